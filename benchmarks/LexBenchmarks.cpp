@@ -0,0 +1,165 @@
+//===- benchmarks/LexBenchmarks.cpp ---------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Throughput benchmarks for the lexing phases: raw lexing, full preprocessing
+// and the dependency-directives minimizer. Every benchmark replays the same
+// header-shaped corpus and reports tokens/sec (items) and bytes/sec, so a
+// lexer change can be compared across all three consumers of the buffer.
+//
+// The corpus is synthetic by default; point CLANG_LEX_BENCHMARK_CORPUS at a
+// real header to replay captured input instead.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TargetOptions.h"
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/ModuleLoader.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace clang;
+
+namespace {
+
+// Builds a corpus that exercises the constructs headers are made of: include
+// guards, macro definitions and uses, conditionals, declarations and inline
+// definitions. Repeated until the corpus is large enough that per-iteration
+// setup cost is negligible.
+std::string buildSyntheticCorpus() {
+  std::string Corpus;
+  Corpus += "#ifndef BENCH_CORPUS_H\n#define BENCH_CORPUS_H\n";
+  for (unsigned I = 0; I < 500; ++I) {
+    std::string N = std::to_string(I);
+    Corpus += "#define BENCH_CONST_" + N + " (" + N + " * 2 + 1)\n";
+    Corpus += "#define BENCH_MIN_" + N + "(a, b) ((a) < (b) ? (a) : (b))\n";
+    Corpus += "#if BENCH_CONST_" + N + " > 100\n";
+    Corpus += "enum { bench_enum_" + N + " = BENCH_CONST_" + N + " };\n";
+    Corpus += "#else\n";
+    Corpus += "enum { bench_enum_" + N + " = 0 };\n";
+    Corpus += "#endif\n";
+    Corpus += "struct bench_struct_" + N + " { int x, y; unsigned flags; };\n";
+    Corpus += "static inline int bench_fn_" + N +
+              "(struct bench_struct_" + N + " *s) {\n"
+              "  return BENCH_MIN_" + N + "(s->x, s->y) + bench_enum_" + N +
+              "; /* trailing comment */\n}\n";
+  }
+  Corpus += "#endif // BENCH_CORPUS_H\n";
+  return Corpus;
+}
+
+StringRef getCorpus() {
+  static const std::string Corpus = [] {
+    if (const char *Path = getenv("CLANG_LEX_BENCHMARK_CORPUS")) {
+      auto Buffer = llvm::MemoryBuffer::getFile(Path);
+      if (!Buffer)
+        llvm::report_fatal_error("cannot read CLANG_LEX_BENCHMARK_CORPUS");
+      return std::string((*Buffer)->getBuffer());
+    }
+    return buildSyntheticCorpus();
+  }();
+  return Corpus;
+}
+
+// Raw mode: pure token boundary recognition, no identifier lookup, no
+// directive handling. This is the layer the speculative skipping and the
+// dependency scanner sit on.
+void BM_RawLex(benchmark::State &BState) {
+  StringRef Corpus = getCorpus();
+  LangOptions LangOpts;
+  uint64_t NumTokens = 0;
+  for (auto _ : BState) {
+    Lexer RawLex(SourceLocation(), LangOpts, Corpus.begin(), Corpus.begin(),
+                 Corpus.end());
+    Token Tok;
+    NumTokens = 0;
+    while (!RawLex.LexFromRawLexer(Tok))
+      ++NumTokens;
+    benchmark::DoNotOptimize(Tok);
+  }
+  BState.SetItemsProcessed(BState.iterations() * NumTokens);
+  BState.SetBytesProcessed(BState.iterations() * Corpus.size());
+}
+BENCHMARK(BM_RawLex);
+
+// Full preprocessing: directive handling, macro expansion, identifier
+// lookup. Covers PPDirectives.cpp and the macro expansion paths.
+void BM_PreprocessorLex(benchmark::State &BState) {
+  StringRef Corpus = getCorpus();
+  FileSystemOptions FileMgrOpts;
+  FileManager FileMgr(FileMgrOpts);
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs);
+  DiagnosticsEngine Diags(DiagID, new DiagnosticOptions,
+                          new IgnoringDiagConsumer);
+  LangOptions LangOpts;
+  std::shared_ptr<TargetOptions> TargetOpts =
+      std::make_shared<TargetOptions>();
+  TargetOpts->Triple = "x86_64-unknown-linux-gnu";
+  IntrusiveRefCntPtr<TargetInfo> Target =
+      TargetInfo::CreateTargetInfo(Diags, TargetOpts);
+
+  uint64_t NumTokens = 0;
+  for (auto _ : BState) {
+    SourceManager SourceMgr(Diags, FileMgr);
+    SourceMgr.setMainFileID(SourceMgr.createFileID(
+        llvm::MemoryBuffer::getMemBuffer(Corpus)));
+    TrivialModuleLoader ModLoader;
+    HeaderSearch HeaderInfo(std::make_shared<HeaderSearchOptions>(), SourceMgr,
+                            Diags, LangOpts, Target.get());
+    Preprocessor PP(std::make_shared<PreprocessorOptions>(), Diags, LangOpts,
+                    SourceMgr, HeaderInfo, ModLoader,
+                    /*IILookup=*/nullptr,
+                    /*OwnsHeaderSearch=*/false);
+    PP.Initialize(*Target);
+    PP.EnterMainSourceFile();
+    Token Tok;
+    NumTokens = 0;
+    do {
+      PP.Lex(Tok);
+      ++NumTokens;
+    } while (Tok.isNot(tok::eof));
+    benchmark::DoNotOptimize(Tok);
+  }
+  BState.SetItemsProcessed(BState.iterations() * NumTokens);
+  BState.SetBytesProcessed(BState.iterations() * Corpus.size());
+}
+BENCHMARK(BM_PreprocessorLex);
+
+// Dependency-directives minimization: what the dependency scanner runs over
+// every file before preprocessing it.
+void BM_DependencyMinimize(benchmark::State &BState) {
+  StringRef Corpus = getCorpus();
+  llvm::SmallVector<char, 4096> Output;
+  llvm::SmallVector<minimize_source_to_dependency_directives::Token, 64>
+      Tokens;
+  uint64_t NumTokens = 0;
+  for (auto _ : BState) {
+    if (minimizeSourceToDependencyDirectives(Corpus, Output, Tokens))
+      llvm::report_fatal_error("minimizer rejected the corpus");
+    NumTokens = Tokens.size();
+    benchmark::DoNotOptimize(Output.data());
+  }
+  BState.SetItemsProcessed(BState.iterations() * NumTokens);
+  BState.SetBytesProcessed(BState.iterations() * Corpus.size());
+}
+BENCHMARK(BM_DependencyMinimize);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,280 @@
+//===- benchmarks/StaticAnalyzerBenchmarks.cpp ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Micro-benchmarks for the state-representation kernels of the static
+// analyzer: store bindings, range constraints, program state churn, symbol
+// liveness and exploded graph growth. They exercise the kernels in isolation
+// on a small fixed workload, so that the cost of a state-representation
+// change can be quantified before running the full analyzer over real code.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/CrossTU/CrossTranslationUnit.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraph.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/ProgramStateTrait.h"
+#include "clang/Tooling/Tooling.h"
+
+using namespace clang;
+using namespace ento;
+
+// Per-state counter map standing in for the state a typical checker carries.
+REGISTER_MAP_WITH_PROGRAMSTATE(BenchMap, int, int)
+
+namespace {
+
+// The fixed workload every benchmark runs against. The parameters provide
+// symbolic values in the initial state, the locals provide regions to bind,
+// and the structs provide subregions for the liveness queries.
+constexpr const char *WorkloadCode =
+    "struct S { int x; int y; };"
+    "void bench(int p0, int p1, int p2, int p3,"
+    "           int p4, int p5, int p6, int p7) {"
+    "  int v0 = 0, v1 = 0, v2 = 0, v3 = 0, v4 = 0, v5 = 0, v6 = 0, v7 = 0;"
+    "  struct S s0, s1, s2, s3;"
+    "}";
+
+// Find a declaration in the workload by name.
+template <typename T>
+const T *findDeclByName(const Decl *Where, StringRef Name) {
+  using namespace ast_matchers;
+  auto Matches = match(decl(hasDescendant(namedDecl(hasName(Name)).bind("v"))),
+                       *Where, Where->getASTContext());
+  assert(Matches.size() == 1 && "Expected exactly one match!");
+  return selectFirst<T>("v", Matches);
+}
+
+// Mirrors the scaffolding of unittests/StaticAnalyzer/Reusables.h: builds a
+// fully functional ExprEngine and hands it, together with the parsed
+// workload function, to the benchmark body. Parsing and engine construction
+// happen outside the measured iterations.
+class ExprEngineBenchConsumer : public ASTConsumer {
+public:
+  using BenchBody =
+      llvm::function_ref<void(ExprEngine &, const FunctionDecl *)>;
+
+private:
+  CompilerInstance &C;
+  CheckerManager ChkMgr;
+  cross_tu::CrossTranslationUnitContext CTU;
+  PathDiagnosticConsumers Consumers;
+  AnalysisManager AMgr;
+  SetOfConstDecls VisitedCallees;
+  FunctionSummariesTy FS;
+  ExprEngine Eng;
+  BenchBody Body;
+
+public:
+  ExprEngineBenchConsumer(CompilerInstance &C, BenchBody Body)
+      : C(C), ChkMgr(C.getASTContext(), *C.getAnalyzerOpts()), CTU(C),
+        Consumers(),
+        AMgr(C.getASTContext(), C.getDiagnostics(), Consumers,
+             CreateRegionStoreManager, CreateRangeConstraintManager, &ChkMgr,
+             *C.getAnalyzerOpts()),
+        VisitedCallees(), FS(),
+        Eng(CTU, AMgr, &VisitedCallees, &FS, ExprEngine::Inline_Regular),
+        Body(Body) {}
+
+  bool HandleTopLevelDecl(DeclGroupRef DG) override {
+    for (const auto *D : DG)
+      if (const auto *FD = dyn_cast<FunctionDecl>(D))
+        if (FD->getIdentifier() && FD->getName() == "bench")
+          Body(Eng, FD);
+    return true;
+  }
+};
+
+class ExprEngineBenchAction : public ASTFrontendAction {
+  ExprEngineBenchConsumer::BenchBody Body;
+
+public:
+  ExprEngineBenchAction(ExprEngineBenchConsumer::BenchBody Body)
+      : Body(Body) {}
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &Compiler,
+                                                 StringRef File) override {
+    return llvm::make_unique<ExprEngineBenchConsumer>(Compiler, Body);
+  }
+};
+
+void runOnWorkload(ExprEngineBenchConsumer::BenchBody Body) {
+  if (!tooling::runToolOnCode(new ExprEngineBenchAction(Body), WorkloadCode))
+    llvm::report_fatal_error("could not set up the benchmark workload");
+}
+
+// Collect the memory regions of the named variables of the workload.
+SmallVector<const VarRegion *, 8>
+getVarRegions(ExprEngine &Eng, const FunctionDecl *FD, StringRef Prefix,
+              unsigned Count) {
+  const StackFrameContext *SFC =
+      Eng.getAnalysisDeclContextManager().getStackFrame(FD);
+  SmallVector<const VarRegion *, 8> Regions;
+  for (unsigned I = 0; I < Count; ++I) {
+    const auto *VD =
+        findDeclByName<VarDecl>(FD, (Prefix + llvm::Twine(I)).str());
+    Regions.push_back(Eng.getRegionManager().getVarRegion(VD, SFC));
+  }
+  return Regions;
+}
+
+// RegionStore: bind a value to every local, load every binding back, then
+// kill the bindings again.
+void BM_RegionStoreBindLookupKill(benchmark::State &BState) {
+  runOnWorkload([&](ExprEngine &Eng, const FunctionDecl *FD) {
+    StoreManager &StMgr = Eng.getStoreManager();
+    SValBuilder &SVB = Eng.getSValBuilder();
+    ASTContext &ACtx = Eng.getContext();
+    const StackFrameContext *SFC =
+        Eng.getAnalysisDeclContextManager().getStackFrame(FD);
+
+    SmallVector<Loc, 8> Locs;
+    for (const VarRegion *VR : getVarRegions(Eng, FD, "v", 8))
+      Locs.push_back(loc::MemRegionVal(VR));
+
+    const Store StInit = StMgr.getInitialStore(SFC).getStore();
+    const SVal One = SVB.makeIntVal(1, ACtx.IntTy);
+    for (auto _ : BState) {
+      Store St = StInit;
+      for (Loc L : Locs)
+        St = StMgr.Bind(St, L, One).getStore();
+      for (Loc L : Locs)
+        benchmark::DoNotOptimize(StMgr.getBinding(St, L, ACtx.IntTy));
+      for (Loc L : Locs)
+        St = StMgr.killBinding(St, L).getStore();
+      benchmark::DoNotOptimize(St);
+    }
+  });
+}
+BENCHMARK(BM_RegionStoreBindLookupKill);
+
+// RangeConstraintManager: constrain every parameter symbol to an interval
+// and then split the interval by excluding individual values, which is the
+// pattern switch-heavy code produces.
+void BM_RangeConstraintAssume(benchmark::State &BState) {
+  runOnWorkload([&](ExprEngine &Eng, const FunctionDecl *FD) {
+    SValBuilder &SVB = Eng.getSValBuilder();
+    ASTContext &ACtx = Eng.getContext();
+    const StackFrameContext *SFC =
+        Eng.getAnalysisDeclContextManager().getStackFrame(FD);
+    const ProgramStateRef InitState = Eng.getInitialState(SFC);
+
+    SmallVector<SVal, 8> Params;
+    for (const VarRegion *VR : getVarRegions(Eng, FD, "p", 8))
+      Params.push_back(InitState->getSVal(loc::MemRegionVal(VR)));
+
+    for (auto _ : BState) {
+      ProgramStateRef State = InitState;
+      for (SVal V : Params) {
+        auto Constrain = [&](BinaryOperator::Opcode Op, int RHS) {
+          SVal Cond = SVB.evalBinOp(State, Op, V,
+                                    SVB.makeIntVal(RHS, ACtx.IntTy),
+                                    ACtx.BoolTy);
+          if (auto DV = Cond.getAs<DefinedOrUnknownSVal>())
+            State = State->assume(*DV, true);
+          assert(State && "Workload constraints must be satisfiable");
+        };
+        Constrain(BO_GE, 0);
+        Constrain(BO_LT, 100);
+        for (int Excluded = 10; Excluded < 50; Excluded += 10)
+          Constrain(BO_NE, Excluded);
+      }
+      benchmark::DoNotOptimize(State);
+    }
+  });
+}
+BENCHMARK(BM_RangeConstraintAssume);
+
+// ProgramState: the add/overwrite/remove churn of a typical checker's
+// per-state map, including the state uniquing behind each step.
+void BM_ProgramStateMapChurn(benchmark::State &BState) {
+  runOnWorkload([&](ExprEngine &Eng, const FunctionDecl *FD) {
+    const StackFrameContext *SFC =
+        Eng.getAnalysisDeclContextManager().getStackFrame(FD);
+    const ProgramStateRef InitState = Eng.getInitialState(SFC);
+
+    for (auto _ : BState) {
+      ProgramStateRef State = InitState;
+      for (int I = 0; I < 64; ++I)
+        State = State->set<BenchMap>(I, I);
+      for (int I = 0; I < 64; ++I)
+        benchmark::DoNotOptimize(State->get<BenchMap>(I));
+      for (int I = 0; I < 64; I += 2)
+        State = State->remove<BenchMap>(I);
+      benchmark::DoNotOptimize(State);
+    }
+  });
+}
+BENCHMARK(BM_ProgramStateMapChurn);
+
+// SymbolReaper: mark the subregions of half of the structs live and sweep
+// the liveness of all regions and parameter symbols, as removeDeadBindings
+// does at every cleanup point.
+void BM_SymbolReaperSweep(benchmark::State &BState) {
+  runOnWorkload([&](ExprEngine &Eng, const FunctionDecl *FD) {
+    const StackFrameContext *SFC =
+        Eng.getAnalysisDeclContextManager().getStackFrame(FD);
+    const ProgramStateRef InitState = Eng.getInitialState(SFC);
+
+    const auto *FieldX = findDeclByName<FieldDecl>(FD, "x");
+    SmallVector<const VarRegion *, 8> Structs = getVarRegions(Eng, FD, "s", 4);
+    SmallVector<const VarRegion *, 8> Locals = getVarRegions(Eng, FD, "v", 8);
+    SmallVector<SymbolRef, 8> ParamSyms;
+    for (const VarRegion *VR : getVarRegions(Eng, FD, "p", 8))
+      ParamSyms.push_back(
+          InitState->getSVal(loc::MemRegionVal(VR)).getAsSymbol());
+
+    for (auto _ : BState) {
+      SymbolReaper SymReaper(SFC, /*s=*/nullptr, Eng.getSymbolManager(),
+                             Eng.getStoreManager());
+      for (unsigned I = 0; I < Structs.size(); I += 2)
+        SymReaper.markLive(
+            Eng.getRegionManager().getFieldRegion(FieldX, Structs[I]));
+      for (SymbolRef Sym : ParamSyms)
+        if (Sym)
+          SymReaper.markLive(Sym);
+      for (const VarRegion *VR : Structs)
+        benchmark::DoNotOptimize(SymReaper.isLiveRegion(VR));
+      for (const VarRegion *VR : Locals)
+        benchmark::DoNotOptimize(SymReaper.isLiveRegion(VR));
+      for (SymbolRef Sym : ParamSyms)
+        if (Sym)
+          benchmark::DoNotOptimize(SymReaper.isLive(Sym));
+    }
+  });
+}
+BENCHMARK(BM_SymbolReaperSweep);
+
+// ExplodedGraph: grow a graph by one node per distinct state, which is
+// dominated by state profiling and the node uniquing of the graph.
+void BM_ExplodedGraphGrowth(benchmark::State &BState) {
+  runOnWorkload([&](ExprEngine &Eng, const FunctionDecl *FD) {
+    const StackFrameContext *SFC =
+        Eng.getAnalysisDeclContextManager().getStackFrame(FD);
+    const ProgramStateRef InitState = Eng.getInitialState(SFC);
+    const Stmt *Body = FD->getBody();
+
+    for (auto _ : BState) {
+      ExplodedGraph G;
+      ProgramStateRef State = InitState;
+      for (int I = 0; I < 256; ++I) {
+        State = State->set<BenchMap>(0, I);
+        bool IsNew;
+        benchmark::DoNotOptimize(
+            G.getNode(PostStmt(Body, SFC), State, /*IsSink=*/false, &IsNew));
+      }
+    }
+  });
+}
+BENCHMARK(BM_ExplodedGraphGrowth);
+
+} // namespace
+
+BENCHMARK_MAIN();
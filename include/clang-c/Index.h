@@ -32,7 +32,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 59
+#define CINDEX_VERSION_MINOR 60
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -4191,6 +4191,71 @@ CINDEX_LINKAGE unsigned clang_visitChildrenWithBlock(CXCursor parent,
 #  endif
 #endif
 
+/**
+ * One serialized cursor produced by clang_getCursorDescendants().
+ */
+typedef struct CXDescendantRecord {
+  /* The kind of the cursor. */
+  enum CXCursorKind Kind;
+
+  /* The depth of the cursor below the traversal root; direct children of
+     the root have depth 0. Records are in visitation (pre)order, so the
+     tree shape can be reconstructed from the depths alone. */
+  unsigned Depth;
+
+  /* The extent of the cursor, as clang_getCursorExtent() returns it. */
+  CXSourceRange Extent;
+
+  /* Byte offsets of the cursor spelling and Unified Symbol Resolution
+     string in the string table of the batch. The strings are
+     NUL-terminated; offset 0 is always the empty string, and the USR
+     offset is 0 when USRs were not requested. */
+  unsigned SpellingOffset;
+  unsigned USROffset;
+} CXDescendantRecord;
+
+/**
+ * A whole cursor subtree serialized into flat arrays.
+ */
+typedef struct CXCursorDescendants {
+  /* Private data member, used by clang_disposeCursorDescendants(). */
+  void *data;
+
+  /* The number of records in the 'records' array. */
+  unsigned numRecords;
+
+  /* The serialized cursors, in visitation order. */
+  const CXDescendantRecord *records;
+
+  /* The string table the records point into, a sequence of NUL-terminated
+     strings of 'stringsSize' bytes in total. */
+  unsigned stringsSize;
+  const char *strings;
+} CXCursorDescendants;
+
+/**
+ * Serialize the entire subtree below \p parent in one call.
+ *
+ * Equivalent to a recursive clang_visitChildren() traversal, but the
+ * results are returned as one flat array of records plus a deduplicated
+ * string table instead of invoking a callback per cursor. Bindings that
+ * pay per libclang entry (for example, foreign function interfaces of
+ * interpreted languages) can consume the arrays directly.
+ *
+ * \param parent the cursor whose descendants should be serialized.
+ *
+ * \param wantUSRs if non-zero, the USR of each cursor is computed and
+ * recorded; computing USRs is considerably more expensive than the
+ * traversal itself.
+ *
+ * \returns the serialized subtree. The object should be released with
+ * clang_disposeCursorDescendants().
+ */
+CINDEX_LINKAGE CXCursorDescendants clang_getCursorDescendants(CXCursor parent,
+                                                              unsigned wantUSRs);
+
+CINDEX_LINKAGE void clang_disposeCursorDescendants(CXCursorDescendants batch);
+
 /**
  * @}
  */
@@ -167,19 +167,37 @@ public:
     llvm::PointerIntPair<Expr *, 1, bool> ExprAndFlag;
   };
 
+  /// The cached result of an integer constant evaluation, together with the
+  /// side effect flags the evaluation produced (see Expr::EvaluateAsInt).
+  struct IntEvalCacheEntry {
+    llvm::APSInt Value;
+    bool Success;
+    bool HasSideEffects;
+    bool HasUndefinedBehavior;
+  };
+
 private:
   friend class NestedNameSpecifier;
 
+  /// Initial bucket count (log2) for the interning folding sets that a
+  /// typical C++ translation unit fills with thousands of nodes. Growing a
+  /// FoldingSet rehashes every node it contains, so starting the hottest
+  /// sets above the default of 64 buckets saves several full rehash passes
+  /// while the AST is built.
+  static const unsigned HotFoldingSetLog2InitSize = 10;
+
   mutable SmallVector<Type *, 0> Types;
   mutable llvm::FoldingSet<ExtQuals> ExtQualNodes;
   mutable llvm::FoldingSet<ComplexType> ComplexTypes;
-  mutable llvm::FoldingSet<PointerType> PointerTypes;
+  mutable llvm::FoldingSet<PointerType> PointerTypes{HotFoldingSetLog2InitSize};
   mutable llvm::FoldingSet<AdjustedType> AdjustedTypes;
   mutable llvm::FoldingSet<BlockPointerType> BlockPointerTypes;
-  mutable llvm::FoldingSet<LValueReferenceType> LValueReferenceTypes;
+  mutable llvm::FoldingSet<LValueReferenceType> LValueReferenceTypes{
+      HotFoldingSetLog2InitSize};
   mutable llvm::FoldingSet<RValueReferenceType> RValueReferenceTypes;
   mutable llvm::FoldingSet<MemberPointerType> MemberPointerTypes;
-  mutable llvm::FoldingSet<ConstantArrayType> ConstantArrayTypes;
+  mutable llvm::FoldingSet<ConstantArrayType> ConstantArrayTypes{
+      HotFoldingSetLog2InitSize};
   mutable llvm::FoldingSet<IncompleteArrayType> IncompleteArrayTypes;
   mutable std::vector<VariableArrayType*> VariableArrayTypes;
   mutable llvm::FoldingSet<DependentSizedArrayType> DependentSizedArrayTypes;
@@ -197,13 +215,14 @@ private:
   mutable llvm::FoldingSet<TemplateTypeParmType> TemplateTypeParmTypes;
   mutable llvm::FoldingSet<ObjCTypeParamType> ObjCTypeParamTypes;
   mutable llvm::FoldingSet<SubstTemplateTypeParmType>
-    SubstTemplateTypeParmTypes;
+    SubstTemplateTypeParmTypes{HotFoldingSetLog2InitSize};
   mutable llvm::FoldingSet<SubstTemplateTypeParmPackType>
     SubstTemplateTypeParmPackTypes;
   mutable llvm::ContextualFoldingSet<TemplateSpecializationType, ASTContext&>
     TemplateSpecializationTypes;
   mutable llvm::FoldingSet<ParenType> ParenTypes;
-  mutable llvm::FoldingSet<ElaboratedType> ElaboratedTypes;
+  mutable llvm::FoldingSet<ElaboratedType> ElaboratedTypes{
+      HotFoldingSetLog2InitSize};
   mutable llvm::FoldingSet<DependentNameType> DependentNameTypes;
   mutable llvm::ContextualFoldingSet<DependentTemplateSpecializationType,
                                      ASTContext&>
@@ -231,12 +250,15 @@ private:
   /// The set of nested name specifiers.
   ///
   /// This set is managed by the NestedNameSpecifier class.
-  mutable llvm::FoldingSet<NestedNameSpecifier> NestedNameSpecifiers;
+  mutable llvm::FoldingSet<NestedNameSpecifier> NestedNameSpecifiers{
+      HotFoldingSetLog2InitSize};
   mutable NestedNameSpecifier *GlobalNestedNameSpecifier = nullptr;
 
   /// A cache mapping from RecordDecls to ASTRecordLayouts.
   ///
-  /// This is lazily created.  This is intentionally not serialized.
+  /// This is lazily created. The layouts computed by the time an AST file is
+  /// written are serialized with it and served back by the reader through
+  /// ExternalASTSource::layoutRecordType().
   mutable llvm::DenseMap<const RecordDecl*, const ASTRecordLayout*>
     ASTRecordLayouts;
   mutable llvm::DenseMap<const ObjCContainerDecl*, const ASTRecordLayout*>
@@ -252,6 +274,12 @@ private:
   using UnadjustedAlignMap = llvm::DenseMap<const Type *, unsigned>;
   mutable UnadjustedAlignMap MemoizedUnadjustedAlign;
 
+  /// A cache of integer constant evaluations, keyed by expression and
+  /// evaluation flags. Expressions are immutable once built, so entries
+  /// never need invalidation.
+  mutable llvm::DenseMap<std::pair<const Expr *, unsigned>, IntEvalCacheEntry>
+      IntEvalCache;
+
   /// A cache mapping from CXXRecordDecls to key functions.
   llvm::DenseMap<const CXXRecordDecl*, LazyDeclPtr> KeyFunctions;
 
@@ -545,6 +573,32 @@ private:
   ///
   /// AST objects are never destructed; rather, all memory associated with the
   /// AST objects will be released when the ASTContext itself is destroyed.
+  ///
+  /// All AST construction (Sema, the ASTReader, the importers) runs on one
+  /// thread, so the non-atomic bump pointer is the fast path by design.
+  /// Note before parallelizing any of those clients: the reference returned
+  /// by getAllocator() is shared with the comments subsystem, Decl::getID
+  /// and Stmt::getID walk the slab list via identifyKnownAlignedObject(),
+  /// and neither is prepared for slabs appearing concurrently.
+  ///
+  /// On replacing intra-AST pointers with 32-bit slab-relative references
+  /// (periodically proposed to shrink analysis-only ASTs): the slabs are
+  /// independent, geometrically growing mallocs rather than one contiguous
+  /// reservation, so a compressed reference needs a slab index plus offset
+  /// and a side table to decode it, and it still cannot reach the nodes
+  /// that live outside this allocator (ASTImporter targets, nodes of other
+  /// ASTUnits during CTU). More fundamentally, the AST hands out raw
+  /// Stmt*/Decl* everywhere: TrailingObjects arrays such as a
+  /// CompoundStmt's body are typed Stmt** and iterated by clients directly,
+  /// Stmt::children() yields Stmt*& lvalues that Sema and the tree
+  /// transforms assign through, and every external interface (ASTMatchers,
+  /// libclang, plugins, serialization) traffics in plain pointers. Accessor
+  /// templates would therefore have to decompress at each such boundary,
+  /// which is a rewrite of the node classes, not an allocator change. The
+  /// cheap variant of the idea already exists where it pays: the AST reader
+  /// stores cross-references as 32-bit IDs and materializes nodes lazily,
+  /// so analysis processes should load ASTs rather than rebuild them when
+  /// memory is the constraint.
   mutable llvm::BumpPtrAllocator BumpAlloc;
 
   /// Allocator for partial diagnostics.
@@ -565,6 +619,12 @@ private:
   const TargetInfo *AuxTarget = nullptr;
   clang::PrintingPolicy PrintingPolicy;
 
+  /// The generation of the declarations visible in file contexts (namespaces
+  /// and the translation unit). It is incremented whenever such a declaration
+  /// is added or removed; Sema uses it to validate memoized qualified name
+  /// lookups.
+  unsigned QualifiedLookupGeneration = 0;
+
 public:
   IdentifierTable &Idents;
   SelectorTable &Selectors;
@@ -1082,6 +1142,17 @@ public:
     return ExternalSource.get();
   }
 
+  /// Retrieve the current generation of the declarations visible in file
+  /// contexts. Qualified name lookup results that were memoized under an
+  /// older generation are stale.
+  unsigned getQualifiedLookupGeneration() const {
+    return QualifiedLookupGeneration;
+  }
+
+  /// Note that the set of declarations visible in a file context has
+  /// changed, invalidating any memoized qualified name lookups.
+  void incrementQualifiedLookupGeneration() { ++QualifiedLookupGeneration; }
+
   /// Attach an AST mutation listener to the AST context.
   ///
   /// The AST mutation listener provides the ability to track modifications to
@@ -1096,6 +1167,13 @@ public:
   ASTMutationListener *getASTMutationListener() const { return Listener; }
 
   void PrintStats() const;
+
+  /// Write a JSON breakdown of AST memory usage to \p OS, attributing
+  /// declarations and types to their kind and declarations to the file they
+  /// were written in. Node sizes are the static sizes of the corresponding
+  /// classes, so nodes with trailing storage are lower bounds.
+  void printMemoryProfile(llvm::raw_ostream &OS) const;
+
   const SmallVectorImpl<Type *>& getTypes() const { return Types; }
 
   BuiltinTemplateDecl *buildBuiltinTemplateDecl(BuiltinTemplateKind BTK,
@@ -2680,6 +2758,16 @@ public:
     return Res;
   }
 
+  /// Look up the cached result of evaluating \p E as an integer with the
+  /// given evaluation flags, or null if \p E has not been evaluated yet.
+  const IntEvalCacheEntry *getIntEvalCacheEntry(const Expr *E,
+                                                unsigned Flags) const;
+
+  /// Cache the result of evaluating \p E as an integer with the given
+  /// evaluation flags.
+  void setIntEvalCacheEntry(const Expr *E, unsigned Flags,
+                            IntEvalCacheEntry Entry) const;
+
   bool isSentinelNullExpr(const Expr *E);
 
   /// Get the implementation of the ObjCInterfaceDecl \p D, or nullptr if
@@ -2869,6 +2957,14 @@ public:
   /// declarations were built.
   unsigned NumImplicitDestructorsDeclared = 0;
 
+  /// The number of integer constant evaluations answered from the
+  /// evaluation cache.
+  mutable unsigned NumIntEvalCacheHits = 0;
+
+  /// The number of integer constant evaluations that populated the
+  /// evaluation cache.
+  mutable unsigned NumIntEvalCacheMisses = 0;
+
 public:
   /// Initialize built-in types.
   ///
@@ -20,7 +20,10 @@ namespace clang {
 /// Used to specify the format for printing AST dump information.
 enum ASTDumpOutputFormat {
   ADOF_Default,
-  ADOF_JSON
+  ADOF_JSON,
+  /// One compact JSON object per top-level declaration per line, emitted as
+  /// declarations are parsed rather than after the whole TU is built.
+  ADOF_JSONLines
 };
 
 // Colors used for various parts of the AST dump
@@ -81,6 +81,14 @@ class TypeSourceInfo;
 
   /// Imports selected nodes from one AST context into another context,
   /// merging AST nodes where appropriate.
+  ///
+  /// An importer and both of its ASTContexts are confined to a single
+  /// thread: every import mutates the destination context through
+  /// unsynchronized structures (the allocator, the identifier table and the
+  /// type/declaration FoldingSets), so neither one importer nor two
+  /// importers sharing a destination context may run concurrently.
+  /// Parallel cross-TU imports therefore have to be partitioned between
+  /// processes, each owning its own destination context.
   class ASTImporter {
     friend class ASTNodeImporter;
   public:
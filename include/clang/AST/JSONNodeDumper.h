@@ -101,7 +101,7 @@ public:
     FirstChild = false;
   }
 
-  NodeStreamer(raw_ostream &OS) : JOS(OS, 2) {}
+  NodeStreamer(raw_ostream &OS, unsigned Indent = 2) : JOS(OS, Indent) {}
 };
 
 // Dumps AST nodes in JSON format. There is no implied stability for the
@@ -179,9 +179,10 @@ class JSONNodeDumper
 public:
   JSONNodeDumper(raw_ostream &OS, const SourceManager &SrcMgr, ASTContext &Ctx,
                  const PrintingPolicy &PrintPolicy,
-                 const comments::CommandTraits *Traits)
-      : NodeStreamer(OS), SM(SrcMgr), Ctx(Ctx), PrintPolicy(PrintPolicy),
-        Traits(Traits), LastLocLine(0), LastLocPresumedLine(0) {}
+                 const comments::CommandTraits *Traits, unsigned Indent = 2)
+      : NodeStreamer(OS, Indent), SM(SrcMgr), Ctx(Ctx),
+        PrintPolicy(PrintPolicy), Traits(Traits), LastLocLine(0),
+        LastLocPresumedLine(0) {}
 
   void Visit(const Attr *A);
   void Visit(const Stmt *Node);
@@ -404,8 +405,8 @@ class JSONDumper : public ASTNodeTraverser<JSONDumper, JSONNodeDumper> {
 public:
   JSONDumper(raw_ostream &OS, const SourceManager &SrcMgr, ASTContext &Ctx,
              const PrintingPolicy &PrintPolicy,
-             const comments::CommandTraits *Traits)
-      : NodeDumper(OS, SrcMgr, Ctx, PrintPolicy, Traits) {}
+             const comments::CommandTraits *Traits, unsigned Indent = 2)
+      : NodeDumper(OS, SrcMgr, Ctx, PrintPolicy, Traits, Indent) {}
 
   JSONNodeDumper &doGetNodeDelegate() { return NodeDumper; }
 
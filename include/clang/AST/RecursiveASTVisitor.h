@@ -175,6 +175,20 @@ public:
   /// Return whether this visitor should traverse post-order.
   bool shouldTraversePostOrder() const { return false; }
 
+  /// Return whether this visitor should use data recursion (an explicit
+  /// worklist) instead of native recursion when traversing the declarations
+  /// of a DeclContext.
+  ///
+  /// This bounds the C++ stack usage on deeply nested declaration contexts,
+  /// e.g. in generated code. Every declaration is still traversed through
+  /// the usual Traverse*Decl entry points and is visited before its context
+  /// children, but a child is traversed only after the enclosing
+  /// TraverseDecl() call has returned. Visitors that maintain state keyed on
+  /// the traversal nesting (such as a stack of parent nodes) must leave this
+  /// disabled. Ignored in post-order mode, where a parent must be walked up
+  /// after its children.
+  bool shouldDataRecurseDecls() const { return false; }
+
   /// Recursively visits an entire AST, starting from the top-level Decls
   /// in the AST traversal scope (by default, the TranslationUnitDecl).
   /// \returns false if visitation was terminated early.
@@ -538,6 +552,14 @@ private:
 
   bool dataTraverseNode(Stmt *S, DataRecursionQueue *Queue);
   bool PostVisitStmt(Stmt *S);
+
+  /// When non-null, child declarations found while traversing a DeclContext
+  /// are deferred to this worklist instead of being recursed into; the
+  /// outermost TraverseDecl call drains it. Only used when the derived
+  /// visitor enables shouldDataRecurseDecls().
+  SmallVectorImpl<Decl *> *DeclsToTraverse = nullptr;
+
+  bool dataRecurseDecls(Decl *D);
 };
 
 template <typename Derived>
@@ -713,6 +735,13 @@ bool RecursiveASTVisitor<Derived>::TraverseDecl(Decl *D) {
   if (!getDerived().shouldVisitImplicitCode() && D->isImplicit())
     return true;
 
+  // If requested, perform data recursion over declaration contexts: this
+  // outermost call becomes the driver draining the worklist that
+  // TraverseDeclContextHelper fills.
+  if (getDerived().shouldDataRecurseDecls() && !DeclsToTraverse &&
+      !getDerived().shouldTraversePostOrder())
+    return dataRecurseDecls(D);
+
   switch (D->getKind()) {
 #define ABSTRACT_DECL(DECL)
 #define DECL(CLASS, BASE)                                                      \
@@ -731,6 +760,23 @@ bool RecursiveASTVisitor<Derived>::TraverseDecl(Decl *D) {
   return true;
 }
 
+template <typename Derived>
+bool RecursiveASTVisitor<Derived>::dataRecurseDecls(Decl *D) {
+  SmallVector<Decl *, 16> Worklist;
+  Worklist.push_back(D);
+  DeclsToTraverse = &Worklist;
+  bool Result = true;
+  while (!Worklist.empty()) {
+    Decl *Next = Worklist.pop_back_val();
+    if (!getDerived().TraverseDecl(Next)) {
+      Result = false;
+      break;
+    }
+  }
+  DeclsToTraverse = nullptr;
+  return Result;
+}
+
 #undef DISPATCH
 
 template <typename Derived>
@@ -1388,6 +1434,19 @@ bool RecursiveASTVisitor<Derived>::TraverseDeclContextHelper(DeclContext *DC) {
   if (!DC)
     return true;
 
+  // In data-recursion mode, defer the children to the worklist. They are
+  // reversed so that the LIFO drain in dataRecurseDecls keeps the usual
+  // source order.
+  if (DeclsToTraverse) {
+    const size_t FirstChild = DeclsToTraverse->size();
+    for (auto *Child : DC->decls())
+      if (!canIgnoreChildDeclWhileTraversingDeclContext(Child))
+        DeclsToTraverse->push_back(Child);
+    std::reverse(DeclsToTraverse->begin() + FirstChild,
+                 DeclsToTraverse->end());
+    return true;
+  }
+
   for (auto *Child : DC->decls()) {
     if (!canIgnoreChildDeclWhileTraversingDeclContext(Child))
       TRY_TO(TraverseDecl(Child));
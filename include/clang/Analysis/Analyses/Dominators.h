@@ -15,6 +15,7 @@
 
 #include "clang/Analysis/AnalysisDeclContext.h"
 #include "clang/Analysis/CFG.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/iterator.h"
@@ -176,6 +177,20 @@ public:
     DT.print(OS);
   }
 
+  /// Hooks for AnalysisDeclContext::getAnalysis, so the tree is built once
+  /// per function and shared by every consumer instead of recalculated from
+  /// scratch by each of them.
+  static const void *getTag() {
+    static int x;
+    return &x;
+  }
+
+  static CFGDominatorTreeImpl *create(AnalysisDeclContext &AC) {
+    if (CFG *cfg = AC.getCFG())
+      return new CFGDominatorTreeImpl(cfg);
+    return nullptr;
+  }
+
 private:
   CFG *cfg;
   DominatorTreeBase DT;
@@ -187,6 +202,54 @@ using CFGPostDomTree = CFGDominatorTreeImpl</*IsPostDom*/ true>;
 template<> void CFGDominatorTreeImpl<true>::anchor();
 template<> void CFGDominatorTreeImpl<false>::anchor();
 
+/// A compact immediate-dominator table for a CFG.
+///
+/// Stores one block ID per block instead of the linked DomTreeNode objects,
+/// which makes it cheap enough to keep alive for every function of a
+/// whole-TU run. The full dominator tree is only needed while building the
+/// table and can be discarded afterwards. Only immediate-dominator chain
+/// walks are supported; use CFGDomTree for arbitrary dominance queries.
+class CFGIDomTable {
+public:
+  enum : unsigned { NoIDom = ~0u };
+
+  CFGIDomTable() = default;
+  explicit CFGIDomTable(CFG *cfg) { build(cfg); }
+
+  void build(CFG *cfg) {
+    CFGDomTree DT(cfg);
+    IDoms.assign(cfg->getNumBlockIDs(), NoIDom);
+    Reachable.assign(cfg->getNumBlockIDs(), false);
+    for (CFGBlock *B : *cfg) {
+      DomTreeNode *N = DT.getBase().getNode(B);
+      if (!N)
+        continue;
+      Reachable[B->getBlockID()] = true;
+      if (DomTreeNode *IDom = N->getIDom())
+        if (IDom->getBlock())
+          IDoms[B->getBlockID()] = IDom->getBlock()->getBlockID();
+    }
+  }
+
+  /// \returns the ID of the immediate dominator of the block with the given
+  /// ID, or NoIDom for the entry block and for unreachable blocks.
+  unsigned getIDom(unsigned BlockID) const {
+    assert(BlockID < IDoms.size());
+    return IDoms[BlockID];
+  }
+
+  /// Tests whether the block with the given ID is reachable from the entry
+  /// block; unreachable blocks have no dominators.
+  bool isReachable(unsigned BlockID) const {
+    assert(BlockID < Reachable.size());
+    return Reachable[BlockID];
+  }
+
+private:
+  std::vector<unsigned> IDoms;
+  llvm::BitVector Reachable;
+};
+
 } // end of namespace clang
 
 namespace llvm {
@@ -252,6 +315,20 @@ public:
     return llvm::is_contained(getControlDependencies(A), B);
   }
 
+  /// Hooks for AnalysisDeclContext::getAnalysis, so the post dominator tree
+  /// and the control dependencies computed so far are shared by every
+  /// consumer of the same function.
+  static const void *getTag() {
+    static int x;
+    return &x;
+  }
+
+  static ControlDependencyCalculator *create(AnalysisDeclContext &AC) {
+    if (CFG *cfg = AC.getCFG())
+      return new ControlDependencyCalculator(cfg);
+    return nullptr;
+  }
+
   // Dumps immediate control dependencies for each block.
   LLVM_DUMP_METHOD void dump() {
     CFG *cfg = PostDomTree.getCFG();
@@ -70,6 +70,11 @@ public:
   ~LiveVariables() override;
 
   /// Compute the liveness information for a given CFG.
+  ///
+  /// For very large CFGs the full all-variables fixpoint is deferred and
+  /// the isLive() queries are answered on demand by a memoized search; the
+  /// fixpoint is still computed lazily for clients, such as
+  /// runOnAllBlocks(), that need liveness everywhere.
   static LiveVariables *computeLiveness(AnalysisDeclContext &analysisContext,
                                         bool killAtAssign);
 
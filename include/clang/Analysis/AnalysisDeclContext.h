@@ -73,7 +73,7 @@ class AnalysisDeclContext {
 
   const Decl * const D;
 
-  std::unique_ptr<CFG> cfg, completeCFG;
+  std::unique_ptr<CFG> cfg, completeCFG, skeletonCFG;
   std::unique_ptr<CFGStmtMap> cfgStmtMap;
 
   CFG::BuildOptions cfgBuildOptions;
@@ -81,6 +81,7 @@ class AnalysisDeclContext {
 
   bool builtCFG = false;
   bool builtCompleteCFG = false;
+  bool builtSkeletonCFG = false;
   std::unique_ptr<ParentMap> PM;
   std::unique_ptr<CFGReverseBlockReachabilityAnalysis> CFA;
 
@@ -164,6 +165,16 @@ public:
   /// Return a version of the CFG without any edges pruned.
   CFG *getUnoptimizedCFG();
 
+  /// Return a version of the CFG built without any of the optional elements
+  /// (implicit destructors, temporaries, scopes, ...), i.e. blocks and
+  /// terminators only.
+  ///
+  /// This is considerably cheaper to build than the full CFG and suffices
+  /// for purely structural queries such as reachability or block counts.
+  /// Note that block IDs are not stable across CFG variants, so blocks taken
+  /// from the skeleton must never be mixed with blocks from getCFG().
+  CFG *getSkeletonCFG();
+
   void dumpCFG(bool ShowColors);
 
   /// Returns true if we have built a CFG for this analysis context.
@@ -608,6 +608,8 @@ class CFGBlock {
 
     size_t size() const { return Impl.size(); }
     bool empty() const { return Impl.empty(); }
+
+    void shrinkToFit(BumpVectorContext &C) { Impl.shrink_to_fit(C); }
   };
 
   /// The set of statements in the basic block.
@@ -902,6 +904,16 @@ public:
   /// Adds a (potentially unreachable) successor block to the current block.
   void addSuccessor(AdjacentBlock Succ, BumpVectorContext &C);
 
+  /// Repacks the element, predecessor and successor vectors into
+  /// exactly-sized buffers. Called once per block when CFG construction is
+  /// done; shrinking the blocks in order lays their arrays out back-to-back
+  /// in the CFG's allocator.
+  void shrinkToFit(BumpVectorContext &C) {
+    Elements.shrinkToFit(C);
+    Preds.shrink_to_fit(C);
+    Succs.shrink_to_fit(C);
+  }
+
   void appendStmt(Stmt *statement, BumpVectorContext &C) {
     Elements.push_back(CFGStmt(statement), C);
   }
@@ -1086,6 +1098,12 @@ public:
   /// not directly free it.
   CFGBlock *createBlock();
 
+  /// Repacks the block list and every block's vectors into exactly-sized
+  /// buffers, laid out in traversal order within the CFG's allocator. Run by
+  /// buildCFG once construction is done so that the analyses iterating the
+  /// graph touch densely packed memory.
+  void shrinkToFit();
+
   /// Set the entry block of the CFG. This is typically used only during CFG
   /// construction. Most CFG clients expect that the entry block has no
   /// predecessors and contains no statements.
@@ -0,0 +1,72 @@
+//===- CallArgumentFacts.h - Flow-insensitive call-site summaries -*- C++ -*-=//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares a cheap, flow-insensitive whole-TU pre-pass that
+//  summarizes the arguments each function is called with. Consumers can use
+//  the facts to seed analyses with conditions no visible caller can violate.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_ANALYSIS_CALLARGUMENTFACTS_H
+#define LLVM_CLANG_ANALYSIS_CALLARGUMENTFACTS_H
+
+#include "llvm/ADT/APSInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace clang {
+
+class FunctionDecl;
+class TranslationUnitDecl;
+
+/// Flow-insensitive, whole-TU summary of the arguments each function is
+/// called with.
+///
+/// Facts are only recorded for functions whose callers are all visible in
+/// the TU: internal linkage, non-virtual, and address never taken. For each
+/// parameter of such a function the summary records whether every call
+/// passes a provably non-null pointer and whether every call passes one
+/// identical integer constant. The path-sensitive engine uses these facts
+/// to seed entry states of top-level frames, avoiding state splits on
+/// conditions no caller can trigger.
+class CallArgumentFacts {
+public:
+  struct ParamFacts {
+    /// Every visible call passes a provably non-null pointer argument.
+    bool AlwaysNonNull = true;
+
+    /// The single integer constant every visible call passes, if the calls
+    /// agree on one.
+    llvm::Optional<llvm::APSInt> UniqueConstant;
+  };
+
+  struct FunctionFacts {
+    /// The number of calls summarized. Parameter facts are vacuous while
+    /// this is zero.
+    unsigned NumCalls = 0;
+
+    llvm::SmallVector<ParamFacts, 4> Params;
+  };
+
+  /// Summarize every call visible in \p TU. Intended to be invoked once.
+  void addTU(const TranslationUnitDecl *TU);
+
+  /// Return the facts for \p FD, or null if not all of its callers are
+  /// visible in the TU or no call to it was seen.
+  const FunctionFacts *lookup(const FunctionDecl *FD) const;
+
+private:
+  friend class CallArgumentCollector;
+
+  llvm::DenseMap<const FunctionDecl *, FunctionFacts> Facts;
+};
+
+} // namespace clang
+
+#endif // LLVM_CLANG_ANALYSIS_CALLARGUMENTFACTS_H
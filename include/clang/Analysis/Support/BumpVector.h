@@ -190,6 +190,32 @@ public:
       grow(C, N);
   }
 
+  /// Reallocate the vector into an exactly-sized buffer at the allocator's
+  /// current end. Bump allocation can never reclaim the slack left behind by
+  /// growing, but once a vector is known to be complete, a tight copy packs
+  /// vectors shrunk in sequence next to each other, which improves locality
+  /// of later traversals.
+  void shrink_to_fit(BumpVectorContext &C) {
+    size_t CurSize = size();
+    if (CurSize == capacity())
+      return;
+
+    if (CurSize == 0) {
+      Begin = End = Capacity = nullptr;
+      return;
+    }
+
+    T *NewElts = C.getAllocator().template Allocate<T>(CurSize);
+    if (std::is_class<T>::value) {
+      std::uninitialized_copy(Begin, End, NewElts);
+      destroy_range(Begin, End);
+    } else {
+      memcpy(NewElts, Begin, CurSize * sizeof(T));
+    }
+    Begin = NewElts;
+    End = Capacity = NewElts + CurSize;
+  }
+
   /// capacity - Return the total number of elements in the currently allocated
   /// buffer.
   size_t capacity() const { return Capacity - Begin; }
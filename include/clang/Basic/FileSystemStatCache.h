@@ -15,14 +15,17 @@
 #define LLVM_CLANG_BASIC_FILESYSTEMSTATCACHE_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include <cstdint>
 #include <ctime>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -83,6 +86,72 @@ public:
                           llvm::vfs::FileSystem &FS) override;
 };
 
+/// Thread-safe storage shared by all SharedStatCache instances created from
+/// it, so that stat results survive individual FileManagers and compiler
+/// instances.
+///
+/// Unlike MemorizeStatCalls this also records negative results: header
+/// probing walks every -I directory, so on network file systems most stat
+/// traffic is ENOENT and caching only successes leaves the expensive part
+/// uncached. Only absolute paths are stored, since instances sharing the
+/// storage may run with different working directories. Callers are
+/// responsible for not sharing storage across builds that modify the headers
+/// being probed.
+class SharedStatCacheStorage
+    : public llvm::RefCountedBase<SharedStatCacheStorage> {
+public:
+  /// Record a directory-listing snapshot of \p Dir. A single listing makes
+  /// every name under \p Dir known: lookups of paths inside it that did not
+  /// appear in the listing are answered as ENOENT without touching the file
+  /// system. \p Dir must be an absolute path; entries are keyed by the paths
+  /// the directory iterator produces, so \p Dir should be spelled the way
+  /// subsequent lookups will spell it.
+  void preloadDirectory(StringRef Dir, llvm::vfs::FileSystem &FS);
+
+private:
+  friend class SharedStatCache;
+
+  enum LookupResult { LR_Unknown, LR_Exists, LR_DoesNotExist };
+
+  LookupResult lookup(StringRef Path, llvm::vfs::Status &Status) const;
+  void noteExists(StringRef Path, const llvm::vfs::Status &Status);
+  void noteDoesNotExist(StringRef Path);
+
+  mutable std::mutex Mutex;
+
+  /// Successful stat results, keyed by absolute path.
+  llvm::StringMap<llvm::vfs::Status> PositiveEntries;
+
+  /// Absolute paths known not to exist.
+  llvm::StringSet<> NegativeEntries;
+
+  /// Directories whose full contents have been recorded by
+  /// preloadDirectory. A path whose parent is listed here and which is not
+  /// in \c ListedNames does not exist.
+  llvm::StringSet<> ListedDirs;
+
+  /// Names observed while listing the directories in \c ListedDirs.
+  llvm::StringSet<> ListedNames;
+};
+
+/// A stat cache backed by SharedStatCacheStorage. Install one instance per
+/// FileManager; all instances created from the same storage observe each
+/// other's results.
+class SharedStatCache : public FileSystemStatCache {
+public:
+  explicit SharedStatCache(
+      llvm::IntrusiveRefCntPtr<SharedStatCacheStorage> Storage)
+      : Storage(std::move(Storage)) {}
+
+  std::error_code getStat(StringRef Path, llvm::vfs::Status &Status,
+                          bool isFile,
+                          std::unique_ptr<llvm::vfs::File> *F,
+                          llvm::vfs::FileSystem &FS) override;
+
+private:
+  llvm::IntrusiveRefCntPtr<SharedStatCacheStorage> Storage;
+};
+
 } // namespace clang
 
 #endif // LLVM_CLANG_BASIC_FILESYSTEMSTATCACHE_H
@@ -482,6 +482,14 @@ public:
 /// This has no other purpose, but this is an extremely performance-critical
 /// piece of the code, as each occurrence of every identifier goes through
 /// here when lexed.
+///
+/// The table cannot be shared between the threads of a multi-TU tool, and
+/// not merely for lack of locking: the IdentifierInfo entries themselves
+/// carry per-translation-unit mutable state (the macro definition flags,
+/// the revertible token IDs, the frontend token info pointer), so two TUs
+/// interning the same string must still own separate entries. Sharing
+/// interned identifiers would first require splitting that state out of
+/// IdentifierInfo into a per-TU side table.
 class IdentifierTable {
   // Shark shows that using MallocAllocator is *much* slower than using this
   // BumpPtrAllocator!
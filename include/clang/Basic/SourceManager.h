@@ -149,18 +149,27 @@ namespace SrcMgr {
     /// after serialization and deserialization.
     unsigned IsTransient : 1;
 
+    /// True if the buffer is known to contain only bytes in the ASCII
+    /// range.
+    ///
+    /// Computed with a word-at-a-time scan when the buffer is loaded, so it
+    /// is only meaningful once getBuffer() has succeeded. The lexer uses it
+    /// to skip the UTF-8 handling paths entirely for plain ASCII files.
+    mutable unsigned IsPureASCII : 1;
+
     ContentCache(const FileEntry *Ent = nullptr) : ContentCache(Ent, Ent) {}
 
     ContentCache(const FileEntry *Ent, const FileEntry *contentEnt)
         : Buffer(nullptr, false), OrigEntry(Ent), ContentsEntry(contentEnt),
-          BufferOverridden(false), IsFileVolatile(false), IsTransient(false) {}
+          BufferOverridden(false), IsFileVolatile(false), IsTransient(false),
+          IsPureASCII(false) {}
 
     /// The copy ctor does not allow copies where source object has either
     /// a non-NULL Buffer or SourceLineCache.  Ownership of allocated memory
     /// is not transferred, so this is a logical error.
     ContentCache(const ContentCache &RHS)
         : Buffer(nullptr, false), BufferOverridden(false),
-          IsFileVolatile(false), IsTransient(false) {
+          IsFileVolatile(false), IsTransient(false), IsPureASCII(false) {
       OrigEntry = RHS.OrigEntry;
       ContentsEntry = RHS.ContentsEntry;
 
@@ -222,6 +231,13 @@ namespace SrcMgr {
       return Buffer.getInt() & InvalidFlag;
     }
 
+    /// Determine whether the loaded buffer contains only ASCII bytes.
+    ///
+    /// Returns false when the buffer has not been loaded yet.
+    bool isPureASCII() const {
+      return Buffer.getPointer() && IsPureASCII;
+    }
+
     /// Determine whether the buffer should be freed.
     bool shouldFreeBuffer() const {
       return (Buffer.getInt() & DoNotFreeFlag) == 0;
@@ -640,6 +656,15 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// expansion.
   SmallVector<SrcMgr::SLocEntry, 0> LocalSLocEntryTable;
 
+  /// The offsets of the entries of LocalSLocEntryTable, maintained in
+  /// parallel with it.
+  ///
+  /// getFileIDLocal only needs the offsets, and searching this densely packed
+  /// array touches a fraction of the cache lines that striding through the
+  /// much larger SLocEntrys does; getFileID is one of the hottest functions
+  /// in diagnostics-heavy and indexing workloads.
+  SmallVector<unsigned, 0> LocalSLocOffsetTable;
+
   /// The table of SLocEntries that are loaded from other modules.
   ///
   /// Negative FileIDs are indexes into this table. To get from ID to an index,
@@ -688,6 +713,16 @@ class SourceManager : public RefCountedBase<SourceManager> {
   mutable unsigned LastLineNoFilePos;
   mutable unsigned LastLineNoResult;
 
+  /// These ivars serve as a cache in getPresumedLoc, which diagnostics
+  /// emission tends to hit repeatedly with the same location (every piece of
+  /// an analyzer path resolves its anchor statement again). The cache is
+  /// invalidated when a #line directive is added, since the result depends
+  /// on the line table.
+  mutable FileID LastPresumedFileIDQuery;
+  mutable unsigned LastPresumedOffset;
+  mutable bool LastPresumedUseLineDirectives;
+  mutable PresumedLoc LastPresumedResult;
+
   /// The file ID for the main source file of the translation unit.
   FileID MainFileID;
 
@@ -1012,6 +1047,14 @@ public:
   /// \param Invalid If non-NULL, will be set true if an error occurred.
   StringRef getBufferData(FileID FID, bool *Invalid = nullptr) const;
 
+  /// Return true if the buffer for \p FID has been loaded and is known to
+  /// contain only ASCII bytes.
+  ///
+  /// This is conservative: it returns false for buffers that have not been
+  /// read in yet, so callers may only use it to select a fast path, never
+  /// to change behavior.
+  bool isBufferPureASCII(FileID FID) const;
+
   /// Get the number of FileIDs (files and macros) that were created
   /// during preprocessing of \p FID, including it.
   unsigned getNumCreatedFIDsForFileID(FileID FID) const {
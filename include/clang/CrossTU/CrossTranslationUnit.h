@@ -21,6 +21,8 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <list>
 
 namespace clang {
 class CompilerInstance;
@@ -90,6 +92,64 @@ parseCrossTUIndex(StringRef IndexPath, StringRef CrossTUDir);
 
 std::string createCrossTUIndexString(const llvm::StringMap<std::string> &Index);
 
+/// Collects the external definition map entries of the main file of \p Ctx
+/// into \p Index: the USR of every externally visible definition located in
+/// the main file is mapped to the main file's path.
+void collectCrossTUIndex(ASTContext &Ctx, llvm::StringMap<std::string> &Index);
+
+/// Writes \p Index to \p OS in the binary index format.
+///
+/// The binary format avoids the line-by-line parsing and the eager
+/// materialization of a map that the text format requires at every analyzer
+/// startup; see BinaryCrossTUIndex for the layout and the lookup strategy.
+void writeBinaryCrossTUIndex(llvm::raw_ostream &OS,
+                             const llvm::StringMap<std::string> &Index);
+
+/// A zero-copy view of an external definition index file in the binary
+/// format.
+///
+/// The layout of the file is a 12 byte header (the "CTUI" magic, a version
+/// number and the number of entries, both 32 bit little-endian), followed by
+/// the entry table and a string table of null-terminated strings. An entry is
+/// a pair of 32 bit little-endian offsets into the string table: the USR of a
+/// definition and the path of the file containing it. The entries are sorted
+/// by the USR string, so a lookup is a binary search over the memory mapped
+/// file and no map has to be materialized up front. Since the mapping is
+/// read-only and never copied, analyzer processes running concurrently on
+/// the same index share a single set of physical pages.
+class BinaryCrossTUIndex {
+public:
+  /// Returns true if the file at \p IndexPath starts with the magic bytes of
+  /// the binary index format.
+  static bool isBinaryIndexFile(StringRef IndexPath);
+
+  /// Memory-maps the index file at \p IndexPath and validates its header.
+  /// Relative file paths stored in the index are interpreted relative to
+  /// \p CrossTUDir, like in the text format.
+  static llvm::Expected<BinaryCrossTUIndex> load(StringRef IndexPath,
+                                                 StringRef CrossTUDir);
+
+  /// Looks up the path of the file which contains the definition of
+  /// \p LookupName, or returns empty if the index has no such entry.
+  llvm::Optional<std::string> lookup(StringRef LookupName) const;
+
+private:
+  BinaryCrossTUIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
+                     uint32_t NumEntries, StringRef CrossTUDir)
+      : Buffer(std::move(Buffer)), NumEntries(NumEntries),
+        CrossTUDir(CrossTUDir) {}
+
+  /// Returns the string at \p Offset of the string table, or an empty string
+  /// for out of bounds offsets in a corrupt index.
+  StringRef getString(uint32_t Offset) const;
+
+  enum : size_t { HeaderSize = 12, EntrySize = 8 };
+
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  uint32_t NumEntries;
+  std::string CrossTUDir;
+};
+
 // Returns true if the variable or any field of a record variable is const.
 bool containsConst(const VarDecl *VD, const ASTContext &ACtx);
 
@@ -199,6 +259,9 @@ private:
   ImporterMapTy ASTUnitImporterMap;
 
   ASTContext &Context;
+  /// Whether the importers are created in minimal-import mode. Set up from
+  /// the 'ctu-minimal-import' analyzer option.
+  bool MinimalImport;
   std::shared_ptr<ASTImporterSharedState> ImporterSharedSt;
   /// Map of imported FileID's (in "To" context) to FileID in "From" context
   /// and the ASTUnit for the From context.
@@ -272,13 +335,31 @@ private:
                                                    StringRef CrossTUDir,
                                                    StringRef IndexName);
 
+    /// Hands over the units evicted by the 'ctu-ast-cache-size' budget since
+    /// the last call. The owner of the storage is expected to release any
+    /// state referring to these units (importers, imported FileID entries),
+    /// so that the last reference is dropped and the memory is reclaimed.
+    std::vector<std::shared_ptr<clang::ASTUnit>> takeEvictedUnits();
+
   private:
     llvm::Error ensureCTUIndexLoaded(StringRef CrossTUDir, StringRef IndexName);
     llvm::Expected<ASTUnit *> getASTUnitForFile(StringRef FileName,
                                                 bool DisplayCTUProgress);
 
+    /// Looks up the path of the file containing the definition of
+    /// \p FunctionName in the index, regardless of the index format.
+    llvm::Optional<std::string> lookupName(StringRef FunctionName) const;
+
+    /// Move \p FileName to the front of the recency list, inserting it if it
+    /// was not tracked yet.
+    void markRecentlyUsed(StringRef FileName);
+
+    /// Enforce the 'ctu-ast-cache-size' budget: move the least recently used
+    /// units over the budget from the cache maps to the evicted list.
+    void evictOverBudget();
+
     template <typename... T> using BaseMapTy = llvm::StringMap<T...>;
-    using OwningMapTy = BaseMapTy<std::unique_ptr<clang::ASTUnit>>;
+    using OwningMapTy = BaseMapTy<std::shared_ptr<clang::ASTUnit>>;
     using NonOwningMapTy = BaseMapTy<clang::ASTUnit *>;
 
     OwningMapTy FileASTUnitMap;
@@ -287,8 +368,33 @@ private:
     using IndexMapTy = BaseMapTy<std::string>;
     IndexMapTy NameFileMap;
 
+    /// The index in the binary format, if 'ctu-index-name' points to such a
+    /// file. Lookups are served directly from the memory mapped index
+    /// instead of the eagerly filled \p NameFileMap.
+    llvm::Optional<BinaryCrossTUIndex> LazyIndex;
+
     ASTFileLoader FileAccessor;
 
+    /// Whether the loaded ASTUnits should also be registered in the process
+    /// wide cache, so other CrossTranslationUnitContext instances can reuse
+    /// them without paying the deserialization cost again.
+    bool ShareLoadedASTs;
+
+    /// The maximal number of units kept materialized; 0 means no limit.
+    /// See the 'ctu-ast-cache-size' analyzer-config option.
+    unsigned ASTCacheSize;
+
+    /// File names of the loaded units, most recently used first. Units
+    /// falling off the end of this list are evicted when over budget.
+    std::list<std::string> RecencyList;
+
+    /// Maps a file name to its position in \p RecencyList.
+    BaseMapTy<std::list<std::string>::iterator> RecencyPos;
+
+    /// Units evicted from the cache maps but possibly still referenced by the
+    /// owning CrossTranslationUnitContext; drained by takeEvictedUnits.
+    std::vector<std::shared_ptr<clang::ASTUnit>> EvictedUnits;
+
     /// Limit the number of loaded ASTs. Used to limit the  memory usage of the
     /// CrossTranslationUnitContext.
     /// The ASTUnitStorage has the knowledge about if the AST to load is
@@ -0,0 +1,44 @@
+//===--- ExtDefMapGen.h - Emit the extdef map while compiling ---*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares a frontend action adaptor which emits the external
+//  definition map entries of a translation unit as a side output of a normal
+//  compilation, so building the cross translation unit index does not require
+//  a separate pass with clang-extdef-mapping over the whole codebase.
+//
+//===----------------------------------------------------------------------===//
+#ifndef LLVM_CLANG_CROSSTU_EXTDEFMAPGEN_H
+#define LLVM_CLANG_CROSSTU_EXTDEFMAPGEN_H
+
+#include "clang/Frontend/FrontendAction.h"
+
+namespace clang {
+namespace cross_tu {
+
+/// Wraps a frontend action so that, in addition to the wrapped action's
+/// consumer, the compilation collects the external definition map entries of
+/// the main file and writes them in the text index format to \p OutputPath.
+/// The collection shares the parse with the wrapped action, so its marginal
+/// cost is a single walk over the already built AST.
+class GenerateExtDefMapAction : public WrapperFrontendAction {
+public:
+  GenerateExtDefMapAction(std::unique_ptr<FrontendAction> WrappedAction,
+                          StringRef OutputPath);
+
+protected:
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
+                                                 StringRef InFile) override;
+
+private:
+  std::string OutputPath;
+};
+
+} // namespace cross_tu
+} // namespace clang
+
+#endif // LLVM_CLANG_CROSSTU_EXTDEFMAPGEN_H
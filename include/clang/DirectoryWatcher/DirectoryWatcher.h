@@ -11,6 +11,7 @@
 
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
@@ -108,6 +109,31 @@ public:
              Receiver,
          bool WaitForInitialSync);
 
+  /// Like create(), but absorbs event storms before delivery.
+  ///
+  /// Raw kernel events are buffered until the directory has been quiet for
+  /// \p SettleDuration, then delivered as one batch with at most one event
+  /// per file. If a single batch accumulates more than \p RescanThreshold
+  /// raw events (a git branch switch, a cache prune), the directory is
+  /// re-listed and re-stated in one pass instead and the batch is the diff
+  /// against the previously delivered state, so the receiver does work
+  /// proportional to the number of changed files rather than the number of
+  /// kernel events. Events about the watched directory itself (removal,
+  /// invalidation) are flushed immediately.
+  ///
+  /// The initial scan is delivered unchanged. Ordering between events for
+  /// different files within a batch is not preserved.
+  static std::unique_ptr<DirectoryWatcher>
+  createCoalescing(llvm::StringRef Path,
+                   std::function<void(
+                       llvm::ArrayRef<DirectoryWatcher::Event> Events,
+                       bool IsInitial)>
+                       Receiver,
+                   bool WaitForInitialSync,
+                   std::chrono::milliseconds SettleDuration =
+                       std::chrono::milliseconds(100),
+                   size_t RescanThreshold = 1024);
+
   virtual ~DirectoryWatcher() = default;
   DirectoryWatcher(const DirectoryWatcher &) = delete;
   DirectoryWatcher &operator=(const DirectoryWatcher &) = delete;
@@ -199,6 +199,12 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// Pointer to the ExecuteCC1Tool function, if the driver is capable of
+  /// running the -cc1 tool within this process. Jobs are then constructed as
+  /// CC1Command and avoid launching a new process per compilation.
+  using CC1ToolFunc = int (*)(SmallVectorImpl<const char *> &ArgV);
+  CC1ToolFunc CC1Main = nullptr;
+
 private:
   /// Raw target triple.
   std::string TargetTriple;
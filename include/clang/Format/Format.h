@@ -2165,6 +2165,51 @@ tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
                                StringRef FileName,
                                bool *IncompleteFormat);
 
+/// Remembers the input of the previous ``reformatIncremental()`` call so
+/// that the next call can restrict formatting to the lines that actually
+/// changed.
+///
+/// Intended for long-lived processes (editor daemons, format-on-save hooks)
+/// that reformat the same buffer repeatedly after small edits. A cache
+/// instance is valid for one file; use one instance per open file.
+class IncrementalFormatCache {
+  friend tooling::Replacements
+  reformatIncremental(const FormatStyle &Style, StringRef Code,
+                      IncrementalFormatCache &Cache, StringRef FileName,
+                      FormattingAttemptStatus *Status);
+
+  /// The code of the previous call.
+  std::string PreviousCode;
+
+  /// The style of the previous call; a style change invalidates the cache.
+  FormatStyle PreviousStyle;
+
+  /// The replacements computed by the previous call, returned again when the
+  /// input is byte-identical.
+  tooling::Replacements PreviousResult;
+
+  /// The formatting status of the previous call.
+  FormattingAttemptStatus PreviousStatus;
+
+  /// False until the first call populates the cache.
+  bool Valid = false;
+};
+
+/// Reformats \p Code like ``reformat()``, but derives the ranges to format
+/// from the difference between \p Code and the input of the previous call
+/// that used the same \p Cache.
+///
+/// Only the whole lines that changed since the previous call (and whatever
+/// their formatting influences, see ``reformat()``) are formatted, so
+/// repeated calls after small edits skip the expensive layout optimization
+/// for the unchanged part of the buffer. The first call with a fresh cache,
+/// and any call with a changed \p Style, formats \p Code as a whole.
+tooling::Replacements
+reformatIncremental(const FormatStyle &Style, StringRef Code,
+                    IncrementalFormatCache &Cache,
+                    StringRef FileName = "<stdin>",
+                    FormattingAttemptStatus *Status = nullptr);
+
 /// Clean up any erroneous/redundant code in the given \p Ranges in \p
 /// Code.
 ///
@@ -237,6 +237,17 @@ private:
   /// when any errors are present.
   unsigned NumWarningsInPreamble = 0;
 
+  /// The size and modification time of every on-disk file the last
+  /// successful reparse read, keyed by file name. Together with
+  /// \c LastParseUnsavedBuffersHash this describes the complete input of
+  /// that reparse; \c Reparse skips re-parsing entirely when none of it
+  /// changed. Empty when no such snapshot is available.
+  llvm::StringMap<std::pair<uint64_t, int64_t>> LastParseInputStats;
+
+  /// A hash of the names and contents of the unsaved file buffers the last
+  /// successful reparse used.
+  uint64_t LastParseUnsavedBuffersHash = 0;
+
   /// A list of the serialization ID numbers for each of the top-level
   /// declarations parsed within the precompiled preamble.
   std::vector<serialization::DeclID> TopLevelDeclsInPreamble;
@@ -717,6 +728,16 @@ private:
       unsigned PrecompilePreambleAfterNParses,
       IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS);
 
+  /// Returns true if the inputs of a reparse - the unsaved file buffers and
+  /// the on-disk files the last successful reparse read - are unchanged, so
+  /// re-parsing can be skipped and the current AST kept.
+  bool isReparseInputUnchanged(ArrayRef<RemappedFile> RemappedFiles,
+                               llvm::vfs::FileSystem &VFS) const;
+
+  /// Record the input snapshot of a just finished successful reparse for
+  /// \c isReparseInputUnchanged.
+  void captureReparseInputSnapshot(ArrayRef<RemappedFile> RemappedFiles);
+
 public:
   /// Create an ASTUnit from a source file, via a CompilerInvocation
   /// object, by invoking the optionally provided ASTFrontendAction.
@@ -813,6 +834,20 @@ public:
   /// it(i.e., be an overlay over RealFileSystem). RealFileSystem will be used
   /// if \p VFS is nullptr.
   ///
+  /// \param PooledInvocation - If non-null, a slot of an invocation pool.
+  /// When the slot holds an invocation, the driver is skipped and that
+  /// invocation, which the caller must be willing to have adjusted, is
+  /// parsed directly; when the slot is empty, the driver is run as usual
+  /// and a pristine copy of the resulting invocation is stored into the
+  /// slot, so the caller can remember it for the next identical command
+  /// line.
+  ///
+  /// \param PooledDriverDiags - Storage for the diagnostics the driver
+  /// emits while resolving the command line. When the pool slot is filled,
+  /// the contents are replayed into the unit's stored diagnostics in place
+  /// of running the driver; when the slot is empty, the captured driver
+  /// diagnostics are copied out for pooling alongside the invocation.
+  ///
   // FIXME: Move OnlyLocalDecls, UseBumpAllocator to setters on the ASTUnit, we
   // shouldn't need to specify them at construction time.
   static ASTUnit *LoadFromCommandLine(
@@ -834,7 +869,9 @@ public:
       bool ForSerialization = false,
       llvm::Optional<StringRef> ModuleFormat = llvm::None,
       std::unique_ptr<ASTUnit> *ErrAST = nullptr,
-      IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS = nullptr);
+      IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS = nullptr,
+      std::shared_ptr<CompilerInvocation> *PooledInvocation = nullptr,
+      SmallVectorImpl<StoredDiagnostic> *PooledDriverDiags = nullptr);
 
   /// Reparse the source files using the same command-line options that
   /// were originally used to produce this translation unit.
@@ -15,6 +15,7 @@
 
 namespace clang {
 
+class DependencyCollector;
 class Module;
 class FileEntry;
 
@@ -75,6 +76,14 @@ protected:
 };
 
 class GeneratePCHAction : public ASTFrontendAction {
+  /// Collects every file read while building the PCH when the
+  /// content-addressed PCH cache is in use; null otherwise.
+  std::shared_ptr<DependencyCollector> CacheDepCollector;
+
+  /// The cache key of the PCH being built; empty when the cache is disabled
+  /// or the key could not be computed.
+  std::string CacheKey;
+
 protected:
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  StringRef InFile) override;
@@ -102,6 +111,10 @@ public:
                    std::string &OutputFile);
 
   bool BeginSourceFileAction(CompilerInstance &CI) override;
+
+  /// In addition to finalizing the output file, publishes the generated PCH
+  /// in the content-addressed cache when one is configured.
+  void EndSourceFile() override;
 };
 
 class GenerateModuleAction : public ASTFrontendAction {
@@ -316,6 +316,10 @@ public:
   /// Whether timestamps should be written to the produced PCH file.
   unsigned IncludeTimestamps : 1;
 
+  /// Whether -verify-pch should deserialize the entire contents of the AST
+  /// file rather than only checking its structure and dependencies.
+  unsigned VerifyPCHFull : 1;
+
   CodeCompleteOptions CodeCompleteOpts;
 
   /// Specifies the output format of the AST.
@@ -397,6 +401,12 @@ public:
   /// The output file, if any.
   std::string OutputFile;
 
+  /// If given, the directory of a content-addressed cache of generated PCH
+  /// files shared between compiler processes. An entry is keyed by the hash
+  /// of the invocation and the main file content and is guarded by a
+  /// manifest of the content hashes of every file read while building it.
+  std::string PCHCacheDir;
+
   /// If given, the new suffix for fix-it rewritten files.
   std::string FixItSuffix;
 
@@ -451,6 +461,13 @@ public:
   /// Filename to write statistics to.
   std::string StatsFile;
 
+  /// If given, the file to write the external definition map entries of the
+  /// translation unit to, as a side output of the main action.
+  std::string ExtDefMapOutput;
+
+  /// If given, the file to write a JSON breakdown of AST memory usage to.
+  std::string ASTMemoryProfileOutput;
+
 public:
   FrontendOptions()
       : DisableFree(false), RelocatablePCH(false), ShowHelp(false),
@@ -461,7 +478,7 @@ public:
         UseGlobalModuleIndex(true), GenerateGlobalModuleIndex(true),
         ASTDumpDecls(false), ASTDumpLookups(false),
         BuildingImplicitModule(false), ModulesEmbedAllFiles(false),
-        IncludeTimestamps(true) {}
+        IncludeTimestamps(true), VerifyPCHFull(false) {}
 
   /// getInputKindForExtension - Return the appropriate input kind for a file
   /// extension. For example, "c" would return InputKind::C.
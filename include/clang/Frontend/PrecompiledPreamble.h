@@ -16,6 +16,7 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/AlignOf.h"
 #include "llvm/Support/MD5.h"
 #include <cstddef>
@@ -164,7 +165,11 @@ private:
 
   class InMemoryPreamble {
   public:
-    std::string Data;
+    /// The serialized AST, taken directly from the PCH generator's buffer so
+    /// that building an in-memory preamble never copies the bitstream. The
+    /// buffer is guaranteed to be followed by a null terminator so it can be
+    /// exposed as a file through a VFS overlay.
+    llvm::SmallVector<char, 0> Data;
   };
 
   class PCHStorage {
@@ -0,0 +1,74 @@
+//===--- PreprocessedOutputCache.h - Cache for -E output --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  A content-addressed on-disk cache for preprocessed output. Tooling that
+//  repeatedly preprocesses unchanged translation units (lint pipelines,
+//  metrics jobs) can replay the output of an earlier run instead of
+//  preprocessing again.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_PREPROCESSEDOUTPUTCACHE_H
+#define LLVM_CLANG_FRONTEND_PREPROCESSEDOUTPUTCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace clang {
+
+class CompilerInvocation;
+
+/// An on-disk cache of preprocessed output, keyed by a hash of the
+/// invocation and validated against the contents of every file the
+/// preprocessor read.
+///
+/// Each entry consists of the preprocessed output and a manifest listing the
+/// content hash of every transitively included file (system headers
+/// included). An entry is replayed only if every listed file still hashes to
+/// the recorded value, so the cache never needs explicit invalidation; stale
+/// entries simply stop matching. PrintPreprocessedAction consults the cache
+/// when the -preprocessed-output-cache cc1 option names a directory, and
+/// in-process tools running that action through the tooling library get the
+/// same behavior from their invocations.
+class PreprocessedOutputCache {
+  std::string Path;
+
+public:
+  explicit PreprocessedOutputCache(StringRef Path) : Path(Path) {}
+
+  /// Compute the cache key for preprocessing \p MainFile under
+  /// \p Invocation. The key covers the language, target, header search and
+  /// preprocessor options as well as the output format flags; anything the
+  /// key does not cover but the output depends on is caught by the manifest
+  /// check in replay().
+  static std::string computeKey(const CompilerInvocation &Invocation,
+                                StringRef MainFile);
+
+  /// If the cache holds an entry for \p Key whose manifest still matches the
+  /// on-disk contents of every recorded file, write the cached output to
+  /// \p OS and return true.
+  bool replay(StringRef Key, raw_ostream &OS);
+
+  /// Record \p Output for \p Key, together with a manifest of the current
+  /// content hashes of \p Dependencies. Failures are silently ignored; the
+  /// cache is an optimization and the output has already been produced.
+  void store(StringRef Key, StringRef Output,
+             ArrayRef<std::string> Dependencies);
+
+private:
+  /// Hash the current contents of \p File into \p Hex. Returns false if the
+  /// file cannot be read.
+  static bool hashFileContents(StringRef File, SmallString<32> &Hex);
+};
+
+} // end namespace clang
+
+#endif
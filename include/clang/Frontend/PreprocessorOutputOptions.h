@@ -9,6 +9,8 @@
 #ifndef LLVM_CLANG_FRONTEND_PREPROCESSOROUTPUTOPTIONS_H
 #define LLVM_CLANG_FRONTEND_PREPROCESSOROUTPUTOPTIONS_H
 
+#include <string>
+
 namespace clang {
 
 /// PreprocessorOutputOptions - Options for controlling the C preprocessor
@@ -25,6 +27,10 @@ public:
   unsigned RewriteIncludes : 1;    ///< Preprocess include directives only.
   unsigned RewriteImports  : 1;    ///< Include contents of transitively-imported modules.
 
+  /// If non-empty, the directory of the on-disk cache preprocessed output is
+  /// stored in and replayed from (see PreprocessedOutputCache).
+  std::string CachePath;
+
 public:
   PreprocessorOutputOptions() {
     ShowCPP = 0;
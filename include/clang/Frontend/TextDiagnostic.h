@@ -16,6 +16,7 @@
 #define LLVM_CLANG_FRONTEND_TEXTDIAGNOSTIC_H
 
 #include "clang/Frontend/DiagnosticRenderer.h"
+#include <memory>
 
 namespace clang {
 
@@ -31,9 +32,25 @@ namespace clang {
 /// beautiful text diagnostics from any particular interfaces. The Clang
 /// DiagnosticClient is implemented through this class as is diagnostic
 /// printing coming out of libclang.
+struct SourceColumnMap;
+
 class TextDiagnostic : public DiagnosticRenderer {
   raw_ostream &OS;
 
+  /// A cache of the most recently extracted snippet line and its
+  /// byte-to-column map (which owns a copy of the line's text). Runs of
+  /// diagnostics pointing into the same line — macro argument notes,
+  /// template instantiation chains — re-render the same source line, and
+  /// the extraction and column map computation are the parts of that work
+  /// that do not depend on the individual diagnostic.
+  FileID CachedLineFID;
+  unsigned CachedLineNo = 0;
+  std::unique_ptr<SourceColumnMap> CachedColMap;
+
+  /// The number of diagnostics this renderer emitted a snippet for, for
+  /// enforcing -fcaret-diagnostics-max-count.
+  unsigned NumSnippetsEmitted = 0;
+
 public:
   TextDiagnostic(raw_ostream &OS,
                  const LangOptions &LangOpts,
@@ -0,0 +1,102 @@
+//===--- BatchingIndexDataConsumer.h - Async occurrence delivery -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_INDEX_BATCHINGINDEXDATACONSUMER_H
+#define LLVM_CLANG_INDEX_BATCHINGINDEXDATACONSUMER_H
+
+#include "clang/Index/IndexDataConsumer.h"
+#include "llvm/ADT/SmallVector.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace clang {
+namespace index {
+
+/// Decouples AST traversal from a slow (typically I/O-bound) index consumer.
+///
+/// Occurrences are recorded into a bounded queue on the indexing thread and
+/// replayed to the wrapped consumer on a single background thread, so that
+/// the consumer writing its output does not stall traversal. When the queue
+/// is full the indexing thread blocks until the consumer catches up.
+///
+/// The wrapped consumer's handle* callbacks run on the background thread
+/// while the frontend may still be parsing, so they must not inspect the AST
+/// beyond using the passed pointers as opaque keys; consumers that need to
+/// walk the AST (or generate USRs, which can deserialize) must resolve that
+/// data elsewhere or stay synchronous. initialize(), setPreprocessor() and
+/// finish() are forwarded on the indexing thread when no occurrences are in
+/// flight. finish() drains the queue before forwarding.
+///
+/// If the wrapped consumer aborts, the abort takes effect on the indexing
+/// thread as soon as the next occurrence is recorded.
+class BatchingIndexDataConsumer : public IndexDataConsumer {
+public:
+  explicit BatchingIndexDataConsumer(std::shared_ptr<IndexDataConsumer> Next,
+                                     size_t MaxQueuedOccurrences = 8192);
+  ~BatchingIndexDataConsumer() override;
+
+  void initialize(ASTContext &Ctx) override;
+  void setPreprocessor(std::shared_ptr<Preprocessor> PP) override;
+  bool handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
+                           ArrayRef<SymbolRelation> Relations,
+                           SourceLocation Loc, ASTNodeInfo ASTNode) override;
+  bool handleMacroOccurence(const IdentifierInfo *Name, const MacroInfo *MI,
+                            SymbolRoleSet Roles, SourceLocation Loc) override;
+  bool handleModuleOccurence(const ImportDecl *ImportD, const Module *Mod,
+                             SymbolRoleSet Roles, SourceLocation Loc) override;
+  void finish() override;
+
+private:
+  /// A self-contained copy of one handle* invocation.
+  struct Occurrence {
+    enum OccurrenceKind { Decl, Macro, Module } Kind;
+    SymbolRoleSet Roles;
+    SourceLocation Loc;
+    const clang::Decl *D = nullptr;
+    llvm::SmallVector<SymbolRelation, 3> Relations;
+    ASTNodeInfo ASTNode = {nullptr, nullptr, nullptr, nullptr};
+    const IdentifierInfo *MacroName = nullptr;
+    const MacroInfo *MI = nullptr;
+    const ImportDecl *ImportD = nullptr;
+    const clang::Module *Mod = nullptr;
+  };
+
+  /// Blocks while the queue is full; returns false once the wrapped
+  /// consumer has asked to abort.
+  bool enqueue(Occurrence &&O);
+
+  /// Waits until every queued occurrence has been replayed.
+  void drain();
+
+  /// Replays one occurrence to the wrapped consumer.
+  bool deliver(const Occurrence &O);
+
+  void consumeLoop();
+
+  std::shared_ptr<IndexDataConsumer> Next;
+  const size_t MaxQueued;
+
+  std::mutex Mutex;
+  std::condition_variable QueueNotEmpty;
+  std::condition_variable QueueNotFull;
+  std::deque<Occurrence> Queue;
+  bool DoneEnqueueing = false;
+  unsigned NumInFlight = 0;
+
+  std::atomic<bool> Aborted{false};
+  std::thread Consumer;
+};
+
+} // namespace index
+} // namespace clang
+
+#endif // LLVM_CLANG_INDEX_BATCHINGINDEXDATACONSUMER_H
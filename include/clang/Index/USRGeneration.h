@@ -10,7 +10,9 @@
 #define LLVM_CLANG_INDEX_USRGENERATION_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
 
 namespace clang {
 class ASTContext;
@@ -31,6 +33,22 @@ static inline StringRef getUSRSpacePrefix() {
 /// \returns true if the results should be ignored, false otherwise.
 bool generateUSRForDecl(const Decl *D, SmallVectorImpl<char> &Buf);
 
+/// Interns USRs per declaration so that clients which ask for the same
+/// decls over and over - indexers, most notably - do not pay for full
+/// recomputation each time. Generation through the cache also reuses the
+/// already-interned USR of an enclosing namespace as the prefix of the
+/// nested declarations' USRs instead of re-printing the chain.
+class USRCache {
+  llvm::BumpPtrAllocator Alloc;
+  llvm::DenseMap<const Decl *, StringRef> USRs;
+
+public:
+  /// Returns the USR for the canonical declaration of \p D, computing and
+  /// interning it on first use. Returns an empty StringRef if no USR can be
+  /// generated. The result lives as long as the cache.
+  StringRef getUSR(const Decl *D);
+};
+
 /// Generate a USR fragment for an Objective-C class.
 void generateUSRForObjCClass(StringRef Cls, raw_ostream &OS,
                              StringRef ExtSymbolDefinedIn = "",
@@ -0,0 +1,67 @@
+//===--- CompactTokenBuffer.h - Byte-packed token storage -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the CompactTokenBuffer interface.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_COMPACTTOKENBUFFER_H
+#define LLVM_CLANG_LEX_COMPACTTOKENBUFFER_H
+
+#include "clang/Lex/Token.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace clang {
+
+class IdentifierInfo;
+
+/// A byte-packed store for a cached token sequence.
+///
+/// A Token is 24 bytes, but most of its content is small: the kind and flags
+/// fit in a few bits, the length of a token is short, the location is usually
+/// close to the previous token's, and the identifier pointers of a sequence
+/// repeat heavily. CompactTokenBuffer stores a token sequence as a byte
+/// stream of variable-length integers - delta-encoded raw source locations
+/// and identifier pointers interned into a per-buffer table - which shrinks
+/// the dominant cost of caches that hold on to whole function bodies, such
+/// as the late-parsed templates of -fdelayed-template-parsing.
+///
+/// Annotation tokens carry a second location and an opaque pointer and are
+/// not produced by raw caching; a sequence containing one is kept verbatim
+/// instead of packed.
+class CompactTokenBuffer {
+public:
+  bool empty() const { return NumTokens == 0; }
+  unsigned size() const { return NumTokens; }
+
+  /// Replaces the contents of the buffer with a packed copy of \p Toks.
+  void encode(ArrayRef<Token> Toks);
+
+  /// Appends the stored token sequence to \p Out.
+  void decode(SmallVectorImpl<Token> &Out) const;
+
+private:
+  bool tryEncode(ArrayRef<Token> Toks);
+
+  /// The packed byte stream.
+  SmallVector<uint8_t, 0> Packed;
+
+  /// The identifiers referenced by the packed stream, indexed in order of
+  /// first use.
+  SmallVector<IdentifierInfo *, 0> Idents;
+
+  /// Fallback storage for sequences that cannot be packed.
+  CachedTokens Raw;
+
+  unsigned NumTokens = 0;
+};
+
+} // namespace clang
+
+#endif // LLVM_CLANG_LEX_COMPACTTOKENBUFFER_H
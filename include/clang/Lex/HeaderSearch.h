@@ -175,6 +175,15 @@ class HeaderSearch {
   unsigned SystemDirIdx = 0;
   bool NoCurDirSearch = false;
 
+  /// A hash identifying the contents of SearchDirs, used to share lookup
+  /// results between the compiler instances of one process that were set up
+  /// with the same search path list. Zero when it has not been computed
+  /// since the last search path change.
+  mutable uint64_t SearchPathSignature = 0;
+
+  /// Compute (and cache) \c SearchPathSignature.
+  uint64_t getSearchPathSignature() const;
+
   /// \#include prefixes for which the 'system header' property is
   /// overridden.
   ///
@@ -281,6 +290,7 @@ public:
     AngledDirIdx = angledDirIdx;
     SystemDirIdx = systemDirIdx;
     NoCurDirSearch = noCurDirSearch;
+    SearchPathSignature = 0;
     //LookupFileCache.clear();
   }
 
@@ -291,6 +301,7 @@ public:
     if (!isAngled)
       AngledDirIdx++;
     SystemDirIdx++;
+    SearchPathSignature = 0;
   }
 
   /// Set the list of system header prefixes.
@@ -192,6 +192,10 @@ public:
   /// \c BuildSessionTimestamp).
   unsigned ModulesValidateOncePerBuildSession : 1;
 
+  /// If true, skip verifying the input files of a PCH that was built
+  /// during the current build session (see \c BuildSessionTimestamp).
+  unsigned PCHValidateOncePerBuildSession : 1;
+
   /// Whether to validate system input files when a module is loaded.
   unsigned ModulesValidateSystemHeaders : 1;
 
@@ -202,14 +206,23 @@ public:
 
   unsigned ModulesHashContent : 1;
 
+  /// Share header lookup hit indices across the HeaderSearch instances of
+  /// this process. The shared memo is never invalidated, so only batch tools
+  /// whose search directories do not change for the lifetime of the process
+  /// (e.g. one CompilerInstance per TU over a fixed -I set) should opt in;
+  /// long-lived hosts such as IDE sessions must leave it off.
+  unsigned SharedLookupHitCache : 1;
+
   HeaderSearchOptions(StringRef _Sysroot = "/")
       : Sysroot(_Sysroot), ModuleFormat("raw"), DisableModuleHash(false),
         ImplicitModuleMaps(false), ModuleMapFileHomeIsCwd(false),
         UseBuiltinIncludes(true), UseStandardSystemIncludes(true),
         UseStandardCXXIncludes(true), UseLibcxx(false), Verbose(false),
         ModulesValidateOncePerBuildSession(false),
+        PCHValidateOncePerBuildSession(false),
         ModulesValidateSystemHeaders(false), UseDebugInfo(false),
-        ModulesValidateDiagnosticOptions(true), ModulesHashContent(false) {}
+        ModulesValidateDiagnosticOptions(true), ModulesHashContent(false),
+        SharedLookupHitCache(false) {}
 
   /// AddPath - Add the \p Path path to the specified \p Group list.
   void AddPath(StringRef Path, frontend::IncludeDirGroup Group,
@@ -96,6 +96,12 @@ class Lexer : public PreprocessorLexer {
   // True if lexer for _Pragma handling.
   bool Is_PragmaLexer;
 
+  // True if the whole buffer is known to contain only ASCII bytes, as
+  // precomputed by the SourceManager when the buffer was loaded.  When set,
+  // the UTF-8 handling paths in the lexer are unreachable and are skipped.
+  // Conservatively false when the buffer is unknown to the SourceManager.
+  bool IsPureASCIIBuffer;
+
   //===--------------------------------------------------------------------===//
   // Context-specific lexing flags set by the preprocessor.
   //
@@ -676,6 +682,22 @@ private:
 
   void SetByteOffset(unsigned Offset, bool StartOfLine);
 
+  /// Returns the current lexing offset.
+  unsigned getCurrentBufferOffset() {
+    assert(BufferPtr >= BufferStart && "Invalid buffer state");
+    return BufferPtr - BufferStart;
+  }
+
+  /// Skip over \p NumBytes bytes.
+  ///
+  /// If the skip is successful, the next token will be lexed from the new
+  /// offset. The lexer also assumes that a skip of NumBytes bytes will leave
+  /// it at the start of a line.
+  ///
+  /// \returns true if the skip failed (new offset would have been past the
+  /// end of the buffer), false otherwise.
+  bool skipOver(unsigned NumBytes);
+
   void PropagateLineStartLeadingSpaceInfo(Token &Result);
 
   const char *LexUDSuffix(Token &Result, const char *CurPtr,
@@ -64,6 +64,11 @@ class MacroInfo {
   mutable unsigned DefinitionLength;
   mutable bool IsDefinitionLengthCached : 1;
 
+  /// Whether the replacement tokens can be replayed verbatim on expansion;
+  /// see isReplayableExpansion().
+  mutable bool IsReplayableExpansion : 1;
+  mutable bool IsReplayableExpansionCached : 1;
+
   /// True if this macro is function-like, false if it is object-like.
   bool IsFunctionLike : 1;
 
@@ -135,6 +140,19 @@ public:
     return getDefinitionLengthSlow(SM);
   }
 
+  /// Return true if expanding this macro amounts to replaying its
+  /// replacement tokens verbatim: it is object-like and its body contains no
+  /// identifiers (so no nested expansion, keyword mapping or
+  /// disable-expansion bookkeeping can occur), no token pasting and no
+  /// comments.  Expansions of such macros can bypass the TokenLexer
+  /// machinery entirely.  The answer only depends on the replacement list,
+  /// so it is computed once and cached.
+  bool isReplayableExpansion() const {
+    if (IsReplayableExpansionCached)
+      return IsReplayableExpansion;
+    return isReplayableExpansionSlow();
+  }
+
   /// Return true if the specified macro definition is equal to
   /// this macro in spelling, arguments, and whitespace.
   ///
@@ -278,6 +296,8 @@ private:
   friend class Preprocessor;
 
   unsigned getDefinitionLengthSlow(const SourceManager &SM) const;
+
+  bool isReplayableExpansionSlow() const;
 };
 
 /// Encapsulates changes to the "macros namespace" (the location where
@@ -15,12 +15,14 @@
 
 #include "clang/Basic/LLVM.h"
 #include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include <string>
 
 namespace clang {
 
+class IdentifierInfo;
 class PragmaNamespace;
 class Preprocessor;
 class Token;
@@ -98,6 +100,17 @@ class PragmaNamespace : public PragmaHandler {
   /// as key.
   llvm::StringMap<PragmaHandler *> Handlers;
 
+  /// Memoized identifier-to-handler resolutions, including negative ("no
+  /// handler, ignore this pragma") verdicts. Pragma names are interned
+  /// identifiers, so each distinct spelling pays for the StringMap lookup
+  /// only once; the cache is dropped whenever the handler set changes.
+  mutable llvm::DenseMap<const IdentifierInfo *, PragmaHandler *> HandlerCache;
+
+  /// The handler registered under the null name, if any. It serves as the
+  /// fallback for unmatched pragmas and is maintained separately so the
+  /// dispatch fast path does not have to look it up in the map.
+  PragmaHandler *NullHandler = nullptr;
+
 public:
   explicit PragmaNamespace(StringRef Name) : PragmaHandler(Name) {}
   ~PragmaNamespace() override;
@@ -109,6 +122,11 @@ public:
   PragmaHandler *FindHandler(StringRef Name,
                              bool IgnoreNull = true) const;
 
+  /// Variant of FindHandler for an interned pragma name, which memoizes the
+  /// resolution per identifier pointer.
+  PragmaHandler *FindHandler(const IdentifierInfo *II,
+                             bool IgnoreNull = true) const;
+
   /// AddPragma - Add a pragma to this namespace.
   void AddPragma(PragmaHandler *Handler);
 
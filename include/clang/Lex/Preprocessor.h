@@ -476,6 +476,15 @@ private:
     State ConditionalStackState = Off;
   } PreambleConditionalStack;
 
+  /// Maps the start of an excluded-conditional lex pass, identified by its
+  /// pointer into the file's memory buffer, to the number of bytes that the
+  /// pass skipped until the next interesting directive. The text between two
+  /// directives is independent of the macro state, so when a guarded header
+  /// is re-entered the recorded spans are jumped over instead of re-lexed;
+  /// only the directives themselves are processed again.
+  using SkippedRangeMap = llvm::DenseMap<const char *, unsigned>;
+  SkippedRangeMap RecordedSkippedRanges;
+
   /// The current top of the stack that we're lexing from if
   /// not expanding a macro and we are lexing directly from source code.
   ///
@@ -789,6 +798,7 @@ private:
   unsigned NumFnMacroExpanded = 0;
   unsigned NumBuiltinMacroExpanded = 0;
   unsigned NumFastMacroExpanded = 0;
+  unsigned NumReplayedMacroExpanded = 0;
   unsigned NumTokenPaste = 0;
   unsigned NumFastTokenPaste = 0;
   unsigned NumSkipped = 0;
@@ -0,0 +1,39 @@
+//===--- RawTokenHash.h - Hashing of raw token streams ----------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines a stable hash over the raw token stream of a source
+//  range, intended for cheap "did this code change" answers that do not
+//  require building an AST.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_RAWTOKENHASH_H
+#define LLVM_CLANG_LEX_RAWTOKENHASH_H
+
+#include "clang/Basic/SourceLocation.h"
+#include <cstdint>
+
+namespace clang {
+
+class LangOptions;
+class SourceManager;
+
+/// Computes a stable 64-bit hash of the raw token stream spelled in the
+/// given range, in one streaming pass at raw lexing speed.
+///
+/// Each token contributes its spelling, so the hash is insensitive to
+/// whitespace and comment changes but changes whenever any token does. The
+/// range is reduced to a file range with Lexer::makeFileCharRange first;
+/// ranges that do not correspond to a contiguous piece of one file hash
+/// to 0.
+uint64_t hashRawTokensInRange(CharSourceRange Range, const SourceManager &SM,
+                              const LangOptions &LangOpts);
+
+} // namespace clang
+
+#endif // LLVM_CLANG_LEX_RAWTOKENHASH_H
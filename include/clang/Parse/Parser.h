@@ -23,6 +23,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/Sema.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/PrettyStackTrace.h"
@@ -891,16 +892,26 @@ private:
     }
     void Commit() {
       assert(isActive && "Parsing action was finished!");
+      if (P.TentativelyDeclaredIdentifiers.size() !=
+          PrevTentativelyDeclaredIdentifierCount)
+        P.TentativeParseVerdicts.clear();
       P.TentativelyDeclaredIdentifiers.resize(
           PrevTentativelyDeclaredIdentifierCount);
       P.PP.CommitBacktrackedTokens();
+      if (!P.PP.isBacktrackEnabled())
+        P.TentativeParseVerdicts.clear();
       isActive = false;
     }
     void Revert() {
       assert(isActive && "Parsing action was finished!");
       P.PP.Backtrack();
+      if (!P.PP.isBacktrackEnabled())
+        P.TentativeParseVerdicts.clear();
       P.PreferredType = PrevPreferredType;
       P.Tok = PrevTok;
+      if (P.TentativelyDeclaredIdentifiers.size() !=
+          PrevTentativelyDeclaredIdentifierCount)
+        P.TentativeParseVerdicts.clear();
       P.TentativelyDeclaredIdentifiers.resize(
           PrevTentativelyDeclaredIdentifierCount);
       P.ParenCount = PrevParenCount;
@@ -2298,6 +2309,20 @@ private:
     True, False, Ambiguous, Error
   };
 
+  /// Memoized isCXXDeclarationSpecifier verdicts, keyed by the location of
+  /// the token the query started at together with the query arguments.
+  /// Disambiguating one construct revisits the same decl-specifier several
+  /// times on backtrack, and the verdict cannot change while a tentative
+  /// parsing region is active because no declarations are committed there;
+  /// the cache is dropped together with the outermost region, and also
+  /// whenever TentativelyDeclaredIdentifiers changes, since a tentatively
+  /// declared identifier disambiguates differently from then on. The second
+  /// member of the value records the observed write to *InvalidAsDeclSpec
+  /// (0: none, 1: set to true, 2: set to false) so a cache hit replays it.
+  llvm::SmallDenseMap<std::pair<unsigned, unsigned>,
+                      std::pair<TPResult, unsigned char>, 8>
+      TentativeParseVerdicts;
+
   /// Based only on the given token kind, determine whether we know that
   /// we're at the start of an expression or a type-specifier-seq (which may
   /// be an expression, in C++).
@@ -2321,6 +2346,11 @@ private:
   isCXXDeclarationSpecifier(TPResult BracedCastResult = TPResult::False,
                             bool *InvalidAsDeclSpec = nullptr);
 
+  /// The worker for isCXXDeclarationSpecifier, whose verdicts are memoized
+  /// in TentativeParseVerdicts while a tentative parsing region is active.
+  TPResult isCXXDeclarationSpecifierImpl(TPResult BracedCastResult,
+                                         bool *InvalidAsDeclSpec);
+
   /// Given that isCXXDeclarationSpecifier returns \c TPResult::True or
   /// \c TPResult::Ambiguous, determine whether the decl-specifier would be
   /// a type-specifier other than a cv-qualifier.
@@ -15,6 +15,7 @@
 #define LLVM_CLANG_REWRITE_CORE_HTMLREWRITE_H
 
 #include "clang/Basic/SourceLocation.h"
+#include <memory>
 #include <string>
 
 namespace clang {
@@ -25,6 +26,18 @@ class Preprocessor;
 
 namespace html {
 
+  /// RelexRewriteCache - If the same file is rewritten multiple times (e.g.
+  /// one HTML report per bug in a hot header), instantiate a
+  /// RelexRewriteCache and pass it to SyntaxHighlight() and HighlightMacros()
+  /// so that the file is re-lexed and re-preprocessed only once; subsequent
+  /// rewrites of the same FileID replay the recorded highlight operations.
+  /// The cache may outlive any individual rewriter, but the cached FileIDs
+  /// must remain valid, i.e. it must not be reused across SourceManagers.
+  class RelexRewriteCache;
+  using RelexRewriteCacheRef = std::shared_ptr<RelexRewriteCache>;
+
+  RelexRewriteCacheRef instantiateRelexRewriteCache();
+
   /// HighlightRange - Highlight a range in the source code with the specified
   /// start/end tags.  B/E must be in the same file.  This ensures that
   /// start/end tags are placed at the start/end of each line if the range is
@@ -67,13 +80,15 @@ namespace html {
 
   /// SyntaxHighlight - Relex the specified FileID and annotate the HTML with
   /// information about keywords, comments, etc.
-  void SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP);
+  void SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP,
+                       RelexRewriteCacheRef Cache = nullptr);
 
   /// HighlightMacros - This uses the macro table state from the end of the
   /// file, to reexpand macros and insert (into the HTML) information about the
   /// macro expansions.  This won't be perfectly perfect, but it will be
   /// reasonably close.
-  void HighlightMacros(Rewriter &R, FileID FID, const Preprocessor &PP);
+  void HighlightMacros(Rewriter &R, FileID FID, const Preprocessor &PP,
+                       RelexRewriteCacheRef Cache = nullptr);
 
 } // end html namespace
 } // end clang namespace
@@ -276,6 +276,10 @@ public:
     AllowHidden = AH;
   }
 
+  /// Determine whether this lookup is permitted to see any hidden
+  /// declaration, regardless of the visibility of its owning module.
+  bool isAllowingHiddenDeclarations() const { return AllowHidden; }
+
   /// Determine whether this lookup is permitted to see hidden
   /// declarations, such as those in modules that have not yet been imported.
   bool isHiddenDeclarationVisible(NamedDecl *ND) const {
@@ -289,6 +293,10 @@ public:
     HideTags = Hide;
   }
 
+  /// Determine whether tag declarations may be hidden by non-tag
+  /// declarations during resolution.
+  bool isHidingTags() const { return HideTags; }
+
   /// Sets whether this is a template-name lookup. For template-name lookups,
   /// injected-class-names are treated as naming a template rather than a
   /// template specialization.
@@ -37,6 +37,7 @@
 #include "clang/Basic/Specifiers.h"
 #include "clang/Basic/TemplateKinds.h"
 #include "clang/Basic/TypeTraits.h"
+#include "clang/Lex/CompactTokenBuffer.h"
 #include "clang/Sema/AnalysisBasedWarnings.h"
 #include "clang/Sema/CleanupInfo.h"
 #include "clang/Sema/DeclSpec.h"
@@ -325,6 +326,15 @@ private:
 };
 
 /// Sema - This implements semantic analysis and AST building for C.
+///
+/// Sema is confined to a single thread, and its work cannot be pipelined
+/// against the parser: the parser calls back into Sema while a declaration
+/// is still open, Sema mutates shared structures (the ASTContext allocator,
+/// the identifier table, redeclaration chains, the pending template
+/// instantiation queue) without any synchronization, and even syntactically
+/// independent top-level declarations are linked through them. Parallelism
+/// over translation units must therefore be organized per Sema instance,
+/// i.e. per thread or per process.
 class Sema {
   Sema(const Sema &) = delete;
   void operator=(const Sema &) = delete;
@@ -3329,6 +3339,40 @@ public:
 private:
   bool CppLookupName(LookupResult &R, Scope *S);
 
+  /// The memoized outcome of a qualified name lookup that had to walk the
+  /// using-directive graph of a namespace or of the translation unit
+  /// (C++ [namespace.qual]). An entry is valid only while both stamped
+  /// generations still match the current ones; a lookup performed under
+  /// different criteria than the recorded ones re-walks the graph and
+  /// overwrites the entry.
+  struct UsingDirectiveLookupMemo {
+    /// ASTContext::getQualifiedLookupGeneration() right after the walk.
+    unsigned DeclGeneration;
+    /// VisibleModules.getGeneration() right after the walk.
+    unsigned ModuleGeneration;
+    /// The criteria the walk ran under.
+    LookupNameKind Kind;
+    bool TemplateNameLookup;
+    bool HideTags;
+    /// Whether the walk found any declarations.
+    bool Found;
+    /// Whether the result was ambiguous between tag and non-tag names
+    /// from different namespaces (C++ [namespace.qual]p5).
+    bool AmbiguousTagHiding;
+    /// The declarations the walk found, in the order it found them.
+    SmallVector<DeclAccessPair, 2> Decls;
+  };
+
+  /// Memoized using-directive walks, keyed by the starting context and the
+  /// name looked up. Namespace-heavy code repeats the same qualified
+  /// lookups many times; replaying a memoized walk turns them into hash
+  /// hits.
+  llvm::DenseMap<std::pair<DeclContext *, DeclarationName>,
+                 UsingDirectiveLookupMemo>
+      UsingDirectiveLookupCache;
+
+  bool LookupInUsingDirectivesMemoized(LookupResult &R, DeclContext *StartDC);
+
   struct TypoExprState {
     std::unique_ptr<TypoCorrectionConsumer> Consumer;
     TypoDiagnosticGenerator DiagHandler;
@@ -7920,6 +7964,13 @@ public:
   /// The number of typos corrected by CorrectTypo.
   unsigned TyposCorrected;
 
+  /// Wall-clock time spent correcting typos so far, in microseconds.
+  ///
+  /// Compared against DiagnosticOptions::SpellCheckingBudget; once the
+  /// budget is exhausted, further corrections are skipped and diagnostics
+  /// are emitted without suggestions.
+  uint64_t TypoCorrectionMicros;
+
   typedef llvm::SmallSet<SourceLocation, 2> SrcLocSet;
   typedef llvm::DenseMap<IdentifierInfo *, SrcLocSet> IdentifierSourceLocations;
 
@@ -11311,7 +11362,9 @@ MakeDeductionFailureInfo(ASTContext &Context, Sema::TemplateDeductionResult TDK,
 /// Contains a late templated function.
 /// Will be parsed at the end of the translation unit, used by Sema & Parser.
 struct LateParsedTemplate {
-  CachedTokens Toks;
+  /// The cached body tokens, stored packed; on template-heavy TUs these
+  /// caches dominate the memory footprint of -fdelayed-template-parsing.
+  CompactTokenBuffer Toks;
   /// The template function declaration to be late parsed.
   Decl *D;
 };
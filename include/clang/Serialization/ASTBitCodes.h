@@ -41,7 +41,7 @@ namespace serialization {
     /// Version 4 of AST files also requires that the version control branch and
     /// revision match exactly, since there is no backward compatibility of
     /// AST files at this time.
-    const unsigned VERSION_MAJOR = 7;
+    const unsigned VERSION_MAJOR = 8;
 
     /// AST file minor version number supported by this version of
     /// Clang.
@@ -51,7 +51,7 @@ namespace serialization {
     /// for the previous version could still support reading the new
     /// version by ignoring new kinds of subblocks), this number
     /// should be increased.
-    const unsigned VERSION_MINOR = 0;
+    const unsigned VERSION_MINOR = 1;
 
     /// An ID number that refers to an identifier in an AST file.
     ///
@@ -331,6 +331,10 @@ namespace serialization {
 
       /// Record code for the module build directory.
       MODULE_DIRECTORY,
+
+      /// Record code for the build session timestamp the AST file was
+      /// built under, if any. Only emitted for PCH files.
+      BUILD_SESSION_TIMESTAMP,
     };
 
     /// Record types that occur within the options block inside
@@ -647,7 +651,14 @@ namespace serialization {
       PP_CONDITIONAL_STACK = 62,
 
       /// A table of skipped ranges within the preprocessing record.
-      PPD_SKIPPED_RANGES = 63
+      PPD_SKIPPED_RANGES = 63,
+
+      /// Record code for the layouts of the complete record types whose
+      /// layout had been computed when the AST file was written. Readers
+      /// serve them back through ExternalASTSource::layoutRecordType() so
+      /// that the layouts need not be recomputed in every consumer of the
+      /// AST file.
+      RECORD_LAYOUTS = 64
     };
 
     /// Record types used within a source manager block.
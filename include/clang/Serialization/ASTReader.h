@@ -70,6 +70,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -440,6 +441,16 @@ private:
   /// The module manager which manages modules and their dependencies
   ModuleManager ModuleMgr;
 
+  /// Background threads touching the pages spanned by the decl records of
+  /// freshly loaded AST files, so that the on-demand deserialization storm
+  /// right after a big PCH load does not stall on page faults behind the
+  /// bitstream cursor. They read the immutable file buffer only; joined in
+  /// the destructor.
+  std::vector<std::thread> DeclPrefetchThreads;
+
+  /// Start a background page prefetch over the decl records of \p F.
+  void startDeclPrefetch(ModuleFile &F);
+
   /// A dummy identifier resolver used to merge TU-scope declarations in
   /// C, for the cases where we don't have a Sema object to provide a real
   /// identifier resolver.
@@ -897,6 +908,23 @@ private:
   // A list of late parsed template function data.
   SmallVector<uint64_t, 1> LateParsedTemplates;
 
+  /// The layout of a record type as its AST file stored it.
+  ///
+  /// Field offsets are in bits and follow the field order of the record;
+  /// base offsets are in characters and follow the order of the base
+  /// specifiers, non-virtual direct bases first, then all virtual bases.
+  struct SerializedRecordLayout {
+    uint64_t Size;
+    uint64_t Alignment;
+    SmallVector<uint64_t, 8> FieldOffsets;
+    SmallVector<int64_t, 4> BaseOffsets;
+    SmallVector<int64_t, 2> VirtualBaseOffsets;
+  };
+
+  /// The layouts stored in the loaded AST files, keyed by the global
+  /// declaration ID of the record definition they belong to.
+  llvm::DenseMap<serialization::DeclID, SerializedRecordLayout> RecordLayouts;
+
 public:
   struct ImportedSubmodule {
     serialization::SubmoduleID ID;
@@ -1145,6 +1173,11 @@ private:
   /// When reading a Stmt tree, Stmt operands are placed in this stack.
   SmallVector<Stmt *, 16> StmtStack;
 
+  /// The rotated raw encoding of the last source location read from the
+  /// statement stream currently being read. Statement records store their
+  /// source locations as zig-zag encoded deltas against it.
+  uint32_t LastStmtStreamLoc = 0;
+
   /// What kind of records we are reading.
   enum ReadingKind {
     Read_None, Read_Decl, Read_Type, Read_Stmt
@@ -1885,6 +1918,15 @@ public:
   /// redeclaration chain for \p D.
   void CompleteRedeclChain(const Decl *D) override;
 
+  /// Serve the layout of \p Record if its AST file stored one, so that it
+  /// does not have to be recomputed.
+  bool layoutRecordType(
+      const RecordDecl *Record, uint64_t &Size, uint64_t &Alignment,
+      llvm::DenseMap<const FieldDecl *, uint64_t> &FieldOffsets,
+      llvm::DenseMap<const CXXRecordDecl *, CharUnits> &BaseOffsets,
+      llvm::DenseMap<const CXXRecordDecl *, CharUnits> &VirtualBaseOffsets)
+      override;
+
   CXXBaseSpecifier *GetExternalCXXBaseSpecifiers(uint64_t Offset) override;
 
   /// Resolve the offset of a statement into a statement.
@@ -2204,7 +2246,14 @@ public:
   SourceLocation ReadSourceLocation(ModuleFile &ModuleFile,
                                     const RecordDataImpl &Record,
                                     unsigned &Idx) {
-    return ReadSourceLocation(ModuleFile, Record[Idx++]);
+    uint64_t Value = Record[Idx++];
+    if (ReadingKind == Read_Stmt) {
+      // Statement records store their source locations as zig-zag encoded
+      // deltas against the previous location in the statement stream.
+      int64_t Delta = int64_t(Value >> 1) ^ -int64_t(Value & 1);
+      Value = LastStmtStreamLoc = uint32_t(LastStmtStreamLoc + Delta);
+    }
+    return ReadSourceLocation(ModuleFile, Value);
   }
 
   /// Read a source range.
@@ -298,6 +298,15 @@ private:
   /// just after the stmt record.
   llvm::DenseMap<Stmt *, uint64_t> SubStmtEntries;
 
+  /// Whether we are emitting the statement stream that follows a
+  /// declaration or type record. Statement records delta-encode their
+  /// source locations against \c LastStmtStreamLoc.
+  bool WritingStmtStream = false;
+
+  /// The rotated raw encoding of the last source location emitted into the
+  /// current statement stream.
+  uint32_t LastStmtStreamLoc = 0;
+
   /// @}
 
   /// Offsets of each of the identifier IDs into the identifier
@@ -494,6 +503,7 @@ private:
   void WriteTypeDeclOffsets();
   void WriteFileDeclIDsMap();
   void WriteComments();
+  void WriteRecordLayouts(ASTContext &Context);
   void WriteSelectors(Sema &SemaRef);
   void WriteReferencedSelectorsPool(Sema &SemaRef);
   void WriteIdentifierTable(Preprocessor &PP, IdentifierResolver &IdResolver,
@@ -758,6 +768,11 @@ class ASTRecordWriter {
   /// record when emitted.
   SmallVector<unsigned, 8> OffsetIndices;
 
+  /// Indices of record elements of a statement record that hold source
+  /// locations. These will be rewritten as deltas against the previous
+  /// location in the statement stream when the record is emitted.
+  SmallVector<unsigned, 8> StmtLocIndices;
+
   /// Flush all of the statements and expressions that have
   /// been added to the queue via AddStmt().
   void FlushStmts();
@@ -774,6 +789,20 @@ class ASTRecordWriter {
     OffsetIndices.clear();
   }
 
+  void DeltaEncodeStmtLocs() {
+    // Rewrite the source locations of this statement record as zig-zag
+    // encoded deltas against the previous location in the statement stream.
+    // This runs after the substatement records have been flushed, so the
+    // chain advances in the order the reader consumes the stream.
+    for (unsigned I : StmtLocIndices) {
+      uint32_t Encoded = uint32_t((*Record)[I]);
+      int64_t Delta = int64_t(Encoded) - int64_t(Writer->LastStmtStreamLoc);
+      (*Record)[I] = (uint64_t(Delta) << 1) ^ uint64_t(Delta >> 63);
+      Writer->LastStmtStreamLoc = Encoded;
+    }
+    StmtLocIndices.clear();
+  }
+
 public:
   /// Construct a ASTRecordWriter that uses the default encoding scheme.
   ASTRecordWriter(ASTWriter &Writer, ASTWriter::RecordDataImpl &Record)
@@ -817,6 +846,7 @@ public:
   /// Emit the record to the stream, preceded by its substatements.
   uint64_t EmitStmt(unsigned Code, unsigned Abbrev = 0) {
     FlushSubStmts();
+    DeltaEncodeStmtLocs();
     PrepareToEmit(Writer->Stream.GetCurrentBitNo());
     Writer->Stream.EmitRecord(Code, *Record, Abbrev);
     return Writer->Stream.GetCurrentBitNo();
@@ -844,14 +874,18 @@ public:
   /// to emit.
   void AddFunctionDefinition(const FunctionDecl *FD);
 
-  /// Emit a source location.
+  /// Emit a source location. Within the statement stream, locations are
+  /// collected here and rewritten as deltas when the record is emitted.
   void AddSourceLocation(SourceLocation Loc) {
+    if (Writer->WritingStmtStream)
+      StmtLocIndices.push_back(Record->size());
     return Writer->AddSourceLocation(Loc, *Record);
   }
 
   /// Emit a source range.
   void AddSourceRange(SourceRange Range) {
-    return Writer->AddSourceRange(Range, *Record);
+    AddSourceLocation(Range.getBegin());
+    AddSourceLocation(Range.getEnd());
   }
 
   /// Emit an integral value.
@@ -235,6 +235,12 @@ public:
   /// The time is specified in seconds since the start of the Epoch.
   uint64_t InputFilesValidationTimestamp = 0;
 
+  /// The build session timestamp recorded in the AST file, or zero if
+  /// the file was built without a session stamp.
+  ///
+  /// The time is specified in seconds since the start of the Epoch.
+  uint64_t BuildSessionTimestamp = 0;
+
   // === Source Locations ===
 
   /// Cursor used to read source location entries.
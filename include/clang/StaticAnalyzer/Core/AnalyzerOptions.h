@@ -125,6 +125,7 @@ enum class ExplorationStrategyKind {
   UnexploredFirst,
   UnexploredFirstQueue,
   UnexploredFirstLocationQueue,
+  CoverageFirstQueue,
   BFSBlockDFSContents,
 };
 
@@ -195,6 +196,12 @@ public:
   /// A key-value table of use-specified configuration values.
   // TODO: This shouldn't be public.
   ConfigTable Config;
+
+  /// Resolved checker option values, keyed by "<checker>:<option>". Several
+  /// checkers query their options in every callback; remembering the result
+  /// here lets the repeated lookups skip the search through the parent
+  /// packages of \c Config and its per-probe key allocations.
+  mutable ConfigTable ResolvedCheckerOptions;
   AnalysisStores AnalysisStoreOpt = RegionStoreModel;
   AnalysisConstraints AnalysisConstraintsOpt = RangeConstraintsModel;
   AnalysisDiagClients AnalysisDiagOpt = PD_HTML;
@@ -248,6 +255,12 @@ public:
   /// Emit analyzer warnings as errors.
   unsigned AnalyzerWerror : 1;
 
+  /// Set when the checker list and config table were loaded from a
+  /// configuration cache (-analyzer-config-cache) written by an invocation
+  /// with an identical configuration, in which case CheckerRegistry can skip
+  /// revalidating them.
+  unsigned HasPrevalidatedConfig : 1;
+
   /// The inlining stack depth limit.
   // Cap the stack depth at 4 calls (5 stack frames, base + 4 calls).
   unsigned InlineMaxStackDepth = 5;
@@ -300,7 +313,8 @@ public:
         AnalyzerDisplayProgress(false), AnalyzeNestedBlocks(false),
         eagerlyAssumeBinOpBifurcation(false), TrimGraph(false),
         visualizeExplodedGraphWithGraphViz(false), UnoptimizedCFG(false),
-        PrintStats(false), NoRetryExhausted(false), AnalyzerWerror(false) {
+        PrintStats(false), NoRetryExhausted(false), AnalyzerWerror(false),
+        HasPrevalidatedConfig(false) {
     llvm::sort(AnalyzerConfigCmdFlags);
   }
 
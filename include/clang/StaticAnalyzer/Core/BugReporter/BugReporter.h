@@ -19,23 +19,28 @@
 #include "clang/StaticAnalyzer/Core/BugReporter/BugReporterVisitors.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/PathDiagnostic.h"
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
+#include "clang/StaticAnalyzer/Core/IssueHash.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SVals.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SymExpr.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraph.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/ImmutableSet.h"
 #include "llvm/ADT/None.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/ilist.h"
 #include "llvm/ADT/ilist_node.h"
 #include "llvm/ADT/iterator_range.h"
 #include <cassert>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -90,6 +95,11 @@ public:
   using ExtraTextList = SmallVector<StringRef, 2>;
   using NoteList = SmallVector<std::shared_ptr<PathDiagnosticNotePiece>, 4>;
 
+  /// Renders the description of a report on demand (see the lazy
+  /// constructors below). The callback owns the values the message is built
+  /// from and must stay valid for the lifetime of the report.
+  using DescriptionBuilder = std::function<std::string()>;
+
 protected:
   friend class BugReportEquivClass;
   friend class BugReporter;
@@ -97,7 +107,22 @@ protected:
   const BugType& BT;
   const Decl *DeclWithIssue = nullptr;
   std::string ShortDescription;
-  std::string Description;
+
+  /// The warning message; rendered on first use (and cached here) when the
+  /// report was created with a DescriptionBuilder.
+  mutable std::string Description;
+
+  /// Non-null until the description of a lazily described report has been
+  /// rendered. Most reports of an equivalence class are never presented, so
+  /// deferring the rendering past the class selection saves the formatting
+  /// work for them entirely.
+  mutable DescriptionBuilder LazyDescription;
+
+  /// Whether this report was created with a DescriptionBuilder. Unlike
+  /// LazyDescription this stays set after the rendering, so Profile()
+  /// treats the report consistently no matter when it runs.
+  bool DescriptionIsLazy = false;
+
   PathDiagnosticLocation Location;
   PathDiagnosticLocation UniqueingLocation;
   const Decl *UniqueingDecl;
@@ -189,6 +214,29 @@ public:
       : BT(bt), Description(desc), UniqueingLocation(LocationToUnique),
         UniqueingDecl(DeclToUnique), ErrorNode(errornode) {}
 
+  /// Create a BugReport whose description is rendered only if the report is
+  /// selected for presentation.
+  ///
+  /// Most reports lose the equivalence-class selection in BugReporter and
+  /// their description is never shown, so checkers that format a message on
+  /// every error node can hand over a builder closure instead and skip the
+  /// formatting for the discarded reports. In exchange the description does
+  /// not take part in uniquing: the checker must guarantee that reports of
+  /// \p bt that compare equal by location and ranges would render the same
+  /// message.
+  BugReport(const BugType &bt, DescriptionBuilder desc,
+            const ExplodedNode *errornode)
+      : BT(bt), LazyDescription(std::move(desc)), DescriptionIsLazy(true),
+        ErrorNode(errornode) {}
+
+  /// Create a lazily described BugReport with a custom uniqueing location
+  /// (see above).
+  BugReport(BugType &bt, DescriptionBuilder desc, const ExplodedNode *errornode,
+            PathDiagnosticLocation LocationToUnique, const Decl *DeclToUnique)
+      : BT(bt), LazyDescription(std::move(desc)), DescriptionIsLazy(true),
+        UniqueingLocation(LocationToUnique), UniqueingDecl(DeclToUnique),
+        ErrorNode(errornode) {}
+
   virtual ~BugReport();
 
   const BugType& getBugType() const { return BT; }
@@ -208,11 +256,17 @@ public:
 
   const ExplodedNode *getErrorNode() const { return ErrorNode; }
 
-  StringRef getDescription() const { return Description; }
+  StringRef getDescription() const {
+    if (LazyDescription) {
+      Description = LazyDescription();
+      LazyDescription = nullptr;
+    }
+    return Description;
+  }
 
   StringRef getShortDescription(bool UseFallback = true) const {
     if (ShortDescription.empty() && UseFallback)
-      return Description;
+      return getDescription();
     return ShortDescription;
   }
 
@@ -402,11 +456,37 @@ public:
 // BugReporter and friends.
 //===----------------------------------------------------------------------===//
 
+/// The bookkeeping behind the 'report-quota' config option. A BugReporter
+/// only lives for one entry point, so the quota state lives in the
+/// AnalysisManager and is shared by every BugReporter of the translation
+/// unit.
+class ReportQuotaState {
+  friend class BugReporter;
+
+  /// The number of report equivalence classes admitted per (checker, file)
+  /// pair. The key is the checker name and the file name joined by a NUL.
+  llvm::StringMap<unsigned> Admitted;
+
+  /// The number of equivalence classes dropped per (checker, file) pair
+  /// after its quota ran out, keyed like Admitted.
+  llvm::StringMap<unsigned> Suppressed;
+
+  /// The issue hashes of the admitted classes, used to drop textually
+  /// identical issues before any bug path is constructed.
+  llvm::StringSet<> SeenIssueHashes;
+
+public:
+  /// Emit one summary warning per capped (checker, file) pair saying how
+  /// many reports the quota dropped, and forget the counts.
+  void flushSuppressedCounts(DiagnosticsEngine &Diag);
+};
+
 class BugReporterData {
 public:
   virtual ~BugReporterData();
 
   virtual DiagnosticsEngine& getDiagnostic() = 0;
+  virtual ReportQuotaState &getReportQuotaState() = 0;
   virtual ArrayRef<PathDiagnosticConsumer*> getPathDiagnosticConsumers() = 0;
   virtual ASTContext &getASTContext() = 0;
   virtual SourceManager &getSourceManager() = 0;
@@ -446,6 +526,10 @@ private:
   /// A vector of BugReports for tracking the allocated pointers and cleanup.
   std::vector<BugReportEquivClass *> EQClassesVector;
 
+  /// Shares the issue hash line normalization between this reporter's
+  /// reports; used by the report quota and the cross-process deduplication.
+  IssueHashLineCache IssueHashCache;
+
 protected:
   BugReporter(BugReporterData& d, Kind k)
       : BugTypes(F.getEmptySet()), kind(k), D(d) {}
@@ -484,6 +568,8 @@ public:
 
   AnalyzerOptions &getAnalyzerOptions() { return D.getAnalyzerOptions(); }
 
+  ReportQuotaState &getReportQuotaState() { return D.getReportQuotaState(); }
+
   virtual std::unique_ptr<DiagnosticForConsumerMapTy>
   generatePathDiagnostics(ArrayRef<PathDiagnosticConsumer *> consumers,
                           ArrayRef<BugReport *> &bugReports) {
@@ -522,6 +608,13 @@ private:
 class GRBugReporter : public BugReporter {
   ExprEngine& Eng;
 
+  /// Z3 refutation verdicts from already-flushed reports, keyed by the root
+  /// of the canonicalized constraint map collected along the report's error
+  /// path. Reports from different equivalence classes frequently share
+  /// identical constraint sets, so caching the verdict lets the refutation
+  /// visitor skip repeated solver runs.
+  llvm::DenseMap<const void *, bool> RefutationCache;
+
 public:
   GRBugReporter(BugReporterData& d, ExprEngine& eng)
       : BugReporter(d, GRBugReporterKind), Eng(eng) {}
@@ -545,6 +638,23 @@ public:
   generatePathDiagnostics(ArrayRef<PathDiagnosticConsumer *> consumers,
                           ArrayRef<BugReport *> &bugReports) override;
 
+  /// Returns the cached refutation verdict for the canonical constraint map
+  /// rooted at \p ConstraintKey, if one was recorded for an earlier report.
+  Optional<bool> getCachedRefutationSatisfiability(
+      const void *ConstraintKey) const {
+    auto I = RefutationCache.find(ConstraintKey);
+    if (I == RefutationCache.end())
+      return None;
+    return I->second;
+  }
+
+  /// Records the solver's verdict for the constraint map rooted at
+  /// \p ConstraintKey, so that later reports carrying identical constraints
+  /// skip the solver entirely.
+  void cacheRefutationSatisfiability(const void *ConstraintKey, bool IsSat) {
+    RefutationCache[ConstraintKey] = IsSat;
+  }
+
   /// classof - Used by isa<>, cast<>, and dyn_cast<>.
   static bool classof(const BugReporter* R) {
     return R->getKind() == GRBugReporterKind;
@@ -563,15 +673,40 @@ public:
   }
 };
 
+/// Memoizes constraint queries that bug reporter visitors issue at every node
+/// of an error path. The reports of an equivalence class replay largely
+/// identical paths over the same uniqued ProgramStates, so whenever a report
+/// is suppressed the walk of the next candidate repeats the same queries.
+/// One cache is created per equivalence class and shared by all of its path
+/// walks, including the refutation pass.
+class VisitorFactCache {
+  /// Cached verdicts of null-constraint queries, keyed by (state, symbol).
+  /// The trimmed graph keeps the states alive for the whole flush, so bare
+  /// pointers are safe keys here.
+  llvm::DenseMap<std::pair<const ProgramState *, SymbolRef>, ConditionTruthVal>
+      NullVerdicts;
+
+public:
+  /// Equivalent to \c State->isNull(V), memoized across path walks.
+  ConditionTruthVal isNull(ProgramStateRef State, SVal V);
+};
+
 class BugReporterContext {
   GRBugReporter &BR;
   NodeMapClosure NMC;
 
+  /// Points at the equivalence-class-wide cache when the caller supplied one,
+  /// and at OwnFactCache otherwise.
+  VisitorFactCache *FactCache;
+  VisitorFactCache OwnFactCache;
+
   virtual void anchor();
 
 public:
-  BugReporterContext(GRBugReporter &br, InterExplodedGraphMap &Backmap)
-      : BR(br), NMC(Backmap) {}
+  BugReporterContext(GRBugReporter &br, InterExplodedGraphMap &Backmap,
+                     VisitorFactCache *FactCache = nullptr)
+      : BR(br), NMC(Backmap),
+        FactCache(FactCache ? FactCache : &OwnFactCache) {}
 
   virtual ~BugReporterContext() = default;
 
@@ -600,6 +735,8 @@ public:
   }
 
   NodeMapClosure& getNodeResolver() { return NMC; }
+
+  VisitorFactCache &getVisitorFactCache() { return *FactCache; }
 };
 
 
@@ -62,6 +62,8 @@ using SymbolRef = const SymExpr *;
 //===----------------------------------------------------------------------===//
 
 class PathDiagnostic;
+class PathDiagnosticPiece;
+class PathPieces;
 
 class PathDiagnosticConsumer {
 public:
@@ -109,6 +111,11 @@ public:
   virtual void FlushDiagnosticsImpl(std::vector<const PathDiagnostic *> &Diags,
                                     FilesMade *filesMade) = 0;
 
+  /// Emit a single finalized diagnostic right away instead of collecting it
+  /// for FlushDiagnosticsImpl(). Only called when supportsStreaming() returns
+  /// true.
+  virtual void StreamDiagnosticImpl(const PathDiagnostic &D) {}
+
   virtual StringRef getName() const = 0;
 
   void HandlePathDiagnostic(std::unique_ptr<PathDiagnostic> D);
@@ -131,6 +138,43 @@ public:
   /// PathDiagnostics that span multiple files.
   virtual bool supportsCrossFileDiagnostics() const { return false; }
 
+  /// Return true if the PathDiagnosticConsumer emits each diagnostic as soon
+  /// as it is handed over, so that the paths need not be kept alive until
+  /// the end of the translation unit. Streamed diagnostics are not
+  /// deduplicated against later ones with an identical profile.
+  virtual bool supportsStreaming() const { return false; }
+
+private:
+  /// A path piece (and, transitively, the whole call or macro subtree below
+  /// it) shared between several stored diagnostics, uniqued by its profile.
+  class PDSharedPiece : public llvm::FoldingSetNode {
+  public:
+    PDSharedPiece(const llvm::FoldingSetNodeID &NodeID,
+                  std::shared_ptr<PathDiagnosticPiece> Piece)
+        : Piece(std::move(Piece)), NodeID(NodeID) {}
+
+    std::shared_ptr<PathDiagnosticPiece> Piece;
+
+    /// A precomputed hash tag used for uniquing PDSharedPiece objects.
+    const llvm::FoldingSetNodeID NodeID;
+
+    /// Used for profiling in the FoldingSet.
+    void Profile(llvm::FoldingSetNodeID &ID) { ID = NodeID; }
+  };
+
+  /// Replace each piece of \p Path with the uniqued copy of an earlier
+  /// profile-identical piece, if one was stored already. Reports produced
+  /// from one entry point tend to share long prefixes (the same call chain
+  /// into a header), so the stored diagnostics keep a single copy per
+  /// distinct subtree while they wait to be flushed.
+  ///
+  /// Returns true if every piece of the path could be shared.
+  bool sharePieces(PathPieces &Path);
+  bool sharePiece(std::shared_ptr<PathDiagnosticPiece> &Piece);
+
+  llvm::BumpPtrAllocator PieceAlloc;
+  llvm::FoldingSet<PDSharedPiece> SharedPieces;
+
 protected:
   bool flushed = false;
   llvm::FoldingSet<PathDiagnostic> Diags;
@@ -60,6 +60,30 @@ public:
   }
 };
 
+/// A statement-kind subscription on function bodies: the checker is called
+/// back from the single traversal the analyzer performs per body, instead of
+/// re-walking the body with a visitor of its own.
+template <typename STMT>
+class ASTCodeBodyStmt {
+  template <typename CHECKER>
+  static void _checkBodyStmt(void *checker, const Stmt *S, const Decl *D,
+                             AnalysisManager &mgr, BugReporter &BR) {
+    ((const CHECKER *)checker)->checkASTCodeBodyStmt(cast<STMT>(S), D, mgr,
+                                                     BR);
+  }
+
+  static bool _handlesStmt(const Stmt *S) {
+    return isa<STMT>(S);
+  }
+public:
+  template <typename CHECKER>
+  static void _register(CHECKER *checker, CheckerManager &mgr) {
+    mgr._registerForBodyStmt(
+        CheckerManager::CheckBodyStmtFunc(checker, _checkBodyStmt<CHECKER>),
+        _handlesStmt);
+  }
+};
+
 class EndOfTranslationUnit {
   template <typename CHECKER>
   static void _checkEndOfTranslationUnit(void *checker,
@@ -19,8 +19,10 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/Store.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Timer.h"
 #include <vector>
 
 namespace clang {
@@ -187,6 +189,10 @@ public:
                             BugReporter &BR);
 
   /// Run checkers handling Decls containing a Stmt body.
+  ///
+  /// Checkers subscribed to individual statement kinds are notified from a
+  /// single traversal of the body rather than each of them walking it on
+  /// their own.
   void runCheckersOnASTBody(const Decl *D, AnalysisManager& mgr,
                             BugReporter &BR);
 
@@ -417,6 +423,40 @@ public:
                                     unsigned int Space = 0,
                                     bool IsDot = false) const;
 
+  /// Returns true if the 'profile-checkers' config option is set. The run
+  /// functions then measure the time spent in each checker's callbacks, and a
+  /// per-checker report is printed when the manager is destroyed.
+  bool shouldProfileCheckers() const;
+
+  /// Adds \p Time to the accumulated callback time of \p Checker.
+  void accumulateCheckerTime(const CheckerBase *Checker,
+                             const llvm::TimeRecord &Time);
+
+  /// Returns the accumulated callback time of all checkers together. Only
+  /// meaningful when checker profiling is enabled.
+  llvm::TimeRecord getTotalCheckerTime() const;
+
+  /// Invokes \p Fn with the name and accumulated callback time of every
+  /// profiled checker. Only meaningful when checker profiling is enabled.
+  void forEachCheckerTime(
+      llvm::function_ref<void(StringRef, const llvm::TimeRecord &)> Fn) const;
+
+  /// Prints the accumulated per-checker callback times, most expensive
+  /// checker first.
+  void printCheckerProfile(raw_ostream &Out) const;
+
+  /// Returns true if the 'prefer-vetoing-checkers' config option is set. The
+  /// run functions then dispatch to the checkers that have sunk the most
+  /// paths first, so the paths they kill never reach the checkers behind
+  /// them.
+  bool shouldPreferVetoingCheckers() const;
+
+  /// Adds \p N to the number of paths \p Checker has ended with a sink.
+  void noteSunkPaths(const CheckerBase *Checker, unsigned N);
+
+  /// The number of paths \p Checker has ended with a sink so far.
+  uint64_t getSunkPathCount(const CheckerBase *Checker) const;
+
   //===----------------------------------------------------------------------===//
   // Internal registration functions for AST traversing.
   //===----------------------------------------------------------------------===//
@@ -427,12 +467,21 @@ public:
   using CheckDeclFunc =
       CheckerFn<void (const Decl *, AnalysisManager&, BugReporter &)>;
 
+  using CheckBodyStmtFunc =
+      CheckerFn<void (const Stmt *, const Decl *, AnalysisManager &,
+                      BugReporter &)>;
+
   using HandlesDeclFunc = bool (*)(const Decl *D);
 
+  using HandlesStmtFunc = bool (*)(const Stmt *D);
+
   void _registerForDecl(CheckDeclFunc checkfn, HandlesDeclFunc isForDeclFn);
 
   void _registerForBody(CheckDeclFunc checkfn);
 
+  void _registerForBodyStmt(CheckBodyStmtFunc checkfn,
+                            HandlesStmtFunc isForStmtFn);
+
 //===----------------------------------------------------------------------===//
 // Internal registration functions for path-sensitive checking.
 //===----------------------------------------------------------------------===//
@@ -496,8 +545,6 @@ public:
       CheckerFn<void (const TranslationUnitDecl *, AnalysisManager &,
                       BugReporter &)>;
 
-  using HandlesStmtFunc = bool (*)(const Stmt *D);
-
   void _registerForPreStmt(CheckStmtFunc checkfn,
                            HandlesStmtFunc isForStmtFn);
   void _registerForPostStmt(CheckStmtFunc checkfn,
@@ -582,6 +629,15 @@ private:
 
   llvm::DenseMap<CheckerTag, CheckerRef> CheckerTags;
 
+  /// Wall and CPU time spent in each checker's callbacks. Only populated when
+  /// the 'profile-checkers' config option is set.
+  llvm::DenseMap<const CheckerBase *, llvm::TimeRecord> CheckerProfileTimes;
+
+  /// How many paths each checker has ended with a sink. Only populated when
+  /// the 'prefer-vetoing-checkers' config option is set; drives the dispatch
+  /// order of that mode.
+  llvm::DenseMap<const CheckerBase *, uint64_t> SunkPathCounts;
+
   std::vector<CheckerDtor> CheckerDtors;
 
   struct DeclCheckerInfo {
@@ -592,6 +648,19 @@ private:
 
   std::vector<CheckDeclFunc> BodyCheckers;
 
+  struct BodyStmtCheckerInfo {
+    CheckBodyStmtFunc CheckFn;
+    HandlesStmtFunc IsForStmtFn;
+  };
+  std::vector<BodyStmtCheckerInfo> BodyStmtCheckers;
+
+  using CachedBodyStmtCheckers = SmallVector<CheckBodyStmtFunc, 4>;
+  using CachedBodyStmtCheckersMapTy =
+      llvm::DenseMap<unsigned, CachedBodyStmtCheckers>;
+  CachedBodyStmtCheckersMapTy CachedBodyStmtCheckersMap;
+
+  const CachedBodyStmtCheckers &getCachedBodyStmtCheckersFor(const Stmt *S);
+
   using CachedDeclCheckers = SmallVector<CheckDeclFunc, 4>;
   using CachedDeclCheckersMapTy = llvm::DenseMap<unsigned, CachedDeclCheckers>;
   CachedDeclCheckersMapTy CachedDeclCheckersMap;
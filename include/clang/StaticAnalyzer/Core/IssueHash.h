@@ -8,14 +8,34 @@
 #ifndef LLVM_CLANG_STATICANALYZER_CORE_ISSUE_HASH_H
 #define LLVM_CLANG_STATICANALYZER_CORE_ISSUE_HASH_H
 
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallString.h"
 
+#include <string>
+#include <utility>
+
 namespace clang {
 class Decl;
 class SourceManager;
 class FullSourceLoc;
 class LangOptions;
 
+/// Memoizes the most expensive part of issue hashing: the normalized text
+/// of the source line a report points at, which is re-lexed from the buffer
+/// otherwise. Reports cluster on the same hot lines, so callers that hash
+/// many reports (the diagnostic consumers, the report deduplication) should
+/// share one cache across a flush. Entries are keyed by FileID and line
+/// number, so a cache must never be used across SourceManagers.
+class IssueHashLineCache {
+  friend std::string GetIssueString(const SourceManager &, FullSourceLoc &,
+                                    llvm::StringRef, llvm::StringRef,
+                                    const Decl *, const LangOptions &,
+                                    IssueHashLineCache *);
+
+  llvm::DenseMap<std::pair<FileID, unsigned>, std::string> Lines;
+};
+
 /// Get an MD5 hash to help identify bugs.
 ///
 /// This function returns a hash that helps identify bugs within a source file.
@@ -34,17 +54,21 @@ class LangOptions;
 /// possible to introduce experimental hashes that may change in the future.
 /// Such hashes should be marked as experimental using a comment in the plist
 /// files.
+/// \p LineCache, when given, memoizes the line normalization across calls;
+/// see IssueHashLineCache.
 llvm::SmallString<32> GetIssueHash(const SourceManager &SM,
                                    FullSourceLoc &IssueLoc,
                                    llvm::StringRef CheckerName,
                                    llvm::StringRef BugType, const Decl *D,
-                                   const LangOptions &LangOpts);
+                                   const LangOptions &LangOpts,
+                                   IssueHashLineCache *LineCache = nullptr);
 
 /// Get the string representation of issue hash. See GetIssueHash() for
 /// more information.
 std::string GetIssueString(const SourceManager &SM, FullSourceLoc &IssueLoc,
                            llvm::StringRef CheckerName, llvm::StringRef BugType,
-                           const Decl *D, const LangOptions &LangOpts);
+                           const Decl *D, const LangOptions &LangOpts,
+                           IssueHashLineCache *LineCache = nullptr);
 } // namespace clang
 
 #endif
@@ -22,6 +22,7 @@
 
 namespace clang {
 
+class CallArgumentFacts;
 class CodeInjector;
 
 namespace ento {
@@ -42,6 +43,15 @@ class AnalysisManager : public BugReporterData {
 
   CheckerManager *CheckerMgr;
 
+  /// Lazily computed whole-TU call-argument summary; see
+  /// getCallArgumentFacts().
+  std::unique_ptr<CallArgumentFacts> CallArgFacts;
+
+  /// The per-(checker, file) report quota counts; shared by the
+  /// BugReporters of all entry points, see the 'report-quota' config
+  /// option.
+  ReportQuotaState ReportQuota;
+
 public:
   AnalyzerOptions &options;
 
@@ -76,6 +86,9 @@ public:
 
   CheckerManager *getCheckerManager() const { return CheckerMgr; }
 
+  /// Return the whole-TU call-argument summary, computing it on first use.
+  const CallArgumentFacts &getCallArgumentFacts();
+
   ASTContext &getASTContext() override {
     return Ctx;
   }
@@ -88,6 +101,10 @@ public:
     return Diags;
   }
 
+  ReportQuotaState &getReportQuotaState() override {
+    return ReportQuota;
+  }
+
   const LangOptions &getLangOpts() const {
     return LangOpts;
   }
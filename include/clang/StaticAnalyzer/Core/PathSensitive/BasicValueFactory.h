@@ -111,6 +111,23 @@ class BasicValueFactory {
   llvm::BumpPtrAllocator& BPAlloc;
 
   APSIntSetTy APSIntSet;
+
+  /// Direct-indexed caches in front of APSIntSet for the concrete integers
+  /// the analyzer materializes over and over (null and boolean constants,
+  /// array indices, loop bounds, all-ones masks, powers of two from shifts
+  /// and alignments). A hit costs two loads instead of profiling an APInt
+  /// and probing the FoldingSet. All caches are keyed by signedness and bit
+  /// width; a slot is filled the first time the value is interned.
+  enum : unsigned { MaxCachedBitWidth = 64, NumCachedInts = 16 };
+  const llvm::APSInt
+      *SmallIntCache[2][MaxCachedBitWidth + 1][NumCachedInts] = {};
+  const llvm::APSInt *AllOnesCache[2][MaxCachedBitWidth + 1] = {};
+  const llvm::APSInt
+      *Pow2Cache[2][MaxCachedBitWidth + 1][MaxCachedBitWidth] = {};
+
+  /// Returns the cache slot for X, or null if X is not a cached constant.
+  const llvm::APSInt **getSmallIntSlot(const llvm::APSInt &X);
+
   void *PersistentSVals = nullptr;
   void *PersistentSValPairs = nullptr;
 
@@ -21,6 +21,7 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/BugReporter.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/BlockCounter.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/EngineStats.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraph.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState_Fwd.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/WorkList.h"
@@ -96,10 +97,20 @@ private:
   /// (This data is owned by AnalysisConsumer.)
   FunctionSummariesTy *FunctionSummaries;
 
+  /// The 'max-graph-memory' limit in bytes, or 0 for no limit. When the
+  /// graph's allocator (which also holds the states, stores and symbols of
+  /// this entry point) grows past it, the worklist is abandoned like it is
+  /// when the step budget runs out.
+  uint64_t MaxGraphMemory;
+
   /// Add path note tags along the path when we see that something interesting
   /// is happening. This field is the allocator for such tags.
   NoteTag::Factory NoteTags;
 
+  /// How much the ENGINE_STATISTIC counters grew during the last
+  /// ExecuteWorkList call; the per-entry-point share of the statistics.
+  SmallVector<EngineStats::Delta, 8> StatsDeltas;
+
   void generateNode(const ProgramPoint &Loc,
                     ProgramStateRef State,
                     ExplodedNode *Pred);
@@ -201,6 +212,10 @@ public:
   void enqueueStmtNode(ExplodedNode *N, const CFGBlock *Block, unsigned Idx);
 
   NoteTag::Factory &getNoteTags() { return NoteTags; }
+
+  /// The growth of the ENGINE_STATISTIC counters during the last
+  /// ExecuteWorkList call, i.e. the statistics of one entry point.
+  ArrayRef<EngineStats::Delta> getStatsDeltas() const { return StatsDeltas; }
 };
 
 // TODO: Turn into a class.
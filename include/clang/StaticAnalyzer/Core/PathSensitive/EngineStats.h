@@ -0,0 +1,108 @@
+//===- EngineStats.h - Cheap counters for the engine's hot paths -*- C++ -*-==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines EngineCounter, a non-atomic replacement for the
+//  llvm::Statistic objects that sit in the per-node loops of the path
+//  sensitive engine.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_ENGINESTATS_H
+#define LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_ENGINESTATS_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Compiler.h"
+#include <cstdint>
+
+/// Compiles the hot path counters of the engine down to nothing when
+/// defined to 0. The default leaves them on: a plain increment is cheap
+/// enough to ship enabled.
+#ifndef CLANG_ANALYZER_ENGINE_STATS
+#define CLANG_ANALYZER_ENGINE_STATS 1
+#endif
+
+namespace clang {
+namespace ento {
+
+/// A plain counter for the hottest paths of the path sensitive engine.
+///
+/// llvm::Statistic is an atomic whose increment is measurable when it sits
+/// in the loops the engine runs once per exploded node. An EngineCounter
+/// pairs a plain integer with such a Statistic: the hot path pays a
+/// non-atomic increment (the analyzer is single threaded, which makes that
+/// safe) and the accumulated delta is pushed into the Statistic once per
+/// entry point by EngineStats::flush, so the '-stats' output is unchanged.
+///
+/// Define one with the ENGINE_STATISTIC macro.
+class EngineCounter {
+  friend class EngineStats;
+
+  llvm::Statistic &Aggregate;
+  uint64_t Value = 0;
+
+  /// The part of Value already pushed into Aggregate.
+  uint64_t Flushed = 0;
+
+  /// Counters link themselves into the registry on their first increment,
+  /// like llvm::Statistic, so that defining one does not cost a static
+  /// constructor.
+  EngineCounter *Next = nullptr;
+  bool Registered = false;
+
+public:
+  constexpr EngineCounter(llvm::Statistic &Aggregate) : Aggregate(Aggregate) {}
+
+  EngineCounter &operator++() {
+#if CLANG_ANALYZER_ENGINE_STATS
+    if (LLVM_UNLIKELY(!Registered))
+      registerCounter();
+    ++Value;
+#endif
+    return *this;
+  }
+
+  void operator++(int) { ++*this; }
+
+  uint64_t getValue() const { return Value; }
+
+private:
+  void registerCounter();
+};
+
+/// The registry of the EngineCounters that have been incremented.
+class EngineStats {
+  friend class EngineCounter;
+
+  static EngineCounter *Head;
+
+public:
+  /// One counter's growth since the previous flush.
+  struct Delta {
+    const char *Name;
+    uint64_t Value;
+  };
+
+  /// Push the deltas accumulated since the previous flush into the
+  /// aggregate Statistics and, when \p Deltas is given, append the nonzero
+  /// ones to it. CoreEngine flushes at the end of ExecuteWorkList, which
+  /// makes the deltas a per-entry-point breakdown of the counters.
+  static void flush(llvm::SmallVectorImpl<Delta> *Deltas = nullptr);
+};
+
+/// Define a file-local engine counter together with the llvm::Statistic it
+/// aggregates into. As with STATISTIC, DEBUG_TYPE must be defined.
+#define ENGINE_STATISTIC(VARNAME, DESC)                                        \
+  static llvm::Statistic VARNAME##Aggregate = {DEBUG_TYPE, #VARNAME, DESC,     \
+                                               {0}, {false}};                  \
+  static clang::ento::EngineCounter VARNAME(VARNAME##Aggregate)
+
+} // namespace ento
+} // namespace clang
+
+#endif // LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_ENGINESTATS_H
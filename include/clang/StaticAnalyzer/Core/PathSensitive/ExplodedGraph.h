@@ -22,6 +22,7 @@
 #include "clang/Analysis/ProgramPoint.h"
 #include "clang/Analysis/Support/BumpVector.h"
 #include "clang/Basic/LLVM.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraphTrace.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState_Fwd.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SVals.h"
@@ -131,6 +132,11 @@ class ExplodedNode : public llvm::FoldingSetNode {
   /// Succs - The successors of this node.
   NodeGroup Succs;
 
+  /// The most recent reachability pass of ExplodedGraph::trim that visited
+  /// this node. Stamping the nodes makes the visited queries of a pass O(1)
+  /// without building a side table of the whole subgraph.
+  mutable unsigned VisitGeneration = 0;
+
 public:
   explicit ExplodedNode(const ProgramPoint &loc, ProgramStateRef state,
                         bool IsSink)
@@ -280,10 +286,16 @@ protected:
   /// Nodes - The nodes in the graph.
   llvm::FoldingSet<ExplodedNode> Nodes;
 
-  /// BVC - Allocator and context for allocating nodes and their predecessor
-  /// and successor groups.
+  /// BVC - Allocator and context for allocating the predecessor and
+  /// successor groups of the nodes.
   BumpVectorContext BVC;
 
+  /// NodeAlloc - A dedicated arena for the nodes themselves. Keeping the
+  /// nodes out of the edge-group arena packs them contiguously in allocation
+  /// order, which helps the backward walks of the bug reporter visitors that
+  /// traverse nodes in roughly the reverse of that order.
+  llvm::BumpPtrAllocator NodeAlloc;
+
   /// NumNodes - The number of nodes in the graph.
   unsigned NumNodes = 0;
 
@@ -301,6 +313,15 @@ protected:
   /// Counter to determine when to reclaim nodes.
   unsigned ReclaimCounter;
 
+  /// The generation of the latest reachability pass of trim; each pass
+  /// stamps the nodes it reaches with a fresh generation instead of
+  /// collecting them into a visited set.
+  mutable unsigned VisitGeneration = 0;
+
+  /// If non-null, every edge added to the graph is summarized into this
+  /// ring buffer.
+  std::unique_ptr<ExplodedGraphTrace> Trace;
+
 public:
   ExplodedGraph();
   ~ExplodedGraph();
@@ -321,6 +342,15 @@ public:
     ProgramStateRef State,
     bool IsSink = false);
 
+  /// Start summarizing every transition into a ring buffer; see
+  /// ExplodedGraphTrace.
+  void enableTracing() {
+    if (!Trace)
+      Trace = llvm::make_unique<ExplodedGraphTrace>();
+  }
+
+  ExplodedGraphTrace *getTrace() const { return Trace.get(); }
+
   std::unique_ptr<ExplodedGraph> MakeEmptyGraph() const {
     return llvm::make_unique<ExplodedGraph>();
   }
@@ -0,0 +1,98 @@
+//===- ExplodedGraphTrace.h - Binary trace of graph transitions -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines ExplodedGraphTrace, a fixed-size ring buffer of
+//  state-transition summaries that is cheap enough to leave enabled on
+//  production analysis runs. Unlike the Graphviz dump of ViewGraph it records
+//  only a few words per transition, so the entry points responsible for an
+//  exponential blowup can be found without rerunning under a debug build.
+//  The buffer is appended to a file per entry point and decoded offline by
+//  the analyzer-trace-decode tool.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_EXPLODEDGRAPHTRACE_H
+#define LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_EXPLODEDGRAPHTRACE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace clang {
+namespace ento {
+
+class ExplodedGraph;
+class ExplodedNode;
+
+class ExplodedGraphTrace {
+public:
+  /// One state transition. All fields are written to disk verbatim, so the
+  /// layout is part of the trace file format.
+  struct Record {
+    /// IDs of the predecessor and successor node, as returned by
+    /// ExplodedNode::getID.
+    uint64_t PredID;
+    uint64_t SuccID;
+
+    /// The raw encoding of the statement location of the successor's program
+    /// point, or 0 when the point has no statement.
+    uint32_t StmtLoc;
+
+    /// The ProgramPoint::Kind of the successor.
+    uint8_t PointKind;
+
+    /// A bitmask of StateChangeFlags.
+    uint8_t Flags;
+
+    /// Index into the tag string table, or 0 when the point has no tag.
+    uint16_t TagID;
+  };
+
+  /// Which parts of the program state differ between the predecessor and the
+  /// successor. The components are compared by identity, which is exact for
+  /// the store and the generic data map and conservative for the
+  /// environment.
+  enum StateChangeFlags : uint8_t {
+    SCF_Environment = 0x1,
+    SCF_Store = 0x2,
+    SCF_GDM = 0x4,
+    SCF_Sink = 0x8
+  };
+
+  /// The ring keeps the last 2^Log2Capacity transitions; earlier ones are
+  /// overwritten but still counted, so the decoder can report how much of
+  /// the run the buffer covers.
+  explicit ExplodedGraphTrace(unsigned Log2Capacity = 20);
+
+  void recordTransition(const ExplodedNode *Pred, const ExplodedNode *Succ,
+                        ExplodedGraph &G);
+
+  /// Append the buffered transitions as one trace segment named \p
+  /// EntryPoint to \p Path, then reset the buffer for the next entry point.
+  std::error_code appendTo(llvm::StringRef Path, llvm::StringRef EntryPoint);
+
+private:
+  uint16_t getTagID(const void *Tag, llvm::StringRef Description);
+
+  std::vector<Record> Buffer;
+  uint64_t NumRecorded = 0;
+
+  /// Tag descriptions are interned by the identity of the ProgramPointTag,
+  /// which is almost always a static checker tag. ID 0 is reserved for
+  /// "no tag".
+  llvm::DenseMap<const void *, uint16_t> TagIDs;
+  std::vector<std::string> TagNames;
+};
+
+} // namespace ento
+} // namespace clang
+
+#endif // LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_EXPLODEDGRAPHTRACE_H
@@ -350,6 +350,18 @@ public:
                                  ExplodedNode *Pred,
                                  ExplodedNodeSet &Dst);
 
+  /// Remove dead bindings when entering a basic block that does not begin
+  /// with a statement (controlled by the 'purge-dead-on-block-entrance'
+  /// config option). Paths whose states differ only in dead bindings then
+  /// collapse into a single exploded node at the block entrance instead of
+  /// each dragging its stale values through the rest of the function.
+  /// Merging states that differ in live but never-again-observed values
+  /// would additionally require knowing which symbols each checker can
+  /// still observe; nothing models that, so liveness is the strongest safe
+  /// criterion here.
+  void removeDeadOnBlockEntrance(const BlockEdge &L, NodeBuilderWithSinks &Bldr,
+                                 ExplodedNode *Pred);
+
   /// Generate the entry node of the callee.
   void processCallEnter(NodeBuilderContext& BC, CallEnter CE,
                         ExplodedNode *Pred) override;
@@ -677,6 +689,12 @@ public:
                        const EvalCallOptions &CallOpts = {});
 
 private:
+  /// Constrain the parameters of a top-level frame with the facts every
+  /// visible caller guarantees; see CallArgumentFacts.
+  ProgramStateRef seedCallArgumentFacts(ProgramStateRef State,
+                                        const FunctionDecl *FD,
+                                        const LocationContext *InitLoc);
+
   ProgramStateRef finishArgumentConstruction(ProgramStateRef State,
                                              const CallEvent &Call);
   void finishArgumentConstruction(ExplodedNodeSet &Dst, ExplodedNode *Pred,
@@ -748,6 +766,12 @@ private:
   void conservativeEvalCall(const CallEvent &Call, NodeBuilder &Bldr,
                             ExplodedNode *Pred, ProgramStateRef State);
 
+  /// Evaluate the call from the callee's recorded return-value summary, if
+  /// it has one, instead of inlining the body again. Returns true if the
+  /// call was fully modeled by the summary.
+  bool tryApplyReturnSummary(const CallEvent &Call, NodeBuilder &Bldr,
+                             ExplodedNode *Pred, ProgramStateRef State);
+
   /// Either inline or process the call conservatively (or both), based
   /// on DynamicDispatchBifurcation data.
   void BifurcateCall(const MemRegion *BifurReg,
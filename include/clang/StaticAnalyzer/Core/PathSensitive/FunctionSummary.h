@@ -20,16 +20,67 @@
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallBitVector.h"
+#include "llvm/ADT/STLExtras.h"
 #include <cassert>
 #include <deque>
 #include <utility>
 
 namespace clang {
+
+class Expr;
+
 namespace ento {
 
 using SetOfDecls = std::deque<Decl *>;
 using SetOfConstDecls = llvm::DenseSet<const Decl *>;
 
+/// A reusable summary of the return value of a trivial callee: either a
+/// literal from the body, or the argument that is passed through unchanged.
+/// Calls to such callees can be modeled from the summary at every further
+/// call site instead of re-inlining the body.
+class ReturnSummary {
+public:
+  enum SummaryKind {
+    /// The callee returns the stored literal expression.
+    Literal,
+
+    /// The callee returns its parameter with the stored index unchanged.
+    Parameter
+  };
+
+private:
+  SummaryKind Kind;
+  const Expr *Lit = nullptr;
+  unsigned ParamIdx = 0;
+
+  explicit ReturnSummary(SummaryKind K) : Kind(K) {}
+
+public:
+  static ReturnSummary makeLiteral(const Expr *E) {
+    ReturnSummary S(Literal);
+    S.Lit = E;
+    return S;
+  }
+
+  static ReturnSummary makeParameter(unsigned Idx) {
+    ReturnSummary S(Parameter);
+    S.ParamIdx = Idx;
+    return S;
+  }
+
+  SummaryKind getKind() const { return Kind; }
+
+  const Expr *getLiteral() const {
+    assert(Kind == Literal);
+    return Lit;
+  }
+
+  unsigned getParamIndex() const {
+    assert(Kind == Parameter);
+    return ParamIdx;
+  }
+};
+
 class FunctionSummariesTy {
   class FunctionSummary {
   public:
@@ -46,12 +97,35 @@ class FunctionSummariesTy {
     /// True if this function may be inlined.
     unsigned MayInline : 1;
 
+    /// True if the CFG size classification below has been computed.
+    unsigned SizeClassComputed : 1;
+
+    /// The memoized verdicts of the CFG size classification used by the
+    /// inlining heuristics; only meaningful once SizeClassComputed is set.
+    unsigned IsSmall : 1;
+    unsigned IsLarge : 1;
+    unsigned IsHuge : 1;
+
     /// The number of times the function has been inlined.
     unsigned TimesInlined : 32;
 
+    /// The number of basic-block visits the analyzer has recorded in the
+    /// function, over all inlinings and its own top-level analysis. A cheap
+    /// proxy for the number of exploded nodes the function expands into.
+    unsigned NumBlockVisits;
+
+    /// The lazily computed return-value summary; only meaningful once
+    /// RetSummaryComputed is set. None records that the body has no usable
+    /// summary, so it is not inspected again.
+    Optional<ReturnSummary> RetSummary;
+
+    /// True if RetSummary has been computed.
+    unsigned RetSummaryComputed : 1;
+
     FunctionSummary()
         : TotalBasicBlocks(0), InlineChecked(0), MayInline(0),
-          TimesInlined(0) {}
+          SizeClassComputed(0), IsSmall(0), IsLarge(0), IsHuge(0),
+          TimesInlined(0), NumBlockVisits(0), RetSummaryComputed(0) {}
   };
 
   using MapTy = llvm::DenseMap<const Decl *, FunctionSummary>;
@@ -93,6 +167,51 @@ public:
     return None;
   }
 
+  /// Record the CFG size classification of \p D as computed by the inlining
+  /// heuristics, so it is not recomputed for every stack frame at every call
+  /// site.
+  void markSizeClass(const Decl *D, bool Small, bool Large, bool Huge) {
+    MapTy::iterator I = findOrInsertSummary(D);
+    I->second.SizeClassComputed = 1;
+    I->second.IsSmall = Small;
+    I->second.IsLarge = Large;
+    I->second.IsHuge = Huge;
+  }
+
+  Optional<bool> isSmall(const Decl *D) {
+    MapTy::const_iterator I = Map.find(D);
+    if (I != Map.end() && I->second.SizeClassComputed)
+      return I->second.IsSmall;
+    return None;
+  }
+
+  Optional<bool> isLarge(const Decl *D) {
+    MapTy::const_iterator I = Map.find(D);
+    if (I != Map.end() && I->second.SizeClassComputed)
+      return I->second.IsLarge;
+    return None;
+  }
+
+  Optional<bool> isHuge(const Decl *D) {
+    MapTy::const_iterator I = Map.find(D);
+    if (I != Map.end() && I->second.SizeClassComputed)
+      return I->second.IsHuge;
+    return None;
+  }
+
+  /// Return the cached return-value summary of \p D, computing it with
+  /// \p Compute on the first query. None means the body has no usable
+  /// summary.
+  Optional<ReturnSummary> getOrComputeReturnSummary(
+      const Decl *D, llvm::function_ref<Optional<ReturnSummary>()> Compute) {
+    MapTy::iterator I = findOrInsertSummary(D);
+    if (!I->second.RetSummaryComputed) {
+      I->second.RetSummary = Compute();
+      I->second.RetSummaryComputed = 1;
+    }
+    return I->second.RetSummary;
+  }
+
   void markVisitedBasicBlock(unsigned ID, const Decl* D, unsigned TotalIDs) {
     MapTy::iterator I = findOrInsertSummary(D);
     llvm::SmallBitVector &Blocks = I->second.VisitedBasicBlocks;
@@ -102,6 +221,14 @@ public:
       I->second.TotalBasicBlocks = TotalIDs;
     }
     Blocks.set(ID);
+    I->second.NumBlockVisits++;
+  }
+
+  unsigned getNumBlockVisits(const Decl *D) {
+    MapTy::const_iterator I = Map.find(D);
+    if (I != Map.end())
+      return I->second.NumBlockVisits;
+    return 0;
   }
 
   unsigned getNumVisitedBasicBlocks(const Decl* D) {
@@ -25,9 +25,15 @@ namespace ento {
 ///
 /// Widen the loop by invalidating anything that might be modified
 /// by the loop body in any iteration.
+///
+/// If \p OnlyModified is set, only the variables the loop can actually
+/// modify are invalidated, provided every effect of the loop can be
+/// attributed to a specific variable; otherwise the behavior falls back to
+/// invalidating everything reachable.
 ProgramStateRef getWidenedLoopState(ProgramStateRef PrevState,
                                     const LocationContext *LCtx,
-                                    unsigned BlockCount, const Stmt *LoopStmt);
+                                    unsigned BlockCount, const Stmt *LoopStmt,
+                                    bool OnlyModified = false);
 
 } // end namespace ento
 } // end namespace clang
@@ -103,6 +103,15 @@ private:
   const Kind kind;
   mutable Optional<RegionOffset> cachedOffset;
 
+  /// A dense identifier, unique within this region's MemRegionManager and
+  /// assigned in creation order. It allows sets of regions to be represented
+  /// as bitmaps indexed by identifier instead of hash tables of pointers;
+  /// SymbolReaper uses this for its live region roots. The identifier carries
+  /// no meaning across different MemRegionManager instances.
+  unsigned Id = 0;
+
+  friend class MemRegionManager;
+
 protected:
   MemRegion(Kind k) : kind(k) {}
   virtual ~MemRegion();
@@ -168,6 +177,10 @@ public:
 
   Kind getKind() const { return kind; }
 
+  /// Return the dense identifier assigned to this region by its
+  /// MemRegionManager.
+  unsigned getID() const { return Id; }
+
   template<typename RegionTy> const RegionTy* getAs() const;
 
   virtual bool isBoundable() const { return false; }
@@ -1240,6 +1253,10 @@ class MemRegionManager {
   llvm::BumpPtrAllocator& A;
   llvm::FoldingSet<MemRegion> Regions;
 
+  /// The dense identifier handed to the next region allocated by this
+  /// manager (see MemRegion::getID).
+  unsigned NextRegionId = 0;
+
   GlobalInternalSpaceRegion *InternalGlobals = nullptr;
   GlobalSystemSpaceRegion *SystemGlobals = nullptr;
   GlobalImmutableSpaceRegion *ImmutableGlobals = nullptr;
@@ -1471,6 +1488,10 @@ public:
   void setTrait(const MemRegion *MR, InvalidationKinds IK);
   bool hasTrait(SymbolRef Sym, InvalidationKinds IK) const;
   bool hasTrait(const MemRegion *MR, InvalidationKinds IK) const;
+
+  /// Returns true if \p IK is set for any region at all. Lets clients skip
+  /// per-region queries when the trait was never requested.
+  bool hasTraitForAnyRegion(InvalidationKinds IK) const;
 };
 
 //===----------------------------------------------------------------------===//
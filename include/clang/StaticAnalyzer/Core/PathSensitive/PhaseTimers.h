@@ -0,0 +1,111 @@
+//===- PhaseTimers.h - Hierarchical timers for analyzer phases --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines a tree of named wall/CPU timers covering the phases of
+//  a translation unit's analysis (see the 'phase-timers' config option).
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_PHASETIMERS_H
+#define LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_PHASETIMERS_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Timer.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace ento {
+
+class PhaseTimerScope;
+
+/// A tree of named wall/CPU timers covering the phases of a translation
+/// unit's analysis: parsing, CFG construction, checker callbacks, store
+/// operations, bug reporting and CTU import. Phases nest dynamically: a
+/// scope opened while another one is active becomes a child of it, so the
+/// report shows where inside the exploration the time went rather than one
+/// flat total per phase.
+///
+/// The registry is process global and, like the rest of the analyzer, must
+/// only be used from one thread at a time. When disabled it costs a single
+/// branch per scope.
+class PhaseTimers {
+public:
+  struct Node {
+    std::string Name;
+    llvm::TimeRecord Time;
+    uint64_t Invocations = 0;
+    std::vector<std::unique_ptr<Node>> Children;
+
+    Node *getOrCreateChild(llvm::StringRef ChildName);
+  };
+
+  static bool isEnabled() { return Enabled; }
+
+  /// Start collecting samples. Enabled once and for all; the samples are
+  /// pruned per translation unit by reset().
+  static void enable() { Enabled = true; }
+
+  /// Attribute \p Time to the child \p Name of the innermost open scope,
+  /// for callers that have already measured a duration themselves.
+  static void addSample(llvm::StringRef Name, const llvm::TimeRecord &Time);
+
+  /// Same, with an intermediate \p Group node collecting the samples.
+  static void addSample(llvm::StringRef Group, llvm::StringRef Name,
+                        const llvm::TimeRecord &Time);
+
+  /// Print the tree as an indented human readable table, most expensive
+  /// phase first.
+  static void print(llvm::raw_ostream &OS);
+
+  /// Print the tree as JSON (see the 'phase-timers-json' config option).
+  static void printJSON(llvm::raw_ostream &OS);
+
+  /// Drop the samples of the current translation unit.
+  static void reset();
+
+private:
+  friend class PhaseTimerScope;
+
+  static bool Enabled;
+  static Node Root;
+  static Node *Current;
+};
+
+/// RAII handle opening a named phase. Cheap when the timers are disabled.
+class PhaseTimerScope {
+public:
+  explicit PhaseTimerScope(llvm::StringRef Name) {
+    if (PhaseTimers::isEnabled())
+      open(Name);
+  }
+
+  ~PhaseTimerScope() {
+    if (Parent)
+      close();
+  }
+
+  PhaseTimerScope(const PhaseTimerScope &) = delete;
+  PhaseTimerScope &operator=(const PhaseTimerScope &) = delete;
+
+private:
+  void open(llvm::StringRef Name);
+  void close();
+
+  /// The node to restore as the innermost scope, or null when the timers
+  /// are disabled or this is a recursive re-entry (whose time the outer
+  /// scope already covers).
+  PhaseTimers::Node *Parent = nullptr;
+  llvm::TimeRecord Start;
+};
+
+} // namespace ento
+} // namespace clang
+
+#endif // LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_PHASETIMERS_H
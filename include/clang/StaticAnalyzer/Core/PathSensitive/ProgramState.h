@@ -23,6 +23,7 @@
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/ImmutableMap.h"
 #include "llvm/Support/Allocator.h"
+#include <memory>
 #include <utility>
 
 namespace llvm {
@@ -37,6 +38,8 @@ namespace ento {
 class AnalysisManager;
 class CallEvent;
 class CallEventManager;
+class GDMTrieFactory;
+class GDMTrieNode;
 
 typedef std::unique_ptr<ConstraintManager>(*ConstraintManagerCreator)(
     ProgramStateManager &, SubEngine *);
@@ -72,12 +75,65 @@ template <typename T> struct ProgramStateTrait {
 class ProgramState : public llvm::FoldingSetNode {
 public:
   typedef llvm::ImmutableSet<llvm::APSInt*>                IntSetTy;
-  typedef llvm::ImmutableMap<void*, void*>                 GenericDataMap;
+
+  /// GenericDataMap - The map from a trait tag to the trait's opaque data.
+  ///
+  /// All traits share a single immutable hash-array-mapped trie keyed by the
+  /// tag pointer, so updating one trait copies only the nodes on that tag's
+  /// path and the rest of the map is structurally shared between states.
+  /// The factory uniques nodes, which keeps map equality and profiling (the
+  /// hot part of ProgramStateManager::getPersistentState) a root pointer
+  /// comparison.
+  class GenericDataMap {
+  public:
+    class Factory;
+
+  private:
+    friend class Factory;
+
+    const GDMTrieNode *Root = nullptr;
+
+    explicit GenericDataMap(const GDMTrieNode *R) : Root(R) {}
+
+  public:
+    GenericDataMap() = default;
+
+    /// Return a pointer to the data attached to \p Tag, or null if the map
+    /// contains no entry for it.
+    void *const *lookup(void *Tag) const;
+
+    bool operator==(const GenericDataMap &RHS) const {
+      return Root == RHS.Root;
+    }
+    bool operator!=(const GenericDataMap &RHS) const {
+      return Root != RHS.Root;
+    }
+
+    void Profile(llvm::FoldingSetNodeID &ID) const { ID.AddPointer(Root); }
+
+    class Factory {
+      std::unique_ptr<GDMTrieFactory> Impl;
+
+    public:
+      Factory(llvm::BumpPtrAllocator &Alloc);
+      ~Factory();
+
+      GenericDataMap getEmptyMap() { return GenericDataMap(); }
+
+      /// Return a map with \p Data attached to \p Tag, overwriting any
+      /// previous entry for it.
+      GenericDataMap add(GenericDataMap M, void *Tag, void *Data);
+
+      /// Return a map with the entry for \p Tag removed.
+      GenericDataMap remove(GenericDataMap M, void *Tag);
+    };
+  };
 
 private:
   void operator=(const ProgramState& R) = delete;
 
   friend class ProgramStateManager;
+  friend class ProgramStateTransaction;
   friend class ExplodedGraph;
   friend class ExplodedNode;
 
@@ -133,6 +189,10 @@ public:
   /// Profile - Profile the contents of a ProgramState object for use in a
   ///  FoldingSet.  Two ProgramState objects are considered equal if they
   ///  have the same Environment, Store, and GenericDataMap.
+  /// The interning key is cheap by construction: every sub-state is already
+  /// canonicalized by its own factory (the environment and GDM by their map
+  /// factories, the store by the store manager), so profiling the three
+  /// root pointers identifies the full contents without rehashing them.
   static void Profile(llvm::FoldingSetNodeID& ID, const ProgramState *V) {
     V->Env.Profile(ID);
     ID.AddPointer(V->store);
@@ -455,6 +515,7 @@ private:
 
 class ProgramStateManager {
   friend class ProgramState;
+  friend class ProgramStateTransaction;
   friend void ProgramStateRelease(const ProgramState *state);
 private:
   /// Eng - The SubEngine that owns this state manager.
@@ -637,6 +698,90 @@ public:
 };
 
 
+//===----------------------------------------------------------------------===//
+// ProgramStateTransaction - Batched trait edits against a base state.
+//===----------------------------------------------------------------------===//
+
+/// Accumulates several trait edits against a base state and interns the
+/// combined result once.
+///
+/// Each ProgramState::set/add/remove call profiles and interns an
+/// intermediate state in the manager's state set even when the caller
+/// immediately overwrites it with the next edit. Callbacks that perform
+/// several trait writes in a row can batch them through a transaction so
+/// that only the final state is interned:
+///
+/// \code
+///   ProgramStateTransaction T(State);
+///   T.set<RegionMap>(R, V);
+///   T.remove<PendingInits>(R);
+///   return C.addTransition(T.commit());
+/// \endcode
+///
+/// Store and environment updates are deliberately not covered: bindLoc
+/// notifies checkers of region changes through processRegionChange, which
+/// must observe a fully-built state per binding.
+class ProgramStateTransaction {
+  ProgramStateRef Base;
+  ProgramState::GenericDataMap GDM;
+
+  void addGDM(void *Key, void *Data);
+
+public:
+  explicit ProgramStateTransaction(ProgramStateRef St)
+      : Base(std::move(St)), GDM(Base->getGDM()) {}
+
+  /// Return the value of a trait, reflecting any edits already accumulated
+  /// in this transaction.
+  template <typename T>
+  typename ProgramStateTrait<T>::data_type get() const {
+    return ProgramStateTrait<T>::MakeData(
+        GDM.lookup(ProgramStateTrait<T>::GDMIndex()));
+  }
+
+  template <typename T>
+  typename ProgramStateTrait<T>::lookup_type
+  get(typename ProgramStateTrait<T>::key_type K) const {
+    return ProgramStateTrait<T>::Lookup(get<T>(), K);
+  }
+
+  template <typename T>
+  ProgramStateTransaction &set(typename ProgramStateTrait<T>::data_type D) {
+    addGDM(ProgramStateTrait<T>::GDMIndex(),
+           ProgramStateTrait<T>::MakeVoidPtr(D));
+    return *this;
+  }
+
+  template <typename T>
+  ProgramStateTransaction &set(typename ProgramStateTrait<T>::key_type K,
+                               typename ProgramStateTrait<T>::value_type E) {
+    addGDM(ProgramStateTrait<T>::GDMIndex(),
+           ProgramStateTrait<T>::MakeVoidPtr(ProgramStateTrait<T>::Set(
+               get<T>(), K, E, Base->get_context<T>())));
+    return *this;
+  }
+
+  template <typename T>
+  ProgramStateTransaction &add(typename ProgramStateTrait<T>::key_type K) {
+    addGDM(ProgramStateTrait<T>::GDMIndex(),
+           ProgramStateTrait<T>::MakeVoidPtr(ProgramStateTrait<T>::Add(
+               get<T>(), K, Base->get_context<T>())));
+    return *this;
+  }
+
+  template <typename T>
+  ProgramStateTransaction &remove(typename ProgramStateTrait<T>::key_type K) {
+    addGDM(ProgramStateTrait<T>::GDMIndex(),
+           ProgramStateTrait<T>::MakeVoidPtr(ProgramStateTrait<T>::Remove(
+               get<T>(), K, Base->get_context<T>())));
+    return *this;
+  }
+
+  /// Intern the accumulated edits as a single state. Returns the base state
+  /// unchanged if no edit modified the map.
+  ProgramStateRef commit();
+};
+
 //===----------------------------------------------------------------------===//
 // Out-of-line method definitions for ProgramState.
 //===----------------------------------------------------------------------===//
@@ -107,10 +107,16 @@ private:
                         PrimRangeSet::iterator &e) const;
 
   const llvm::APSInt &getMinValue() const;
+  const llvm::APSInt &getMaxValue() const;
 
   bool pin(llvm::APSInt &Lower, llvm::APSInt &Upper) const;
 
 public:
+  /// Returns true if the set contains \p Point, which must be representable
+  /// in the type of the set's values. Unlike Intersect, this is a read-only
+  /// query and allocates nothing.
+  bool contains(llvm::APSInt Point) const;
+
   RangeSet Intersect(BasicValueFactory &BV, Factory &F, llvm::APSInt Lower,
                      llvm::APSInt Upper) const;
   RangeSet Intersect(BasicValueFactory &BV, Factory &F,
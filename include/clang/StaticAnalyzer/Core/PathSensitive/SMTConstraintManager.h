@@ -17,6 +17,8 @@
 #include "clang/Basic/JsonSupport.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/RangedConstraintManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SMTConv.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 
 typedef llvm::ImmutableSet<
     std::pair<clang::ento::SymbolRef, const llvm::SMTExpr *>>
@@ -123,7 +125,16 @@ public:
       llvm::SMTExprRef Exp =
           SMTConv::fromData(Solver, SD->getSymbolID(), Ty, Ctx.getTypeSize(Ty));
 
-      Solver->reset();
+      // The interpretation queries below manipulate the solver outside of
+      // syncSolver()'s stack discipline, so leave the solver empty again on
+      // every path out of this block; otherwise the next synchronization
+      // would assert on top of these leftover constraints.
+      struct SolverResetter {
+        const SMTConstraintManager &CM;
+        ~SolverResetter() { CM.resetSolver(); }
+      } Resetter{*this};
+
+      resetSolver();
       addStateConstraints(State);
 
       // Constraints are unsatisfiable
@@ -322,6 +333,50 @@ protected:
     }
   }
 
+  /// Discard all solver assertions and forget the mirrored assertion stack.
+  /// Must be used instead of Solver->reset() whenever the solver is
+  /// manipulated outside of syncSolver(), or the stack bookkeeping goes
+  /// stale; it must also run again before such a manipulation returns, so
+  /// that the solver and the (empty) mirror agree.
+  void resetSolver() const {
+    Solver->reset();
+    AssertedConstraints.clear();
+    AssertedExprs.clear();
+  }
+
+  /// Bring the solver's assertion stack in sync with the given constraint
+  /// set. Successive queries share all but the newest constraints, so
+  /// instead of resetting the solver and re-asserting the whole set we keep
+  /// one backtracking point per asserted constraint: constraints no longer
+  /// in the set are popped and only the delta is asserted on top. When
+  /// exploration jumps to an unrelated path this degenerates into popping
+  /// most of the stack, which is no worse than a reset.
+  void syncSolver(const ConstraintSMTType &CS) const {
+    // Find the longest prefix of the stack that is still part of the set.
+    unsigned Keep = 0;
+    while (Keep < AssertedConstraints.size() &&
+           CS.contains(AssertedConstraints[Keep]))
+      ++Keep;
+
+    if (unsigned Drop = AssertedConstraints.size() - Keep) {
+      Solver->pop(Drop);
+      for (unsigned I = Keep, E = AssertedConstraints.size(); I != E; ++I)
+        AssertedExprs.erase(AssertedConstraints[I].second);
+      AssertedConstraints.resize(Keep);
+    }
+
+    // Assert whatever the remaining stack does not cover yet.
+    for (auto I = CS.begin(), E = CS.end(); I != E; ++I) {
+      if (!AssertedExprs.insert(I->second).second)
+        continue;
+
+      Solver->push();
+      llvm::SMTExprRef Constraint = I->second;
+      Solver->addConstraint(Constraint);
+      AssertedConstraints.push_back(*I);
+    }
+  }
+
   // Generate and check a Z3 model, using the given constraint.
   ConditionTruthVal checkModel(ProgramStateRef State, SymbolRef Sym,
                                const llvm::SMTExprRef &Exp) const {
@@ -336,8 +391,7 @@ protected:
     if (I != Cached.end())
       return I->second;
 
-    Solver->reset();
-    addStateConstraints(NewState);
+    syncSolver(NewState->get<ConstraintSMT>());
 
     Optional<bool> res = Solver->check();
     if (!res.hasValue())
@@ -351,6 +405,13 @@ protected:
   // Cache the result of an SMT query (true, false, unknown). The key is the
   // hash of the constraints in a state
   mutable llvm::DenseMap<unsigned, ConditionTruthVal> Cached;
+
+  // The solver's assertion stack, one backtracking point per constraint, in
+  // assertion order. AssertedExprs mirrors it for cheap membership tests
+  // when computing the delta of the next query.
+  mutable llvm::SmallVector<std::pair<SymbolRef, const llvm::SMTExpr *>, 16>
+      AssertedConstraints;
+  mutable llvm::SmallPtrSet<const llvm::SMTExpr *, 16> AssertedExprs;
 }; // end class SMTConstraintManager
 
 } // namespace ento
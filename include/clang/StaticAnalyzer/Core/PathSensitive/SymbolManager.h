@@ -24,12 +24,16 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/SparseBitVector.h"
 #include "llvm/Support/Allocator.h"
 #include <cassert>
 
 namespace clang {
 
 class ASTContext;
+class CFGBlock;
+class RelaxedLiveVariables;
 class Stmt;
 
 namespace ento {
@@ -553,19 +557,42 @@ class SymbolReaper {
 
   using SymbolSetTy = llvm::DenseSet<SymbolRef>;
   using SymbolMapTy = llvm::DenseMap<SymbolRef, SymbolStatus>;
-  using RegionSetTy = llvm::DenseSet<const MemRegion *>;
+  using RegionSetTy = SmallVector<const MemRegion *, 16>;
 
   SymbolMapTy TheLiving;
   SymbolSetTy MetadataInUse;
 
+  /// The base regions marked live, in the order they were marked.
   RegionSetTy RegionRoots;
 
+  /// Bitmap over the dense region identifiers (MemRegion::getID) of the
+  /// members of RegionRoots, so membership tests during the store scan are
+  /// bit tests instead of pointer hashing.
+  llvm::SparseBitVector<> LiveRegionRoots;
+
   const StackFrameContext *LCtx;
   const Stmt *Loc;
+
+  /// When set, liveness is anchored at the exit of this basic block instead
+  /// of at a statement; see the block-edge constructor below.
+  const CFGBlock *Block = nullptr;
+
   SymbolManager& SymMgr;
   StoreRef reapedStore;
   llvm::DenseMap<const MemRegion *, unsigned> includedRegionCache;
 
+  /// The liveness analysis of the reaper's own location context, looked up
+  /// lazily on the first query. LCtx and Loc are fixed for the lifetime of
+  /// the reaper, so the analysis is fetched once per removeDeadBindings pass
+  /// rather than once per liveness query.
+  RelaxedLiveVariables *cachedLiveVariables = nullptr;
+
+  /// Caches whether values bound in a given location context are still in
+  /// scope at the reaper's own location context, so the parent-chain walk is
+  /// performed once per distinct context rather than once per environment
+  /// binding.
+  llvm::DenseMap<const LocationContext *, unsigned> scopeCache;
+
 public:
   /// Construct a reaper object, which removes everything which is not
   /// live before we execute statement s in the given location context.
@@ -578,6 +605,18 @@ public:
                SymbolManager &symmgr, StoreManager &storeMgr)
       : LCtx(Ctx), Loc(s), SymMgr(symmgr), reapedStore(nullptr, storeMgr) {}
 
+  /// Construct a reaper anchored at the exit of the given basic block,
+  /// which removes everything that is not live when the block's outgoing
+  /// edges are taken. Used when purging on a block-entrance edge, where no
+  /// statement is available as an anchor. Block-exit liveness
+  /// over-approximates the liveness on any single outgoing edge, and
+  /// expression values are kept alive wholesale, so this is never more
+  /// aggressive than a statement-anchored reaper.
+  SymbolReaper(const StackFrameContext *Ctx, const CFGBlock *B,
+               SymbolManager &symmgr, StoreManager &storeMgr)
+      : LCtx(Ctx), Loc(nullptr), Block(B), SymMgr(symmgr),
+        reapedStore(nullptr, storeMgr) {}
+
   const LocationContext *getLocationContext() const { return LCtx; }
 
   bool isLive(SymbolRef sym);
@@ -624,6 +663,10 @@ public:
 private:
   /// Mark the symbols dependent on the input symbol as live.
   void markDependentsLive(SymbolRef sym);
+
+  /// Return the liveness analysis of the reaper's own location context,
+  /// running it lazily if necessary.
+  RelaxedLiveVariables *getLiveVariables() const;
 };
 
 class SymbolVisitor {
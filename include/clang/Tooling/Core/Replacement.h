@@ -328,6 +328,15 @@ bool applyAllReplacements(const Replacements &Replaces, Rewriter &Rewrite);
 llvm::Expected<std::string> applyAllReplacements(StringRef Code,
                                                  const Replacements &Replaces);
 
+/// Applies all replacements in \p Replaces to \p Code, streaming the result
+/// to \p OS as alternating spans of the original buffer and replacement
+/// texts, without materializing the changed code in memory. \p Code may be a
+/// memory-mapped buffer; it is only read.
+///
+/// This completely ignores the path stored in each replacement.
+llvm::Error applyAllReplacements(StringRef Code, const Replacements &Replaces,
+                                 llvm::raw_ostream &OS);
+
 /// Collection of Replacements generated from a single translation unit.
 struct TranslationUnitReplacements {
   /// Name of the main source for the translation unit.
@@ -21,6 +21,8 @@ namespace clang {
 namespace tooling {
 namespace dependencies {
 
+class DependencyScanningFilesystemSharedCache;
+
 /// An individual dependency scanning worker that is able to run on its own
 /// thread.
 ///
@@ -29,7 +31,14 @@ namespace dependencies {
 /// using the regular processing run.
 class DependencyScanningWorker {
 public:
-  DependencyScanningWorker();
+  /// Construct a worker.
+  ///
+  /// \param SharedCache The cache of minimized files shared between all the
+  /// workers of the tool. When non-null, the worker preprocesses minimized
+  /// sources served from the cache; when null, it preprocesses the original
+  /// sources.
+  DependencyScanningWorker(
+      DependencyScanningFilesystemSharedCache *SharedCache = nullptr);
 
   /// Print out the dependency information into a string using the dependency
   /// file format that is specified in the options (-MD is the default) and
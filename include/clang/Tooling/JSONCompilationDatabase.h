@@ -105,6 +105,19 @@ private:
   /// failed.
   bool parse(std::string &ErrorMessage);
 
+  /// Indexes the database without parsing it: a single raw scan over the
+  /// buffer validates the structure, slices the top level array into the
+  /// byte ranges of its entries and indexes them by the (unescaped) 'file'
+  /// values. The YAML parser then only ever sees the entries a caller
+  /// actually requests, which makes loading a large database cheap for
+  /// tools that query a handful of files.
+  ///
+  /// Only the strict JSON subset that compilation database generators emit
+  /// is understood. Returns false on any input outside of it — including
+  /// entries the full parser would reject — in which case the caller must
+  /// fall back to parse() for the exact error message.
+  bool scanLazily();
+
   // Tuple (directory, filename, commandline, output) where 'commandline'
   // points to the corresponding scalar nodes in the YAML stream.
   // If the command line contains a single argument, it is a shell-escaped
@@ -121,6 +134,18 @@ private:
   void getCommands(ArrayRef<CompileCommandRef> CommandsRef,
                    std::vector<CompileCommand> &Commands) const;
 
+  /// Parses one object of the database array into a command reference and
+  /// the native path of its 'file' entry. Shared between parse() and the
+  /// lazily sliced entries.
+  static bool parseEntryNode(llvm::yaml::Node &Object, CompileCommandRef &Ref,
+                             SmallVectorImpl<char> &NativeFilePath,
+                             std::string &ErrorMessage);
+
+  /// Parses the given lazily sliced entries and appends the resulting
+  /// commands.
+  void getCommandsFromSlices(ArrayRef<StringRef> Slices,
+                             std::vector<CompileCommand> &Commands) const;
+
   // Maps file paths to the compile command lines for that file.
   llvm::StringMap<std::vector<CompileCommandRef>> IndexByFile;
 
@@ -128,6 +153,13 @@ private:
   /// JSON stream.
   std::vector<CompileCommandRef> AllCommands;
 
+  /// The lazily indexed counterparts of IndexByFile and AllCommands: the
+  /// unparsed byte ranges of the database's entries, in database order.
+  /// Only used when scanLazily() succeeded.
+  llvm::StringMap<std::vector<StringRef>> SliceIndexByFile;
+  std::vector<StringRef> AllSlices;
+  bool IsLazilyIndexed = false;
+
   FileMatchTrie MatchTrie;
 
   std::unique_ptr<llvm::MemoryBuffer> Database;
@@ -0,0 +1,43 @@
+//===--- RawTokenHash.h - Token hashing of AST nodes ------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file exposes raw token hashing for AST nodes, so tools can detect
+//  whether a declaration changed between runs by comparing hashes that are
+//  computed at lexing speed. Example:
+//
+//    const FunctionDecl *FD;
+//    uint64_t Hash = tooling::getRawTokenHash(*FD, Context);
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_RAWTOKENHASH_H
+#define LLVM_CLANG_TOOLING_RAWTOKENHASH_H
+
+#include "clang/AST/ASTContext.h"
+#include "clang/Lex/RawTokenHash.h"
+
+namespace clang {
+namespace tooling {
+
+/// Returns a stable 64-bit hash of the raw tokens spelled by \p Node.
+///
+/// The hash only depends on the token spellings, so reformatting and comment
+/// edits do not change it; see clang::hashRawTokensInRange for the exact
+/// guarantees. Nodes whose range does not map to a contiguous piece of one
+/// file hash to 0.
+template <typename T>
+uint64_t getRawTokenHash(const T &Node, const ASTContext &Context) {
+  return hashRawTokensInRange(
+      CharSourceRange::getTokenRange(Node.getSourceRange()),
+      Context.getSourceManager(), Context.getLangOpts());
+}
+
+} // namespace tooling
+} // namespace clang
+
+#endif // LLVM_CLANG_TOOLING_RAWTOKENHASH_H
@@ -0,0 +1,83 @@
+//===--- DeclExtentIndex.h - Clang refactoring library ----------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_REFACTORING_DECLEXTENTINDEX_H
+#define LLVM_CLANG_TOOLING_REFACTORING_DECLEXTENTINDEX_H
+
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include <vector>
+
+namespace clang {
+
+class ASTContext;
+class Decl;
+
+namespace tooling {
+
+/// An index over the file extents of the top-level declarations of a
+/// translation unit.
+///
+/// Location-based queries such as "which node is under the cursor" or "which
+/// nodes overlap the selection" can only produce results inside the top-level
+/// declarations whose extents intersect the queried range, yet the finders
+/// used to consider every top-level declaration per query. The index sorts
+/// the extents once per file, lazily, and then answers intersection queries
+/// with a binary search.
+class DeclExtentIndex {
+public:
+  explicit DeclExtentIndex(const ASTContext &Context) : Context(Context) {}
+
+  /// Appends the top-level declarations of \p File whose extents intersect
+  /// the offset range [BeginOffset, EndOffset] to \p Result, in lexical
+  /// order. Declarations whose lexical end cannot be pinned down in \p File
+  /// (macro-generated code, Objective-C implementations whose lexical end
+  /// lies past their source range) intersect every query: the result
+  /// over-approximates and never misses a candidate.
+  void declsIntersecting(FileID File, unsigned BeginOffset, unsigned EndOffset,
+                         SmallVectorImpl<Decl *> &Result) const;
+
+  /// Appends the top-level declarations whose extents contain \p Loc to
+  /// \p Result. Unlike the plain range query this also walks the include
+  /// chain of the location's file, so a declaration spanning the include
+  /// site - e.g. a namespace whose body includes the header \p Loc lies in -
+  /// is found as well.
+  void declsContainingLoc(SourceLocation Loc,
+                          SmallVectorImpl<Decl *> &Result) const;
+
+private:
+  /// The extent of one top-level declaration, in file offsets.
+  struct Extent {
+    unsigned Begin;
+    /// One past the last character of the declaration's final token, or
+    /// UINT_MAX when the lexical end cannot be determined.
+    unsigned End;
+    /// Running maximum of the extent ends up to and including this entry.
+    /// It is non-decreasing over the sorted array, so the first extent that
+    /// can reach a queried range is found by binary search.
+    unsigned MaxEnd;
+    Decl *D;
+  };
+
+  /// The extents of the top-level declarations of one file, sorted by their
+  /// begin offset.
+  struct FileIndex {
+    std::vector<Extent> Extents;
+  };
+
+  const FileIndex &getFileIndex(FileID File) const;
+
+  const ASTContext &Context;
+  mutable llvm::DenseMap<FileID, FileIndex> FileIndices;
+};
+
+} // end namespace tooling
+} // end namespace clang
+
+#endif // LLVM_CLANG_TOOLING_REFACTORING_DECLEXTENTINDEX_H
@@ -228,6 +228,36 @@ std::unique_ptr<ASTUnit> buildASTFromCodeWithArgs(
         std::make_shared<PCHContainerOperations>(),
     ArgumentsAdjuster Adjuster = getClangStripDependencyFileAdjuster());
 
+/// Caches parsed CompilerInvocations across the files of a tool run.
+///
+/// The compile commands of a build differ almost exclusively in the input
+/// and output paths; the remaining cc1 argument vector — the "shape" of the
+/// command line — is shared by thousands of commands, and parsing it into a
+/// CompilerInvocation costs several milliseconds per file. The cache keys on
+/// the argument vector with the per-file values blanked out, runs the full
+/// parse once per unique shape, and afterwards hands out copies of the
+/// parsed template patched with the per-file values.
+///
+/// Note that option diagnostics (e.g. unknown argument warnings) are only
+/// emitted by the full parse, so they appear once per shape rather than once
+/// per file.
+class InvocationTemplateCache {
+public:
+  InvocationTemplateCache();
+  ~InvocationTemplateCache();
+
+  /// Parse \p CC1Args into a CompilerInvocation the same way
+  /// tooling::newInvocation() does, reusing the parse of an earlier argument
+  /// vector of the same shape when one is cached. The caller owns the result.
+  CompilerInvocation *newInvocation(DiagnosticsEngine *Diagnostics,
+                                    const llvm::opt::ArgStringList &CC1Args);
+
+private:
+  /// The parsed invocation of every command-line shape seen so far, keyed by
+  /// the rendered argument vector with the per-file values blanked out.
+  llvm::StringMap<std::unique_ptr<CompilerInvocation>> Templates;
+};
+
 /// Utility to run a FrontendAction in a single clang invocation.
 class ToolInvocation {
 public:
@@ -265,6 +295,13 @@ public:
     this->DiagConsumer = DiagConsumer;
   }
 
+  /// Use \p Cache to amortize the option parsing across invocations that
+  /// share their command-line shape. The cache must outlive the invocation;
+  /// ClangTool sets its own cache on the invocations it creates.
+  void setInvocationTemplateCache(InvocationTemplateCache *Cache) {
+    this->TemplateCache = Cache;
+  }
+
   /// Map a virtual file to be used while running the tool.
   ///
   /// \param FilePath The path at which the content will be mapped.
@@ -293,6 +330,7 @@ public:
   // Maps <file name> -> <file content>.
   llvm::StringMap<StringRef> MappedFileContents;
   DiagnosticConsumer *DiagConsumer = nullptr;
+  InvocationTemplateCache *TemplateCache = nullptr;
 };
 
 /// Utility to run a FrontendAction over a set of files.
@@ -389,6 +427,10 @@ private:
 
   DiagnosticConsumer *DiagConsumer = nullptr;
 
+  /// Amortizes the option parsing across the near-identical compile commands
+  /// of the run; shared by all invocations this tool creates.
+  InvocationTemplateCache TemplateCache;
+
   bool RestoreCWD = true;
   bool PrintErrorMessage = true;
 };
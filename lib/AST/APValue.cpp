@@ -201,6 +201,17 @@ struct APValue::MemberPointerData : MemberPointerBase {
 };
 
 // FIXME: Reduce the malloc traffic here.
+//
+// Notes on the constraints, for anyone sizing up a compact encoding:
+// - Integers of up to 64 bits already carry no heap payload; APInt stores
+//   them in its inline word, so only wider integers allocate.
+// - The union is sized by its largest members (the complex pairs), but that
+//   slack doubles as the inline path storage of LV and MemberPointerData.
+//   Shrinking the union mostly converts it into per-path allocations.
+// - Packing homogeneous array elements into a flat buffer would have to get
+//   by without getArrayInitializedElt() and getArrayFiller() handing out
+//   APValue lvalues, which the evaluator (in-place construction), constant
+//   emission and (de)serialization all depend on.
 
 APValue::Arr::Arr(unsigned NumElts, unsigned Size) :
   Elts(new APValue[NumElts + (NumElts != Size ? 1 : 0)]),
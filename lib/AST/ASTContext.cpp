@@ -23,6 +23,7 @@
 #include "clang/AST/DeclBase.h"
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclContextInternals.h"
+#include "clang/AST/DeclFriend.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/DeclOpenMP.h"
 #include "clang/AST/DeclTemplate.h"
@@ -73,6 +74,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Support/Capacity.h"
@@ -775,7 +777,8 @@ static bool isAddrSpaceMapManglingEnabled(const TargetInfo &TI,
 ASTContext::ASTContext(LangOptions &LOpts, SourceManager &SM,
                        IdentifierTable &idents, SelectorTable &sels,
                        Builtin::Context &builtins)
-    : FunctionProtoTypes(this_()), TemplateSpecializationTypes(this_()),
+    : FunctionProtoTypes(this_(), HotFoldingSetLog2InitSize),
+      TemplateSpecializationTypes(this_(), HotFoldingSetLog2InitSize),
       DependentTemplateSpecializationTypes(this_()),
       SubstTemplateTemplateParmPacks(this_()), SourceMgr(SM), LangOpts(LOpts),
       SanitizerBL(new SanitizerBlacklist(LangOpts.SanitizerBlacklistFiles, SM)),
@@ -969,6 +972,10 @@ void ASTContext::PrintStats() const {
                << NumImplicitDestructors
                << " implicit destructors created\n";
 
+  llvm::errs() << NumIntEvalCacheHits << "/"
+               << (NumIntEvalCacheHits + NumIntEvalCacheMisses)
+               << " integer constant evaluations cached\n";
+
   if (ExternalSource) {
     llvm::errs() << "\n";
     ExternalSource->PrintStats();
@@ -977,6 +984,147 @@ void ASTContext::PrintStats() const {
   BumpAlloc.PrintStats();
 }
 
+/// Return the static size of the class implementing the given declaration
+/// kind. Declarations with trailing storage occupy more memory than this.
+static size_t getDeclKindSize(Decl::Kind K) {
+  switch (K) {
+#define DECL(DERIVED, BASE)                                                    \
+  case Decl::DERIVED:                                                          \
+    return sizeof(DERIVED##Decl);
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
+  }
+  llvm_unreachable("unknown decl kind");
+}
+
+namespace {
+
+/// Per-kind or per-file accumulator for printMemoryProfile.
+struct MemoryProfileEntry {
+  uint64_t Count = 0;
+  uint64_t Bytes = 0;
+};
+
+} // namespace
+
+static void emitMemoryProfileArray(
+    llvm::raw_ostream &OS, StringRef Key,
+    std::vector<std::pair<StringRef, MemoryProfileEntry>> &Entries) {
+  // Largest consumers first; break ties by name for stable output.
+  llvm::sort(Entries, [](const std::pair<StringRef, MemoryProfileEntry> &L,
+                         const std::pair<StringRef, MemoryProfileEntry> &R) {
+    if (L.second.Bytes != R.second.Bytes)
+      return L.second.Bytes > R.second.Bytes;
+    return L.first < R.first;
+  });
+
+  OS << "  \"" << Key << "\": [";
+  bool First = true;
+  for (const auto &Entry : Entries) {
+    OS << (First ? "\n" : ",\n");
+    First = false;
+    OS << "    {\"name\": \"";
+    OS.write_escaped(Entry.first);
+    OS << "\", \"count\": " << Entry.second.Count
+       << ", \"bytes\": " << Entry.second.Bytes << "}";
+  }
+  OS << "\n  ]";
+}
+
+void ASTContext::printMemoryProfile(llvm::raw_ostream &OS) const {
+  llvm::StringMap<MemoryProfileEntry> DeclStats;
+  llvm::StringMap<MemoryProfileEntry> FileStats;
+
+  // Walk all declarations without triggering deserialization; nodes that were
+  // never deserialized do not occupy memory in this context.
+  SmallVector<const DeclContext *, 16> Worklist;
+  Worklist.push_back(getTranslationUnitDecl());
+  while (!Worklist.empty()) {
+    const DeclContext *DC = Worklist.pop_back_val();
+    for (const Decl *D : DC->noload_decls()) {
+      size_t Size = getDeclKindSize(D->getKind());
+      MemoryProfileEntry &Kind = DeclStats[D->getDeclKindName()];
+      Kind.Count += 1;
+      Kind.Bytes += Size;
+
+      // Attribute the declaration to the file its name was written in. The
+      // same header may be represented by several FileIDs, so merge by name.
+      StringRef FileName = "<invalid>";
+      FileID FID = SourceMgr.getFileID(SourceMgr.getExpansionLoc(D->getLocation()));
+      if (const FileEntry *FE = SourceMgr.getFileEntryForID(FID))
+        FileName = FE->getName();
+      MemoryProfileEntry &File = FileStats[FileName];
+      File.Count += 1;
+      File.Bytes += Size;
+
+      if (const auto *InnerDC = dyn_cast<DeclContext>(D))
+        Worklist.push_back(InnerDC);
+    }
+  }
+
+  MemoryProfileEntry TypeStats[] = {
+#define TYPE(Name, Parent) {},
+#define ABSTRACT_TYPE(Name, Parent)
+#include "clang/AST/TypeNodes.def"
+  };
+  for (const Type *T : Types) {
+    unsigned Idx = T->getTypeClass();
+    TypeStats[Idx].Count += 1;
+  }
+  {
+    unsigned Idx = 0;
+#define TYPE(Name, Parent)                                                     \
+  TypeStats[Idx].Bytes = TypeStats[Idx].Count * sizeof(Name##Type);            \
+  ++Idx;
+#define ABSTRACT_TYPE(Name, Parent)
+#include "clang/AST/TypeNodes.def"
+  }
+
+  OS << "{\n";
+  OS << "  \"total_ast_bytes\": " << getASTAllocatedMemory() << ",\n";
+  OS << "  \"side_table_bytes\": " << getSideTableAllocatedMemory() << ",\n";
+
+  std::vector<std::pair<StringRef, MemoryProfileEntry>> Entries;
+  for (const auto &Kind : DeclStats)
+    Entries.emplace_back(Kind.getKey(), Kind.getValue());
+  emitMemoryProfileArray(OS, "decls", Entries);
+  OS << ",\n";
+
+  Entries.clear();
+  {
+    unsigned Idx = 0;
+#define TYPE(Name, Parent)                                                     \
+  if (TypeStats[Idx].Count)                                                    \
+    Entries.emplace_back(#Name, TypeStats[Idx]);                               \
+  ++Idx;
+#define ABSTRACT_TYPE(Name, Parent)
+#include "clang/AST/TypeNodes.def"
+  }
+  emitMemoryProfileArray(OS, "types", Entries);
+  OS << ",\n";
+
+  Entries.clear();
+  for (const auto &File : FileStats)
+    Entries.emplace_back(File.getKey(), File.getValue());
+  emitMemoryProfileArray(OS, "files", Entries);
+  OS << "\n}\n";
+}
+
+const ASTContext::IntEvalCacheEntry *
+ASTContext::getIntEvalCacheEntry(const Expr *E, unsigned Flags) const {
+  auto I = IntEvalCache.find(std::make_pair(E, Flags));
+  if (I == IntEvalCache.end())
+    return nullptr;
+  ++NumIntEvalCacheHits;
+  return &I->second;
+}
+
+void ASTContext::setIntEvalCacheEntry(const Expr *E, unsigned Flags,
+                                      IntEvalCacheEntry Entry) const {
+  ++NumIntEvalCacheMisses;
+  IntEvalCache[std::make_pair(E, Flags)] = std::move(Entry);
+}
+
 void ASTContext::mergeDefinitionIntoModule(NamedDecl *ND, Module *M,
                                            bool NotifyListeners) {
   if (NotifyListeners)
@@ -1322,6 +1322,9 @@ ExternalASTSource::SetNoExternalVisibleDeclsForName(const DeclContext *DC,
   if (DC->hasNeedToReconcileExternalVisibleStorage())
     DC->reconcileExternalVisibleStorage();
 
+  if (DC->isFileContext())
+    Context.incrementQualifiedLookupGeneration();
+
   (*Map)[Name].removeExternalDecls();
 
   return DeclContext::lookup_result();
@@ -1338,6 +1341,9 @@ ExternalASTSource::SetExternalVisibleDeclsForName(const DeclContext *DC,
   if (DC->hasNeedToReconcileExternalVisibleStorage())
     DC->reconcileExternalVisibleStorage();
 
+  if (DC->isFileContext())
+    Context.incrementQualifiedLookupGeneration();
+
   StoredDeclsList &List = (*Map)[Name];
 
   // Clear out any old external visible declarations, to avoid quadratic
@@ -1474,6 +1480,8 @@ void DeclContext::removeDecl(Decl *D) {
     do {
       StoredDeclsMap *Map = DC->getPrimaryContext()->LookupPtr;
       if (Map) {
+        if (DC->isFileContext())
+          getParentASTContext().incrementQualifiedLookupGeneration();
         StoredDeclsMap::iterator Pos = Map->find(ND->getDeclName());
         assert(Pos != Map->end() && "no lookup entry for decl");
         // Remove the decl only if it is contained.
@@ -1847,6 +1855,11 @@ void DeclContext::makeDeclVisibleInContextWithFlags(NamedDecl *D, bool Internal,
 }
 
 void DeclContext::makeDeclVisibleInContextImpl(NamedDecl *D, bool Internal) {
+  // Changing the visible names of a namespace or of the translation unit
+  // invalidates any qualified lookup results Sema has memoized for them.
+  if (isFileContext())
+    getParentASTContext().incrementQualifiedLookupGeneration();
+
   // Find or create the stored declaration map.
   StoredDeclsMap *Map = LookupPtr;
   if (!Map) {
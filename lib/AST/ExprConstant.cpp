@@ -12397,9 +12397,41 @@ bool Expr::EvaluateAsInt(EvalResult &Result, const ASTContext &Ctx,
                          bool InConstantContext) const {
   assert(!isValueDependent() &&
          "Expression evaluator can't be called on a dependent expression.");
+
+  // The outcome only depends on the expression and the evaluation flags, and
+  // expressions are immutable once built, so results can be reused across
+  // calls. Callers collecting diagnostic notes bypass the cache, which cannot
+  // replay them.
+  const unsigned CacheFlags = static_cast<unsigned>(AllowSideEffects) |
+                              (InConstantContext ? 1u << 2 : 0);
+  const bool Cacheable = !Result.Diag;
+  if (Cacheable) {
+    if (const ASTContext::IntEvalCacheEntry *Entry =
+            Ctx.getIntEvalCacheEntry(this, CacheFlags)) {
+      if (Entry->Success)
+        Result.Val = APValue(Entry->Value);
+      Result.HasSideEffects = Entry->HasSideEffects;
+      Result.HasUndefinedBehavior = Entry->HasUndefinedBehavior;
+      return Entry->Success;
+    }
+  }
+
   EvalInfo Info(Ctx, Result, EvalInfo::EM_IgnoreSideEffects);
   Info.InConstantContext = InConstantContext;
-  return ::EvaluateAsInt(this, Result, Ctx, AllowSideEffects, Info);
+  const bool Success = ::EvaluateAsInt(this, Result, Ctx, AllowSideEffects,
+                                       Info);
+
+  if (Cacheable) {
+    ASTContext::IntEvalCacheEntry Entry;
+    if (Success)
+      Entry.Value = Result.Val.getInt();
+    Entry.Success = Success;
+    Entry.HasSideEffects = Result.HasSideEffects;
+    Entry.HasUndefinedBehavior = Result.HasUndefinedBehavior;
+    Ctx.setIntEvalCacheEntry(this, CacheFlags, std::move(Entry));
+  }
+
+  return Success;
 }
 
 bool Expr::EvaluateAsFixedPoint(EvalResult &Result, const ASTContext &Ctx,
@@ -12473,6 +12505,16 @@ bool Expr::EvaluateAsInitializer(APValue &Value, const ASTContext &Ctx,
 
   // FIXME: Evaluating initializers for large array and record types can cause
   // performance problems. Only do so in C++11 for now.
+  //
+  // Note for would-be optimizers of the large-TU case: the fixed per-call
+  // overhead is already small (EvalInfo and its bottom frame live on the
+  // stack, and zero-initialization of arrays goes through the O(1) array
+  // filler), so batching evaluations buys little. The remaining costs are
+  // the evaluation itself and the APValue trees it builds, and those trees
+  // cannot be interned or arena-allocated behind the evaluator's back:
+  // every composite APValue uniquely owns its payload and frees it in its
+  // destructor, which both the evaluator's temporaries and the
+  // ASTContext-registered cleanups of the stored results rely on.
   if (isRValue() && (getType()->isArrayType() || getType()->isRecordType()) &&
       !Ctx.getLangOpts().CPlusPlus11)
     return false;
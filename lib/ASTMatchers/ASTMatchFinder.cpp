@@ -549,9 +549,10 @@ private:
 
   void matchWithFilter(const ast_type_traits::DynTypedNode &DynNode) {
     auto Kind = DynNode.getNodeKind();
-    auto it = MatcherFiltersMap.find(Kind);
-    const auto &Filter =
-        it != MatcherFiltersMap.end() ? it->second : getFilterForKind(Kind);
+    auto Entry = MatcherFiltersMap.try_emplace(Kind);
+    const std::vector<unsigned short> &Filter = Entry.first->second;
+    if (Entry.second)
+      buildFilterForKind(Kind, Entry.first->second);
 
     if (Filter.empty())
       return;
@@ -571,9 +572,8 @@ private:
     }
   }
 
-  const std::vector<unsigned short> &
-  getFilterForKind(ast_type_traits::ASTNodeKind Kind) {
-    auto &Filter = MatcherFiltersMap[Kind];
+  void buildFilterForKind(ast_type_traits::ASTNodeKind Kind,
+                          std::vector<unsigned short> &Filter) {
     auto &Matchers = this->Matchers->DeclOrStmt;
     assert((Matchers.size() < USHRT_MAX) && "Too many matchers.");
     for (unsigned I = 0, E = Matchers.size(); I != E; ++I) {
@@ -581,7 +581,6 @@ private:
         Filter.push_back(I);
       }
     }
-    return Filter;
   }
 
   /// @{
@@ -776,7 +775,10 @@ private:
   /// node.
   /// We precalculate a list of matchers that pass the toplevel restrict check.
   /// This also allows us to skip the restrict check at matching time. See
-  /// use \c matchesNoKindCheck() above.
+  /// use \c matchesNoKindCheck() above. The remaining matcher categories
+  /// (\c TypeLoc, \c QualType, ...) are represented by a single node kind in
+  /// \c ASTNodeKind, so a per-kind filter cannot discriminate between their
+  /// matchers and they keep the unfiltered dispatch path.
   llvm::DenseMap<ast_type_traits::ASTNodeKind, std::vector<unsigned short>>
       MatcherFiltersMap;
 
@@ -248,6 +248,22 @@ CFG *AnalysisDeclContext::getUnoptimizedCFG() {
   return completeCFG.get();
 }
 
+CFG *AnalysisDeclContext::getSkeletonCFG() {
+  if (!builtSkeletonCFG) {
+    // Build with all optional elements disabled; only the edge pruning
+    // setting is inherited so that reachability matches getCFG().
+    CFG::BuildOptions SkeletonOptions;
+    SkeletonOptions.PruneTriviallyFalseEdges =
+        cfgBuildOptions.PruneTriviallyFalseEdges;
+    skeletonCFG =
+        CFG::buildCFG(D, getBody(), &D->getASTContext(), SkeletonOptions);
+    // Even when the cfg is not successfully built, we don't
+    // want to try building it again.
+    builtSkeletonCFG = true;
+  }
+  return skeletonCFG.get();
+}
+
 CFGStmtMap *AnalysisDeclContext::getCFGStmtMap() {
   if (cfgStmtMap)
     return cfgStmtMap.get();
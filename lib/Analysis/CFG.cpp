@@ -4788,7 +4788,20 @@ CFGBlock *CFG::createBlock() {
 std::unique_ptr<CFG> CFG::buildCFG(const Decl *D, Stmt *Statement,
                                    ASTContext *C, const BuildOptions &BO) {
   CFGBuilder Builder(C, BO);
-  return Builder.buildCFG(D, Statement);
+  std::unique_ptr<CFG> Cfg = Builder.buildCFG(D, Statement);
+  if (Cfg)
+    Cfg->shrinkToFit();
+  return Cfg;
+}
+
+void CFG::shrinkToFit() {
+  // The construction bump-allocator cannot reuse the slack the growing
+  // vectors left behind, but copying each vector into an exactly-sized
+  // buffer in block order packs the arrays back-to-back, so the many
+  // traversals of the finished graph iterate densely allocated memory.
+  Blocks.shrink_to_fit(BlkBVC);
+  for (CFGBlock *B : *this)
+    B->shrinkToFit(BlkBVC);
 }
 
 bool CFG::isLinear() const {
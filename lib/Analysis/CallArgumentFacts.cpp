@@ -0,0 +1,193 @@
+//===- CallArgumentFacts.cpp - Flow-insensitive call-site summaries -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the whole-TU call-argument summary pre-pass.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Analysis/CallArgumentFacts.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "llvm/ADT/DenseSet.h"
+
+using namespace clang;
+
+/// Return true if \p E is a pointer argument that cannot be null: taking an
+/// address, decaying an array or function, or a string literal.
+static bool isProvablyNonNull(const Expr *E) {
+  E = E->IgnoreParenCasts();
+
+  if (const auto *UO = dyn_cast<UnaryOperator>(E))
+    return UO->getOpcode() == UO_AddrOf;
+
+  if (isa<StringLiteral>(E) || isa<CompoundLiteralExpr>(E))
+    return true;
+
+  if (const auto *DRE = dyn_cast<DeclRefExpr>(E)) {
+    if (isa<FunctionDecl>(DRE->getDecl()))
+      return true;
+    if (const auto *VD = dyn_cast<VarDecl>(DRE->getDecl()))
+      return VD->getType()->isArrayType();
+  }
+
+  return false;
+}
+
+/// Return true if all callers of \p FD are visible in its own TU, ignoring
+/// address-taking, which is accounted for separately.
+static bool hasOnlyVisibleCallers(const FunctionDecl *FD) {
+  if (FD->isExternallyVisible() || FD->isVariadic())
+    return false;
+  if (const auto *MD = dyn_cast<CXXMethodDecl>(FD))
+    if (MD->isVirtual())
+      return false;
+  return true;
+}
+
+namespace clang {
+
+class CallArgumentCollector
+    : public RecursiveASTVisitor<CallArgumentCollector> {
+  CallArgumentFacts &Facts;
+  const ASTContext &Ctx;
+
+  /// Reference counts used to detect address-taken functions: a function
+  /// whose every DeclRefExpr is the callee of a direct call cannot be
+  /// called through a pointer.
+  llvm::DenseMap<const FunctionDecl *, unsigned> Refs, CalleeRefs;
+
+  /// Names called through overload sets, ADL, or dependent callees. Such
+  /// call sites record no argument values, so no like-named function may
+  /// keep facts.
+  llvm::DenseSet<DeclarationName> UnresolvedNames;
+
+public:
+  CallArgumentCollector(CallArgumentFacts &Facts, const ASTContext &Ctx)
+      : Facts(Facts), Ctx(Ctx) {}
+
+  bool shouldWalkTypesOfTypeLocs() const { return false; }
+
+  bool VisitDeclRefExpr(DeclRefExpr *DRE) {
+    if (const auto *FD = dyn_cast<FunctionDecl>(DRE->getDecl()))
+      ++Refs[FD->getCanonicalDecl()];
+    return true;
+  }
+
+  bool VisitCallExpr(CallExpr *CE) {
+    const FunctionDecl *FD = CE->getDirectCallee();
+    if (!FD) {
+      // A call that does not resolve to one function (overload set, ADL,
+      // dependent callee) may reach any like-named candidate without its
+      // arguments being summarized; remember the name so every candidate
+      // loses its facts. Calls through function pointers need no entry
+      // here: the pointer value itself counted as a non-callee reference.
+      const Expr *Callee = CE->getCallee()->IgnoreParenImpCasts();
+      if (const auto *OE = dyn_cast<OverloadExpr>(Callee))
+        UnresolvedNames.insert(OE->getName());
+      else if (const auto *ME = dyn_cast<CXXDependentScopeMemberExpr>(Callee))
+        UnresolvedNames.insert(ME->getMember());
+      else if (const auto *DRE = dyn_cast<DependentScopeDeclRefExpr>(Callee))
+        UnresolvedNames.insert(DRE->getDeclName());
+      return true;
+    }
+    if (!hasOnlyVisibleCallers(FD))
+      return true;
+    FD = FD->getCanonicalDecl();
+
+    if (const auto *DRE =
+            dyn_cast<DeclRefExpr>(CE->getCallee()->IgnoreParenImpCasts()))
+      if (DRE->getDecl()->getCanonicalDecl() == FD)
+        ++CalleeRefs[FD];
+
+    recordCall(FD, CE);
+    return true;
+  }
+
+  /// Discard facts for functions whose address may have been taken or whose
+  /// name was called through an unresolved callee.
+  void prune() {
+    for (const auto &Entry : Refs)
+      if (Entry.second != CalleeRefs.lookup(Entry.first))
+        Facts.Facts.erase(Entry.first);
+
+    if (UnresolvedNames.empty())
+      return;
+    llvm::SmallVector<const FunctionDecl *, 8> Doomed;
+    for (const auto &Entry : Facts.Facts)
+      if (UnresolvedNames.count(Entry.first->getDeclName()))
+        Doomed.push_back(Entry.first);
+    for (const FunctionDecl *FD : Doomed)
+      Facts.Facts.erase(FD);
+  }
+
+private:
+  void recordCall(const FunctionDecl *FD, const CallExpr *CE) {
+    CallArgumentFacts::FunctionFacts &FF = Facts.Facts[FD];
+    const unsigned NumParams = FD->getNumParams();
+    if (FF.Params.size() < NumParams)
+      FF.Params.resize(NumParams);
+    ++FF.NumCalls;
+
+    // In a member operator call the first argument is the object argument;
+    // the parameters map to the arguments that follow it.
+    unsigned ArgOffset = 0;
+    if (isa<CXXOperatorCallExpr>(CE))
+      if (const auto *MD = dyn_cast<CXXMethodDecl>(FD))
+        if (MD->isInstance())
+          ArgOffset = 1;
+
+    for (unsigned I = 0; I != NumParams; ++I) {
+      CallArgumentFacts::ParamFacts &PF = FF.Params[I];
+
+      // A call relying on a default argument is treated as passing an
+      // unknown value.
+      if (I + ArgOffset >= CE->getNumArgs() ||
+          isa<CXXDefaultArgExpr>(CE->getArg(I + ArgOffset))) {
+        PF.AlwaysNonNull = false;
+        PF.UniqueConstant.reset();
+        continue;
+      }
+      const Expr *Arg = CE->getArg(I + ArgOffset);
+
+      if (PF.AlwaysNonNull && !isProvablyNonNull(Arg))
+        PF.AlwaysNonNull = false;
+
+      Expr::EvalResult ER;
+      const bool IsConstant =
+          !Arg->isValueDependent() && Arg->EvaluateAsInt(ER, Ctx);
+      if (FF.NumCalls == 1) {
+        if (IsConstant)
+          PF.UniqueConstant = ER.Val.getInt();
+      } else if (PF.UniqueConstant &&
+                 (!IsConstant || !llvm::APSInt::isSameValue(
+                                     *PF.UniqueConstant, ER.Val.getInt()))) {
+        PF.UniqueConstant.reset();
+      }
+    }
+  }
+};
+
+} // namespace clang
+
+void CallArgumentFacts::addTU(const TranslationUnitDecl *TU) {
+  CallArgumentCollector Collector(*this, TU->getASTContext());
+  Collector.TraverseDecl(const_cast<TranslationUnitDecl *>(TU));
+  Collector.prune();
+}
+
+const CallArgumentFacts::FunctionFacts *
+CallArgumentFacts::lookup(const FunctionDecl *FD) const {
+  auto It = Facts.find(FD->getCanonicalDecl());
+  if (It == Facts.end() || It->second.NumCalls == 0)
+    return nullptr;
+  return &It->second;
+}
@@ -16,6 +16,7 @@
 #include "clang/Analysis/Analyses/PostOrderCFGView.h"
 #include "clang/Analysis/AnalysisDeclContext.h"
 #include "clang/Analysis/CFG.h"
+#include "clang/Analysis/CFGStmtMap.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/PriorityQueue.h"
@@ -71,18 +72,52 @@ const CFGBlock *DataflowWorklist::dequeue() {
 }
 
 namespace {
+
+/// The first effect a statement or block has on a variable when read in
+/// program order.  \c None means the variable is passed through untouched.
+enum class DeclEffect { None, Use, Kill };
+
 class LiveVariablesImpl {
 public:
   AnalysisDeclContext &analysisContext;
   llvm::ImmutableSet<const Stmt *>::Factory SSetFact;
   llvm::ImmutableSet<const VarDecl *>::Factory DSetFact;
   llvm::ImmutableSet<const BindingDecl *>::Factory BSetFact;
-  llvm::DenseMap<const CFGBlock *, LiveVariables::LivenessValues> blocksEndToLiveness;
-  llvm::DenseMap<const CFGBlock *, LiveVariables::LivenessValues> blocksBeginToLiveness;
+  // Per-block values live in dense arrays indexed by the block ID; block IDs
+  // are consecutive, so this is both preallocatable and cheaper to query than
+  // hashing the block pointer.
+  std::vector<LiveVariables::LivenessValues> blocksEndToLiveness;
+  std::vector<LiveVariables::LivenessValues> blocksBeginToLiveness;
   llvm::DenseMap<const Stmt *, LiveVariables::LivenessValues> stmtsToLiveness;
   llvm::DenseMap<const DeclRefExpr *, unsigned> inAssignment;
   const bool killAtAssign;
 
+  // For very large CFGs the full all-variables fixpoint is deferred and
+  // individual "is X live at P" queries are answered by a forward search
+  // over the CFG that stops at kills, memoized per (block, variable).
+  // SymbolReaper only queries a handful of bindings per step, so in that
+  // regime the searches are much cheaper than the up-front fixpoint.
+  bool demandDriven = false;
+  bool fixpointComputed = false;
+  llvm::DenseMap<std::pair<const CFGBlock *, const VarDecl *>, bool>
+      liveAtEntryCache;
+
+  void computeFixpoint();
+
+  /// Run the deferred fixpoint if it has not been computed yet.  Used by
+  /// clients such as runOnAllBlocks that need per-block values for the
+  /// whole CFG rather than individual queries.
+  void ensureFixpoint();
+
+  DeclEffect classifyStmt(const Stmt *S, const VarDecl *D);
+  DeclEffect classifyElement(const CFGElement &elem, const VarDecl *D);
+  DeclEffect scanBlock(const CFGBlock *block, const VarDecl *D);
+
+  bool isLiveAtEntry(const CFGBlock *block, const VarDecl *D);
+  bool isLiveAtExit(const CFGBlock *block, const VarDecl *D);
+  bool isLiveAt(const Stmt *Loc, const VarDecl *D);
+  bool isStmtLiveAt(const Stmt *Loc, const Stmt *Val);
+
   LiveVariables::LivenessValues
   merge(LiveVariables::LivenessValues valsA,
         LiveVariables::LivenessValues valsB);
@@ -181,15 +216,28 @@ static bool isAlwaysAlive(const VarDecl *D) {
 }
 
 bool LiveVariables::isLive(const CFGBlock *B, const VarDecl *D) {
-  return isAlwaysAlive(D) || getImpl(impl).blocksEndToLiveness[B].isLive(D);
+  if (isAlwaysAlive(D))
+    return true;
+  LiveVariablesImpl &LV = getImpl(impl);
+  if (LV.demandDriven)
+    return LV.isLiveAtExit(B, D);
+  return LV.blocksEndToLiveness[B->getBlockID()].isLive(D);
 }
 
 bool LiveVariables::isLive(const Stmt *S, const VarDecl *D) {
-  return isAlwaysAlive(D) || getImpl(impl).stmtsToLiveness[S].isLive(D);
+  if (isAlwaysAlive(D))
+    return true;
+  LiveVariablesImpl &LV = getImpl(impl);
+  if (LV.demandDriven)
+    return LV.isLiveAt(S, D);
+  return LV.stmtsToLiveness[S].isLive(D);
 }
 
 bool LiveVariables::isLive(const Stmt *Loc, const Stmt *S) {
-  return getImpl(impl).stmtsToLiveness[Loc].isLive(S);
+  LiveVariablesImpl &LV = getImpl(impl);
+  if (LV.demandDriven)
+    return LV.isStmtLiveAt(Loc, S);
+  return LV.stmtsToLiveness[Loc].isLive(S);
 }
 
 //===----------------------------------------------------------------------===//
@@ -493,6 +541,244 @@ void TransferFunctions::VisitUnaryOperator(UnaryOperator *UO) {
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Demand-driven queries.
+//===----------------------------------------------------------------------===//
+//
+// Above this many CFG blocks the fixpoint computation dominates the analysis
+// setup cost, so queries are answered on demand instead (see the comment on
+// LiveVariablesImpl::demandDriven).  The demand answers over-approximate the
+// fixpoint in a few corner cases (noted below), which is the conservative
+// direction: a variable is never reported dead while the fixpoint would keep
+// it live.
+static const unsigned DemandDrivenBlockThreshold = 10000;
+
+DeclEffect LiveVariablesImpl::classifyStmt(const Stmt *S, const VarDecl *D) {
+  if (const auto *DR = dyn_cast<DeclRefExpr>(S)) {
+    const Decl *RefD = DR->getDecl();
+    bool Matches = RefD == D;
+    if (!Matches)
+      if (const auto *DD = dyn_cast<DecompositionDecl>(D))
+        for (const BindingDecl *BD : DD->bindings())
+          Matches |= RefD == BD;
+    if (Matches && !inAssignment.lookup(DR))
+      return DeclEffect::Use;
+    return DeclEffect::None;
+  }
+
+  if (const auto *BO = dyn_cast<BinaryOperator>(S)) {
+    // Compound assignments read the variable first; their DeclRefExpr is not
+    // marked as being in an assignment, so the scan reports the use before
+    // ever reaching the operator.  Only plain assignments kill.
+    if (killAtAssign && BO->getOpcode() == BO_Assign)
+      if (const auto *DR = dyn_cast<DeclRefExpr>(BO->getLHS()->IgnoreParens()))
+        if (DR->getDecl() == D && writeShouldKill(D))
+          return DeclEffect::Kill;
+    return DeclEffect::None;
+  }
+
+  if (const auto *DS = dyn_cast<DeclStmt>(S)) {
+    for (const auto *DI : DS->decls())
+      if (DI == D)
+        return DeclEffect::Kill;
+    return DeclEffect::None;
+  }
+
+  if (const auto *BE = dyn_cast<BlockExpr>(S)) {
+    for (const VarDecl *VD :
+         analysisContext.getReferencedBlockVars(BE->getBlockDecl()))
+      if (VD == D)
+        return DeclEffect::Use;
+    return DeclEffect::None;
+  }
+
+  if (const auto *ME = dyn_cast<ObjCMessageExpr>(S)) {
+    if (ME->getReceiverKind() == ObjCMessageExpr::SuperInstance &&
+        analysisContext.getSelfDecl() == D)
+      return DeclEffect::Use;
+    return DeclEffect::None;
+  }
+
+  if (const auto *OS = dyn_cast<ObjCForCollectionStmt>(S)) {
+    const Stmt *element = OS->getElement();
+    const VarDecl *VD = nullptr;
+    if (const auto *DS = dyn_cast<DeclStmt>(element))
+      VD = cast<VarDecl>(DS->getSingleDecl());
+    else if (const auto *DR =
+                 dyn_cast<DeclRefExpr>(cast<Expr>(element)->IgnoreParens()))
+      VD = cast<VarDecl>(DR->getDecl());
+    if (VD == D)
+      return DeclEffect::Kill;
+    return DeclEffect::None;
+  }
+
+  return DeclEffect::None;
+}
+
+DeclEffect LiveVariablesImpl::classifyElement(const CFGElement &elem,
+                                              const VarDecl *D) {
+  if (Optional<CFGAutomaticObjDtor> Dtor = elem.getAs<CFGAutomaticObjDtor>())
+    return Dtor->getVarDecl() == D ? DeclEffect::Use : DeclEffect::None;
+  if (Optional<CFGStmt> CS = elem.getAs<CFGStmt>())
+    return classifyStmt(CS->getStmt(), D);
+  return DeclEffect::None;
+}
+
+DeclEffect LiveVariablesImpl::scanBlock(const CFGBlock *block,
+                                        const VarDecl *D) {
+  for (const CFGElement &elem : *block) {
+    DeclEffect E = classifyElement(elem, D);
+    if (E != DeclEffect::None)
+      return E;
+  }
+  if (const Stmt *term = block->getTerminatorStmt())
+    return classifyStmt(term, D);
+  return DeclEffect::None;
+}
+
+bool LiveVariablesImpl::isLiveAtEntry(const CFGBlock *block,
+                                      const VarDecl *D) {
+  auto Cached = liveAtEntryCache.find(std::make_pair(block, D));
+  if (Cached != liveAtEntryCache.end())
+    return Cached->second;
+
+  // Search forward for a use of D that is not preceded by a kill.  Blocks
+  // whose elements neither use nor kill D pass the query through to their
+  // successors.
+  const CFG *cfg = analysisContext.getCFG();
+  llvm::BitVector visited(cfg->getNumBlockIDs());
+  SmallVector<const CFGBlock *, 32> worklist;
+  SmallVector<const CFGBlock *, 32> scanned;
+  worklist.push_back(block);
+  visited[block->getBlockID()] = true;
+
+  bool live = false;
+  while (!worklist.empty()) {
+    const CFGBlock *b = worklist.pop_back_val();
+
+    auto it = liveAtEntryCache.find(std::make_pair(b, D));
+    if (it != liveAtEntryCache.end()) {
+      if (it->second) {
+        live = true;
+        break;
+      }
+      continue;
+    }
+
+    scanned.push_back(b);
+    DeclEffect E = scanBlock(b, D);
+    if (E == DeclEffect::Use) {
+      live = true;
+      break;
+    }
+    if (E == DeclEffect::Kill)
+      continue;
+
+    for (CFGBlock::const_succ_iterator I = b->succ_begin(), EI = b->succ_end();
+         I != EI; ++I)
+      if (const CFGBlock *succ = *I)
+        if (!visited[succ->getBlockID()]) {
+          visited[succ->getBlockID()] = true;
+          worklist.push_back(succ);
+        }
+  }
+
+  if (live) {
+    // Only the query block is known to reach the use; blocks visited on
+    // other branches of the search may still be dead.
+    liveAtEntryCache[std::make_pair(block, D)] = true;
+  } else {
+    // The search saturated without finding a use, so everything reachable
+    // from a scanned block through pass-through blocks was also scanned.
+    // All of them share the negative answer.
+    for (const CFGBlock *b : scanned)
+      liveAtEntryCache[std::make_pair(b, D)] = false;
+  }
+  return live;
+}
+
+bool LiveVariablesImpl::isLiveAtExit(const CFGBlock *block, const VarDecl *D) {
+  for (CFGBlock::const_succ_iterator I = block->succ_begin(),
+                                     E = block->succ_end(); I != E; ++I)
+    if (const CFGBlock *succ = *I)
+      if (isLiveAtEntry(succ, D))
+        return true;
+  return false;
+}
+
+bool LiveVariablesImpl::isLiveAt(const Stmt *Loc, const VarDecl *D) {
+  CFGStmtMap *SM = analysisContext.getCFGStmtMap();
+  const CFGBlock *block = SM ? SM->getBlock(Loc) : nullptr;
+  if (!block)
+    return true; // Be conservative when the statement cannot be located.
+
+  // Scan the remainder of Loc's block, starting at Loc itself: a reference
+  // to D in Loc keeps D live at the program point before it.
+  bool found = false;
+  for (const CFGElement &elem : *block) {
+    if (!found) {
+      Optional<CFGStmt> CS = elem.getAs<CFGStmt>();
+      if (!CS || CS->getStmt() != Loc)
+        continue;
+      found = true;
+    }
+    DeclEffect E = classifyElement(elem, D);
+    if (E == DeclEffect::Use)
+      return true;
+    if (E == DeclEffect::Kill)
+      return false;
+  }
+  if (!found)
+    return true; // Loc is not a block-level element; be conservative.
+
+  if (const Stmt *term = block->getTerminatorStmt()) {
+    DeclEffect E = classifyStmt(term, D);
+    if (E == DeclEffect::Use)
+      return true;
+    if (E == DeclEffect::Kill)
+      return false;
+  }
+  return isLiveAtExit(block, D);
+}
+
+bool LiveVariablesImpl::isStmtLiveAt(const Stmt *Loc, const Stmt *Val) {
+  Val = LookThroughStmt(Val);
+  CFGStmtMap *SM = analysisContext.getCFGStmtMap();
+  const CFGBlock *block = SM ? SM->getBlock(Loc) : nullptr;
+  if (!block)
+    return true;
+
+  // An expression value is live from its own element up to the statement
+  // that consumes it.  Operands precede their consumers in the element
+  // order, so scan forward from Loc: a later statement with Val among its
+  // children keeps it live; reaching Val's own element first means it has
+  // not been computed yet at the point before Loc.
+  bool found = false;
+  for (const CFGElement &elem : *block) {
+    Optional<CFGStmt> CS = elem.getAs<CFGStmt>();
+    if (!CS)
+      continue;
+    const Stmt *S = CS->getStmt();
+    if (!found) {
+      if (S != Loc)
+        continue;
+      found = true;
+    }
+    for (const Stmt *Child : S->children())
+      if (Child && LookThroughStmt(Child) == Val)
+        return true;
+    if (isa<Expr>(S) && LookThroughStmt(S) == Val)
+      return false;
+  }
+  if (!found)
+    return true;
+
+  // Values can also be consumed by the terminator or in a successor block
+  // (e.g. the operands of a short-circuit operator); unlike the fixpoint we
+  // do not chase those consumers and conservatively report the value live.
+  return true;
+}
+
 LiveVariables::LivenessValues
 LiveVariablesImpl::runOnBlock(const CFGBlock *block,
                               LiveVariables::LivenessValues val,
@@ -526,9 +812,11 @@ LiveVariablesImpl::runOnBlock(const CFGBlock *block,
 }
 
 void LiveVariables::runOnAllBlocks(LiveVariables::Observer &obs) {
+  getImpl(impl).ensureFixpoint();
   const CFG *cfg = getImpl(impl).analysisContext.getCFG();
   for (CFG::const_iterator it = cfg->begin(), ei = cfg->end(); it != ei; ++it)
-    getImpl(impl).runOnBlock(*it, getImpl(impl).blocksEndToLiveness[*it], &obs);
+    getImpl(impl).runOnBlock(
+        *it, getImpl(impl).blocksEndToLiveness[(*it)->getBlockID()], &obs);
 }
 
 LiveVariables::LiveVariables(void *im) : impl(im) {}
@@ -553,21 +841,18 @@ LiveVariables::computeLiveness(AnalysisDeclContext &AC,
 
   LiveVariablesImpl *LV = new LiveVariablesImpl(AC, killAtAssign);
 
-  // Construct the dataflow worklist.  Enqueue the exit block as the
-  // start of the analysis.
-  DataflowWorklist worklist(*cfg, AC);
-  llvm::BitVector everAnalyzedBlock(cfg->getNumBlockIDs());
-
-  // FIXME: we should enqueue using post order.
-  for (CFG::const_iterator it = cfg->begin(), ei = cfg->end(); it != ei; ++it) {
-    const CFGBlock *block = *it;
-    worklist.enqueueBlock(block);
-
-    // FIXME: Scan for DeclRefExprs using in the LHS of an assignment.
-    // We need to do this because we lack context in the reverse analysis
-    // to determine if a DeclRefExpr appears in such a context, and thus
-    // doesn't constitute a "use".
-    if (killAtAssign)
+  // Allocate the per-block values up front; they are dense in the block IDs.
+  LV->blocksBeginToLiveness.resize(cfg->getNumBlockIDs());
+  LV->blocksEndToLiveness.resize(cfg->getNumBlockIDs());
+
+  // FIXME: Scan for DeclRefExprs using in the LHS of an assignment.
+  // We need to do this because we lack context in the reverse analysis
+  // to determine if a DeclRefExpr appears in such a context, and thus
+  // doesn't constitute a "use".
+  if (killAtAssign)
+    for (CFG::const_iterator it = cfg->begin(), ei = cfg->end(); it != ei;
+         ++it) {
+      const CFGBlock *block = *it;
       for (CFGBlock::const_iterator bi = block->begin(), be = block->end();
            bi != be; ++bi) {
         if (Optional<CFGStmt> cs = bi->getAs<CFGStmt>()) {
@@ -582,19 +867,50 @@ LiveVariables::computeLiveness(AnalysisDeclContext &AC,
           }
         }
       }
-  }
+    }
+
+  // For huge CFGs answer queries on demand instead of paying for the full
+  // fixpoint; ensureFixpoint() still computes it lazily for clients that
+  // need per-block values everywhere.
+  if (cfg->getNumBlockIDs() > DemandDrivenBlockThreshold)
+    LV->demandDriven = true;
+  else
+    LV->computeFixpoint();
+
+  return new LiveVariables(LV);
+}
+
+void LiveVariablesImpl::ensureFixpoint() {
+  if (fixpointComputed)
+    return;
+  computeFixpoint();
+  demandDriven = false;
+}
+
+void LiveVariablesImpl::computeFixpoint() {
+  CFG *cfg = analysisContext.getCFG();
+
+  // Construct the dataflow worklist.  Enqueue the exit block as the
+  // start of the analysis.
+  DataflowWorklist worklist(*cfg, analysisContext);
+  llvm::BitVector everAnalyzedBlock(cfg->getNumBlockIDs());
+
+  // FIXME: we should enqueue using post order.
+  for (CFG::const_iterator it = cfg->begin(), ei = cfg->end(); it != ei; ++it)
+    worklist.enqueueBlock(*it);
 
   while (const CFGBlock *block = worklist.dequeue()) {
     // Determine if the block's end value has changed.  If not, we
     // have nothing left to do for this block.
-    LivenessValues &prevVal = LV->blocksEndToLiveness[block];
+    LiveVariables::LivenessValues &prevVal =
+        blocksEndToLiveness[block->getBlockID()];
 
     // Merge the values of all successor blocks.
-    LivenessValues val;
+    LiveVariables::LivenessValues val;
     for (CFGBlock::const_succ_iterator it = block->succ_begin(),
                                        ei = block->succ_end(); it != ei; ++it) {
       if (const CFGBlock *succ = *it) {
-        val = LV->merge(val, LV->blocksBeginToLiveness[succ]);
+        val = merge(val, blocksBeginToLiveness[succ->getBlockID()]);
       }
     }
 
@@ -606,26 +922,23 @@ LiveVariables::computeLiveness(AnalysisDeclContext &AC,
     prevVal = val;
 
     // Update the dataflow value for the start of this block.
-    LV->blocksBeginToLiveness[block] = LV->runOnBlock(block, val);
+    blocksBeginToLiveness[block->getBlockID()] = runOnBlock(block, val);
 
     // Enqueue the value to the predecessors.
     worklist.enqueuePredecessors(block);
   }
 
-  return new LiveVariables(LV);
+  fixpointComputed = true;
 }
 
 void LiveVariables::dumpBlockLiveness(const SourceManager &M) {
+  getImpl(impl).ensureFixpoint();
   getImpl(impl).dumpBlockLiveness(M);
 }
 
 void LiveVariablesImpl::dumpBlockLiveness(const SourceManager &M) {
-  std::vector<const CFGBlock *> vec;
-  for (llvm::DenseMap<const CFGBlock *, LiveVariables::LivenessValues>::iterator
-       it = blocksEndToLiveness.begin(), ei = blocksEndToLiveness.end();
-       it != ei; ++it) {
-    vec.push_back(it->first);
-  }
+  std::vector<const CFGBlock *> vec(analysisContext.getCFG()->begin(),
+                                    analysisContext.getCFG()->end());
   llvm::sort(vec, [](const CFGBlock *A, const CFGBlock *B) {
     return A->getBlockID() < B->getBlockID();
   });
@@ -637,7 +950,8 @@ void LiveVariablesImpl::dumpBlockLiveness(const SourceManager &M) {
     llvm::errs() << "\n[ B" << (*it)->getBlockID()
                  << " (live variables at block exit) ]\n";
 
-    LiveVariables::LivenessValues vals = blocksEndToLiveness[*it];
+    LiveVariables::LivenessValues vals =
+        blocksEndToLiveness[(*it)->getBlockID()];
     declVec.clear();
 
     for (llvm::ImmutableSet<const VarDecl *>::iterator si =
@@ -662,6 +976,7 @@ void LiveVariablesImpl::dumpBlockLiveness(const SourceManager &M) {
 }
 
 void LiveVariables::dumpStmtLiveness(const SourceManager &M) {
+  getImpl(impl).ensureFixpoint();
   getImpl(impl).dumpStmtLiveness(M);
 }
 
@@ -671,7 +986,7 @@ void LiveVariablesImpl::dumpStmtLiveness(const SourceManager &M) {
 
     llvm::errs() << "\n[ B" << I->getBlockID()
                  << " (live statements at block exit) ]\n";
-    for (auto S : blocksEndToLiveness[I].liveStmts) {
+    for (auto S : blocksEndToLiveness[I->getBlockID()].liveStmts) {
       llvm::errs() << "\n";
       S->dump();
     }
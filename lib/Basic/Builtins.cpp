@@ -14,6 +14,7 @@
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 using namespace clang;
 
@@ -47,13 +48,27 @@ void Builtin::Context::InitializeTarget(const TargetInfo &Target,
     AuxTSRecords = AuxTarget->getTargetBuiltins();
 }
 
-bool Builtin::Context::isBuiltinFunc(const char *Name) {
-  StringRef FuncName(Name);
-  for (unsigned i = Builtin::NotBuiltin + 1; i != Builtin::FirstTSBuiltin; ++i)
-    if (FuncName.equals(BuiltinInfo[i].Name))
-      return strchr(BuiltinInfo[i].Attributes, 'f') != nullptr;
+/// A process-wide index of the target-independent builtin names. The builtin
+/// table is immutable, so the index is built once, on first use, and shared
+/// by every compiler instance in the process instead of rescanning the table
+/// per query.
+static const llvm::StringMap<unsigned> &getBuiltinNameIndex() {
+  static const llvm::StringMap<unsigned> Index = [] {
+    llvm::StringMap<unsigned> I(Builtin::FirstTSBuiltin);
+    for (unsigned ID = Builtin::NotBuiltin + 1; ID != Builtin::FirstTSBuiltin;
+         ++ID)
+      I.try_emplace(BuiltinInfo[ID].Name, ID);
+    return I;
+  }();
+  return Index;
+}
 
-  return false;
+bool Builtin::Context::isBuiltinFunc(const char *Name) {
+  const llvm::StringMap<unsigned> &Index = getBuiltinNameIndex();
+  auto Known = Index.find(Name);
+  if (Known == Index.end())
+    return false;
+  return strchr(BuiltinInfo[Known->second].Attributes, 'f') != nullptr;
 }
 
 bool Builtin::Context::builtinIsSupported(const Builtin::Info &BuiltinInfo,
@@ -14,9 +14,12 @@
 #include "clang/Basic/AllDiagnostics.h"
 #include "clang/Basic/DiagnosticCategories.h"
 #include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/RWMutex.h"
 #include <map>
 using namespace clang;
 
@@ -575,6 +578,55 @@ static bool getDiagnosticsInGroup(diag::Flavor Flavor,
   return NotFound;
 }
 
+namespace {
+/// A process-wide cache of fully expanded warning groups.
+///
+/// The group tables are immutable, so the transitive members of a group only
+/// depend on the group and the flavor. Expanding them once and sharing the
+/// result matters for tools that run one CompilerInstance per thread: every
+/// instance replays the same -W flags, and each flag used to re-walk the
+/// subgroup tree.
+class GroupExpansionCache {
+  struct Expansion {
+    SmallVector<diag::kind, 16> Members;
+    bool NotFound;
+  };
+
+  llvm::sys::RWMutex Mutex;
+  llvm::DenseMap<unsigned, std::unique_ptr<Expansion>> Expansions;
+
+public:
+  /// Return the expanded members of the group at \p Index in OptionTable,
+  /// computing them on the first request. The return value is the NotFound
+  /// result of the expansion.
+  bool get(diag::Flavor Flavor, unsigned Index,
+           ArrayRef<diag::kind> &Members) {
+    const unsigned Key = (static_cast<unsigned>(Flavor) << 16) | Index;
+    {
+      llvm::sys::ScopedReader Lock(Mutex);
+      auto I = Expansions.find(Key);
+      if (I != Expansions.end()) {
+        Members = I->second->Members;
+        return I->second->NotFound;
+      }
+    }
+
+    auto Entry = llvm::make_unique<Expansion>();
+    Entry->NotFound =
+        ::getDiagnosticsInGroup(Flavor, &OptionTable[Index], Entry->Members);
+
+    llvm::sys::ScopedWriter Lock(Mutex);
+    std::unique_ptr<Expansion> &Slot = Expansions[Key];
+    if (!Slot)
+      Slot = std::move(Entry);
+    Members = Slot->Members;
+    return Slot->NotFound;
+  }
+};
+} // namespace
+
+static llvm::ManagedStatic<GroupExpansionCache> ExpandedGroups;
+
 bool
 DiagnosticIDs::getDiagnosticsInGroup(diag::Flavor Flavor, StringRef Group,
                                      SmallVectorImpl<diag::kind> &Diags) const {
@@ -583,7 +635,11 @@ DiagnosticIDs::getDiagnosticsInGroup(diag::Flavor Flavor, StringRef Group,
   if (Found == std::end(OptionTable) || Found->getName() != Group)
     return true; // Option not found.
 
-  return ::getDiagnosticsInGroup(Flavor, Found, Diags);
+  ArrayRef<diag::kind> Members;
+  const bool NotFound =
+      ExpandedGroups->get(Flavor, Found - std::begin(OptionTable), Members);
+  Diags.append(Members.begin(), Members.end());
+  return NotFound;
 }
 
 void DiagnosticIDs::getAllDiagnostics(diag::Flavor Flavor,
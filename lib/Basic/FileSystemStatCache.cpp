@@ -118,3 +118,96 @@ MemorizeStatCalls::getStat(StringRef Path, llvm::vfs::Status &Status,
 
   return std::error_code();
 }
+
+void SharedStatCacheStorage::preloadDirectory(StringRef Dir,
+                                              llvm::vfs::FileSystem &FS) {
+  // Take the listing before locking; directory iteration may be slow.
+  std::vector<std::string> Names;
+  std::error_code EC;
+  for (llvm::vfs::directory_iterator I = FS.dir_begin(Dir, EC), E;
+       !EC && I != E; I.increment(EC))
+    Names.push_back(I->path());
+  if (EC)
+    return; // An unreadable directory gives us no negative information.
+
+  std::unique_lock<std::mutex> Lock(Mutex);
+  for (const std::string &Name : Names)
+    ListedNames.insert(Name);
+  ListedDirs.insert(Dir);
+}
+
+SharedStatCacheStorage::LookupResult
+SharedStatCacheStorage::lookup(StringRef Path,
+                               llvm::vfs::Status &Status) const {
+  std::unique_lock<std::mutex> Lock(Mutex);
+
+  auto I = PositiveEntries.find(Path);
+  if (I != PositiveEntries.end()) {
+    Status = I->second;
+    return LR_Exists;
+  }
+
+  if (NegativeEntries.count(Path))
+    return LR_DoesNotExist;
+
+  // A preloaded directory listing is exhaustive: any name under it that was
+  // not listed does not exist.
+  StringRef Parent = llvm::sys::path::parent_path(Path);
+  if (!Parent.empty() && ListedDirs.count(Parent) && !ListedNames.count(Path))
+    return LR_DoesNotExist;
+
+  return LR_Unknown;
+}
+
+void SharedStatCacheStorage::noteExists(StringRef Path,
+                                        const llvm::vfs::Status &Status) {
+  std::unique_lock<std::mutex> Lock(Mutex);
+  PositiveEntries[Path] = Status;
+}
+
+void SharedStatCacheStorage::noteDoesNotExist(StringRef Path) {
+  std::unique_lock<std::mutex> Lock(Mutex);
+  NegativeEntries.insert(Path);
+}
+
+std::error_code
+SharedStatCache::getStat(StringRef Path, llvm::vfs::Status &Status,
+                         bool isFile,
+                         std::unique_ptr<llvm::vfs::File> *F,
+                         llvm::vfs::FileSystem &FS) {
+  // Relative paths may resolve differently in other instances sharing the
+  // storage, so neither answer nor record them.
+  bool Cacheable = llvm::sys::path::is_absolute(Path);
+
+  if (Cacheable) {
+    // On a positive hit *F stays null even if the client asked for the file
+    // to be opened; as with the PCH stat cache, the client then opens the
+    // file lazily when the contents are actually needed.
+    switch (Storage->lookup(Path, Status)) {
+    case SharedStatCacheStorage::LR_Exists:
+      return std::error_code();
+    case SharedStatCacheStorage::LR_DoesNotExist:
+      return std::make_error_code(std::errc::no_such_file_or_directory);
+    case SharedStatCacheStorage::LR_Unknown:
+      break;
+    }
+  }
+
+  std::error_code err = get(Path, Status, isFile, F, nullptr, FS);
+  if (!Cacheable)
+    return err;
+
+  if (!err) {
+    Storage->noteExists(Path, Status);
+  } else if (err == std::errc::no_such_file_or_directory) {
+    Storage->noteDoesNotExist(Path);
+  } else if (err == std::errc::is_a_directory ||
+             err == std::errc::not_a_directory) {
+    // A "directoryness" mismatch still proves the path exists and leaves
+    // Status valid; record it so the mismatch is recomputed from the cache.
+    Storage->noteExists(Path, Status);
+  }
+  // Other errors (e.g. EACCES) are not cached: they are rare and may be
+  // transient.
+  return err;
+}
@@ -28,6 +28,7 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
@@ -36,6 +37,7 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <tuple>
 #include <utility>
@@ -82,6 +84,24 @@ unsigned ContentCache::getSize() const {
                              : (unsigned) ContentsEntry->getSize();
 }
 
+/// Determine whether a buffer contains only bytes in the ASCII range,
+/// scanning a machine word at a time. Plain ASCII is by far the common case,
+/// so a whole-buffer scan at load time is cheap compared to the per-byte
+/// checks it lets the lexer skip later.
+static bool containsOnlyASCII(StringRef Buf) {
+  const char *Ptr = Buf.begin(), *End = Buf.end();
+  uint64_t Word;
+  for (; Ptr + sizeof(Word) <= End; Ptr += sizeof(Word)) {
+    memcpy(&Word, Ptr, sizeof(Word));
+    if (Word & UINT64_C(0x8080808080808080))
+      return false;
+  }
+  for (; Ptr != End; ++Ptr)
+    if (*Ptr & 0x80)
+      return false;
+  return true;
+}
+
 void ContentCache::replaceBuffer(const llvm::MemoryBuffer *B, bool DoNotFree) {
   if (B && B == Buffer.getPointer()) {
     assert(0 && "Replacing with the same buffer");
@@ -93,6 +113,7 @@ void ContentCache::replaceBuffer(const llvm::MemoryBuffer *B, bool DoNotFree) {
     delete Buffer.getPointer();
   Buffer.setPointer(B);
   Buffer.setInt((B && DoNotFree) ? DoNotFreeFlag : 0);
+  IsPureASCII = B && containsOnlyASCII(B->getBuffer());
 }
 
 const llvm::MemoryBuffer *ContentCache::getBuffer(DiagnosticsEngine &Diag,
@@ -211,6 +232,12 @@ const llvm::MemoryBuffer *ContentCache::getBuffer(DiagnosticsEngine &Diag,
     Buffer.setInt(Buffer.getInt() | InvalidFlag);
   }
 
+  // Remember whether the buffer is plain ASCII, so that the lexer can take
+  // an ASCII-only fast path for the common case of source files with no
+  // extended characters. A buffer with an unsupported BOM has non-ASCII
+  // bytes up front, so it never qualifies.
+  IsPureASCII = containsOnlyASCII(BufStr);
+
   if (Invalid)
     *Invalid = isBufferInvalid();
 
@@ -301,6 +328,9 @@ void SourceManager::AddLineNote(SourceLocation Loc, unsigned LineNo,
                                 int FilenameID, bool IsFileEntry,
                                 bool IsFileExit,
                                 SrcMgr::CharacteristicKind FileKind) {
+  // The memoized presumed location may no longer reflect the line table.
+  LastPresumedFileIDQuery = FileID();
+
   std::pair<FileID, unsigned> LocInfo = getDecomposedExpansionLoc(Loc);
 
   bool Invalid = false;
@@ -364,10 +394,15 @@ SourceManager::~SourceManager() {
 void SourceManager::clearIDTables() {
   MainFileID = FileID();
   LocalSLocEntryTable.clear();
+  LocalSLocOffsetTable.clear();
   LoadedSLocEntryTable.clear();
   SLocEntryLoaded.clear();
   LastLineNoFileIDQuery = FileID();
   LastLineNoContentCache = nullptr;
+  LastPresumedFileIDQuery = FileID();
+  LastPresumedOffset = 0;
+  LastPresumedUseLineDirectives = false;
+  LastPresumedResult = PresumedLoc();
   LastFileIDLookup = FileID();
 
   if (LineTable)
@@ -571,6 +606,7 @@ FileID SourceManager::createFileID(const ContentCache *File,
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset,
                                                FileInfo::get(IncludePos, File,
                                                              FileCharacter)));
+  LocalSLocOffsetTable.push_back(NextLocalOffset);
   unsigned FileSize = File->getSize();
   assert(NextLocalOffset + FileSize + 1 > NextLocalOffset &&
          NextLocalOffset + FileSize + 1 <= CurrentLoadedOffset &&
@@ -631,7 +667,9 @@ SourceManager::createExpansionLocImpl(const ExpansionInfo &Info,
     SLocEntryLoaded[Index] = true;
     return SourceLocation::getMacroLoc(LoadedOffset);
   }
+
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset, Info));
+  LocalSLocOffsetTable.push_back(NextLocalOffset);
   assert(NextLocalOffset + TokLength + 1 > NextLocalOffset &&
          NextLocalOffset + TokLength + 1 <= CurrentLoadedOffset &&
          "Ran out of source locations!");
@@ -708,6 +746,16 @@ StringRef SourceManager::getBufferData(FileID FID, bool *Invalid) const {
   return Buf->getBuffer();
 }
 
+bool SourceManager::isBufferPureASCII(FileID FID) const {
+  bool MyInvalid = false;
+  const SLocEntry &SLoc = getSLocEntry(FID, &MyInvalid);
+  if (MyInvalid || !SLoc.isFile())
+    return false;
+
+  const ContentCache *Content = SLoc.getFile().getContentCache();
+  return Content && Content->isPureASCII();
+}
+
 //===----------------------------------------------------------------------===//
 // SourceLocation manipulation methods.
 //===----------------------------------------------------------------------===//
@@ -744,17 +792,22 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
   // then we fall back to a less cache efficient, but more scalable, binary
   // search to find the location.
 
+  // Both searches run over LocalSLocOffsetTable, the densely packed copy of
+  // the entry offsets, rather than striding through the SLocEntrys
+  // themselves: a cache line holds sixteen offsets but only a couple of
+  // entries.
+
   // See if this is near the file point - worst case we start scanning from the
   // most newly created FileID.
-  const SrcMgr::SLocEntry *I;
+  const unsigned *Begin = LocalSLocOffsetTable.begin();
+  const unsigned *I;
 
-  if (LastFileIDLookup.ID < 0 ||
-      LocalSLocEntryTable[LastFileIDLookup.ID].getOffset() < SLocOffset) {
+  if (LastFileIDLookup.ID < 0 || Begin[LastFileIDLookup.ID] < SLocOffset) {
     // Neither loc prunes our search.
-    I = LocalSLocEntryTable.end();
+    I = LocalSLocOffsetTable.end();
   } else {
     // Perhaps it is near the file point.
-    I = LocalSLocEntryTable.begin()+LastFileIDLookup.ID;
+    I = Begin + LastFileIDLookup.ID;
   }
 
   // Find the FileID that contains this.  "I" is an iterator that points to a
@@ -762,12 +815,12 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
   unsigned NumProbes = 0;
   while (true) {
     --I;
-    if (I->getOffset() <= SLocOffset) {
-      FileID Res = FileID::get(int(I - LocalSLocEntryTable.begin()));
+    if (*I <= SLocOffset) {
+      FileID Res = FileID::get(int(I - Begin));
 
       // If this isn't an expansion, remember it.  We have good locality across
       // FileID lookups.
-      if (!I->isExpansion())
+      if (!LocalSLocEntryTable[Res.ID].isExpansion())
         LastFileIDLookup = Res;
       NumLinearScans += NumProbes+1;
       return Res;
@@ -776,47 +829,29 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
       break;
   }
 
-  // Convert "I" back into an index.  We know that it is an entry whose index is
-  // larger than the offset we are looking for.
-  unsigned GreaterIndex = I - LocalSLocEntryTable.begin();
-  // LessIndex - This is the lower bound of the range that we're searching.
-  // We know that the offset corresponding to the FileID is is less than
-  // SLocOffset.
+  // The result is the last entry whose offset is <= SLocOffset. "GreaterIndex"
+  // is an entry known to have an offset larger than SLocOffset (the linear
+  // scan above just rejected it), and entry 0 has offset 0, so "LessIndex"
+  // starts as a valid lower bound.
+  unsigned GreaterIndex = I - Begin;
   unsigned LessIndex = 0;
   NumProbes = 0;
-  while (true) {
-    bool Invalid = false;
-    unsigned MiddleIndex = (GreaterIndex-LessIndex)/2+LessIndex;
-    unsigned MidOffset = getLocalSLocEntry(MiddleIndex, &Invalid).getOffset();
-    if (Invalid)
-      return FileID::get(0);
-
+  while (GreaterIndex - LessIndex > 1) {
+    unsigned MiddleIndex = LessIndex + (GreaterIndex - LessIndex) / 2;
     ++NumProbes;
-
-    // If the offset of the midpoint is too large, chop the high side of the
-    // range to the midpoint.
-    if (MidOffset > SLocOffset) {
+    if (Begin[MiddleIndex] > SLocOffset)
       GreaterIndex = MiddleIndex;
-      continue;
-    }
-
-    // If the middle index contains the value, succeed and return.
-    // FIXME: This could be made faster by using a function that's aware of
-    // being in the local area.
-    if (isOffsetInFileID(FileID::get(MiddleIndex), SLocOffset)) {
-      FileID Res = FileID::get(MiddleIndex);
-
-      // If this isn't a macro expansion, remember it.  We have good locality
-      // across FileID lookups.
-      if (!LocalSLocEntryTable[MiddleIndex].isExpansion())
-        LastFileIDLookup = Res;
-      NumBinaryProbes += NumProbes;
-      return Res;
-    }
-
-    // Otherwise, move the low-side up to the middle index.
-    LessIndex = MiddleIndex;
+    else
+      LessIndex = MiddleIndex;
   }
+  NumBinaryProbes += NumProbes;
+
+  FileID Res = FileID::get(int(LessIndex));
+  // If this isn't a macro expansion, remember it.  We have good locality
+  // across FileID lookups.
+  if (!LocalSLocEntryTable[LessIndex].isExpansion())
+    LastFileIDLookup = Res;
+  return Res;
 }
 
 /// Return the FileID for a SourceLocation with a high offset.
@@ -1239,9 +1274,36 @@ static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
 
   const unsigned char *Buf = (const unsigned char *)Buffer->getBufferStart();
   const unsigned char *End = (const unsigned char *)Buffer->getBufferEnd();
+#ifdef __SSE2__
+  const unsigned Size = End - Buf;
+#endif
   unsigned I = 0;
   while (true) {
     // Skip over the contents of the line.
+#ifdef __SSE2__
+    // Scan 16 bytes at a time; the scalar loop below then only looks at the
+    // chunk that contains a line terminator or a NUL. The typical source
+    // line fits into a single chunk, and for the long runs without any
+    // terminator (minified sources, string tables) this is where nearly all
+    // of the time of the byte-wise scan used to go.
+    const __m128i LF = _mm_set1_epi8('\n');
+    const __m128i CR = _mm_set1_epi8('\r');
+    const __m128i NUL = _mm_setzero_si128();
+    while (I + 16 <= Size) {
+      const __m128i Chunk =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(Buf + I));
+      const __m128i Special =
+          _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(Chunk, LF),
+                                    _mm_cmpeq_epi8(Chunk, CR)),
+                       _mm_cmpeq_epi8(Chunk, NUL));
+      const unsigned Mask = _mm_movemask_epi8(Special);
+      if (Mask) {
+        I += llvm::countTrailingZeros(Mask);
+        break;
+      }
+      I += 16;
+    }
+#endif
     while (Buf[I] != '\n' && Buf[I] != '\r' && Buf[I] != '\0')
       ++I;
 
@@ -1441,6 +1503,13 @@ PresumedLoc SourceManager::getPresumedLoc(SourceLocation Loc,
   // Presumed locations are always for expansion points.
   std::pair<FileID, unsigned> LocInfo = getDecomposedExpansionLoc(Loc);
 
+  // Diagnostics emission frequently resolves the same location several times
+  // in a row; serve those from the last query.
+  if (LocInfo.first == LastPresumedFileIDQuery &&
+      LocInfo.second == LastPresumedOffset &&
+      UseLineDirectives == LastPresumedUseLineDirectives)
+    return LastPresumedResult;
+
   bool Invalid = false;
   const SLocEntry &Entry = getSLocEntry(LocInfo.first, &Invalid);
   if (Invalid || !Entry.isFile())
@@ -1500,7 +1569,12 @@ PresumedLoc SourceManager::getPresumedLoc(SourceLocation Loc,
     }
   }
 
-  return PresumedLoc(Filename.data(), FID, LineNo, ColNo, IncludeLoc);
+  LastPresumedFileIDQuery = LocInfo.first;
+  LastPresumedOffset = LocInfo.second;
+  LastPresumedUseLineDirectives = UseLineDirectives;
+  LastPresumedResult = PresumedLoc(Filename.data(), FID, LineNo, ColNo,
+                                   IncludeLoc);
+  return LastPresumedResult;
 }
 
 /// Returns whether the PresumedLoc for a given SourceLocation is
@@ -2128,7 +2202,9 @@ void SourceManager::PrintStats() const {
   llvm::errs() << LocalSLocEntryTable.size() << " local SLocEntry's allocated ("
                << llvm::capacity_in_bytes(LocalSLocEntryTable)
                << " bytes of capacity), "
-               << NextLocalOffset << "B of Sloc address space used.\n";
+               << NextLocalOffset << "B of Sloc address space used ("
+               << llvm::format("%.2f", NextLocalOffset * 100.0 / MaxLoadedOffset)
+               << "% of the local half).\n";
   llvm::errs() << LoadedSLocEntryTable.size()
                << " loaded SLocEntries allocated, "
                << MaxLoadedOffset - CurrentLoadedOffset
@@ -2231,6 +2307,7 @@ SourceManager::MemoryBufferSizes SourceManager::getMemoryBufferSizes() const {
 size_t SourceManager::getDataStructureSizes() const {
   size_t size = llvm::capacity_in_bytes(MemBufferInfos)
     + llvm::capacity_in_bytes(LocalSLocEntryTable)
+    + llvm::capacity_in_bytes(LocalSLocOffsetTable)
     + llvm::capacity_in_bytes(LoadedSLocEntryTable)
     + llvm::capacity_in_bytes(SLocEntryLoaded)
     + llvm::capacity_in_bytes(FileInfos);
@@ -12,19 +12,25 @@
 #include "clang/CrossTU/CrossTranslationUnit.h"
 #include "clang/AST/ASTImporter.h"
 #include "clang/AST/Decl.h"
+#include "clang/AST/Expr.h"
+#include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/CrossTU/CrossTUDiagnostic.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <fstream>
+#include <mutex>
 #include <sstream>
 
 namespace clang {
@@ -49,6 +55,8 @@ STATISTIC(NumLangMismatch, "The # of language mismatches");
 STATISTIC(NumLangDialectMismatch, "The # of language dialect mismatches");
 STATISTIC(NumASTLoadThresholdReached,
           "The # of ASTs not loaded because of threshold");
+STATISTIC(NumASTUnitsEvicted,
+          "The # of ASTs evicted because of the AST cache budget");
 
 // Same as Triple's equality operator, but we check a field only if that is
 // known in both instances.
@@ -116,6 +124,35 @@ public:
 };
 
 static llvm::ManagedStatic<IndexErrorCategory> Category;
+
+/// A process wide cache of materialized external ASTUnits, keyed by the path
+/// of the AST dump file. Materialized ASTs are pointer graphs, so they cannot
+/// be shared between processes; sharing them between the
+/// CrossTranslationUnitContext instances of one process is the next best
+/// thing: tools that analyze many translation units in a single process
+/// deserialize each AST dump only once. Guarded by a mutex, as such tools may
+/// drive several compiler instances from different threads.
+class SharedASTUnitCache {
+public:
+  std::shared_ptr<ASTUnit> get(StringRef FileName) {
+    std::lock_guard<std::mutex> Guard(Mutex);
+    auto Entry = Units.find(FileName);
+    if (Entry == Units.end())
+      return nullptr;
+    return Entry->second;
+  }
+
+  void insert(StringRef FileName, std::shared_ptr<ASTUnit> Unit) {
+    std::lock_guard<std::mutex> Guard(Mutex);
+    Units.try_emplace(FileName, std::move(Unit));
+  }
+
+private:
+  std::mutex Mutex;
+  llvm::StringMap<std::shared_ptr<ASTUnit>> Units;
+};
+
+static llvm::ManagedStatic<SharedASTUnitCache> GlobalASTUnitCache;
 } // end anonymous namespace
 
 char IndexError::ID;
@@ -166,6 +203,202 @@ createCrossTUIndexString(const llvm::StringMap<std::string> &Index) {
   return Result.str();
 }
 
+namespace {
+/// Walks a translation unit and collects the external definition map entries
+/// of its main file.
+class ExtDefIndexCollector {
+public:
+  ExtDefIndexCollector(ASTContext &Ctx, llvm::StringMap<std::string> &Index)
+      : Ctx(Ctx), SM(Ctx.getSourceManager()), Index(Index) {}
+
+  void handleDecl(const Decl *D);
+
+private:
+  void addIfInMain(const DeclaratorDecl *DD, SourceLocation DefStart);
+
+  ASTContext &Ctx;
+  SourceManager &SM;
+  llvm::StringMap<std::string> &Index;
+  std::string MainFileName;
+};
+} // end anonymous namespace
+
+void ExtDefIndexCollector::handleDecl(const Decl *D) {
+  // Walk with an explicit worklist: generated code can nest declaration
+  // contexts deeply enough to overflow the stack with native recursion, and
+  // the order in which the index entries are collected does not matter.
+  SmallVector<const Decl *, 32> Worklist;
+  Worklist.push_back(D);
+
+  while (!Worklist.empty()) {
+    D = Worklist.pop_back_val();
+    if (!D)
+      continue;
+
+    if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+      if (FD->isThisDeclarationADefinition()) {
+        if (const Stmt *Body = FD->getBody())
+          addIfInMain(FD, Body->getBeginLoc());
+        else if (FD->hasSkippedBody())
+          // The body was skipped at parse time (-fskip-function-bodies); the
+          // index only needs the location of the definition anyway.
+          addIfInMain(FD, FD->getLocation());
+      }
+    } else if (const auto *VD = dyn_cast<VarDecl>(D)) {
+      if (containsConst(VD, Ctx) && VD->hasInit())
+        if (const Expr *Init = VD->getInit())
+          addIfInMain(VD, Init->getBeginLoc());
+    }
+
+    if (const auto *DC = dyn_cast<DeclContext>(D))
+      for (const Decl *Child : DC->decls())
+        Worklist.push_back(Child);
+  }
+}
+
+void ExtDefIndexCollector::addIfInMain(const DeclaratorDecl *DD,
+                                       SourceLocation DefStart) {
+  llvm::Optional<std::string> LookupName =
+      CrossTranslationUnitContext::getLookupName(DD);
+  if (!LookupName)
+    return;
+  assert(!LookupName->empty() && "Lookup name should be non-empty.");
+
+  if (MainFileName.empty()) {
+    MainFileName =
+        SM.getFileEntryForID(SM.getMainFileID())->tryGetRealPathName();
+    if (MainFileName.empty())
+      MainFileName = "invalid_file";
+  }
+
+  switch (DD->getLinkageInternal()) {
+  case ExternalLinkage:
+  case VisibleNoLinkage:
+  case UniqueExternalLinkage:
+    if (SM.isInMainFile(DefStart))
+      Index[*LookupName] = MainFileName;
+    break;
+  default:
+    break;
+  }
+}
+
+void collectCrossTUIndex(ASTContext &Ctx,
+                         llvm::StringMap<std::string> &Index) {
+  ExtDefIndexCollector(Ctx, Index).handleDecl(Ctx.getTranslationUnitDecl());
+}
+
+/// Magic bytes at the beginning of a binary external definition index file.
+static const char CrossTUIndexMagic[] = "CTUI";
+static const uint32_t CrossTUIndexVersion = 1;
+
+void writeBinaryCrossTUIndex(llvm::raw_ostream &OS,
+                             const llvm::StringMap<std::string> &Index) {
+  // The entries must be sorted by USR so the reader can use binary search.
+  std::vector<std::pair<StringRef, StringRef>> Entries;
+  Entries.reserve(Index.size());
+  for (const auto &E : Index)
+    Entries.emplace_back(E.getKey(), E.getValue());
+  llvm::sort(Entries, [](const std::pair<StringRef, StringRef> &LHS,
+                         const std::pair<StringRef, StringRef> &RHS) {
+    return LHS.first < RHS.first;
+  });
+
+  // Build the string table; file paths are typically shared by many entries,
+  // so identical strings are stored only once.
+  std::string StringTable;
+  llvm::StringMap<uint32_t> StringOffsets;
+  auto InternString = [&StringTable, &StringOffsets](StringRef S) -> uint32_t {
+    auto Inserted = StringOffsets.try_emplace(S, StringTable.size());
+    if (Inserted.second) {
+      StringTable.append(S.begin(), S.end());
+      StringTable.push_back('\0');
+    }
+    return Inserted.first->second;
+  };
+
+  llvm::support::endian::Writer Writer(OS, llvm::support::little);
+  OS.write(CrossTUIndexMagic, 4);
+  Writer.write<uint32_t>(CrossTUIndexVersion);
+  Writer.write<uint32_t>(Entries.size());
+  for (const auto &Entry : Entries) {
+    Writer.write<uint32_t>(InternString(Entry.first));
+    Writer.write<uint32_t>(InternString(Entry.second));
+  }
+  OS << StringTable;
+}
+
+bool BinaryCrossTUIndex::isBinaryIndexFile(StringRef IndexPath) {
+  // Only the magic bytes are needed to decide about the format.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFileSlice(IndexPath, /*MapSize=*/4, /*Offset=*/0);
+  if (!Buffer)
+    return false;
+  return (*Buffer)->getBuffer().startswith(CrossTUIndexMagic);
+}
+
+llvm::Expected<BinaryCrossTUIndex>
+BinaryCrossTUIndex::load(StringRef IndexPath, StringRef CrossTUDir) {
+  // Do not ask for a null terminator: the reader is bounds-checked and never
+  // scans past the buffer, and dropping the requirement guarantees the file
+  // is mapped as-is instead of being copied into private memory. Concurrent
+  // analyzer processes mapping the same index then share one set of physical
+  // pages through the page cache, so only the first of them pays the I/O.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> BufferOrErr =
+      llvm::MemoryBuffer::getFile(IndexPath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!BufferOrErr)
+    return llvm::make_error<IndexError>(index_error_code::missing_index_file,
+                                        IndexPath.str());
+  std::unique_ptr<llvm::MemoryBuffer> Buffer = std::move(*BufferOrErr);
+
+  StringRef Data = Buffer->getBuffer();
+  if (Data.size() < HeaderSize || !Data.startswith(CrossTUIndexMagic))
+    return llvm::make_error<IndexError>(index_error_code::invalid_index_format,
+                                        IndexPath.str());
+  const uint32_t Version =
+      llvm::support::endian::read32le(Data.data() + 4);
+  const uint32_t NumEntries =
+      llvm::support::endian::read32le(Data.data() + 8);
+  if (Version != CrossTUIndexVersion ||
+      Data.size() < HeaderSize + uint64_t(NumEntries) * EntrySize)
+    return llvm::make_error<IndexError>(index_error_code::invalid_index_format,
+                                        IndexPath.str());
+
+  return BinaryCrossTUIndex(std::move(Buffer), NumEntries, CrossTUDir);
+}
+
+StringRef BinaryCrossTUIndex::getString(uint32_t Offset) const {
+  StringRef Data = Buffer->getBuffer();
+  const size_t Begin = HeaderSize + size_t(NumEntries) * EntrySize + Offset;
+  if (Begin >= Data.size())
+    return StringRef();
+  return Data.slice(Begin, Data.find('\0', Begin));
+}
+
+llvm::Optional<std::string>
+BinaryCrossTUIndex::lookup(StringRef LookupName) const {
+  const char *EntryTable = Buffer->getBufferStart() + HeaderSize;
+  uint32_t Low = 0, High = NumEntries;
+  while (Low < High) {
+    const uint32_t Mid = Low + (High - Low) / 2;
+    const char *Entry = EntryTable + uint64_t(Mid) * EntrySize;
+    StringRef Key = getString(llvm::support::endian::read32le(Entry));
+    if (Key == LookupName) {
+      StringRef FileName =
+          getString(llvm::support::endian::read32le(Entry + 4));
+      SmallString<256> FilePath = StringRef(CrossTUDir);
+      llvm::sys::path::append(FilePath, FileName);
+      return FilePath.str().str();
+    }
+    if (Key < LookupName)
+      Low = Mid + 1;
+    else
+      High = Mid;
+  }
+  return llvm::None;
+}
+
 bool containsConst(const VarDecl *VD, const ASTContext &ACtx) {
   CanQualType CT = ACtx.getCanonicalType(VD->getType());
   if (!CT.isConstQualified()) {
@@ -188,7 +421,9 @@ template <typename T> static bool hasBodyOrInit(const T *D) {
 }
 
 CrossTranslationUnitContext::CrossTranslationUnitContext(CompilerInstance &CI)
-    : Context(CI.getASTContext()), ASTStorage(CI) {}
+    : Context(CI.getASTContext()),
+      MinimalImport(CI.getAnalyzerOpts()->ShouldMinimalImportCTU),
+      ASTStorage(CI) {}
 
 CrossTranslationUnitContext::~CrossTranslationUnitContext() {}
 
@@ -355,16 +590,73 @@ CrossTranslationUnitContext::ASTFileLoader::operator()(StringRef ASTFilePath) {
   IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
       new DiagnosticsEngine(DiagID, &*DiagOpts, DiagClient));
 
+  // The importer only needs the AST and the preprocessor state; skipping the
+  // Sema restoration avoids the eager part of the deserialization. The decls
+  // themselves are faulted in lazily from the memory-mapped bitstream when
+  // the importer touches them.
   return ASTUnit::LoadFromASTFile(
       ASTFilePath, CI.getPCHContainerOperations()->getRawReader(),
-      ASTUnit::LoadEverything, Diags, CI.getFileSystemOpts());
+      ASTUnit::LoadASTOnly, Diags, CI.getFileSystemOpts());
 }
 
 CrossTranslationUnitContext::ASTUnitStorage::ASTUnitStorage(
     const CompilerInstance &CI)
-    : FileAccessor(CI), LoadGuard(const_cast<CompilerInstance &>(CI)
-                                      .getAnalyzerOpts()
-                                      ->CTUImportThreshold) {}
+    : FileAccessor(CI),
+      ShareLoadedASTs(const_cast<CompilerInstance &>(CI)
+                          .getAnalyzerOpts()
+                          ->ShouldShareLoadedCTUASTs),
+      ASTCacheSize(const_cast<CompilerInstance &>(CI)
+                       .getAnalyzerOpts()
+                       ->CTUASTCacheSize),
+      LoadGuard(const_cast<CompilerInstance &>(CI)
+                    .getAnalyzerOpts()
+                    ->CTUImportThreshold) {}
+
+void CrossTranslationUnitContext::ASTUnitStorage::markRecentlyUsed(
+    StringRef FileName) {
+  if (!ASTCacheSize)
+    return;
+  auto Pos = RecencyPos.find(FileName);
+  if (Pos != RecencyPos.end()) {
+    RecencyList.splice(RecencyList.begin(), RecencyList, Pos->second);
+  } else {
+    RecencyList.emplace_front(FileName.str());
+    RecencyPos[FileName] = RecencyList.begin();
+  }
+}
+
+void CrossTranslationUnitContext::ASTUnitStorage::evictOverBudget() {
+  if (!ASTCacheSize)
+    return;
+  while (RecencyList.size() > ASTCacheSize) {
+    const std::string &FileName = RecencyList.back();
+
+    auto Evicted = FileASTUnitMap.find(FileName);
+    assert(Evicted != FileASTUnitMap.end() &&
+           "The recency list tracks only loaded units.");
+    ASTUnit *Unit = Evicted->second.get();
+
+    // Drop the name based cache entries referring to the evicted unit, so a
+    // subsequent import from it triggers an on-demand re-load.
+    SmallVector<StringRef, 8> StaleNames;
+    for (const auto &Entry : NameASTUnitMap)
+      if (Entry.second == Unit)
+        StaleNames.push_back(Entry.first());
+    for (StringRef StaleName : StaleNames)
+      NameASTUnitMap.erase(StaleName);
+
+    EvictedUnits.push_back(std::move(Evicted->second));
+    FileASTUnitMap.erase(Evicted);
+    RecencyPos.erase(FileName);
+    RecencyList.pop_back();
+    ++NumASTUnitsEvicted;
+  }
+}
+
+std::vector<std::shared_ptr<ASTUnit>>
+CrossTranslationUnitContext::ASTUnitStorage::takeEvictedUnits() {
+  return std::move(EvictedUnits);
+}
 
 llvm::Expected<ASTUnit *>
 CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFile(
@@ -373,6 +665,18 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFile(
   auto ASTCacheEntry = FileASTUnitMap.find(FileName);
   if (ASTCacheEntry == FileASTUnitMap.end()) {
 
+    // An other context of this process may have materialized the AST already.
+    if (ShareLoadedASTs) {
+      if (std::shared_ptr<ASTUnit> SharedUnit =
+              GlobalASTUnitCache->get(FileName)) {
+        ASTUnit *Unit = SharedUnit.get();
+        FileASTUnitMap[FileName] = std::move(SharedUnit);
+        markRecentlyUsed(FileName);
+        evictOverBudget();
+        return Unit;
+      }
+    }
+
     // Do not load if the limit is reached.
     if (!LoadGuard) {
       ++NumASTLoadThresholdReached;
@@ -381,13 +685,17 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFile(
     }
 
     // Load the ASTUnit from the pre-dumped AST file specified by ASTFileName.
-    std::unique_ptr<ASTUnit> LoadedUnit = FileAccessor(FileName);
+    std::shared_ptr<ASTUnit> LoadedUnit = FileAccessor(FileName);
 
-    // Need the raw pointer and the unique_ptr as well.
+    // Need the raw pointer and the owning pointer as well.
     ASTUnit *Unit = LoadedUnit.get();
 
-    // Update the cache.
+    // Update the caches.
+    if (ShareLoadedASTs)
+      GlobalASTUnitCache->insert(FileName, LoadedUnit);
     FileASTUnitMap[FileName] = std::move(LoadedUnit);
+    markRecentlyUsed(FileName);
+    evictOverBudget();
 
     LoadGuard.indicateLoadSuccess();
 
@@ -398,6 +706,7 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFile(
 
   } else {
     // Found in the cache.
+    markRecentlyUsed(FileName);
     return ASTCacheEntry->second.get();
   }
 }
@@ -417,7 +726,8 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFunction(
       return std::move(IndexLoadError);
 
     // Check if there is and entry in the index for the function.
-    if (!NameFileMap.count(FunctionName)) {
+    llvm::Optional<std::string> FileName = lookupName(FunctionName);
+    if (!FileName) {
       ++NumNotInOtherTU;
       return llvm::make_error<IndexError>(index_error_code::missing_definition);
     }
@@ -425,7 +735,7 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFunction(
     // Search in the index for the filename where the definition of FuncitonName
     // resides.
     if (llvm::Expected<ASTUnit *> FoundForFile =
-            getASTUnitForFile(NameFileMap[FunctionName], DisplayCTUProgress)) {
+            getASTUnitForFile(*FileName, DisplayCTUProgress)) {
 
       // Update the cache.
       NameASTUnitMap[FunctionName] = *FoundForFile;
@@ -435,7 +745,10 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFunction(
       return FoundForFile.takeError();
     }
   } else {
-    // Found in the cache.
+    // Found in the cache. Refresh the entry's position in the eviction order.
+    if (ASTCacheSize)
+      if (llvm::Optional<std::string> FileName = lookupName(FunctionName))
+        markRecentlyUsed(*FileName);
     return ASTCacheEntry->second;
   }
 }
@@ -445,13 +758,26 @@ CrossTranslationUnitContext::ASTUnitStorage::getFileForFunction(
     StringRef FunctionName, StringRef CrossTUDir, StringRef IndexName) {
   if (llvm::Error IndexLoadError = ensureCTUIndexLoaded(CrossTUDir, IndexName))
     return std::move(IndexLoadError);
-  return NameFileMap[FunctionName];
+  if (llvm::Optional<std::string> FileName = lookupName(FunctionName))
+    return *FileName;
+  return llvm::make_error<IndexError>(index_error_code::missing_definition);
+}
+
+llvm::Optional<std::string>
+CrossTranslationUnitContext::ASTUnitStorage::lookupName(
+    StringRef FunctionName) const {
+  if (LazyIndex)
+    return LazyIndex->lookup(FunctionName);
+  auto Entry = NameFileMap.find(FunctionName);
+  if (Entry == NameFileMap.end())
+    return llvm::None;
+  return Entry->second;
 }
 
 llvm::Error CrossTranslationUnitContext::ASTUnitStorage::ensureCTUIndexLoaded(
     StringRef CrossTUDir, StringRef IndexName) {
-  // Dont initialize if the map is filled.
-  if (!NameFileMap.empty())
+  // Dont initialize if the map is filled or a lazy index is attached.
+  if (!NameFileMap.empty() || LazyIndex)
     return llvm::Error::success();
 
   // Get the absolute path to the index file.
@@ -461,6 +787,16 @@ llvm::Error CrossTranslationUnitContext::ASTUnitStorage::ensureCTUIndexLoaded(
   else
     llvm::sys::path::append(IndexFile, IndexName);
 
+  // The binary format needs no parsing: lookups are served directly from the
+  // memory mapped file.
+  if (BinaryCrossTUIndex::isBinaryIndexFile(IndexFile)) {
+    if (auto Index = BinaryCrossTUIndex::load(IndexFile, CrossTUDir)) {
+      LazyIndex = std::move(*Index);
+      return llvm::Error::success();
+    } else
+      return Index.takeError();
+  }
+
   if (auto IndexMapping = parseCrossTUIndex(IndexFile, CrossTUDir)) {
     // Initialize member map.
     NameFileMap = *IndexMapping;
@@ -483,6 +819,22 @@ llvm::Expected<ASTUnit *> CrossTranslationUnitContext::loadExternalAST(
   llvm::Expected<ASTUnit *> Unit = ASTStorage.getASTUnitForFunction(
       LookupName, CrossTUDir, IndexName, DisplayCTUProgress);
 
+  // Release the importer state of the units evicted by the AST cache budget,
+  // so their memory can actually be reclaimed. Importing from such a unit
+  // again creates a fresh importer; the ASTImporterSharedState keeps the
+  // lookup results consistent between the old and the new importer.
+  for (const std::shared_ptr<ASTUnit> &Evicted : ASTStorage.takeEvictedUnits()) {
+    if (!Evicted)
+      continue;
+    ASTUnitImporterMap.erase(Evicted->getASTContext().getTranslationUnitDecl());
+    SmallVector<FileID, 8> StaleFileIDs;
+    for (const auto &Entry : ImportedFileIDs)
+      if (Entry.second.second == Evicted.get())
+        StaleFileIDs.push_back(Entry.first);
+    for (FileID FID : StaleFileIDs)
+      ImportedFileIDs.erase(FID);
+  }
+
   if (!Unit)
     return Unit.takeError();
 
@@ -556,7 +908,8 @@ CrossTranslationUnitContext::getOrCreateASTImporter(ASTUnit *Unit) {
   lazyInitImporterSharedSt(Context.getTranslationUnitDecl());
   ASTImporter *NewImporter = new ASTImporter(
       Context, Context.getSourceManager().getFileManager(), From,
-      From.getSourceManager().getFileManager(), false, ImporterSharedSt);
+      From.getSourceManager().getFileManager(), MinimalImport,
+      ImporterSharedSt);
   NewImporter->setFileIDImportHandler([this, Unit](FileID ToID, FileID FromID) {
     assert(ImportedFileIDs.find(ToID) == ImportedFileIDs.end() &&
            "FileID already imported, should not happen.");
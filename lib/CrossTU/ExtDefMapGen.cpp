@@ -0,0 +1,72 @@
+//===--- ExtDefMapGen.cpp - Emit the extdef map while compiling -----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the frontend action adaptor which emits the external
+//  definition map entries of a translation unit during a normal compilation.
+//
+//===----------------------------------------------------------------------===//
+#include "clang/CrossTU/ExtDefMapGen.h"
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/CrossTU/CrossTranslationUnit.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/MultiplexConsumer.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace clang::cross_tu;
+
+namespace {
+
+/// Collects the external definition map entries once the wrapped action's
+/// consumer is done with the translation unit and writes them out.
+class ExtDefMapConsumer : public ASTConsumer {
+public:
+  ExtDefMapConsumer(CompilerInstance &CI, StringRef OutputPath)
+      : CI(CI), OutputPath(OutputPath) {}
+
+  void HandleTranslationUnit(ASTContext &Ctx) override {
+    llvm::StringMap<std::string> Index;
+    collectCrossTUIndex(Ctx, Index);
+
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(OutputPath, EC, llvm::sys::fs::F_None);
+    if (EC) {
+      CI.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << OutputPath << EC.message();
+      return;
+    }
+    OS << createCrossTUIndexString(Index);
+  }
+
+private:
+  CompilerInstance &CI;
+  std::string OutputPath;
+};
+
+} // end anonymous namespace
+
+GenerateExtDefMapAction::GenerateExtDefMapAction(
+    std::unique_ptr<FrontendAction> WrappedAction, StringRef OutputPath)
+    : WrapperFrontendAction(std::move(WrappedAction)), OutputPath(OutputPath) {}
+
+std::unique_ptr<ASTConsumer>
+GenerateExtDefMapAction::CreateASTConsumer(CompilerInstance &CI,
+                                           StringRef InFile) {
+  std::unique_ptr<ASTConsumer> Wrapped =
+      WrapperFrontendAction::CreateASTConsumer(CI, InFile);
+  if (!Wrapped)
+    return nullptr;
+
+  std::vector<std::unique_ptr<ASTConsumer>> Consumers;
+  Consumers.push_back(std::move(Wrapped));
+  Consumers.push_back(llvm::make_unique<ExtDefMapConsumer>(CI, OutputPath));
+  return llvm::make_unique<MultiplexConsumer>(std::move(Consumers));
+}
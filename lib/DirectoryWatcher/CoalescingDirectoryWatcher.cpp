@@ -0,0 +1,193 @@
+//===- CoalescingDirectoryWatcher.cpp - Storm-absorbing watcher wrapper ---===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "DirectoryScanner.h"
+#include "clang/DirectoryWatcher/DirectoryWatcher.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Path.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace clang;
+using namespace llvm;
+
+namespace {
+
+/// Wraps a platform DirectoryWatcher and batches its events; see
+/// DirectoryWatcher::createCoalescing for the delivery contract.
+class CoalescingDirectoryWatcher final : public DirectoryWatcher {
+public:
+  CoalescingDirectoryWatcher(
+      StringRef Path,
+      std::function<void(ArrayRef<Event>, bool)> Receiver,
+      std::chrono::milliseconds SettleDuration, size_t RescanThreshold)
+      : WatchedPath(Path), Receiver(std::move(Receiver)),
+        SettleDuration(SettleDuration), RescanThreshold(RescanThreshold) {
+    FlushThread = std::thread([this] { flushLoop(); });
+  }
+
+  /// Must be called after construction; separate so that the platform
+  /// watcher never sees a half-constructed wrapper.
+  bool startWatching(bool WaitForInitialSync) {
+    Inner = DirectoryWatcher::create(
+        WatchedPath,
+        [this](ArrayRef<Event> Events, bool IsInitial) {
+          onRawEvents(Events, IsInitial);
+        },
+        WaitForInitialSync);
+    return Inner != nullptr;
+  }
+
+  ~CoalescingDirectoryWatcher() override {
+    // Stop the event source first; its destructor delivers the guaranteed
+    // invalidation event, which requests an immediate flush.
+    Inner.reset();
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      ShutDown = true;
+    }
+    Cond.notify_all();
+    FlushThread.join();
+    // Whatever arrived after the last flush still belongs to the client.
+    if (!Pending.empty())
+      Receiver(coalesceEvents(std::move(Pending)), /*IsInitial=*/false);
+  }
+
+private:
+  void onRawEvents(ArrayRef<Event> Events, bool IsInitial) {
+    if (IsInitial) {
+      // The initial scan is forwarded unchanged; it also seeds the snapshot
+      // the first storm diff will be computed against. No batched events can
+      // precede it, so Snapshot is not contended yet.
+      Snapshot = takeDirectorySnapshot(WatchedPath);
+      Receiver(Events, /*IsInitial=*/true);
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      for (const Event &E : Events) {
+        Pending.push_back(E);
+        if (E.Kind == Event::EventKind::WatchedDirRemoved ||
+            E.Kind == Event::EventKind::WatcherGotInvalidated)
+          UrgentFlush = true;
+      }
+      RawEventCount += Events.size();
+    }
+    Cond.notify_all();
+  }
+
+  void flushLoop() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (true) {
+      Cond.wait(Lock, [this] { return !Pending.empty() || ShutDown; });
+      if (ShutDown)
+        return;
+
+      // Let the storm settle: flush once no new event arrived for a full
+      // settle period, or right away when urgent.
+      while (!UrgentFlush && !ShutDown) {
+        size_t Count = RawEventCount;
+        Cond.wait_for(Lock, SettleDuration,
+                      [this] { return UrgentFlush || ShutDown; });
+        if (RawEventCount == Count)
+          break;
+      }
+      if (ShutDown)
+        return;
+
+      flushLocked(Lock);
+    }
+  }
+
+  void flushLocked(std::unique_lock<std::mutex> &Lock) {
+    std::vector<Event> Batch = std::move(Pending);
+    Pending.clear();
+    bool Rescan = RawEventCount >= RescanThreshold;
+    RawEventCount = 0;
+    UrgentFlush = false;
+    Lock.unlock();
+
+    std::vector<Event> Out;
+    if (Rescan) {
+      // The storm exceeded the threshold; diffing one fresh listing against
+      // the last delivered state is O(changed files), not O(events).
+      DirectorySnapshot New = takeDirectorySnapshot(WatchedPath);
+      Out = diffDirectorySnapshots(Snapshot, New);
+      Snapshot = std::move(New);
+      // Directory-level events still have to reach the client.
+      for (Event &E : Batch)
+        if (E.Filename.empty())
+          Out.push_back(std::move(E));
+    } else {
+      Out = coalesceEvents(std::move(Batch));
+      updateSnapshot(Out);
+    }
+
+    if (!Out.empty())
+      Receiver(Out, /*IsInitial=*/false);
+    Lock.lock();
+  }
+
+  /// Keeps the snapshot in sync with what the client has been told, so that
+  /// a later storm diff never contradicts already delivered events.
+  void updateSnapshot(ArrayRef<Event> Events) {
+    for (const Event &E : Events) {
+      if (E.Filename.empty())
+        continue;
+      if (E.Kind == Event::EventKind::Removed) {
+        Snapshot.Files.erase(E.Filename);
+        continue;
+      }
+      SmallString<256> Path(WatchedPath);
+      sys::path::append(Path, E.Filename);
+      if (auto Status = getFileStatus(Path))
+        Snapshot.Files[E.Filename] = {
+            Status->getSize(),
+            Status->getLastModificationTime().time_since_epoch().count()};
+      else
+        Snapshot.Files.erase(E.Filename);
+    }
+  }
+
+  std::string WatchedPath;
+  std::function<void(ArrayRef<Event>, bool)> Receiver;
+  const std::chrono::milliseconds SettleDuration;
+  const size_t RescanThreshold;
+
+  std::mutex Mutex;
+  std::condition_variable Cond;
+  std::vector<Event> Pending;
+  size_t RawEventCount = 0;
+  bool UrgentFlush = false;
+  bool ShutDown = false;
+
+  /// Only touched by the flush thread and the initial-scan callback, which
+  /// cannot overlap.
+  DirectorySnapshot Snapshot;
+
+  std::thread FlushThread;
+  std::unique_ptr<DirectoryWatcher> Inner;
+};
+
+} // namespace
+
+std::unique_ptr<DirectoryWatcher> DirectoryWatcher::createCoalescing(
+    StringRef Path,
+    std::function<void(ArrayRef<DirectoryWatcher::Event>, bool)> Receiver,
+    bool WaitForInitialSync, std::chrono::milliseconds SettleDuration,
+    size_t RescanThreshold) {
+  auto Watcher = llvm::make_unique<CoalescingDirectoryWatcher>(
+      Path, std::move(Receiver), SettleDuration, RescanThreshold);
+  if (!Watcher->startWatching(WaitForInitialSync))
+    return nullptr;
+  return std::move(Watcher);
+}
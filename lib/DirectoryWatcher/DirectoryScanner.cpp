@@ -8,7 +8,9 @@
 
 #include "DirectoryScanner.h"
 
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Path.h"
+#include <algorithm>
 
 namespace clang {
 
@@ -39,6 +41,62 @@ std::vector<std::string> scanDirectory(StringRef Path) {
   return Result;
 }
 
+DirectorySnapshot takeDirectorySnapshot(StringRef Path) {
+  using namespace llvm::sys;
+  DirectorySnapshot Snapshot;
+
+  std::error_code EC;
+  for (auto It = fs::directory_iterator(Path, EC),
+            End = fs::directory_iterator();
+       !EC && It != End; It.increment(EC)) {
+    auto Status = getFileStatus(It->path());
+    if (!Status.hasValue())
+      continue;
+    Snapshot.Files[path::filename(It->path())] = {
+        Status->getSize(),
+        Status->getLastModificationTime().time_since_epoch().count()};
+  }
+
+  return Snapshot;
+}
+
+std::vector<DirectoryWatcher::Event>
+diffDirectorySnapshots(const DirectorySnapshot &Old,
+                       const DirectorySnapshot &New) {
+  std::vector<DirectoryWatcher::Event> Events;
+
+  for (const auto &OldEntry : Old.Files)
+    if (!New.Files.count(OldEntry.first))
+      Events.emplace_back(DirectoryWatcher::Event::EventKind::Removed,
+                          OldEntry.first);
+
+  for (const auto &NewEntry : New.Files) {
+    auto OldIt = Old.Files.find(NewEntry.first);
+    if (OldIt == Old.Files.end() || OldIt->second != NewEntry.second)
+      Events.emplace_back(DirectoryWatcher::Event::EventKind::Modified,
+                          NewEntry.first);
+  }
+
+  return Events;
+}
+
+std::vector<DirectoryWatcher::Event>
+coalesceEvents(std::vector<DirectoryWatcher::Event> Events) {
+  std::vector<DirectoryWatcher::Event> Result;
+  Result.reserve(Events.size());
+
+  // Walk backwards so that the last event per file is the one kept.
+  llvm::StringSet<> SeenFiles;
+  for (auto It = Events.rbegin(), End = Events.rend(); It != End; ++It) {
+    if (!It->Filename.empty() && !SeenFiles.insert(It->Filename).second)
+      continue;
+    Result.push_back(std::move(*It));
+  }
+
+  std::reverse(Result.begin(), Result.end());
+  return Result;
+}
+
 std::vector<DirectoryWatcher::Event>
 getAsFileEvents(const std::vector<std::string> &Scan) {
   std::vector<DirectoryWatcher::Event> Events;
@@ -8,6 +8,7 @@
 
 #include "clang/DirectoryWatcher/DirectoryWatcher.h"
 #include "llvm/Support/FileSystem.h"
+#include <map>
 #include <string>
 #include <vector>
 
@@ -26,4 +27,27 @@ getAsFileEvents(const std::vector<std::string> &Scan);
 /// \returns llvm::None if \p Path doesn't exist or can't get the status.
 llvm::Optional<llvm::sys::fs::file_status> getFileStatus(llvm::StringRef Path);
 
+/// A point-in-time listing of a directory taken in one bulk stat pass:
+/// file name to (size, modification time).
+struct DirectorySnapshot {
+  std::map<std::string, std::pair<uint64_t, int64_t>> Files;
+};
+
+/// Lists and stats every entry of the directory at \p Path in one pass.
+DirectorySnapshot takeDirectorySnapshot(llvm::StringRef Path);
+
+/// Computes the events that turn \p Old into \p New: Removed for entries that
+/// disappeared, Modified for entries that appeared or changed. The result is
+/// proportional to the number of changed files, however many kernel events
+/// the change generated.
+std::vector<DirectoryWatcher::Event>
+diffDirectorySnapshots(const DirectorySnapshot &Old,
+                       const DirectorySnapshot &New);
+
+/// Collapses an event stream so that only the last event per file survives,
+/// in the order the surviving events arrived. Events about the watched
+/// directory itself (empty filename) are never dropped.
+std::vector<DirectoryWatcher::Event>
+coalesceEvents(std::vector<DirectoryWatcher::Event> Events);
+
 } // namespace clang
\ No newline at end of file
@@ -2344,6 +2344,66 @@ tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
   return Result;
 }
 
+// Returns the smallest whole-line range of \p New covering everything that
+// differs from \p Old.
+static tooling::Range computeDirtyLineRange(StringRef Old, StringRef New) {
+  size_t MinSize = std::min(Old.size(), New.size());
+  size_t Prefix = 0;
+  while (Prefix < MinSize && Old[Prefix] == New[Prefix])
+    ++Prefix;
+  size_t OldEnd = Old.size();
+  size_t NewEnd = New.size();
+  while (OldEnd > Prefix && NewEnd > Prefix &&
+         Old[OldEnd - 1] == New[NewEnd - 1]) {
+    --OldEnd;
+    --NewEnd;
+  }
+  // Widen to whole lines; an edit within a line dirties the line as a whole,
+  // and snapping to line boundaries also keeps multi-byte characters intact.
+  while (Prefix > 0 && New[Prefix - 1] != '\n')
+    --Prefix;
+  while (NewEnd < New.size() && New[NewEnd] != '\n')
+    ++NewEnd;
+  return tooling::Range(Prefix, NewEnd - Prefix);
+}
+
+tooling::Replacements reformatIncremental(const FormatStyle &Style,
+                                          StringRef Code,
+                                          IncrementalFormatCache &Cache,
+                                          StringRef FileName,
+                                          FormattingAttemptStatus *Status) {
+  if (Cache.Valid && Style == Cache.PreviousStyle) {
+    if (Code == Cache.PreviousCode) {
+      if (Status)
+        *Status = Cache.PreviousStatus;
+      return Cache.PreviousResult;
+    }
+    const tooling::Range Dirty =
+        computeDirtyLineRange(Cache.PreviousCode, Code);
+    FormattingAttemptStatus LocalStatus;
+    tooling::Replacements Result =
+        reformat(Style, Code, Dirty, FileName, &LocalStatus);
+    Cache.PreviousCode = Code;
+    Cache.PreviousResult = Result;
+    Cache.PreviousStatus = LocalStatus;
+    if (Status)
+      *Status = LocalStatus;
+    return Result;
+  }
+
+  FormattingAttemptStatus LocalStatus;
+  tooling::Replacements Result = reformat(
+      Style, Code, tooling::Range(0, Code.size()), FileName, &LocalStatus);
+  Cache.Valid = true;
+  Cache.PreviousStyle = Style;
+  Cache.PreviousCode = Code;
+  Cache.PreviousResult = Result;
+  Cache.PreviousStatus = LocalStatus;
+  if (Status)
+    *Status = LocalStatus;
+  return Result;
+}
+
 tooling::Replacements fixNamespaceEndComments(const FormatStyle &Style,
                                               StringRef Code,
                                               ArrayRef<tooling::Range> Ranges,
@@ -14,6 +14,8 @@
 #include "clang/AST/AST.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclGroup.h"
+#include "clang/AST/JSONNodeDumper.h"
 #include "clang/AST/PrettyPrinter.h"
 #include "clang/AST/RecordLayout.h"
 #include "clang/AST/RecursiveASTVisitor.h"
@@ -41,7 +43,27 @@ namespace {
           OutputKind(K), OutputFormat(Format), FilterString(FilterString),
           DumpLookups(DumpLookups) {}
 
+    bool HandleTopLevelDecl(DeclGroupRef DG) override {
+      if (!isStreaming())
+        return true;
+
+      // Stream each declaration as it is parsed instead of waiting for the
+      // whole translation unit, so memory use stays bounded by the largest
+      // single declaration rather than the output size.
+      for (Decl *D : DG) {
+        if (!FilterString.empty() && !filterMatches(D))
+          continue;
+        printJSONLine(D);
+      }
+      return true;
+    }
+
     void HandleTranslationUnit(ASTContext &Context) override {
+      // In JSON-lines mode the declarations have already been streamed out
+      // from HandleTopLevelDecl.
+      if (isStreaming())
+        return;
+
       TranslationUnitDecl *D = Context.getTranslationUnitDecl();
 
       if (FilterString.empty())
@@ -70,6 +92,19 @@ namespace {
     }
 
   private:
+    bool isStreaming() const {
+      return OutputFormat == ADOF_JSONLines && OutputKind == Dump &&
+             !DumpLookups;
+    }
+
+    void printJSONLine(Decl *D) {
+      ASTContext &Ctx = D->getASTContext();
+      JSONDumper P(Out, Ctx.getSourceManager(), Ctx, Ctx.getPrintingPolicy(),
+                   &Ctx.getCommentCommandTraits(), /*Indent=*/0);
+      P.Visit(D);
+      Out << '\n';
+    }
+
     std::string getName(Decl *D) {
       if (isa<NamedDecl>(D))
         return cast<NamedDecl>(D)->getQualifiedNameAsString();
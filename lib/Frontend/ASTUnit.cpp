@@ -70,6 +70,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
@@ -78,6 +79,7 @@
 #include "llvm/Bitstream/BitstreamWriter.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/Chrono.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -1735,14 +1737,25 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
     bool AllowPCHWithCompilerErrors, SkipFunctionBodiesScope SkipFunctionBodies,
     bool SingleFileParse, bool UserFilesAreVolatile, bool ForSerialization,
     llvm::Optional<StringRef> ModuleFormat, std::unique_ptr<ASTUnit> *ErrAST,
-    IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS) {
+    IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS,
+    std::shared_ptr<CompilerInvocation> *PooledInvocation,
+    SmallVectorImpl<StoredDiagnostic> *PooledDriverDiags) {
   assert(Diags.get() && "no DiagnosticsEngine was provided");
 
   SmallVector<StoredDiagnostic, 4> StoredDiagnostics;
 
   std::shared_ptr<CompilerInvocation> CI;
 
-  {
+  if (PooledInvocation && *PooledInvocation) {
+    // The pool slot carries the result of resolving an identical command
+    // line earlier; the caller passes a copy it is willing to have adjusted
+    // below and during parsing. Replay the diagnostics the driver emitted
+    // when the command line was first resolved.
+    CI = *PooledInvocation;
+    if (PooledDriverDiags)
+      StoredDiagnostics.append(PooledDriverDiags->begin(),
+                               PooledDriverDiags->end());
+  } else {
     CaptureDroppedDiagnostics Capture(CaptureDiagnostics, *Diags,
                                       &StoredDiagnostics, nullptr);
 
@@ -1750,6 +1763,12 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
         llvm::makeArrayRef(ArgBegin, ArgEnd), Diags, VFS);
     if (!CI)
       return nullptr;
+    if (PooledInvocation) {
+      *PooledInvocation = std::make_shared<CompilerInvocation>(*CI);
+      if (PooledDriverDiags)
+        PooledDriverDiags->assign(StoredDiagnostics.begin(),
+                                  StoredDiagnostics.end());
+    }
   }
 
   // Override any files that need remapping
@@ -1818,6 +1837,68 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
   return AST.release();
 }
 
+/// Compute a hash over the names and contents of the given unsaved file
+/// buffers, to detect whether they changed between two reparses.
+static uint64_t hashUnsavedBuffers(ArrayRef<ASTUnit::RemappedFile> Buffers) {
+  llvm::hash_code Hash = llvm::hash_value(Buffers.size());
+  for (const auto &RemappedFile : Buffers)
+    Hash = llvm::hash_combine(Hash, llvm::hash_value(RemappedFile.first),
+                              llvm::hash_value(RemappedFile.second->getBuffer()));
+  return Hash;
+}
+
+bool ASTUnit::isReparseInputUnchanged(ArrayRef<RemappedFile> RemappedFiles,
+                                      llvm::vfs::FileSystem &VFS) const {
+  // A usable snapshot requires an intact AST from a successful parse.
+  if (LastParseInputStats.empty() || !TheSema || !Ctx)
+    return false;
+
+  if (hashUnsavedBuffers(RemappedFiles) != LastParseUnsavedBuffersHash)
+    return false;
+
+  llvm::StringSet<> RemappedNames;
+  for (const auto &RemappedFile : RemappedFiles)
+    RemappedNames.insert(RemappedFile.first);
+
+  for (const auto &Entry : LastParseInputStats) {
+    // Files overridden by an unsaved buffer are covered by the hash above.
+    if (RemappedNames.count(Entry.getKey()))
+      continue;
+    llvm::ErrorOr<llvm::vfs::Status> Status = VFS.status(Entry.getKey());
+    if (!Status ||
+        Status->getSize() != Entry.getValue().first ||
+        llvm::sys::toTimeT(Status->getLastModificationTime()) !=
+            Entry.getValue().second)
+      return false;
+  }
+
+  return true;
+}
+
+void ASTUnit::captureReparseInputSnapshot(
+    ArrayRef<RemappedFile> RemappedFiles) {
+  LastParseInputStats.clear();
+  LastParseUnsavedBuffersHash = hashUnsavedBuffers(RemappedFiles);
+  if (!SourceMgr)
+    return;
+
+  llvm::StringSet<> RemappedNames;
+  for (const auto &RemappedFile : RemappedFiles)
+    RemappedNames.insert(RemappedFile.first);
+
+  // Record the stat values of every on-disk file the parse read; a change in
+  // any of them invalidates the snapshot.
+  for (auto I = SourceMgr->fileinfo_begin(), E = SourceMgr->fileinfo_end();
+       I != E; ++I) {
+    const FileEntry *File = I->first;
+    if (!File || RemappedNames.count(File->getName()))
+      continue;
+    LastParseInputStats[File->getName()] =
+        std::make_pair(static_cast<uint64_t>(File->getSize()),
+                       static_cast<int64_t>(File->getModificationTime()));
+  }
+}
+
 bool ASTUnit::Reparse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
                       ArrayRef<RemappedFile> RemappedFiles,
                       IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS) {
@@ -1829,6 +1910,19 @@ bool ASTUnit::Reparse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
     VFS = &FileMgr->getVirtualFileSystem();
   }
 
+  // If no input changed since the last successful parse - neither the
+  // unsaved buffers nor any on-disk file the parse read - the current AST is
+  // already up to date and re-parsing can be skipped entirely. Editors
+  // commonly trigger such reparses, e.g. when a file is saved without
+  // further edits.
+  if (isReparseInputUnchanged(RemappedFiles, *VFS)) {
+    // The unsaved buffers of this call are identical in content to the
+    // installed ones, and ownership of them ends here.
+    for (const auto &RemappedFile : RemappedFiles)
+      delete RemappedFile.second;
+    return false;
+  }
+
   clearFileLevelDecls();
 
   SimpleTimer ParsingTimer(WantTiming);
@@ -1863,6 +1957,13 @@ bool ASTUnit::Reparse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
   bool Result =
       Parse(std::move(PCHContainerOps), std::move(OverrideMainBuffer), VFS);
 
+  // Remember the inputs of a successful parse so that an identical reparse
+  // can be skipped; a failed parse must not leave a stale snapshot behind.
+  if (!Result)
+    captureReparseInputSnapshot(RemappedFiles);
+  else
+    LastParseInputStats.clear();
+
   // If we're caching global code-completion results, and the top-level
   // declarations have changed, clear out the code-completion cache.
   if (!Result && ShouldCacheCodeCompletionResults &&
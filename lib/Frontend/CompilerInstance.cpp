@@ -35,7 +35,9 @@
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
 #include "clang/Serialization/InMemoryModuleCache.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/BuryPointer.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/Errc.h"
@@ -49,8 +51,12 @@
 #include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <sys/stat.h>
 #include <system_error>
+#include <thread>
 #include <time.h>
 #include <utility>
 
@@ -1223,6 +1229,113 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
   return Result;
 }
 
+namespace {
+
+/// Serializes implicit module builds among the threads of this process and
+/// wakes waiters the moment a build completes. Threaded clients that share a
+/// module cache (e.g. several ASTUnits) otherwise all take the lock-file
+/// path below and sleep through its coarse backoff even though the builder
+/// sits in the same address space.
+class InProcessModuleBuildCoordinator {
+  std::mutex Mu;
+  std::condition_variable FinishedABuild;
+
+  /// Module files some thread of this process is currently building.
+  llvm::StringSet<> Building;
+
+public:
+  static InProcessModuleBuildCoordinator &get() {
+    static InProcessModuleBuildCoordinator Coordinator;
+    return Coordinator;
+  }
+
+  /// Claims the build of the given module file for the calling thread and
+  /// returns true. If another thread already owns it, blocks until that
+  /// thread is done and returns false; the result of the attempt, good or
+  /// bad, is then sitting in the module cache.
+  bool claimOrWait(StringRef ModuleFileName) {
+    std::unique_lock<std::mutex> Lock(Mu);
+    if (Building.insert(ModuleFileName).second)
+      return true;
+    FinishedABuild.wait(
+        Lock, [&] { return Building.count(ModuleFileName) == 0; });
+    return false;
+  }
+
+  /// Releases a build claimed with claimOrWait and wakes the waiters.
+  void release(StringRef ModuleFileName) {
+    {
+      std::lock_guard<std::mutex> Lock(Mu);
+      Building.erase(ModuleFileName);
+    }
+    FinishedABuild.notify_all();
+  }
+};
+
+} // end anonymous namespace
+
+/// Waits for another process to finish building the given module file.
+///
+/// LockFileManager::waitForUnlock backs off exponentially to sleeps of tens
+/// of seconds, so a process that joins late can idle long after the build
+/// finished. The module file is renamed into the cache atomically once it is
+/// complete, so waiting for it directly with a tightly capped poll interval
+/// picks the result up almost immediately; readers never observe a partially
+/// written file. The owner recorded in the lock file is probed for liveness
+/// about once a second, so a crashed builder is reported as Res_OwnerDied on
+/// the next poll instead of stalling every waiter until the timeout.
+static llvm::LockFileManager::WaitForUnlockResult
+waitForModuleBuild(StringRef ModuleFileName) {
+  // The name LockFileManager derives from the protected file.
+  SmallString<128> LockFileName(ModuleFileName);
+  LockFileName += ".lock";
+
+  // An implicit rebuild of an out-of-date module leaves the old file in
+  // place until the new one is renamed over it, so bare existence of the
+  // module file is not a completion signal; remember what is there now.
+  llvm::sys::fs::file_status InitialStatus;
+  bool HadModuleFile = !llvm::sys::fs::status(ModuleFileName, InitialStatus);
+
+  const unsigned long MaxWaitMS = 100;
+  const unsigned long TimeoutMS = 5 * 60 * 1000;
+  const unsigned long OwnerProbeIntervalMS = 1000;
+  unsigned long WaitMS = 1;
+  // The caller's own LockFileManager found the owner alive just before
+  // calling, so the first probe can wait a full interval.
+  unsigned long NextOwnerProbeMS = OwnerProbeIntervalMS;
+  for (unsigned long ElapsedMS = 0; ElapsedMS < TimeoutMS;
+       ElapsedMS += WaitMS, WaitMS = std::min(WaitMS * 2, MaxWaitMS)) {
+    // The builder removes the lock once the result was renamed into place,
+    // whether the build succeeded or not.
+    if (!llvm::sys::fs::exists(LockFileName))
+      return llvm::sys::fs::exists(ModuleFileName)
+                 ? llvm::LockFileManager::Res_Success
+                 : llvm::LockFileManager::Res_OwnerDied;
+
+    llvm::sys::fs::file_status Status;
+    if (!llvm::sys::fs::status(ModuleFileName, Status) &&
+        (!HadModuleFile || Status.getLastModificationTime() !=
+                               InitialStatus.getLastModificationTime()))
+      return llvm::LockFileManager::Res_Success;
+
+    // A crashed builder leaves its lock behind; probe the owner it recorded
+    // so the death is noticed on the next poll rather than at the timeout.
+    // Constructing a LockFileManager runs its owner liveness check: a live
+    // owner reads back as LFS_Shared, while a dead one has its stale lock
+    // cleaned up and the probe briefly takes the lock itself, releasing it
+    // again on destruction so the caller can retry for ownership.
+    if (ElapsedMS >= NextOwnerProbeMS) {
+      NextOwnerProbeMS = ElapsedMS + OwnerProbeIntervalMS;
+      llvm::LockFileManager Probe(ModuleFileName);
+      if (Probe.getState() != llvm::LockFileManager::LFS_Shared)
+        return llvm::LockFileManager::Res_OwnerDied;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(WaitMS));
+  }
+  return llvm::LockFileManager::Res_Timeout;
+}
+
 static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
                                  SourceLocation ImportLoc,
                                  SourceLocation ModuleNameLoc, Module *Module,
@@ -1241,46 +1354,62 @@ static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
 
   while (1) {
     unsigned ModuleLoadCapabilities = ASTReader::ARR_Missing;
-    llvm::LockFileManager Locked(ModuleFileName);
-    switch (Locked) {
-    case llvm::LockFileManager::LFS_Error:
-      // ModuleCache takes care of correctness and locks are only necessary for
-      // performance. Fallback to building the module in case of any lock
-      // related errors.
-      Diags.Report(ModuleNameLoc, diag::remark_module_lock_failure)
-          << Module->Name << Locked.getErrorMessage();
-      // Clear out any potential leftover.
-      Locked.unsafeRemoveLockFile();
-      LLVM_FALLTHROUGH;
-    case llvm::LockFileManager::LFS_Owned:
-      // We're responsible for building the module ourselves.
-      if (!compileModuleImpl(ImportingInstance, ModuleNameLoc, Module,
-                             ModuleFileName)) {
-        diagnoseBuildFailure();
-        return false;
-      }
-      break;
+    // Whether someone else, thread or process, performed the build; an
+    // out-of-date read result is then retried instead of trusted.
+    bool BuiltElsewhere = false;
+
+    InProcessModuleBuildCoordinator &Coordinator =
+        InProcessModuleBuildCoordinator::get();
+    if (!Coordinator.claimOrWait(ModuleFileName)) {
+      // Another thread of this process just finished its build attempt; read
+      // whatever it left in the module cache.
+      BuiltElsewhere = true;
+      ModuleLoadCapabilities |= ASTReader::ARR_OutOfDate;
+    } else {
+      auto Release = llvm::make_scope_exit(
+          [&Coordinator, ModuleFileName] { Coordinator.release(ModuleFileName); });
+      llvm::LockFileManager Locked(ModuleFileName);
+      switch (Locked) {
+      case llvm::LockFileManager::LFS_Error:
+        // ModuleCache takes care of correctness and locks are only necessary
+        // for performance. Fallback to building the module in case of any lock
+        // related errors.
+        Diags.Report(ModuleNameLoc, diag::remark_module_lock_failure)
+            << Module->Name << Locked.getErrorMessage();
+        // Clear out any potential leftover.
+        Locked.unsafeRemoveLockFile();
+        LLVM_FALLTHROUGH;
+      case llvm::LockFileManager::LFS_Owned:
+        // We're responsible for building the module ourselves.
+        if (!compileModuleImpl(ImportingInstance, ModuleNameLoc, Module,
+                               ModuleFileName)) {
+          diagnoseBuildFailure();
+          return false;
+        }
+        break;
 
-    case llvm::LockFileManager::LFS_Shared:
-      // Someone else is responsible for building the module. Wait for them to
-      // finish.
-      switch (Locked.waitForUnlock()) {
-      case llvm::LockFileManager::Res_Success:
-        ModuleLoadCapabilities |= ASTReader::ARR_OutOfDate;
+      case llvm::LockFileManager::LFS_Shared:
+        // Another process is responsible for building the module. Wait for it
+        // to finish.
+        BuiltElsewhere = true;
+        switch (waitForModuleBuild(ModuleFileName)) {
+        case llvm::LockFileManager::Res_Success:
+          ModuleLoadCapabilities |= ASTReader::ARR_OutOfDate;
+          break;
+        case llvm::LockFileManager::Res_OwnerDied:
+          continue; // try again to get the lock.
+        case llvm::LockFileManager::Res_Timeout:
+          // Since ModuleCache takes care of correctness, we try waiting for
+          // another process to complete the build so clang does not do it done
+          // twice. If case of timeout, build it ourselves.
+          Diags.Report(ModuleNameLoc, diag::remark_module_lock_timeout)
+              << Module->Name;
+          // Clear the lock file so that future invocations can make progress.
+          Locked.unsafeRemoveLockFile();
+          continue;
+        }
         break;
-      case llvm::LockFileManager::Res_OwnerDied:
-        continue; // try again to get the lock.
-      case llvm::LockFileManager::Res_Timeout:
-        // Since ModuleCache takes care of correctness, we try waiting for
-        // another process to complete the build so clang does not do it done
-        // twice. If case of timeout, build it ourselves.
-        Diags.Report(ModuleNameLoc, diag::remark_module_lock_timeout)
-            << Module->Name;
-        // Clear the lock file so that future invocations can make progress.
-        Locked.unsafeRemoveLockFile();
-        continue;
       }
-      break;
     }
 
     // Try to read the module file, now that we've compiled it.
@@ -1289,8 +1418,7 @@ static bool compileAndLoadModule(CompilerInstance &ImportingInstance,
             ModuleFileName, serialization::MK_ImplicitModule, ImportLoc,
             ModuleLoadCapabilities);
 
-    if (ReadResult == ASTReader::OutOfDate &&
-        Locked == llvm::LockFileManager::LFS_Shared) {
+    if (ReadResult == ASTReader::OutOfDate && BuiltElsewhere) {
       // The module may be out of date in the presence of file system races,
       // or if one of its imports depends on header search paths that are not
       // consistent with this ImportingInstance.  Try again...
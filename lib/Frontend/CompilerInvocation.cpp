@@ -66,11 +66,13 @@
 #include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
@@ -201,6 +203,155 @@ static void getAllNoBuiltinFuncValues(ArgList &Args,
   Funcs.insert(Funcs.end(), Values.begin(), Values.end());
 }
 
+// The analyzer configuration cache (-analyzer-config-cache) snapshots the
+// fully parsed and validated checker list and config table, so that later
+// invocations with an identical configuration can load them back instead of
+// reparsing and revalidating per process. The format is a simple binary
+// blob: a magic number, a format version, a hash of the inputs the
+// configuration was built from, and length-prefixed strings.
+
+static const char AnalyzerConfigCacheMagic[] = "ACFG";
+enum { AnalyzerConfigCacheVersion = 1 };
+
+/// Hash everything the cached configuration is derived from: the compiler
+/// version and the analyzer configuration arguments, in command-line order.
+static llvm::MD5::MD5Result computeAnalyzerConfigKey(const ArgList &Args) {
+  llvm::MD5 Hash;
+  Hash.update(getClangFullVersion());
+  for (const Arg *A :
+       Args.filtered(OPT_analyzer_checker, OPT_analyzer_disable_checker,
+                     OPT_analyzer_config)) {
+    Hash.update(A->getSpelling());
+    Hash.update(StringRef("\0", 1));
+    Hash.update(A->getValue());
+    Hash.update(StringRef("\0", 1));
+  }
+  Hash.update(Args.getLastArgValue(OPT_analyzer_config_compatibility_mode));
+  llvm::MD5::MD5Result Key;
+  Hash.final(Key);
+  return Key;
+}
+
+static void writeAnalyzerConfigCache(StringRef Path,
+                                     const llvm::MD5::MD5Result &Key,
+                                     const AnalyzerOptions &Opts,
+                                     DiagnosticsEngine &Diags) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    Diags.Report(diag::warn_analyzer_config_cache_write)
+        << Path << EC.message();
+    return;
+  }
+
+  auto EmitU32 = [&OS](uint32_t V) {
+    char Buf[4];
+    llvm::support::endian::write32le(Buf, V);
+    OS.write(Buf, sizeof(Buf));
+  };
+  auto EmitString = [&OS, &EmitU32](StringRef S) {
+    EmitU32(S.size());
+    OS << S;
+  };
+
+  OS.write(AnalyzerConfigCacheMagic, 4);
+  EmitU32(AnalyzerConfigCacheVersion);
+  OS.write(reinterpret_cast<const char *>(Key.Bytes.data()), Key.Bytes.size());
+
+  EmitU32(Opts.CheckersControlList.size());
+  for (const std::pair<std::string, bool> &Opt : Opts.CheckersControlList) {
+    EmitU32(Opt.second);
+    EmitString(Opt.first);
+  }
+
+  // Sort the entries so that the cache file is deterministic.
+  SmallVector<std::pair<StringRef, StringRef>, 64> ConfigEntries;
+  for (const auto &Entry : Opts.Config)
+    ConfigEntries.push_back({Entry.getKey(), Entry.getValue()});
+  llvm::sort(ConfigEntries);
+
+  EmitU32(ConfigEntries.size());
+  for (const std::pair<StringRef, StringRef> &Entry : ConfigEntries) {
+    EmitString(Entry.first);
+    EmitString(Entry.second);
+  }
+}
+
+/// Load the configuration cache if it matches \p Key. Returns false on any
+/// mismatch or malformation, in which case the caller parses the command
+/// line as usual (and rewrites the cache).
+static bool loadAnalyzerConfigCache(StringRef Path,
+                                    const llvm::MD5::MD5Result &Key,
+                                    AnalyzerOptions &Opts) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return false;
+  StringRef Data = (*Buffer)->getBuffer();
+
+  auto ReadU32 = [&Data](uint32_t &V) {
+    if (Data.size() < 4)
+      return false;
+    V = llvm::support::endian::read32le(Data.data());
+    Data = Data.drop_front(4);
+    return true;
+  };
+  auto ReadString = [&Data, &ReadU32](StringRef &S) {
+    uint32_t Length;
+    if (!ReadU32(Length) || Data.size() < Length)
+      return false;
+    S = Data.take_front(Length);
+    Data = Data.drop_front(Length);
+    return true;
+  };
+
+  if (!Data.startswith(AnalyzerConfigCacheMagic))
+    return false;
+  Data = Data.drop_front(4);
+
+  uint32_t Version;
+  if (!ReadU32(Version) || Version != AnalyzerConfigCacheVersion)
+    return false;
+
+  if (Data.size() < Key.Bytes.size() ||
+      !std::equal(Key.Bytes.begin(), Key.Bytes.end(),
+                  reinterpret_cast<const uint8_t *>(Data.data())))
+    return false;
+  Data = Data.drop_front(Key.Bytes.size());
+
+  uint32_t NumCheckers;
+  if (!ReadU32(NumCheckers))
+    return false;
+  std::vector<std::pair<std::string, bool>> Checkers;
+  for (uint32_t I = 0; I < NumCheckers; ++I) {
+    uint32_t Enable;
+    StringRef Name;
+    if (!ReadU32(Enable) || !ReadString(Name))
+      return false;
+    Checkers.emplace_back(Name, Enable != 0);
+  }
+
+  uint32_t NumConfigs;
+  if (!ReadU32(NumConfigs))
+    return false;
+  SmallVector<std::pair<StringRef, StringRef>, 64> ConfigEntries;
+  for (uint32_t I = 0; I < NumConfigs; ++I) {
+    StringRef ConfigKey, Value;
+    if (!ReadString(ConfigKey) || !ReadString(Value))
+      return false;
+    ConfigEntries.push_back({ConfigKey, Value});
+  }
+
+  if (!Data.empty())
+    return false;
+
+  Opts.CheckersControlList = std::move(Checkers);
+  for (const std::pair<StringRef, StringRef> &Entry : ConfigEntries)
+    Opts.Config[Entry.first] = Entry.second;
+  Opts.HasPrevalidatedConfig = true;
+  return true;
+}
+
 static bool ParseAnalyzerArgs(AnalyzerOptions &Opts, ArgList &Args,
                               DiagnosticsEngine &Diags) {
   bool Success = true;
@@ -324,6 +475,34 @@ static bool ParseAnalyzerArgs(AnalyzerOptions &Opts, ArgList &Args,
       getLastArgIntValue(Args, OPT_analyzer_inline_max_stack_depth,
                          Opts.InlineMaxStackDepth, Diags);
 
+  // If a configuration cache file is given and it matches this invocation's
+  // analyzer arguments, load the checker list and config table from it and
+  // skip the parsing and validation below; the invocation that wrote the
+  // cache already performed both.
+  llvm::raw_string_ostream os(Opts.FullCompilerInvocation);
+  for (unsigned i = 0; i < Args.getNumInputArgStrings(); ++i) {
+    if (i != 0)
+      os << " ";
+    os << Args.getArgString(i);
+  }
+  os.flush();
+
+  StringRef ConfigCachePath = Args.getLastArgValue(OPT_analyzer_config_cache);
+  llvm::MD5::MD5Result ConfigCacheKey;
+  if (!ConfigCachePath.empty()) {
+    ConfigCacheKey = computeAnalyzerConfigKey(Args);
+    if (loadAnalyzerConfigCache(ConfigCachePath, ConfigCacheKey, Opts)) {
+      for (const Arg *A :
+           Args.filtered(OPT_analyzer_checker, OPT_analyzer_disable_checker,
+                         OPT_analyzer_config))
+        A->claim();
+      // The cached values were already validated, so there is nothing to
+      // diagnose; only bind the config table to the option fields.
+      parseAnalyzerConfigs(Opts, nullptr);
+      return Success;
+    }
+  }
+
   Opts.CheckersControlList.clear();
   for (const Arg *A :
        Args.filtered(OPT_analyzer_checker, OPT_analyzer_disable_checker)) {
@@ -381,13 +560,10 @@ static bool ParseAnalyzerArgs(AnalyzerOptions &Opts, ArgList &Args,
   else
     parseAnalyzerConfigs(Opts, nullptr);
 
-  llvm::raw_string_ostream os(Opts.FullCompilerInvocation);
-  for (unsigned i = 0; i < Args.getNumInputArgStrings(); ++i) {
-    if (i != 0)
-      os << " ";
-    os << Args.getArgString(i);
-  }
-  os.flush();
+  // parseAnalyzerConfigs() filled in the defaults, so the table written here
+  // is complete and a later invocation loading it needs no revalidation.
+  if (!ConfigCachePath.empty() && Success)
+    writeAnalyzerConfigCache(ConfigCachePath, ConfigCacheKey, Opts, Diags);
 
   return Success;
 }
@@ -1562,9 +1738,13 @@ bool clang::ParseDiagnosticArgs(DiagnosticOptions &Opts, ArgList &Args,
   Opts.SpellCheckingLimit = getLastArgIntValue(
       Args, OPT_fspell_checking_limit,
       DiagnosticOptions::DefaultSpellCheckingLimit, Diags);
+  Opts.SpellCheckingBudget =
+      getLastArgIntValue(Args, OPT_fspell_checking_budget, 0, Diags);
   Opts.SnippetLineLimit = getLastArgIntValue(
       Args, OPT_fcaret_diagnostics_max_lines,
       DiagnosticOptions::DefaultSnippetLineLimit, Diags);
+  Opts.SnippetCountLimit =
+      getLastArgIntValue(Args, OPT_fcaret_diagnostics_max_count, 0, Diags);
   Opts.TabStop = getLastArgIntValue(Args, OPT_ftabstop,
                                     DiagnosticOptions::DefaultTabStop, Diags);
   if (Opts.TabStop == 0 || Opts.TabStop > DiagnosticOptions::MaxTabStop) {
@@ -1623,6 +1803,7 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       unsigned Val = llvm::StringSwitch<unsigned>(A->getValue())
                          .CaseLower("default", ADOF_Default)
                          .CaseLower("json", ADOF_JSON)
+                         .CaseLower("json-lines", ADOF_JSONLines)
                          .Default(std::numeric_limits<unsigned>::max());
 
       if (Val != std::numeric_limits<unsigned>::max())
@@ -1784,6 +1965,7 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.ASTDumpAll = Args.hasArg(OPT_ast_dump_all, OPT_ast_dump_all_EQ);
   Opts.ASTDumpFilter = Args.getLastArgValue(OPT_ast_dump_filter);
   Opts.ASTDumpLookups = Args.hasArg(OPT_ast_dump_lookups);
+  Opts.VerifyPCHFull = Args.hasArg(OPT_verify_pch_full);
   Opts.UseGlobalModuleIndex = !Args.hasArg(OPT_fno_modules_global_index);
   Opts.GenerateGlobalModuleIndex = Opts.UseGlobalModuleIndex;
   Opts.ModuleMapFiles = Args.getAllArgValues(OPT_fmodule_map_file);
@@ -1796,6 +1978,7 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.ModulesEmbedFiles = Args.getAllArgValues(OPT_fmodules_embed_file_EQ);
   Opts.ModulesEmbedAllFiles = Args.hasArg(OPT_fmodules_embed_all_files);
   Opts.IncludeTimestamps = !Args.hasArg(OPT_fno_pch_timestamp);
+  Opts.PCHCacheDir = Args.getLastArgValue(OPT_pch_cache_dir);
 
   Opts.CodeCompleteOpts.IncludeMacros
     = Args.hasArg(OPT_code_completion_macros);
@@ -1814,6 +1997,8 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     = Args.getLastArgValue(OPT_foverride_record_layout_EQ);
   Opts.AuxTriple = Args.getLastArgValue(OPT_aux_triple);
   Opts.StatsFile = Args.getLastArgValue(OPT_stats_file);
+  Opts.ExtDefMapOutput = Args.getLastArgValue(OPT_femit_extdef_mapping_EQ);
+  Opts.ASTMemoryProfileOutput = Args.getLastArgValue(OPT_ast_memory_profile);
 
   if (const Arg *A = Args.getLastArg(OPT_arcmt_check,
                                      OPT_arcmt_modify,
@@ -2007,6 +2192,8 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args,
       getLastArgIntValue(Args, OPT_fmodules_prune_after, 31 * 24 * 60 * 60);
   Opts.ModulesValidateOncePerBuildSession =
       Args.hasArg(OPT_fmodules_validate_once_per_build_session);
+  Opts.PCHValidateOncePerBuildSession =
+      Args.hasArg(OPT_fpch_validate_once_per_build_session);
   Opts.BuildSessionTimestamp =
       getLastArgUInt64Value(Args, OPT_fbuild_session_timestamp, 0);
   Opts.ModulesValidateSystemHeaders =
@@ -3271,6 +3458,7 @@ static void ParsePreprocessorOutputArgs(PreprocessorOutputOptions &Opts,
   Opts.RewriteIncludes = Args.hasArg(OPT_frewrite_includes);
   Opts.RewriteImports = Args.hasArg(OPT_frewrite_imports);
   Opts.UseLineDirectives = Args.hasArg(OPT_fuse_line_directives);
+  Opts.CachePath = Args.getLastArgValue(OPT_preprocessed_output_cache);
 }
 
 static void ParseTargetArgs(TargetOptions &Opts, ArgList &Args,
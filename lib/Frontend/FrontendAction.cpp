@@ -966,6 +966,19 @@ void FrontendAction::EndSourceFile() {
   // Finalize the action.
   EndSourceFileAction();
 
+  // Emit the AST memory profile while the AST context is still alive.
+  if (!CI.getFrontendOpts().ASTMemoryProfileOutput.empty() &&
+      CI.hasASTContext()) {
+    StringRef Path = CI.getFrontendOpts().ASTMemoryProfileOutput;
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_None);
+    if (EC)
+      CI.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << Path << EC.message();
+    else
+      CI.getASTContext().printMemoryProfile(OS);
+  }
+
   // Sema references the ast consumer, so reset sema first.
   //
   // FIXME: There is more per-file stuff we could just drop here?
@@ -8,11 +8,14 @@
 
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/AST/ASTConsumer.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclObjC.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Frontend/ASTConsumers.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/MultiplexConsumer.h"
+#include "clang/Frontend/PreprocessedOutputCache.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
 #include "clang/Lex/HeaderSearch.h"
@@ -22,6 +25,8 @@
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/ASTWriter.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/YAMLTraits.h"
@@ -90,6 +95,122 @@ ASTViewAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
   return CreateASTViewer();
 }
 
+namespace {
+
+/// Records every file a PCH build reads, including system headers: a cached
+/// PCH is only reusable when none of them changed.
+class PCHCacheDependencyCollector : public DependencyCollector {
+  bool needSystemDependencies() override { return true; }
+};
+
+} // namespace
+
+/// Returns the hex MD5 of the content of \p Path, or None if the file is not
+/// readable.
+static Optional<SmallString<32>> getFileContentHash(const Twine &Path) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return None;
+  llvm::MD5 Hash;
+  llvm::MD5::MD5Result Result;
+  Hash.update((*Buffer)->getBuffer());
+  Hash.final(Result);
+  return Result.digest();
+}
+
+/// Computes the cache key of the PCH built from \p MainFile: the module-level
+/// hash of the invocation combined with the content of the main file. The
+/// headers the build reads are not part of the key -- they are not known
+/// before parsing -- and are validated through the manifest stored next to
+/// the cached PCH instead. Returns an empty string when the main file cannot
+/// be read.
+static std::string computePCHCacheKey(CompilerInstance &CI,
+                                      StringRef MainFile) {
+  auto MainHash = getFileContentHash(MainFile);
+  if (!MainHash)
+    return std::string();
+  llvm::MD5 Hash;
+  llvm::MD5::MD5Result Result;
+  Hash.update(CI.getInvocation().getModuleHash());
+  Hash.update(*MainHash);
+  Hash.final(Result);
+  return Result.digest().str().str();
+}
+
+/// Returns true if the cache in \p CacheDir holds a PCH for \p Key whose
+/// recorded dependencies all still have the content they were hashed with;
+/// the cached PCH is then copied to the configured output file.
+static bool reuseCachedPCH(CompilerInstance &CI, StringRef CacheDir,
+                           StringRef Key) {
+  SmallString<128> PCHPath(CacheDir);
+  llvm::sys::path::append(PCHPath, Key + ".pch");
+  SmallString<128> ManifestPath(CacheDir);
+  llvm::sys::path::append(ManifestPath, Key + ".manifest");
+
+  auto Manifest = llvm::MemoryBuffer::getFile(ManifestPath);
+  if (!Manifest || !llvm::sys::fs::exists(PCHPath))
+    return false;
+
+  // Each manifest line is "<md5> <path>"; every recorded file must still
+  // hash to the recorded value.
+  for (llvm::line_iterator LI(**Manifest, /*SkipBlanks=*/true); !LI.is_at_end();
+       ++LI) {
+    const std::pair<StringRef, StringRef> HashAndPath = LI->split(' ');
+    auto CurrentHash = getFileContentHash(HashAndPath.second);
+    if (!CurrentHash || CurrentHash->str() != HashAndPath.first)
+      return false;
+  }
+
+  return !llvm::sys::fs::copy_file(PCHPath, CI.getFrontendOpts().OutputFile);
+}
+
+/// Publishes \p PCHFile in the cache under \p Key together with the manifest
+/// of its dependencies. Both files are renamed into place so that concurrent
+/// processes only ever observe complete entries; any failure just leaves the
+/// cache without this entry.
+static void storeCachedPCH(StringRef CacheDir, StringRef Key,
+                           StringRef PCHFile,
+                           ArrayRef<std::string> Dependencies) {
+  if (llvm::sys::fs::create_directories(CacheDir))
+    return;
+
+  std::string ManifestText;
+  llvm::raw_string_ostream ManifestOS(ManifestText);
+  for (StringRef Dep : Dependencies) {
+    auto DepHash = getFileContentHash(Dep);
+    if (!DepHash)
+      return;
+    ManifestOS << *DepHash << ' ' << Dep << '\n';
+  }
+
+  SmallString<128> PCHPath(CacheDir);
+  llvm::sys::path::append(PCHPath, Key + ".pch");
+  SmallString<128> TmpPCH;
+  if (llvm::sys::fs::createUniqueFile(PCHPath + ".tmp%%%%%%", TmpPCH))
+    return;
+  if (llvm::sys::fs::copy_file(PCHFile, TmpPCH) ||
+      llvm::sys::fs::rename(TmpPCH, PCHPath)) {
+    llvm::sys::fs::remove(TmpPCH);
+    return;
+  }
+
+  // The manifest is written after the PCH: readers require both, so a
+  // manifest must never refer to a PCH that is not in place yet.
+  SmallString<128> ManifestPath(CacheDir);
+  llvm::sys::path::append(ManifestPath, Key + ".manifest");
+  int ManifestFD;
+  SmallString<128> TmpManifest;
+  if (llvm::sys::fs::createUniqueFile(ManifestPath + ".tmp%%%%%%", ManifestFD,
+                                      TmpManifest))
+    return;
+  {
+    llvm::raw_fd_ostream OS(ManifestFD, /*shouldClose=*/true);
+    OS << ManifestOS.str();
+  }
+  if (llvm::sys::fs::rename(TmpManifest, ManifestPath))
+    llvm::sys::fs::remove(TmpManifest);
+}
+
 std::unique_ptr<ASTConsumer>
 GeneratePCHAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
   std::string Sysroot;
@@ -155,9 +276,40 @@ bool GeneratePCHAction::shouldEraseOutputFiles() {
 
 bool GeneratePCHAction::BeginSourceFileAction(CompilerInstance &CI) {
   CI.getLangOpts().CompilingPCH = true;
+
+  StringRef CacheDir = CI.getFrontendOpts().PCHCacheDir;
+  if (!CacheDir.empty() && getCurrentInput().isFile()) {
+    CacheKey = computePCHCacheKey(CI, getCurrentFile());
+    if (!CacheKey.empty()) {
+      if (reuseCachedPCH(CI, CacheDir, CacheKey))
+        // The output was copied from the cache; returning false skips the
+        // whole build without raising an error.
+        return false;
+      CacheDepCollector = std::make_shared<PCHCacheDependencyCollector>();
+      CacheDepCollector->attachToPreprocessor(CI.getPreprocessor());
+    }
+  }
+
   return true;
 }
 
+void GeneratePCHAction::EndSourceFile() {
+  // Capture what the cache needs before the base class finalizes the output
+  // file and detaches this action from the compiler instance.
+  CompilerInstance &CI = getCompilerInstance();
+  const std::string CacheDir = CI.getFrontendOpts().PCHCacheDir;
+  const std::string OutputFile = CI.getFrontendOpts().OutputFile;
+  const bool Usable = !CI.getDiagnostics().hasErrorOccurred() ||
+                      CI.getPreprocessorOpts().AllowPCHWithCompilerErrors;
+  std::shared_ptr<DependencyCollector> Deps = std::move(CacheDepCollector);
+
+  ASTFrontendAction::EndSourceFile();
+
+  if (Deps && Usable && !CacheKey.empty() && !CacheDir.empty() &&
+      !OutputFile.empty() && OutputFile != "-")
+    storeCachedPCH(CacheDir, CacheKey, OutputFile, Deps->getDependencies());
+}
+
 std::unique_ptr<ASTConsumer>
 GenerateModuleAction::CreateASTConsumer(CompilerInstance &CI,
                                         StringRef InFile) {
@@ -339,11 +491,32 @@ void VerifyPCHAction::ExecuteAction() {
       /*AllowConfigurationMismatch*/ true,
       /*ValidateSystemInputs*/ true));
 
-  Reader->ReadAST(getCurrentFile(),
-                  Preamble ? serialization::MK_Preamble
-                           : serialization::MK_PCH,
-                  SourceLocation(),
-                  ASTReader::ARR_ConfigurationMismatch);
+  if (Reader->ReadAST(getCurrentFile(),
+                      Preamble ? serialization::MK_Preamble
+                               : serialization::MK_PCH,
+                      SourceLocation(),
+                      ASTReader::ARR_ConfigurationMismatch) !=
+      ASTReader::Success)
+    return;
+
+  // Loading the AST only checks the control block and the dependencies; the
+  // declarations themselves stay lazy, so corruption in a declaration record
+  // would normally surface at first use rather than here. When a full
+  // verification is requested, force every declaration (and the function
+  // bodies and initializers they defer) through the reader now.
+  if (CI.getFrontendOpts().VerifyPCHFull) {
+    for (serialization::DeclID ID = serialization::NUM_PREDEF_DECL_IDS,
+                               E = ID + Reader->getTotalNumDecls();
+         ID != E && !CI.getDiagnostics().hasErrorOccurred(); ++ID) {
+      Decl *D = Reader->GetDecl(ID);
+      if (auto *FD = dyn_cast_or_null<FunctionDecl>(D))
+        FD->getBody();
+      else if (auto *MD = dyn_cast_or_null<ObjCMethodDecl>(D))
+        MD->getBody();
+      else if (auto *VD = dyn_cast_or_null<VarDecl>(D))
+        VD->getInit();
+    }
+  }
 }
 
 namespace {
@@ -765,6 +938,21 @@ void PreprocessOnlyAction::ExecuteAction() {
   } while (Tok.isNot(tok::eof));
 }
 
+namespace {
+
+/// Collects every file the preprocessor reads, including system headers, to
+/// build the manifest of a preprocessed-output cache entry.
+class PreprocessCacheDependencyCollector : public DependencyCollector {
+  bool needSystemDependencies() override { return true; }
+
+  bool sawDependency(StringRef Filename, bool FromModule, bool IsSystem,
+                     bool IsModuleFile, bool IsMissing) override {
+    return !IsMissing;
+  }
+};
+
+} // end anonymous namespace
+
 void PrintPreprocessedAction::ExecuteAction() {
   CompilerInstance &CI = getCompilerInstance();
   // Output file may need to be set to 'Binary', to avoid converting Unix style
@@ -826,6 +1014,35 @@ void PrintPreprocessedAction::ExecuteAction() {
     (*OS) << "#pragma clang module contents\n";
   }
 
+  // With a preprocessed-output cache configured, try to replay an earlier
+  // run's output, and otherwise preprocess into a buffer so the result can
+  // be recorded together with a manifest of everything that was read.
+  const std::string &CachePath = CI.getPreprocessorOutputOpts().CachePath;
+  if (!CachePath.empty() &&
+      Input.getKind().getFormat() == InputKind::Source && Input.isFile()) {
+    PreprocessedOutputCache Cache(CachePath);
+    std::string Key =
+        PreprocessedOutputCache::computeKey(CI.getInvocation(),
+                                            Input.getFile());
+    if (Cache.replay(Key, *OS))
+      return;
+
+    auto Dependencies = std::make_shared<PreprocessCacheDependencyCollector>();
+    Dependencies->attachToPreprocessor(CI.getPreprocessor());
+    // The preprocessor keeps callbacks into the collector until the source
+    // file is finished; keep the collector alive as long as the instance.
+    CI.addDependencyCollector(Dependencies);
+
+    SmallString<256> Buffer;
+    llvm::raw_svector_ostream BufferOS(Buffer);
+    DoPrintPreprocessedInput(CI.getPreprocessor(), &BufferOS,
+                             CI.getPreprocessorOutputOpts());
+    if (!CI.getDiagnostics().hasErrorOccurred())
+      Cache.store(Key, Buffer, Dependencies->getDependencies());
+    *OS << Buffer;
+    return;
+  }
+
   DoPrintPreprocessedInput(CI.getPreprocessor(), OS.get(),
                            CI.getPreprocessorOutputOpts());
 }
@@ -127,7 +127,7 @@ void TemporaryFiles::removeFile(StringRef File) {
 
 class PrecompilePreambleAction : public ASTFrontendAction {
 public:
-  PrecompilePreambleAction(std::string *InMemStorage,
+  PrecompilePreambleAction(llvm::SmallVectorImpl<char> *InMemStorage,
                            PreambleCallbacks &Callbacks)
       : InMemStorage(InMemStorage), Callbacks(Callbacks) {}
 
@@ -150,7 +150,7 @@ private:
   friend class PrecompilePreambleConsumer;
 
   bool HasEmittedPreamblePCH = false;
-  std::string *InMemStorage;
+  llvm::SmallVectorImpl<char> *InMemStorage;
   PreambleCallbacks &Callbacks;
 };
 
@@ -177,13 +177,23 @@ public:
     if (!hasEmittedPCH())
       return;
 
-    // Write the generated bitstream to "Out".
-    *Out << getPCH();
-    // Make sure it hits disk now.
-    Out->flush();
-    // Free the buffer.
-    llvm::SmallVector<char, 0> Empty;
-    getPCH() = std::move(Empty);
+    if (Action.InMemStorage) {
+      // Take the serialized AST directly from the generator's buffer instead
+      // of streaming a copy of it; preamble PCHs are routinely tens of
+      // megabytes. Re-establish the null terminator the VFS overlay relies on
+      // without giving up the buffer's capacity.
+      *Action.InMemStorage = std::move(getPCH());
+      Action.InMemStorage->push_back('\0');
+      Action.InMemStorage->pop_back();
+    } else {
+      // Write the generated bitstream to "Out".
+      *Out << getPCH();
+      // Make sure it hits disk now.
+      Out->flush();
+      // Free the buffer.
+      llvm::SmallVector<char, 0> Empty;
+      getPCH() = std::move(Empty);
+    }
 
     Action.setEmittedPreamblePCH(getWriter());
   }
@@ -200,15 +210,15 @@ PrecompilePreambleAction::CreateASTConsumer(CompilerInstance &CI,
   if (!GeneratePCHAction::ComputeASTConsumerArguments(CI, Sysroot))
     return nullptr;
 
+  // For in-memory storage the consumer moves the serialized AST out of the
+  // PCH generator's buffer and no output stream is needed.
   std::unique_ptr<llvm::raw_ostream> OS;
-  if (InMemStorage) {
-    OS = llvm::make_unique<llvm::raw_string_ostream>(*InMemStorage);
-  } else {
+  if (!InMemStorage) {
     std::string OutputFile;
     OS = GeneratePCHAction::CreateOutputFile(CI, InFile, OutputFile);
+    if (!OS)
+      return nullptr;
   }
-  if (!OS)
-    return nullptr;
 
   if (!CI.getFrontendOpts().RelocatablePCH)
     Sysroot.clear();
@@ -750,7 +760,9 @@ void PrecompiledPreamble::setupPreambleStorage(
     StringRef PCHPath = getInMemoryPreamblePath();
     PreprocessorOpts.ImplicitPCHInclude = PCHPath;
 
-    auto Buf = llvm::MemoryBuffer::getMemBuffer(Storage.asMemory().Data);
+    const InMemoryPreamble &Memory = Storage.asMemory();
+    auto Buf = llvm::MemoryBuffer::getMemBuffer(
+        StringRef(Memory.Data.data(), Memory.Data.size()));
     VFS = createVFSOverlayForPreamblePCH(PCHPath, std::move(Buf), VFS);
   }
 }
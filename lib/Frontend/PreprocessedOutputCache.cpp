@@ -0,0 +1,171 @@
+//===--- PreprocessedOutputCache.cpp - Cache for -E output ----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/PreprocessedOutputCache.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/PreprocessorOutputOptions.h"
+#include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+
+std::string PreprocessedOutputCache::computeKey(
+    const CompilerInvocation &Invocation, StringRef MainFile) {
+  llvm::MD5 Hash;
+  // The module hash covers the language, target and preprocessor options,
+  // including macro definitions.
+  Hash.update(Invocation.getModuleHash());
+  Hash.update(MainFile);
+
+  // The module hash deliberately leaves out the include search path and the
+  // files included from the command line, but they decide which file an
+  // include directive resolves to, which the manifest check cannot catch on
+  // its own.
+  const HeaderSearchOptions &HSOpts = Invocation.getHeaderSearchOpts();
+  for (const HeaderSearchOptions::Entry &E : HSOpts.UserEntries) {
+    Hash.update(E.Path);
+    uint8_t EntryFlags[] = {static_cast<uint8_t>(E.Group),
+                            static_cast<uint8_t>(E.IsFramework),
+                            static_cast<uint8_t>(E.IgnoreSysRoot)};
+    Hash.update(EntryFlags);
+  }
+  const PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  for (const std::string &Include : PPOpts.Includes)
+    Hash.update(Include);
+  for (const std::string &Include : PPOpts.MacroIncludes)
+    Hash.update(Include);
+
+  const PreprocessorOutputOptions &OutputOpts =
+      Invocation.getPreprocessorOutputOpts();
+  uint8_t OutputFlags[] = {
+      static_cast<uint8_t>(OutputOpts.ShowCPP),
+      static_cast<uint8_t>(OutputOpts.ShowComments),
+      static_cast<uint8_t>(OutputOpts.ShowLineMarkers),
+      static_cast<uint8_t>(OutputOpts.UseLineDirectives),
+      static_cast<uint8_t>(OutputOpts.ShowMacroComments),
+      static_cast<uint8_t>(OutputOpts.ShowMacros),
+      static_cast<uint8_t>(OutputOpts.ShowIncludeDirectives),
+      static_cast<uint8_t>(OutputOpts.RewriteIncludes),
+      static_cast<uint8_t>(OutputOpts.RewriteImports)};
+  Hash.update(OutputFlags);
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Str;
+  llvm::MD5::stringifyResult(Result, Str);
+  return Str.str();
+}
+
+bool PreprocessedOutputCache::hashFileContents(StringRef File,
+                                               SmallString<32> &Hex) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(File, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return false;
+
+  llvm::MD5 Hash;
+  Hash.update((*Buffer)->getBuffer());
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  Hex.clear();
+  llvm::MD5::stringifyResult(Result, Hex);
+  return true;
+}
+
+/// Write \p Contents to \p FinalPath through a temporary file, so concurrent
+/// processes filling the same cache never observe a partial entry.
+static bool writeCacheFile(StringRef FinalPath, StringRef Contents) {
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(FinalPath + ".tmp-%%%%%%%%", FD,
+                                      TempPath))
+    return false;
+
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Contents;
+    OS.flush();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return false;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, FinalPath)) {
+    llvm::sys::fs::remove(TempPath);
+    return false;
+  }
+  return true;
+}
+
+bool PreprocessedOutputCache::replay(StringRef Key, raw_ostream &OS) {
+  SmallString<128> ManifestPath(Path);
+  llvm::sys::path::append(ManifestPath, Key + ".dep");
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Manifest =
+      llvm::MemoryBuffer::getFile(ManifestPath);
+  if (!Manifest)
+    return false;
+
+  // Each manifest line is "<hash> <file>"; the entry is only usable if every
+  // file still hashes to its recorded value.
+  for (llvm::line_iterator I(**Manifest, /*SkipBlanks=*/true), E; I != E;
+       ++I) {
+    std::pair<StringRef, StringRef> Split = I->split(' ');
+    SmallString<32> Hex;
+    if (!hashFileContents(Split.second, Hex) || Split.first != Hex)
+      return false;
+  }
+
+  SmallString<128> OutputPath(Path);
+  llvm::sys::path::append(OutputPath, Key + ".out");
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Output =
+      llvm::MemoryBuffer::getFile(OutputPath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!Output)
+    return false;
+
+  OS << (*Output)->getBuffer();
+  return true;
+}
+
+void PreprocessedOutputCache::store(StringRef Key, StringRef Output,
+                                    ArrayRef<std::string> Dependencies) {
+  if (llvm::sys::fs::create_directories(Path))
+    return;
+
+  std::string Manifest;
+  llvm::raw_string_ostream ManifestOS(Manifest);
+  for (const std::string &File : Dependencies) {
+    SmallString<32> Hex;
+    // A dependency that cannot be re-read would make the entry unreplayable;
+    // do not record it at all.
+    if (!hashFileContents(File, Hex))
+      return;
+    ManifestOS << Hex << ' ' << File << '\n';
+  }
+  ManifestOS.flush();
+
+  // Write the output before the manifest: replay() keys off the manifest, so
+  // an entry only becomes visible once its output is complete.
+  SmallString<128> OutputPath(Path);
+  llvm::sys::path::append(OutputPath, Key + ".out");
+  if (!writeCacheFile(OutputPath, Output))
+    return;
+
+  SmallString<128> ManifestPath(Path);
+  llvm::sys::path::append(ManifestPath, Key + ".dep");
+  writeCacheFile(ManifestPath, Manifest);
+}
@@ -12,6 +12,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Lex/Lexer.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/ConvertUTF.h"
@@ -250,7 +251,10 @@ static void columnToByte(StringRef SourceLine, unsigned TabStop,
   out.back() = i;
 }
 
-namespace {
+namespace clang {
+/// Declared in TextDiagnostic.h rather than an anonymous namespace:
+/// TextDiagnostic caches the map of the most recently rendered line across
+/// diagnostics.
 struct SourceColumnMap {
   SourceColumnMap(StringRef SourceLine, unsigned TabStop)
   : m_SourceLine(SourceLine) {
@@ -314,7 +318,7 @@ private:
   SmallVector<int,200> m_byteToColumn;
   SmallVector<int,200> m_columnToByte;
 };
-} // end anonymous namespace
+} // end namespace clang
 
 /// When the source code line we want to print is too long for
 /// the terminal, select the "interesting" region.
@@ -1152,6 +1156,13 @@ void TextDiagnostic::emitSnippetAndCaret(
       (LastLevel != DiagnosticsEngine::Note || Level == LastLevel))
     return;
 
+  // Bound the total snippet work under -fcaret-diagnostics-max-count;
+  // diagnostics past the cap still show their location line.
+  if (DiagOpts->SnippetCountLimit &&
+      NumSnippetsEmitted >= DiagOpts->SnippetCountLimit)
+    return;
+  ++NumSnippetsEmitted;
+
   // Decompose the location into a FID/Offset pair.
   std::pair<FileID, unsigned> LocInfo = Loc.getDecomposedLoc();
   FileID FID = LocInfo.first;
@@ -1181,37 +1192,59 @@ void TextDiagnostic::emitSnippetAndCaret(
       Lines = maybeAddRange(Lines, *OptionalRange, MaxLines);
 
   for (unsigned LineNo = Lines.first; LineNo != Lines.second + 1; ++LineNo) {
-    const char *BufStart = BufData.data();
-    const char *BufEnd = BufStart + BufData.size();
-
-    // Rewind from the current position to the start of the line.
-    const char *LineStart =
-        BufStart +
-        SM.getDecomposedLoc(SM.translateLineCol(FID, LineNo, 1)).second;
-    if (LineStart == BufEnd)
-      break;
-
-    // Compute the line end.
-    const char *LineEnd = LineStart;
-    while (*LineEnd != '\n' && *LineEnd != '\r' && LineEnd != BufEnd)
-      ++LineEnd;
+    // The extracted line and its byte-to-column map depend only on the
+    // buffer and the line number, so reuse the ones from the previous
+    // diagnostic when it pointed into the same line.
+    const SourceColumnMap *ColMap = nullptr;
+    llvm::Optional<SourceColumnMap> UncachedColMap;
+    if (CachedColMap && FID == CachedLineFID && LineNo == CachedLineNo) {
+      ColMap = CachedColMap.get();
+    } else {
+      const char *BufStart = BufData.data();
+      const char *BufEnd = BufStart + BufData.size();
+
+      // Rewind from the current position to the start of the line.
+      const char *LineStart =
+          BufStart +
+          SM.getDecomposedLoc(SM.translateLineCol(FID, LineNo, 1)).second;
+      if (LineStart == BufEnd)
+        break;
 
-    // Arbitrarily stop showing snippets when the line is too long.
-    // FIXME: Don't print any lines in this case.
-    if (size_t(LineEnd - LineStart) > MaxLineLengthToPrint)
-      return;
+      // Compute the line end.
+      const char *LineEnd = LineStart;
+      while (*LineEnd != '\n' && *LineEnd != '\r' && LineEnd != BufEnd)
+        ++LineEnd;
+
+      // Arbitrarily stop showing snippets when the line is too long.
+      // FIXME: Don't print any lines in this case.
+      if (size_t(LineEnd - LineStart) > MaxLineLengthToPrint)
+        return;
+
+      // Trim trailing null-bytes.
+      StringRef Line(LineStart, LineEnd - LineStart);
+      bool TrimmedAroundCaret = false;
+      while (!Line.empty() && Line.back() == '\0' &&
+             (LineNo != CaretLineNo || Line.size() > CaretColNo)) {
+        Line = Line.drop_back();
+        TrimmedAroundCaret = true;
+      }
 
-    // Trim trailing null-bytes.
-    StringRef Line(LineStart, LineEnd - LineStart);
-    while (!Line.empty() && Line.back() == '\0' &&
-           (LineNo != CaretLineNo || Line.size() > CaretColNo))
-      Line = Line.drop_back();
+      // Build the byte to column map. A line trimmed above depends on the
+      // caret position and is not cached.
+      if (TrimmedAroundCaret) {
+        UncachedColMap.emplace(Line, DiagOpts->TabStop);
+        ColMap = UncachedColMap.getPointer();
+      } else {
+        CachedColMap.reset(new SourceColumnMap(Line, DiagOpts->TabStop));
+        CachedLineFID = FID;
+        CachedLineNo = LineNo;
+        ColMap = CachedColMap.get();
+      }
+    }
+    const SourceColumnMap &sourceColMap = *ColMap;
 
     // Copy the line of code into an std::string for ease of manipulation.
-    std::string SourceLine(Line.begin(), Line.end());
-
-    // Build the byte to column map.
-    const SourceColumnMap sourceColMap(SourceLine, DiagOpts->TabStop);
+    std::string SourceLine = sourceColMap.getSourceLine().str();
 
     // Create a line for the caret that is filled with spaces that is the same
     // number of columns as the line of source code.
@@ -14,6 +14,7 @@
 #include "clang/ARCMigrate/ARCMTActions.h"
 #include "clang/CodeGen/CodeGenAction.h"
 #include "clang/Config/config.h"
+#include "clang/CrossTU/ExtDefMapGen.h"
 #include "clang/Driver/Options.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
@@ -181,6 +182,12 @@ CreateFrontendAction(CompilerInstance &CI) {
     Act = llvm::make_unique<ASTMergeAction>(std::move(Act),
                                             FEOpts.ASTMergeFiles);
 
+  // If requested, emit the external definition map entries of the translation
+  // unit as a side output of the main action.
+  if (!FEOpts.ExtDefMapOutput.empty())
+    Act = llvm::make_unique<cross_tu::GenerateExtDefMapAction>(
+        std::move(Act), FEOpts.ExtDefMapOutput);
+
   return Act;
 }
 
@@ -0,0 +1,159 @@
+//===--- BatchingIndexDataConsumer.cpp - Async occurrence delivery --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Index/BatchingIndexDataConsumer.h"
+#include "llvm/Support/Threading.h"
+
+using namespace clang;
+using namespace clang::index;
+
+BatchingIndexDataConsumer::BatchingIndexDataConsumer(
+    std::shared_ptr<IndexDataConsumer> Next, size_t MaxQueuedOccurrences)
+    : Next(std::move(Next)), MaxQueued(MaxQueuedOccurrences) {
+  assert(this->Next && "no consumer to deliver to");
+  // Without thread support every occurrence is forwarded synchronously.
+  if (llvm::llvm_is_multithreaded())
+    Consumer = std::thread([this] { consumeLoop(); });
+}
+
+BatchingIndexDataConsumer::~BatchingIndexDataConsumer() {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    DoneEnqueueing = true;
+  }
+  QueueNotEmpty.notify_all();
+  if (Consumer.joinable())
+    Consumer.join();
+}
+
+void BatchingIndexDataConsumer::initialize(ASTContext &Ctx) {
+  drain();
+  Next->initialize(Ctx);
+}
+
+void BatchingIndexDataConsumer::setPreprocessor(
+    std::shared_ptr<Preprocessor> PP) {
+  drain();
+  Next->setPreprocessor(std::move(PP));
+}
+
+bool BatchingIndexDataConsumer::handleDeclOccurence(
+    const clang::Decl *D, SymbolRoleSet Roles,
+    ArrayRef<SymbolRelation> Relations, SourceLocation Loc,
+    ASTNodeInfo ASTNode) {
+  Occurrence O;
+  O.Kind = Occurrence::Decl;
+  O.Roles = Roles;
+  O.Loc = Loc;
+  O.D = D;
+  O.Relations.append(Relations.begin(), Relations.end());
+  O.ASTNode = ASTNode;
+  return enqueue(std::move(O));
+}
+
+bool BatchingIndexDataConsumer::handleMacroOccurence(
+    const IdentifierInfo *Name, const MacroInfo *MI, SymbolRoleSet Roles,
+    SourceLocation Loc) {
+  Occurrence O;
+  O.Kind = Occurrence::Macro;
+  O.Roles = Roles;
+  O.Loc = Loc;
+  O.MacroName = Name;
+  O.MI = MI;
+  return enqueue(std::move(O));
+}
+
+bool BatchingIndexDataConsumer::handleModuleOccurence(
+    const ImportDecl *ImportD, const clang::Module *Mod, SymbolRoleSet Roles,
+    SourceLocation Loc) {
+  Occurrence O;
+  O.Kind = Occurrence::Module;
+  O.Roles = Roles;
+  O.Loc = Loc;
+  O.ImportD = ImportD;
+  O.Mod = Mod;
+  return enqueue(std::move(O));
+}
+
+void BatchingIndexDataConsumer::finish() {
+  drain();
+  Next->finish();
+}
+
+bool BatchingIndexDataConsumer::enqueue(Occurrence &&O) {
+  if (Aborted)
+    return false;
+
+  if (!Consumer.joinable())
+    return deliver(O);
+
+  std::unique_lock<std::mutex> Lock(Mutex);
+  // Backpressure: let the consumer catch up rather than queueing the whole
+  // translation unit.
+  QueueNotFull.wait(Lock, [this] {
+    return Queue.size() < MaxQueued || Aborted;
+  });
+  if (Aborted)
+    return false;
+  Queue.push_back(std::move(O));
+  Lock.unlock();
+  QueueNotEmpty.notify_one();
+  return true;
+}
+
+void BatchingIndexDataConsumer::drain() {
+  if (!Consumer.joinable())
+    return;
+  std::unique_lock<std::mutex> Lock(Mutex);
+  QueueNotFull.wait(Lock, [this] {
+    return (Queue.empty() && NumInFlight == 0) || Aborted;
+  });
+}
+
+void BatchingIndexDataConsumer::consumeLoop() {
+  while (true) {
+    Occurrence O;
+    {
+      std::unique_lock<std::mutex> Lock(Mutex);
+      QueueNotEmpty.wait(Lock, [this] {
+        return !Queue.empty() || DoneEnqueueing;
+      });
+      if (Queue.empty())
+        return;
+      O = std::move(Queue.front());
+      Queue.pop_front();
+      ++NumInFlight;
+    }
+
+    bool Continue = deliver(O);
+
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      --NumInFlight;
+      if (!Continue) {
+        Aborted = true;
+        Queue.clear();
+      }
+    }
+    // Wakes both producers waiting for room and drain().
+    QueueNotFull.notify_all();
+  }
+}
+
+bool BatchingIndexDataConsumer::deliver(const Occurrence &O) {
+  switch (O.Kind) {
+  case Occurrence::Decl:
+    return Next->handleDeclOccurence(O.D, O.Roles, O.Relations, O.Loc,
+                                     O.ASTNode);
+  case Occurrence::Macro:
+    return Next->handleMacroOccurence(O.MacroName, O.MI, O.Roles, O.Loc);
+  case Occurrence::Module:
+    return Next->handleModuleOccurence(O.ImportD, O.Mod, O.Roles, O.Loc);
+  }
+  llvm_unreachable("unknown occurrence kind");
+}
@@ -11,6 +11,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/Lex/PreprocessingRecord.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -61,16 +62,19 @@ class USRGenerator : public ConstDeclVisitor<USRGenerator> {
   bool IgnoreResults;
   ASTContext *Context;
   bool generatedLoc;
+  USRCache *Cache;
 
   llvm::DenseMap<const Type *, unsigned> TypeSubstitutions;
 
 public:
-  explicit USRGenerator(ASTContext *Ctx, SmallVectorImpl<char> &Buf)
+  explicit USRGenerator(ASTContext *Ctx, SmallVectorImpl<char> &Buf,
+                        USRCache *Cache = nullptr)
   : Buf(Buf),
     Out(Buf),
     IgnoreResults(false),
     Context(Ctx),
-    generatedLoc(false)
+    generatedLoc(false),
+    Cache(Cache)
   {
     // Add the USR space prefix.
     Out << getUSRSpacePrefix();
@@ -195,9 +199,19 @@ bool USRGenerator::ShouldGenerateLocation(const NamedDecl *D) {
 }
 
 void USRGenerator::VisitDeclContext(const DeclContext *DC) {
-  if (const NamedDecl *D = dyn_cast<NamedDecl>(DC))
+  if (const NamedDecl *D = dyn_cast<NamedDecl>(DC)) {
+    // A namespace prefix is identical for every decl nested in it and never
+    // interacts with the type substitution table, so splice the interned
+    // spelling instead of re-printing the chain for every nested decl.
+    if (Cache && isa<NamespaceDecl>(D)) {
+      StringRef USR = Cache->getUSR(D);
+      if (!USR.empty()) {
+        Out << USR.drop_front(getUSRSpacePrefix().size());
+        return;
+      }
+    }
     Visit(D);
-  else if (isa<LinkageSpecDecl>(DC)) // Linkage specs are transparent in USRs.
+  } else if (isa<LinkageSpecDecl>(DC)) // Linkage specs are transparent in USRs.
     VisitDeclContext(DC->getParent());
 }
 
@@ -1079,6 +1093,27 @@ bool clang::index::generateUSRForDecl(const Decl *D,
   return UG.ignoreResults();
 }
 
+StringRef clang::index::USRCache::getUSR(const Decl *D) {
+  if (!D)
+    return StringRef();
+  D = D->getCanonicalDecl();
+
+  auto It = USRs.find(D);
+  if (It != USRs.end())
+    return It->second;
+
+  SmallString<128> Buf;
+  USRGenerator UG(&D->getASTContext(), Buf, this);
+  UG.Visit(D);
+
+  // Visiting an enclosing namespace may have recursed back into the cache,
+  // so only insert once generation is complete.
+  StringRef USR;
+  if (!UG.ignoreResults())
+    USR = StringRef(Buf).copy(Alloc);
+  return USRs[D] = USR;
+}
+
 bool clang::index::generateUSRForMacro(const MacroDefinitionRecord *MD,
                                        const SourceManager &SM,
                                        SmallVectorImpl<char> &Buf) {
@@ -0,0 +1,154 @@
+//===--- CompactTokenBuffer.cpp - Byte-packed token storage ---------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the CompactTokenBuffer class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/CompactTokenBuffer.h"
+#include "clang/Basic/IdentifierTable.h"
+#include "llvm/ADT/DenseMap.h"
+
+using namespace clang;
+
+// Each token is encoded as a sequence of LEB128-style variable-length
+// integers: the kind, the flags word combined with a payload tag in its two
+// top bits, the zigzag-encoded delta of the raw source location from the
+// previous token's, the length, and then the payload selected by the tag -
+// nothing, an index into the identifier table, or the raw bits of a literal
+// data pointer (literal spellings live in the preprocessor's buffers for the
+// lifetime of the compilation, so the pointer stays valid).
+enum : unsigned {
+  PayloadShift = 14, // Above the highest Token::TokenFlags bit.
+  PayloadMask = 0x3u << PayloadShift,
+  PayloadNone = 0u << PayloadShift,
+  PayloadIdentifier = 1u << PayloadShift,
+  PayloadLiteral = 2u << PayloadShift
+};
+
+static void writeVarint(SmallVectorImpl<uint8_t> &Out, uint64_t V) {
+  do {
+    uint8_t Byte = V & 0x7f;
+    V >>= 7;
+    if (V)
+      Byte |= 0x80;
+    Out.push_back(Byte);
+  } while (V);
+}
+
+static uint64_t readVarint(const uint8_t *&P) {
+  uint64_t Result = 0;
+  unsigned Shift = 0;
+  uint8_t Byte;
+  do {
+    Byte = *P++;
+    Result |= uint64_t(Byte & 0x7f) << Shift;
+    Shift += 7;
+  } while (Byte & 0x80);
+  return Result;
+}
+
+static uint32_t zigzagEncode(int32_t V) {
+  return (uint32_t(V) << 1) ^ uint32_t(V >> 31);
+}
+
+static int32_t zigzagDecode(uint32_t V) {
+  return int32_t(V >> 1) ^ -int32_t(V & 1);
+}
+
+bool CompactTokenBuffer::tryEncode(ArrayRef<Token> Toks) {
+  llvm::DenseMap<IdentifierInfo *, unsigned> IdentIndex;
+  uint32_t PrevLoc = 0;
+
+  for (const Token &Tok : Toks) {
+    // Annotation tokens carry a pointer and a second location, raw
+    // identifiers point into the source buffer with no interned identifier,
+    // and eof tokens may carry out-of-band data; none of these occur in a
+    // cached phase-4 token sequence, but keep such sequences verbatim rather
+    // than lose information.
+    if (Tok.isAnnotation() || Tok.isOneOf(tok::raw_identifier, tok::eof))
+      return false;
+
+    unsigned Payload = PayloadNone;
+    if (Tok.getIdentifierInfo())
+      Payload = PayloadIdentifier;
+    else if (Tok.isLiteral())
+      Payload = PayloadLiteral;
+
+    writeVarint(Packed, Tok.getKind());
+    assert(!(Tok.getFlags() & PayloadMask) && "Flags collide with the tag");
+    writeVarint(Packed, Tok.getFlags() | Payload);
+
+    uint32_t Loc = Tok.getLocation().getRawEncoding();
+    writeVarint(Packed, zigzagEncode(int32_t(Loc - PrevLoc)));
+    PrevLoc = Loc;
+
+    writeVarint(Packed, Tok.getLength());
+
+    if (Payload == PayloadIdentifier) {
+      IdentifierInfo *II = Tok.getIdentifierInfo();
+      auto Ins = IdentIndex.insert(std::make_pair(II, Idents.size()));
+      if (Ins.second)
+        Idents.push_back(II);
+      writeVarint(Packed, Ins.first->second);
+    } else if (Payload == PayloadLiteral) {
+      writeVarint(Packed, reinterpret_cast<uintptr_t>(Tok.getLiteralData()));
+    }
+  }
+  return true;
+}
+
+void CompactTokenBuffer::encode(ArrayRef<Token> Toks) {
+  Packed.clear();
+  Idents.clear();
+  Raw.clear();
+  NumTokens = Toks.size();
+
+  if (!tryEncode(Toks)) {
+    Packed.clear();
+    Idents.clear();
+    Raw.append(Toks.begin(), Toks.end());
+  }
+}
+
+void CompactTokenBuffer::decode(SmallVectorImpl<Token> &Out) const {
+  if (!Raw.empty()) {
+    Out.append(Raw.begin(), Raw.end());
+    return;
+  }
+
+  Out.reserve(Out.size() + NumTokens);
+
+  const uint8_t *P = Packed.begin();
+  const uint8_t *End = Packed.end();
+  uint32_t PrevLoc = 0;
+
+  while (P != End) {
+    Token Tok;
+    Tok.startToken();
+    Tok.setKind(tok::TokenKind(readVarint(P)));
+
+    unsigned Flags = readVarint(P);
+    unsigned Payload = Flags & PayloadMask;
+    if (unsigned RealFlags = Flags & ~PayloadMask)
+      Tok.setFlag(Token::TokenFlags(RealFlags));
+
+    PrevLoc += uint32_t(zigzagDecode(readVarint(P)));
+    Tok.setLocation(SourceLocation::getFromRawEncoding(PrevLoc));
+
+    Tok.setLength(readVarint(P));
+
+    if (Payload == PayloadIdentifier)
+      Tok.setIdentifierInfo(Idents[readVarint(P)]);
+    else if (Payload == PayloadLiteral)
+      Tok.setLiteralData(reinterpret_cast<const char *>(
+          uintptr_t(readVarint(P))));
+
+    Out.push_back(Tok);
+  }
+}
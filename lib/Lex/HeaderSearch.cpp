@@ -24,6 +24,7 @@
 #include "clang/Lex/ModuleMap.h"
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
@@ -32,7 +33,10 @@
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/RWMutex.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include <algorithm>
 #include <cassert>
@@ -45,6 +49,77 @@
 
 using namespace clang;
 
+namespace {
+
+/// A process-wide memo of which search directory satisfied an include
+/// spelling, shared by all the HeaderSearch instances whose search path
+/// lists hash to the same signature. Tools that run one CompilerInstance
+/// per TU with a common -I set (e.g. AllTUsToolExecutor) otherwise re-probe
+/// the same directories for the same spellings in every TU; with the memo
+/// a fresh instance resumes its scan directly at the recorded directory.
+///
+/// Only plain hits are recorded: spellings that a header map remapped
+/// mid-scan are left out, since replaying them needs the scan's side
+/// effects. Unlike the per-instance lookup cache, whose frozen-directory
+/// assumption is bounded by one TU, the memo assumes the directories'
+/// contents do not change while the process runs and is never invalidated.
+/// It is therefore opt-in (HeaderSearchOptions::SharedLookupHitCache);
+/// long-lived hosts that re-parse as the filesystem changes, such as IDE
+/// sessions over libclang, must not enable it.
+class GlobalLookupHitCache {
+  llvm::sys::RWMutex Mutex;
+
+  /// Hit indices per search path signature. The key is the start index of
+  /// the scan followed by ':' and the spelled filename; the value is the
+  /// hit index + 1.
+  llvm::DenseMap<uint64_t, llvm::StringMap<unsigned>> Hits;
+
+  static void makeKey(SmallVectorImpl<char> &Key, unsigned StartIdx,
+                      StringRef Filename) {
+    llvm::raw_svector_ostream OS(Key);
+    OS << StartIdx << ':' << Filename;
+  }
+
+public:
+  /// Return the recorded hit index + 1 for the given scan, or 0 if none.
+  unsigned get(uint64_t Signature, unsigned StartIdx, StringRef Filename) {
+    SmallString<128> Key;
+    makeKey(Key, StartIdx, Filename);
+    llvm::sys::ScopedReader Guard(Mutex);
+    auto It = Hits.find(Signature);
+    if (It == Hits.end())
+      return 0;
+    return It->second.lookup(Key);
+  }
+
+  void put(uint64_t Signature, unsigned StartIdx, StringRef Filename,
+           unsigned HitIdx) {
+    SmallString<128> Key;
+    makeKey(Key, StartIdx, Filename);
+    llvm::sys::ScopedWriter Guard(Mutex);
+    Hits[Signature].try_emplace(Key, HitIdx + 1);
+  }
+};
+
+llvm::ManagedStatic<GlobalLookupHitCache> GlobalLookupHits;
+
+} // namespace
+
+uint64_t HeaderSearch::getSearchPathSignature() const {
+  if (SearchPathSignature)
+    return SearchPathSignature;
+  llvm::hash_code Hash = llvm::hash_value(SearchDirs.size());
+  for (const DirectoryLookup &DL : SearchDirs)
+    Hash = llvm::hash_combine(Hash, DL.getName(),
+                              unsigned(DL.getLookupType()),
+                              unsigned(DL.getDirCharacteristic()));
+  // Reserve zero for "not computed yet".
+  SearchPathSignature = uint64_t(size_t(Hash));
+  if (!SearchPathSignature)
+    SearchPathSignature = 1;
+  return SearchPathSignature;
+}
+
 const IdentifierInfo *
 HeaderFileInfo::getControllingMacro(ExternalPreprocessorSource *External) {
   if (ControllingMacro) {
@@ -849,6 +924,16 @@ const FileEntry *HeaderSearch::LookupFile(
     // our search start.  We will fill in our found location below, so prime the
     // start point value.
     CacheLookup.reset(/*StartIdx=*/i+1);
+
+    // Ask the process-wide cache where another instance with the same search
+    // path list found this file, and resume the scan at that directory: the
+    // directories in between did not contain the file for that instance and
+    // cannot contain it for us either.
+    if (!SkipCache && HSOpts->SharedLookupHitCache)
+      if (unsigned GlobalHit =
+              GlobalLookupHits->get(getSearchPathSignature(), i, Filename))
+        if (GlobalHit - 1 > i && GlobalHit - 1 < SearchDirs.size())
+          i = GlobalHit - 1;
   }
 
   SmallString<64> MappedName;
@@ -922,6 +1007,13 @@ const FileEntry *HeaderSearch::LookupFile(
 
     // Remember this location for the next lookup we do.
     CacheLookup.HitIdx = i;
+
+    // Publish the hit for the other instances of the process, unless a
+    // header map remapped the spelling mid-scan; replaying such a scan
+    // needs the remapping side effects, not just the final directory.
+    if (!SkipCache && HSOpts->SharedLookupHitCache && !CacheLookup.MappedName)
+      GlobalLookupHits->put(getSearchPathSignature(), CacheLookup.StartIdx - 1,
+                            Filename, i);
     return FE;
   }
 
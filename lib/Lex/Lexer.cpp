@@ -47,6 +47,13 @@
 #include <tuple>
 #include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#endif
+
 using namespace clang;
 
 //===----------------------------------------------------------------------===//
@@ -103,6 +110,10 @@ void Lexer::InitLexer(const char *BufStart, const char *BufPtr,
   Is_PragmaLexer = false;
   CurrentConflictMarkerState = CMK_None;
 
+  // Assume the buffer may contain non-ASCII bytes; the constructors that know
+  // the FileID refine this from the SourceManager's load-time scan.
+  IsPureASCIIBuffer = false;
+
   // Start of the file is a start of line.
   IsAtStartOfLine = true;
   IsAtPhysicalStartOfLine = true;
@@ -136,6 +147,7 @@ Lexer::Lexer(FileID FID, const llvm::MemoryBuffer *InputFile, Preprocessor &PP)
       LangOpts(PP.getLangOpts()) {
   InitLexer(InputFile->getBufferStart(), InputFile->getBufferStart(),
             InputFile->getBufferEnd());
+  IsPureASCIIBuffer = PP.getSourceManager().isBufferPureASCII(FID);
 
   resetExtendedTokenMode();
 }
@@ -158,7 +170,9 @@ Lexer::Lexer(SourceLocation fileloc, const LangOptions &langOpts,
 Lexer::Lexer(FileID FID, const llvm::MemoryBuffer *FromFile,
              const SourceManager &SM, const LangOptions &langOpts)
     : Lexer(SM.getLocForStartOfFile(FID), langOpts, FromFile->getBufferStart(),
-            FromFile->getBufferStart(), FromFile->getBufferEnd()) {}
+            FromFile->getBufferStart(), FromFile->getBufferEnd()) {
+  IsPureASCIIBuffer = SM.isBufferPureASCII(FID);
+}
 
 void Lexer::resetExtendedTokenMode() {
   assert(PP && "Cannot reset token mode without a preprocessor");
@@ -1419,6 +1433,15 @@ void Lexer::SetByteOffset(unsigned Offset, bool StartOfLine) {
   IsAtPhysicalStartOfLine = StartOfLine;
 }
 
+bool Lexer::skipOver(unsigned NumBytes) {
+  IsAtPhysicalStartOfLine = true;
+  IsAtStartOfLine = true;
+  if ((BufferPtr + NumBytes) > BufferEnd)
+    return true;
+  BufferPtr += NumBytes;
+  return false;
+}
+
 static bool isAllowedIDChar(uint32_t C, const LangOptions &LangOpts) {
   if (LangOpts.AsmPreprocessor) {
     return false;
@@ -1629,6 +1652,38 @@ bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
   unsigned char C = *CurPtr++;
+
+#ifdef __SSE2__
+  // Skip whole 16-byte chunks of [_A-Za-z0-9] at once. Anything rarer ('$',
+  // UCNs, escaped newlines, non-ASCII) stops the chunk scan and is handled by
+  // the scalar loop and the slow path below, exactly as before. Non-ASCII
+  // bytes are negative in the signed comparisons, so they never pass the
+  // range checks.
+  if (isIdentifierBody(C)) {
+    --CurPtr; // Reestablish *CurPtr == C for the chunked scan.
+    auto InRange = [](__m128i Chunk, char Lo, char Hi) {
+      return _mm_and_si128(_mm_cmpgt_epi8(Chunk, _mm_set1_epi8(Lo - 1)),
+                           _mm_cmpgt_epi8(_mm_set1_epi8(Hi + 1), Chunk));
+    };
+    const __m128i Underscores = _mm_set1_epi8('_');
+    while (CurPtr + 16 <= BufferEnd) {
+      __m128i Chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(CurPtr));
+      __m128i IsBody = _mm_or_si128(
+          _mm_or_si128(InRange(Chunk, 'a', 'z'), InRange(Chunk, 'A', 'Z')),
+          _mm_or_si128(InRange(Chunk, '0', '9'),
+                       _mm_cmpeq_epi8(Chunk, Underscores)));
+      int Mask = _mm_movemask_epi8(IsBody);
+      if (Mask != 0xFFFF) {
+        // Advance to the first byte that is not an identifier body.
+        CurPtr += llvm::countTrailingOnes<unsigned>(Mask);
+        break;
+      }
+      CurPtr += 16;
+    }
+    C = *CurPtr++;
+  }
+#endif
+
   while (isIdentifierBody(C))
     C = *CurPtr++;
 
@@ -1706,7 +1761,8 @@ FinishIdentifier:
     } else if (C == '\\' && tryConsumeIdentifierUCN(CurPtr, Size, Result)) {
       C = getCharAndSize(CurPtr, Size);
       continue;
-    } else if (!isASCII(C) && tryConsumeIdentifierUTF8Char(CurPtr)) {
+    } else if (!IsPureASCIIBuffer && !isASCII(C) &&
+               tryConsumeIdentifierUTF8Char(CurPtr)) {
       C = getCharAndSize(CurPtr, Size);
       continue;
     } else if (!isIdentifierBody(C)) {
@@ -1789,7 +1845,7 @@ bool Lexer::LexNumericConstant(Token &Result, const char *CurPtr) {
   // If we have a UCN or UTF-8 character (perhaps in a ud-suffix), continue.
   if (C == '\\' && tryConsumeIdentifierUCN(CurPtr, Size, Result))
     return LexNumericConstant(Result, CurPtr);
-  if (!isASCII(C) && tryConsumeIdentifierUTF8Char(CurPtr))
+  if (!IsPureASCIIBuffer && !isASCII(C) && tryConsumeIdentifierUTF8Char(CurPtr))
     return LexNumericConstant(Result, CurPtr);
 
   // Update the location of token as well as BufferPtr.
@@ -1813,7 +1869,8 @@ const char *Lexer::LexUDSuffix(Token &Result, const char *CurPtr,
   if (!isIdentifierHead(C)) {
     if (C == '\\' && tryConsumeIdentifierUCN(CurPtr, Size, Result))
       Consumed = true;
-    else if (!isASCII(C) && tryConsumeIdentifierUTF8Char(CurPtr))
+    else if (!IsPureASCIIBuffer && !isASCII(C) &&
+             tryConsumeIdentifierUTF8Char(CurPtr))
       Consumed = true;
     else
       return CurPtr;
@@ -1883,7 +1940,8 @@ const char *Lexer::LexUDSuffix(Token &Result, const char *CurPtr,
     C = getCharAndSize(CurPtr, Size);
     if (isIdentifierBody(C)) { CurPtr = ConsumeChar(CurPtr, Size, Result); }
     else if (C == '\\' && tryConsumeIdentifierUCN(CurPtr, Size, Result)) {}
-    else if (!isASCII(C) && tryConsumeIdentifierUTF8Char(CurPtr)) {}
+    else if (!IsPureASCIIBuffer && !isASCII(C) &&
+             tryConsumeIdentifierUTF8Char(CurPtr)) {}
     else break;
   }
 
@@ -2182,6 +2240,26 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
 
   // Skip consecutive spaces efficiently.
   while (true) {
+#ifdef __SSE2__
+    // Skip whole 16-byte chunks of spaces and tabs at once; long indentation
+    // runs are the common case in machine generated and deeply nested code.
+    // Newlines and the directive-end handling stay in the scalar code below.
+    if (isHorizontalWhitespace(Char)) {
+      const __m128i Spaces = _mm_set1_epi8(' ');
+      const __m128i Tabs = _mm_set1_epi8('\t');
+      while (CurPtr + 16 <= BufferEnd) {
+        __m128i Chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(CurPtr));
+        int Mask = _mm_movemask_epi8(_mm_or_si128(
+            _mm_cmpeq_epi8(Chunk, Spaces), _mm_cmpeq_epi8(Chunk, Tabs)));
+        if (Mask != 0xFFFF)
+          break;
+        CurPtr += 16;
+      }
+      Char = *CurPtr;
+    }
+#endif
+
     // Skip horizontal whitespace very aggressively.
     while (isHorizontalWhitespace(Char))
       Char = *++CurPtr;
@@ -2253,6 +2331,32 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   char C;
   while (true) {
     C = *CurPtr;
+
+#ifdef __SSE2__
+    // Scan for the terminating newline (or a NUL) a 16-byte chunk at a time.
+    // NUL is one of the scanned-for bytes, so a code completion point inside
+    // the comment is still found.
+    if (C != 0 && C != '\n' && C != '\r') {
+      const __m128i Zeros = _mm_setzero_si128();
+      const __m128i LFs = _mm_set1_epi8('\n');
+      const __m128i CRs = _mm_set1_epi8('\r');
+      while (CurPtr + 16 <= BufferEnd) {
+        __m128i Chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(CurPtr));
+        int Mask = _mm_movemask_epi8(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(Chunk, Zeros),
+                                      _mm_cmpeq_epi8(Chunk, LFs)),
+                         _mm_cmpeq_epi8(Chunk, CRs)));
+        if (Mask != 0) {
+          CurPtr += llvm::countTrailingZeros<unsigned>(Mask);
+          break;
+        }
+        CurPtr += 16;
+      }
+      C = *CurPtr;
+    }
+#endif
+
     // Skip over characters in the fast loop.
     while (C != 0 &&                // Potentially EOF.
            C != '\n' && C != '\r')  // Newline or DOS-style newline.
@@ -2459,13 +2563,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
@@ -29,7 +29,9 @@
 using namespace clang;
 
 MacroInfo::MacroInfo(SourceLocation DefLoc)
-    : Location(DefLoc), IsDefinitionLengthCached(false), IsFunctionLike(false),
+    : Location(DefLoc), IsDefinitionLengthCached(false),
+      IsReplayableExpansion(false), IsReplayableExpansionCached(false),
+      IsFunctionLike(false),
       IsC99Varargs(false), IsGNUVarargs(false), IsBuiltinMacro(false),
       HasCommaPasting(false), IsDisabled(false), IsUsed(false),
       IsAllowRedefinitionsWithoutWarning(false), IsWarnIfUnused(false),
@@ -64,6 +66,30 @@ unsigned MacroInfo::getDefinitionLengthSlow(const SourceManager &SM) const {
   return DefinitionLength;
 }
 
+bool MacroInfo::isReplayableExpansionSlow() const {
+  assert(!IsReplayableExpansionCached);
+  IsReplayableExpansionCached = true;
+  IsReplayableExpansion = false;
+
+  if (IsFunctionLike || IsBuiltinMacro)
+    return false;
+
+  for (const Token &Tok : ReplacementTokens) {
+    // Identifiers may name macros or keywords and need the per-token
+    // handling in TokenLexer::Lex; '##' pastes even in object-like macros;
+    // comments take a different location-mapping path.
+    if (Tok.getIdentifierInfo() || Tok.isOneOf(tok::hashhash, tok::comment))
+      return false;
+    // Replayed tokens are remapped relative to the definition start, which
+    // requires spelling locations inside the definition's file.
+    if (!Tok.getLocation().isFileID())
+      return false;
+  }
+
+  IsReplayableExpansion = true;
+  return true;
+}
+
 /// Return true if the specified macro definition is equal to
 /// this macro in spelling, arguments, and whitespace.
 ///
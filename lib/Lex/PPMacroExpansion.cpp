@@ -611,6 +611,43 @@ bool Preprocessor::HandleMacroExpandedIdentifier(Token &Identifier,
     // we're done.
     ++NumFastMacroExpanded;
     return true;
+  } else if (MI->isReplayableExpansion()) {
+    // This macro expands to a fixed sequence of literal tokens -- no
+    // identifiers, no pasting.  Hand out a copy of the replacement list with
+    // remapped locations instead of pushing a full macro expansion context;
+    // the copied tokens need none of TokenLexer's per-token handling.
+    assert(!Args && "replayable macros are object-like");
+    unsigned NumToks = MI->getNumTokens();
+    auto Toks = llvm::make_unique<Token[]>(NumToks);
+
+    // Create a single expansion entry covering the macro definition and
+    // remap each token into it, exactly as TokenLexer::Init would.
+    SourceLocation DefStart =
+        SourceMgr.getExpansionLoc(MI->getReplacementToken(0).getLocation());
+    unsigned DefLength = MI->getDefinitionLength(SourceMgr);
+    SourceLocation ExpansionStart =
+        SourceMgr.createExpansionLoc(DefStart, ExpandLoc, ExpansionEnd,
+                                     DefLength);
+    for (unsigned I = 0; I != NumToks; ++I) {
+      Toks[I] = MI->getReplacementToken(I);
+      unsigned RelOffset = 0;
+      bool Invalid = !SourceMgr.isInSLocAddrSpace(Toks[I].getLocation(),
+                                                  DefStart, DefLength,
+                                                  &RelOffset);
+      assert(!Invalid && "Expected token to come from the macro definition");
+      (void)Invalid;
+      Toks[I].setLocation(ExpansionStart.getLocWithOffset(RelOffset));
+    }
+
+    // Propagate the isAtStartOfLine/hasLeadingSpace markers of the macro
+    // identifier to the first expanded token.
+    Toks[0].setFlagValue(Token::StartOfLine, Identifier.isAtStartOfLine());
+    Toks[0].setFlagValue(Token::LeadingSpace, Identifier.hasLeadingSpace());
+
+    ++NumReplayedMacroExpanded;
+    EnterTokenStream(std::move(Toks), NumToks,
+                     /*DisableMacroExpansion=*/false, /*IsReinject=*/false);
+    return false;
   }
 
   // Start expanding the macro.
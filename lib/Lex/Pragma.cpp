@@ -82,19 +82,44 @@ PragmaHandler *PragmaNamespace::FindHandler(StringRef Name,
                                             bool IgnoreNull) const {
   if (PragmaHandler *Handler = Handlers.lookup(Name))
     return Handler;
-  return IgnoreNull ? nullptr : Handlers.lookup(StringRef());
+  return IgnoreNull ? nullptr : NullHandler;
+}
+
+PragmaHandler *PragmaNamespace::FindHandler(const IdentifierInfo *II,
+                                            bool IgnoreNull) const {
+  // Identifiers are interned, so the resolution (including the "there is no
+  // handler" verdict) can be remembered per pointer; pragma-heavy inputs
+  // repeat the same few spellings many thousands of times.
+  auto Cached = HandlerCache.find(II);
+  PragmaHandler *Handler;
+  if (Cached != HandlerCache.end())
+    Handler = Cached->second;
+  else {
+    Handler = Handlers.lookup(II->getName());
+    HandlerCache[II] = Handler;
+  }
+
+  if (Handler)
+    return Handler;
+  return IgnoreNull ? nullptr : NullHandler;
 }
 
 void PragmaNamespace::AddPragma(PragmaHandler *Handler) {
   assert(!Handlers.lookup(Handler->getName()) &&
          "A handler with this name is already registered in this namespace");
   Handlers[Handler->getName()] = Handler;
+  if (Handler->getName().empty())
+    NullHandler = Handler;
+  HandlerCache.clear();
 }
 
 void PragmaNamespace::RemovePragmaHandler(PragmaHandler *Handler) {
   assert(Handlers.lookup(Handler->getName()) &&
          "Handler not registered in this namespace");
   Handlers.erase(Handler->getName());
+  if (Handler == NullHandler)
+    NullHandler = nullptr;
+  HandlerCache.clear();
 }
 
 void PragmaNamespace::HandlePragma(Preprocessor &PP,
@@ -103,11 +128,13 @@ void PragmaNamespace::HandlePragma(Preprocessor &PP,
   // expand it, the user can have a STDC #define, that should not affect this.
   PP.LexUnexpandedToken(Tok);
 
-  // Get the handler for this token.  If there is no handler, ignore the pragma.
-  PragmaHandler *Handler
-    = FindHandler(Tok.getIdentifierInfo() ? Tok.getIdentifierInfo()->getName()
-                                          : StringRef(),
-                  /*IgnoreNull=*/false);
+  // Get the handler for this token.  If there is no handler, ignore the
+  // pragma. Pragma names are identifiers, so the resolution is memoized per
+  // identifier pointer.
+  PragmaHandler *Handler =
+      Tok.getIdentifierInfo()
+          ? FindHandler(Tok.getIdentifierInfo(), /*IgnoreNull=*/false)
+          : FindHandler(StringRef(), /*IgnoreNull=*/false);
   if (!Handler) {
     PP.Diag(Tok, diag::warn_pragma_ignored);
     return;
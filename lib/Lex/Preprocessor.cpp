@@ -275,7 +275,8 @@ void Preprocessor::PrintStats() {
 
   llvm::errs() << NumMacroExpanded << "/" << NumFnMacroExpanded << "/"
              << NumBuiltinMacroExpanded << " obj/fn/builtin macros expanded, "
-             << NumFastMacroExpanded << " on the fast path.\n";
+             << NumFastMacroExpanded << " on the fast path, "
+             << NumReplayedMacroExpanded << " replayed verbatim.\n";
   llvm::errs() << (NumFastTokenPaste+NumTokenPaste)
              << " token paste (##) operations performed, "
              << NumFastTokenPaste << " on the fast path.\n";
@@ -875,6 +876,22 @@ bool Preprocessor::HandleIdentifier(Token &Identifier) {
   return true;
 }
 
+/// Lex - To lex a token from the preprocessor, just pull a token from the
+/// current lexer or macro object.
+///
+/// Note on pipelining: running this on a lookahead thread ahead of the parser
+/// has been proposed more than once and does not fit the design. The token
+/// stream is not a one-way pipe: the parser re-enters tokens it has already
+/// consumed (EnterTokenStream, EnterToken), rewrites cached tokens in place
+/// during annotation (AnnotatePreviousCachedTokens,
+/// ReplacePreviousCachedToken), and rewinds the stream when tentative parses
+/// fail (Backtrack). Pragma handlers and code completion call back into Sema
+/// at the point the token is *consumed*, and parser-directed state such as
+/// LexAfterModuleImport changes how the very next tokens are lexed. Any
+/// token lexed ahead of the consumer is therefore speculative and would have
+/// to be thrown away at every annotation or pragma, which in C++ means
+/// constantly. Overlap across translation units (separate invocations) is
+/// the profitable form of parallelism here.
 void Preprocessor::Lex(Token &Result) {
   ++LexLevel;
 
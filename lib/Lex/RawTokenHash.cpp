@@ -0,0 +1,61 @@
+//===--- RawTokenHash.cpp - Hashing of raw token streams ------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements hashing of the raw token stream of a source range.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/RawTokenHash.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/Support/MD5.h"
+
+using namespace clang;
+
+uint64_t clang::hashRawTokensInRange(CharSourceRange Range,
+                                     const SourceManager &SM,
+                                     const LangOptions &LangOpts) {
+  CharSourceRange FileRange = Lexer::makeFileCharRange(Range, SM, LangOpts);
+  if (FileRange.isInvalid())
+    return 0;
+
+  std::pair<FileID, unsigned> Begin = SM.getDecomposedLoc(FileRange.getBegin());
+  std::pair<FileID, unsigned> End = SM.getDecomposedLoc(FileRange.getEnd());
+  if (Begin.first != End.first || Begin.second > End.second)
+    return 0;
+
+  bool Invalid = false;
+  StringRef Buffer = SM.getBufferData(Begin.first, &Invalid);
+  if (Invalid)
+    return 0;
+
+  Lexer RawLex(SM.getLocForStartOfFile(Begin.first), LangOpts, Buffer.begin(),
+               Buffer.data() + Begin.second, Buffer.end());
+
+  llvm::MD5 Hash;
+  Token Tok;
+  while (true) {
+    RawLex.LexFromRawLexer(Tok);
+    if (Tok.is(tok::eof))
+      break;
+    unsigned Offset = SM.getFileOffset(Tok.getLocation());
+    if (Offset >= End.second)
+      break;
+
+    // Prefix each spelling with its length so that moving characters across
+    // a token boundary cannot produce the same byte stream.
+    uint32_t Length = Tok.getLength();
+    Hash.update(
+        StringRef(reinterpret_cast<const char *>(&Length), sizeof(Length)));
+    Hash.update(StringRef(Buffer.data() + Offset, Tok.getLength()));
+  }
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  return Result.low();
+}
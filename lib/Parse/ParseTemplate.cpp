@@ -1493,10 +1493,15 @@ void Parser::ParseLateTemplatedFuncDef(LateParsedTemplate &LPT) {
 
   assert(!LPT.Toks.empty() && "Empty body!");
 
-  // Append the current token at the end of the new token stream so that it
-  // doesn't get lost.
-  LPT.Toks.push_back(Tok);
-  PP.EnterTokenStream(LPT.Toks, true, /*IsReinject*/true);
+  // Unpack the cached body and append the current token at the end of the
+  // new token stream so that it doesn't get lost. The stream must outlive
+  // this function, so hand an owned copy to the preprocessor.
+  CachedTokens Body;
+  LPT.Toks.decode(Body);
+  Body.push_back(Tok);
+  auto Toks = llvm::make_unique<Token[]>(Body.size());
+  std::copy(Body.begin(), Body.end(), Toks.get());
+  PP.EnterTokenStream(std::move(Toks), Body.size(), true, /*IsReinject*/true);
 
   // Consume the previously pushed token.
   ConsumeAnyToken(/*ConsumeCodeCompletionTok=*/true);
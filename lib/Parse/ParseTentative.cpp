@@ -971,8 +971,13 @@ Parser::TPResult Parser::TryParseDeclarator(bool mayBeAbstract,
     // declarator-id
     if (Tok.is(tok::annot_cxxscope))
       ConsumeAnnotationToken();
-    else if (Tok.is(tok::identifier))
+    else if (Tok.is(tok::identifier)) {
       TentativelyDeclaredIdentifiers.push_back(Tok.getIdentifierInfo());
+      // The tentative declaration changes how later occurrences of the
+      // identifier disambiguate (TryAnnotateName sends them down
+      // ANK_TentativeDecl), so memoized verdicts are stale now.
+      TentativeParseVerdicts.clear();
+    }
     if (Tok.is(tok::kw_operator)) {
       if (TryParseOperatorId() == TPResult::Error)
         return TPResult::Error;
@@ -1197,6 +1202,48 @@ public:
   }
 };
 }
+
+Parser::TPResult
+Parser::isCXXDeclarationSpecifier(Parser::TPResult BracedCastResult,
+                                  bool *InvalidAsDeclSpec) {
+  // Disambiguating one construct queries the same decl-specifier several
+  // times: once to decide whether tentative parsing is needed at all, and
+  // then again from each enclosing TryParse* attempt that backtracks over
+  // it. While a tentative parsing region is active no declarations are
+  // committed, so the verdict for a given token position cannot change and
+  // is worth memoizing; the cache dies with the outermost region, before
+  // committed parsing can declare names that would invalidate it, and is
+  // also dropped whenever TentativelyDeclaredIdentifiers changes, because
+  // tentatively declared identifiers disambiguate differently.
+  if (!PP.isBacktrackEnabled())
+    return isCXXDeclarationSpecifierImpl(BracedCastResult, InvalidAsDeclSpec);
+
+  std::pair<unsigned, unsigned> Key(
+      Tok.getLocation().getRawEncoding(),
+      static_cast<unsigned>(BracedCastResult) << 1 |
+          (InvalidAsDeclSpec != nullptr));
+  auto Known = TentativeParseVerdicts.find(Key);
+  if (Known != TentativeParseVerdicts.end()) {
+    if (Known->second.second)
+      *InvalidAsDeclSpec = Known->second.second == 1;
+    return Known->second.first;
+  }
+
+  bool WasInvalid = InvalidAsDeclSpec && *InvalidAsDeclSpec;
+  TPResult TPR =
+      isCXXDeclarationSpecifierImpl(BracedCastResult, InvalidAsDeclSpec);
+  bool IsInvalid = InvalidAsDeclSpec && *InvalidAsDeclSpec;
+
+  // Record the write to *InvalidAsDeclSpec so a cache hit can replay it. A
+  // write of the value that is already there cannot be observed, but then
+  // replaying it as "no write" makes no difference either.
+  unsigned char InvalidEffect = 0;
+  if (IsInvalid != WasInvalid)
+    InvalidEffect = IsInvalid ? 1 : 2;
+  TentativeParseVerdicts[Key] = std::make_pair(TPR, InvalidEffect);
+  return TPR;
+}
+
 /// isCXXDeclarationSpecifier - Returns TPResult::True if it is a declaration
 /// specifier, TPResult::False if it is not, TPResult::Ambiguous if it could
 /// be either a decl-specifier or a function-style cast, and TPResult::Error
@@ -1310,8 +1357,8 @@ public:
 /// [GNU]     restrict
 ///
 Parser::TPResult
-Parser::isCXXDeclarationSpecifier(Parser::TPResult BracedCastResult,
-                                  bool *InvalidAsDeclSpec) {
+Parser::isCXXDeclarationSpecifierImpl(Parser::TPResult BracedCastResult,
+                                      bool *InvalidAsDeclSpec) {
   switch (Tok.getKind()) {
   case tok::identifier: {
     // Check for need to substitute AltiVec __vector keyword
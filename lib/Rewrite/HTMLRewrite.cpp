@@ -16,6 +16,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/TokenConcatenation.h"
 #include "clang/Rewrite/Core/Rewriter.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -23,6 +24,39 @@
 #include <memory>
 using namespace clang;
 
+/// RelexRewriteCache - A recording of the highlight operations that
+/// SyntaxHighlight() and HighlightMacros() performed for a given FileID, so
+/// that later rewrites of the same file can replay them instead of re-lexing
+/// (and, for macro highlighting, re-preprocessing) the whole file.  The
+/// recorded operations mirror the arguments of the two HighlightRange()
+/// overloads, which are the only ways these passes touch the buffer.
+namespace clang {
+namespace html {
+class RelexRewriteCache {
+public:
+  /// A HighlightRange() call made on decomposed file offsets.
+  struct RawHighlight {
+    unsigned B, E;
+    std::string StartTag, EndTag;
+  };
+
+  /// A HighlightRange() call made on source locations.
+  struct Highlight {
+    SourceLocation B, E;
+    std::string StartTag, EndTag;
+    bool IsTokenRange;
+  };
+
+  // These lists are rarely small, so use std::vector over SmallVector.
+  llvm::DenseMap<FileID, std::vector<RawHighlight>> SyntaxHighlights;
+  llvm::DenseMap<FileID, std::vector<Highlight>> MacroHighlights;
+};
+} // namespace html
+} // namespace clang
+
+html::RelexRewriteCacheRef html::instantiateRelexRewriteCache() {
+  return std::make_shared<RelexRewriteCache>();
+}
 
 /// HighlightRange - Highlight a range in the source code with the specified
 /// start/end tags.  B/E must be in the same file.  This ensures that
@@ -441,13 +475,35 @@ input.spoilerhider:checked + label + .spoiler{
 /// information about keywords, macro expansions etc.  This uses the macro
 /// table state from the end of the file, so it won't be perfectly perfect,
 /// but it will be reasonably close.
-void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
+void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP,
+                           RelexRewriteCacheRef Cache) {
   RewriteBuffer &RB = R.getEditBuffer(FID);
 
   const SourceManager &SM = PP.getSourceManager();
   const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
+  const char *BufferStart = FromFile->getBuffer().data();
+
+  // If we highlighted this file before, replay the recorded operations
+  // instead of re-lexing it; the highlights depend only on the file contents.
+  if (Cache) {
+    auto CacheIt = Cache->SyntaxHighlights.find(FID);
+    if (CacheIt != Cache->SyntaxHighlights.end()) {
+      for (const RelexRewriteCache::RawHighlight &H : CacheIt->second)
+        HighlightRange(RB, H.B, H.E, BufferStart, H.StartTag.data(),
+                       H.EndTag.data());
+      return;
+    }
+  }
+
+  // Highlight the range now, and record the operation if we are caching.
+  auto DoHighlight = [&](unsigned B, unsigned E, const char *StartTag,
+                         const char *EndTag) {
+    HighlightRange(RB, B, E, BufferStart, StartTag, EndTag);
+    if (Cache)
+      Cache->SyntaxHighlights[FID].push_back({B, E, StartTag, EndTag});
+  };
+
   Lexer L(FID, FromFile, SM, PP.getLangOpts());
-  const char *BufferStart = L.getBuffer().data();
 
   // Inform the preprocessor that we want to retain comments as tokens, so we
   // can highlight them.
@@ -474,13 +530,13 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
 
       // If this is a pp-identifier, for a keyword, highlight it as such.
       if (Tok.isNot(tok::identifier))
-        HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                       "<span class='keyword'>", "</span>");
+        DoHighlight(TokOffs, TokOffs + TokLen, "<span class='keyword'>",
+                    "</span>");
       break;
     }
     case tok::comment:
-      HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                     "<span class='comment'>", "</span>");
+      DoHighlight(TokOffs, TokOffs + TokLen, "<span class='comment'>",
+                  "</span>");
       break;
     case tok::utf8_string_literal:
       // Chop off the u part of u8 prefix
@@ -497,8 +553,8 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
       LLVM_FALLTHROUGH;
     case tok::string_literal:
       // FIXME: Exclude the optional ud-suffix from the highlighted range.
-      HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                     "<span class='string_literal'>", "</span>");
+      DoHighlight(TokOffs, TokOffs + TokLen, "<span class='string_literal'>",
+                  "</span>");
       break;
     case tok::hash: {
       // If this is a preprocessor directive, all tokens to end of line are too.
@@ -515,8 +571,7 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
       }
 
       // Find end of line.  This is a hack.
-      HighlightRange(RB, TokOffs, TokEnd, BufferStart,
-                     "<span class='directive'>", "</span>");
+      DoHighlight(TokOffs, TokEnd, "<span class='directive'>", "</span>");
 
       // Don't skip the next token.
       continue;
@@ -525,15 +580,36 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
 
     L.LexFromRawLexer(Tok);
   }
+
+  // Make sure a cache entry exists even when nothing was highlighted, so that
+  // the next rewrite of this file does not re-lex it.
+  if (Cache)
+    (void)Cache->SyntaxHighlights[FID];
 }
 
 /// HighlightMacros - This uses the macro table state from the end of the
 /// file, to re-expand macros and insert (into the HTML) information about the
 /// macro expansions.  This won't be perfectly perfect, but it will be
 /// reasonably close.
-void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP) {
-  // Re-lex the raw token stream into a token buffer.
+void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor &PP,
+                           RelexRewriteCacheRef Cache) {
   const SourceManager &SM = PP.getSourceManager();
+
+  // Replaying recorded expansions is much cheaper than re-preprocessing the
+  // file, and the result is identical: macro expansion at the end of the
+  // translation unit depends only on the file contents and the final macro
+  // table, both of which are fixed by now.
+  if (Cache) {
+    auto CacheIt = Cache->MacroHighlights.find(FID);
+    if (CacheIt != Cache->MacroHighlights.end()) {
+      for (const RelexRewriteCache::Highlight &H : CacheIt->second)
+        HighlightRange(R, H.B, H.E, H.StartTag.data(), H.EndTag.data(),
+                       H.IsTokenRange);
+      return;
+    }
+  }
+
+  // Re-lex the raw token stream into a token buffer.
   std::vector<Token> TokenStream;
 
   const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
@@ -660,9 +736,19 @@ void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP) {
 
     HighlightRange(R, LLoc.getBegin(), LLoc.getEnd(), "<span class='macro'>",
                    Expansion.c_str(), LLoc.isTokenRange());
+
+    if (Cache)
+      Cache->MacroHighlights[FID].push_back({LLoc.getBegin(), LLoc.getEnd(),
+                                             "<span class='macro'>", Expansion,
+                                             LLoc.isTokenRange()});
   }
 
   // Restore the preprocessor's old state.
   TmpPP.setDiagnostics(*OldDiags);
   TmpPP.setPragmasEnabled(PragmasPreviouslyEnabled);
+
+  // Make sure a cache entry exists even when the file expanded no macros, so
+  // that the next rewrite of this file does not re-preprocess it.
+  if (Cache)
+    (void)Cache->MacroHighlights[FID];
 }
@@ -116,6 +116,11 @@ namespace {
     /// node is returned and must be inserted into a parent.
     RopePieceBTreeNode *insert(unsigned Offset, const RopePiece &R);
 
+    /// coalesce - Try to absorb R by growing a piece adjacent to Offset that
+    /// covers the bytes right before R in the same buffer.  Returns true if R
+    /// was absorbed, in which case no separate insertion is needed.
+    bool coalesce(unsigned Offset, const RopePiece &R);
+
     /// erase - Remove NumBytes from this node at the specified offset.  We are
     /// guaranteed that there is a split at Offset.
     void erase(unsigned Offset, unsigned NumBytes);
@@ -216,6 +221,9 @@ namespace {
     /// node is returned and must be inserted into a parent.
     RopePieceBTreeNode *insert(unsigned Offset, const RopePiece &R);
 
+    /// coalesce - Try to absorb R into a piece adjacent to Offset.
+    bool coalesce(unsigned Offset, const RopePiece &R);
+
     /// erase - Remove NumBytes from this node at the specified offset.  We are
     /// guaranteed that there is a split at Offset.
     void erase(unsigned Offset, unsigned NumBytes);
@@ -332,6 +340,44 @@ RopePieceBTreeNode *RopePieceBTreeLeaf::insert(unsigned Offset,
   return NewNode;
 }
 
+/// coalesce - Try to absorb R by growing a piece adjacent to Offset that
+/// covers the bytes right before R in the same buffer.  Sequential edits
+/// produce exactly this pattern - MakeRopeString hands out contiguous ranges
+/// of a shared allocation - and without coalescing a heavy rewrite run
+/// fragments the rope into one piece per edit.
+bool RopePieceBTreeLeaf::coalesce(unsigned Offset, const RopePiece &R) {
+  if (Offset == 0 || getNumPieces() == 0)
+    return false;
+
+  // Find the piece boundary at Offset, if there is one.
+  unsigned i = 0, SlotOffs = 0;
+  for (; Offset > SlotOffs; ++i)
+    SlotOffs += getPiece(i).size();
+  if (SlotOffs != Offset)
+    return false; // Offset lands in the middle of a piece.
+
+  // Extend the piece ending at Offset if R continues its buffer.
+  RopePiece &Prev = Pieces[i-1];
+  if (Prev.StrData == R.StrData && Prev.EndOffs == R.StartOffs) {
+    Prev.EndOffs = R.EndOffs;
+    Size += R.size();
+    return true;
+  }
+
+  // Otherwise, prepend to the piece starting at Offset if R ends right where
+  // it begins.
+  if (i != getNumPieces()) {
+    RopePiece &Next = Pieces[i];
+    if (Next.StrData == R.StrData && Next.StartOffs == R.EndOffs) {
+      Next.StartOffs = R.StartOffs;
+      Size += R.size();
+      return true;
+    }
+  }
+
+  return false;
+}
+
 /// erase - Remove NumBytes from this node at the specified offset.  We are
 /// guaranteed that there is a split at Offset.
 void RopePieceBTreeLeaf::erase(unsigned Offset, unsigned NumBytes) {
@@ -453,6 +499,9 @@ namespace {
     /// node is returned and must be inserted into a parent.
     RopePieceBTreeNode *insert(unsigned Offset, const RopePiece &R);
 
+    /// coalesce - Try to absorb R into a piece adjacent to Offset.
+    bool coalesce(unsigned Offset, const RopePiece &R);
+
     /// HandleChildPiece - A child propagated an insertion result up to us.
     /// Insert the new child, and/or propagate the result further up the tree.
     RopePieceBTreeNode *HandleChildPiece(unsigned i, RopePieceBTreeNode *RHS);
@@ -525,6 +574,23 @@ RopePieceBTreeNode *RopePieceBTreeInterior::insert(unsigned Offset,
   return nullptr;
 }
 
+/// coalesce - Try to absorb R into a piece adjacent to Offset.
+bool RopePieceBTreeInterior::coalesce(unsigned Offset, const RopePiece &R) {
+  // Descend into the child covering Offset, biasing towards the left child
+  // at a boundary so that the piece ending at Offset is in scope.
+  unsigned i = 0, e = getNumChildren();
+  for (; i != e && Offset > getChild(i)->size(); ++i)
+    Offset -= getChild(i)->size();
+  if (i == e)
+    return false;
+
+  if (!getChild(i)->coalesce(Offset, R))
+    return false;
+
+  Size += R.size();
+  return true;
+}
+
 /// HandleChildPiece - A child propagated an insertion result up to us.
 /// Insert the new child, and/or propagate the result further up the tree.
 RopePieceBTreeNode *
@@ -651,6 +717,14 @@ RopePieceBTreeNode *RopePieceBTreeNode::insert(unsigned Offset,
   return cast<RopePieceBTreeInterior>(this)->insert(Offset, R);
 }
 
+/// coalesce - Try to absorb R into a piece adjacent to Offset.
+bool RopePieceBTreeNode::coalesce(unsigned Offset, const RopePiece &R) {
+  assert(Offset <= size() && "Invalid offset to coalesce!");
+  if (auto *Leaf = dyn_cast<RopePieceBTreeLeaf>(this))
+    return Leaf->coalesce(Offset, R);
+  return cast<RopePieceBTreeInterior>(this)->coalesce(Offset, R);
+}
+
 /// erase - Remove NumBytes from this node at the specified offset.  We are
 /// guaranteed that there is a split at Offset.
 void RopePieceBTreeNode::erase(unsigned Offset, unsigned NumBytes) {
@@ -745,6 +819,13 @@ void RopePieceBTree::clear() {
 }
 
 void RopePieceBTree::insert(unsigned Offset, const RopePiece &R) {
+  // #0. If the new piece picks up exactly where a piece adjacent to Offset
+  // left off in the same buffer, grow that piece in place instead of adding
+  // another one.  This is done before splitting, which would otherwise cut a
+  // piece apart just to wedge the new one between the halves.
+  if (getRoot(Root)->coalesce(Offset, R))
+    return;
+
   // #1. Split at Offset.
   if (RopePieceBTreeNode *RHS = getRoot(Root)->split(Offset))
     Root = new RopePieceBTreeInterior(getRoot(Root), RHS);
@@ -15169,7 +15169,10 @@ void Sema::MarkFunctionReferenced(SourceLocation Loc, FunctionDecl *Func,
           // expression evaluator needing to call back into Sema if it sees a
           // call to such a function.
           InstantiateFunctionDefinition(PointOfInstantiation, Func);
-        else {
+        else if (!Func->instantiationIsPending()) {
+          // An explicit instantiation definition passes the check above at
+          // every use; one queue entry is enough to instantiate the
+          // definition at the end of the TU.
           Func->setInstantiationIsPending(true);
           PendingInstantiations.push_back(
               std::make_pair(Func, PointOfInstantiation));
@@ -41,6 +41,7 @@
 #include "llvm/ADT/edit_distance.h"
 #include "llvm/Support/ErrorHandling.h"
 #include <algorithm>
+#include <chrono>
 #include <iterator>
 #include <list>
 #include <set>
@@ -2048,6 +2049,64 @@ static bool LookupQualifiedNameInUsingDirectives(Sema &S, LookupResult &R,
   return Found;
 }
 
+/// Perform the using-directive walk for \p R through the memo of earlier
+/// walks, replaying a stored outcome instead of re-walking the graph when
+/// the memo's validity stamps still hold.
+bool Sema::LookupInUsingDirectivesMemoized(LookupResult &R,
+                                           DeclContext *StartDC) {
+  // Lookups that may see hidden declarations depend on more state than the
+  // generation counters validate; compute them directly. Results that were
+  // accumulated by the caller would leak into the memo, so skip those too.
+  if (R.isAllowingHiddenDeclarations() || !R.empty())
+    return LookupQualifiedNameInUsingDirectives(*this, R, StartDC);
+
+  std::pair<DeclContext *, DeclarationName> Key(StartDC->getPrimaryContext(),
+                                                R.getLookupName());
+  auto Known = UsingDirectiveLookupCache.find(Key);
+  if (Known != UsingDirectiveLookupCache.end()) {
+    const UsingDirectiveLookupMemo &Memo = Known->second;
+    if (Memo.DeclGeneration == Context.getQualifiedLookupGeneration() &&
+        Memo.ModuleGeneration == VisibleModules.getGeneration() &&
+        Memo.Kind == R.getLookupKind() &&
+        Memo.TemplateNameLookup == R.isTemplateNameLookup() &&
+        Memo.HideTags == R.isHidingTags()) {
+      if (!Memo.Found)
+        return false;
+      // Replay the walk's additions; resolveKind is deterministic over the
+      // set it already filtered once.
+      for (DeclAccessPair DAP : Memo.Decls)
+        R.addDecl(DAP.getDecl(), DAP.getAccess());
+      if (Memo.AmbiguousTagHiding)
+        R.setAmbiguousQualifiedTagHiding();
+      else
+        R.resolveKind();
+      return true;
+    }
+  }
+
+  bool Found = LookupQualifiedNameInUsingDirectives(*this, R, StartDC);
+
+  // Stamp the generations only now: the walk itself may have built lookup
+  // tables or pulled in external declarations, which bumps them.
+  UsingDirectiveLookupMemo &Memo = UsingDirectiveLookupCache[Key];
+  Memo.DeclGeneration = Context.getQualifiedLookupGeneration();
+  Memo.ModuleGeneration = VisibleModules.getGeneration();
+  Memo.Kind = R.getLookupKind();
+  Memo.TemplateNameLookup = R.isTemplateNameLookup();
+  Memo.HideTags = R.isHidingTags();
+  Memo.Found = Found;
+  Memo.AmbiguousTagHiding =
+      Found && R.isAmbiguous() &&
+      R.getAmbiguityKind() == LookupResult::AmbiguousTagHiding;
+  Memo.Decls.clear();
+  if (Found)
+    for (UnresolvedSetIterator I = R.asUnresolvedSet().begin(),
+                               E = R.asUnresolvedSet().end();
+         I != E; ++I)
+      Memo.Decls.push_back(I.getPair());
+  return Found;
+}
+
 /// Callback that looks for any member of a class with the given name.
 static bool LookupAnyMember(const CXXBaseSpecifier *Specifier,
                             CXXBasePath &Path, DeclarationName Name) {
@@ -2158,7 +2217,7 @@ bool Sema::LookupQualifiedName(LookupResult &R, DeclContext *LookupCtx,
 
   // If this is a namespace, look it up in the implied namespaces.
   if (LookupCtx->isFileContext())
-    return LookupQualifiedNameInUsingDirectives(*this, R, LookupCtx);
+    return LookupInUsingDirectivesMemoized(R, LookupCtx);
 
   // If this isn't a C++ class, we aren't allowed to look into base
   // classes, we're done.
@@ -4676,6 +4735,28 @@ static void AddKeywordsToConsumer(Sema &SemaRef,
   }
 }
 
+namespace {
+
+/// RAII object that accounts the wall-clock time spent building a typo
+/// correction consumer toward the per-TU spell checking budget.
+class TypoCorrectionTimer {
+  Sema &SemaRef;
+  std::chrono::steady_clock::time_point Start;
+
+public:
+  TypoCorrectionTimer(Sema &SemaRef)
+      : SemaRef(SemaRef), Start(std::chrono::steady_clock::now()) {}
+
+  ~TypoCorrectionTimer() {
+    SemaRef.TypoCorrectionMicros +=
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - Start)
+            .count();
+  }
+};
+
+} // namespace
+
 std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
     const DeclarationNameInfo &TypoName, Sema::LookupNameKind LookupKind,
     Scope *S, CXXScopeSpec *SS, CorrectionCandidateCallback &CCC,
@@ -4729,8 +4810,21 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
   unsigned Limit = getDiagnostics().getDiagnosticOptions().SpellCheckingLimit;
   if (Limit && TyposCorrected >= Limit)
     return nullptr;
+
+  // Likewise bound the total time spent enumerating and scoring correction
+  // candidates: in a TU with many visible identifiers a single correction can
+  // take a long time, and failing parses attempt many of them. Once the
+  // budget is spent, diagnostics are still emitted, just without suggestions.
+  unsigned BudgetMS =
+      getDiagnostics().getDiagnosticOptions().SpellCheckingBudget;
+  if (BudgetMS && TypoCorrectionMicros / 1000 >= BudgetMS)
+    return nullptr;
   ++TyposCorrected;
 
+  // Everything below walks candidate sets whose size scales with the whole
+  // TU, so it all counts toward the spell checking budget.
+  TypoCorrectionTimer Timer(*this);
+
   // If we're handling a missing symbol error, using modules, and the
   // special search all modules option is used, look for a missing import.
   if (ErrorRecovery && getLangOpts().Modules &&
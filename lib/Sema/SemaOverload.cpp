@@ -6050,9 +6050,22 @@ void Sema::AddOverloadCandidate(
   EnterExpressionEvaluationContext Unevaluated(
       *this, Sema::ExpressionEvaluationContext::Unevaluated);
 
+  // Arity mismatches are by far the most common reason a candidate is not
+  // viable in operator-heavy code, and neither their diagnosis nor their
+  // display ordering ever looks at conversion sequences. Detect them up
+  // front so the candidate is recorded without allocating one conversion
+  // slot per argument.
+  unsigned NumParams = Proto->getNumParams();
+  const bool ArityMismatch =
+      EarlyConversions.empty() &&
+      ((TooManyArguments(NumParams, Args.size(), PartialOverloading) &&
+        !Proto->isVariadic()) ||
+       (Args.size() < Function->getMinRequiredArguments() &&
+        !PartialOverloading));
+
   // Add this candidate
-  OverloadCandidate &Candidate =
-      CandidateSet.addCandidate(Args.size(), EarlyConversions);
+  OverloadCandidate &Candidate = CandidateSet.addCandidate(
+      ArityMismatch ? 0 : Args.size(), EarlyConversions);
   Candidate.FoundDecl = FoundDecl;
   Candidate.Function = Function;
   Candidate.Viable = true;
@@ -6114,8 +6127,6 @@ void Sema::AddOverloadCandidate(
     }
   }
 
-  unsigned NumParams = Proto->getNumParams();
-
   // (C++ 13.3.2p2): A candidate function having fewer than m
   // parameters is viable only if it has an ellipsis in its parameter
   // list (8.3.5).
@@ -6600,17 +6611,25 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
   EnterExpressionEvaluationContext Unevaluated(
       *this, Sema::ExpressionEvaluationContext::Unevaluated);
 
+  // As in AddOverloadCandidate, record arity mismatches without allocating
+  // conversion slots; nothing ever reads them for such candidates.
+  unsigned NumParams = Proto->getNumParams();
+  const bool ArityMismatch =
+      EarlyConversions.empty() &&
+      ((TooManyArguments(NumParams, Args.size(), PartialOverloading) &&
+        !Proto->isVariadic()) ||
+       (Args.size() < Method->getMinRequiredArguments() &&
+        !PartialOverloading));
+
   // Add this candidate
-  OverloadCandidate &Candidate =
-      CandidateSet.addCandidate(Args.size() + 1, EarlyConversions);
+  OverloadCandidate &Candidate = CandidateSet.addCandidate(
+      ArityMismatch ? 0 : Args.size() + 1, EarlyConversions);
   Candidate.FoundDecl = FoundDecl;
   Candidate.Function = Method;
   Candidate.IsSurrogate = false;
   Candidate.IgnoreObjectArgument = false;
   Candidate.ExplicitCallArguments = Args.size();
 
-  unsigned NumParams = Proto->getNumParams();
-
   // (C++ 13.3.2p2): A candidate function having fewer than m
   // parameters is viable only if it has an ellipsis in its parameter
   // list (8.3.5).
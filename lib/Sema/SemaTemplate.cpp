@@ -10299,8 +10299,10 @@ void Sema::MarkAsLateParsedTemplate(FunctionDecl *FD, Decl *FnD,
 
   auto LPT = llvm::make_unique<LateParsedTemplate>();
 
-  // Take tokens to avoid allocations
-  LPT->Toks.swap(Toks);
+  // Pack the tokens; the caches of a template-heavy TU far outweigh the cost
+  // of re-encoding the handful of templates that get instantiated.
+  LPT->Toks.encode(Toks);
+  Toks.clear();
   LPT->D = FnD;
   LateParsedTemplateMap.insert(std::make_pair(FD, std::move(LPT)));
 
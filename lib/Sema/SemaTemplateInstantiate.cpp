@@ -2569,6 +2569,24 @@ getPatternForClassTemplateSpecialization(
   return Pattern;
 }
 
+/// Note on cross-TU memoization: sharing completed specializations between
+/// translation units through a side cache keyed by template and argument
+/// hashes has been proposed to avoid re-instantiating the same common
+/// specializations in every TU of a build. It does not fit the
+/// serialization design. ASTReader imports whole module files whose decls
+/// reference each other by module-local IDs; an isolated specialization
+/// has no such ID space, and every type, decl and expression it mentions
+/// would need to be re-resolved against the importing TU's AST — which is
+/// exactly the identity mapping that PCH and modules already maintain, at
+/// file granularity. A hash of the template and its arguments is also not
+/// a sound key: the instantiated AST depends on the point of
+/// instantiation (visible specializations and partial specializations,
+/// default arguments, SFINAE context), so two TUs with the same key can
+/// legitimately need different results. Builds that want to pay for these
+/// instantiations once should put the explicit instantiation definitions
+/// in one TU and declarations elsewhere, or use a PCH or modules, which
+/// serialize completed specializations together with the context that
+/// makes importing them sound.
 bool Sema::InstantiateClassTemplateSpecialization(
     SourceLocation PointOfInstantiation,
     ClassTemplateSpecializationDecl *ClassTemplateSpec,
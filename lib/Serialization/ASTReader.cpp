@@ -113,6 +113,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/VersionTuple.h"
 #include "llvm/Support/raw_ostream.h"
@@ -2564,6 +2565,15 @@ ASTReader::ReadControlBlock(ModuleFile &F,
              F.Kind == MK_ImplicitModule))
           N = NumInputs;
 
+        // A PCH stamped with the current build session was built from inputs
+        // the build system promises are frozen for the whole session, so the
+        // per-file size and modification time checks cannot fire; skip them
+        // wholesale.
+        if (F.Kind == MK_PCH && HSOpts.PCHValidateOncePerBuildSession &&
+            HSOpts.BuildSessionTimestamp != 0 &&
+            F.BuildSessionTimestamp == HSOpts.BuildSessionTimestamp)
+          N = 0;
+
         for (unsigned I = 0; I < N; ++I) {
           InputFile IF = getInputFile(F, I+1, Complain);
           if (!IF.getFile() || IF.isOutOfDate())
@@ -2842,6 +2852,10 @@ ASTReader::ReadControlBlock(ModuleFile &F,
         return Result;
       break;
 
+    case BUILD_SESSION_TIMESTAMP:
+      F.BuildSessionTimestamp = Record[0];
+      break;
+
     case INPUT_FILE_OFFSETS:
       NumInputs = Record[0];
       NumUserInputs = Record[1];
@@ -3597,6 +3611,21 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       }
       break;
 
+    case RECORD_LAYOUTS:
+      for (unsigned I = 0, N = Record.size(); I != N;) {
+        serialization::DeclID ID = getGlobalDeclID(F, Record[I++]);
+        SerializedRecordLayout &Layout = RecordLayouts[ID];
+        Layout.Size = Record[I++];
+        Layout.Alignment = Record[I++];
+        for (uint64_t Count = Record[I++]; Count; --Count)
+          Layout.FieldOffsets.push_back(Record[I++]);
+        for (uint64_t Count = Record[I++]; Count; --Count)
+          Layout.BaseOffsets.push_back(Record[I++]);
+        for (uint64_t Count = Record[I++]; Count; --Count)
+          Layout.VirtualBaseOffsets.push_back(Record[I++]);
+      }
+      break;
+
     case IMPORTED_MODULES:
       if (!F.isModule()) {
         // If we aren't loading a module (which has its own exports), make
@@ -4091,6 +4120,38 @@ static bool SkipCursorToBlock(BitstreamCursor &Cursor, unsigned BlockID) {
   }
 }
 
+void ASTReader::startDeclPrefetch(ModuleFile &F) {
+  // Creating decls on another thread is out of the question - it mutates the
+  // ASTContext, the identifier table and Sema - but the dominant cost of the
+  // first-access storm after loading a big mmap'ed PCH is faulting in the
+  // pages behind the bitstream cursor. Touching those pages only reads the
+  // immutable file buffer, so that part can safely overlap with the client.
+  if (!llvm::llvm_is_multithreaded() || !F.DeclOffsets || !F.LocalNumDecls)
+    return;
+
+  llvm::ArrayRef<uint8_t> Bytes = F.DeclsCursor.getBitcodeBytes();
+  uint64_t Begin = Bytes.size(), End = 0;
+  for (unsigned I = 0, N = F.LocalNumDecls; I != N; ++I) {
+    uint64_t Off = F.DeclOffsets[I].BitOffset / 8;
+    Begin = std::min(Begin, Off);
+    End = std::max(End, Off);
+  }
+  End = std::min<uint64_t>(End + 1, Bytes.size());
+
+  // Not worth a thread unless the records span a fair number of pages.
+  const uint64_t PageSize = 4096;
+  if (Begin >= End || End - Begin < 16 * PageSize)
+    return;
+
+  DeclPrefetchThreads.emplace_back([Bytes, Begin, End, PageSize] {
+    // The volatile sink keeps the loads from being optimized away.
+    volatile uint8_t Sink = 0;
+    for (uint64_t Off = Begin; Off < End; Off += PageSize)
+      Sink = Bytes[Off];
+    (void)Sink;
+  });
+}
+
 ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
                                             ModuleKind Type,
                                             SourceLocation ImportLoc,
@@ -4323,6 +4384,11 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
     }
   }
 
+  // Fault in the pages spanned by each new file's decl records in the
+  // background while the caller proceeds and deserializes on demand.
+  for (const ImportedModule &M : Loaded)
+    startDeclPrefetch(*M.Mod);
+
   return Success;
 }
 
@@ -7576,6 +7642,56 @@ void ASTReader::CompleteRedeclChain(const Decl *D) {
   }
 }
 
+bool ASTReader::layoutRecordType(
+    const RecordDecl *Record, uint64_t &Size, uint64_t &Alignment,
+    llvm::DenseMap<const FieldDecl *, uint64_t> &FieldOffsets,
+    llvm::DenseMap<const CXXRecordDecl *, CharUnits> &BaseOffsets,
+    llvm::DenseMap<const CXXRecordDecl *, CharUnits> &VirtualBaseOffsets) {
+  if (!Record->isFromASTFile())
+    return false;
+
+  auto It = RecordLayouts.find(Record->getGlobalID());
+  if (It == RecordLayouts.end())
+    return false;
+  const SerializedRecordLayout &Layout = It->second;
+
+  // The record layout builder requires offsets for every field; treat an
+  // entry that does not line up with the redeclaration we are asked about
+  // as if it was never stored.
+  unsigned FieldIdx = 0;
+  for (const FieldDecl *FD : Record->fields()) {
+    if (FieldIdx == Layout.FieldOffsets.size())
+      return false;
+    FieldOffsets[FD] = Layout.FieldOffsets[FieldIdx++];
+  }
+  if (FieldIdx != Layout.FieldOffsets.size())
+    return false;
+
+  if (const auto *CXXRD = dyn_cast<CXXRecordDecl>(Record)) {
+    unsigned BaseIdx = 0;
+    for (const CXXBaseSpecifier &Base : CXXRD->bases()) {
+      if (Base.isVirtual())
+        continue;
+      if (BaseIdx == Layout.BaseOffsets.size())
+        return false;
+      BaseOffsets[Base.getType()->getAsCXXRecordDecl()] =
+          CharUnits::fromQuantity(Layout.BaseOffsets[BaseIdx++]);
+    }
+
+    unsigned VBaseIdx = 0;
+    for (const CXXBaseSpecifier &Base : CXXRD->vbases()) {
+      if (VBaseIdx == Layout.VirtualBaseOffsets.size())
+        return false;
+      VirtualBaseOffsets[Base.getType()->getAsCXXRecordDecl()] =
+          CharUnits::fromQuantity(Layout.VirtualBaseOffsets[VBaseIdx++]);
+    }
+  }
+
+  Size = Layout.Size;
+  Alignment = Layout.Alignment;
+  return true;
+}
+
 CXXCtorInitializer **
 ASTReader::GetExternalCXXCtorInitializers(uint64_t Offset) {
   RecordLocation Loc = getLocalBitOffset(Offset);
@@ -8723,9 +8839,11 @@ void ASTReader::ReadLateParsedTemplates(
     assert(F && "No module");
 
     unsigned TokN = LateParsedTemplates[Idx++];
-    LT->Toks.reserve(TokN);
+    CachedTokens Toks;
+    Toks.reserve(TokN);
     for (unsigned T = 0; T < TokN; ++T)
-      LT->Toks.push_back(ReadToken(*F, LateParsedTemplates, Idx));
+      Toks.push_back(ReadToken(*F, LateParsedTemplates, Idx));
+    LT->Toks.encode(Toks);
 
     LPTMap.insert(std::make_pair(FD, std::move(LT)));
   }
@@ -12165,6 +12283,9 @@ ASTReader::ASTReader(Preprocessor &PP, InMemoryModuleCache &ModuleCache,
 }
 
 ASTReader::~ASTReader() {
+  for (std::thread &T : DeclPrefetchThreads)
+    T.join();
+
   if (OwnsDeserializationListener)
     delete DeserializationListener;
 }
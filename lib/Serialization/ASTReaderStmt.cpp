@@ -55,6 +55,7 @@
 #include "llvm/Bitstream/BitstreamReader.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/SaveAndRestore.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
@@ -2385,6 +2386,12 @@ Stmt *ASTReader::ReadStmtFromStream(ModuleFile &F) {
   ReadingKindTracker ReadingKind(Read_Stmt, *this);
   llvm::BitstreamCursor &Cursor = F.DeclsCursor;
 
+  // Statement records delta-encode their source locations (see
+  // ASTRecordWriter::FlushStmts). Every stream starts a fresh chain, and
+  // reading a nested declaration below may recurse into another stream, so
+  // save the chain of the enclosing stream across this read.
+  llvm::SaveAndRestore<uint32_t> StmtLocChain(LastStmtStreamLoc, 0);
+
   // Map of offset to previously deserialized stmt. The offset points
   // just after the stmt record.
   llvm::DenseMap<uint64_t, Stmt *> StmtEntries;
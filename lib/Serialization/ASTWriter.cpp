@@ -30,6 +30,7 @@
 #include "clang/AST/LambdaCapture.h"
 #include "clang/AST/NestedNameSpecifier.h"
 #include "clang/AST/RawCommentList.h"
+#include "clang/AST/RecordLayout.h"
 #include "clang/AST/TemplateName.h"
 #include "clang/AST/Type.h"
 #include "clang/AST/TypeLocVisitor.h"
@@ -1088,6 +1089,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(ORIGINAL_PCH_DIR);
   RECORD(ORIGINAL_FILE_ID);
   RECORD(INPUT_FILE_OFFSETS);
+  RECORD(BUILD_SESSION_TIMESTAMP);
 
   BLOCK(OPTIONS_BLOCK);
   RECORD(LANGUAGE_OPTIONS);
@@ -1153,6 +1155,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(DELETE_EXPRS_TO_ANALYZE);
   RECORD(CUDA_PRAGMA_FORCE_HOST_DEVICE_DEPTH);
   RECORD(PP_CONDITIONAL_STACK);
+  RECORD(RECORD_LAYOUTS);
 
   // SourceManager Block.
   BLOCK(SOURCE_MANAGER_BLOCK);
@@ -1531,6 +1534,20 @@ void ASTWriter::WriteControlBlock(Preprocessor &PP, ASTContext &Context,
     BaseDirectory = isysroot;
   }
 
+  // Stamp PCH files with the build session, so that a later load within the
+  // same session can skip input-file validation. Module files are not
+  // stamped: they have their own once-per-session validation scheme, and a
+  // per-session timestamp would perturb the signature of implicitly built
+  // modules.
+  if (!WritingModule) {
+    uint64_t SessionTimestamp =
+        PP.getHeaderSearchInfo().getHeaderSearchOpts().BuildSessionTimestamp;
+    if (SessionTimestamp != 0) {
+      RecordData::value_type Record[] = {SessionTimestamp};
+      Stream.EmitRecord(BUILD_SESSION_TIMESTAMP, Record);
+    }
+  }
+
   // Module map file
   if (WritingModule && WritingModule->Kind == Module::ModuleMapModule) {
     Record.clear();
@@ -3278,6 +3295,60 @@ void ASTWriter::WriteComments() {
   }
 }
 
+void ASTWriter::WriteRecordLayouts(ASTContext &Context) {
+  RecordData Record;
+  for (const auto &Entry : Context.ASTRecordLayouts) {
+    const RecordDecl *RD = Entry.first;
+    if (RD->isInvalidDecl() || !RD->isCompleteDefinition())
+      continue;
+
+    // Only write layouts of records this AST file knows; referencing other
+    // declarations here would force their emission.
+    auto IDI = DeclIDs.find(RD);
+    if (IDI == DeclIDs.end())
+      continue;
+
+    const ASTRecordLayout &Layout = *Entry.second;
+    Record.push_back(IDI->second);
+    Record.push_back(Context.toBits(Layout.getSize()));
+    Record.push_back(Context.toBits(Layout.getAlignment()));
+
+    Record.push_back(Layout.getFieldCount());
+    for (unsigned I = 0, N = Layout.getFieldCount(); I != N; ++I)
+      Record.push_back(Layout.getFieldOffset(I));
+
+    const auto *CXXRD = dyn_cast<CXXRecordDecl>(RD);
+    if (!CXXRD) {
+      Record.push_back(0);
+      Record.push_back(0);
+      continue;
+    }
+
+    // Base offsets follow the order of the base specifiers, so that the
+    // reader does not have to name the base classes.
+    unsigned NumBases = 0;
+    for (const CXXBaseSpecifier &Base : CXXRD->bases())
+      if (!Base.isVirtual())
+        ++NumBases;
+    Record.push_back(NumBases);
+    for (const CXXBaseSpecifier &Base : CXXRD->bases()) {
+      if (Base.isVirtual())
+        continue;
+      const auto *BaseDecl = Base.getType()->getAsCXXRecordDecl();
+      Record.push_back(Layout.getBaseClassOffset(BaseDecl).getQuantity());
+    }
+
+    Record.push_back(CXXRD->getNumVBases());
+    for (const CXXBaseSpecifier &Base : CXXRD->vbases()) {
+      const auto *BaseDecl = Base.getType()->getAsCXXRecordDecl();
+      Record.push_back(Layout.getVBaseClassOffset(BaseDecl).getQuantity());
+    }
+  }
+
+  if (!Record.empty())
+    Stream.EmitRecord(RECORD_LAYOUTS, Record);
+}
+
 //===----------------------------------------------------------------------===//
 // Global Method Pool and Selector Serialization
 //===----------------------------------------------------------------------===//
@@ -4422,9 +4493,12 @@ void ASTWriter::WriteLateParsedTemplates(Sema &SemaRef) {
     LateParsedTemplate &LPT = *LPTMapEntry.second;
     AddDeclRef(FD, Record);
     AddDeclRef(LPT.D, Record);
-    Record.push_back(LPT.Toks.size());
 
-    for (const auto &Tok : LPT.Toks) {
+    CachedTokens Toks;
+    LPT.Toks.decode(Toks);
+    Record.push_back(Toks.size());
+
+    for (const auto &Tok : Toks) {
       AddToken(Tok, Record);
     }
   }
@@ -5135,6 +5209,10 @@ ASTFileSignature ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
   if (!DeleteExprsToAnalyze.empty())
     Stream.EmitRecord(DELETE_EXPRS_TO_ANALYZE, DeleteExprsToAnalyze);
 
+  // Write the layouts computed for the records in this AST file, so readers
+  // do not have to recompute them.
+  WriteRecordLayouts(Context);
+
   // Write the visible updates to DeclContexts.
   for (auto *DC : UpdatedDeclContexts)
     WriteDeclContextVisibleUpdate(DC);
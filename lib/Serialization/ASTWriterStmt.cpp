@@ -2391,7 +2391,13 @@ void ASTRecordWriter::FlushStmts() {
   assert(Writer->SubStmtEntries.empty() && "unexpected entries in sub-stmt map");
   assert(Writer->ParentStmts.empty() && "unexpected entries in parent stmt map");
 
+  // Statement records delta-encode their source locations. Each top-level
+  // statement starts a fresh chain, mirroring the reset the reader performs
+  // for every stream it reads (see ASTReader::ReadStmtFromStream).
+  Writer->WritingStmtStream = true;
+
   for (unsigned I = 0, N = StmtsToEmit.size(); I != N; ++I) {
+    Writer->LastStmtStreamLoc = 0;
     Writer->WriteSubStmt(StmtsToEmit[I]);
 
     assert(N == StmtsToEmit.size() && "record modified while being written!");
@@ -2405,6 +2411,7 @@ void ASTRecordWriter::FlushStmts() {
     Writer->ParentStmts.clear();
   }
 
+  Writer->WritingStmtStream = false;
   StmtsToEmit.clear();
 }
 
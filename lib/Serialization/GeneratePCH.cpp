@@ -57,6 +57,13 @@ void PCHGenerator::HandleTranslationUnit(ASTContext &Ctx) {
     }
   }
 
+  // The bitstream accumulates in a single contiguous buffer that grows by
+  // doubling; for a large PCH every doubling re-copies hundreds of megabytes
+  // of already emitted stream. The AST's bump-allocated memory is a usable
+  // proxy for the final stream size, so reserve that up front and pay for
+  // the growth copies at most once.
+  Buffer->Data.reserve(Buffer->Data.size() + Ctx.getASTAllocatedMemory());
+
   // Emit the PCH file to the Buffer.
   assert(SemaPtr && "No Sema?");
   Buffer->Signature =
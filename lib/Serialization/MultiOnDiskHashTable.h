@@ -147,9 +147,35 @@ private:
     if (!Merged)
       Merged = new MergedTable;
 
-    // Read in all the tables and merge them together.
-    // FIXME: Be smarter about which tables we merge.
-    for (auto *ODT : tables()) {
+    // Merge only the smallest tables and keep the largest ones
+    // memory-mapped. Probing a handful of big on-disk tables per lookup is
+    // cheap, but deserializing every entry of them up front is not, and in
+    // a big table most entries are never queried.
+    llvm::SmallVector<OnDiskTable *, 16> AllTables(tables().begin(),
+                                                   tables().end());
+    llvm::SmallVector<OnDiskTable *, 16> BySize(AllTables.begin(),
+                                                AllTables.end());
+    llvm::sort(BySize, [](const OnDiskTable *LHS, const OnDiskTable *RHS) {
+      return LHS->Table.getNumEntries() < RHS->Table.getNumEntries();
+    });
+    size_t NumKept = std::min<size_t>(
+        AllTables.size(), static_cast<size_t>(Info::MaxTables) - 1);
+    size_t NumMerged = AllTables.size() - NumKept;
+    assert(NumMerged != 0 && "condensing without reducing the table count");
+    llvm::DenseSet<OnDiskTable *> TablesToMerge(BySize.begin(),
+                                                BySize.begin() + NumMerged);
+
+    Tables.clear();
+    Tables.push_back(Table(Merged).getOpaqueValue());
+
+    // Visit the tables in their original order so that the relative probe
+    // order of the kept tables does not change.
+    for (auto *ODT : AllTables) {
+      if (!TablesToMerge.count(ODT)) {
+        Tables.push_back(Table(ODT).getOpaqueValue());
+        continue;
+      }
+
       auto &HT = ODT->Table;
       Info &InfoObj = HT.getInfoObj();
 
@@ -167,9 +193,6 @@ private:
       Merged->Files.push_back(ODT->File);
       delete ODT;
     }
-
-    Tables.clear();
-    Tables.push_back(Table(Merged).getOpaqueValue());
   }
 
 public:
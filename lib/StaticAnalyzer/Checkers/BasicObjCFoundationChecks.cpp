@@ -1095,6 +1095,7 @@ ObjCLoopChecker::checkPointerEscape(ProgramStateRef State,
   SymbolRef ImmutableReceiver = getMethodReceiverIfKnownImmutable(Call);
 
   // Remove the invalidated symbols form the collection count map.
+  ProgramStateTransaction T(State);
   for (InvalidatedSymbols::const_iterator I = Escaped.begin(),
        E = Escaped.end();
        I != E; ++I) {
@@ -1109,10 +1110,10 @@ ObjCLoopChecker::checkPointerEscape(ProgramStateRef State,
 
     // The symbol escaped. Pessimistically, assume that the count could have
     // changed.
-    State = State->remove<ContainerCountMap>(Sym);
-    State = State->remove<ContainerNonEmptyMap>(Sym);
+    T.remove<ContainerCountMap>(Sym);
+    T.remove<ContainerNonEmptyMap>(Sym);
   }
-  return State;
+  return T.commit();
 }
 
 void ObjCLoopChecker::checkDeadSymbols(SymbolReaper &SymReaper,
@@ -1120,17 +1121,18 @@ void ObjCLoopChecker::checkDeadSymbols(SymbolReaper &SymReaper,
   ProgramStateRef State = C.getState();
 
   // Remove the dead symbols from the collection count map.
+  ProgramStateTransaction T(State);
   ContainerCountMapTy Tracked = State->get<ContainerCountMap>();
   for (ContainerCountMapTy::iterator I = Tracked.begin(),
                                      E = Tracked.end(); I != E; ++I) {
     SymbolRef Sym = I->first;
     if (SymReaper.isDead(Sym)) {
-      State = State->remove<ContainerCountMap>(Sym);
-      State = State->remove<ContainerNonEmptyMap>(Sym);
+      T.remove<ContainerCountMap>(Sym);
+      T.remove<ContainerNonEmptyMap>(Sym);
     }
   }
 
-  C.addTransition(State);
+  C.addTransition(T.commit());
 }
 
 namespace {
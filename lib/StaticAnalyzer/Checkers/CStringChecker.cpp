@@ -257,7 +257,50 @@ public:
 
 } //end anonymous namespace
 
-REGISTER_MAP_WITH_PROGRAMSTATE(CStringLength, const MemRegion *, SVal)
+// String lengths are keyed by the string's region and sharded by that
+// region's base region, mirroring the cluster layout of RegionStore: every
+// region on a super-region chain shares the chain's base region, so
+// invalidating a region only needs to visit the shards of the changed bases
+// instead of every tracked string in the program.
+REGISTER_MAP_FACTORY_WITH_PROGRAMSTATE(CStringLengthShard, const MemRegion *,
+                                       SVal)
+REGISTER_MAP_WITH_PROGRAMSTATE(CStringLength, const MemRegion *,
+                               CStringLengthShard)
+
+/// Look up the recorded length of \p MR in its base region's shard.
+static const SVal *getCStringLengthEntry(ProgramStateRef state,
+                                         const MemRegion *MR) {
+  const CStringLengthShard *Shard =
+      state->get<CStringLength>(MR->getBaseRegion());
+  return Shard ? Shard->lookup(MR) : nullptr;
+}
+
+/// Record the length of \p MR in its base region's shard.
+static ProgramStateRef setCStringLengthEntry(ProgramStateRef state,
+                                             const MemRegion *MR,
+                                             SVal strLength) {
+  const MemRegion *Base = MR->getBaseRegion();
+  CStringLengthShard::Factory &F = state->get_context<CStringLengthShard>();
+  const CStringLengthShard *Shard = state->get<CStringLength>(Base);
+  return state->set<CStringLength>(
+      Base, F.add(Shard ? *Shard : F.getEmptyMap(), MR, strLength));
+}
+
+/// Drop the recorded length of \p MR, removing its base region's shard
+/// entirely if this was the last entry.
+static ProgramStateRef removeCStringLengthEntry(ProgramStateRef state,
+                                                const MemRegion *MR) {
+  const MemRegion *Base = MR->getBaseRegion();
+  const CStringLengthShard *Shard = state->get<CStringLength>(Base);
+  if (!Shard)
+    return state;
+
+  CStringLengthShard::Factory &F = state->get_context<CStringLengthShard>();
+  CStringLengthShard NewShard = F.remove(*Shard, MR);
+  if (NewShard.isEmpty())
+    return state->remove<CStringLength>(Base);
+  return state->set<CStringLength>(Base, NewShard);
+}
 
 //===----------------------------------------------------------------------===//
 // Individual checks and utility methods.
@@ -739,9 +782,9 @@ ProgramStateRef CStringChecker::setCStringLength(ProgramStateRef state,
   }
 
   if (strLength.isUnknown())
-    return state->remove<CStringLength>(MR);
+    return removeCStringLengthEntry(state, MR);
 
-  return state->set<CStringLength>(MR, strLength);
+  return setCStringLengthEntry(state, MR, strLength);
 }
 
 SVal CStringChecker::getCStringLengthForRegion(CheckerContext &C,
@@ -751,7 +794,7 @@ SVal CStringChecker::getCStringLengthForRegion(CheckerContext &C,
                                                bool hypothetical) {
   if (!hypothetical) {
     // If there's a recorded length, go ahead and return it.
-    const SVal *Recorded = state->get<CStringLength>(MR);
+    const SVal *Recorded = getCStringLengthEntry(state, MR);
     if (Recorded)
       return *Recorded;
   }
@@ -777,7 +820,7 @@ SVal CStringChecker::getCStringLengthForRegion(CheckerContext &C,
                                                 maxLength, sizeTy);
       state = state->assume(evalLength.castAs<DefinedOrUnknownSVal>(), true);
     }
-    state = state->set<CStringLength>(MR, strLength);
+    state = setCStringLengthEntry(state, MR, strLength);
   }
 
   return strLength;
@@ -2295,7 +2338,7 @@ void CStringChecker::checkPreStmt(const DeclStmt *DS, CheckerContext &C) const {
     DefinedOrUnknownSVal strLength =
       getCStringLength(C, state, Init, StrVal).castAs<DefinedOrUnknownSVal>();
 
-    state = state->set<CStringLength>(MR, strLength);
+    state = setCStringLengthEntry(state, MR, strLength);
   }
 
   C.addTransition(state);
@@ -2314,12 +2357,20 @@ CStringChecker::checkRegionChanges(ProgramStateRef state,
 
   llvm::SmallPtrSet<const MemRegion *, 8> Invalidated;
   llvm::SmallPtrSet<const MemRegion *, 32> SuperRegions;
+  llvm::SmallPtrSet<const MemRegion *, 8> Bases;
+  llvm::SmallPtrSet<const MemRegion *, 4> Spaces;
 
-  // First build sets for the changed regions and their super-regions.
+  // First build sets for the changed regions and their super-regions, and
+  // collect the base regions (and whole memory spaces) whose shards may be
+  // affected.
   for (ArrayRef<const MemRegion *>::iterator
       I = Regions.begin(), E = Regions.end(); I != E; ++I) {
     const MemRegion *MR = *I;
     Invalidated.insert(MR);
+    if (isa<MemSpaceRegion>(MR))
+      Spaces.insert(MR);
+    else
+      Bases.insert(MR->getBaseRegion());
 
     SuperRegions.insert(MR);
     while (const SubRegion *SR = dyn_cast<SubRegion>(MR)) {
@@ -2329,26 +2380,50 @@ CStringChecker::checkRegionChanges(ProgramStateRef state,
   }
 
   CStringLengthTy::Factory &F = state->get_context<CStringLength>();
+  CStringLengthShard::Factory &SF = state->get_context<CStringLengthShard>();
+
+  // Drop the entries of one shard that are related to a changed region.
+  auto ProcessShard = [&](const MemRegion *Base, CStringLengthShard Shard) {
+    for (CStringLengthShard::iterator I = Shard.begin(), E = Shard.end();
+        I != E; ++I) {
+      const MemRegion *MR = I.getKey();
+
+      // Is this entry for a super-region of a changed region?
+      if (SuperRegions.count(MR)) {
+        Shard = SF.remove(Shard, MR);
+        continue;
+      }
 
-  // Then loop over the entries in the current state.
-  for (CStringLengthTy::iterator I = Entries.begin(),
-      E = Entries.end(); I != E; ++I) {
-    const MemRegion *MR = I.getKey();
-
-    // Is this entry for a super-region of a changed region?
-    if (SuperRegions.count(MR)) {
-      Entries = F.remove(Entries, MR);
-      continue;
+      // Is this entry for a sub-region of a changed region?
+      const MemRegion *Super = MR;
+      while (const SubRegion *SR = dyn_cast<SubRegion>(Super)) {
+        Super = SR->getSuperRegion();
+        if (Invalidated.count(Super)) {
+          Shard = SF.remove(Shard, MR);
+          break;
+        }
+      }
     }
 
-    // Is this entry for a sub-region of a changed region?
-    const MemRegion *Super = MR;
-    while (const SubRegion *SR = dyn_cast<SubRegion>(Super)) {
-      Super = SR->getSuperRegion();
-      if (Invalidated.count(Super)) {
-        Entries = F.remove(Entries, MR);
-        break;
-      }
+    Entries = Shard.isEmpty() ? F.remove(Entries, Base)
+                              : F.add(Entries, Base, Shard);
+  };
+
+  // Any entry related to a changed region through a super-region chain
+  // necessarily shares its base region, so only the shards of the changed
+  // bases need to be visited. Changed memory spaces cover every shard whose
+  // base lies in them, so fall back to walking all shards when one changes.
+  if (Spaces.empty()) {
+    for (const MemRegion *Base : Bases)
+      if (const CStringLengthShard *Shard = Entries.lookup(Base))
+        ProcessShard(Base, *Shard);
+  } else {
+    CStringLengthTy OldEntries = Entries;
+    for (CStringLengthTy::iterator I = OldEntries.begin(),
+        E = OldEntries.end(); I != E; ++I) {
+      const MemRegion *Base = I.getKey();
+      if (Bases.count(Base) || Spaces.count(Base->getMemorySpace()))
+        ProcessShard(Base, I.getData());
     }
   }
 
@@ -2362,11 +2437,15 @@ void CStringChecker::checkLiveSymbols(ProgramStateRef state,
 
   for (CStringLengthTy::iterator I = Entries.begin(), E = Entries.end();
       I != E; ++I) {
-    SVal Len = I.getData();
-
-    for (SymExpr::symbol_iterator si = Len.symbol_begin(),
-        se = Len.symbol_end(); si != se; ++si)
-      SR.markInUse(*si);
+    const CStringLengthShard &Shard = I.getData();
+    for (CStringLengthShard::iterator J = Shard.begin(), F = Shard.end();
+        J != F; ++J) {
+      SVal Len = J.getData();
+
+      for (SymExpr::symbol_iterator si = Len.symbol_begin(),
+          se = Len.symbol_end(); si != se; ++si)
+        SR.markInUse(*si);
+    }
   }
 }
 
@@ -2378,13 +2457,21 @@ void CStringChecker::checkDeadSymbols(SymbolReaper &SR,
     return;
 
   CStringLengthTy::Factory &F = state->get_context<CStringLength>();
+  CStringLengthShard::Factory &SF = state->get_context<CStringLengthShard>();
   for (CStringLengthTy::iterator I = Entries.begin(), E = Entries.end();
       I != E; ++I) {
-    SVal Len = I.getData();
-    if (SymbolRef Sym = Len.getAsSymbol()) {
-      if (SR.isDead(Sym))
-        Entries = F.remove(Entries, I.getKey());
+    CStringLengthShard Shard = I.getData();
+    for (CStringLengthShard::iterator J = Shard.begin(), JE = Shard.end();
+        J != JE; ++J) {
+      SVal Len = J.getData();
+      if (SymbolRef Sym = Len.getAsSymbol()) {
+        if (SR.isDead(Sym))
+          Shard = SF.remove(Shard, J.getKey());
+      }
     }
+
+    Entries = Shard.isEmpty() ? F.remove(Entries, I.getKey())
+                              : F.add(Entries, I.getKey(), Shard);
   }
 
   state = state->set<CStringLength>(Entries);
@@ -13,7 +13,6 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Checkers/BuiltinCheckerRegistration.h"
-#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/BugType.h"
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
@@ -23,20 +22,18 @@ using namespace clang;
 using namespace ento;
 
 namespace {
-class CastToStructVisitor : public RecursiveASTVisitor<CastToStructVisitor> {
-  BugReporter &BR;
-  const CheckerBase *Checker;
-  AnalysisDeclContext *AC;
-
+class CastToStructChecker : public Checker<check::ASTCodeBodyStmt<CastExpr>> {
 public:
-  explicit CastToStructVisitor(BugReporter &B, const CheckerBase *Checker,
-                               AnalysisDeclContext *A)
-      : BR(B), Checker(Checker), AC(A) {}
-  bool VisitCastExpr(const CastExpr *CE);
+  void checkASTCodeBodyStmt(const CastExpr *CE, const Decl *D,
+                            AnalysisManager &Mgr, BugReporter &BR) const;
 };
-}
+} // end anonymous namespace
 
-bool CastToStructVisitor::VisitCastExpr(const CastExpr *CE) {
+void CastToStructChecker::checkASTCodeBodyStmt(const CastExpr *CE,
+                                               const Decl *D,
+                                               AnalysisManager &Mgr,
+                                               BugReporter &BR) const {
+  AnalysisDeclContext *AC = Mgr.getAnalysisDeclContext(D);
   const Expr *E = CE->getSubExpr();
   ASTContext &Ctx = AC->getASTContext();
   QualType OrigTy = Ctx.getCanonicalType(E->getType());
@@ -46,24 +43,24 @@ bool CastToStructVisitor::VisitCastExpr(const CastExpr *CE) {
   const PointerType *ToPTy = dyn_cast<PointerType>(ToTy.getTypePtr());
 
   if (!ToPTy || !OrigPTy)
-    return true;
+    return;
 
   QualType OrigPointeeTy = OrigPTy->getPointeeType();
   QualType ToPointeeTy = ToPTy->getPointeeType();
 
   if (!ToPointeeTy->isStructureOrClassType())
-    return true;
+    return;
 
   // We allow cast from void*.
   if (OrigPointeeTy->isVoidType())
-    return true;
+    return;
 
   // Now the cast-to-type is struct pointer, the original type is not void*.
   if (!OrigPointeeTy->isRecordType()) {
     SourceRange Sr[1] = {CE->getSourceRange()};
     PathDiagnosticLocation Loc(CE, BR.getSourceManager(), AC);
     BR.EmitBasicReport(
-        AC->getDecl(), Checker, "Cast from non-struct type to struct type",
+        AC->getDecl(), this, "Cast from non-struct type to struct type",
         categories::LogicError, "Casting a non-structure type to a structure "
                                 "type and accessing a field can lead to memory "
                                 "access errors or data corruption.",
@@ -72,7 +69,7 @@ bool CastToStructVisitor::VisitCastExpr(const CastExpr *CE) {
     // Don't warn when size of data is unknown.
     const auto *U = dyn_cast<UnaryOperator>(E);
     if (!U || U->getOpcode() != UO_AddrOf)
-      return true;
+      return;
 
     // Don't warn for references
     const ValueDecl *VD = nullptr;
@@ -81,41 +78,28 @@ bool CastToStructVisitor::VisitCastExpr(const CastExpr *CE) {
     else if (const auto *SE = dyn_cast<MemberExpr>(U->getSubExpr()))
       VD = SE->getMemberDecl();
     if (!VD || VD->getType()->isReferenceType())
-      return true;
+      return;
 
     if (ToPointeeTy->isIncompleteType() ||
         OrigPointeeTy->isIncompleteType())
-      return true;
+      return;
 
     // Warn when there is widening cast.
     unsigned ToWidth = Ctx.getTypeInfo(ToPointeeTy).Width;
     unsigned OrigWidth = Ctx.getTypeInfo(OrigPointeeTy).Width;
     if (ToWidth <= OrigWidth)
-      return true;
+      return;
 
     PathDiagnosticLocation Loc(CE, BR.getSourceManager(), AC);
-    BR.EmitBasicReport(AC->getDecl(), Checker, "Widening cast to struct type",
+    BR.EmitBasicReport(AC->getDecl(), this, "Widening cast to struct type",
                        categories::LogicError,
                        "Casting data to a larger structure type and accessing "
                        "a field can lead to memory access errors or data "
                        "corruption.",
                        Loc, CE->getSourceRange());
   }
-
-  return true;
 }
 
-namespace {
-class CastToStructChecker : public Checker<check::ASTCodeBody> {
-public:
-  void checkASTCodeBody(const Decl *D, AnalysisManager &Mgr,
-                        BugReporter &BR) const {
-    CastToStructVisitor Visitor(BR, this, Mgr.getAnalysisDeclContext(D));
-    Visitor.TraverseDecl(const_cast<Decl *>(D));
-  }
-};
-} // end anonymous namespace
-
 void ento::registerCastToStructChecker(CheckerManager &mgr) {
   mgr.registerChecker<CastToStructChecker>();
 }
@@ -12,7 +12,6 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Checkers/BuiltinCheckerRegistration.h"
-#include "clang/AST/StmtVisitor.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/BugReporter.h"
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
@@ -21,28 +20,18 @@ using namespace clang;
 using namespace ento;
 
 namespace {
-class WalkAST : public StmtVisitor<WalkAST> {
-  BugReporter &BR;
-  const CheckerBase *Checker;
-  AnalysisDeclContext* AC;
-
+class SizeofPointerChecker
+    : public Checker<check::ASTCodeBodyStmt<UnaryExprOrTypeTraitExpr>> {
 public:
-  WalkAST(BugReporter &br, const CheckerBase *checker, AnalysisDeclContext *ac)
-      : BR(br), Checker(checker), AC(ac) {}
-  void VisitUnaryExprOrTypeTraitExpr(UnaryExprOrTypeTraitExpr *E);
-  void VisitStmt(Stmt *S) { VisitChildren(S); }
-  void VisitChildren(Stmt *S);
+  void checkASTCodeBodyStmt(const UnaryExprOrTypeTraitExpr *E, const Decl *D,
+                            AnalysisManager &mgr, BugReporter &BR) const;
 };
 }
 
-void WalkAST::VisitChildren(Stmt *S) {
-  for (Stmt *Child : S->children())
-    if (Child)
-      Visit(Child);
-}
-
 // CWE-467: Use of sizeof() on a Pointer Type
-void WalkAST::VisitUnaryExprOrTypeTraitExpr(UnaryExprOrTypeTraitExpr *E) {
+void SizeofPointerChecker::checkASTCodeBodyStmt(
+    const UnaryExprOrTypeTraitExpr *E, const Decl *D, AnalysisManager &mgr,
+    BugReporter &BR) const {
   if (E->getKind() != UETT_SizeOf)
     return;
 
@@ -57,13 +46,14 @@ void WalkAST::VisitUnaryExprOrTypeTraitExpr(UnaryExprOrTypeTraitExpr *E) {
     // Many false positives have the form 'sizeof *p'. This is reasonable
     // because people know what they are doing when they intentionally
     // dereference the pointer.
-    Expr *ArgEx = E->getArgumentExpr();
+    const Expr *ArgEx = E->getArgumentExpr();
     if (!isa<DeclRefExpr>(ArgEx->IgnoreParens()))
       return;
 
+    AnalysisDeclContext *AC = mgr.getAnalysisDeclContext(D);
     PathDiagnosticLocation ELoc =
       PathDiagnosticLocation::createBegin(E, BR.getSourceManager(), AC);
-    BR.EmitBasicReport(AC->getDecl(), Checker,
+    BR.EmitBasicReport(AC->getDecl(), this,
                        "Potential unintended use of sizeof() on pointer type",
                        categories::LogicError,
                        "The code calls sizeof() on a pointer type. "
@@ -72,21 +62,6 @@ void WalkAST::VisitUnaryExprOrTypeTraitExpr(UnaryExprOrTypeTraitExpr *E) {
   }
 }
 
-//===----------------------------------------------------------------------===//
-// SizeofPointerChecker
-//===----------------------------------------------------------------------===//
-
-namespace {
-class SizeofPointerChecker : public Checker<check::ASTCodeBody> {
-public:
-  void checkASTCodeBody(const Decl *D, AnalysisManager& mgr,
-                        BugReporter &BR) const {
-    WalkAST walker(BR, this, mgr.getAnalysisDeclContext(D));
-    walker.Visit(D->getBody());
-  }
-};
-}
-
 void ento::registerSizeofPointerChecker(CheckerManager &mgr) {
   mgr.registerChecker<SizeofPointerChecker>();
 }
@@ -34,11 +34,9 @@ class DominatorsTreeDumper : public Checker<check::ASTCodeBody> {
 public:
   void checkASTCodeBody(const Decl *D, AnalysisManager& mgr,
                         BugReporter &BR) const {
-    if (AnalysisDeclContext *AC = mgr.getAnalysisDeclContext(D)) {
-      CFGDomTree Dom;
-      Dom.buildDominatorTree(AC->getCFG());
-      Dom.dump();
-    }
+    if (AnalysisDeclContext *AC = mgr.getAnalysisDeclContext(D))
+      if (CFGDomTree *Dom = AC->getAnalysis<CFGDomTree>())
+        Dom->dump();
   }
 };
 }
@@ -60,11 +58,9 @@ class PostDominatorsTreeDumper : public Checker<check::ASTCodeBody> {
 public:
   void checkASTCodeBody(const Decl *D, AnalysisManager& mgr,
                         BugReporter &BR) const {
-    if (AnalysisDeclContext *AC = mgr.getAnalysisDeclContext(D)) {
-      CFGPostDomTree Dom;
-      Dom.buildDominatorTree(AC->getCFG());
-      Dom.dump();
-    }
+    if (AnalysisDeclContext *AC = mgr.getAnalysisDeclContext(D))
+      if (CFGPostDomTree *Dom = AC->getAnalysis<CFGPostDomTree>())
+        Dom->dump();
   }
 };
 }
@@ -2335,18 +2335,24 @@ void MallocChecker::reportLeak(SymbolRef Sym, ExplodedNode *N,
                                               C.getSourceManager(),
                                               AllocNode->getLocationContext());
 
-  SmallString<200> buf;
-  llvm::raw_svector_ostream os(buf);
-  if (Region && Region->canPrintPretty()) {
-    os << "Potential leak of memory pointed to by ";
-    Region->printPretty(os);
-  } else {
-    os << "Potential memory leak";
-  }
-
+  // All leak paths of one allocation site collapse into a single
+  // equivalence class, of which only one report is presented; defer the
+  // message rendering to that report. The message depends only on the
+  // leaked region, which is itself determined by the uniqueing location.
   auto R = llvm::make_unique<BugReport>(
-      *BT_Leak[*CheckKind], os.str(), N, LocUsedForUniqueing,
-      AllocNode->getLocationContext()->getDecl());
+      *BT_Leak[*CheckKind],
+      [Region]() -> std::string {
+        SmallString<200> buf;
+        llvm::raw_svector_ostream os(buf);
+        if (Region && Region->canPrintPretty()) {
+          os << "Potential leak of memory pointed to by ";
+          Region->printPretty(os);
+        } else {
+          os << "Potential memory leak";
+        }
+        return os.str();
+      },
+      N, LocUsedForUniqueing, AllocNode->getLocationContext()->getDecl());
   R->markInteresting(Sym);
   R->addVisitor(llvm::make_unique<MallocBugVisitor>(Sym, true));
   C.emitReport(std::move(R));
@@ -233,13 +233,15 @@ private:
         return nullptr;
 
       // Drop implications from the map.
+      ProgramStateTransaction T(State);
       if (Negated) {
-        State = State->remove<NonNullImplicationMap>(Antecedent);
-        State = State->remove<NullImplicationMap>(*Consequent);
+        T.remove<NonNullImplicationMap>(Antecedent);
+        T.remove<NullImplicationMap>(*Consequent);
       } else {
-        State = State->remove<NullImplicationMap>(Antecedent);
-        State = State->remove<NonNullImplicationMap>(*Consequent);
+        T.remove<NullImplicationMap>(Antecedent);
+        T.remove<NonNullImplicationMap>(*Consequent);
       }
+      State = T.commit();
     }
 
     return State;
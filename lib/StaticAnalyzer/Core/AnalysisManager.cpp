@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
+#include "clang/Analysis/CallArgumentFacts.h"
 
 using namespace clang;
 using namespace ento;
@@ -45,12 +46,23 @@ AnalysisManager::AnalysisManager(ASTContext &ASTCtx, DiagnosticsEngine &diags,
   AnaCtxMgr.getCFGBuildOptions().setAllAlwaysAdd();
 }
 
+const CallArgumentFacts &AnalysisManager::getCallArgumentFacts() {
+  if (!CallArgFacts) {
+    CallArgFacts = llvm::make_unique<CallArgumentFacts>();
+    CallArgFacts->addTU(Ctx.getTranslationUnitDecl());
+  }
+  return *CallArgFacts;
+}
+
 AnalysisManager::~AnalysisManager() {
   FlushDiagnostics();
   for (PathDiagnosticConsumers::iterator I = PathConsumers.begin(),
        E = PathConsumers.end(); I != E; ++I) {
     delete *I;
   }
+  // The quota summaries belong after the reports the consumers above just
+  // flushed.
+  ReportQuota.flushSuppressedCounts(Diags);
 }
 
 void AnalysisManager::FlushDiagnostics() {
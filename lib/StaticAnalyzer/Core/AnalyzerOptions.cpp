@@ -93,6 +93,8 @@ AnalyzerOptions::getExplorationStrategy() const {
                 ExplorationStrategyKind::UnexploredFirstQueue)
           .Case("unexplored_first_location_queue",
                 ExplorationStrategyKind::UnexploredFirstLocationQueue)
+          .Case("coverage_first_queue",
+                ExplorationStrategyKind::CoverageFirstQueue)
           .Case("bfs_block_dfs_contents",
                 ExplorationStrategyKind::BFSBlockDFSContents)
           .Default(None);
@@ -140,17 +142,29 @@ StringRef AnalyzerOptions::getCheckerStringOption(StringRef CheckerName,
          "Empty checker name! Make sure the checker object (including it's "
          "bases!) if fully initialized before calling this function!");
 
+  SmallString<64> Key;
+  (Twine(CheckerName) + ":" + OptionName).toVector(Key);
+
+  ConfigTable::const_iterator Cached = ResolvedCheckerOptions.find(Key);
+  if (Cached != ResolvedCheckerOptions.end())
+    return StringRef(Cached->getValue());
+
   ConfigTable::const_iterator E = Config.end();
+  SmallString<64> ProbeKey = Key;
   do {
-    ConfigTable::const_iterator I =
-        Config.find((Twine(CheckerName) + ":" + OptionName).str());
+    ConfigTable::const_iterator I = Config.find(ProbeKey);
     if (I != E)
-      return StringRef(I->getValue());
+      return StringRef(ResolvedCheckerOptions
+                           .insert(std::make_pair(StringRef(Key),
+                                                  I->getValue()))
+                           .first->getValue());
     size_t Pos = CheckerName.rfind('.');
     if (Pos == StringRef::npos)
       break;
 
     CheckerName = CheckerName.substr(0, Pos);
+    ProbeKey.clear();
+    (Twine(CheckerName) + ":" + OptionName).toVector(ProbeKey);
   } while (!CheckerName.empty() && SearchInParents);
 
   llvm_unreachable("Unknown checker option! Did you call getChecker*Option "
@@ -86,7 +86,32 @@ BasicValueFactory::~BasicValueFactory() {
   delete (PersistentSValPairsTy*) PersistentSValPairs;
 }
 
+const llvm::APSInt **BasicValueFactory::getSmallIntSlot(const llvm::APSInt &X) {
+  unsigned BitWidth = X.getBitWidth();
+  if (BitWidth == 0 || BitWidth > MaxCachedBitWidth)
+    return nullptr;
+
+  if (X.isAllOnesValue())
+    return &AllOnesCache[X.isUnsigned()][BitWidth];
+
+  uint64_t V = X.getZExtValue();
+  if (V < NumCachedInts)
+    return &SmallIntCache[X.isUnsigned()][BitWidth][V];
+
+  // Covers the signed minimum as well, whose bit pattern is a power of two.
+  if (X.isPowerOf2())
+    return &Pow2Cache[X.isUnsigned()][BitWidth][X.logBase2()];
+
+  return nullptr;
+}
+
 const llvm::APSInt& BasicValueFactory::getValue(const llvm::APSInt& X) {
+  // Arithmetic in evalAPSInt funnels every intermediate result through here,
+  // so check the constant caches before paying for a profile and probe.
+  const llvm::APSInt **Slot = getSmallIntSlot(X);
+  if (Slot && *Slot)
+    return **Slot;
+
   llvm::FoldingSetNodeID ID;
   void *InsertPos;
 
@@ -101,6 +126,9 @@ const llvm::APSInt& BasicValueFactory::getValue(const llvm::APSInt& X) {
     APSIntSet.InsertNode(P, InsertPos);
   }
 
+  if (Slot)
+    *Slot = &P->getValue();
+
   return *P;
 }
 
@@ -112,13 +140,24 @@ const llvm::APSInt& BasicValueFactory::getValue(const llvm::APInt& X,
 
 const llvm::APSInt& BasicValueFactory::getValue(uint64_t X, unsigned BitWidth,
                                            bool isUnsigned) {
+  if (BitWidth <= MaxCachedBitWidth && X < NumCachedInts) {
+    const llvm::APSInt *&Slot = SmallIntCache[isUnsigned][BitWidth][X];
+    if (!Slot) {
+      llvm::APSInt V(BitWidth, isUnsigned);
+      V = X;
+      Slot = &getValue(V);
+    }
+    return *Slot;
+  }
+
   llvm::APSInt V(BitWidth, isUnsigned);
   V = X;
   return getValue(V);
 }
 
 const llvm::APSInt& BasicValueFactory::getValue(uint64_t X, QualType T) {
-  return getValue(getAPSIntType(T).getValue(X));
+  APSIntType VTy = getAPSIntType(T);
+  return getValue(X, VTy.getBitWidth(), VTy.isUnsigned());
 }
 
 const CompoundValData*
@@ -34,6 +34,7 @@
 #include "clang/StaticAnalyzer/Core/BugReporter/PathDiagnostic.h"
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
+#include "clang/StaticAnalyzer/Core/IssueHash.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraph.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/MemRegion.h"
@@ -56,7 +57,9 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -84,6 +87,20 @@ BugReporterVisitor::~BugReporterVisitor() = default;
 
 void BugReporterContext::anchor() {}
 
+ConditionTruthVal VisitorFactCache::isNull(ProgramStateRef State, SVal V) {
+  // Constants answer without consulting the constraint manager; only symbol
+  // queries are worth memoizing.
+  SymbolRef Sym = V.getAsSymbol(/* IncludeBaseRegion */ true);
+  if (!Sym)
+    return State->isNull(V);
+
+  auto Ins = NullVerdicts.insert(
+      std::make_pair(std::make_pair(State.get(), Sym), ConditionTruthVal()));
+  if (Ins.second)
+    Ins.first->second = State->isNull(V);
+  return Ins.first->second;
+}
+
 //===----------------------------------------------------------------------===//
 // Helper routines for walking the ExplodedGraph and fetching statements.
 //===----------------------------------------------------------------------===//
@@ -2078,7 +2095,13 @@ const Decl *BugReport::getDeclWithIssue() const {
 
 void BugReport::Profile(llvm::FoldingSetNodeID& hash) const {
   hash.AddPointer(&BT);
-  hash.AddString(Description);
+  // A lazily described report promises that its message is determined by
+  // the bug type and the uniqueing data hashed below, so the equivalence
+  // class can be formed without rendering the message. Keep the hash stable
+  // regardless of whether the rendering happened already.
+  hash.AddBoolean(DescriptionIsLazy);
+  if (!DescriptionIsLazy)
+    hash.AddString(Description);
   PathDiagnosticLocation UL = getUniqueingLocation();
   if (UL.isValid()) {
     UL.Profile(hash);
@@ -2361,36 +2384,35 @@ TrimmedGraph::TrimmedGraph(const ExplodedGraph *OriginalGraph,
 
   assert(!RemainingNodes.empty() && "No error node found in the trimmed graph");
 
-  // Perform a forward BFS to find all the shortest paths.
+  // Perform a forward BFS to find all the shortest paths. Nodes are numbered
+  // in discovery order, and a node is numbered exactly once, when it is first
+  // pushed; revisits through other edges are filtered out here instead of at
+  // pop time, so the worklist stays bounded by the number of nodes rather
+  // than the number of edges.
   std::queue<const ExplodedNode *> WS;
 
   assert(G->num_roots() == 1);
-  WS.push(*G->roots_begin());
+  PriorityMap.reserve(G->size());
   unsigned Priority = 0;
 
+  PriorityMap.insert(std::make_pair(*G->roots_begin(), Priority++));
+  WS.push(*G->roots_begin());
+
   while (!WS.empty()) {
     const ExplodedNode *Node = WS.front();
     WS.pop();
 
-    PriorityMapTy::iterator PriorityEntry;
-    bool IsNew;
-    std::tie(PriorityEntry, IsNew) =
-      PriorityMap.insert(std::make_pair(Node, Priority));
-    ++Priority;
-
-    if (!IsNew) {
-      assert(PriorityEntry->second <= Priority);
-      continue;
-    }
-
     if (RemainingNodes.erase(Node))
       if (RemainingNodes.empty())
         break;
 
-    for (ExplodedNode::const_pred_iterator I = Node->succ_begin(),
+    for (ExplodedNode::const_succ_iterator I = Node->succ_begin(),
                                            E = Node->succ_end();
          I != E; ++I)
-      WS.push(*I);
+      if (PriorityMap.insert(std::make_pair(*I, Priority)).second) {
+        ++Priority;
+        WS.push(*I);
+      }
   }
 
   // Sort the error paths from longest to shortest.
@@ -2608,6 +2630,10 @@ std::pair<BugReport*, std::unique_ptr<VisitorsDiagnosticsTy>> findValidReport(
   AnalyzerOptions &Opts,
   GRBugReporter &Reporter) {
 
+  // All reports of the class replay paths over the same uniqued states, so
+  // constraint queries memoized on one walk pay off on every later one.
+  VisitorFactCache FactCache;
+
   while (TrimG.popNextReportGraph(ErrorGraph)) {
     // Find the BugReport with the original location.
     assert(ErrorGraph.Index < bugReports.size());
@@ -2625,7 +2651,7 @@ std::pair<BugReport*, std::unique_ptr<VisitorsDiagnosticsTy>> findValidReport(
     R->addVisitor(llvm::make_unique<ConditionBRVisitor>());
     R->addVisitor(llvm::make_unique<TagVisitor>());
 
-    BugReporterContext BRC(Reporter, ErrorGraph.BackMap);
+    BugReporterContext BRC(Reporter, ErrorGraph.BackMap, &FactCache);
 
     // Run all visitors on a given graph, once.
     std::unique_ptr<VisitorsDiagnosticsTy> visitorNotes =
@@ -2735,6 +2761,40 @@ void BugReporter::emitReport(std::unique_ptr<BugReport> R) {
   BugReportEquivClass* EQ = EQClasses.FindNodeOrInsertPos(ID, InsertPos);
 
   if (!EQ) {
+    // A new equivalence class counts against the per-(checker, file) report
+    // quota (see the 'report-quota' config option). Issues the quota drops
+    // never reach the expensive bug path construction; reports that join an
+    // existing class stay exempt because they only provide alternative
+    // paths for an already admitted issue.
+    if (unsigned Quota = getAnalyzerOptions().ReportQuota) {
+      const SourceManager &SM = getSourceManager();
+      PathDiagnosticLocation UPDLoc = R->getUniqueingLocation();
+      FullSourceLoc L(SM.getExpansionLoc(UPDLoc.isValid()
+                                             ? UPDLoc.asLocation()
+                                             : R->getLocation(SM)
+                                                   .asLocation()),
+                      SM);
+      SmallString<32> IssueHash =
+          GetIssueHash(SM, L, BT.getCheckName(), BT.getName(),
+                       R->getDeclWithIssue(), getContext().getLangOpts(),
+                       &IssueHashCache);
+      ReportQuotaState &QS = getReportQuotaState();
+      // An issue hash already admitted by an earlier entry point would be
+      // deduplicated by the consumers anyway; drop it before it costs
+      // anything.
+      if (QS.SeenIssueHashes.count(IssueHash))
+        return;
+      SmallString<128> Key(BT.getCheckName());
+      Key += '\0';
+      Key += SM.getFilename(L);
+      unsigned &Used = QS.Admitted[Key];
+      if (Used >= Quota) {
+        ++QS.Suppressed[Key];
+        return;
+      }
+      ++Used;
+      QS.SeenIssueHashes.insert(IssueHash);
+    }
     EQ = new BugReportEquivClass(std::move(R));
     EQClasses.InsertNode(EQ, InsertPos);
     EQClassesVector.push_back(EQ);
@@ -2742,6 +2802,30 @@ void BugReporter::emitReport(std::unique_ptr<BugReport> R) {
     EQ->AddReport(std::move(R));
 }
 
+void ReportQuotaState::flushSuppressedCounts(DiagnosticsEngine &Diag) {
+  if (Suppressed.empty())
+    return;
+
+  // Sort the keys so the summaries come out in a deterministic order.
+  std::vector<StringRef> Keys;
+  Keys.reserve(Suppressed.size());
+  for (const auto &E : Suppressed)
+    Keys.push_back(E.getKey());
+  llvm::sort(Keys);
+
+  unsigned DiagID = Diag.getCustomDiagID(
+      DiagnosticsEngine::Warning,
+      "the analyzer suppressed %0 further report%s0 from checker '%1' in "
+      "file '%2' after its report quota of %3 was reached");
+  for (StringRef Key : Keys) {
+    // A capped key's admitted count is exactly the quota.
+    std::pair<StringRef, StringRef> CheckAndFile = Key.split('\0');
+    Diag.Report(DiagID) << Suppressed[Key] << CheckAndFile.first
+                        << CheckAndFile.second << Admitted.lookup(Key);
+  }
+  Suppressed.clear();
+}
+
 //===----------------------------------------------------------------------===//
 // Emitting reports in equivalence classes.
 //===----------------------------------------------------------------------===//
@@ -2948,12 +3032,55 @@ FindReportInEquivalenceClass(BugReportEquivClass& EQ,
   return exampleReport;
 }
 
+/// Claim \p IssueHash in the issue store at \p Dir shared by the analyzer
+/// processes of a build (see the 'report-dedup-dir' config option). Every
+/// claim is one empty marker file named by the hash, which keeps the store
+/// consistent between processes without any locking. Returns false if another
+/// process already claimed the hash.
+static bool claimIssueAcrossProcesses(StringRef Dir, StringRef IssueHash) {
+  SmallString<128> Path(Dir);
+  llvm::sys::path::append(Path, "issue-" + IssueHash);
+  if (llvm::sys::fs::exists(Path))
+    return false;
+  llvm::sys::fs::create_directories(Dir);
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::OF_None);
+  // A failed claim only costs a duplicated report.
+  (void)EC;
+  return true;
+}
+
 void BugReporter::FlushReport(BugReportEquivClass& EQ) {
   SmallVector<BugReport*, 10> bugReports;
   BugReport *report = FindReportInEquivalenceClass(EQ, bugReports);
   if (!report)
     return;
 
+  // Deduplicate the report against the other analyzer processes of the build
+  // before constructing the bug path, which is the expensive part of report
+  // emission. The first process to reach an issue claims its hash in the
+  // shared store and emits the report; the later ones drop their copies. The
+  // issue hash is the same content based hash that the plist and HTML
+  // consumers emit, so textually identical issues reached from different
+  // translation units collapse into one claim.
+  if (!getAnalyzerOptions().ReportDedupDir.empty()) {
+    const SourceManager &SM = getSourceManager();
+    PathDiagnosticLocation UPDLoc = report->getUniqueingLocation();
+    FullSourceLoc L(SM.getExpansionLoc(UPDLoc.isValid()
+                                           ? UPDLoc.asLocation()
+                                           : report->getLocation(SM)
+                                                 .asLocation()),
+                    SM);
+    const BugType &BT = report->getBugType();
+    SmallString<32> IssueHash =
+        GetIssueHash(SM, L, BT.getCheckName(), BT.getName(),
+                     report->getDeclWithIssue(), getContext().getLangOpts(),
+                     &IssueHashCache);
+    if (!claimIssueAcrossProcesses(getAnalyzerOptions().ReportDedupDir,
+                                   IssueHash))
+      return;
+  }
+
   ArrayRef<PathDiagnosticConsumer*> Consumers = getPathDiagnosticConsumers();
   std::unique_ptr<DiagnosticForConsumerMapTy> Diagnostics =
       generateDiagnosticForConsumerMap(report, Consumers, bugReports);
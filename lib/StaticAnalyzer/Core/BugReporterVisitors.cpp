@@ -1555,16 +1555,21 @@ SuppressInlineDefensiveChecksVisitor::VisitNode(const ExplodedNode *Succ,
   if (IsSatisfied)
     return nullptr;
 
+  // The null-constraint queries below run on every node of the path, and the
+  // walk is repeated for each report of the equivalence class, so go through
+  // the shared memo cache instead of the constraint manager directly.
+  VisitorFactCache &FactCache = BRC.getVisitorFactCache();
+
   // Start tracking after we see the first state in which the value is null.
   if (!IsTrackingTurnedOn)
-    if (Succ->getState()->isNull(V).isConstrainedTrue())
+    if (FactCache.isNull(Succ->getState(), V).isConstrainedTrue())
       IsTrackingTurnedOn = true;
   if (!IsTrackingTurnedOn)
     return nullptr;
 
   // Check if in the previous state it was feasible for this value
   // to *not* be null.
-  if (!Pred->getState()->isNull(V).isConstrainedTrue()) {
+  if (!FactCache.isNull(Pred->getState(), V).isConstrainedTrue()) {
     IsSatisfied = true;
 
     assert(Succ->getState()->isNull(V).isConstrainedTrue());
@@ -1637,12 +1642,16 @@ namespace {
 /// trackExpressionValue().
 class TrackControlDependencyCondBRVisitor final : public BugReporterVisitor {
   const ExplodedNode *Origin;
-  ControlDependencyCalculator ControlDeps;
+  // Owned by the AnalysisDeclContext, so building the post dominator tree is
+  // paid once per function rather than once per report.
+  ControlDependencyCalculator *ControlDeps;
   llvm::SmallSet<const CFGBlock *, 32> VisitedBlocks;
 
 public:
   TrackControlDependencyCondBRVisitor(const ExplodedNode *O)
-  : Origin(O), ControlDeps(&O->getCFG()) {}
+      : Origin(O), ControlDeps(O->getLocationContext()
+                                   ->getAnalysisDeclContext()
+                                   ->getAnalysis<ControlDependencyCalculator>()) {}
 
   void Profile(llvm::FoldingSetNodeID &ID) const override {
     static int x = 0;
@@ -1704,10 +1713,10 @@ TrackControlDependencyCondBRVisitor::VisitNode(const ExplodedNode *N,
   CFGBlock *OriginB = GetRelevantBlock(Origin);
 
   // TODO: Cache CFGBlocks for each ExplodedNode.
-  if (!OriginB || !NB)
+  if (!ControlDeps || !OriginB || !NB)
     return nullptr;
 
-  if (ControlDeps.isControlDependent(OriginB, NB)) {
+  if (ControlDeps->isControlDependent(OriginB, NB)) {
     if (const Expr *Condition = NB->getLastCondition()) {
       // Keeping track of the already tracked conditions on a visitor level
       // isn't sufficient, because a new visitor is created for each tracked
@@ -2716,6 +2725,20 @@ void FalsePositiveRefutationBRVisitor::finalizeVisitor(
   // Collect new constraints
   VisitNode(EndPathNode, BRC, BR);
 
+  // The constraint map is canonicalized by its factory, so its root uniquely
+  // identifies the collected constraint set. Reports flushed earlier often
+  // carried identical constraints; reuse their verdict instead of running the
+  // solver again.
+  GRBugReporter &Reporter = BRC.getBugReporter();
+  const void *ConstraintKey = Constraints.getRootWithoutRetain();
+  if (Optional<bool> CachedSat =
+          Reporter.getCachedRefutationSatisfiability(ConstraintKey)) {
+    if (!CachedSat.getValue())
+      BR.markInvalid("Infeasible constraints",
+                     EndPathNode->getLocationContext());
+    return;
+  }
+
   // Create a refutation manager
   llvm::SMTSolverRef RefutationSolver = llvm::CreateZ3Solver();
   ASTContext &Ctx = BRC.getASTContext();
@@ -2743,6 +2766,8 @@ void FalsePositiveRefutationBRVisitor::finalizeVisitor(
   if (!isSat.hasValue())
     return;
 
+  Reporter.cacheRefutationSatisfiability(ConstraintKey, isSat.getValue());
+
   if (!isSat.getValue())
     BR.markInvalid("Infeasible constraints", EndPathNode->getLocationContext());
 }
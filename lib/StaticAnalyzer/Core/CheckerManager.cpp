@@ -12,20 +12,26 @@
 
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
 #include "clang/AST/DeclBase.h"
+#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/AST/Stmt.h"
 #include "clang/Analysis/ProgramPoint.h"
 #include "clang/Basic/JsonSupport.h"
 #include "clang/Basic/LLVM.h"
 #include "clang/Driver/DriverDiagnostic.h"
+#include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CheckerContext.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CoreEngine.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/PhaseTimers.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SVals.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
 #include <cassert>
 #include <vector>
 
@@ -95,18 +101,75 @@ void CheckerManager::runCheckersOnASTDecl(const Decl *D, AnalysisManager& mgr,
     checker(D, mgr, BR);
 }
 
+namespace {
+
+/// Drives the fused body traversal: one pass over the body notifies every
+/// checker that subscribed to a statement kind.
+class BodyStmtDispatcher : public RecursiveASTVisitor<BodyStmtDispatcher> {
+  llvm::function_ref<void (const Stmt *)> Dispatch;
+
+public:
+  BodyStmtDispatcher(llvm::function_ref<void (const Stmt *)> Dispatch)
+      : Dispatch(Dispatch) {}
+
+  bool VisitStmt(Stmt *S) {
+    Dispatch(S);
+    return true;
+  }
+};
+
+} // namespace
+
 void CheckerManager::runCheckersOnASTBody(const Decl *D, AnalysisManager& mgr,
                                           BugReporter &BR) {
   assert(D && D->hasBody());
 
   for (const auto BodyChecker : BodyCheckers)
     BodyChecker(D, mgr, BR);
+
+  if (BodyStmtCheckers.empty())
+    return;
+
+  auto Dispatch = [&](const Stmt *S) {
+    for (const auto &CheckFn : getCachedBodyStmtCheckersFor(S))
+      CheckFn(S, D, mgr, BR);
+  };
+  // Traverse the declaration rather than just its body so that statements
+  // outside of it, such as constructor initializers and default arguments,
+  // are dispatched as well.
+  BodyStmtDispatcher Dispatcher(Dispatch);
+  Dispatcher.TraverseDecl(const_cast<Decl *>(D));
+}
+
+const CheckerManager::CachedBodyStmtCheckers &
+CheckerManager::getCachedBodyStmtCheckersFor(const Stmt *S) {
+  assert(S);
+
+  unsigned Key = S->getStmtClass();
+  CachedBodyStmtCheckersMapTy::iterator CCI =
+      CachedBodyStmtCheckersMap.find(Key);
+  if (CCI != CachedBodyStmtCheckersMap.end())
+    return CCI->second;
+
+  // Find the checkers that should run for this Stmt and cache them.
+  CachedBodyStmtCheckers &Checkers = CachedBodyStmtCheckersMap[Key];
+  for (const auto &Info : BodyStmtCheckers)
+    if (Info.IsForStmtFn(S))
+      Checkers.push_back(Info.CheckFn);
+  return Checkers;
 }
 
 //===----------------------------------------------------------------------===//
 // Functions for running checkers for path-sensitive checking.
 //===----------------------------------------------------------------------===//
 
+/// The name a checker's samples are filed under in the phase timer tree;
+/// mirrors forEachCheckerTime.
+static StringRef getCheckerTimerName(const CheckerBase *Checker) {
+  StringRef Name = Checker->getCheckName().getName();
+  return Name.empty() ? StringRef(Checker->getTagDescription()) : Name;
+}
+
 template <typename CHECK_CTX>
 static void expandGraphWithCheckers(CHECK_CTX checkCtx,
                                     ExplodedNodeSet &Dst,
@@ -125,18 +188,59 @@ static void expandGraphWithCheckers(CHECK_CTX checkCtx,
   ExplodedNodeSet Tmp1, Tmp2;
   const ExplodedNodeSet *PrevSet = &Src;
 
-  for (; I != E; ++I) {
+  CheckerManager &CM = checkCtx.Eng.getCheckerManager();
+  const bool ProfileCheckers = CM.shouldProfileCheckers();
+  const bool TimeCheckers = ProfileCheckers || PhaseTimers::isEnabled();
+  const bool PreferVetoers = CM.shouldPreferVetoingCheckers();
+
+  // With 'prefer-vetoing-checkers', dispatch to the checkers that have sunk
+  // the most paths so far first: every path such a checker kills is never
+  // handed to the (often more expensive) checkers behind it, and the
+  // all-sinks early exit below fires as early as possible.
+  using CheckerFnRef = const typename CHECK_CTX::CheckersTy::value_type *;
+  SmallVector<CheckerFnRef, 8> Checkers;
+  for (; I != E; ++I)
+    Checkers.push_back(&*I);
+  if (PreferVetoers)
+    std::stable_sort(Checkers.begin(), Checkers.end(),
+                     [&CM](CheckerFnRef L, CheckerFnRef R) {
+                       return CM.getSunkPathCount(L->Checker) >
+                              CM.getSunkPathCount(R->Checker);
+                     });
+
+  for (unsigned Idx = 0, N = Checkers.size(); Idx != N; ++Idx) {
     ExplodedNodeSet *CurrSet = nullptr;
-    if (I+1 == E)
+    if (Idx + 1 == N)
       CurrSet = &Dst;
     else {
       CurrSet = (PrevSet == &Tmp1) ? &Tmp2 : &Tmp1;
       CurrSet->clear();
     }
 
+    llvm::TimeRecord StartTime;
+    if (TimeCheckers)
+      StartTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
+
     NodeBuilder B(*PrevSet, *CurrSet, BldrCtx);
     for (const auto &NI : *PrevSet)
-      checkCtx.runChecker(*I, B, NI);
+      checkCtx.runChecker(*Checkers[Idx], B, NI);
+
+    if (TimeCheckers) {
+      llvm::TimeRecord Elapsed =
+          llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+      Elapsed -= StartTime;
+      if (ProfileCheckers)
+        CM.accumulateCheckerTime(Checkers[Idx]->Checker, Elapsed);
+      PhaseTimers::addSample("checkers",
+                             getCheckerTimerName(Checkers[Idx]->Checker),
+                             Elapsed);
+    }
+
+    // A checker that hands fewer nodes on than it received has sunk the
+    // difference (checkers that split paths hand on more, not fewer).
+    if (PreferVetoers && CurrSet->size() < PrevSet->size())
+      CM.noteSunkPaths(Checkers[Idx]->Checker,
+                       PrevSet->size() - CurrSet->size());
 
     // If all the produced transitions are sinks, stop.
     if (CurrSet->empty())
@@ -651,6 +755,8 @@ void CheckerManager::runCheckersForEvalCall(ExplodedNodeSet &Dst,
                                             const ExplodedNodeSet &Src,
                                             const CallEvent &Call,
                                             ExprEngine &Eng) {
+  const bool ProfileCheckers = shouldProfileCheckers();
+  const bool TimeCheckers = ProfileCheckers || PhaseTimers::isEnabled();
   for (const auto Pred : Src) {
     bool anyEvaluated = false;
 
@@ -667,12 +773,25 @@ void CheckerManager::runCheckersForEvalCall(ExplodedNodeSet &Dst,
           Pred->getLocationContext(),
           EvalCallChecker.Checker);
       bool evaluated = false;
+      llvm::TimeRecord StartTime;
+      if (TimeCheckers)
+        StartTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
       { // CheckerContext generates transitions(populates checkDest) on
         // destruction, so introduce the scope to make sure it gets properly
         // populated.
         CheckerContext C(B, Eng, Pred, L);
         evaluated = EvalCallChecker(Call, C);
       }
+      if (TimeCheckers) {
+        llvm::TimeRecord Elapsed =
+            llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+        Elapsed -= StartTime;
+        if (ProfileCheckers)
+          accumulateCheckerTime(EvalCallChecker.Checker, Elapsed);
+        PhaseTimers::addSample("checkers",
+                               getCheckerTimerName(EvalCallChecker.Checker),
+                               Elapsed);
+      }
       assert(!(evaluated && anyEvaluated)
              && "There are more than one checkers evaluating the call");
       if (evaluated) {
@@ -770,6 +889,74 @@ void CheckerManager::runCheckersForPrintStateJson(raw_ostream &Out,
   Out << NL;
 }
 
+bool CheckerManager::shouldProfileCheckers() const {
+  return AOptions.ShouldProfileCheckers;
+}
+
+bool CheckerManager::shouldPreferVetoingCheckers() const {
+  return AOptions.ShouldPreferVetoingCheckers;
+}
+
+void CheckerManager::noteSunkPaths(const CheckerBase *Checker, unsigned N) {
+  SunkPathCounts[Checker] += N;
+}
+
+uint64_t CheckerManager::getSunkPathCount(const CheckerBase *Checker) const {
+  auto I = SunkPathCounts.find(Checker);
+  return I == SunkPathCounts.end() ? 0 : I->second;
+}
+
+void CheckerManager::accumulateCheckerTime(const CheckerBase *Checker,
+                                           const llvm::TimeRecord &Time) {
+  CheckerProfileTimes[Checker] += Time;
+}
+
+llvm::TimeRecord CheckerManager::getTotalCheckerTime() const {
+  llvm::TimeRecord Total;
+  for (const auto &Entry : CheckerProfileTimes)
+    Total += Entry.second;
+  return Total;
+}
+
+void CheckerManager::forEachCheckerTime(
+    llvm::function_ref<void(StringRef, const llvm::TimeRecord &)> Fn) const {
+  for (const auto &Entry : CheckerProfileTimes) {
+    StringRef Name = Entry.first->getCheckName().getName();
+    Fn(Name.empty() ? StringRef(Entry.first->getTagDescription()) : Name,
+       Entry.second);
+  }
+}
+
+void CheckerManager::printCheckerProfile(raw_ostream &Out) const {
+  if (CheckerProfileTimes.empty())
+    return;
+
+  std::vector<std::pair<const CheckerBase *, llvm::TimeRecord>> Times(
+      CheckerProfileTimes.begin(), CheckerProfileTimes.end());
+  llvm::sort(Times,
+             [](const std::pair<const CheckerBase *, llvm::TimeRecord> &LHS,
+                const std::pair<const CheckerBase *, llvm::TimeRecord> &RHS) {
+               return RHS.second < LHS.second;
+             });
+
+  llvm::TimeRecord Total;
+  for (const auto &Time : Times)
+    Total += Time.second;
+
+  Out << "===" << std::string(73, '-') << "===\n";
+  Out << "                           Analyzer checker times\n";
+  Out << "===" << std::string(73, '-') << "===\n";
+  Total.print(Total, Out);
+  Out << " Total\n";
+  for (const auto &Time : Times) {
+    Time.second.print(Total, Out);
+    StringRef Name = Time.first->getCheckName().getName();
+    Out << ' ' << (Name.empty() ? Time.first->getTagDescription() : Name)
+        << '\n';
+  }
+  Out << '\n';
+}
+
 //===----------------------------------------------------------------------===//
 // Internal registration functions for AST traversing.
 //===----------------------------------------------------------------------===//
@@ -784,6 +971,12 @@ void CheckerManager::_registerForBody(CheckDeclFunc checkfn) {
   BodyCheckers.push_back(checkfn);
 }
 
+void CheckerManager::_registerForBodyStmt(CheckBodyStmtFunc checkfn,
+                                          HandlesStmtFunc isForStmtFn) {
+  BodyStmtCheckerInfo info = { checkfn, isForStmtFn };
+  BodyStmtCheckers.push_back(info);
+}
+
 //===----------------------------------------------------------------------===//
 // Internal registration functions for path-sensitive checking.
 //===----------------------------------------------------------------------===//
@@ -904,6 +1097,8 @@ CheckerManager::getCachedStmtCheckersFor(const Stmt *S, bool isPreVisit) {
 }
 
 CheckerManager::~CheckerManager() {
+  if (!CheckerProfileTimes.empty())
+    printCheckerProfile(llvm::errs());
   for (const auto CheckerDtor : CheckerDtors)
     CheckerDtor();
 }
@@ -22,6 +22,7 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/BlockCounter.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/EngineStats.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraph.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/FunctionSummary.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SubEngine.h"
@@ -41,11 +42,13 @@ using namespace ento;
 
 #define DEBUG_TYPE "CoreEngine"
 
-STATISTIC(NumSteps,
+ENGINE_STATISTIC(NumSteps,
             "The # of steps executed.");
-STATISTIC(NumReachedMaxSteps,
+ENGINE_STATISTIC(NumReachedMaxSteps,
             "The # of times we reached the max number of steps.");
-STATISTIC(NumPathsExplored,
+ENGINE_STATISTIC(NumReachedMaxGraphMemory,
+            "The # of times we reached the max graph memory.");
+ENGINE_STATISTIC(NumPathsExplored,
             "The # of paths explored by the analyzer.");
 
 //===----------------------------------------------------------------------===//
@@ -67,6 +70,8 @@ static std::unique_ptr<WorkList> generateWorkList(AnalyzerOptions &Opts,
       return WorkList::makeUnexploredFirstPriorityQueue();
     case ExplorationStrategyKind::UnexploredFirstLocationQueue:
       return WorkList::makeUnexploredFirstPriorityLocationQueue();
+    case ExplorationStrategyKind::CoverageFirstQueue:
+      return WorkList::makeCoverageFirstPriorityQueue();
   }
   llvm_unreachable("Unknown AnalyzerOptions::ExplorationStrategyKind");
 }
@@ -74,7 +79,8 @@ static std::unique_ptr<WorkList> generateWorkList(AnalyzerOptions &Opts,
 CoreEngine::CoreEngine(SubEngine &subengine, FunctionSummariesTy *FS,
                        AnalyzerOptions &Opts)
     : SubEng(subengine), WList(generateWorkList(Opts, subengine)),
-      BCounterFactory(G.getAllocator()), FunctionSummaries(FS) {}
+      BCounterFactory(G.getAllocator()), FunctionSummaries(FS),
+      MaxGraphMemory(uint64_t(Opts.MaxGraphMemory) << 20) {}
 
 /// ExecuteWorkList - Run the worklist algorithm for a maximum number of steps.
 bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
@@ -126,6 +132,8 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
   if(!UnlimitedSteps)
     G.reserve(std::min(Steps,PreReservationCap));
 
+  unsigned StepsSinceMemoryProbe = 0;
+
   while (WList->hasWork()) {
     if (!UnlimitedSteps) {
       if (Steps == 0) {
@@ -137,6 +145,15 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
 
     NumSteps++;
 
+    // The allocation watermark moves slowly relative to the step count, so
+    // probing it on every 1024th step is enough to catch runaway entry
+    // points without putting the (non-trivial) slab walk on the hot path.
+    if (MaxGraphMemory && (++StepsSinceMemoryProbe & 1023) == 0 &&
+        G.getAllocator().getBytesAllocated() > MaxGraphMemory) {
+      NumReachedMaxGraphMemory++;
+      break;
+    }
+
     const WorkListUnit& WU = WList->dequeue();
 
     // Set the current block counter.
@@ -148,6 +165,12 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
     dispatchWorkItem(Node, Node->getLocation(), WU);
   }
   SubEng.processEndWorklist();
+
+  // Fold the hot path counters into their aggregate Statistics; the deltas
+  // are this entry point's share of them.
+  StatsDeltas.clear();
+  EngineStats::flush(&StatsDeltas);
+
   return WList->hasWork();
 }
 
@@ -0,0 +1,36 @@
+//===- EngineStats.cpp - Cheap counters for the engine's hot paths --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the registry behind ENGINE_STATISTIC counters.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/StaticAnalyzer/Core/PathSensitive/EngineStats.h"
+
+using namespace clang;
+using namespace ento;
+
+EngineCounter *EngineStats::Head = nullptr;
+
+void EngineCounter::registerCounter() {
+  Registered = true;
+  Next = EngineStats::Head;
+  EngineStats::Head = this;
+}
+
+void EngineStats::flush(llvm::SmallVectorImpl<Delta> *Deltas) {
+  for (EngineCounter *C = Head; C; C = C->Next) {
+    const uint64_t Pending = C->Value - C->Flushed;
+    if (!Pending)
+      continue;
+    C->Aggregate += Pending;
+    C->Flushed = C->Value;
+    if (Deltas)
+      Deltas->push_back({C->Aggregate.getName(), Pending});
+  }
+}
@@ -169,33 +169,58 @@ Environment
 EnvironmentManager::removeDeadBindings(Environment Env,
                                        SymbolReaper &SymReaper,
                                        ProgramStateRef ST) {
-  // We construct a new Environment object entirely, as this is cheaper than
-  // individually removing all the subexpression bindings (which will greatly
-  // outnumber block-level expression bindings).
-  Environment NewEnv = getInitialEnvironment();
-
   MarkLiveCallback CB(SymReaper);
   ScanReachableSymbols RSScaner(ST, CB);
 
-  llvm::ImmutableMapRef<EnvironmentEntry, SVal>
-    EBMapRef(NewEnv.ExprBindings.getRootWithoutRetain(),
-             F.getTreeFactory());
-
-  // Iterate over the block-expr bindings.
+  // Classify every binding and mark the symbols of the surviving values live
+  // before touching the map: which rewrite of the map is cheaper depends on
+  // the outcome.
+  SmallVector<EnvironmentEntry, 16> Dead;
+  SmallVector<std::pair<EnvironmentEntry, SVal>, 16> Live;
   for (Environment::iterator I = Env.begin(), E = Env.end();
        I != E; ++I) {
     const EnvironmentEntry &BlkExpr = I.getKey();
     const SVal &X = I.getData();
 
     if (SymReaper.isLive(BlkExpr.getStmt(), BlkExpr.getLocationContext())) {
-      // Copy the binding to the new map.
-      EBMapRef = EBMapRef.add(BlkExpr, X);
+      Live.push_back(std::make_pair(BlkExpr, X));
 
       // Mark all symbols in the block expr's value live.
       RSScaner.scan(X);
+    } else {
+      Dead.push_back(BlkExpr);
     }
   }
 
+  // Everything survived; keep the existing map instead of rebuilding an
+  // identical tree. This is the common shape when dead bindings are removed
+  // at every exploded node rather than only at block boundaries.
+  if (Dead.empty())
+    return Env;
+
+  // A few dead bindings in a mostly live map: unlink just those. Removal
+  // leaves the subtrees holding the live bindings shared with the previous
+  // state, while a rebuild would re-hash every live binding through the
+  // factory only to arrive at the same canonical tree.
+  if (Dead.size() < Live.size()) {
+    BindingsTy Bindings = Env.ExprBindings;
+    for (const EnvironmentEntry &E : Dead)
+      Bindings = F.remove(Bindings, E);
+    return Environment(Bindings);
+  }
+
+  // Mostly dead: construct a new Environment object entirely, as this is
+  // cheaper than individually removing all the subexpression bindings (which
+  // will greatly outnumber block-level expression bindings).
+  Environment NewEnv = getInitialEnvironment();
+
+  llvm::ImmutableMapRef<EnvironmentEntry, SVal>
+    EBMapRef(NewEnv.ExprBindings.getRootWithoutRetain(),
+             F.getTreeFactory());
+
+  for (const std::pair<EnvironmentEntry, SVal> &B : Live)
+    EBMapRef = EBMapRef.add(B.first, B.second);
+
   NewEnv.ExprBindings = EBMapRef.asImmutableMap();
   return NewEnv;
 }
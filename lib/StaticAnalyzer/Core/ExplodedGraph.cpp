@@ -22,7 +22,6 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState_Fwd.h"
-#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerUnion.h"
@@ -206,6 +205,8 @@ void ExplodedNode::addPredecessor(ExplodedNode *V, ExplodedGraph &G) {
   assert(!V->isSink());
   Preds.addNode(V, G);
   V->Succs.addNode(this, G);
+  if (ExplodedGraphTrace *Trace = G.getTrace())
+    Trace->recordTransition(V, this, G);
 }
 
 void ExplodedNode::NodeGroup::replaceNode(ExplodedNode *node) {
@@ -310,7 +311,7 @@ ExplodedNode *ExplodedGraph::getNode(const ProgramPoint &L,
     }
     else {
       // Allocate a new node.
-      V = (NodeTy*) getAllocator().Allocate<NodeTy>();
+      V = (NodeTy*) NodeAlloc.Allocate<NodeTy>();
     }
 
     new (V) NodeTy(L, State, IsSink);
@@ -333,7 +334,7 @@ ExplodedNode *ExplodedGraph::getNode(const ProgramPoint &L,
 ExplodedNode *ExplodedGraph::createUncachedNode(const ProgramPoint &L,
                                                 ProgramStateRef State,
                                                 bool IsSink) {
-  NodeTy *V = (NodeTy *) getAllocator().Allocate<NodeTy>();
+  NodeTy *V = (NodeTy *) NodeAlloc.Allocate<NodeTy>();
   new (V) NodeTy(L, State, IsSink);
   return V;
 }
@@ -345,28 +346,36 @@ ExplodedGraph::trim(ArrayRef<const NodeTy *> Sinks,
   if (Nodes.empty())
     return nullptr;
 
-  using Pass1Ty = llvm::DenseSet<const ExplodedNode *>;
-  Pass1Ty Pass1;
-
   using Pass2Ty = InterExplodedGraphMap;
   InterExplodedGraphMap Pass2Scratch;
   Pass2Ty &Pass2 = ForwardMap ? *ForwardMap : Pass2Scratch;
 
+  // Each pass stamps the nodes it reaches with a fresh generation instead of
+  // collecting them into a visited set; the stamps make the visited queries
+  // O(1) with no hashing and keep this pass proportional to the trimmed
+  // subgraph rather than to a side table of it.
+  const unsigned ThisGeneration = ++VisitGeneration;
+  const auto isVisited = [ThisGeneration](const ExplodedNode *N) {
+    return N->VisitGeneration == ThisGeneration;
+  };
+  const auto markVisited = [ThisGeneration](const ExplodedNode *N) {
+    N->VisitGeneration = ThisGeneration;
+  };
+
   SmallVector<const ExplodedNode*, 10> WL1, WL2;
 
   // ===- Pass 1 (reverse DFS) -===
   for (const auto Sink : Sinks)
-    if (Sink)
+    if (Sink && !isVisited(Sink)) {
+      markVisited(Sink);
       WL1.push_back(Sink);
+    }
 
-  // Process the first worklist until it is empty.
+  // Process the first worklist until it is empty. Marking the nodes on push
+  // keeps every node on the worklist at most once.
   while (!WL1.empty()) {
     const ExplodedNode *N = WL1.pop_back_val();
 
-    // Have we already visited this node?  If so, continue to the next one.
-    if (!Pass1.insert(N).second)
-      continue;
-
     // If this is a root enqueue it to the second worklist.
     if (N->Preds.empty()) {
       WL2.push_back(N);
@@ -374,7 +383,11 @@ ExplodedGraph::trim(ArrayRef<const NodeTy *> Sinks,
     }
 
     // Visit our predecessors and enqueue them.
-    WL1.append(N->Preds.begin(), N->Preds.end());
+    for (const ExplodedNode *Pred : N->Preds)
+      if (!isVisited(Pred)) {
+        markVisited(Pred);
+        WL1.push_back(Pred);
+      }
   }
 
   // We didn't hit a root? Return with a null pointer for the new graph.
@@ -431,7 +444,7 @@ ExplodedGraph::trim(ArrayRef<const NodeTy *> Sinks,
       }
 
       // Enqueue nodes to the worklist that were marked during pass 1.
-      if (Pass1.count(*I))
+      if (isVisited(*I))
         WL2.push_back(*I);
     }
   }
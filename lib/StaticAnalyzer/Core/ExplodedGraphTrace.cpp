@@ -0,0 +1,148 @@
+//===- ExplodedGraphTrace.cpp - Binary trace of graph transitions ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the transition ring buffer and its on-disk format.
+//  A trace file is a sequence of independent segments, one per analyzed
+//  entry point:
+//
+//    char     Magic[4] = "XGTR"
+//    uint32   Version
+//    uint32   EntryPointNameLength, char EntryPointName[]
+//    uint64   NumRecorded       (transitions seen, including overwritten)
+//    uint32   NumStored         (transitions present in this segment)
+//    uint32   NumTags
+//    NumTags * (uint32 Length, char Description[])
+//    NumStored * Record         (fields in declaration order, little endian)
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraphTrace.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraph.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace ento;
+
+static const char ExplodedGraphTraceMagic[] = "XGTR";
+enum { ExplodedGraphTraceVersion = 1 };
+
+ExplodedGraphTrace::ExplodedGraphTrace(unsigned Log2Capacity) {
+  Buffer.reserve(1u << Log2Capacity);
+  Buffer.resize(1u << Log2Capacity);
+  // Reserve tag ID 0 for untagged program points.
+  TagNames.push_back("");
+}
+
+uint16_t ExplodedGraphTrace::getTagID(const void *Tag,
+                                      StringRef Description) {
+  auto Inserted = TagIDs.try_emplace(Tag, TagNames.size());
+  if (Inserted.second) {
+    // Saturate rather than grow the ID space; 65k distinct tags do not
+    // happen in practice.
+    if (TagNames.size() > UINT16_MAX) {
+      Inserted.first->second = 0;
+      return 0;
+    }
+    TagNames.push_back(Description.str());
+  }
+  return Inserted.first->second;
+}
+
+void ExplodedGraphTrace::recordTransition(const ExplodedNode *Pred,
+                                          const ExplodedNode *Succ,
+                                          ExplodedGraph &G) {
+  Record &R = Buffer[NumRecorded++ & (Buffer.size() - 1)];
+  R.PredID = Pred->getID(&G);
+  R.SuccID = Succ->getID(&G);
+
+  const ProgramPoint &PP = Succ->getLocation();
+  R.PointKind = PP.getKind();
+  R.StmtLoc = 0;
+  if (Optional<StmtPoint> SP = PP.getAs<StmtPoint>())
+    R.StmtLoc = SP->getStmt()->getBeginLoc().getRawEncoding();
+
+  R.TagID = 0;
+  if (const ProgramPointTag *Tag = PP.getTag())
+    R.TagID = getTagID(Tag, Tag->getTagDescription());
+
+  // Compare the state components by identity; this is what makes the
+  // recording cheap enough to stay enabled.
+  R.Flags = 0;
+  ProgramStateRef PredState = Pred->getState();
+  ProgramStateRef SuccState = Succ->getState();
+  if (PredState != SuccState) {
+    if (!(PredState->getEnvironment() == SuccState->getEnvironment()))
+      R.Flags |= SCF_Environment;
+    if (PredState->getStore() != SuccState->getStore())
+      R.Flags |= SCF_Store;
+    if (PredState->getGDM() != SuccState->getGDM())
+      R.Flags |= SCF_GDM;
+  }
+  if (Succ->isSink())
+    R.Flags |= SCF_Sink;
+}
+
+std::error_code ExplodedGraphTrace::appendTo(StringRef Path,
+                                             StringRef EntryPoint) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::OF_Append);
+  if (EC)
+    return EC;
+
+  auto EmitU32 = [&OS](uint32_t V) {
+    char Buf[4];
+    llvm::support::endian::write32le(Buf, V);
+    OS.write(Buf, sizeof(Buf));
+  };
+  auto EmitU64 = [&OS](uint64_t V) {
+    char Buf[8];
+    llvm::support::endian::write64le(Buf, V);
+    OS.write(Buf, sizeof(Buf));
+  };
+  auto EmitString = [&OS, &EmitU32](StringRef S) {
+    EmitU32(S.size());
+    OS.write(S.data(), S.size());
+  };
+
+  OS.write(ExplodedGraphTraceMagic, 4);
+  EmitU32(ExplodedGraphTraceVersion);
+  EmitString(EntryPoint);
+
+  const uint64_t NumStored = std::min<uint64_t>(NumRecorded, Buffer.size());
+  EmitU64(NumRecorded);
+  EmitU32(NumStored);
+
+  EmitU32(TagNames.size());
+  for (const std::string &Name : TagNames)
+    EmitString(Name);
+
+  // Emit the surviving records oldest first.
+  uint64_t First = NumRecorded - NumStored;
+  for (uint64_t I = 0; I != NumStored; ++I) {
+    const Record &R = Buffer[(First + I) & (Buffer.size() - 1)];
+    EmitU64(R.PredID);
+    EmitU64(R.SuccID);
+    EmitU32(R.StmtLoc);
+    OS.write(static_cast<char>(R.PointKind));
+    OS.write(static_cast<char>(R.Flags));
+    char TagBuf[2];
+    llvm::support::endian::write16le(TagBuf, R.TagID);
+    OS.write(TagBuf, sizeof(TagBuf));
+  }
+
+  // Reset for the next entry point; the tag table is rebuilt per segment so
+  // segments stay independently decodable.
+  NumRecorded = 0;
+  TagIDs.clear();
+  TagNames.clear();
+  TagNames.push_back("");
+  return OS.error();
+}
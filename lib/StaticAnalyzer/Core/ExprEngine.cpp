@@ -30,6 +30,7 @@
 #include "clang/AST/Type.h"
 #include "clang/Analysis/AnalysisDeclContext.h"
 #include "clang/Analysis/CFG.h"
+#include "clang/Analysis/CallArgumentFacts.h"
 #include "clang/Analysis/ConstructionContext.h"
 #include "clang/Analysis/ProgramPoint.h"
 #include "clang/Basic/IdentifierTable.h"
@@ -48,6 +49,7 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ConstraintManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CoreEngine.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/EngineStats.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraph.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/LoopUnrolling.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/LoopWidening.h"
@@ -87,15 +89,17 @@ using namespace ento;
 
 #define DEBUG_TYPE "ExprEngine"
 
-STATISTIC(NumRemoveDeadBindings,
+ENGINE_STATISTIC(NumRemoveDeadBindings,
             "The # of times RemoveDeadBindings is called");
-STATISTIC(NumMaxBlockCountReached,
+ENGINE_STATISTIC(NumBlockEntrancePurges,
+            "The # of dead binding purges anchored at a block entrance");
+ENGINE_STATISTIC(NumMaxBlockCountReached,
             "The # of aborted paths due to reaching the maximum block count in "
             "a top level function");
-STATISTIC(NumMaxBlockCountReachedInInlined,
+ENGINE_STATISTIC(NumMaxBlockCountReachedInInlined,
             "The # of aborted paths due to reaching the maximum block count in "
             "an inlined function");
-STATISTIC(NumTimesRetriedWithoutInlining,
+ENGINE_STATISTIC(NumTimesRetriedWithoutInlining,
             "The # of times we re-evaluated a call without inlining");
 
 //===----------------------------------------------------------------------===//
@@ -223,6 +227,9 @@ ExprEngine::ExprEngine(cross_tu::CrossTranslationUnitContext &CTU,
     // Enable eager node reclamation when constructing the ExplodedGraph.
     G.enableNodeReclamation(TrimInterval);
   }
+
+  if (!mgr.options.TransitionTraceFile.empty())
+    G.enableTracing();
 }
 
 //===----------------------------------------------------------------------===//
@@ -303,6 +310,56 @@ ProgramStateRef ExprEngine::getInitialState(const LocationContext *InitLoc) {
     }
   }
 
+  // Precondition: when every caller of a TU-local function is visible and
+  // agrees on a fact about an argument (a non-null pointer, one identical
+  // constant), seed it into the entry state of the top-level frame so the
+  // analysis does not split on conditions no caller can trigger.
+  if (AMgr.options.ShouldSeedCallArgumentFacts &&
+      InitLoc->getStackFrame()->getParent() == nullptr) {
+    if (const auto *FD = dyn_cast<FunctionDecl>(D))
+      state = seedCallArgumentFacts(state, FD, InitLoc);
+  }
+
+  return state;
+}
+
+ProgramStateRef
+ExprEngine::seedCallArgumentFacts(ProgramStateRef state, const FunctionDecl *FD,
+                                  const LocationContext *InitLoc) {
+  const CallArgumentFacts::FunctionFacts *FF =
+      AMgr.getCallArgumentFacts().lookup(FD);
+  if (!FF)
+    return state;
+
+  for (unsigned I = 0, N = FD->getNumParams(); I != N; ++I) {
+    if (I >= FF->Params.size())
+      break;
+    const CallArgumentFacts::ParamFacts &PF = FF->Params[I];
+    const ParmVarDecl *PD = FD->getParamDecl(I);
+
+    const MemRegion *R = state->getRegion(PD, InitLoc);
+    if (!R)
+      continue;
+    SVal V = state->getSVal(loc::MemRegionVal(R));
+
+    if (PF.AlwaysNonNull && PD->getType()->isPointerType()) {
+      if (Optional<Loc> LV = V.getAs<Loc>())
+        if (ProgramStateRef NewState = state->assume(*LV, true))
+          state = NewState;
+      continue;
+    }
+
+    if (PF.UniqueConstant && PD->getType()->isIntegralOrEnumerationType()) {
+      SVal Constant = svalBuilder.makeIntVal(*PF.UniqueConstant);
+      SVal Cond = evalBinOp(state, BO_EQ, V, Constant,
+                            svalBuilder.getConditionType());
+      if (Optional<DefinedOrUnknownSVal> DV =
+              Cond.getAs<DefinedOrUnknownSVal>())
+        if (ProgramStateRef NewState = state->assume(*DV, true))
+          state = NewState;
+    }
+  }
+
   return state;
 }
 
@@ -1938,7 +1995,8 @@ void ExprEngine::processCFGBlockEntrance(const BlockEdge &L,
     // Widen.
     const LocationContext *LCtx = Pred->getLocationContext();
     ProgramStateRef WidenedState =
-        getWidenedLoopState(Pred->getState(), LCtx, BlockCount, Term);
+        getWidenedLoopState(Pred->getState(), LCtx, BlockCount, Term,
+                            AMgr.options.ShouldWidenLoopsOnlyModified);
     nodeBuilder.generateNode(WidenedState, Pred);
     return;
   }
@@ -1971,7 +2029,110 @@ void ExprEngine::processCFGBlockEntrance(const BlockEdge &L,
 
     // Make sink nodes as exhausted(for stats) only if retry failed.
     Engine.blocksExhausted.push_back(std::make_pair(L, Sink));
+    return;
+  }
+
+  // Purge dead bindings on edges into statement-less blocks, so that paths
+  // whose states differ only in dead values merge here instead of staying
+  // apart for the rest of the function.
+  if (AMgr.options.ShouldPurgeDeadOnBlockEntrance)
+    removeDeadOnBlockEntrance(L, nodeBuilder, Pred);
+}
+
+void ExprEngine::removeDeadOnBlockEntrance(const BlockEdge &L,
+                                           NodeBuilderWithSinks &Bldr,
+                                           ExplodedNode *Pred) {
+  if (AMgr.options.AnalysisPurgeOpt == PurgeNone)
+    return;
+
+  // Blocks that begin with a statement get their purge from ProcessStmt
+  // right before that statement runs; only the anchor-less blocks (empty
+  // ones and those starting with implicit destructors or scope markers) are
+  // handled here.
+  const CFGBlock *Blk = L.getDst();
+  if (!Blk->empty() && Blk->front().getAs<CFGStmt>())
+    return;
+
+  // The dead-symbol checker callbacks need a statement to anchor their
+  // diagnostics on; the just-executed terminator of the source block is the
+  // natural one.
+  const Stmt *Term = L.getSrc()->getTerminatorStmt();
+  if (!Term)
+    return;
+
+  NumBlockEntrancePurges++;
+  // The dead-symbol checkers reach the node builder context through
+  // getBuilderContext(); point it at the entrance builder's context for the
+  // duration of the purge, mirroring what processBranch does.
+  currBldrCtx = &const_cast<NodeBuilderContext &>(Bldr.getContext());
+  ProgramStateRef CleanedState = Pred->getState();
+
+  // Anchor liveness at the exit of the source block. This over-approximates
+  // what is live on the edge itself, so the purge is never more aggressive
+  // than the statement-anchored one that a later block would perform.
+  const StackFrameContext *SFC = Pred->getLocationContext()->getStackFrame();
+  SymbolReaper SymReaper(SFC, L.getSrc(), SymMgr, getStoreManager());
+
+  for (auto I : CleanedState->get<ObjectsUnderConstruction>()) {
+    if (SymbolRef Sym = I.second.getAsSymbol())
+      SymReaper.markLive(Sym);
+    if (const MemRegion *MR = I.second.getAsRegion())
+      SymReaper.markLive(MR);
   }
+
+  getCheckerManager().runCheckersForLiveSymbols(CleanedState, SymReaper);
+
+  CleanedState = StateMgr.removeDeadBindings(CleanedState, SFC, SymReaper);
+
+  // If nothing died, there is nothing to merge; let the edge proceed as if
+  // the purge never happened rather than paying for an extra node.
+  if (CleanedState == Pred->getState()) {
+    currBldrCtx = nullptr;
+    return;
+  }
+
+  // Call checkers with the non-cleaned state so that they could query the
+  // values of the soon to be dead symbols.
+  ExplodedNodeSet CheckedSet;
+  getCheckerManager().runCheckersForDeadSymbols(
+      CheckedSet, Pred, SymReaper, Term, *this,
+      ProgramPoint::PostStmtPurgeDeadSymbolsKind);
+
+  // Identical cleaned states produce the same BlockEntrance program point,
+  // so the paths unify through the ExplodedGraph's node uniquing.
+  static SimpleProgramPointTag cleanupTag(TagProviderName,
+                                          "Clean Block Entrance");
+
+  // If the dead-symbol checkers sank every path, keep the edge from
+  // auto-advancing with the unpurged state.
+  if (CheckedSet.empty()) {
+    Bldr.generateSink(Pred->getState(), Pred, &cleanupTag);
+    currBldrCtx = nullptr;
+    return;
+  }
+
+  for (const auto I : CheckedSet) {
+    ProgramStateRef CheckerState =
+        getConstraintManager().removeDeadBindings(I->getState(), SymReaper);
+
+    assert(StateMgr.haveEqualEnvironments(CheckerState, Pred->getState()) &&
+           "Checkers are not allowed to modify the Environment as a part of "
+           "checkDeadSymbols processing.");
+    assert(StateMgr.haveEqualStores(CheckerState, Pred->getState()) &&
+           "Checkers are not allowed to modify the Store as a part of "
+           "checkDeadSymbols processing.");
+
+    ProgramStateRef CleanedCheckerSt =
+        StateMgr.getPersistentStateWithGDM(CleanedState, CheckerState);
+    Bldr.generateNode(CleanedCheckerSt, I, &cleanupTag);
+  }
+
+  // The purged nodes descend from the intermediate checker nodes, so the
+  // original predecessor is never erased from the entrance builder's
+  // frontier; drop it by hand or the edge would be explored both with and
+  // without the purge.
+  Bldr.takeNodes(Pred);
+  currBldrCtx = nullptr;
 }
 
 //===----------------------------------------------------------------------===//
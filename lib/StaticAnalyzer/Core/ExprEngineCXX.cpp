@@ -19,10 +19,20 @@
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/EngineStats.h"
 
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "ExprEngine"
+
+ENGINE_STATISTIC(NumArgumentsConstructedInCallee,
+                 "The # of call arguments constructed directly into the "
+                 "future callee's parameter region");
+ENGINE_STATISTIC(NumImproperlyModeledConstructionTargets,
+                 "The # of constructions that fell back to a temporary "
+                 "region because their target could not be modeled");
+
 void ExprEngine::CreateCXXTemporaryObject(const MaterializeTemporaryExpr *ME,
                                           ExplodedNode *Pred,
                                           ExplodedNodeSet &Dst) {
@@ -377,6 +387,11 @@ std::pair<ProgramStateRef, SVal> ExprEngine::prepareForObjectConstruction(
 
       assert(!V.isUnknown());
 
+      // Constructing straight into the future parameter region elides the
+      // temporary that the argument would otherwise be copied from when the
+      // call is entered.
+      ++NumArgumentsConstructedInCallee;
+
       if (BTE)
         State = addObjectUnderConstruction(State, BTE, LCtx, V);
 
@@ -386,6 +401,7 @@ std::pair<ProgramStateRef, SVal> ExprEngine::prepareForObjectConstruction(
   }
   // If we couldn't find an existing region to construct into, assume we're
   // constructing a temporary. Notify the caller of our failure.
+  ++NumImproperlyModeledConstructionTargets;
   CallOpts.IsCtorOrDtorWithImproperlyModeledTargetRegion = true;
   return std::make_pair(
       State, loc::MemRegionVal(MRMgr.getCXXTempObjectRegion(E, LCtx)));
@@ -14,10 +14,12 @@
 #include "PrettyStackTraceLocationContext.h"
 #include "clang/AST/CXXInheritance.h"
 #include "clang/AST/DeclCXX.h"
+#include "clang/AST/ExprCXX.h"
 #include "clang/Analysis/Analyses/LiveVariables.h"
 #include "clang/Analysis/ConstructionContext.h"
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/EngineStats.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/SaveAndRestore.h"
@@ -27,15 +29,21 @@ using namespace ento;
 
 #define DEBUG_TYPE "ExprEngine"
 
-STATISTIC(NumOfDynamicDispatchPathSplits,
+ENGINE_STATISTIC(NumOfDynamicDispatchPathSplits,
   "The # of times we split the path due to imprecise dynamic dispatch info");
 
-STATISTIC(NumInlinedCalls,
+ENGINE_STATISTIC(NumInlinedCalls,
   "The # of times we inlined a call");
 
-STATISTIC(NumReachedInlineCountMax,
+ENGINE_STATISTIC(NumReachedInlineCountMax,
   "The # of times we reached inline count maximum");
 
+ENGINE_STATISTIC(NumReachedInlineCostMax,
+  "The # of times a callee was rejected for its recorded block visit rate");
+
+ENGINE_STATISTIC(NumReturnSummariesApplied,
+  "The # of times a call was modeled by a return-value summary");
+
 void ExprEngine::processCallEnter(NodeBuilderContext& BC, CallEnter CE,
                                   ExplodedNode *Pred) {
   // Get the entry block in the CFG of the callee.
@@ -364,24 +372,46 @@ void ExprEngine::processCallExit(ExplodedNode *CEBNode) {
   }
 }
 
-bool ExprEngine::isSmall(AnalysisDeclContext *ADC) const {
+/// Compute and memoize the CFG size classification of the function. The
+/// classification is queried for every stack frame at every call site, and
+/// the linearity check walks the CFG, so the verdicts are recorded in the
+/// function summary on the first query.
+static void classifyCFGSize(AnalysisDeclContext *ADC, FunctionSummariesTy &FS,
+                            AnalyzerOptions &Opts) {
   // When there are no branches in the function, it means that there's no
   // exponential complexity introduced by inlining such function.
   // Such functions also don't trigger various fundamental problems
   // with our inlining mechanism, such as the problem of
   // inlined defensive checks. Hence isLinear().
   const CFG *Cfg = ADC->getCFG();
-  return Cfg->isLinear() || Cfg->size() <= AMgr.options.AlwaysInlineSize;
+  bool Small = Cfg->isLinear() || Cfg->size() <= Opts.AlwaysInlineSize;
+  bool Large = Cfg->size() >= Opts.MinCFGSizeTreatFunctionsAsLarge;
+  bool Huge = Cfg->getNumBlockIDs() > Opts.MaxInlinableSize;
+  FS.markSizeClass(ADC->getDecl(), Small, Large, Huge);
+}
+
+bool ExprEngine::isSmall(AnalysisDeclContext *ADC) const {
+  const Decl *D = ADC->getDecl();
+  if (Optional<bool> Small = Engine.FunctionSummaries->isSmall(D))
+    return *Small;
+  classifyCFGSize(ADC, *Engine.FunctionSummaries, AMgr.options);
+  return *Engine.FunctionSummaries->isSmall(D);
 }
 
 bool ExprEngine::isLarge(AnalysisDeclContext *ADC) const {
-  const CFG *Cfg = ADC->getCFG();
-  return Cfg->size() >= AMgr.options.MinCFGSizeTreatFunctionsAsLarge;
+  const Decl *D = ADC->getDecl();
+  if (Optional<bool> Large = Engine.FunctionSummaries->isLarge(D))
+    return *Large;
+  classifyCFGSize(ADC, *Engine.FunctionSummaries, AMgr.options);
+  return *Engine.FunctionSummaries->isLarge(D);
 }
 
 bool ExprEngine::isHuge(AnalysisDeclContext *ADC) const {
-  const CFG *Cfg = ADC->getCFG();
-  return Cfg->getNumBlockIDs() > AMgr.options.MaxInlinableSize;
+  const Decl *D = ADC->getDecl();
+  if (Optional<bool> Huge = Engine.FunctionSummaries->isHuge(D))
+    return *Huge;
+  classifyCFGSize(ADC, *Engine.FunctionSummaries, AMgr.options);
+  return *Engine.FunctionSummaries->isHuge(D);
 }
 
 void ExprEngine::examineStackFrames(const Decl *D, const LocationContext *LCtx,
@@ -680,6 +710,98 @@ void ExprEngine::conservativeEvalCall(const CallEvent &Call, NodeBuilder &Bldr,
   Bldr.generateNode(Call.getProgramPoint(), State, Pred);
 }
 
+/// Compute a reusable return-value summary of \p FD, if its body is trivial
+/// enough: a single return statement yielding a literal or an unmodified
+/// parameter. Such a body has no effects at all, so the call can be modeled
+/// by binding the return value alone.
+static Optional<ReturnSummary> computeReturnSummary(const FunctionDecl *FD,
+                                                    ASTContext &Ctx) {
+  if (FD->isVariadic() || FD->getReturnType()->isReferenceType())
+    return None;
+
+  const auto *Body = dyn_cast_or_null<CompoundStmt>(FD->getBody());
+  if (!Body || Body->size() != 1)
+    return None;
+
+  const auto *Ret = dyn_cast<ReturnStmt>(Body->body_front());
+  if (!Ret || !Ret->getRetValue())
+    return None;
+
+  // Strip only the casts that do not change the value; anything else (an
+  // integral conversion, a null-to-pointer cast, ...) would have to be
+  // re-modeled at the call site.
+  const Expr *RetVal = Ret->getRetValue()->IgnoreParens();
+  while (const auto *ICE = dyn_cast<ImplicitCastExpr>(RetVal)) {
+    if (ICE->getCastKind() != CK_LValueToRValue &&
+        ICE->getCastKind() != CK_NoOp)
+      return None;
+    RetVal = ICE->getSubExpr()->IgnoreParens();
+  }
+
+  if (isa<IntegerLiteral>(RetVal) || isa<CXXBoolLiteralExpr>(RetVal))
+    return ReturnSummary::makeLiteral(RetVal);
+
+  if (const auto *DRE = dyn_cast<DeclRefExpr>(RetVal))
+    if (const auto *PVD = dyn_cast<ParmVarDecl>(DRE->getDecl()))
+      if (!PVD->getType()->isReferenceType() &&
+          PVD->getType()->isScalarType() &&
+          Ctx.hasSameUnqualifiedType(PVD->getType(), FD->getReturnType()))
+        return ReturnSummary::makeParameter(PVD->getFunctionScopeIndex());
+
+  return None;
+}
+
+bool ExprEngine::tryApplyReturnSummary(const CallEvent &Call, NodeBuilder &Bldr,
+                                       ExplodedNode *Pred,
+                                       ProgramStateRef State) {
+  // Only plain function calls have a stable callee with matching argument
+  // and parameter lists.
+  if (Call.getKind() != CE_Function)
+    return false;
+
+  const Expr *E = Call.getOriginExpr();
+  if (!E || !Call.getResultType()->isScalarType())
+    return false;
+
+  const auto *FD =
+      dyn_cast_or_null<FunctionDecl>(Call.getRuntimeDefinition().getDecl());
+  if (!FD || !FD->hasBody())
+    return false;
+
+  Optional<ReturnSummary> Summary =
+      Engine.FunctionSummaries->getOrComputeReturnSummary(
+          FD, [&] { return computeReturnSummary(FD, getContext()); });
+  if (!Summary)
+    return false;
+
+  SVal V;
+  switch (Summary->getKind()) {
+  case ReturnSummary::Literal: {
+    const Expr *Lit = Summary->getLiteral();
+    if (const auto *IL = dyn_cast<IntegerLiteral>(Lit))
+      V = svalBuilder.makeIntVal(IL);
+    else
+      V = svalBuilder.makeTruthVal(cast<CXXBoolLiteralExpr>(Lit)->getValue(),
+                                   Lit->getType());
+    break;
+  }
+  case ReturnSummary::Parameter: {
+    unsigned Idx = Summary->getParamIndex();
+    if (Idx >= Call.getNumArgs() ||
+        !getContext().hasSameUnqualifiedType(Call.getArgExpr(Idx)->getType(),
+                                             Call.getResultType()))
+      return false;
+    V = Call.getArgSVal(Idx);
+    break;
+  }
+  }
+
+  ++NumReturnSummariesApplied;
+  State = State->BindExpr(E, Pred->getLocationContext(), V);
+  Bldr.generateNode(Call.getProgramPoint(), State, Pred);
+  return true;
+}
+
 ExprEngine::CallInlinePolicy
 ExprEngine::mayInlineCallKind(const CallEvent &Call, const ExplodedNode *Pred,
                               AnalyzerOptions &Opts,
@@ -980,6 +1102,21 @@ bool ExprEngine::shouldInlineCall(const CallEvent &Call, const Decl *D,
     return false;
   }
 
+  // Do not keep inlining callees that have historically burned the budget.
+  // Once the basic-block visits recorded for a callee exceed the configured
+  // rate per inlining, further calls to it are evaluated conservatively: the
+  // visits are a cheap proxy for the exploded nodes the callee expands into
+  // at every new call site.
+  if (unsigned MaxVisitRate = Opts.InlineMaxBlockVisitRate) {
+    unsigned TimesInlined = Engine.FunctionSummaries->getNumTimesInlined(D);
+    if (TimesInlined > 0 &&
+        Engine.FunctionSummaries->getNumBlockVisits(D) >
+            MaxVisitRate * TimesInlined) {
+      NumReachedInlineCostMax++;
+      return false;
+    }
+  }
+
   if (HowToInline == Inline_Minimal && (!isSmall(CalleeADC) || IsRecursive))
     return false;
 
@@ -1013,6 +1150,12 @@ void ExprEngine::defaultEvalCall(NodeBuilder &Bldr, ExplodedNode *Pred,
     return;
   }
 
+  // Model trivial callees from their return-value summary instead of
+  // inlining the same body again at every call site.
+  if (getAnalysisManager().options.ShouldUseReturnSummaries &&
+      tryApplyReturnSummary(*Call, Bldr, Pred, State))
+    return;
+
   // Try to inline the call.
   // The origin expression here is just used as a kind of checksum;
   // this should still be safe even for CallEvents that don't come from exprs.
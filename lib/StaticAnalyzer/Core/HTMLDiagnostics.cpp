@@ -65,6 +65,16 @@ class HTMLDiagnostics : public PathDiagnosticConsumer {
   AnalyzerOptions &AnalyzerOpts;
   const bool SupportsCrossFileDiagnostics;
 
+  // Pass this to the highlighting passes so that a file referenced by many
+  // reports is only lexed and re-preprocessed for the first one; later
+  // reports replay the recorded highlights.
+  html::RelexRewriteCacheRef RewriterCache =
+      html::instantiateRelexRewriteCache();
+
+  /// Shares the issue hash line normalization between the reports of the
+  /// translation unit.
+  IssueHashLineCache IssueHashCache;
+
 public:
   HTMLDiagnostics(AnalyzerOptions &AnalyzerOpts,
                   const std::string& prefix,
@@ -556,7 +566,7 @@ void HTMLDiagnostics::FinalizeHTML(const PathDiagnostic& D, Rewriter &R,
 
     os << "\n<!-- ISSUEHASHCONTENTOFLINEINCONTEXT "
        << GetIssueHash(SMgr, L, D.getCheckName(), D.getBugType(), DeclWithIssue,
-                       PP.getLangOpts()) << " -->\n";
+                       PP.getLangOpts(), &IssueHashCache) << " -->\n";
 
     os << "\n<!-- BUGLINE "
        << LineNumber
@@ -730,8 +740,8 @@ void HTMLDiagnostics::RewriteFile(Rewriter &R,
   // If we have a preprocessor, relex the file and syntax highlight.
   // We might not have a preprocessor if we come from a deserialized AST file,
   // for example.
-  html::SyntaxHighlight(R, FID, PP);
-  html::HighlightMacros(R, FID, PP);
+  html::SyntaxHighlight(R, FID, PP, RewriterCache);
+  html::HighlightMacros(R, FID, PP, RewriterCache);
 }
 
 void HTMLDiagnostics::HandlePiece(Rewriter &R, FileID BugFileID,
@@ -183,13 +183,29 @@ std::string clang::GetIssueString(const SourceManager &SM,
                                   FullSourceLoc &IssueLoc,
                                   StringRef CheckerName, StringRef BugType,
                                   const Decl *D,
-                                  const LangOptions &LangOpts) {
+                                  const LangOptions &LangOpts,
+                                  IssueHashLineCache *LineCache) {
   static StringRef Delimiter = "$";
 
+  std::string NormalizedLine;
+  if (LineCache) {
+    // The normalization depends only on the file and the line, so reports
+    // pointing at the same line share one re-lexing. The empty string is
+    // the not-yet-computed sentinel; a line that normalizes to it (an
+    // all-whitespace line) is merely recomputed.
+    std::string &Cached = LineCache->Lines[std::make_pair(
+        IssueLoc.getFileID(), IssueLoc.getExpansionLineNumber())];
+    if (Cached.empty())
+      Cached = NormalizeLine(SM, IssueLoc, LangOpts);
+    NormalizedLine = Cached;
+  } else {
+    NormalizedLine = NormalizeLine(SM, IssueLoc, LangOpts);
+  }
+
   return (llvm::Twine(CheckerName) + Delimiter +
           GetEnclosingDeclContextSignature(D) + Delimiter +
           Twine(IssueLoc.getExpansionColumnNumber()) + Delimiter +
-          NormalizeLine(SM, IssueLoc, LangOpts) + Delimiter + BugType)
+          NormalizedLine + Delimiter + BugType)
       .str();
 }
 
@@ -197,8 +213,10 @@ SmallString<32> clang::GetIssueHash(const SourceManager &SM,
                                     FullSourceLoc &IssueLoc,
                                     StringRef CheckerName, StringRef BugType,
                                     const Decl *D,
-                                    const LangOptions &LangOpts) {
+                                    const LangOptions &LangOpts,
+                                    IssueHashLineCache *LineCache) {
 
   return GetHashOfContent(
-      GetIssueString(SM, IssueLoc, CheckerName, BugType, D, LangOpts));
+      GetIssueString(SM, IssueLoc, CheckerName, BugType, D, LangOpts,
+                     LineCache));
 }
@@ -17,6 +17,7 @@
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraph.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/LoopWidening.h"
+#include "llvm/ADT/SetVector.h"
 
 using namespace clang;
 using namespace ento;
@@ -38,16 +39,127 @@ static const Expr *getLoopCondition(const Stmt *LoopStmt) {
   }
 }
 
+/// Resolve the variable that is modified by a store to the lvalue \p E and
+/// add it to \p Vars. Return false if the store cannot be attributed to a
+/// specific variable, e.g. because it goes through a pointer.
+static bool addModifiedVar(const Expr *E,
+                           llvm::SmallSetVector<const VarDecl *, 16> &Vars) {
+  E = E->IgnoreParenCasts();
+  while (true) {
+    if (const auto *ME = dyn_cast<MemberExpr>(E)) {
+      // A store through 'a->b' modifies the pointee, not a known variable.
+      if (ME->isArrow())
+        return false;
+      E = ME->getBase()->IgnoreParenCasts();
+      continue;
+    }
+    if (const auto *ASE = dyn_cast<ArraySubscriptExpr>(E)) {
+      const Expr *Base = ASE->getBase()->IgnoreParenCasts();
+      // Subscripts on pointers store through the pointee as well.
+      if (Base->getType()->isPointerType())
+        return false;
+      E = Base;
+      continue;
+    }
+    break;
+  }
+  if (const auto *DRE = dyn_cast<DeclRefExpr>(E))
+    if (const auto *VD = dyn_cast<VarDecl>(DRE->getDecl())) {
+      // A reference stands for some other object.
+      if (VD->getType()->isReferenceType())
+        return false;
+      Vars.insert(VD);
+      return true;
+    }
+  return false;
+}
+
+/// Collect the variables the statement \p S can modify into \p Vars. Return
+/// false if \p S has effects that cannot be attributed to specific variables,
+/// in which case the caller has to fall back to invalidating everything
+/// reachable.
+static bool
+collectModifiedVars(const Stmt *S,
+                    llvm::SmallSetVector<const VarDecl *, 16> &Vars) {
+  if (!S)
+    return true;
+
+  // Calls can modify anything their arguments point to as well as any
+  // global, and inline assembly is entirely opaque.
+  if (isa<CallExpr>(S) || isa<CXXConstructExpr>(S) || isa<ObjCMessageExpr>(S) ||
+      isa<AsmStmt>(S))
+    return false;
+
+  if (const auto *BO = dyn_cast<BinaryOperator>(S)) {
+    if (BO->isAssignmentOp() && !addModifiedVar(BO->getLHS(), Vars))
+      return false;
+  } else if (const auto *UO = dyn_cast<UnaryOperator>(S)) {
+    if (UO->isIncrementDecrementOp() &&
+        !addModifiedVar(UO->getSubExpr(), Vars))
+      return false;
+  }
+
+  for (const Stmt *Child : S->children())
+    if (!collectModifiedVars(Child, Vars))
+      return false;
+  return true;
+}
+
+/// Try to widen the loop by invalidating only the variables it can modify,
+/// leaving all other bindings and constraints intact. Returns null if the
+/// loop's effects cannot be attributed to specific variables.
+static ProgramStateRef widenModifiedVars(ProgramStateRef PrevState,
+                                         const LocationContext *LCtx,
+                                         unsigned BlockCount,
+                                         const Stmt *LoopStmt) {
+  const Stmt *Body;
+  const Expr *Inc = nullptr;
+  if (const auto *FS = dyn_cast<ForStmt>(LoopStmt)) {
+    Body = FS->getBody();
+    Inc = FS->getInc();
+  } else if (const auto *WS = dyn_cast<WhileStmt>(LoopStmt)) {
+    Body = WS->getBody();
+  } else {
+    Body = cast<DoStmt>(LoopStmt)->getBody();
+  }
+
+  // The condition can have side effects too, e.g. 'while (i++ < n)'.
+  llvm::SmallSetVector<const VarDecl *, 16> ModifiedVars;
+  if (!collectModifiedVars(getLoopCondition(LoopStmt), ModifiedVars) ||
+      !collectModifiedVars(Body, ModifiedVars) ||
+      !collectModifiedVars(Inc, ModifiedVars))
+    return nullptr;
+
+  // If the loop cannot modify anything, no iteration can change the state,
+  // so the last seen state already approximates all further iterations.
+  if (ModifiedVars.empty())
+    return PrevState;
+
+  MemRegionManager &MRMgr = PrevState->getStateManager().getRegionManager();
+  SmallVector<const MemRegion *, 16> Regions;
+  for (const VarDecl *VD : ModifiedVars)
+    Regions.push_back(MRMgr.getVarRegion(VD, LCtx));
+
+  return PrevState->invalidateRegions(Regions, getLoopCondition(LoopStmt),
+                                      BlockCount, LCtx, true);
+}
+
 namespace clang {
 namespace ento {
 
 ProgramStateRef getWidenedLoopState(ProgramStateRef PrevState,
                                     const LocationContext *LCtx,
-                                    unsigned BlockCount, const Stmt *LoopStmt) {
+                                    unsigned BlockCount, const Stmt *LoopStmt,
+                                    bool OnlyModified) {
 
   assert(isa<ForStmt>(LoopStmt) || isa<WhileStmt>(LoopStmt) ||
          isa<DoStmt>(LoopStmt));
 
+  if (OnlyModified)
+    if (ProgramStateRef WidenedState =
+            widenModifiedVars(PrevState, LCtx, BlockCount, LoopStmt))
+      return WidenedState;
+
   // Invalidate values in the current state.
   // TODO Make this more conservative by only invalidating values that might
   //      be modified by the body of the loop.
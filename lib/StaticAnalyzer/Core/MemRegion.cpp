@@ -73,6 +73,7 @@ RegionTy* MemRegionManager::getSubRegion(const Arg1Ty arg1,
   if (!R) {
     R = A.Allocate<RegionTy>();
     new (R) RegionTy(arg1, superRegion);
+    R->Id = NextRegionId++;
     Regions.InsertNode(R, InsertPos);
   }
 
@@ -90,6 +91,7 @@ RegionTy* MemRegionManager::getSubRegion(const Arg1Ty arg1, const Arg2Ty arg2,
   if (!R) {
     R = A.Allocate<RegionTy>();
     new (R) RegionTy(arg1, arg2, superRegion);
+    R->Id = NextRegionId++;
     Regions.InsertNode(R, InsertPos);
   }
 
@@ -109,6 +111,7 @@ RegionTy* MemRegionManager::getSubRegion(const Arg1Ty arg1, const Arg2Ty arg2,
   if (!R) {
     R = A.Allocate<RegionTy>();
     new (R) RegionTy(arg1, arg2, arg3, superRegion);
+    R->Id = NextRegionId++;
     Regions.InsertNode(R, InsertPos);
   }
 
@@ -722,6 +725,7 @@ const REG *MemRegionManager::LazyAllocate(REG*& region) {
   if (!region) {
     region = A.Allocate<REG>();
     new (region) REG(this);
+    region->Id = NextRegionId++;
   }
 
   return region;
@@ -732,6 +736,7 @@ const REG *MemRegionManager::LazyAllocate(REG*& region, ARG a) {
   if (!region) {
     region = A.Allocate<REG>();
     new (region) REG(this, a);
+    region->Id = NextRegionId++;
   }
 
   return region;
@@ -747,6 +752,7 @@ MemRegionManager::getStackLocalsRegion(const StackFrameContext *STC) {
 
   R = A.Allocate<StackLocalsSpaceRegion>();
   new (R) StackLocalsSpaceRegion(this, STC);
+  R->Id = NextRegionId++;
   return R;
 }
 
@@ -760,6 +766,7 @@ MemRegionManager::getStackArgumentsRegion(const StackFrameContext *STC) {
 
   R = A.Allocate<StackArgumentsSpaceRegion>();
   new (R) StackArgumentsSpaceRegion(this, STC);
+  R->Id = NextRegionId++;
   return R;
 }
 
@@ -782,6 +789,7 @@ const GlobalsSpaceRegion
 
   R = A.Allocate<StaticGlobalSpaceRegion>();
   new (R) StaticGlobalSpaceRegion(this, CR);
+  R->Id = NextRegionId++;
   return R;
 }
 
@@ -1001,6 +1009,7 @@ MemRegionManager::getElementRegion(QualType elementType, NonLoc Idx,
   if (!R) {
     R = A.Allocate<ElementRegion>();
     new (R) ElementRegion(T, Idx, superRegion);
+    R->Id = NextRegionId++;
     Regions.InsertNode(R, InsertPos);
   }
 
@@ -1618,3 +1627,12 @@ bool RegionAndSymbolInvalidationTraits::hasTrait(const MemRegion *MR,
 
   return false;
 }
+
+bool RegionAndSymbolInvalidationTraits::hasTraitForAnyRegion(
+    InvalidationKinds IK) const {
+  for (const auto &Entry : MRTraitsMap)
+    if (Entry.second & IK)
+      return true;
+
+  return false;
+}
@@ -212,6 +212,58 @@ PathDiagnosticConsumer::~PathDiagnosticConsumer() {
   // Delete the contents of the FoldingSet if it isn't empty already.
   for (auto &Diag : Diags)
     delete &Diag;
+  for (PDSharedPiece &Piece : SharedPieces)
+    Piece.~PDSharedPiece();
+}
+
+bool PathDiagnosticConsumer::sharePiece(
+    std::shared_ptr<PathDiagnosticPiece> &Piece) {
+  // Unique the subtree first, so that two calls whose inner paths are already
+  // shared piece-for-piece hash to the same profile below.
+  bool SubtreeShareable = true;
+  if (auto *Call = dyn_cast<PathDiagnosticCallPiece>(Piece.get()))
+    SubtreeShareable = sharePieces(Call->path);
+  else if (auto *Macro = dyn_cast<PathDiagnosticMacroPiece>(Piece.get()))
+    SubtreeShareable = sharePieces(Macro->subPieces);
+
+  // The "last piece in the main file" marker is not part of the profile but
+  // changes how the piece is rendered, so keep such subtrees per-report.
+  if (!SubtreeShareable || Piece->isLastInMainSourceFile())
+    return false;
+
+  llvm::FoldingSetNodeID Profile;
+  Piece->Profile(Profile);
+
+  // PathDiagnosticCallPiece::Profile only covers the inner path; mix in the
+  // locations and declarations the call itself is rendered from, so that two
+  // different calls with an identical inner path are not merged.
+  if (const auto *Call = dyn_cast<PathDiagnosticCallPiece>(Piece.get())) {
+    Profile.Add(Call->callEnter);
+    Profile.Add(Call->callEnterWithin);
+    Profile.Add(Call->callReturn);
+    Profile.AddPointer(Call->getCaller());
+    Profile.AddPointer(Call->getCallee());
+  }
+
+  void *InsertPos = nullptr;
+  if (PDSharedPiece *Shared =
+          SharedPieces.FindNodeOrInsertPos(Profile, InsertPos)) {
+    Piece = Shared->Piece;
+    return true;
+  }
+
+  PDSharedPiece *Entry = PieceAlloc.Allocate<PDSharedPiece>();
+  Entry = new (Entry) PDSharedPiece(Profile, Piece);
+  SharedPieces.InsertNode(Entry, InsertPos);
+  return true;
+}
+
+bool PathDiagnosticConsumer::sharePieces(PathPieces &Path) {
+  bool AllShareable = true;
+  for (auto &Piece : Path)
+    if (!sharePiece(Piece))
+      AllShareable = false;
+  return AllShareable;
 }
 
 void PathDiagnosticConsumer::HandlePathDiagnostic(
@@ -279,6 +331,20 @@ void PathDiagnosticConsumer::HandlePathDiagnostic(
       return; // FIXME: Emit a warning?
   }
 
+  // Streaming consumers emit the diagnostic right away instead of collecting
+  // it, trading the deduplication of profile-identical reports for not
+  // keeping every path alive until the end of the translation unit.
+  if (supportsStreaming()) {
+    StreamDiagnosticImpl(*D);
+    return;
+  }
+
+  // Reports from one entry point often share a long prefix of pieces (the
+  // same call chain into a header). Unique the pieces against the ones held
+  // by the already stored diagnostics, so that each distinct subtree is kept
+  // only once until the diagnostics are flushed.
+  sharePieces(D->path);
+
   // Profile the node to see if we already have something matching it
   llvm::FoldingSetNodeID profile;
   D->Profile(profile);
@@ -492,6 +558,11 @@ void PathDiagnosticConsumer::FlushDiagnostics(
 
   // Clear out the FoldingSet.
   Diags.clear();
+
+  // Drop the piece-sharing table together with the diagnostics it served.
+  for (PDSharedPiece &Piece : SharedPieces)
+    Piece.~PDSharedPiece();
+  SharedPieces.clear();
 }
 
 PathDiagnosticConsumer::FilesMade::~FilesMade() {
@@ -0,0 +1,142 @@
+//===- PhaseTimers.cpp - Hierarchical timers for analyzer phases ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the phase timer tree behind the 'phase-timers'
+//  config option.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/StaticAnalyzer/Core/PathSensitive/PhaseTimers.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cassert>
+
+using namespace clang;
+using namespace ento;
+
+using llvm::StringRef;
+
+bool PhaseTimers::Enabled = false;
+PhaseTimers::Node PhaseTimers::Root;
+PhaseTimers::Node *PhaseTimers::Current = &PhaseTimers::Root;
+
+PhaseTimers::Node *PhaseTimers::Node::getOrCreateChild(StringRef ChildName) {
+  for (const std::unique_ptr<Node> &Child : Children)
+    if (Child->Name == ChildName)
+      return Child.get();
+  Children.push_back(llvm::make_unique<Node>());
+  Children.back()->Name = ChildName.str();
+  return Children.back().get();
+}
+
+void PhaseTimers::addSample(StringRef Name, const llvm::TimeRecord &Time) {
+  if (!Enabled)
+    return;
+  Node *N = Current->getOrCreateChild(Name);
+  N->Time += Time;
+  ++N->Invocations;
+}
+
+void PhaseTimers::addSample(StringRef Group, StringRef Name,
+                            const llvm::TimeRecord &Time) {
+  if (!Enabled)
+    return;
+  Node *G = Current->getOrCreateChild(Group);
+  Node *N = G->getOrCreateChild(Name);
+  N->Time += Time;
+  ++N->Invocations;
+  // The group shows the sum of its members.
+  G->Time += Time;
+  ++G->Invocations;
+}
+
+void PhaseTimers::reset() {
+  assert(Current == &Root && "resetting the tree inside an open scope");
+  Root.Children.clear();
+  Root.Time = llvm::TimeRecord();
+  Root.Invocations = 0;
+  Current = &Root;
+}
+
+void PhaseTimerScope::open(StringRef Name) {
+  PhaseTimers::Node *Cur = PhaseTimers::Current;
+  // Recursive re-entry; the already open scope accounts for this time.
+  if (Cur->Name == Name)
+    return;
+  Parent = Cur;
+  PhaseTimers::Current = Cur->getOrCreateChild(Name);
+  ++PhaseTimers::Current->Invocations;
+  Start = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
+}
+
+void PhaseTimerScope::close() {
+  llvm::TimeRecord Elapsed = llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+  Elapsed -= Start;
+  PhaseTimers::Current->Time += Elapsed;
+  PhaseTimers::Current = Parent;
+}
+
+static std::vector<const PhaseTimers::Node *>
+sortedChildren(const PhaseTimers::Node &N) {
+  std::vector<const PhaseTimers::Node *> Children;
+  for (const std::unique_ptr<PhaseTimers::Node> &Child : N.Children)
+    Children.push_back(Child.get());
+  std::stable_sort(Children.begin(), Children.end(),
+                   [](const PhaseTimers::Node *L, const PhaseTimers::Node *R) {
+                     return L->Time.getWallTime() > R->Time.getWallTime();
+                   });
+  return Children;
+}
+
+static void printNode(llvm::raw_ostream &OS, const PhaseTimers::Node &N,
+                      unsigned Depth) {
+  OS << llvm::format("%10.4f %10.4f %9llu  ", N.Time.getWallTime(),
+                     N.Time.getProcessTime(),
+                     (unsigned long long)N.Invocations);
+  OS.indent(Depth * 2) << N.Name << '\n';
+  for (const PhaseTimers::Node *Child : sortedChildren(N))
+    printNode(OS, *Child, Depth + 1);
+}
+
+void PhaseTimers::print(llvm::raw_ostream &OS) {
+  if (Root.Children.empty())
+    return;
+  OS << "\n===-----------------------------------------------------------"
+        "---------===\n"
+        "                           Analyzer phase timers\n"
+        "===-----------------------------------------------------------"
+        "---------===\n"
+        "   wall(s)     cpu(s)     calls  phase\n";
+  for (const Node *Child : sortedChildren(Root))
+    printNode(OS, *Child, 0);
+  OS << '\n';
+}
+
+static llvm::json::Object nodeToJSON(const PhaseTimers::Node &N) {
+  llvm::json::Object Obj{{"name", N.Name},
+                         {"wall-seconds", N.Time.getWallTime()},
+                         {"cpu-seconds", N.Time.getProcessTime()},
+                         {"calls", int64_t(N.Invocations)}};
+  if (!N.Children.empty()) {
+    llvm::json::Array Children;
+    for (const PhaseTimers::Node *Child : sortedChildren(N))
+      Children.push_back(nodeToJSON(*Child));
+    Obj["children"] = std::move(Children);
+  }
+  return Obj;
+}
+
+void PhaseTimers::printJSON(llvm::raw_ostream &OS) {
+  llvm::json::Array Phases;
+  for (const Node *Child : sortedChildren(Root))
+    Phases.push_back(nodeToJSON(*Child));
+  OS << llvm::json::Value(llvm::json::Object{{"phases", std::move(Phases)}})
+     << '\n';
+}
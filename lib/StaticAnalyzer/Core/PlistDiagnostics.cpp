@@ -26,6 +26,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Casting.h"
 
 using namespace clang;
@@ -44,6 +45,10 @@ namespace {
     const cross_tu::CrossTranslationUnitContext &CTU;
     AnalyzerOptions &AnOpts;
     const bool SupportsCrossFileDiagnostics;
+
+    /// Shares the issue hash line normalization between the reports of the
+    /// translation unit.
+    IssueHashLineCache IssueHashCache;
   public:
     PlistDiagnostics(AnalyzerOptions &AnalyzerOpts, const std::string &prefix,
                      const Preprocessor &PP,
@@ -55,6 +60,8 @@ namespace {
     void FlushDiagnosticsImpl(std::vector<const PathDiagnostic *> &Diags,
                               FilesMade *filesMade) override;
 
+    void StreamDiagnosticImpl(const PathDiagnostic &D) override;
+
     StringRef getName() const override {
       return "PlistDiagnostics";
     }
@@ -66,6 +73,27 @@ namespace {
     bool supportsCrossFileDiagnostics() const override {
       return SupportsCrossFileDiagnostics;
     }
+    bool supportsStreaming() const override {
+      // plist-html also goes through this consumer and references the files
+      // made by the HTML consumer, which are unknown until the final flush,
+      // so only the single-file plist output streams.
+      return AnOpts.ShouldStreamPlistDiagnostics && !SupportsCrossFileDiagnostics;
+    }
+
+  private:
+    void printHeader(llvm::raw_ostream &o);
+    void printDiagnostic(llvm::raw_fd_ostream &o, FIDMap &FM,
+                         SmallVectorImpl<FileID> &Fids,
+                         const PathDiagnostic *D, FilesMade *filesMade);
+    void printFooter(llvm::raw_ostream &o, ArrayRef<FileID> Fids);
+
+    /// The output stream of a streamed plist; opened lazily by
+    /// StreamDiagnosticImpl() and closed by the final flush, which appends
+    /// the footer. The file table grows as diagnostics are streamed.
+    std::unique_ptr<llvm::raw_fd_ostream> StreamedOS;
+    FIDMap StreamedFM;
+    SmallVector<FileID, 10> StreamedFids;
+    bool StreamingFailed = false;
   };
 } // end anonymous namespace
 
@@ -549,16 +577,11 @@ void ento::createPlistMultiFileDiagnosticConsumer(
   C.push_back(new PlistDiagnostics(AnalyzerOpts, s, PP, CTU,
                                    /*supportsMultipleFiles*/ true));
 }
-void PlistDiagnostics::FlushDiagnosticsImpl(
-                                    std::vector<const PathDiagnostic *> &Diags,
-                                    FilesMade *filesMade) {
-  // Build up a set of FIDs that we use by scanning the locations and
-  // ranges of the diagnostics.
-  FIDMap FM;
-  SmallVector<FileID, 10> Fids;
-  const SourceManager& SM = PP.getSourceManager();
-  const LangOptions &LangOpts = PP.getLangOpts();
-
+/// Collect the FIDs used by the locations and ranges of a diagnostic into
+/// the file table.
+static void collectDiagnosticFIDs(const PathDiagnostic *D,
+                                  const SourceManager &SM, FIDMap &FM,
+                                  SmallVectorImpl<FileID> &Fids) {
   auto AddPieceFID = [&FM, &Fids, &SM](const PathDiagnosticPiece &Piece) {
     AddFID(FM, Fids, SM, Piece.getLocation().asLocation());
     ArrayRef<SourceRange> Ranges = Piece.getRanges();
@@ -568,61 +591,57 @@ void PlistDiagnostics::FlushDiagnosticsImpl(
     }
   };
 
-  for (const PathDiagnostic *D : Diags) {
-
-    SmallVector<const PathPieces *, 5> WorkList;
-    WorkList.push_back(&D->path);
+  SmallVector<const PathPieces *, 5> WorkList;
+  WorkList.push_back(&D->path);
 
-    while (!WorkList.empty()) {
-      const PathPieces &Path = *WorkList.pop_back_val();
+  while (!WorkList.empty()) {
+    const PathPieces &Path = *WorkList.pop_back_val();
 
-      for (const auto &Iter : Path) {
-        const PathDiagnosticPiece &Piece = *Iter;
-        AddPieceFID(Piece);
+    for (const auto &Iter : Path) {
+      const PathDiagnosticPiece &Piece = *Iter;
+      AddPieceFID(Piece);
 
-        if (const PathDiagnosticCallPiece *Call =
-                dyn_cast<PathDiagnosticCallPiece>(&Piece)) {
-          if (auto CallEnterWithin = Call->getCallEnterWithinCallerEvent())
-            AddPieceFID(*CallEnterWithin);
+      if (const PathDiagnosticCallPiece *Call =
+              dyn_cast<PathDiagnosticCallPiece>(&Piece)) {
+        if (auto CallEnterWithin = Call->getCallEnterWithinCallerEvent())
+          AddPieceFID(*CallEnterWithin);
 
-          if (auto CallEnterEvent = Call->getCallEnterEvent())
-            AddPieceFID(*CallEnterEvent);
+        if (auto CallEnterEvent = Call->getCallEnterEvent())
+          AddPieceFID(*CallEnterEvent);
 
-          WorkList.push_back(&Call->path);
-        } else if (const PathDiagnosticMacroPiece *Macro =
-                       dyn_cast<PathDiagnosticMacroPiece>(&Piece)) {
-          WorkList.push_back(&Macro->subPieces);
-        }
+        WorkList.push_back(&Call->path);
+      } else if (const PathDiagnosticMacroPiece *Macro =
+                     dyn_cast<PathDiagnosticMacroPiece>(&Piece)) {
+        WorkList.push_back(&Macro->subPieces);
       }
     }
   }
+}
 
-  // Open the file.
-  std::error_code EC;
-  llvm::raw_fd_ostream o(OutputFile, EC, llvm::sys::fs::F_Text);
-  if (EC) {
-    llvm::errs() << "warning: could not create file: " << EC.message() << '\n';
-    return;
-  }
-
+void PlistDiagnostics::printHeader(llvm::raw_ostream &o) {
   EmitPlistHeader(o);
 
   // Write the root object: a <dict> containing...
   //  - "clang_version", the string representation of clang version
-  //  - "files", an <array> mapping from FIDs to file names
   //  - "diagnostics", an <array> containing the path diagnostics
+  //  - "files", an <array> mapping from FIDs to file names
   o << "<dict>\n" <<
        " <key>clang_version</key>\n";
   EmitString(o, getClangFullVersion()) << '\n';
   o << " <key>diagnostics</key>\n"
        " <array>\n";
+}
 
-  for (std::vector<const PathDiagnostic*>::iterator DI=Diags.begin(),
-       DE = Diags.end(); DI!=DE; ++DI) {
+void PlistDiagnostics::printDiagnostic(llvm::raw_fd_ostream &o, FIDMap &FM,
+                                       SmallVectorImpl<FileID> &Fids,
+                                       const PathDiagnostic *D,
+                                       FilesMade *filesMade) {
+  const SourceManager &SM = PP.getSourceManager();
+  const LangOptions &LangOpts = PP.getLangOpts();
 
+  {
     o << "  <dict>\n";
 
-    const PathDiagnostic *D = *DI;
     printBugPath(o, FM, AnOpts, PP, CTU, D->path);
 
     // Output the bug type and bug category.
@@ -644,7 +663,7 @@ void PlistDiagnostics::FlushDiagnosticsImpl(
                     SM);
     const Decl *DeclWithIssue = D->getDeclWithIssue();
     EmitString(o, GetIssueHash(SM, L, D->getCheckName(), D->getBugType(),
-                               DeclWithIssue, LangOpts))
+                               DeclWithIssue, LangOpts, &IssueHashCache))
         << '\n';
 
     // Output information about the semantic context where
@@ -712,7 +731,7 @@ void PlistDiagnostics::FlushDiagnosticsImpl(
     EmitLocation(o, SM, D->getLocation().asLocation(), FM, 2);
 
     // Output the diagnostic to the sub-diagnostic client, if any.
-    if (!filesMade->empty()) {
+    if (filesMade && !filesMade->empty()) {
       StringRef lastName;
       PDFileEntry::ConsumerFiles *files = filesMade->getFiles(*D);
       if (files) {
@@ -738,6 +757,11 @@ void PlistDiagnostics::FlushDiagnosticsImpl(
     // Close up the entry.
     o << "  </dict>\n";
   }
+}
+
+void PlistDiagnostics::printFooter(llvm::raw_ostream &o,
+                                   ArrayRef<FileID> Fids) {
+  const SourceManager &SM = PP.getSourceManager();
 
   o << " </array>\n";
 
@@ -760,6 +784,68 @@ void PlistDiagnostics::FlushDiagnosticsImpl(
   o << "</dict>\n</plist>\n";
 }
 
+void PlistDiagnostics::FlushDiagnosticsImpl(
+                                    std::vector<const PathDiagnostic *> &Diags,
+                                    FilesMade *filesMade) {
+  // A streamed plist already contains every diagnostic; only the footer is
+  // missing.
+  if (StreamedOS) {
+    assert(Diags.empty() && "Diagnostics collected despite streaming!");
+    printFooter(*StreamedOS, StreamedFids);
+    StreamedOS.reset();
+    return;
+  }
+  if (StreamingFailed)
+    return;
+
+  // Build up a set of FIDs that we use by scanning the locations and
+  // ranges of the diagnostics.
+  FIDMap FM;
+  SmallVector<FileID, 10> Fids;
+  const SourceManager &SM = PP.getSourceManager();
+
+  for (const PathDiagnostic *D : Diags)
+    collectDiagnosticFIDs(D, SM, FM, Fids);
+
+  // Open the file.
+  std::error_code EC;
+  llvm::raw_fd_ostream o(OutputFile, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    llvm::errs() << "warning: could not create file: " << EC.message() << '\n';
+    return;
+  }
+
+  printHeader(o);
+  for (const PathDiagnostic *D : Diags)
+    printDiagnostic(o, FM, Fids, D, filesMade);
+  printFooter(o, Fids);
+}
+
+void PlistDiagnostics::StreamDiagnosticImpl(const PathDiagnostic &D) {
+  if (StreamingFailed)
+    return;
+
+  if (!StreamedOS) {
+    std::error_code EC;
+    StreamedOS = llvm::make_unique<llvm::raw_fd_ostream>(
+        OutputFile, EC, llvm::sys::fs::F_Text);
+    if (EC) {
+      llvm::errs() << "warning: could not create file: " << EC.message()
+                   << '\n';
+      StreamedOS.reset();
+      StreamingFailed = true;
+      return;
+    }
+    printHeader(*StreamedOS);
+  }
+
+  collectDiagnosticFIDs(&D, PP.getSourceManager(), StreamedFM, StreamedFids);
+  // The files made by the other consumers are not known yet, so a streamed
+  // plist does not reference them.
+  printDiagnostic(*StreamedOS, StreamedFM, StreamedFids, &D,
+                  /*filesMade=*/nullptr);
+}
+
 //===----------------------------------------------------------------------===//
 // Declarations of helper functions and data structures for expanding macros.
 //===----------------------------------------------------------------------===//
@@ -18,6 +18,11 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/DynamicTypeMap.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramStateTrait.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SubEngine.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
@@ -395,6 +400,9 @@ ProgramStateRef ProgramStateManager::getInitialState(const LocationContext *Init
 ProgramStateRef ProgramStateManager::getPersistentStateWithGDM(
                                                      ProgramStateRef FromState,
                                                      ProgramStateRef GDMState) {
+  if (FromState->GDM == GDMState->GDM)
+    return FromState;
+
   ProgramState NewState(*FromState);
   NewState.GDM = GDMState->GDM;
   return getPersistentState(NewState);
@@ -423,6 +431,11 @@ ProgramStateRef ProgramStateManager::getPersistentState(ProgramState &State) {
 }
 
 ProgramStateRef ProgramState::makeWithStore(const StoreRef &store) const {
+  // The store builders return the canonical root for an unchanged store, so
+  // a no-op binding needs no new state and no interning lookup.
+  if (store.getStore() == getStore())
+    return this;
+
   ProgramState NewSt(*this);
   NewSt.setStore(store);
   return getStateManager().getPersistentState(NewSt);
@@ -485,6 +498,382 @@ AnalysisManager& ProgramState::getAnalysisManager() const {
 // Generic Data Map.
 //===----------------------------------------------------------------------===//
 
+/// Hash a trait tag for placement in the GDM trie.  The hash only needs to
+/// be stable within a process; the tags are addresses of static locals.
+static unsigned hashGDMTag(void *Tag) {
+  return llvm::DenseMapInfo<void *>::getHashValue(Tag);
+}
+
+namespace clang {
+namespace ento {
+
+/// A node of the generic data map's hash-array-mapped trie.  Branch nodes
+/// consume the tag's hash five bits per level; leaves hold a single
+/// (tag, data) entry, and collision nodes hold the entries whose tags share
+/// an entire hash.  The factory uniques nodes, and the trie's shape is a
+/// pure function of its contents (branches whose only child is a terminal
+/// node are collapsed), so two maps hold the same entries if and only if
+/// their root pointers are equal.
+class GDMTrieNode : public llvm::FoldingSetNode {
+public:
+  enum NodeKind : unsigned char { Leaf, Branch, Collision };
+
+  /// The number of hash bits consumed per branch level.
+  enum { BitsPerLevel = 5, SlotMask = (1u << BitsPerLevel) - 1 };
+
+private:
+  NodeKind Kind;
+
+protected:
+  GDMTrieNode(NodeKind K) : Kind(K) {}
+
+public:
+  NodeKind getKind() const { return Kind; }
+
+  void Profile(llvm::FoldingSetNodeID &ID) const;
+};
+
+class GDMLeafNode : public GDMTrieNode {
+  void *Tag;
+  void *Data;
+
+public:
+  GDMLeafNode(void *Tag, void *Data)
+      : GDMTrieNode(Leaf), Tag(Tag), Data(Data) {}
+
+  void *getTag() const { return Tag; }
+  void *getData() const { return Data; }
+  void *const *getDataPtr() const { return &Data; }
+
+  static void Profile(llvm::FoldingSetNodeID &ID, void *Tag, void *Data) {
+    ID.AddInteger(unsigned(Leaf));
+    ID.AddPointer(Tag);
+    ID.AddPointer(Data);
+  }
+
+  static bool classof(const GDMTrieNode *N) { return N->getKind() == Leaf; }
+};
+
+class GDMBranchNode : public GDMTrieNode {
+  /// Bit N is set when the node has a child for hash slot N.
+  uint32_t Bitmap;
+
+  /// The present children, densely packed in slot order.
+  const GDMTrieNode *const *Children;
+
+public:
+  GDMBranchNode(uint32_t Bitmap, const GDMTrieNode *const *Children)
+      : GDMTrieNode(Branch), Bitmap(Bitmap), Children(Children) {}
+
+  uint32_t getBitmap() const { return Bitmap; }
+
+  bool hasChild(unsigned Slot) const { return Bitmap & (1u << Slot); }
+
+  /// Return the index into the child array for \p Slot, which need not be
+  /// present in the bitmap (the index is then the insertion position).
+  unsigned getChildIndex(unsigned Slot) const {
+    return llvm::countPopulation(Bitmap & ((1u << Slot) - 1));
+  }
+
+  ArrayRef<const GDMTrieNode *> children() const {
+    return llvm::makeArrayRef(Children, llvm::countPopulation(Bitmap));
+  }
+
+  static void Profile(llvm::FoldingSetNodeID &ID, uint32_t Bitmap,
+                      ArrayRef<const GDMTrieNode *> Children) {
+    ID.AddInteger(unsigned(Branch));
+    ID.AddInteger(Bitmap);
+    for (const GDMTrieNode *C : Children)
+      ID.AddPointer(C);
+  }
+
+  static bool classof(const GDMTrieNode *N) { return N->getKind() == Branch; }
+};
+
+class GDMCollisionNode : public GDMTrieNode {
+  unsigned Hash;
+  unsigned NumEntries;
+
+  /// The colliding entries, sorted by tag pointer value to keep the node's
+  /// contents canonical.
+  const std::pair<void *, void *> *Entries;
+
+public:
+  GDMCollisionNode(unsigned Hash, unsigned NumEntries,
+                   const std::pair<void *, void *> *Entries)
+      : GDMTrieNode(Collision), Hash(Hash), NumEntries(NumEntries),
+        Entries(Entries) {}
+
+  unsigned getHash() const { return Hash; }
+
+  ArrayRef<std::pair<void *, void *>> entries() const {
+    return llvm::makeArrayRef(Entries, NumEntries);
+  }
+
+  static void Profile(llvm::FoldingSetNodeID &ID, unsigned Hash,
+                      ArrayRef<std::pair<void *, void *>> Entries) {
+    ID.AddInteger(unsigned(Collision));
+    ID.AddInteger(Hash);
+    for (const std::pair<void *, void *> &E : Entries) {
+      ID.AddPointer(E.first);
+      ID.AddPointer(E.second);
+    }
+  }
+
+  static bool classof(const GDMTrieNode *N) {
+    return N->getKind() == Collision;
+  }
+};
+
+void GDMTrieNode::Profile(llvm::FoldingSetNodeID &ID) const {
+  switch (Kind) {
+  case Leaf: {
+    const auto *L = cast<GDMLeafNode>(this);
+    GDMLeafNode::Profile(ID, L->getTag(), L->getData());
+    return;
+  }
+  case Branch: {
+    const auto *B = cast<GDMBranchNode>(this);
+    GDMBranchNode::Profile(ID, B->getBitmap(), B->children());
+    return;
+  }
+  case Collision: {
+    const auto *C = cast<GDMCollisionNode>(this);
+    GDMCollisionNode::Profile(ID, C->getHash(), C->entries());
+    return;
+  }
+  }
+  llvm_unreachable("Unknown GDM trie node kind!");
+}
+
+/// Builds and uniques GDM trie nodes.  Owned by the GenericDataMap factory
+/// embedded in ProgramStateManager; the nodes live in the state manager's
+/// allocator.
+class GDMTrieFactory {
+  llvm::BumpPtrAllocator &Alloc;
+  llvm::FoldingSet<GDMTrieNode> Nodes;
+
+  const GDMTrieNode *getLeaf(void *Tag, void *Data) {
+    llvm::FoldingSetNodeID ID;
+    GDMLeafNode::Profile(ID, Tag, Data);
+    void *InsertPos;
+    if (GDMTrieNode *N = Nodes.FindNodeOrInsertPos(ID, InsertPos))
+      return N;
+    auto *N = Alloc.Allocate<GDMLeafNode>();
+    new (N) GDMLeafNode(Tag, Data);
+    Nodes.InsertNode(N, InsertPos);
+    return N;
+  }
+
+  const GDMTrieNode *getBranch(uint32_t Bitmap,
+                               ArrayRef<const GDMTrieNode *> Children) {
+    llvm::FoldingSetNodeID ID;
+    GDMBranchNode::Profile(ID, Bitmap, Children);
+    void *InsertPos;
+    if (GDMTrieNode *N = Nodes.FindNodeOrInsertPos(ID, InsertPos))
+      return N;
+    const GDMTrieNode **Array =
+        Alloc.Allocate<const GDMTrieNode *>(Children.size());
+    std::copy(Children.begin(), Children.end(), Array);
+    auto *N = Alloc.Allocate<GDMBranchNode>();
+    new (N) GDMBranchNode(Bitmap, Array);
+    Nodes.InsertNode(N, InsertPos);
+    return N;
+  }
+
+  const GDMTrieNode *
+  getCollision(unsigned Hash, ArrayRef<std::pair<void *, void *>> Entries) {
+    llvm::FoldingSetNodeID ID;
+    GDMCollisionNode::Profile(ID, Hash, Entries);
+    void *InsertPos;
+    if (GDMTrieNode *N = Nodes.FindNodeOrInsertPos(ID, InsertPos))
+      return N;
+    auto *Array = Alloc.Allocate<std::pair<void *, void *>>(Entries.size());
+    std::copy(Entries.begin(), Entries.end(), Array);
+    auto *N = Alloc.Allocate<GDMCollisionNode>();
+    new (N) GDMCollisionNode(Hash, Entries.size(), Array);
+    Nodes.InsertNode(N, InsertPos);
+    return N;
+  }
+
+  /// Create the branch structure distinguishing the subtrees \p A and \p B,
+  /// whose distinct hashes first diverge at or below \p Shift.
+  const GDMTrieNode *split(unsigned Shift, const GDMTrieNode *A,
+                           unsigned AHash, const GDMTrieNode *B,
+                           unsigned BHash) {
+    assert(AHash != BHash && "Equal hashes belong in a collision node!");
+    unsigned ASlot = (AHash >> Shift) & GDMTrieNode::SlotMask;
+    unsigned BSlot = (BHash >> Shift) & GDMTrieNode::SlotMask;
+    if (ASlot == BSlot) {
+      const GDMTrieNode *Child =
+          split(Shift + GDMTrieNode::BitsPerLevel, A, AHash, B, BHash);
+      return getBranch(1u << ASlot, Child);
+    }
+    if (BSlot < ASlot) {
+      std::swap(A, B);
+      std::swap(ASlot, BSlot);
+    }
+    const GDMTrieNode *Children[2] = {A, B};
+    return getBranch((1u << ASlot) | (1u << BSlot), Children);
+  }
+
+public:
+  GDMTrieFactory(llvm::BumpPtrAllocator &Alloc) : Alloc(Alloc) {}
+
+  const GDMTrieNode *insert(const GDMTrieNode *N, unsigned Shift,
+                            unsigned Hash, void *Tag, void *Data) {
+    if (!N)
+      return getLeaf(Tag, Data);
+
+    if (const auto *L = dyn_cast<GDMLeafNode>(N)) {
+      if (L->getTag() == Tag)
+        return L->getData() == Data ? N : getLeaf(Tag, Data);
+      unsigned LHash = hashGDMTag(L->getTag());
+      if (LHash == Hash) {
+        std::pair<void *, void *> Entries[2] = {{L->getTag(), L->getData()},
+                                                {Tag, Data}};
+        if (uintptr_t(Tag) < uintptr_t(L->getTag()))
+          std::swap(Entries[0], Entries[1]);
+        return getCollision(Hash, Entries);
+      }
+      return split(Shift, N, LHash, getLeaf(Tag, Data), Hash);
+    }
+
+    if (const auto *C = dyn_cast<GDMCollisionNode>(N)) {
+      if (C->getHash() != Hash)
+        return split(Shift, N, C->getHash(), getLeaf(Tag, Data), Hash);
+      SmallVector<std::pair<void *, void *>, 4> Entries(C->entries().begin(),
+                                                        C->entries().end());
+      auto I = llvm::lower_bound(
+          Entries, Tag, [](const std::pair<void *, void *> &E, void *Tag) {
+            return uintptr_t(E.first) < uintptr_t(Tag);
+          });
+      if (I != Entries.end() && I->first == Tag) {
+        if (I->second == Data)
+          return N;
+        I->second = Data;
+      } else {
+        Entries.insert(I, {Tag, Data});
+      }
+      return getCollision(Hash, Entries);
+    }
+
+    const auto *B = cast<GDMBranchNode>(N);
+    unsigned Slot = (Hash >> Shift) & GDMTrieNode::SlotMask;
+    unsigned Index = B->getChildIndex(Slot);
+    SmallVector<const GDMTrieNode *, 8> Children(B->children().begin(),
+                                                 B->children().end());
+    if (B->hasChild(Slot)) {
+      const GDMTrieNode *NewChild = insert(
+          Children[Index], Shift + GDMTrieNode::BitsPerLevel, Hash, Tag, Data);
+      if (NewChild == Children[Index])
+        return N;
+      Children[Index] = NewChild;
+      return getBranch(B->getBitmap(), Children);
+    }
+    Children.insert(Children.begin() + Index, getLeaf(Tag, Data));
+    return getBranch(B->getBitmap() | (1u << Slot), Children);
+  }
+
+  const GDMTrieNode *remove(const GDMTrieNode *N, unsigned Shift,
+                            unsigned Hash, void *Tag) {
+    if (!N)
+      return nullptr;
+
+    if (const auto *L = dyn_cast<GDMLeafNode>(N))
+      return L->getTag() == Tag ? nullptr : N;
+
+    if (const auto *C = dyn_cast<GDMCollisionNode>(N)) {
+      if (C->getHash() != Hash)
+        return N;
+      SmallVector<std::pair<void *, void *>, 4> Entries(C->entries().begin(),
+                                                        C->entries().end());
+      auto I = llvm::find_if(Entries, [Tag](std::pair<void *, void *> E) {
+        return E.first == Tag;
+      });
+      if (I == Entries.end())
+        return N;
+      Entries.erase(I);
+      if (Entries.size() == 1)
+        return getLeaf(Entries.front().first, Entries.front().second);
+      return getCollision(Hash, Entries);
+    }
+
+    const auto *B = cast<GDMBranchNode>(N);
+    unsigned Slot = (Hash >> Shift) & GDMTrieNode::SlotMask;
+    if (!B->hasChild(Slot))
+      return N;
+    unsigned Index = B->getChildIndex(Slot);
+    const GDMTrieNode *OldChild = B->children()[Index];
+    const GDMTrieNode *NewChild =
+        remove(OldChild, Shift + GDMTrieNode::BitsPerLevel, Hash, Tag);
+    if (NewChild == OldChild)
+      return N;
+
+    SmallVector<const GDMTrieNode *, 8> Children(B->children().begin(),
+                                                 B->children().end());
+    uint32_t Bitmap = B->getBitmap();
+    if (!NewChild) {
+      Children.erase(Children.begin() + Index);
+      Bitmap &= ~(1u << Slot);
+      if (Children.empty())
+        return nullptr;
+    } else {
+      Children[Index] = NewChild;
+    }
+
+    // Keep the trie canonical: a branch whose only child is a leaf or a
+    // collision node carries no information and must collapse into it.
+    if (Children.size() == 1 && !isa<GDMBranchNode>(Children.front()))
+      return Children.front();
+    return getBranch(Bitmap, Children);
+  }
+};
+
+} // namespace ento
+} // namespace clang
+
+void *const *ProgramState::GenericDataMap::lookup(void *Tag) const {
+  const GDMTrieNode *N = Root;
+  const unsigned Hash = hashGDMTag(Tag);
+  unsigned Shift = 0;
+  while (N) {
+    if (const auto *L = dyn_cast<GDMLeafNode>(N))
+      return L->getTag() == Tag ? L->getDataPtr() : nullptr;
+
+    if (const auto *C = dyn_cast<GDMCollisionNode>(N)) {
+      for (const std::pair<void *, void *> &E : C->entries())
+        if (E.first == Tag)
+          return &E.second;
+      return nullptr;
+    }
+
+    const auto *B = cast<GDMBranchNode>(N);
+    unsigned Slot = (Hash >> Shift) & GDMTrieNode::SlotMask;
+    if (!B->hasChild(Slot))
+      return nullptr;
+    N = B->children()[B->getChildIndex(Slot)];
+    Shift += GDMTrieNode::BitsPerLevel;
+  }
+  return nullptr;
+}
+
+ProgramState::GenericDataMap::Factory::Factory(llvm::BumpPtrAllocator &Alloc)
+    : Impl(llvm::make_unique<GDMTrieFactory>(Alloc)) {}
+
+ProgramState::GenericDataMap::Factory::~Factory() = default;
+
+ProgramState::GenericDataMap
+ProgramState::GenericDataMap::Factory::add(GenericDataMap M, void *Tag,
+                                           void *Data) {
+  return GenericDataMap(Impl->insert(M.Root, 0, hashGDMTag(Tag), Tag, Data));
+}
+
+ProgramState::GenericDataMap
+ProgramState::GenericDataMap::Factory::remove(GenericDataMap M, void *Tag) {
+  return GenericDataMap(Impl->remove(M.Root, 0, hashGDMTag(Tag), Tag));
+}
+
 void *const* ProgramState::FindGDM(void *K) const {
   return GDM.lookup(K);
 }
@@ -515,6 +904,19 @@ ProgramStateRef ProgramStateManager::addGDM(ProgramStateRef St, void *Key, void
   return getPersistentState(NewSt);
 }
 
+void ProgramStateTransaction::addGDM(void *Key, void *Data) {
+  GDM = Base->getStateManager().GDMFactory.add(GDM, Key, Data);
+}
+
+ProgramStateRef ProgramStateTransaction::commit() {
+  if (GDM == Base->getGDM())
+    return Base;
+
+  ProgramState NewSt = *Base;
+  NewSt.GDM = GDM;
+  return Base->getStateManager().getPersistentState(NewSt);
+}
+
 ProgramStateRef ProgramStateManager::removeGDM(ProgramStateRef state, void *Key) {
   ProgramState::GenericDataMap OldM = state->getGDM();
   ProgramState::GenericDataMap NewM = GDMFactory.remove(OldM, Key);
@@ -65,6 +65,16 @@ const llvm::APSInt &RangeSet::getMinValue() const {
   return ranges.begin()->From();
 }
 
+const llvm::APSInt &RangeSet::getMaxValue() const {
+  assert(!isEmpty());
+  // The ranges of the set are disjoint and ordered by their lower bounds, so
+  // the maximal value is the upper bound of the last range.
+  PrimRangeSet::iterator i = begin(), last = i;
+  for (PrimRangeSet::iterator e = end(); i != e; ++i)
+    last = i;
+  return last->To();
+}
+
 bool RangeSet::pin(llvm::APSInt &Lower, llvm::APSInt &Upper) const {
   // This function has nine cases, the cartesian product of range-testing
   // both the upper and lower bounds against the symbol's type.
@@ -146,6 +156,26 @@ bool RangeSet::pin(llvm::APSInt &Lower, llvm::APSInt &Upper) const {
   return true;
 }
 
+bool RangeSet::contains(llvm::APSInt Point) const {
+  if (ranges.isEmpty())
+    return false;
+
+  // Convert the point to the type of the set's values; the callers only ask
+  // about points that are representable in that type.
+  APSIntType Type(getMinValue());
+  assert(Type.testInRange(Point, true) == APSIntType::RTR_Within);
+  Type.apply(Point);
+
+  // The ranges are disjoint and sorted in ascending order.
+  for (const Range &R : ranges) {
+    if (Point < R.From())
+      return false;
+    if (R.Includes(Point))
+      return true;
+  }
+  return false;
+}
+
 // Returns a set containing the values in the receiving set, intersected with
 // the closed range [Lower, Upper]. Unlike the Range type, this range uses
 // modular arithmetic, corresponding to the common treatment of C integer
@@ -158,6 +188,14 @@ RangeSet RangeSet::Intersect(BasicValueFactory &BV, Factory &F,
   if (!pin(Lower, Upper))
     return F.getEmptySet();
 
+  // Fast path for the common non-wrapping case: if the pinned range subsumes
+  // every range of this set, the intersection cannot change the set, so reuse
+  // the existing tree instead of rebuilding an identical one. This is what
+  // happens whenever a branch condition is consistent with what is already
+  // known about the symbol.
+  if (Lower <= Upper && Lower <= getMinValue() && getMaxValue() <= Upper)
+    return *this;
+
   PrimRangeSet newRanges = F.getEmptySet();
 
   PrimRangeSet::iterator i = begin(), e = end();
@@ -178,6 +216,19 @@ RangeSet RangeSet::Intersect(BasicValueFactory &BV, Factory &F,
 // the range set passed as parameter.
 RangeSet RangeSet::Intersect(BasicValueFactory &BV, Factory &F,
                              const RangeSet &Other) const {
+  // Intersecting a set with itself is a no-op; the trees are shared, so this
+  // is a pointer comparison.
+  if (ranges == Other.ranges)
+    return *this;
+
+  // The overwhelmingly common case is a single range on the right-hand side;
+  // dispatch to the single-range intersection, which can often reuse this
+  // set unchanged, instead of copying its result range by range.
+  if (Other.ranges.isSingleton()) {
+    const Range &R = *Other.begin();
+    return Intersect(BV, F, R.From(), R.To());
+  }
+
   PrimRangeSet newRanges = F.getEmptySet();
 
   for (iterator i = Other.begin(), e = Other.end(); i != e; ++i) {
@@ -240,8 +291,9 @@ void RangeSet::print(raw_ostream &os) const {
 namespace {
 class RangeConstraintManager : public RangedConstraintManager {
 public:
-  RangeConstraintManager(SubEngine *SE, SValBuilder &SVB)
-      : RangedConstraintManager(SE, SVB) {}
+  RangeConstraintManager(SubEngine *SE, SValBuilder &SVB,
+                         llvm::BumpPtrAllocator &Alloc)
+      : RangedConstraintManager(SE, SVB), F(Alloc) {}
 
   //===------------------------------------------------------------------===//
   // Implementation for interface from ConstraintManager.
@@ -302,6 +354,10 @@ public:
       const llvm::APSInt &To, const llvm::APSInt &Adjustment) override;
 
 private:
+  /// The range sets are backed by the same per-entry-point arena as the rest
+  /// of the ProgramState data (environment, store bindings, GDM), so their
+  /// nodes are freed wholesale when the engine finishes the entry point
+  /// instead of being released one by one.
   RangeSet::Factory F;
 
   RangeSet getRange(ProgramStateRef State, SymbolRef Sym);
@@ -330,7 +386,8 @@ private:
 
 std::unique_ptr<ConstraintManager>
 ento::CreateRangeConstraintManager(ProgramStateManager &StMgr, SubEngine *Eng) {
-  return llvm::make_unique<RangeConstraintManager>(Eng, StMgr.getSValBuilder());
+  return llvm::make_unique<RangeConstraintManager>(Eng, StMgr.getSValBuilder(),
+                                                   StMgr.getAllocator());
 }
 
 bool RangeConstraintManager::canReasonAbout(SVal X) const {
@@ -396,7 +453,7 @@ ConditionTruthVal RangeConstraintManager::checkNull(ProgramStateRef State,
   llvm::APSInt Zero = IntType.getZeroValue();
 
   // Check if zero is in the set of possible values.
-  if (Ranges->Intersect(BV, F, Zero, Zero).isEmpty())
+  if (!Ranges->contains(Zero))
     return false;
 
   // Zero is a possible value, but it is not the /only/ possible value.
@@ -559,14 +616,28 @@ RangeConstraintManager::assumeSymNE(ProgramStateRef St, SymbolRef Sym,
   if (AdjustmentType.testInRange(Int, true) != APSIntType::RTR_Within)
     return St;
 
-  llvm::APSInt Lower = AdjustmentType.convert(Int) - Adjustment;
-  llvm::APSInt Upper = Lower;
+  llvm::APSInt Point = AdjustmentType.convert(Int) - Adjustment;
+
+  // Disequality is the overwhelmingly common constraint, and most of the time
+  // it is already decided: either the symbol is pinned to a single value, or
+  // the excluded point is not in the symbol's set at all. Answer those cases
+  // with a read-only query before going through the range machinery.
+  RangeSet Existing = getRange(St, Sym);
+  if (Existing.isEmpty())
+    return nullptr;
+  if (const llvm::APSInt *C = Existing.getConcreteValue())
+    return *C == Point ? nullptr : St;
+  if (!Existing.contains(Point))
+    return St;
+
+  llvm::APSInt Lower = Point;
+  llvm::APSInt Upper = Point;
   --Lower;
   ++Upper;
 
   // [Int-Adjustment+1, Int-Adjustment-1]
   // Notice that the lower bound is greater than the upper bound.
-  RangeSet New = getRange(St, Sym).Intersect(getBasicVals(), F, Upper, Lower);
+  RangeSet New = Existing.Intersect(getBasicVals(), F, Upper, Lower);
   return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
 }
 
@@ -581,7 +652,17 @@ RangeConstraintManager::assumeSymEQ(ProgramStateRef St, SymbolRef Sym,
 
   // [Int-Adjustment, Int-Adjustment]
   llvm::APSInt AdjInt = AdjustmentType.convert(Int) - Adjustment;
-  RangeSet New = getRange(St, Sym).Intersect(getBasicVals(), F, AdjInt, AdjInt);
+
+  // As in assumeSymNE, decide the already-decided cases without touching the
+  // range machinery: a pinned symbol answers equality by comparison, and a
+  // point outside the symbol's set is an infeasible assumption.
+  RangeSet Existing = getRange(St, Sym);
+  if (const llvm::APSInt *C = Existing.getConcreteValue())
+    return *C == AdjInt ? St : nullptr;
+  if (!Existing.contains(AdjInt))
+    return nullptr;
+
+  RangeSet New = Existing.Intersect(getBasicVals(), F, AdjInt, AdjInt);
   return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
 }
 
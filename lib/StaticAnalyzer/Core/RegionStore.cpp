@@ -24,6 +24,7 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/MemRegion.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/PhaseTimers.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramStateTrait.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/SubEngine.h"
@@ -338,6 +339,23 @@ private:
                          SValListTy> LazyBindingsMapTy;
   LazyBindingsMapTy LazyBindingsMap;
 
+  /// Memoized results of getBinding(), keyed by the store, the queried
+  /// region and the requested type. Stores are immutable and regions,
+  /// symbols and lazy compound values are all hash-consed, so for a given
+  /// key the result is always the same; the cache only short-cuts the AVL
+  /// walk and the binding derivation. It is cleared wholesale whenever it
+  /// grows past BindingCacheSize entries.
+  typedef std::pair<Store, std::pair<const MemRegion *, const void *>>
+      BindingCacheKeyTy;
+  typedef llvm::DenseMap<BindingCacheKeyTy, SVal> BindingCacheTy;
+  BindingCacheTy BindingCache;
+
+  /// The maximal number of memoized getBinding() results.
+  ///
+  /// This is controlled by the 'region-store-binding-cache-size' option.
+  /// To disable the memoization, set the option to "0".
+  unsigned BindingCacheSize;
+
   /// The largest number of fields a struct can have and still be
   /// considered "small".
   ///
@@ -358,10 +376,11 @@ public:
   RegionStoreManager(ProgramStateManager& mgr, const RegionStoreFeatures &f)
     : StoreManager(mgr), Features(f),
       RBFactory(mgr.getAllocator()), CBFactory(mgr.getAllocator()),
-      SmallStructLimit(0) {
+      SmallStructLimit(0), BindingCacheSize(0) {
     SubEngine &Eng = StateMgr.getOwningEngine();
     AnalyzerOptions &Options = Eng.getAnalysisManager().options;
     SmallStructLimit = Options.RegionStoreSmallStructLimit;
+    BindingCacheSize = Options.RegionStoreBindingCacheSize;
   }
 
 
@@ -412,6 +431,7 @@ public:
 public: // Part of public interface to class.
 
   StoreRef Bind(Store store, Loc LV, SVal V) override {
+    PhaseTimerScope BindScope("regionstore-bind");
     return StoreRef(bind(getRegionBindings(store), LV, V).asStore(), *this);
   }
 
@@ -518,6 +538,7 @@ public: // Part of public interface to class.
   ///     else
   ///       return symbolic
   SVal getBinding(Store S, Loc L, QualType T) override {
+    PhaseTimerScope ReadScope("regionstore-read");
     return getBinding(getRegionBindings(S), L, T);
   }
 
@@ -531,6 +552,8 @@ public: // Part of public interface to class.
 
   SVal getBinding(RegionBindingsConstRef B, Loc L, QualType T = QualType());
 
+  SVal getBindingUncached(RegionBindingsConstRef B, Loc L, QualType T);
+
   SVal getBindingForElement(RegionBindingsConstRef B, const ElementRegion *R);
 
   SVal getBindingForField(RegionBindingsConstRef B, const FieldRegion *R);
@@ -967,6 +990,12 @@ class InvalidateRegionsWorker : public ClusterAnalysis<InvalidateRegionsWorker>
   RegionAndSymbolInvalidationTraits &ITraits;
   StoreManager::InvalidatedRegions *Regions;
   GlobalsFilterKind GlobalsFilter;
+
+  /// Whether any memory space carries the TK_EntireMemSpace trait; when it
+  /// does not (the common case), includeEntireMemorySpace can skip the
+  /// per-cluster trait lookup.
+  bool HasEntireMemSpaceTrait;
+
 public:
   InvalidateRegionsWorker(RegionStoreManager &rm,
                           ProgramStateManager &stateMgr,
@@ -979,7 +1008,9 @@ public:
                           GlobalsFilterKind GFK)
      : ClusterAnalysis<InvalidateRegionsWorker>(rm, stateMgr, b),
        Ex(ex), Count(count), LCtx(lctx), IS(is), ITraits(ITraitsIn), Regions(r),
-       GlobalsFilter(GFK) {}
+       GlobalsFilter(GFK),
+       HasEntireMemSpaceTrait(ITraitsIn.hasTraitForAnyRegion(
+           RegionAndSymbolInvalidationTraits::TK_EntireMemSpace)) {}
 
   void VisitCluster(const MemRegion *baseR, const ClusterBindings *C);
   void VisitBinding(SVal V);
@@ -1238,6 +1269,9 @@ bool InvalidateRegionsWorker::includeEntireMemorySpace(const MemRegion *Base) {
   if (isInitiallyIncludedGlobalRegion(Base))
     return true;
 
+  if (!HasEntireMemSpaceTrait)
+    return false;
+
   const MemSpaceRegion *MemSpace = Base->getMemorySpace();
   return ITraits.hasTrait(MemSpace,
                           RegionAndSymbolInvalidationTraits::TK_EntireMemSpace);
@@ -1308,6 +1342,7 @@ RegionStoreManager::invalidateRegions(Store store,
                                      RegionAndSymbolInvalidationTraits &ITraits,
                                      InvalidatedRegions *TopLevelRegions,
                                      InvalidatedRegions *Invalidated) {
+  PhaseTimerScope InvalidateScope("regionstore-invalidate");
   GlobalsFilterKind GlobalsFilter;
   if (Call) {
     if (Call->isInSystemHeader())
@@ -1322,8 +1357,15 @@ RegionStoreManager::invalidateRegions(Store store,
   InvalidateRegionsWorker W(*this, StateMgr, B, Ex, Count, LCtx, IS, ITraits,
                             Invalidated, GlobalsFilter);
 
-  // Scan the bindings and generate the clusters.
-  W.GenerateClusters();
+  // Scan the bindings and generate the clusters. For this worker the scan
+  // only seeds the worklist with the clusters of memory spaces that must be
+  // invalidated as a whole; when there are none, every invalidated cluster
+  // is reachable from the values below and the scan over the entire store
+  // can be skipped.
+  if (GlobalsFilter != GFK_None ||
+      ITraits.hasTraitForAnyRegion(
+          RegionAndSymbolInvalidationTraits::TK_EntireMemSpace))
+    W.GenerateClusters();
 
   // Add the regions to the worklist.
   populateWorkList(W, Values, TopLevelRegions);
@@ -1411,7 +1453,31 @@ SVal RegionStoreManager::ArrayToPointer(Loc Array, QualType T) {
 // Loading values from regions.
 //===----------------------------------------------------------------------===//
 
-SVal RegionStoreManager::getBinding(RegionBindingsConstRef B, Loc L, QualType T) {
+SVal RegionStoreManager::getBinding(RegionBindingsConstRef B, Loc L,
+                                    QualType T) {
+  // Every input the lookup depends on is immutable, so the result for a
+  // (store, region, type) triple can be served from the cache. This pays
+  // off most for lazy compound values, which re-read the same fields of
+  // the same snapshot store over and over.
+  Optional<loc::MemRegionVal> MRV = L.getAs<loc::MemRegionVal>();
+  if (!BindingCacheSize || !MRV)
+    return getBindingUncached(B, L, T);
+
+  BindingCacheKeyTy Key(
+      B.asStore(), std::make_pair(MRV->getRegion(), T.getAsOpaquePtr()));
+  BindingCacheTy::iterator Cached = BindingCache.find(Key);
+  if (Cached != BindingCache.end())
+    return Cached->second;
+
+  SVal V = getBindingUncached(B, L, T);
+  if (BindingCache.size() >= BindingCacheSize)
+    BindingCache.clear();
+  BindingCache.try_emplace(Key, V);
+  return V;
+}
+
+SVal RegionStoreManager::getBindingUncached(RegionBindingsConstRef B, Loc L,
+                                            QualType T) {
   assert(!L.getAs<UnknownVal>() && "location unknown");
   assert(!L.getAs<UndefinedVal>() && "location undefined");
 
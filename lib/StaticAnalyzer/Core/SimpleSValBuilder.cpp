@@ -52,6 +52,14 @@ public:
 
   SVal MakeSymIntVal(const SymExpr *LHS, BinaryOperator::Opcode op,
                      const llvm::APSInt &RHS, QualType resultTy);
+
+private:
+  /// Fold a binary operation on two concrete integers, applying the
+  /// comparison promotion or result-type conversion up front.  This is the
+  /// straight-line core of evalBinOpNN, hoisted out so that the dominant
+  /// constant-constant case can bypass the kind dispatch entirely.
+  SVal evalBinOpConcreteInts(BinaryOperator::Opcode op, llvm::APSInt LHSValue,
+                             llvm::APSInt RHSValue, QualType resultTy);
 };
 } // end anonymous namespace
 
@@ -73,6 +81,28 @@ SVal SimpleSValBuilder::dispatchCast(SVal Val, QualType CastTy) {
 
 SVal SimpleSValBuilder::evalCastFromNonLoc(NonLoc val, QualType castTy) {
   bool isLocType = Loc::isLocType(castTy);
+
+  // Check for concrete integers first: they are by far the most commonly
+  // cast kind of value, and the checks for the other kinds below all fail
+  // for them anyway.
+  if (Optional<nonloc::ConcreteInt> CI = val.getAs<nonloc::ConcreteInt>()) {
+    // Handle casts to a boolean type.
+    if (castTy->isBooleanType())
+      return makeTruthVal(CI->getValue().getBoolValue(), castTy);
+
+    // Only handle casts from integers to integers - if val is an integer
+    // constant being cast to a non-integer type, produce unknown.
+    if (!isLocType && !castTy->isIntegralOrEnumerationType())
+      return UnknownVal();
+
+    llvm::APSInt i = CI->getValue();
+    BasicVals.getAPSIntType(castTy).apply(i);
+
+    if (isLocType)
+      return makeIntLocVal(i);
+    return makeIntVal(i);
+  }
+
   if (val.getAs<nonloc::PointerToMember>())
     return val;
 
@@ -103,28 +133,8 @@ SVal SimpleSValBuilder::evalCastFromNonLoc(NonLoc val, QualType castTy) {
     return UnknownVal();
   }
 
-  // If value is a non-integer constant, produce unknown.
-  if (!val.getAs<nonloc::ConcreteInt>())
-    return UnknownVal();
-
-  // Handle casts to a boolean type.
-  if (castTy->isBooleanType()) {
-    bool b = val.castAs<nonloc::ConcreteInt>().getValue().getBoolValue();
-    return makeTruthVal(b, castTy);
-  }
-
-  // Only handle casts from integers to integers - if val is an integer constant
-  // being cast to a non-integer type, produce unknown.
-  if (!isLocType && !castTy->isIntegralOrEnumerationType())
-    return UnknownVal();
-
-  llvm::APSInt i = val.castAs<nonloc::ConcreteInt>().getValue();
-  BasicVals.getAPSIntType(castTy).apply(i);
-
-  if (isLocType)
-    return makeIntLocVal(i);
-  else
-    return makeIntVal(i);
+  // The value is some other non-integer constant; produce unknown.
+  return UnknownVal();
 }
 
 SVal SimpleSValBuilder::evalCastFromLoc(Loc val, QualType castTy) {
@@ -501,6 +511,31 @@ static Optional<NonLoc> tryRearrange(ProgramStateRef State,
   return doRearrangeUnchecked(State, Op, LSym, LInt, RSym, RInt);
 }
 
+SVal SimpleSValBuilder::evalBinOpConcreteInts(BinaryOperator::Opcode op,
+                                              llvm::APSInt LHSValue,
+                                              llvm::APSInt RHSValue,
+                                              QualType resultTy) {
+  if (BinaryOperator::isComparisonOp(op)) {
+    // We're looking for a type big enough to compare the two values.
+    // FIXME: This is not correct. char + short will result in a promotion
+    // to int. Unfortunately we have lost types by this point.
+    APSIntType CompareType = std::max(APSIntType(LHSValue),
+                                      APSIntType(RHSValue));
+    CompareType.apply(LHSValue);
+    CompareType.apply(RHSValue);
+  } else if (!BinaryOperator::isShiftOp(op)) {
+    APSIntType IntType = BasicVals.getAPSIntType(resultTy);
+    IntType.apply(LHSValue);
+    IntType.apply(RHSValue);
+  }
+
+  const llvm::APSInt *Result = BasicVals.evalAPSInt(op, LHSValue, RHSValue);
+  if (!Result)
+    return UndefinedVal();
+
+  return nonloc::ConcreteInt(*Result);
+}
+
 SVal SimpleSValBuilder::evalBinOpNN(ProgramStateRef state,
                                   BinaryOperator::Opcode op,
                                   NonLoc lhs, NonLoc rhs,
@@ -531,6 +566,15 @@ SVal SimpleSValBuilder::evalBinOpNN(ProgramStateRef state,
         return evalCastFromNonLoc(lhs, resultTy);
     }
 
+  // Two concrete integers are by far the most common combination folded
+  // here; handle them with straight-line code before entering the kind
+  // dispatch below, which costs a chain of data-dependent branches (and a
+  // simplifySVal() visitor for the RHS) per operation.
+  if (Optional<nonloc::ConcreteInt> LInt = lhs.getAs<nonloc::ConcreteInt>())
+    if (Optional<nonloc::ConcreteInt> RInt = rhs.getAs<nonloc::ConcreteInt>())
+      return evalBinOpConcreteInts(op, LInt->getValue(), RInt->getValue(),
+                                   resultTy);
+
   while (1) {
     switch (lhs.getSubKind()) {
     default:
@@ -598,29 +642,8 @@ SVal SimpleSValBuilder::evalBinOpNN(ProgramStateRef state,
       llvm::APSInt LHSValue = lhs.castAs<nonloc::ConcreteInt>().getValue();
 
       // If we're dealing with two known constants, just perform the operation.
-      if (const llvm::APSInt *KnownRHSValue = getKnownValue(state, rhs)) {
-        llvm::APSInt RHSValue = *KnownRHSValue;
-        if (BinaryOperator::isComparisonOp(op)) {
-          // We're looking for a type big enough to compare the two values.
-          // FIXME: This is not correct. char + short will result in a promotion
-          // to int. Unfortunately we have lost types by this point.
-          APSIntType CompareType = std::max(APSIntType(LHSValue),
-                                            APSIntType(RHSValue));
-          CompareType.apply(LHSValue);
-          CompareType.apply(RHSValue);
-        } else if (!BinaryOperator::isShiftOp(op)) {
-          APSIntType IntType = BasicVals.getAPSIntType(resultTy);
-          IntType.apply(LHSValue);
-          IntType.apply(RHSValue);
-        }
-
-        const llvm::APSInt *Result =
-          BasicVals.evalAPSInt(op, LHSValue, RHSValue);
-        if (!Result)
-          return UndefinedVal();
-
-        return nonloc::ConcreteInt(*Result);
-      }
+      if (const llvm::APSInt *KnownRHSValue = getKnownValue(state, rhs))
+        return evalBinOpConcreteInts(op, LHSValue, *KnownRHSValue, resultTy);
 
       // Swap the left and right sides and flip the operator if doing so
       // allows us to better reason about the expression (this is a form
@@ -404,7 +404,9 @@ void SymbolReaper::markLive(SymbolRef sym) {
 }
 
 void SymbolReaper::markLive(const MemRegion *region) {
-  RegionRoots.insert(region->getBaseRegion());
+  const MemRegion *Base = region->getBaseRegion();
+  if (LiveRegionRoots.test_and_set(Base->getID()))
+    RegionRoots.push_back(Base);
   markElementIndicesLive(region);
 }
 
@@ -431,7 +433,7 @@ bool SymbolReaper::isLiveRegion(const MemRegion *MR) {
   // that field earlier than, say, the variable that contains the field dies.
   MR = MR->getBaseRegion();
 
-  if (RegionRoots.count(MR))
+  if (LiveRegionRoots.test(MR->getID()))
     return true;
 
   if (const auto *SR = dyn_cast<SymbolicRegion>(MR))
@@ -507,6 +509,13 @@ bool SymbolReaper::isLive(SymbolRef sym) {
   return KnownLive;
 }
 
+RelaxedLiveVariables *SymbolReaper::getLiveVariables() const {
+  if (!cachedLiveVariables)
+    const_cast<SymbolReaper *>(this)->cachedLiveVariables =
+        LCtx->getAnalysis<RelaxedLiveVariables>();
+  return cachedLiveVariables;
+}
+
 bool
 SymbolReaper::isLive(const Stmt *ExprVal, const LocationContext *ELCtx) const {
   if (LCtx == nullptr)
@@ -515,16 +524,22 @@ SymbolReaper::isLive(const Stmt *ExprVal, const LocationContext *ELCtx) const {
   if (LCtx != ELCtx) {
     // If the reaper's location context is a parent of the expression's
     // location context, then the expression value is now "out of scope".
-    if (LCtx->isParentOf(ELCtx))
-      return false;
-    return true;
+    unsigned &cachedScope =
+        const_cast<SymbolReaper *>(this)->scopeCache[ELCtx];
+
+    if (cachedScope)
+      return cachedScope == 1;
+
+    bool InScope = !LCtx->isParentOf(ELCtx);
+    cachedScope = InScope ? 1 : 2;
+    return InScope;
   }
 
   // If no statement is provided, everything is this and parent contexts is live.
   if (!Loc)
     return true;
 
-  return LCtx->getAnalysis<RelaxedLiveVariables>()->isLive(Loc, ExprVal);
+  return getLiveVariables()->isLive(Loc, ExprVal);
 }
 
 bool SymbolReaper::isLive(const VarRegion *VR, bool includeStoreBindings) const{
@@ -538,11 +553,12 @@ bool SymbolReaper::isLive(const VarRegion *VR, bool includeStoreBindings) const{
   const StackFrameContext *CurrentContext = LCtx->getStackFrame();
 
   if (VarContext == CurrentContext) {
-    // If no statement is provided, everything is live.
-    if (!Loc)
+    // If no statement or block is provided, everything is live.
+    if (!Loc && !Block)
       return true;
 
-    if (LCtx->getAnalysis<RelaxedLiveVariables>()->isLive(Loc, VR->getDecl()))
+    if (Block ? getLiveVariables()->isLive(Block, VR->getDecl())
+              : getLiveVariables()->isLive(Loc, VR->getDecl()))
       return true;
 
     if (!includeStoreBindings)
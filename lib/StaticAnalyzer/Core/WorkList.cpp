@@ -11,12 +11,18 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Core/PathSensitive/WorkList.h"
+#include "clang/Analysis/Analyses/Dominators.h"
+#include "clang/Analysis/CFG.h"
 #include "llvm/ADT/PriorityQueue.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Statistic.h"
 #include <deque>
+#include <limits>
+#include <memory>
+#include <tuple>
 #include <vector>
 
 using namespace clang;
@@ -311,3 +317,126 @@ public:
 std::unique_ptr<WorkList> WorkList::makeUnexploredFirstPriorityLocationQueue() {
   return llvm::make_unique<UnexploredFirstPriorityLocationQueue>();
 }
+
+namespace {
+class CoverageFirstPriorityQueue : public WorkList {
+  /// Per-CFG coverage bookkeeping.
+  ///
+  /// For every block we maintain the number of not-yet-visited blocks in its
+  /// dominator subtree, i.e. the blocks that cannot be reached without
+  /// passing through it. This is a cheap lower-bound estimate of how much
+  /// new coverage expanding past the block can yield, and it can be kept up
+  /// to date in O(depth) per newly visited block.
+  struct CFGCoverageInfo {
+    /// The compact table keeps only one word per block, so holding on to one
+    /// per inlined CFG stays affordable on whole-TU runs; the full dominator
+    /// tree lives only while the table is built.
+    CFGIDomTable IDoms;
+
+    /// Blocks for which a block entrance was already enqueued, by block ID.
+    llvm::BitVector Visited;
+
+    /// Number of unvisited blocks in each block's dominator subtree, by
+    /// block ID.
+    std::vector<unsigned> UnvisitedDominated;
+
+    /// Number of times each block was reached, across all stack frames, by
+    /// block ID.
+    std::vector<int> NumReached;
+  };
+
+  // Compare by the estimated coverage gain first, then prefer less often
+  // visited blocks (negated visit count), then insertion time (prefer
+  // expanding nodes inserted later first, which keeps a DFS-like order
+  // among equals).
+  using QueuePriority = std::tuple<int, int, unsigned long>;
+  using QueueItem = std::pair<WorkListUnit, QueuePriority>;
+
+  struct ExplorationComparator {
+    bool operator() (const QueueItem &LHS, const QueueItem &RHS) {
+      return LHS.second < RHS.second;
+    }
+  };
+
+  // Number of inserted nodes, used to emulate DFS ordering in the priority
+  // queue when insertions are equal.
+  unsigned long Counter = 0;
+
+  // Lazily built, since the worklist outlives any single CFG and sees nodes
+  // from every function inlined into the current entry point.
+  llvm::DenseMap<const CFG *, std::unique_ptr<CFGCoverageInfo>> Coverage;
+
+  // The top item is the largest one.
+  llvm::PriorityQueue<QueueItem, std::vector<QueueItem>, ExplorationComparator>
+      queue;
+
+  CFGCoverageInfo &getCoverageInfo(CFG *C) {
+    std::unique_ptr<CFGCoverageInfo> &Info = Coverage[C];
+    if (!Info) {
+      Info = llvm::make_unique<CFGCoverageInfo>();
+      unsigned NumIDs = C->getNumBlockIDs();
+      Info->IDoms.build(C);
+      Info->Visited.resize(NumIDs);
+      Info->UnvisitedDominated.resize(NumIDs, 0);
+      Info->NumReached.resize(NumIDs, 0);
+      // Seed every block's counter with the size of its dominator subtree.
+      // Unreachable blocks have no dominators and are skipped.
+      for (CFGBlock *B : *C) {
+        unsigned ID = B->getBlockID();
+        if (!Info->IDoms.isReachable(ID))
+          continue;
+        ++Info->UnvisitedDominated[ID];
+        while ((ID = Info->IDoms.getIDom(ID)) != CFGIDomTable::NoIDom)
+          ++Info->UnvisitedDominated[ID];
+      }
+    }
+    return *Info;
+  }
+
+  void markVisited(CFGCoverageInfo &Info, CFGBlock *B) {
+    unsigned ID = B->getBlockID();
+    if (Info.Visited.test(ID))
+      return;
+    Info.Visited.set(ID);
+    if (!Info.IDoms.isReachable(ID))
+      return;
+    do {
+      if (Info.UnvisitedDominated[ID] > 0)
+        --Info.UnvisitedDominated[ID];
+    } while ((ID = Info.IDoms.getIDom(ID)) != CFGIDomTable::NoIDom);
+  }
+
+public:
+  bool hasWork() const override {
+    return !queue.empty();
+  }
+
+  void enqueue(const WorkListUnit &U) override {
+    const ExplodedNode *N = U.getNode();
+    // Nodes in the middle of a block inherit the decision made at the
+    // preceding block entrance, so keep making progress on them first.
+    int Gain = std::numeric_limits<int>::max();
+    int NumVisited = 0;
+    if (auto BE = N->getLocation().getAs<BlockEntrance>()) {
+      CFGBlock *B = const_cast<CFGBlock *>(BE->getBlock());
+      CFGCoverageInfo &Info = getCoverageInfo(B->getParent());
+      NumVisited = Info.NumReached[B->getBlockID()]++;
+      markVisited(Info, B);
+      Gain = Info.UnvisitedDominated[B->getBlockID()];
+    }
+
+    queue.push(
+        std::make_pair(U, std::make_tuple(Gain, -NumVisited, ++Counter)));
+  }
+
+  WorkListUnit dequeue() override {
+    QueueItem U = queue.top();
+    queue.pop();
+    return U.first;
+  }
+};
+} // namespace
+
+std::unique_ptr<WorkList> WorkList::makeCoverageFirstPriorityQueue() {
+  return llvm::make_unique<CoverageFirstPriorityQueue>();
+}
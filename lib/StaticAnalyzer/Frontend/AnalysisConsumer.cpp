@@ -15,6 +15,7 @@
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclObjC.h"
+#include "clang/AST/DeclTemplate.h"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Analysis/Analyses/LiveVariables.h"
 #include "clang/Analysis/CFG.h"
@@ -23,7 +24,9 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/CrossTU/CrossTranslationUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/RawTokenHash.h"
 #include "clang/StaticAnalyzer/Checkers/LocalCheckers.h"
 #include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/BugReporter.h"
@@ -31,15 +34,25 @@
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/EngineStats.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/PhaseTimers.h"
 #include "clang/StaticAnalyzer/Frontend/CheckerRegistration.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/DJB.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <chrono>
 #include <memory>
 #include <queue>
 #include <utility>
@@ -59,6 +72,14 @@ STATISTIC(NumVisitedBlocksInAnalyzedFunctions,
           "The # of visited basic blocks in the analyzed functions.");
 STATISTIC(PercentReachableBlocks, "The % of reachable basic blocks.");
 STATISTIC(MaxCFGSize, "The maximum number of basic blocks in a function.");
+STATISTIC(NumFunctionsSkippedIncremental,
+          "The # of functions skipped as unchanged by incremental analysis.");
+STATISTIC(NumHeaderFunctionsDeduplicated,
+          "The # of header-defined functions skipped as covered by another "
+          "analyzer process.");
+STATISTIC(NumEntryPointsExhaustedBudget,
+          "The # of entry points whose exploration was cut short by the node "
+          "budget.");
 
 //===----------------------------------------------------------------------===//
 // Special PathDiagnosticConsumers.
@@ -147,6 +168,376 @@ public:
 };
 } // end anonymous namespace
 
+//===----------------------------------------------------------------------===//
+// Incremental analysis support.
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// Persists the per-function content hashes between analyzer runs for the
+/// incremental mode (see the 'incremental-analysis-dir' config option).
+///
+/// The cache holds one file per translation unit, named by the hash of the
+/// main file path. Each line stores the combined hash of a top level function
+/// followed by its name. A function whose combined hash equals the one stored
+/// by the previous run is considered unchanged and its path sensitive
+/// analysis can be skipped.
+class IncrementalAnalysisCache {
+public:
+  IncrementalAnalysisCache(StringRef CacheDir, StringRef MainFilePath) {
+    llvm::MD5 Hash;
+    llvm::MD5::MD5Result Result;
+    Hash.update(MainFilePath);
+    Hash.final(Result);
+    SmallString<32> HashStr = llvm::MD5::stringifyResult(Result);
+    SmallString<128> FilePath = CacheDir;
+    llvm::sys::path::append(FilePath,
+                            llvm::Twine("fn-hashes-") + HashStr + ".txt");
+    CacheFilePath = FilePath.str();
+
+    auto Buffer = llvm::MemoryBuffer::getFile(CacheFilePath);
+    if (!Buffer)
+      return;
+    for (llvm::line_iterator LI(**Buffer, /*SkipBlanks=*/true); !LI.is_at_end();
+         ++LI) {
+      const std::pair<StringRef, StringRef> HashAndName = LI->split(' ');
+      uint64_t PreviousHash;
+      if (!HashAndName.first.getAsInteger(16, PreviousHash) &&
+          !HashAndName.second.empty())
+        Previous[HashAndName.second] = PreviousHash;
+    }
+  }
+
+  /// Returns true if \p Name was stored by the previous run with the same
+  /// combined hash, i.e. neither the function nor its transitive callees
+  /// changed since then.
+  bool isUpToDate(StringRef Name, uint64_t CombinedHash) const {
+    auto Entry = Previous.find(Name);
+    return Entry != Previous.end() && Entry->second == CombinedHash;
+  }
+
+  /// Record the combined hash of \p Name for the next run.
+  void record(StringRef Name, uint64_t CombinedHash) {
+    Current[Name] = CombinedHash;
+  }
+
+  /// Write the recorded hashes back to the cache file.
+  void save() const {
+    llvm::sys::fs::create_directories(
+        llvm::sys::path::parent_path(CacheFilePath));
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(CacheFilePath, EC, llvm::sys::fs::OF_Text);
+    if (EC) {
+      llvm::errs() << "warning: cannot write incremental analysis cache '"
+                   << CacheFilePath << "': " << EC.message() << '\n';
+      return;
+    }
+    for (const auto &Entry : Current)
+      OS << llvm::format_hex_no_prefix(Entry.second, 16) << ' '
+         << Entry.first() << '\n';
+  }
+
+private:
+  std::string CacheFilePath;
+  llvm::StringMap<uint64_t> Previous;
+  llvm::StringMap<uint64_t> Current;
+};
+
+/// Marks header-defined functions as covered in a store shared by the
+/// analyzer processes of a whole build (see the 'analysis-dedup-dir' config
+/// option). Inline functions defined in common headers would otherwise be
+/// path-analyzed once per including translation unit; the store lets the
+/// first process that reaches a function claim it, and the others skip it.
+/// The reports of a skipped function are part of the output of the covering
+/// process; merging them is the job of the report management tooling.
+///
+/// A function is keyed by its combined content hash, so textually identical
+/// definitions deduplicate across header copies and a changed function is
+/// analyzed anew. Every claim is one empty marker file named by the hash,
+/// which keeps the store consistent between processes without any locking.
+class HeaderCoverageStore {
+public:
+  HeaderCoverageStore(StringRef Dir) : Dir(Dir) {
+    llvm::sys::fs::create_directories(Dir);
+  }
+
+  /// Returns true if some process already claimed \p CombinedHash.
+  bool isCovered(uint64_t CombinedHash) const {
+    return llvm::sys::fs::exists(getMarkerPath(CombinedHash));
+  }
+
+  /// Claim \p CombinedHash for this process.
+  void markCovered(uint64_t CombinedHash) const {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(getMarkerPath(CombinedHash), EC,
+                            llvm::sys::fs::OF_None);
+    // A failed claim only costs a redundant analysis in another process.
+    (void)EC;
+  }
+
+private:
+  std::string getMarkerPath(uint64_t CombinedHash) const {
+    SmallString<128> Path(Dir);
+    llvm::sys::path::append(Path,
+                            "covered-" + llvm::Twine::utohexstr(CombinedHash));
+    return Path.str();
+  }
+
+  std::string Dir;
+};
+
+/// Collects one structured record per path sensitive entry point and writes
+/// them as a chrome://tracing compatible trace file (see the
+/// 'entry-point-trace' config option). Every entry point becomes one
+/// complete event spanning its exploration, with the counters that usually
+/// explain its cost -- exploded node count, CFG size, time spent in checker
+/// callbacks, whether the node budget cut the exploration short -- attached
+/// as event arguments. Sorting the merged traces of a build by duration
+/// pinpoints the most expensive entry points without re-running under a
+/// profiler.
+class EntryPointTraceWriter {
+public:
+  EntryPointTraceWriter(StringRef Path)
+      : TraceFilePath(Path), Epoch(std::chrono::steady_clock::now()) {}
+
+  /// Microseconds elapsed since the writer was created; the timestamp base
+  /// of the recorded events.
+  uint64_t now() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - Epoch)
+        .count();
+  }
+
+  /// Record the exploration of one entry point. \p CheckerSeconds is the
+  /// wall time spent in checker callbacks, or a negative value when checker
+  /// profiling is disabled; \p EngineCounters is the entry point's share of
+  /// the ENGINE_STATISTIC counters.
+  void recordEntryPoint(StringRef Name, uint64_t StartUS, uint64_t EndUS,
+                        unsigned ExplodedNodes, unsigned CFGSize,
+                        double CheckerSeconds, bool BudgetExhausted,
+                        ArrayRef<EngineStats::Delta> EngineCounters) {
+    llvm::json::Object Args{{"exploded-nodes", int64_t(ExplodedNodes)},
+                            {"cfg-blocks", int64_t(CFGSize)},
+                            {"budget-exhausted", BudgetExhausted}};
+    if (CheckerSeconds >= 0)
+      Args["checkers-us"] = int64_t(CheckerSeconds * 1000000.0);
+    for (const EngineStats::Delta &D : EngineCounters)
+      Args[D.Name] = int64_t(D.Value);
+    Events.push_back(llvm::json::Object{{"ph", "X"},
+                                        {"pid", 1},
+                                        {"tid", 1},
+                                        {"name", Name},
+                                        {"ts", int64_t(StartUS)},
+                                        {"dur", int64_t(EndUS - StartUS)},
+                                        {"args", std::move(Args)}});
+  }
+
+  /// Write the recorded events to the trace file.
+  void save() {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(TraceFilePath, EC, llvm::sys::fs::OF_Text);
+    if (EC) {
+      llvm::errs() << "warning: cannot write entry point trace '"
+                   << TraceFilePath << "': " << EC.message() << '\n';
+      return;
+    }
+    OS << llvm::json::Value(
+              llvm::json::Object{{"traceEvents", std::move(Events)}})
+       << '\n';
+  }
+
+private:
+  std::string TraceFilePath;
+  std::chrono::steady_clock::time_point Epoch;
+  llvm::json::Array Events;
+};
+
+/// Streams live progress events, one JSON object per line, into the file
+/// named by the 'progress-events' config option: a record when the analysis
+/// of each path sensitive entry point begins and one when it ends. Every
+/// record is flushed as soon as it is complete, so - unlike the entry point
+/// trace and the results database, which appear only when the translation
+/// unit is done - the stream is readable while the analyzer is still
+/// running. A consumer watching it can spot an entry point whose begin
+/// record never got its end record and kill or reschedule the stuck
+/// translation unit early.
+class ProgressEventWriter {
+public:
+  ProgressEventWriter(StringRef Path, StringRef MainFile)
+      : Epoch(std::chrono::steady_clock::now()) {
+    std::error_code EC;
+    OS = llvm::make_unique<llvm::raw_fd_ostream>(
+        Path, EC, llvm::sys::fs::OF_Append | llvm::sys::fs::OF_Text);
+    if (EC) {
+      llvm::errs() << "warning: cannot write progress events to '" << Path
+                   << "': " << EC.message() << '\n';
+      OS.reset();
+      return;
+    }
+    write(llvm::json::Object{{"event", "translation-unit"},
+                             {"file", MainFile},
+                             {"ts-us", now()}});
+  }
+
+  void beginEntryPoint(StringRef Name) {
+    if (!OS)
+      return;
+    write(llvm::json::Object{
+        {"event", "begin"}, {"name", Name}, {"ts-us", now()}});
+  }
+
+  void endEntryPoint(StringRef Name, unsigned ExplodedNodes,
+                     bool BudgetExhausted) {
+    if (!OS)
+      return;
+    write(llvm::json::Object{{"event", "end"},
+                             {"name", Name},
+                             {"ts-us", now()},
+                             {"exploded-nodes", int64_t(ExplodedNodes)},
+                             {"budget-exhausted", BudgetExhausted}});
+  }
+
+private:
+  /// Microseconds elapsed since the writer was created; the timestamp base
+  /// of the emitted records.
+  int64_t now() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - Epoch)
+        .count();
+  }
+
+  /// Emit one record as a single write followed by a flush, so a consumer
+  /// never observes a partial line.
+  void write(llvm::json::Object Record) {
+    std::string Line;
+    llvm::raw_string_ostream LineOS(Line);
+    LineOS << llvm::json::Value(std::move(Record)) << '\n';
+    *OS << LineOS.str();
+    OS->flush();
+  }
+
+  std::unique_ptr<llvm::raw_fd_ostream> OS;
+  std::chrono::steady_clock::time_point Epoch;
+};
+
+/// Accumulates one machine readable record about the analysis of a
+/// translation unit and writes it into the results database directory (see
+/// the 'results-db' config option): the total analysis time, the duration,
+/// exploded node count and budget verdict of every path sensitive entry
+/// point, and the callback time and diagnostic count of every checker. Each
+/// translation unit gets its own record file, named after the hash of its
+/// main file path, so parallel analyzer processes never contend for a file
+/// and re-analysis overwrites the stale record in place.
+class ResultsDBWriter {
+public:
+  ResultsDBWriter(StringRef Dir) : Dir(Dir) {
+    llvm::sys::fs::create_directories(Dir);
+  }
+
+  /// Starts the translation unit's analysis stopwatch; no record is written
+  /// for translation units whose analysis never started.
+  void markAnalysisStart() {
+    Started = true;
+    Start = std::chrono::steady_clock::now();
+  }
+
+  bool hasAnalysisStarted() const { return Started; }
+
+  /// Record the exploration of one path sensitive entry point.
+  void recordEntryPoint(StringRef Name, double Seconds,
+                        unsigned ExplodedNodes, bool BudgetExhausted) {
+    EntryPoints.push_back(
+        llvm::json::Object{{"name", Name},
+                           {"seconds", Seconds},
+                           {"exploded-nodes", int64_t(ExplodedNodes)},
+                           {"budget-exhausted", BudgetExhausted}});
+  }
+
+  /// Count one emitted diagnostic against \p CheckName.
+  void countDiagnostic(StringRef CheckName) {
+    ++DiagCounts[CheckName.empty() ? StringRef("<unnamed>") : CheckName];
+  }
+
+  /// Write the translation unit's record, keyed by \p MainFile.
+  void save(StringRef MainFile, const CheckerManager &CheckerMgr) {
+    double TotalSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - Start)
+            .count();
+
+    llvm::json::Object Checkers;
+    if (CheckerMgr.shouldProfileCheckers())
+      CheckerMgr.forEachCheckerTime(
+          [&](StringRef Name, const llvm::TimeRecord &Time) {
+            checkerEntry(Checkers, Name)["seconds"] = Time.getWallTime();
+          });
+    for (const auto &Count : DiagCounts)
+      checkerEntry(Checkers, Count.getKey())["diagnostics"] =
+          int64_t(Count.getValue());
+
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(recordPath(MainFile), EC, llvm::sys::fs::OF_Text);
+    if (EC) {
+      llvm::errs() << "warning: cannot write analysis results record for '"
+                   << MainFile << "': " << EC.message() << '\n';
+      return;
+    }
+    OS << llvm::json::Value(
+              llvm::json::Object{{"file", MainFile},
+                                 {"total-seconds", TotalSeconds},
+                                 {"entry-points", std::move(EntryPoints)},
+                                 {"checkers", std::move(Checkers)}})
+       << '\n';
+  }
+
+private:
+  static llvm::json::Object &checkerEntry(llvm::json::Object &Checkers,
+                                          StringRef Name) {
+    llvm::json::Value &V = Checkers[Name];
+    if (!V.getAsObject())
+      V = llvm::json::Object();
+    return *V.getAsObject();
+  }
+
+  std::string recordPath(StringRef MainFile) const {
+    llvm::MD5 Hash;
+    llvm::MD5::MD5Result Result;
+    Hash.update(MainFile);
+    Hash.final(Result);
+    SmallString<128> Path(Dir);
+    llvm::sys::path::append(Path, "tu-" + Result.digest() + ".json");
+    return Path.str();
+  }
+
+  std::string Dir;
+  bool Started = false;
+  std::chrono::steady_clock::time_point Start;
+  llvm::json::Array EntryPoints;
+  llvm::StringMap<unsigned> DiagCounts;
+};
+
+/// Counts the diagnostics each checker produced into the results database
+/// record. Registered next to the real path diagnostic consumers so that it
+/// sees exactly the reports that get emitted.
+class ResultsDBDiagConsumer : public PathDiagnosticConsumer {
+public:
+  ResultsDBDiagConsumer(ResultsDBWriter &DB) : DB(DB) {}
+
+  StringRef getName() const override { return "ResultsDBDiagConsumer"; }
+
+  /// The counts do not need the path; skip its generation.
+  PathGenerationScheme getGenerationScheme() const override { return None; }
+
+  void FlushDiagnosticsImpl(std::vector<const PathDiagnostic *> &Diags,
+                            FilesMade *FilesMade) override {
+    for (const PathDiagnostic *PD : Diags)
+      DB.countDiagnostic(PD->getCheckName());
+  }
+
+private:
+  ResultsDBWriter &DB;
+};
+} // end anonymous namespace
+
 //===----------------------------------------------------------------------===//
 // AnalysisConsumer declaration.
 //===----------------------------------------------------------------------===//
@@ -200,10 +591,62 @@ public:
   std::unique_ptr<llvm::Timer> ExprEngineTimer;
   std::unique_ptr<llvm::Timer> BugReporterTimer;
 
+  /// When the phase timers are on, the moment Initialize() ran; everything
+  /// until HandleTranslationUnit() is attributed to the 'parse' phase.
+  llvm::TimeRecord ParseStart;
+
   /// The information about analyzed functions shared throughout the
   /// translation unit.
   FunctionSummariesTy FunctionSummaries;
 
+  /// The per-function hash store of the incremental mode; null when the
+  /// 'incremental-analysis-dir' config option is not set.
+  std::unique_ptr<IncrementalAnalysisCache> IncrementalCache;
+
+  /// The cross-process coverage store for header-defined functions; null
+  /// when the 'analysis-dedup-dir' config option is not set.
+  std::unique_ptr<HeaderCoverageStore> CoverageStore;
+
+  /// The per-entry-point trace of the path sensitive analysis; null when the
+  /// 'entry-point-trace' config option is not set.
+  std::unique_ptr<EntryPointTraceWriter> TraceWriter;
+
+  /// The live progress event stream; null when the 'progress-events' config
+  /// option is not set.
+  std::unique_ptr<ProgressEventWriter> ProgressWriter;
+
+  /// The translation unit's record in the analysis results database; null
+  /// when the 'results-db' config option is not set.
+  std::unique_ptr<ResultsDBWriter> ResultsDB;
+
+  /// The complexity-proportional node budgets of the 'adaptive-node-budget'
+  /// mode; empty when the mode is off.
+  llvm::DenseMap<const Decl *, unsigned> EntryPointBudgets;
+
+  /// The per-function analysis profiles of the 'function-profiles' config
+  /// option, keyed by the printed function name; empty when the option is
+  /// not set.
+  enum FunctionProfile { ProfileDeep, ProfileShallow };
+  llvm::StringMap<FunctionProfile> FunctionProfiles;
+
+  /// Entry point index ranges assigned to this process by the shard
+  /// manifest, half-open and in terms of the deterministic entry point
+  /// numbering of HandleDeclsCallGraph. When the manifest is configured but
+  /// does not mention this translation unit, the list stays empty and no
+  /// entry point is path-analyzed.
+  std::vector<std::pair<unsigned, unsigned>> ShardManifestRanges;
+  bool HasShardManifest = false;
+
+  /// The USRs of the functions referenced anywhere in the build, loaded from
+  /// the 'analysis-reference-map' config option. Entry points missing from
+  /// the set are dead code and are skipped by getModeForDecl.
+  llvm::StringSet<> ReferencedFunctions;
+  bool HasReferenceMap = false;
+
+  /// Whether the last path sensitive entry point stopped because it reached
+  /// its node budget (see 'max-nodes') while unexplored work remained.
+  bool LastEntryPointExhaustedBudget = false;
+
   AnalysisConsumer(CompilerInstance &CI, const std::string &outdir,
                    AnalyzerOptionsRef opts, ArrayRef<std::string> plugins,
                    CodeInjector *injector)
@@ -211,6 +654,14 @@ public:
         PP(CI.getPreprocessor()), OutDir(outdir), Opts(std::move(opts)),
         Plugins(plugins), Injector(injector), CTU(CI) {
     DigestAnalyzerOptions();
+    if (!Opts->AnalysisResultsDBDir.empty()) {
+      ResultsDB =
+          llvm::make_unique<ResultsDBWriter>(Opts->AnalysisResultsDBDir);
+      // The counting consumer lives and dies with the other path diagnostic
+      // consumers; the writer outlives them so the counts can be saved after
+      // the flush.
+      PathConsumers.push_back(new ResultsDBDiagConsumer(*ResultsDB));
+    }
     if (Opts->PrintStats || Opts->ShouldSerializeStats) {
       AnalyzerTimers = llvm::make_unique<llvm::TimerGroup>(
           "analyzer", "Analyzer timers");
@@ -223,6 +674,9 @@ public:
           *AnalyzerTimers);
       llvm::EnableStatistics(/* PrintOnExit= */ false);
     }
+    if (Opts->ShouldEmitPhaseTimers || !Opts->PhaseTimersFile.empty() ||
+        CI.getFrontendOpts().ShowTimers)
+      PhaseTimers::enable();
   }
 
   ~AnalysisConsumer() override {
@@ -314,6 +768,9 @@ public:
     Mgr = llvm::make_unique<AnalysisManager>(
         *Ctx, PP.getDiagnostics(), PathConsumers, CreateStoreMgr,
         CreateConstraintMgr, checkerMgr.get(), *Opts, Injector);
+
+    if (PhaseTimers::isEnabled())
+      ParseStart = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
   }
 
   /// Store the top level decls in the set to be processed later on.
@@ -333,6 +790,46 @@ public:
   /// use it to define the order in which the functions should be visited.
   void HandleDeclsCallGraph(const unsigned LocalTUDeclsSize);
 
+  /// Append this TU's call graph to the file configured by
+  /// 'dump-ctu-callgraph', keyed by CTU lookup names so that the lines of
+  /// all the analyzer processes of a build can be merged into the whole
+  /// program call graph.
+  void DumpCTUCallGraph(CallGraph &CG);
+
+  /// For the 'adaptive-node-budget' mode, distribute the node budget of the
+  /// translation unit over the defined functions of \p CG in proportion to
+  /// their complexity estimates. The results are kept in \c
+  /// EntryPointBudgets; functions without an entry get the uniform budget.
+  void ComputeEntryPointBudgets(CallGraph &CG);
+
+  /// The node budget of each entry point, or the uniform
+  /// 'max-nodes' budget when the adaptive mode is off. A 'shallow' profile
+  /// caps the budget at the shallow-mode default.
+  unsigned getEntryPointBudget(const Decl *D);
+
+  /// Parse the classification file of the 'function-profiles' config option
+  /// into \c FunctionProfiles.
+  void loadFunctionProfiles();
+
+  /// Load the entry point ranges this process is assigned for the given main
+  /// file from the shard manifest.
+  void loadShardManifest(StringRef MainFilePath);
+
+  /// Load the set of referenced functions from the 'analysis-reference-map'
+  /// config option.
+  void loadReferenceMap();
+
+  bool isEntryPointInShard(unsigned Index) const {
+    for (const auto &Range : ShardManifestRanges)
+      if (Index >= Range.first && Index < Range.second)
+        return true;
+    return false;
+  }
+
+  /// The analysis profile assigned to \p D by the 'function-profiles'
+  /// config option, or None when the function is not listed.
+  llvm::Optional<FunctionProfile> getFunctionProfile(const Decl *D);
+
   /// Run analyzes(syntax or path sensitive) on the given function.
   /// \param Mode - determines if we are requesting syntax only or path
   /// sensitive only analysis.
@@ -356,6 +853,7 @@ public:
     if (Mode & AM_Syntax) {
       if (SyntaxCheckTimer)
         SyntaxCheckTimer->startTimer();
+      PhaseTimerScope SyntaxScope("ast-checks");
       checkerMgr->runCheckersOnASTDecl(D, *Mgr, *RecVisitorBR);
       if (SyntaxCheckTimer)
         SyntaxCheckTimer->stopTimer();
@@ -439,10 +937,25 @@ private:
   void storeTopLevelDecls(DeclGroupRef DG);
   std::string getFunctionName(const Decl *D);
 
+  /// Hash of the source text of the given declaration.
+  uint64_t getFunctionSourceHash(const Decl *D);
+
+  /// Hash of the source text of the given call graph node's declaration
+  /// combined with the hashes of its transitive callees. Recursion in the
+  /// call graph is broken by treating in-progress nodes as empty.
+  uint64_t
+  getCombinedFunctionHash(CallGraphNode *N,
+                          llvm::DenseMap<CallGraphNode *, uint64_t> &Memo);
+
   /// Check if we should skip (not analyze) the given function.
   AnalysisMode getModeForDecl(Decl *D, AnalysisMode Mode);
   void runAnalysisOnTranslationUnit(ASTContext &C);
 
+  /// Collect the function definitions matching the -analyze-function filter
+  /// without looking at any body.
+  void collectMatchingEntryPoints(DeclContext *DC,
+                                  SmallVectorImpl<Decl *> &Selected);
+
   /// Print \p S to stderr if \c Opts->AnalyzerDisplayProgress is set.
   void reportAnalyzerProgress(StringRef S);
 };
@@ -515,6 +1028,239 @@ AnalysisConsumer::getInliningModeForFunction(const Decl *D,
   return ExprEngine::Inline_Regular;
 }
 
+uint64_t AnalysisConsumer::getFunctionSourceHash(const Decl *D) {
+  // Hash the token stream rather than the raw characters, so reformatting
+  // and comment-only edits do not invalidate the incremental cache.
+  return hashRawTokensInRange(
+      CharSourceRange::getTokenRange(D->getSourceRange()),
+      Ctx->getSourceManager(), Ctx->getLangOpts());
+}
+
+uint64_t AnalysisConsumer::getCombinedFunctionHash(
+    CallGraphNode *N, llvm::DenseMap<CallGraphNode *, uint64_t> &Memo) {
+  auto Entry = Memo.find(N);
+  if (Entry != Memo.end())
+    return Entry->second;
+  // Break recursion in the call graph; the cycle members still contribute
+  // their own hashes to each other through the remaining edges.
+  Memo[N] = 0;
+
+  SmallVector<uint64_t, 8> CalleeHashes;
+  for (CallGraphNode *Callee : *N)
+    CalleeHashes.push_back(getCombinedFunctionHash(Callee, Memo));
+  // The combination must not depend on the order of the call expressions,
+  // otherwise pure reordering of calls would invalidate the caller.
+  llvm::sort(CalleeHashes);
+
+  llvm::MD5 Hash;
+  llvm::MD5::MD5Result Result;
+  uint64_t OwnHash = getFunctionSourceHash(N->getDecl());
+  Hash.update(StringRef(reinterpret_cast<const char *>(&OwnHash),
+                        sizeof(OwnHash)));
+  for (uint64_t CalleeHash : CalleeHashes)
+    Hash.update(StringRef(reinterpret_cast<const char *>(&CalleeHash),
+                          sizeof(CalleeHash)));
+  Hash.final(Result);
+
+  return Memo[N] = Result.low();
+}
+
+/// Walk a function body collecting the maximal loop nesting depth and the
+/// number of call sites, the complexity features that are not visible in the
+/// CFG block count alone.
+static void collectComplexityFeatures(const Stmt *S, unsigned Depth,
+                                      unsigned &MaxDepth, unsigned &Calls) {
+  if (!S)
+    return;
+  if (isa<ForStmt>(S) || isa<WhileStmt>(S) || isa<DoStmt>(S) ||
+      isa<CXXForRangeStmt>(S) || isa<ObjCForCollectionStmt>(S)) {
+    ++Depth;
+    MaxDepth = std::max(MaxDepth, Depth);
+  } else if (isa<CallExpr>(S) || isa<ObjCMessageExpr>(S)) {
+    ++Calls;
+  }
+  for (const Stmt *Child : S->children())
+    collectComplexityFeatures(Child, Depth, MaxDepth, Calls);
+}
+
+void AnalysisConsumer::ComputeEntryPointBudgets(CallGraph &CG) {
+  const uint64_t MaxNodes = Mgr->options.MaxNodesPerTopLevelFunction;
+
+  // Estimate how much exploration each defined function needs. The exact
+  // node count is unknowable up front; CFG size and call fan-out grow the
+  // graph roughly linearly while every level of loop nesting multiplies the
+  // explored paths, so the weight doubles per level (capped, as the budget
+  // clamp below makes higher precision pointless).
+  SmallVector<std::pair<const Decl *, uint64_t>, 32> Weights;
+  uint64_t TotalWeight = 0;
+  for (auto &Entry : CG) {
+    const Decl *D = Entry.first;
+    if (!D || !D->hasBody())
+      continue;
+    unsigned Blocks = 0;
+    if (const CFG *DeclCFG = Mgr->getCFG(D))
+      Blocks = DeclCFG->size();
+    unsigned LoopDepth = 0, Calls = 0;
+    collectComplexityFeatures(D->getBody(), 0, LoopDepth, Calls);
+    const uint64_t Weight =
+        uint64_t(Blocks + 2 * Calls + 1) << std::min(LoopDepth, 4u);
+    Weights.push_back({D, Weight});
+    TotalWeight += Weight;
+  }
+  if (Weights.empty() || !TotalWeight)
+    return;
+
+  // Distribute the budget of the whole translation unit proportionally. The
+  // clamp keeps a single huge function from starving all the others and
+  // bounds the extra time an outlier may take.
+  const uint64_t TotalBudget = MaxNodes * Weights.size();
+  for (const std::pair<const Decl *, uint64_t> &Entry : Weights) {
+    uint64_t Budget = TotalBudget * Entry.second / TotalWeight;
+    Budget = std::min(std::max(Budget, MaxNodes / 8), MaxNodes * 8);
+    EntryPointBudgets[Entry.first] = Budget;
+  }
+}
+
+unsigned AnalysisConsumer::getEntryPointBudget(const Decl *D) {
+  unsigned Budget = Mgr->options.MaxNodesPerTopLevelFunction;
+  auto I = EntryPointBudgets.find(D);
+  if (I != EntryPointBudgets.end())
+    Budget = I->second;
+
+  // A 'shallow' profile caps the budget at the shallow-mode default of
+  // 'max-nodes' even when the invocation runs in deep mode, so the listed
+  // cold functions cannot consume more exploration than a shallow run would
+  // have granted them.
+  if (getFunctionProfile(D) == ProfileShallow)
+    Budget = std::min(Budget, 75000u);
+  return Budget;
+}
+
+void AnalysisConsumer::loadFunctionProfiles() {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Opts->FunctionProfilesFile);
+  if (!Buffer) {
+    llvm::errs() << "warning: could not read the function profiles from '"
+                 << Opts->FunctionProfilesFile
+                 << "': " << Buffer.getError().message() << '\n';
+    return;
+  }
+
+  for (llvm::line_iterator LI(**Buffer, /*SkipBlanks=*/true, '#');
+       !LI.is_at_eof(); ++LI) {
+    // Only the first token is the profile; the function name may itself
+    // contain spaces (C++ signatures are printed with a parameter list).
+    std::pair<StringRef, StringRef> Split = LI->trim().split(' ');
+    StringRef Name = Split.second.trim();
+    if (Name.empty()) {
+      llvm::errs() << "warning: malformed line " << LI.line_number()
+                   << " in '" << Opts->FunctionProfilesFile << "'\n";
+      continue;
+    }
+    if (Split.first == "deep")
+      FunctionProfiles[Name] = ProfileDeep;
+    else if (Split.first == "shallow")
+      FunctionProfiles[Name] = ProfileShallow;
+    else
+      llvm::errs() << "warning: unknown analysis profile '" << Split.first
+                   << "' in '" << Opts->FunctionProfilesFile << "'\n";
+  }
+}
+
+void AnalysisConsumer::loadShardManifest(StringRef MainFilePath) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Opts->AnalysisShardManifest);
+  if (!Buffer) {
+    llvm::errs() << "warning: could not read the shard manifest from '"
+                 << Opts->AnalysisShardManifest
+                 << "': " << Buffer.getError().message() << '\n';
+    return;
+  }
+
+  HasShardManifest = true;
+  for (llvm::line_iterator LI(**Buffer, /*SkipBlanks=*/true, '#');
+       !LI.is_at_eof(); ++LI) {
+    // The first token is the half-open entry point range; the rest of the
+    // line is the main file path of the translation unit, which may itself
+    // contain spaces.
+    std::pair<StringRef, StringRef> Split = LI->trim().split(' ');
+    std::pair<StringRef, StringRef> Range = Split.first.split('-');
+    StringRef File = Split.second.trim();
+    unsigned Begin, End;
+    if (File.empty() || Range.first.getAsInteger(10, Begin) ||
+        Range.second.getAsInteger(10, End)) {
+      llvm::errs() << "warning: malformed line " << LI.line_number()
+                   << " in '" << Opts->AnalysisShardManifest << "'\n";
+      continue;
+    }
+    if (File == MainFilePath)
+      ShardManifestRanges.push_back(std::make_pair(Begin, End));
+  }
+}
+
+void AnalysisConsumer::loadReferenceMap() {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Opts->AnalysisReferenceMap);
+  if (!Buffer) {
+    llvm::errs() << "warning: could not read the reference map from '"
+                 << Opts->AnalysisReferenceMap
+                 << "': " << Buffer.getError().message() << '\n';
+    return;
+  }
+
+  HasReferenceMap = true;
+  // Each line is the USR of a referenced function.
+  for (llvm::line_iterator LI(**Buffer, /*SkipBlanks=*/true, '#');
+       !LI.is_at_eof(); ++LI)
+    ReferencedFunctions.insert(LI->trim());
+}
+
+llvm::Optional<AnalysisConsumer::FunctionProfile>
+AnalysisConsumer::getFunctionProfile(const Decl *D) {
+  if (FunctionProfiles.empty())
+    return None;
+  auto I = FunctionProfiles.find(getFunctionName(D));
+  if (I == FunctionProfiles.end())
+    return None;
+  return I->second;
+}
+
+void AnalysisConsumer::DumpCTUCallGraph(CallGraph &CG) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Opts->CTUCallGraphDumpFile, EC,
+                          llvm::sys::fs::OF_Append | llvm::sys::fs::OF_Text);
+  if (EC) {
+    llvm::errs() << "warning: could not write the call graph to '"
+                 << Opts->CTUCallGraphDumpFile << "': " << EC.message()
+                 << '\n';
+    return;
+  }
+
+  // Walk the graph in reverse post order only to keep the output of a TU
+  // deterministic; consumers must not rely on the line order.
+  llvm::ReversePostOrderTraversal<clang::CallGraph *> RPOT(&CG);
+  for (CallGraphNode *N : RPOT) {
+    // Skips the abstract root node, which has no declaration.
+    const auto *ND = dyn_cast_or_null<NamedDecl>(N->getDecl());
+    if (!ND)
+      continue;
+    llvm::Optional<std::string> Name =
+        cross_tu::CrossTranslationUnitContext::getLookupName(ND);
+    if (!Name)
+      continue;
+    OS << *Name;
+    for (CallGraphNode *Callee : *N) {
+      const auto *CalleeND = dyn_cast_or_null<NamedDecl>(Callee->getDecl());
+      if (!CalleeND)
+        continue;
+      if (llvm::Optional<std::string> CalleeName =
+              cross_tu::CrossTranslationUnitContext::getLookupName(CalleeND))
+        OS << ' ' << *CalleeName;
+    }
+    OS << '\n';
+  }
+}
+
 void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   // Build the Call Graph by adding all the top level declarations to the graph.
   // Note: CallGraph can trigger deserialization of more items from a pch
@@ -525,6 +1271,16 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     CG.addToCallGraph(LocalTUDecls[i]);
   }
 
+  if (!Opts->CTUCallGraphDumpFile.empty())
+    DumpCTUCallGraph(CG);
+
+  if (Opts->ShouldUseAdaptiveNodeBudget &&
+      Mgr->options.MaxNodesPerTopLevelFunction)
+    ComputeEntryPointBudgets(CG);
+
+  // Memoized combined hashes for the incremental mode.
+  llvm::DenseMap<CallGraphNode *, uint64_t> FunctionHashes;
+
   // Walk over all of the call graph nodes in topological order, so that we
   // analyze parents before the children. Skip the functions inlined into
   // the previously processed functions. Use external Visited set to identify
@@ -533,6 +1289,7 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   // often.
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
+  unsigned EntryPointIndex = 0;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
@@ -545,17 +1302,71 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    // Number the entry point candidates before any skipping heuristic runs.
+    // The heuristics depend on what this process has analyzed or inlined so
+    // far, so counting after them would make the numbering disagree between
+    // the processes a shard manifest spreads this translation unit over.
+    const unsigned EntryPoint = EntryPointIndex++;
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
       continue;
 
+    // Skip the entry points the shard manifest assigns to other processes;
+    // their reports are part of the output of those processes.
+    if (HasShardManifest && !isEntryPointInShard(EntryPoint))
+      continue;
+
+    // In incremental mode, skip the path sensitive reanalysis of functions
+    // that are unchanged since the previous run, including their transitive
+    // callees. Their reports from the previous run remain valid. Functions
+    // that are analyzed now are recorded only after the analysis, so that an
+    // entry point cut short by the node budget stays out of the cache.
+    uint64_t IncrementalHash = 0;
+    if (IncrementalCache) {
+      IncrementalHash = getCombinedFunctionHash(N, FunctionHashes);
+      const std::string Name = getFunctionName(D);
+      if (IncrementalCache->isUpToDate(Name, IncrementalHash)) {
+        IncrementalCache->record(Name, IncrementalHash);
+        ++NumFunctionsSkippedIncremental;
+        VisitedAsTopLevel.insert(D);
+        continue;
+      }
+    }
+
+    // Skip the path sensitive analysis of header-defined functions that
+    // another analyzer process already covered; their reports are part of
+    // the output of that process. Functions of the main file are never
+    // deduplicated.
+    if (CoverageStore &&
+        !Ctx->getSourceManager().isInMainFile(D->getLocation())) {
+      const uint64_t CombinedHash = getCombinedFunctionHash(N, FunctionHashes);
+      if (CoverageStore->isCovered(CombinedHash)) {
+        ++NumHeaderFunctionsDeduplicated;
+        if (IncrementalCache)
+          IncrementalCache->record(getFunctionName(D), IncrementalHash);
+        VisitedAsTopLevel.insert(D);
+        continue;
+      }
+      CoverageStore->markCovered(CombinedHash);
+    }
+
     // Analyze the function.
     SetOfConstDecls VisitedCallees;
 
+    LastEntryPointExhaustedBudget = false;
     HandleCode(D, AM_Path, getInliningModeForFunction(D, Visited),
                (Mgr->options.InliningMode == All ? nullptr : &VisitedCallees));
 
+    // Record the entry point for the incremental mode only if its exploration
+    // finished within the node budget. An exhausted entry point is left out
+    // of the cache, so a later run -- possibly configured with a higher
+    // budget -- reanalyzes it instead of trusting a truncated result. The
+    // reports found before exhaustion were still flushed above.
+    if (IncrementalCache && !LastEntryPointExhaustedBudget)
+      IncrementalCache->record(getFunctionName(D), IncrementalHash);
+
     // Add the visited callees to the global visited set.
     for (const Decl *Callee : VisitedCallees)
       // Decls from CallGraph are already canonical. But Decls coming from
@@ -575,36 +1386,126 @@ static bool isBisonFile(ASTContext &C) {
   return false;
 }
 
+void AnalysisConsumer::collectMatchingEntryPoints(
+    DeclContext *DC, SmallVectorImpl<Decl *> &Selected) {
+  // The walk stays on the level of declarations: the definedness checks and
+  // the printed name only need the decl records, so under a PCH the bodies
+  // of the unselected functions are never deserialized. Function-local
+  // contexts are not entered; a block cannot be named by -analyze-function
+  // without analyzing its enclosing function anyway.
+  for (Decl *D : DC->decls()) {
+    if (auto *FD = dyn_cast<FunctionDecl>(D)) {
+      if (FD->isThisDeclarationADefinition() && !FD->isDependentContext() &&
+          getFunctionName(FD) == Opts->AnalyzeSpecificFunction)
+        Selected.push_back(FD);
+      continue;
+    }
+    if (auto *MD = dyn_cast<ObjCMethodDecl>(D)) {
+      if (MD->isThisDeclarationADefinition() &&
+          getFunctionName(MD) == Opts->AnalyzeSpecificFunction)
+        Selected.push_back(MD);
+      continue;
+    }
+    // Instantiations are not part of any lexical declaration list; reach
+    // them through their templates. The patterns themselves are dependent
+    // and therefore never entry points.
+    if (auto *FTD = dyn_cast<FunctionTemplateDecl>(D)) {
+      for (FunctionDecl *Spec : FTD->specializations())
+        if (Spec->isThisDeclarationADefinition() &&
+            getFunctionName(Spec) == Opts->AnalyzeSpecificFunction)
+          Selected.push_back(Spec);
+      continue;
+    }
+    if (auto *CTD = dyn_cast<ClassTemplateDecl>(D)) {
+      for (ClassTemplateSpecializationDecl *Spec : CTD->specializations())
+        collectMatchingEntryPoints(Spec, Selected);
+      continue;
+    }
+    if (auto *Inner = dyn_cast<DeclContext>(D))
+      collectMatchingEntryPoints(Inner, Selected);
+  }
+}
+
 void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
   BugReporter BR(*Mgr);
   TranslationUnitDecl *TU = C.getTranslationUnitDecl();
+
+  if (!Opts->IncrementalAnalysisDir.empty()) {
+    const SourceManager &SM = C.getSourceManager();
+    StringRef MainFilePath =
+        SM.getBuffer(SM.getMainFileID())->getBufferIdentifier();
+    IncrementalCache = llvm::make_unique<IncrementalAnalysisCache>(
+        Opts->IncrementalAnalysisDir, MainFilePath);
+  }
+  if (!Opts->AnalysisShardManifest.empty()) {
+    const SourceManager &SM = C.getSourceManager();
+    loadShardManifest(SM.getBuffer(SM.getMainFileID())->getBufferIdentifier());
+  }
+  if (!Opts->AnalysisReferenceMap.empty())
+    loadReferenceMap();
+  if (!Opts->AnalysisDedupDir.empty())
+    CoverageStore = llvm::make_unique<HeaderCoverageStore>(
+        Opts->AnalysisDedupDir);
+  if (!Opts->EntryPointTraceFile.empty())
+    TraceWriter =
+        llvm::make_unique<EntryPointTraceWriter>(Opts->EntryPointTraceFile);
+  if (!Opts->ProgressEventsFile.empty()) {
+    const SourceManager &SM = C.getSourceManager();
+    ProgressWriter = llvm::make_unique<ProgressEventWriter>(
+        Opts->ProgressEventsFile,
+        SM.getBuffer(SM.getMainFileID())->getBufferIdentifier());
+  }
+  if (!Opts->FunctionProfilesFile.empty())
+    loadFunctionProfiles();
+  if (ResultsDB)
+    ResultsDB->markAnalysisStart();
   if (SyntaxCheckTimer)
     SyntaxCheckTimer->startTimer();
-  checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+  {
+    PhaseTimerScope SyntaxScope("ast-checks");
+    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+  }
   if (SyntaxCheckTimer)
     SyntaxCheckTimer->stopTimer();
 
-  // Run the AST-only checks using the order in which functions are defined.
-  // If inlining is not turned on, use the simplest function order for path
-  // sensitive analyzes as well.
-  RecVisitorMode = AM_Syntax;
-  if (!Mgr->shouldInlineCall())
-    RecVisitorMode |= AM_Path;
-  RecVisitorBR = &BR;
-
-  // Process all the top level declarations.
-  //
-  // Note: TraverseDecl may modify LocalTUDecls, but only by appending more
-  // entries.  Thus we don't use an iterator, but rely on LocalTUDecls
-  // random access.  By doing so, we automatically compensate for iterators
-  // possibly being invalidated, although this is a bit slower.
-  const unsigned LocalTUDeclsSize = LocalTUDecls.size();
-  for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
-    TraverseDecl(LocalTUDecls[i]);
-  }
+  if (!Opts->AnalyzeSpecificFunction.empty()) {
+    // A single entry point was requested. Both the syntax visitation and the
+    // call graph construction below walk every function body only to have
+    // getModeForDecl discard all but the match, which under a PCH pays the
+    // deserialization of every body. Enumerate the candidates from
+    // decl-level data instead; bodies are then deserialized on demand for
+    // the selected function and, during inlining, for its callees.
+    SmallVector<Decl *, 4> Selected;
+    collectMatchingEntryPoints(TU, Selected);
+    for (Decl *D : Selected)
+      HandleCode(D, AM_Syntax | AM_Path, ExprEngine::Inline_Regular,
+                 /*VisitedCallees=*/nullptr);
+  } else {
+    // Run the AST-only checks using the order in which functions are defined.
+    // If inlining is not turned on, use the simplest function order for path
+    // sensitive analyzes as well. When no path-sensitive checker is enabled
+    // at all, stay in the syntax-only lane: there is no point ordering entry
+    // points or building the call graph for an engine that will never run.
+    const bool HasPathCheckers = checkerMgr->hasPathSensitiveCheckers();
+    RecVisitorMode = AM_Syntax;
+    if (HasPathCheckers && !Mgr->shouldInlineCall())
+      RecVisitorMode |= AM_Path;
+    RecVisitorBR = &BR;
+
+    // Process all the top level declarations.
+    //
+    // Note: TraverseDecl may modify LocalTUDecls, but only by appending more
+    // entries.  Thus we don't use an iterator, but rely on LocalTUDecls
+    // random access.  By doing so, we automatically compensate for iterators
+    // possibly being invalidated, although this is a bit slower.
+    const unsigned LocalTUDeclsSize = LocalTUDecls.size();
+    for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
+      TraverseDecl(LocalTUDecls[i]);
+    }
 
-  if (Mgr->shouldInlineCall())
-    HandleDeclsCallGraph(LocalTUDeclsSize);
+    if (HasPathCheckers && Mgr->shouldInlineCall())
+      HandleDeclsCallGraph(LocalTUDeclsSize);
+  }
 
   // After all decls handled, run checkers on the entire TranslationUnit.
   checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
@@ -624,6 +1525,13 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
   if (Diags.hasErrorOccurred() || Diags.hasFatalErrorOccurred())
     return;
 
+  if (PhaseTimers::isEnabled()) {
+    llvm::TimeRecord ParseTime =
+        llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+    ParseTime -= ParseStart;
+    PhaseTimers::addSample("parse", ParseTime);
+  }
+
   if (isBisonFile(C)) {
     reportAnalyzerProgress("Skipping bison-generated file\n");
   } else if (Opts->DisableAllChecks) {
@@ -633,6 +1541,7 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     reportAnalyzerProgress("All checks are disabled using a supplied option\n");
   } else {
     // Otherwise, just run the analysis.
+    PhaseTimerScope AnalysisScope("analysis");
     runAnalysisOnTranslationUnit(C);
   }
 
@@ -645,11 +1554,43 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
       (FunctionSummaries.getTotalNumVisitedBasicBlocks() * 100) /
         NumBlocksInAnalyzedFunctions;
 
+  if (IncrementalCache)
+    IncrementalCache->save();
+
+  if (TraceWriter)
+    TraceWriter->save();
+
   // Explicitly destroy the PathDiagnosticConsumer.  This will flush its output.
   // FIXME: This should be replaced with something that doesn't rely on
   // side-effects in PathDiagnosticConsumer's destructor. This is required when
   // used with option -disable-free.
-  Mgr.reset();
+  {
+    PhaseTimerScope FlushScope("flush-diagnostics");
+    Mgr.reset();
+  }
+
+  // The per-checker diagnostic counts are complete only after the path
+  // diagnostic consumers have been flushed above.
+  if (ResultsDB && ResultsDB->hasAnalysisStarted()) {
+    const SourceManager &SM = C.getSourceManager();
+    const FileEntry *FE = SM.getFileEntryForID(SM.getMainFileID());
+    ResultsDB->save(FE ? FE->getName() : StringRef("<unknown>"), *checkerMgr);
+  }
+
+  if (PhaseTimers::isEnabled()) {
+    PhaseTimers::print(llvm::errs());
+    if (!Opts->PhaseTimersFile.empty()) {
+      std::error_code EC;
+      llvm::raw_fd_ostream OS(Opts->PhaseTimersFile, EC,
+                              llvm::sys::fs::OF_Text);
+      if (EC)
+        llvm::errs() << "warning: could not write the phase timers to '"
+                     << Opts->PhaseTimersFile << "': " << EC.message() << '\n';
+      else
+        PhaseTimers::printJSON(OS);
+    }
+    PhaseTimers::reset();
+  }
 }
 
 std::string AnalysisConsumer::getFunctionName(const Decl *D) {
@@ -718,6 +1659,34 @@ AnalysisConsumer::getModeForDecl(Decl *D, AnalysisMode Mode) {
       getFunctionName(D) != Opts->AnalyzeSpecificFunction)
     return AM_None;
 
+  // When the entry points of the translation unit are sharded across several
+  // cooperating analyzer processes, only handle the entry points that hash
+  // into the shard of this process. The hash must be stable across processes,
+  // so it is computed from the printed function name. Note that the skipped
+  // entry points may still be analyzed as inlined callees.
+  if (Opts->AnalysisShardCount > 1 &&
+      llvm::djbHash(getFunctionName(D)) % Opts->AnalysisShardCount !=
+          Opts->AnalysisShardIndex)
+    return AM_None;
+
+  // Skip entry points nothing in the build references (unreferenced template
+  // instantiations, platform-excluded helpers), according to the reference
+  // map emitted by clang-extdef-mapping. Externally visible functions are
+  // kept unless configured otherwise, since their callers may live outside
+  // the build. Like the sharding above, the skipped entry points may still
+  // be analyzed as inlined callees.
+  if (HasReferenceMap) {
+    if (const auto *ND = dyn_cast<NamedDecl>(D)) {
+      if (!(Opts->AnalysisReferenceMapKeepExternal &&
+            ND->isExternallyVisible())) {
+        llvm::Optional<std::string> LookupName =
+            cross_tu::CrossTranslationUnitContext::getLookupName(ND);
+        if (LookupName && !ReferencedFunctions.count(*LookupName))
+          return AM_None;
+      }
+    }
+  }
+
   // Unless -analyze-all is specified, treat decls differently depending on
   // where they came from:
   // - Main source file: run both path-sensitive and non-path-sensitive checks.
@@ -752,21 +1721,42 @@ void AnalysisConsumer::HandleCode(Decl *D, AnalysisMode Mode,
   if (Mgr->getAnalysisDeclContext(D)->isBodyAutosynthesized())
     return;
 
+  // Apply the analysis profile of the entry point, if the classification
+  // file assigned one. A 'shallow' function is analyzed without inlining
+  // (its node budget is capped in getEntryPointBudget); a 'deep' function
+  // keeps full inlining even when getInliningModeForFunction downgraded it
+  // because the function was already visited as an inlined callee.
+  if (Optional<FunctionProfile> Profile = getFunctionProfile(D))
+    IMode = *Profile == ProfileShallow ? ExprEngine::Inline_Minimal
+                                       : ExprEngine::Inline_Regular;
+
   DisplayFunction(D, Mode, IMode);
-  CFG *DeclCFG = Mgr->getCFG(D);
-  if (DeclCFG)
-    MaxCFGSize.updateMax(DeclCFG->size());
+
+  // Only build the CFG eagerly when the path-sensitive engine is about to
+  // consume it. AST-body checkers that need one request it lazily through
+  // the AnalysisDeclContext, so a syntax-only run pays nothing here.
+  const bool RunPathChecks =
+      (Mode & AM_Path) && checkerMgr->hasPathSensitiveCheckers();
+  if (RunPathChecks) {
+    PhaseTimerScope CFGScope("cfg-build");
+    CFG *DeclCFG = Mgr->getCFG(D);
+    if (DeclCFG)
+      MaxCFGSize.updateMax(DeclCFG->size());
+  }
 
   BugReporter BR(*Mgr);
 
   if (Mode & AM_Syntax) {
     if (SyntaxCheckTimer)
       SyntaxCheckTimer->startTimer();
-    checkerMgr->runCheckersOnASTBody(D, *Mgr, BR);
+    {
+      PhaseTimerScope SyntaxScope("ast-checks");
+      checkerMgr->runCheckersOnASTBody(D, *Mgr, BR);
+    }
     if (SyntaxCheckTimer)
       SyntaxCheckTimer->stopTimer();
   }
-  if ((Mode & AM_Path) && checkerMgr->hasPathSensitiveCheckers()) {
+  if (RunPathChecks) {
     RunPathSensitiveChecks(D, IMode, VisitedCallees);
     if (IMode != ExprEngine::Inline_Minimal)
       NumFunctionsAnalyzed++;
@@ -791,17 +1781,44 @@ void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
 
   ExprEngine Eng(CTU, *Mgr, VisitedCallees, &FunctionSummaries, IMode);
 
+  if (ProgressWriter)
+    ProgressWriter->beginEntryPoint(getFunctionName(D));
+
+  const uint64_t TraceStart = TraceWriter ? TraceWriter->now() : 0;
+  const std::chrono::steady_clock::time_point EntryPointStart =
+      std::chrono::steady_clock::now();
+  double CheckerSecondsBefore = 0;
+  if (TraceWriter && checkerMgr->shouldProfileCheckers())
+    CheckerSecondsBefore = checkerMgr->getTotalCheckerTime().getWallTime();
+
   // Execute the worklist algorithm.
   if (ExprEngineTimer)
     ExprEngineTimer->startTimer();
-  Eng.ExecuteWorkList(Mgr->getAnalysisDeclContextManager().getStackFrame(D),
-                      Mgr->options.MaxNodesPerTopLevelFunction);
+  bool WorkRemaining;
+  {
+    PhaseTimerScope ExplorationScope("path-exploration");
+    WorkRemaining = Eng.ExecuteWorkList(
+        Mgr->getAnalysisDeclContextManager().getStackFrame(D),
+        getEntryPointBudget(D));
+  }
   if (ExprEngineTimer)
     ExprEngineTimer->stopTimer();
 
+  if (WorkRemaining) {
+    ++NumEntryPointsExhaustedBudget;
+    LastEntryPointExhaustedBudget = true;
+  }
+
   if (!Mgr->options.DumpExplodedGraphTo.empty())
     Eng.DumpGraph(Mgr->options.TrimGraph, Mgr->options.DumpExplodedGraphTo);
 
+  if (ExplodedGraphTrace *Trace = Eng.getGraph().getTrace())
+    if (std::error_code EC =
+            Trace->appendTo(Mgr->options.TransitionTraceFile, getFunctionName(D)))
+      llvm::errs() << "warning: could not write the transition trace to '"
+                   << Mgr->options.TransitionTraceFile << "': " << EC.message()
+                   << '\n';
+
   // Visualize the exploded graph.
   if (Mgr->options.visualizeExplodedGraphWithGraphViz)
     Eng.ViewGraph(Mgr->options.TrimGraph);
@@ -809,9 +1826,38 @@ void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
   // Display warnings.
   if (BugReporterTimer)
     BugReporterTimer->startTimer();
-  Eng.getBugReporter().FlushReports();
+  {
+    PhaseTimerScope ReportScope("bug-reporting");
+    Eng.getBugReporter().FlushReports();
+  }
   if (BugReporterTimer)
     BugReporterTimer->stopTimer();
+
+  if (TraceWriter) {
+    // The time spent in checker callbacks is only known when checker
+    // profiling is on; a negative value omits it from the record.
+    double CheckerSeconds = -1;
+    if (checkerMgr->shouldProfileCheckers())
+      CheckerSeconds = checkerMgr->getTotalCheckerTime().getWallTime() -
+                       CheckerSecondsBefore;
+    TraceWriter->recordEntryPoint(getFunctionName(D), TraceStart,
+                                  TraceWriter->now(), Eng.getGraph().size(),
+                                  Mgr->getCFG(D)->size(), CheckerSeconds,
+                                  WorkRemaining,
+                                  Eng.getCoreEngine().getStatsDeltas());
+  }
+
+  if (ProgressWriter)
+    ProgressWriter->endEntryPoint(getFunctionName(D), Eng.getGraph().size(),
+                                  WorkRemaining);
+
+  if (ResultsDB)
+    ResultsDB->recordEntryPoint(
+        getFunctionName(D),
+        std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                      EntryPointStart)
+            .count(),
+        Eng.getGraph().size(), WorkRemaining);
 }
 
 //===----------------------------------------------------------------------===//
@@ -361,29 +361,37 @@ template <class T>
 static void
 insertOptionToCollection(StringRef FullName, T &Collection,
                          const CheckerRegistry::CmdLineOption &Option,
-                         AnalyzerOptions &AnOpts, DiagnosticsEngine &Diags) {
-  auto It = binaryFind(Collection, FullName);
-  assert(It != Collection.end() &&
+                         AnalyzerOptions &AnOpts, DiagnosticsEngine &Diags,
+                         typename T::iterator &LastFound) {
+  // The options of one checker or package arrive back to back, so the
+  // previous lookup satisfies most queries.
+  if (LastFound == Collection.end() || LastFound->FullName != FullName)
+    LastFound = binaryFind(Collection, FullName);
+  assert(LastFound != Collection.end() &&
          "Failed to find the checker while attempting to add a command line "
          "option to it!");
 
   insertAndValidate(FullName, Option, AnOpts, Diags);
 
-  It->CmdLineOptions.emplace_back(Option);
+  LastFound->CmdLineOptions.emplace_back(Option);
 }
 
 void CheckerRegistry::resolveCheckerAndPackageOptions() {
+  auto LastChecker = Checkers.end();
   for (const std::pair<StringRef, CmdLineOption> &CheckerOptEntry :
        CheckerOptions) {
     insertOptionToCollection(CheckerOptEntry.first, Checkers,
-                             CheckerOptEntry.second, AnOpts, Diags);
+                             CheckerOptEntry.second, AnOpts, Diags,
+                             LastChecker);
   }
   CheckerOptions.clear();
 
+  auto LastPackage = Packages.end();
   for (const std::pair<StringRef, CmdLineOption> &PackageOptEntry :
        PackageOptions) {
     insertOptionToCollection(PackageOptEntry.first, Packages,
-                             PackageOptEntry.second, AnOpts, Diags);
+                             PackageOptEntry.second, AnOpts, Diags,
+                             LastPackage);
   }
   PackageOptions.clear();
 }
@@ -466,6 +474,11 @@ isOptionContainedIn(const CheckerRegistry::CmdLineOptionList &OptionList,
 }
 
 void CheckerRegistry::validateCheckerOptions() const {
+  // A configuration loaded from a cache file (-analyzer-config-cache) already
+  // passed this validation in the invocation that wrote it.
+  if (AnOpts.HasPrevalidatedConfig)
+    return;
+
   for (const auto &Config : AnOpts.Config) {
 
     StringRef SuppliedChecker;
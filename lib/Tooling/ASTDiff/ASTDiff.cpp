@@ -14,6 +14,8 @@
 
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Lex/Lexer.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/PriorityQueue.h"
 
 #include <limits>
@@ -89,9 +91,11 @@ private:
   // subtrees, but only if both have fewer nodes than MaxSize.
   void addOptimalMapping(Mapping &M, NodeId Id1, NodeId Id2) const;
 
-  // Computes the ratio of common descendants between the two nodes.
-  // Descendants are only considered to be equal when they are mapped in M.
-  double getJaccardSimilarity(const Mapping &M, NodeId Id1, NodeId Id2) const;
+  // Computes the ratio of common descendants between the two nodes from the
+  // number of descendants of Id1 whose mapped image lies in the subtree of
+  // Id2, as counted by the caller.
+  double getJaccardSimilarity(NodeId Id1, NodeId Id2,
+                              int CommonDescendants) const;
 
   // Returns the node that has the highest degree of similarity.
   NodeId findCandidate(const Mapping &M, NodeId Id1) const;
@@ -134,6 +138,10 @@ public:
   // Maps preorder indices to postorder ones.
   std::vector<int> PostorderIds;
   std::vector<NodeId> NodesBfs;
+  /// Fingerprint of every subtree, combining the kind, value and children
+  /// fingerprints of its root. Equal subtrees have equal fingerprints, so an
+  /// unequal fingerprint disproves subtree equality in constant time.
+  std::vector<size_t> SubtreeHashes;
 
   int getSize() const { return Nodes.size(); }
   NodeId getRootId() const { return 0; }
@@ -305,11 +313,17 @@ void SyntaxTree::Impl::initTree() {
   setLeftMostDescendants();
   int PostorderId = 0;
   PostorderIds.resize(getSize());
+  SubtreeHashes.resize(getSize());
   std::function<void(NodeId)> PostorderTraverse = [&](NodeId Id) {
     for (NodeId Child : getNode(Id).Children)
       PostorderTraverse(Child);
     PostorderIds[Id] = PostorderId;
     ++PostorderId;
+    llvm::hash_code Hash =
+        llvm::hash_combine(getNode(Id).getTypeLabel(), getNodeValue(Id));
+    for (NodeId Child : getNode(Id).Children)
+      Hash = llvm::hash_combine(Hash, SubtreeHashes[Child]);
+    SubtreeHashes[Id] = Hash;
   };
   PostorderTraverse(getRootId());
   NodesBfs = getSubtreeBfs(*this, getRootId());
@@ -756,6 +770,12 @@ public:
 } // end anonymous namespace
 
 bool ASTDiff::Impl::identical(NodeId Id1, NodeId Id2) const {
+  // Both trees fingerprint their subtrees with the same function, so a
+  // fingerprint mismatch disproves equality without walking the subtrees.
+  // Equal fingerprints still get verified structurally below to guard
+  // against collisions.
+  if (T1.SubtreeHashes[Id1] != T2.SubtreeHashes[Id2])
+    return false;
   const Node &N1 = T1.getNode(Id1);
   const Node &N2 = T2.getNode(Id2);
   if (N1.Children.size() != N2.Children.size() ||
@@ -795,15 +815,8 @@ void ASTDiff::Impl::addOptimalMapping(Mapping &M, NodeId Id1,
   }
 }
 
-double ASTDiff::Impl::getJaccardSimilarity(const Mapping &M, NodeId Id1,
-                                           NodeId Id2) const {
-  int CommonDescendants = 0;
-  const Node &N1 = T1.getNode(Id1);
-  // Count the common descendants, excluding the subtree root.
-  for (NodeId Src = Id1 + 1; Src <= N1.RightMostDescendant; ++Src) {
-    NodeId Dst = M.getDst(Src);
-    CommonDescendants += int(Dst.isValid() && T2.isInSubtree(Dst, Id2));
-  }
+double ASTDiff::Impl::getJaccardSimilarity(NodeId Id1, NodeId Id2,
+                                           int CommonDescendants) const {
   // We need to subtract 1 to get the number of descendants excluding the root.
   double Denominator = T1.getNumberOfDescendants(Id1) - 1 +
                        T2.getNumberOfDescendants(Id2) - 1 - CommonDescendants;
@@ -815,14 +828,36 @@ double ASTDiff::Impl::getJaccardSimilarity(const Mapping &M, NodeId Id1,
 }
 
 NodeId ASTDiff::Impl::findCandidate(const Mapping &M, NodeId Id1) const {
+  // Only the nodes on a path from the image of a mapped descendant of Id1 to
+  // the root can have descendants in common with Id1. Counting the common
+  // descendants while walking up those paths enumerates exactly the nodes
+  // with nonzero similarity; every other node has similarity zero and could
+  // never become the candidate below, since the initial similarity to beat
+  // is already zero. This replaces a scan of the whole destination tree per
+  // unmatched source node.
+  llvm::SmallDenseMap<int, int, 16> CommonDescendants;
+  const Node &N1 = T1.getNode(Id1);
+  for (NodeId Src = Id1 + 1; Src <= N1.RightMostDescendant; ++Src) {
+    NodeId Dst = M.getDst(Src);
+    if (Dst.isInvalid())
+      continue;
+    for (NodeId Anc = Dst; Anc.isValid(); Anc = T2.getNode(Anc).Parent)
+      ++CommonDescendants[Anc];
+  }
+  // Visit the candidates in the order the former full scan did, so that ties
+  // break the same way and the output stays identical.
+  SmallVector<std::pair<int, int>, 16> Candidates(CommonDescendants.begin(),
+                                                  CommonDescendants.end());
+  llvm::sort(Candidates);
   NodeId Candidate;
   double HighestSimilarity = 0.0;
-  for (NodeId Id2 : T2) {
+  for (const std::pair<int, int> &C : Candidates) {
+    NodeId Id2(C.first);
     if (!isMatchingPossible(Id1, Id2))
       continue;
     if (M.hasDst(Id2))
       continue;
-    double Similarity = getJaccardSimilarity(M, Id1, Id2);
+    double Similarity = getJaccardSimilarity(Id1, Id2, C.second);
     if (Similarity >= Options.MinSimilarity && Similarity > HighestSimilarity) {
       HighestSimilarity = Similarity;
       Candidate = Id2;
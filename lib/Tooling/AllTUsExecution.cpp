@@ -8,6 +8,9 @@
 
 #include "clang/Tooling/AllTUsExecution.h"
 #include "clang/Tooling/ToolExecutorPluginRegistry.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/VirtualFileSystem.h"
 
@@ -29,6 +32,153 @@ ArgumentsAdjuster getDefaultArgumentsAdjusters() {
                        getClangStripDependencyFileAdjuster()));
 }
 
+/// A thread-safe cache of stat results and file contents, shared by all
+/// worker threads of one executor run. The threads compile against the same
+/// headers over and over; without the cache every thread re-stats and
+/// re-reads each header through its own FileManager. The inputs are assumed
+/// to be immutable for the duration of the run, which also holds for the
+/// uncached execution as soon as more than one thread is used.
+///
+/// The cache is append-only and outlives all worker threads, so handing out
+/// non-owning views of the cached buffers is safe.
+class SharedFileCache {
+public:
+  llvm::Optional<llvm::ErrorOr<llvm::vfs::Status>> getStatus(StringRef Path) {
+    std::lock_guard<std::mutex> Guard(Mutex);
+    auto Entry = StatCache.find(Path);
+    if (Entry == StatCache.end())
+      return llvm::None;
+    return Entry->second;
+  }
+
+  void addStatus(StringRef Path, llvm::ErrorOr<llvm::vfs::Status> S) {
+    std::lock_guard<std::mutex> Guard(Mutex);
+    StatCache.try_emplace(Path, std::move(S));
+  }
+
+  std::shared_ptr<llvm::MemoryBuffer> getBuffer(StringRef Path) {
+    std::lock_guard<std::mutex> Guard(Mutex);
+    auto Entry = BufferCache.find(Path);
+    if (Entry == BufferCache.end())
+      return nullptr;
+    return Entry->second;
+  }
+
+  std::shared_ptr<llvm::MemoryBuffer>
+  addBuffer(StringRef Path, std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+    std::lock_guard<std::mutex> Guard(Mutex);
+    auto Entry = BufferCache.try_emplace(Path, std::move(Buffer));
+    return Entry.first->second;
+  }
+
+private:
+  std::mutex Mutex;
+  /// Both hits and misses are cached; the misses of the header search are
+  /// the most frequent stat results of a compilation.
+  llvm::StringMap<llvm::ErrorOr<llvm::vfs::Status>> StatCache;
+  llvm::StringMap<std::shared_ptr<llvm::MemoryBuffer>> BufferCache;
+};
+
+/// Returns a non-owning view of a cached buffer. The cache keeps the buffer
+/// alive for the whole executor run.
+static std::unique_ptr<llvm::MemoryBuffer>
+createBufferView(const llvm::MemoryBuffer &Buffer) {
+  return llvm::MemoryBuffer::getMemBuffer(Buffer.getBuffer(),
+                                          Buffer.getBufferIdentifier());
+}
+
+/// A vfs::File that populates and serves the shared cache for content reads
+/// that go through File::getBuffer instead of FileSystem::getBufferForFile
+/// (the FileManager uses both, depending on whether it kept the file open).
+class CachingFile : public llvm::vfs::File {
+public:
+  CachingFile(std::unique_ptr<llvm::vfs::File> Underlying, StringRef Path,
+              std::shared_ptr<SharedFileCache> Cache)
+      : Underlying(std::move(Underlying)), Path(Path),
+        Cache(std::move(Cache)) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status() override {
+    return Underlying->status();
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    if (IsVolatile)
+      return Underlying->getBuffer(Name, FileSize, RequiresNullTerminator,
+                                   IsVolatile);
+    if (std::shared_ptr<llvm::MemoryBuffer> Cached = Cache->getBuffer(Path))
+      return createBufferView(*Cached);
+    auto Buffer = Underlying->getBuffer(Name, FileSize,
+                                        /*RequiresNullTerminator=*/true,
+                                        IsVolatile);
+    if (!Buffer)
+      return Buffer;
+    return createBufferView(*Cache->addBuffer(Path, std::move(*Buffer)));
+  }
+
+  std::error_code close() override { return Underlying->close(); }
+
+private:
+  std::unique_ptr<llvm::vfs::File> Underlying;
+  std::string Path;
+  std::shared_ptr<SharedFileCache> Cache;
+};
+
+/// Overlays a worker thread's file system with the shared cache. Only
+/// absolute paths are cached: the meaning of a relative path depends on the
+/// working directory, which is per thread.
+class CachingFileSystem : public llvm::vfs::ProxyFileSystem {
+public:
+  CachingFileSystem(IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS,
+                    std::shared_ptr<SharedFileCache> Cache)
+      : ProxyFileSystem(std::move(FS)), Cache(std::move(Cache)) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const Twine &Path) override {
+    SmallString<256> PathStr;
+    Path.toVector(PathStr);
+    if (!llvm::sys::path::is_absolute(PathStr))
+      return ProxyFileSystem::status(Path);
+    if (auto Cached = Cache->getStatus(PathStr))
+      return *Cached;
+    llvm::ErrorOr<llvm::vfs::Status> S = ProxyFileSystem::status(Path);
+    Cache->addStatus(PathStr, S);
+    return S;
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    SmallString<256> PathStr;
+    Path.toVector(PathStr);
+    auto F = ProxyFileSystem::openFileForRead(Path);
+    if (!F || !llvm::sys::path::is_absolute(PathStr))
+      return F;
+    return std::unique_ptr<llvm::vfs::File>(
+        new CachingFile(std::move(*F), PathStr, Cache));
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBufferForFile(const Twine &Name, int64_t FileSize,
+                   bool RequiresNullTerminator, bool IsVolatile) override {
+    SmallString<256> PathStr;
+    Name.toVector(PathStr);
+    if (IsVolatile || !llvm::sys::path::is_absolute(PathStr))
+      return ProxyFileSystem::getBufferForFile(Name, FileSize,
+                                               RequiresNullTerminator,
+                                               IsVolatile);
+    if (std::shared_ptr<llvm::MemoryBuffer> Cached = Cache->getBuffer(PathStr))
+      return createBufferView(*Cached);
+    auto Buffer = ProxyFileSystem::getBufferForFile(
+        Name, FileSize, /*RequiresNullTerminator=*/true, IsVolatile);
+    if (!Buffer)
+      return Buffer;
+    return createBufferView(*Cache->addBuffer(PathStr, std::move(*Buffer)));
+  }
+
+private:
+  std::shared_ptr<SharedFileCache> Cache;
+};
+
 class ThreadSafeToolResults : public ToolResults {
 public:
   void addResult(StringRef Key, StringRef Value) override {
@@ -59,6 +209,12 @@ llvm::cl::opt<std::string>
                           "This flag only applies to all-TUs."),
            llvm::cl::init(".*"));
 
+llvm::cl::opt<bool> DisableSharedFileCache(
+    "disable-shared-file-cache",
+    llvm::cl::desc("Do not share the stat and file content cache between "
+                   "the worker threads. This flag only applies to all-TUs."),
+    llvm::cl::init(false));
+
 AllTUsToolExecutor::AllTUsToolExecutor(
     const CompilationDatabase &Compilations, unsigned ThreadCount,
     std::shared_ptr<PCHContainerOperations> PCHContainerOps)
@@ -102,6 +258,16 @@ llvm::Error AllTUsToolExecutor::execute(
     if (RegexFilter.match(File))
       Files.push_back(File);
   }
+  // Process files of the same directory back to back: they tend to include
+  // the same headers, so the concurrently running workers mostly read cache
+  // entries that another worker populated moments ago and that are still hot
+  // in the last-level cache. The order within a directory is kept as the
+  // compilation database lists it.
+  std::stable_sort(Files.begin(), Files.end(),
+                   [](const std::string &LHS, const std::string &RHS) {
+                     return llvm::sys::path::parent_path(LHS) <
+                            llvm::sys::path::parent_path(RHS);
+                   });
   // Add a counter to track the progress.
   const std::string TotalNumStr = std::to_string(Files.size());
   unsigned Counter = 0;
@@ -112,6 +278,12 @@ llvm::Error AllTUsToolExecutor::execute(
 
   auto &Action = Actions.front();
 
+  // The worker threads largely process the same headers; share one stat and
+  // file content cache between them. The cache must outlive the thread pool.
+  std::shared_ptr<SharedFileCache> FileCache;
+  if (!DisableSharedFileCache)
+    FileCache = std::make_shared<SharedFileCache>();
+
   {
     llvm::ThreadPool Pool(ThreadCount == 0 ? llvm::hardware_concurrency()
                                            : ThreadCount);
@@ -124,6 +296,8 @@ llvm::Error AllTUsToolExecutor::execute(
             // concurrent working directories.
             IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS =
                 llvm::vfs::createPhysicalFileSystem().release();
+            if (FileCache)
+              FS = new CachingFileSystem(std::move(FS), FileCache);
             ClangTool Tool(Compilations, {Path},
                            std::make_shared<PCHContainerOperations>(), FS);
             Tool.appendArgumentsAdjuster(Action.second);
@@ -11,23 +11,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/Core/Replacement.h"
-#include "clang/Basic/Diagnostic.h"
-#include "clang/Basic/DiagnosticIDs.h"
-#include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/FileManager.h"
-#include "clang/Basic/FileSystemOptions.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Lex/Lexer.h"
-#include "clang/Rewrite/Core/RewriteBuffer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
-#include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
-#include "llvm/Support/MemoryBuffer.h"
-#include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -576,33 +568,39 @@ bool applyAllReplacements(const Replacements &Replaces, Rewriter &Rewrite) {
   return Result;
 }
 
+llvm::Error applyAllReplacements(StringRef Code, const Replacements &Replaces,
+                                 llvm::raw_ostream &OS) {
+  // The replacements are sorted by offset and non-overlapping, so the output
+  // is an interleaving of untouched spans of the original buffer and the
+  // replacement texts; neither needs to be copied into intermediate strings.
+  unsigned LastEnd = 0;
+  for (const Replacement &R : Replaces) {
+    if (R.getOffset() > Code.size() ||
+        R.getLength() > Code.size() - R.getOffset())
+      return llvm::make_error<ReplacementError>(
+          replacement_error::fail_to_apply,
+          Replacement("<stdin>", R.getOffset(), R.getLength(),
+                      R.getReplacementText()));
+    assert(R.getOffset() >= LastEnd &&
+           "Replacements must be sorted and non-overlapping");
+    OS << Code.substr(LastEnd, R.getOffset() - LastEnd)
+       << R.getReplacementText();
+    LastEnd = R.getOffset() + R.getLength();
+  }
+  OS << Code.substr(LastEnd);
+  return llvm::Error::success();
+}
+
 llvm::Expected<std::string> applyAllReplacements(StringRef Code,
                                                 const Replacements &Replaces) {
   if (Replaces.empty())
     return Code.str();
 
-  IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> InMemoryFileSystem(
-      new llvm::vfs::InMemoryFileSystem);
-  FileManager Files(FileSystemOptions(), InMemoryFileSystem);
-  DiagnosticsEngine Diagnostics(
-      IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs),
-      new DiagnosticOptions);
-  SourceManager SourceMgr(Diagnostics, Files);
-  Rewriter Rewrite(SourceMgr, LangOptions());
-  InMemoryFileSystem->addFile(
-      "<stdin>", 0, llvm::MemoryBuffer::getMemBuffer(Code, "<stdin>"));
-  FileID ID = SourceMgr.createFileID(Files.getFile("<stdin>"), SourceLocation(),
-                                     clang::SrcMgr::C_User);
-  for (auto I = Replaces.rbegin(), E = Replaces.rend(); I != E; ++I) {
-    Replacement Replace("<stdin>", I->getOffset(), I->getLength(),
-                        I->getReplacementText());
-    if (!Replace.apply(Rewrite))
-      return llvm::make_error<ReplacementError>(
-          replacement_error::fail_to_apply, Replace);
-  }
   std::string Result;
+  Result.reserve(Code.size());
   llvm::raw_string_ostream OS(Result);
-  Rewrite.getEditBuffer(ID).write(OS);
+  if (llvm::Error Err = applyAllReplacements(Code, Replaces, OS))
+    return std::move(Err);
   OS.flush();
   return Result;
 }
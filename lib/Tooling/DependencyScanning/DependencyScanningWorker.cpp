@@ -11,6 +11,7 @@
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Frontend/Utils.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
 #include "clang/Tooling/Tooling.h"
 
 using namespace clang;
@@ -115,12 +116,18 @@ private:
 
 } // end anonymous namespace
 
-DependencyScanningWorker::DependencyScanningWorker() {
+DependencyScanningWorker::DependencyScanningWorker(
+    DependencyScanningFilesystemSharedCache *SharedCache) {
   DiagOpts = new DiagnosticOptions();
   PCHContainerOps = std::make_shared<PCHContainerOperations>();
-  /// FIXME: Use the shared file system from the service for fast scanning
-  /// mode.
-  WorkerFS = new ProxyFileSystemWithoutChdir(llvm::vfs::getRealFileSystem());
+  llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS =
+      llvm::vfs::getRealFileSystem();
+  // In the fast scanning mode, serve the sources minimized down to the
+  // preprocessor directives from the cache shared by all the workers, so
+  // every file is read and minimized only once for the whole tool run.
+  if (SharedCache)
+    FS = new DependencyScanningWorkerFilesystem(*SharedCache, std::move(FS));
+  WorkerFS = new ProxyFileSystemWithoutChdir(std::move(FS));
 }
 
 llvm::Expected<std::string>
@@ -158,6 +158,143 @@ std::vector<std::string> unescapeCommandLine(JSONCommandLineSyntax Syntax,
   return parser.parse();
 }
 
+/// A scanner for the strict JSON subset that compilation database generators
+/// emit. It slices the top level array into the byte ranges of its entries
+/// without building a parse tree; only the string values the index needs are
+/// unescaped. Every scanning method returns false on input outside of the
+/// subset, leaving the caller to fall back to the full parser.
+class RawEntryScanner {
+public:
+  RawEntryScanner(StringRef Buffer)
+      : Position(Buffer.begin()), End(Buffer.end()) {}
+
+  /// Consumes C and any whitespace before it. Consumes nothing if the next
+  /// token is not C.
+  bool consume(char C) {
+    skipWhitespace();
+    if (Position == End || *Position != C)
+      return false;
+    ++Position;
+    return true;
+  }
+
+  /// Returns whether only whitespace remains.
+  bool atEnd() {
+    skipWhitespace();
+    return Position == End;
+  }
+
+  /// Scans one object of the array into Slice and unescapes its 'file' and
+  /// 'directory' values. Fails on any entry parseEntryNode() could reject,
+  /// so that the fall back to the full parse reports the error.
+  bool scanEntry(StringRef &Slice, SmallVectorImpl<char> &FileName,
+                 SmallVectorImpl<char> &Directory) {
+    skipWhitespace();
+    const char *Begin = Position;
+    if (!consume('{'))
+      return false;
+    bool SeenCommand = false;
+    bool SeenFile = false;
+    bool SeenDirectory = false;
+    do {
+      SmallString<10> Key;
+      if (!scanString(&Key) || !consume(':'))
+        return false;
+      if (Key == "file") {
+        // Duplicate keys keep the last value, as in parseEntryNode().
+        FileName.clear();
+        if (!scanString(&FileName))
+          return false;
+        SeenFile = true;
+      } else if (Key == "directory") {
+        Directory.clear();
+        if (!scanString(&Directory))
+          return false;
+        SeenDirectory = true;
+      } else if (Key == "command") {
+        if (!scanString())
+          return false;
+        SeenCommand = true;
+      } else if (Key == "arguments") {
+        if (!scanStringArray())
+          return false;
+        SeenCommand = true;
+      } else if (Key == "output") {
+        if (!scanString())
+          return false;
+      } else {
+        // An unknown key is an error in the full parser as well; it has to
+        // produce the diagnostic.
+        return false;
+      }
+    } while (consume(','));
+    if (!consume('}'))
+      return false;
+    if (!SeenFile || !SeenDirectory || !SeenCommand)
+      return false;
+    Slice = StringRef(Begin, Position - Begin);
+    return true;
+  }
+
+private:
+  void skipWhitespace() {
+    while (Position != End && (*Position == ' ' || *Position == '\t' ||
+                               *Position == '\n' || *Position == '\r'))
+      ++Position;
+  }
+
+  /// Scans a string literal, unescaping it into Value if one is given.
+  bool scanString(SmallVectorImpl<char> *Value = nullptr) {
+    if (!consume('"'))
+      return false;
+    while (Position != End && *Position != '"') {
+      char C = *Position++;
+      // A raw line break would be folded by the YAML parser; leave such
+      // strings to it.
+      if (C == '\n' || C == '\r')
+        return false;
+      if (C == '\\') {
+        if (Position == End)
+          return false;
+        switch (*Position++) {
+        case '"': C = '"'; break;
+        case '\\': C = '\\'; break;
+        case '/': C = '/'; break;
+        case 'b': C = '\b'; break;
+        case 'f': C = '\f'; break;
+        case 'n': C = '\n'; break;
+        case 'r': C = '\r'; break;
+        case 't': C = '\t'; break;
+        default:
+          // Unicode escapes are not worth decoding here.
+          return false;
+        }
+      }
+      if (Value)
+        Value->push_back(C);
+    }
+    if (Position == End)
+      return false;
+    ++Position;
+    return true;
+  }
+
+  bool scanStringArray() {
+    if (!consume('['))
+      return false;
+    if (consume(']'))
+      return true;
+    do {
+      if (!scanString())
+        return false;
+    } while (consume(','));
+    return consume(']');
+  }
+
+  const char *Position;
+  const char *End;
+};
+
 // This plugin locates a nearby compile_command.json file, and also infers
 // compile commands for files not present in the database.
 class JSONCompilationDatabasePlugin : public CompilationDatabasePlugin {
@@ -205,7 +342,11 @@ JSONCompilationDatabase::loadFromFile(StringRef FilePath,
   }
   std::unique_ptr<JSONCompilationDatabase> Database(
       new JSONCompilationDatabase(std::move(*DatabaseBuffer), Syntax));
-  if (!Database->parse(ErrorMessage))
+  // Index the database without parsing it; entries are only parsed when a
+  // caller requests them. Anything the raw scan does not understand —
+  // including entries the parser would reject — goes through the full
+  // parse, which also produces the exact error message.
+  if (!Database->scanLazily() && !Database->parse(ErrorMessage))
     return nullptr;
   return Database;
 }
@@ -233,10 +374,16 @@ JSONCompilationDatabase::getCompileCommands(StringRef FilePath) const {
   StringRef Match = MatchTrie.findEquivalent(NativeFilePath, ES);
   if (Match.empty())
     return {};
+  std::vector<CompileCommand> Commands;
+  if (IsLazilyIndexed) {
+    const auto SlicesI = SliceIndexByFile.find(Match);
+    if (SlicesI != SliceIndexByFile.end())
+      getCommandsFromSlices(SlicesI->getValue(), Commands);
+    return Commands;
+  }
   const auto CommandsRefI = IndexByFile.find(Match);
   if (CommandsRefI == IndexByFile.end())
     return {};
-  std::vector<CompileCommand> Commands;
   getCommands(CommandsRefI->getValue(), Commands);
   return Commands;
 }
@@ -244,6 +391,11 @@ JSONCompilationDatabase::getCompileCommands(StringRef FilePath) const {
 std::vector<std::string>
 JSONCompilationDatabase::getAllFiles() const {
   std::vector<std::string> Result;
+  if (IsLazilyIndexed) {
+    for (const auto &Slices : SliceIndexByFile)
+      Result.push_back(Slices.first().str());
+    return Result;
+  }
   for (const auto &CommandRef : IndexByFile)
     Result.push_back(CommandRef.first().str());
   return Result;
@@ -252,6 +404,10 @@ JSONCompilationDatabase::getAllFiles() const {
 std::vector<CompileCommand>
 JSONCompilationDatabase::getAllCompileCommands() const {
   std::vector<CompileCommand> Commands;
+  if (IsLazilyIndexed) {
+    getCommandsFromSlices(AllSlices, Commands);
+    return Commands;
+  }
   getCommands(AllCommands, Commands);
   return Commands;
 }
@@ -326,6 +482,70 @@ void JSONCompilationDatabase::getCommands(
   }
 }
 
+void JSONCompilationDatabase::getCommandsFromSlices(
+    ArrayRef<StringRef> Slices, std::vector<CompileCommand> &Commands) const {
+  for (StringRef Slice : Slices) {
+    // The nodes of a CompileCommandRef point into the stream, so the
+    // commands have to be built before it goes out of scope.
+    llvm::SourceMgr SliceSM;
+    llvm::yaml::Stream SliceStream(Slice, SliceSM);
+    llvm::yaml::document_iterator I = SliceStream.begin();
+    if (I == SliceStream.end())
+      continue;
+    llvm::yaml::Node *Root = I->getRoot();
+    if (!Root)
+      continue;
+    CompileCommandRef Ref;
+    SmallString<128> NativeFilePath;
+    std::string ErrorMessage;
+    // The raw scan only admits entries the parser accepts, so this cannot
+    // fail; guard regardless rather than crash on a scanner bug.
+    if (!parseEntryNode(*Root, Ref, NativeFilePath, ErrorMessage))
+      continue;
+    getCommands(Ref, Commands);
+  }
+}
+
+bool JSONCompilationDatabase::scanLazily() {
+  RawEntryScanner Scanner(Database->getBuffer());
+  if (!Scanner.consume('['))
+    return false;
+  llvm::StringMap<std::vector<StringRef>> Index;
+  std::vector<StringRef> Slices;
+  if (!Scanner.consume(']')) {
+    do {
+      StringRef Slice;
+      SmallString<32> FileName;
+      SmallString<8> Directory;
+      if (!Scanner.scanEntry(Slice, FileName, Directory))
+        return false;
+      SmallString<128> NativeFilePath;
+      if (llvm::sys::path::is_relative(FileName)) {
+        SmallString<128> AbsolutePath(Directory);
+        llvm::sys::path::append(AbsolutePath, FileName);
+        llvm::sys::path::remove_dots(AbsolutePath, /*remove_dot_dot=*/ true);
+        llvm::sys::path::native(AbsolutePath, NativeFilePath);
+      } else {
+        llvm::sys::path::native(FileName, NativeFilePath);
+      }
+      Index[NativeFilePath].push_back(Slice);
+      Slices.push_back(Slice);
+    } while (Scanner.consume(','));
+    if (!Scanner.consume(']'))
+      return false;
+  }
+  if (!Scanner.atEnd())
+    return false;
+  // Commit the index only once the whole database has been validated; a
+  // partial one must not leak into the fall back parse.
+  for (const auto &Entry : Index)
+    MatchTrie.insert(Entry.first());
+  SliceIndexByFile = std::move(Index);
+  AllSlices = std::move(Slices);
+  IsLazilyIndexed = true;
+  return true;
+}
+
 bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
   llvm::yaml::document_iterator I = YAMLStream.begin();
   if (I == YAMLStream.end()) {
@@ -343,91 +563,101 @@ bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
     return false;
   }
   for (auto &NextObject : *Array) {
-    auto *Object = dyn_cast<llvm::yaml::MappingNode>(&NextObject);
-    if (!Object) {
-      ErrorMessage = "Expected object.";
+    CompileCommandRef Cmd;
+    SmallString<128> NativeFilePath;
+    if (!parseEntryNode(NextObject, Cmd, NativeFilePath, ErrorMessage))
       return false;
-    }
-    llvm::yaml::ScalarNode *Directory = nullptr;
-    llvm::Optional<std::vector<llvm::yaml::ScalarNode *>> Command;
-    llvm::yaml::ScalarNode *File = nullptr;
-    llvm::yaml::ScalarNode *Output = nullptr;
-    for (auto& NextKeyValue : *Object) {
-      auto *KeyString = dyn_cast<llvm::yaml::ScalarNode>(NextKeyValue.getKey());
-      if (!KeyString) {
-        ErrorMessage = "Expected strings as key.";
-        return false;
-      }
-      SmallString<10> KeyStorage;
-      StringRef KeyValue = KeyString->getValue(KeyStorage);
-      llvm::yaml::Node *Value = NextKeyValue.getValue();
-      if (!Value) {
-        ErrorMessage = "Expected value.";
-        return false;
-      }
-      auto *ValueString = dyn_cast<llvm::yaml::ScalarNode>(Value);
-      auto *SequenceString = dyn_cast<llvm::yaml::SequenceNode>(Value);
-      if (KeyValue == "arguments" && !SequenceString) {
-        ErrorMessage = "Expected sequence as value.";
-        return false;
-      } else if (KeyValue != "arguments" && !ValueString) {
-        ErrorMessage = "Expected string as value.";
-        return false;
-      }
-      if (KeyValue == "directory") {
-        Directory = ValueString;
-      } else if (KeyValue == "arguments") {
-        Command = std::vector<llvm::yaml::ScalarNode *>();
-        for (auto &Argument : *SequenceString) {
-          auto *Scalar = dyn_cast<llvm::yaml::ScalarNode>(&Argument);
-          if (!Scalar) {
-            ErrorMessage = "Only strings are allowed in 'arguments'.";
-            return false;
-          }
-          Command->push_back(Scalar);
-        }
-      } else if (KeyValue == "command") {
-        if (!Command)
-          Command = std::vector<llvm::yaml::ScalarNode *>(1, ValueString);
-      } else if (KeyValue == "file") {
-        File = ValueString;
-      } else if (KeyValue == "output") {
-        Output = ValueString;
-      } else {
-        ErrorMessage = ("Unknown key: \"" +
-                        KeyString->getRawValue() + "\"").str();
-        return false;
-      }
-    }
-    if (!File) {
-      ErrorMessage = "Missing key: \"file\".";
+    IndexByFile[NativeFilePath].push_back(Cmd);
+    AllCommands.push_back(Cmd);
+    MatchTrie.insert(NativeFilePath);
+  }
+  return true;
+}
+
+bool JSONCompilationDatabase::parseEntryNode(llvm::yaml::Node &NextObject,
+                                             CompileCommandRef &Ref,
+                                             SmallVectorImpl<char> &NativePath,
+                                             std::string &ErrorMessage) {
+  auto *Object = dyn_cast<llvm::yaml::MappingNode>(&NextObject);
+  if (!Object) {
+    ErrorMessage = "Expected object.";
+    return false;
+  }
+  llvm::yaml::ScalarNode *Directory = nullptr;
+  llvm::Optional<std::vector<llvm::yaml::ScalarNode *>> Command;
+  llvm::yaml::ScalarNode *File = nullptr;
+  llvm::yaml::ScalarNode *Output = nullptr;
+  for (auto& NextKeyValue : *Object) {
+    auto *KeyString = dyn_cast<llvm::yaml::ScalarNode>(NextKeyValue.getKey());
+    if (!KeyString) {
+      ErrorMessage = "Expected strings as key.";
       return false;
     }
-    if (!Command) {
-      ErrorMessage = "Missing key: \"command\" or \"arguments\".";
+    SmallString<10> KeyStorage;
+    StringRef KeyValue = KeyString->getValue(KeyStorage);
+    llvm::yaml::Node *Value = NextKeyValue.getValue();
+    if (!Value) {
+      ErrorMessage = "Expected value.";
       return false;
     }
-    if (!Directory) {
-      ErrorMessage = "Missing key: \"directory\".";
+    auto *ValueString = dyn_cast<llvm::yaml::ScalarNode>(Value);
+    auto *SequenceString = dyn_cast<llvm::yaml::SequenceNode>(Value);
+    if (KeyValue == "arguments" && !SequenceString) {
+      ErrorMessage = "Expected sequence as value.";
+      return false;
+    } else if (KeyValue != "arguments" && !ValueString) {
+      ErrorMessage = "Expected string as value.";
       return false;
     }
-    SmallString<8> FileStorage;
-    StringRef FileName = File->getValue(FileStorage);
-    SmallString<128> NativeFilePath;
-    if (llvm::sys::path::is_relative(FileName)) {
-      SmallString<8> DirectoryStorage;
-      SmallString<128> AbsolutePath(
-          Directory->getValue(DirectoryStorage));
-      llvm::sys::path::append(AbsolutePath, FileName);
-      llvm::sys::path::remove_dots(AbsolutePath, /*remove_dot_dot=*/ true);
-      llvm::sys::path::native(AbsolutePath, NativeFilePath);
+    if (KeyValue == "directory") {
+      Directory = ValueString;
+    } else if (KeyValue == "arguments") {
+      Command = std::vector<llvm::yaml::ScalarNode *>();
+      for (auto &Argument : *SequenceString) {
+        auto *Scalar = dyn_cast<llvm::yaml::ScalarNode>(&Argument);
+        if (!Scalar) {
+          ErrorMessage = "Only strings are allowed in 'arguments'.";
+          return false;
+        }
+        Command->push_back(Scalar);
+      }
+    } else if (KeyValue == "command") {
+      if (!Command)
+        Command = std::vector<llvm::yaml::ScalarNode *>(1, ValueString);
+    } else if (KeyValue == "file") {
+      File = ValueString;
+    } else if (KeyValue == "output") {
+      Output = ValueString;
     } else {
-      llvm::sys::path::native(FileName, NativeFilePath);
+      ErrorMessage = ("Unknown key: \"" +
+                      KeyString->getRawValue() + "\"").str();
+      return false;
     }
-    auto Cmd = CompileCommandRef(Directory, File, *Command, Output);
-    IndexByFile[NativeFilePath].push_back(Cmd);
-    AllCommands.push_back(Cmd);
-    MatchTrie.insert(NativeFilePath);
   }
+  if (!File) {
+    ErrorMessage = "Missing key: \"file\".";
+    return false;
+  }
+  if (!Command) {
+    ErrorMessage = "Missing key: \"command\" or \"arguments\".";
+    return false;
+  }
+  if (!Directory) {
+    ErrorMessage = "Missing key: \"directory\".";
+    return false;
+  }
+  SmallString<8> FileStorage;
+  StringRef FileName = File->getValue(FileStorage);
+  if (llvm::sys::path::is_relative(FileName)) {
+    SmallString<8> DirectoryStorage;
+    SmallString<128> AbsolutePath(
+        Directory->getValue(DirectoryStorage));
+    llvm::sys::path::append(AbsolutePath, FileName);
+    llvm::sys::path::remove_dots(AbsolutePath, /*remove_dot_dot=*/ true);
+    llvm::sys::path::native(AbsolutePath, NativePath);
+  } else {
+    llvm::sys::path::native(FileName, NativePath);
+  }
+  Ref = CompileCommandRef(Directory, File, *Command, Output);
   return true;
 }
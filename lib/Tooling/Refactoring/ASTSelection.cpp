@@ -9,6 +9,7 @@
 #include "clang/Tooling/Refactoring/ASTSelection.h"
 #include "clang/AST/LexicallyOrderedRecursiveASTVisitor.h"
 #include "clang/Lex/Lexer.h"
+#include "clang/Tooling/Refactoring/DeclExtentIndex.h"
 #include "llvm/Support/SaveAndRestore.h"
 
 using namespace clang;
@@ -192,8 +193,21 @@ clang::tooling::findSelectedASTNodes(const ASTContext &Context,
              TargetFile &&
          "selection range must span one file");
 
+  // Only the top-level declarations whose extents intersect the selection can
+  // contribute to the selection tree; let the extent index pick the
+  // candidates instead of walking every top-level declaration.
+  const SourceManager &SM = Context.getSourceManager();
+  DeclExtentIndex Index(Context);
+  SmallVector<Decl *, 8> Candidates;
+  Index.declsIntersecting(TargetFile,
+                          SM.getFileOffset(SelectionRange.getBegin()),
+                          SM.getFileOffset(SelectionRange.getEnd()),
+                          Candidates);
+
   ASTSelectionFinder Visitor(SelectionRange, TargetFile, Context);
-  Visitor.TraverseDecl(Context.getTranslationUnitDecl());
+  for (Decl *D : Candidates)
+    if (!Visitor.TraverseDecl(D))
+      break;
   return Visitor.getSelectedASTNode();
 }
 
@@ -0,0 +1,108 @@
+//===--- DeclExtentIndex.cpp - Clang refactoring library ------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/Refactoring/DeclExtentIndex.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclObjC.h"
+#include "clang/Lex/Lexer.h"
+#include <algorithm>
+#include <climits>
+
+using namespace clang;
+using namespace tooling;
+
+const DeclExtentIndex::FileIndex &
+DeclExtentIndex::getFileIndex(FileID File) const {
+  auto Cached = FileIndices.find(File);
+  if (Cached != FileIndices.end())
+    return Cached->second;
+
+  const SourceManager &SM = Context.getSourceManager();
+  FileIndex &Index = FileIndices[File];
+  for (Decl *D : Context.getTranslationUnitDecl()->decls()) {
+    if (D->isImplicit())
+      continue;
+
+    // Mirror the file classification of the selection finder: a declaration
+    // that begins inside a macro but ends in a file is classified by its end
+    // location.
+    const SourceRange DeclRange = D->getSourceRange();
+    SourceLocation FileLoc;
+    if (DeclRange.getBegin().isMacroID() && !DeclRange.getEnd().isMacroID())
+      FileLoc = DeclRange.getEnd();
+    else
+      FileLoc = SM.getSpellingLoc(DeclRange.getBegin());
+    if (FileLoc.isInvalid() || SM.getFileID(FileLoc) != File)
+      continue;
+
+    Extent E;
+    E.Begin = SM.getFileOffset(FileLoc);
+    E.D = D;
+
+    // Declarations whose lexical end cannot be pinned down in this file stay
+    // candidates for every query. Objective-C implementations lexically end
+    // past their source range (after the 'end' keyword), so they are kept
+    // unbounded rather than measured here.
+    SourceLocation EndLoc = DeclRange.getEnd();
+    if (EndLoc.isMacroID())
+      EndLoc = SM.getExpansionRange(EndLoc).getEnd();
+    if (EndLoc.isInvalid() || EndLoc.isMacroID() ||
+        SM.getFileID(EndLoc) != File || isa<ObjCImplDecl>(D))
+      E.End = UINT_MAX;
+    else
+      // Extend over the final token so queries inside it still match.
+      E.End = SM.getFileOffset(EndLoc) +
+              Lexer::MeasureTokenLength(EndLoc, SM, Context.getLangOpts());
+
+    Index.Extents.push_back(E);
+  }
+
+  std::stable_sort(Index.Extents.begin(), Index.Extents.end(),
+                   [](const Extent &LHS, const Extent &RHS) {
+                     return LHS.Begin < RHS.Begin;
+                   });
+
+  unsigned MaxEnd = 0;
+  for (Extent &E : Index.Extents) {
+    MaxEnd = std::max(MaxEnd, E.End);
+    E.MaxEnd = MaxEnd;
+  }
+  return Index;
+}
+
+void DeclExtentIndex::declsIntersecting(FileID File, unsigned BeginOffset,
+                                        unsigned EndOffset,
+                                        SmallVectorImpl<Decl *> &Result) const {
+  const FileIndex &Index = getFileIndex(File);
+
+  // The first extent whose running maximum end reaches the queried range;
+  // everything before it ends too early to intersect.
+  auto First = std::partition_point(
+      Index.Extents.begin(), Index.Extents.end(),
+      [BeginOffset](const Extent &E) { return E.MaxEnd < BeginOffset; });
+
+  for (auto I = First, E = Index.Extents.end();
+       I != E && I->Begin <= EndOffset; ++I)
+    if (I->End >= BeginOffset)
+      Result.push_back(I->D);
+}
+
+void DeclExtentIndex::declsContainingLoc(
+    SourceLocation Loc, SmallVectorImpl<Decl *> &Result) const {
+  const SourceManager &SM = Context.getSourceManager();
+  Loc = SM.getSpellingLoc(Loc);
+  while (Loc.isValid()) {
+    std::pair<FileID, unsigned> Decomposed = SM.getDecomposedLoc(Loc);
+    declsIntersecting(Decomposed.first, Decomposed.second, Decomposed.second,
+                      Result);
+    // A declaration can also span the include site of the queried file, e.g.
+    // a namespace whose body includes the header the location lies in;
+    // continue the query at that include site.
+    Loc = SM.getIncludeLoc(Decomposed.first);
+  }
+}
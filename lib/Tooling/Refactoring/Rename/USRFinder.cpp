@@ -17,6 +17,7 @@
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Index/USRGeneration.h"
 #include "clang/Lex/Lexer.h"
+#include "clang/Tooling/Refactoring/DeclExtentIndex.h"
 #include "clang/Tooling/Refactoring/RecursiveSymbolVisitor.h"
 #include "llvm/ADT/SmallVector.h"
 
@@ -75,20 +76,17 @@ private:
 
 const NamedDecl *getNamedDeclAt(const ASTContext &Context,
                                 const SourceLocation Point) {
-  const SourceManager &SM = Context.getSourceManager();
   NamedDeclOccurrenceFindingVisitor Visitor(Point, Context);
 
-  // Try to be clever about pruning down the number of top-level declarations we
-  // see. If both start and end is either before or after the point we're
-  // looking for the point cannot be inside of this decl. Don't even look at it.
-  for (auto *CurrDecl : Context.getTranslationUnitDecl()->decls()) {
-    SourceLocation StartLoc = CurrDecl->getBeginLoc();
-    SourceLocation EndLoc = CurrDecl->getEndLoc();
-    if (StartLoc.isValid() && EndLoc.isValid() &&
-        SM.isBeforeInTranslationUnit(StartLoc, Point) !=
-            SM.isBeforeInTranslationUnit(EndLoc, Point))
-      Visitor.TraverseDecl(CurrDecl);
-  }
+  // The point can only lie inside the top-level declarations whose extents
+  // contain it; let the extent index pick the candidates instead of checking
+  // every top-level declaration against the point.
+  DeclExtentIndex Index(Context);
+  SmallVector<Decl *, 8> Candidates;
+  Index.declsContainingLoc(Point, Candidates);
+  for (Decl *CurrDecl : Candidates)
+    if (!Visitor.TraverseDecl(CurrDecl))
+      break;
 
   return Visitor.getNamedDecl();
 }
@@ -35,6 +35,7 @@
 #include "clang/Tooling/ArgumentsAdjusters.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
@@ -126,6 +127,93 @@ CompilerInvocation *newInvocation(
   return Invocation;
 }
 
+InvocationTemplateCache::InvocationTemplateCache() = default;
+
+InvocationTemplateCache::~InvocationTemplateCache() = default;
+
+CompilerInvocation *InvocationTemplateCache::newInvocation(
+    DiagnosticsEngine *Diagnostics, const llvm::opt::ArgStringList &CC1Args) {
+  assert(!CC1Args.empty() && "Must at least contain the program name!");
+
+  // Classify the arguments so the per-file values — the inputs, -o and
+  // -main-file-name — can be blanked out of the cache key and later patched
+  // into the copies handed out below. A malformed argument vector falls back
+  // to the uncached path, which reports it properly.
+  unsigned MissingArgIndex, MissingArgCount;
+  std::unique_ptr<llvm::opt::OptTable> Opts = driver::createDriverOptTable();
+  llvm::opt::InputArgList ParsedArgs =
+      Opts->ParseArgs(makeArrayRef(CC1Args).slice(1), MissingArgIndex,
+                      MissingArgCount, driver::options::CC1Option);
+  if (MissingArgCount)
+    return tooling::newInvocation(Diagnostics, CC1Args);
+
+  // The replacement of each blanked argument string, by index into CC1Args.
+  llvm::DenseMap<unsigned, std::string> Blanked;
+  std::vector<StringRef> Inputs;
+  StringRef Output, MainFileName;
+  bool HasOutput = false, HasMainFileName = false;
+  // Blank the value of a JoinedOrSeparate option, whichever form it took.
+  auto BlankValue = [&Blanked, &CC1Args](unsigned Index, StringRef Flag,
+                                         const char *Placeholder) {
+    if (Flag == CC1Args[Index + 1])
+      Blanked[Index + 2] = Placeholder;
+    else
+      Blanked[Index + 1] = Placeholder;
+  };
+  for (const llvm::opt::Arg *A : ParsedArgs) {
+    switch (A->getOption().getID()) {
+    case driver::options::OPT_INPUT:
+      Inputs.push_back(A->getValue());
+      // The extension stays in the key: without -x it decides the language.
+      Blanked[A->getIndex() + 1] =
+          ("<input>" + llvm::sys::path::extension(A->getValue())).str();
+      break;
+    case driver::options::OPT_o:
+      Output = A->getValue();
+      HasOutput = true;
+      BlankValue(A->getIndex(), "-o", "<output>");
+      break;
+    case driver::options::OPT_main_file_name:
+      MainFileName = A->getValue();
+      HasMainFileName = true;
+      BlankValue(A->getIndex(), "-main-file-name", "<main-file-name>");
+      break;
+    default:
+      break;
+    }
+  }
+
+  std::string Key;
+  for (unsigned I = 1, E = CC1Args.size(); I != E; ++I) {
+    auto Replacement = Blanked.find(I);
+    StringRef Piece = Replacement == Blanked.end()
+                          ? StringRef(CC1Args[I])
+                          : StringRef(Replacement->second);
+    Key.append(Piece.begin(), Piece.end());
+    Key += '\0';
+  }
+
+  std::unique_ptr<CompilerInvocation> &Template = Templates[Key];
+  if (!Template)
+    Template.reset(tooling::newInvocation(Diagnostics, CC1Args));
+
+  // Hand out a copy of the template with this file's values patched in; the
+  // template itself stays pristine for the next file of the same shape.
+  auto *Invocation = new CompilerInvocation(*Template);
+  FrontendOptions &FEOpts = Invocation->getFrontendOpts();
+  assert(Inputs.size() == FEOpts.Inputs.size() &&
+         "same shape must mean the same number of inputs");
+  for (unsigned I = 0, E = std::min(Inputs.size(), FEOpts.Inputs.size());
+       I != E; ++I)
+    FEOpts.Inputs[I] = FrontendInputFile(Inputs[I], FEOpts.Inputs[I].getKind(),
+                                         FEOpts.Inputs[I].isSystem());
+  if (HasOutput)
+    FEOpts.OutputFile = Output;
+  if (HasMainFileName)
+    Invocation->getCodeGenOpts().MainFileName = MainFileName;
+  return Invocation;
+}
+
 bool runToolOnCode(FrontendAction *ToolAction, const Twine &Code,
                    const Twine &FileName,
                    std::shared_ptr<PCHContainerOperations> PCHContainerOps) {
@@ -317,7 +405,8 @@ bool ToolInvocation::run() {
   if (!CC1Args)
     return false;
   std::unique_ptr<CompilerInvocation> Invocation(
-      newInvocation(&Diagnostics, *CC1Args));
+      TemplateCache ? TemplateCache->newInvocation(&Diagnostics, *CC1Args)
+                    : newInvocation(&Diagnostics, *CC1Args));
   // FIXME: remove this when all users have migrated!
   for (const auto &It : MappedFileContents) {
     // Inject the code as the given file name into the preprocessor options.
@@ -514,6 +603,7 @@ int ClangTool::run(ToolAction *Action) {
       ToolInvocation Invocation(std::move(CommandLine), Action, Files.get(),
                                 PCHContainerOps);
       Invocation.setDiagnosticConsumer(DiagConsumer);
+      Invocation.setInvocationTemplateCache(&TemplateCache);
 
       if (!Invocation.run()) {
         // FIXME: Diagnostics should be used instead.
@@ -0,0 +1,14 @@
+// RUN: %clang_cc1 -triple x86_64-pc-linux -ast-dump=json-lines %s | FileCheck %s
+
+int x;
+
+void f(void) {}
+
+// Each top-level declaration is emitted as a single compact JSON object on
+// its own line.
+// CHECK: {"id":
+// CHECK-SAME: "kind":"VarDecl"
+// CHECK-SAME: "name":"x"
+// CHECK-NEXT: {"id":
+// CHECK-SAME: "kind":"FunctionDecl"
+// CHECK-SAME: "name":"f"
@@ -0,0 +1 @@
+static inline int shared_helper(int x) { return x + 1; }
@@ -0,0 +1,21 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_analyze_cc1 -analyzer-display-progress \
+// RUN:   -analyzer-config analysis-dedup-dir=%t %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=FIRST %s
+// RUN: %clang_analyze_cc1 -analyzer-display-progress \
+// RUN:   -analyzer-config analysis-dedup-dir=%t %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=SECOND %s
+
+// The first process claims the header-defined function in the shared
+// coverage store; a later process including the same header skips its path
+// sensitive analysis. Functions of the main file are never deduplicated.
+
+#include "Inputs/analysis-dedup.h"
+
+void use(void) { (void)shared_helper(1); }
+
+// FIRST-DAG: ANALYZE (Path,{{.*}} shared_helper(int)
+// FIRST-DAG: ANALYZE (Path,{{.*}} use()
+
+// SECOND-NOT: ANALYZE (Path,{{.*}} shared_helper(int)
+// SECOND: ANALYZE (Path,{{.*}} use()
@@ -0,0 +1,25 @@
+// With a reference map that mentions nothing, internal-linkage entry points
+// are dead code and are skipped, while externally visible ones are kept by
+// default (their callers may live outside the build).
+// RUN: echo '# nothing is referenced' > %t.map
+// RUN: %clang_analyze_cc1 -analyzer-display-progress \
+// RUN:   -analyzer-config analysis-reference-map=%t.map %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=EXTERNAL %s
+
+// With keep-external disabled, the map alone decides; an empty map leaves
+// nothing to analyze.
+// RUN: %clang_analyze_cc1 -analyzer-display-progress \
+// RUN:   -analyzer-config analysis-reference-map=%t.map \
+// RUN:   -analyzer-config analysis-reference-map-keep-external=false %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CLOSED %s
+
+void f() {}
+static void g() {}
+void h() {}
+
+// EXTERNAL-NOT: ANALYZE {{.*}} g()
+// EXTERNAL-DAG: ANALYZE {{.*}} f()
+// EXTERNAL-DAG: ANALYZE {{.*}} h()
+// EXTERNAL-NOT: ANALYZE {{.*}} g()
+
+// CLOSED-NOT: ANALYZE
@@ -0,0 +1,19 @@
+// RUN: %clang_analyze_cc1 -analyzer-display-progress \
+// RUN:   -analyzer-config analysis-shard-count=2 \
+// RUN:   -analyzer-config analysis-shard-index=0 %s > %t 2>&1
+// RUN: %clang_analyze_cc1 -analyzer-display-progress \
+// RUN:   -analyzer-config analysis-shard-count=2 \
+// RUN:   -analyzer-config analysis-shard-index=1 %s >> %t 2>&1
+// RUN: FileCheck --input-file=%t %s
+
+// The two shards together must cover every entry point of the translation
+// unit. Which function falls into which shard is an implementation detail,
+// so only the union of the two analyses is checked here.
+
+void f() {}
+void g() {}
+void h() {}
+
+// CHECK-DAG: analysis-shard-count.cpp f()
+// CHECK-DAG: analysis-shard-count.cpp g()
+// CHECK-DAG: analysis-shard-count.cpp h()
@@ -0,0 +1,25 @@
+// RUN: echo '0-2 %s' > %t.manifest
+// RUN: %clang_analyze_cc1 -analyzer-display-progress \
+// RUN:   -analyzer-config analysis-shard-manifest=%t.manifest %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=RANGE %s
+
+// A manifest that does not mention this translation unit assigns none of its
+// entry points to this process.
+// RUN: echo '# nothing for this process' > %t.empty.manifest
+// RUN: %clang_analyze_cc1 -analyzer-display-progress \
+// RUN:   -analyzer-config analysis-shard-manifest=%t.empty.manifest %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=UNLISTED %s
+
+// The numbering of the entry points is deterministic, but which function
+// gets which index is an implementation detail; only the count of analyzed
+// entry points is checked here.
+
+void f() {}
+void g() {}
+void h() {}
+void i() {}
+
+// RANGE-COUNT-2: ANALYZE (Path
+// RANGE-NOT: ANALYZE (Path
+
+// UNLISTED-NOT: ANALYZE (Path
@@ -0,0 +1,22 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -analyze-function="ns::S::m(int *)" -verify %s
+
+// Entry points matching -analyze-function are enumerated from decl-level
+// data without visiting function bodies; check that definitions nested in
+// namespaces and classes are still found and that the other functions are
+// not analyzed.
+
+namespace ns {
+struct S {
+  int m(int *p) {
+    if (!p)
+      return *p; // expected-warning{{Dereference of null pointer}}
+    return 0;
+  }
+};
+} // namespace ns
+
+int notSelected(int *p) {
+  if (!p)
+    return *p; // no-warning
+  return 0;
+}
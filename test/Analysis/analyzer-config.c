@@ -2,6 +2,7 @@
 // RUN: FileCheck --input-file=%t %s --match-full-lines
 
 // CHECK: [config]
+// CHECK-NEXT: adaptive-node-budget = false
 // CHECK-NEXT: add-pop-up-notes = true
 // CHECK-NEXT: aggressive-binary-operation-simplification = false
 // CHECK-NEXT: alpha.clone.CloneChecker:IgnoredFilesPattern = ""
@@ -9,6 +10,12 @@
 // CHECK-NEXT: alpha.clone.CloneChecker:ReportNormalClones = true
 // CHECK-NEXT: alpha.security.MmapWriteExec:MmapProtExec = 0x04
 // CHECK-NEXT: alpha.security.MmapWriteExec:MmapProtRead = 0x01
+// CHECK-NEXT: analysis-dedup-dir = ""
+// CHECK-NEXT: analysis-reference-map = ""
+// CHECK-NEXT: analysis-reference-map-keep-external = true
+// CHECK-NEXT: analysis-shard-count = 0
+// CHECK-NEXT: analysis-shard-index = 0
+// CHECK-NEXT: analysis-shard-manifest = ""
 // CHECK-NEXT: avoid-suppressing-null-argument-paths = false
 // CHECK-NEXT: c++-allocator-inlining = true
 // CHECK-NEXT: c++-container-inlining = false
@@ -26,9 +33,12 @@
 // CHECK-NEXT: cfg-temporary-dtors = true
 // CHECK-NEXT: cplusplus.Move:WarnOn = KnownsAndLocals
 // CHECK-NEXT: crosscheck-with-z3 = false
+// CHECK-NEXT: ctu-ast-cache-size = 0
 // CHECK-NEXT: ctu-dir = ""
 // CHECK-NEXT: ctu-import-threshold = 100
 // CHECK-NEXT: ctu-index-name = externalDefMap.txt
+// CHECK-NEXT: ctu-minimal-import = false
+// CHECK-NEXT: ctu-share-loaded-asts = false
 // CHECK-NEXT: debug.AnalysisOrder:* = false
 // CHECK-NEXT: debug.AnalysisOrder:Bind = false
 // CHECK-NEXT: debug.AnalysisOrder:EndFunction = false
@@ -46,16 +56,22 @@
 // CHECK-NEXT: debug.AnalysisOrder:PreStmtOffsetOfExpr = false
 // CHECK-NEXT: debug.AnalysisOrder:RegionChanges = false
 // CHECK-NEXT: display-ctu-progress = false
+// CHECK-NEXT: dump-ctu-callgraph = ""
 // CHECK-NEXT: eagerly-assume = true
 // CHECK-NEXT: elide-constructors = true
+// CHECK-NEXT: entry-point-trace = ""
 // CHECK-NEXT: expand-macros = false
 // CHECK-NEXT: experimental-enable-naive-ctu-analysis = false
 // CHECK-NEXT: exploration_strategy = unexplored_first_queue
 // CHECK-NEXT: faux-bodies = true
+// CHECK-NEXT: function-profiles = ""
 // CHECK-NEXT: graph-trim-interval = 1000
+// CHECK-NEXT: incremental-analysis-dir = ""
 // CHECK-NEXT: inline-lambdas = true
+// CHECK-NEXT: inline-max-block-visit-rate = 0
 // CHECK-NEXT: ipa = dynamic-bifurcate
 // CHECK-NEXT: ipa-always-inline-size = 3
+// CHECK-NEXT: max-graph-memory = 0
 // CHECK-NEXT: max-inlinable-size = 100
 // CHECK-NEXT: max-nodes = 225000
 // CHECK-NEXT: max-symbol-complexity = 35
@@ -77,18 +93,33 @@
 // CHECK-NEXT: osx.NumberObjectConversion:Pedantic = false
 // CHECK-NEXT: osx.cocoa.RetainCount:CheckOSObject = true
 // CHECK-NEXT: osx.cocoa.RetainCount:TrackNSCFStartParam = false
+// CHECK-NEXT: phase-timers = false
+// CHECK-NEXT: phase-timers-json = ""
+// CHECK-NEXT: prefer-vetoing-checkers = false
+// CHECK-NEXT: profile-checkers = false
+// CHECK-NEXT: progress-events = ""
 // CHECK-NEXT: prune-paths = true
+// CHECK-NEXT: purge-dead-on-block-entrance = false
+// CHECK-NEXT: region-store-binding-cache-size = 1024
 // CHECK-NEXT: region-store-small-struct-limit = 2
+// CHECK-NEXT: report-dedup-dir = ""
 // CHECK-NEXT: report-in-main-source-file = false
+// CHECK-NEXT: report-quota = 0
+// CHECK-NEXT: results-db = ""
+// CHECK-NEXT: seed-call-argument-facts = false
 // CHECK-NEXT: serialize-stats = false
 // CHECK-NEXT: stable-report-filename = false
+// CHECK-NEXT: stream-plist-diagnostics = false
 // CHECK-NEXT: suppress-c++-stdlib = true
 // CHECK-NEXT: suppress-inlined-defensive-checks = true
 // CHECK-NEXT: suppress-null-return-paths = true
 // CHECK-NEXT: track-conditions = false
 // CHECK-NEXT: track-conditions-debug = false
+// CHECK-NEXT: transition-trace = ""
 // CHECK-NEXT: unix.DynamicMemoryModeling:Optimistic = false
 // CHECK-NEXT: unroll-loops = false
+// CHECK-NEXT: use-return-summaries = false
 // CHECK-NEXT: widen-loops = false
+// CHECK-NEXT: widen-loops-only-modified = false
 // CHECK-NEXT: [stats]
-// CHECK-NEXT: num-entries = 88
+// CHECK-NEXT: num-entries = 119
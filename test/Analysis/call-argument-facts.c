@@ -0,0 +1,45 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config ipa=none,seed-call-argument-facts=true \
+// RUN:   -verify %s
+
+void clang_analyzer_eval(int);
+
+int g;
+
+// All callers are visible (internal linkage, address never taken) and agree
+// on the argument facts, so the entry state is seeded with them.
+static void seeded(int *p, int k) {
+  clang_analyzer_eval(p != 0); // expected-warning{{TRUE}}
+  clang_analyzer_eval(k == 42); // expected-warning{{TRUE}}
+}
+
+// Callers disagree on the constant and one passes a possibly-null pointer.
+static void not_seeded(int *p, int k) {
+  clang_analyzer_eval(p != 0); // expected-warning{{UNKNOWN}}
+  clang_analyzer_eval(k == 42); // expected-warning{{UNKNOWN}}
+}
+
+// An externally visible function can be called from other TUs; no facts.
+void external(int *p) {
+  clang_analyzer_eval(p != 0); // expected-warning{{UNKNOWN}}
+}
+
+// Taking the address discards the facts: calls through the pointer are not
+// summarized.
+static void address_taken(int *p) {
+  clang_analyzer_eval(p != 0); // expected-warning{{UNKNOWN}}
+}
+
+void calls(int *q) {
+  seeded(&g, 42);
+  seeded(&g, 40 + 2);
+
+  not_seeded(&g, 42);
+  not_seeded(q, 7);
+
+  external(&g);
+
+  address_taken(&g);
+  void (*fp)(int *) = &address_taken;
+  fp(q);
+}
@@ -0,0 +1,39 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config ipa=none,seed-call-argument-facts=true \
+// RUN:   -verify %s
+
+void clang_analyzer_eval(bool);
+
+int g;
+
+namespace {
+
+struct S {
+  // In a member operator call the object is argument 0; the fact below must
+  // be recorded for the operator's first parameter, not for the object.
+  void operator+=(int *p) {
+    clang_analyzer_eval(p != 0); // expected-warning{{TRUE}}
+  }
+};
+
+// Called once directly with a non-null argument and once through an
+// unresolved callee in a template, whose arguments are never summarized;
+// the name is called unresolved, so neither overload may keep facts.
+void overloaded(int *p) {
+  clang_analyzer_eval(p != 0); // expected-warning{{UNKNOWN}}
+}
+void overloaded(long *p) {
+  clang_analyzer_eval(p != 0); // expected-warning{{UNKNOWN}}
+}
+
+template <typename T> void callThrough(T t) { overloaded(t); }
+
+} // namespace
+
+void calls(int *q) {
+  S s;
+  s += &g;
+
+  overloaded(&g);
+  callThrough(q);
+}
@@ -0,0 +1,28 @@
+// RUN: rm -f %t.cache
+
+// The first invocation parses and validates the configuration and writes the
+// cache file.
+// RUN: %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config eagerly-assume=false \
+// RUN:   -analyzer-config-cache=%t.cache -verify %s
+// RUN: test -f %t.cache
+
+// A second invocation with an identical configuration loads the cache and
+// behaves the same.
+// RUN: %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config eagerly-assume=false \
+// RUN:   -analyzer-config-cache=%t.cache -verify %s
+
+// A different configuration must not pick up the now stale cache: the
+// unknown checker has to be diagnosed as usual.
+// RUN: not %clang_analyze_cc1 -analyzer-checker=core,nonexistent \
+// RUN:   -analyzer-config eagerly-assume=false \
+// RUN:   -analyzer-config-cache=%t.cache %s 2>&1 | FileCheck %s
+
+// CHECK: no analyzer checkers or packages are associated with 'nonexistent'
+
+int test(int x) {
+  if (x)
+    return 0;
+  return 5 / x; // expected-warning {{Division by zero}}
+}
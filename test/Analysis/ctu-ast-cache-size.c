@@ -0,0 +1,26 @@
+// Ensure analyzer option 'ctu-ast-cache-size' is a recognized option.
+//
+// RUN: %clang_cc1 -analyze -analyzer-config ctu-ast-cache-size=4 -verify %s
+//
+// Check that analysis with an AST cache budget produces the same results as
+// the unbounded run in ctu-main.c, with the evicted units re-loaded on demand.
+//
+// RUN: rm -rf %t && mkdir %t
+// RUN: mkdir -p %t/ctudir
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu \
+// RUN:   -emit-pch -o %t/ctudir/ctu-other.c.ast %S/Inputs/ctu-other.c
+// RUN: cp %S/Inputs/ctu-other.c.externalDefMap.txt %t/ctudir/externalDefMap.txt
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -fsyntax-only -analyze \
+// RUN:   -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config experimental-enable-naive-ctu-analysis=true \
+// RUN:   -analyzer-config ctu-dir=%t/ctudir \
+// RUN:   -analyzer-config ctu-ast-cache-size=1 \
+// RUN:   -verify %s
+
+// expected-no-diagnostics
+
+int f(int);
+
+int main() {
+  return f(5);
+}
@@ -0,0 +1,16 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config dump-ctu-callgraph=%t/callgraph.txt %s
+// RUN: FileCheck --input-file=%t/callgraph.txt %s
+
+void leaf(void) {}
+
+void caller(void) {
+  leaf();
+}
+
+// Each line starts with the CTU lookup name of a defined function, followed
+// by the lookup names of its callees. The reverse post order walk lists
+// callers before their callees.
+// CHECK: c:@F@caller c:@F@leaf
+// CHECK: c:@F@leaf
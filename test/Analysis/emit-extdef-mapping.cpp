@@ -0,0 +1,20 @@
+// Check that a normal (non-tooling) frontend run can emit the external
+// definition map of the translation unit as a side output.
+
+// RUN: %clang_cc1 -fsyntax-only -femit-extdef-mapping=%t.map %s
+// RUN: FileCheck --implicit-check-not "@F@g#" --implicit-check-not "c:@z" \
+// RUN:   %s < %t.map
+
+int f(int) {
+  return 0;
+}
+// CHECK-DAG: c:@F@f#I#
+
+extern const int x = 5;
+// CHECK-DAG: c:@x
+
+// Internal linkage definitions are not collected.
+static int g(void) {
+  return 1;
+}
+const int z = 5;
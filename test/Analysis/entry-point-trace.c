@@ -0,0 +1,20 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config entry-point-trace=%t/trace.json %s
+// RUN: FileCheck --input-file=%t/trace.json %s
+
+// Every path sensitive entry point becomes one complete event in the
+// chrome://tracing compatible trace, carrying its cost counters as event
+// arguments. Object keys are serialized in sorted order.
+
+void traced(int x) {
+  if (x)
+    ++x;
+}
+
+// CHECK: {"traceEvents":
+// CHECK-SAME: "args":{"budget-exhausted":false,"cfg-blocks":{{[0-9]+}},"exploded-nodes":{{[0-9]+}}}
+// CHECK-SAME: "dur":{{[0-9]+}}
+// CHECK-SAME: "name":"traced"
+// CHECK-SAME: "ph":"X"
+// CHECK-SAME: "ts":{{[0-9]+}}
@@ -0,0 +1,24 @@
+// RUN: %clang_analyze_cc1 -w -analyzer-checker=core -analyzer-config exploration_strategy=coverage_first_queue -verify %s
+
+extern int coin();
+
+int foo() {
+  int *x = 0;
+  while (coin()) {
+    if (coin())
+      return *x; // expected-warning{{Dereference of null pointer (loaded from variable 'x')}}
+  }
+  return 0;
+}
+
+int baz() {
+  int *x = 0;
+  if (coin()) {
+    if (coin())
+      return 0;
+    else if (coin())
+      return 1;
+    return 2;
+  }
+  return *x; // expected-warning{{Dereference of null pointer (loaded from variable 'x')}}
+}
@@ -0,0 +1,28 @@
+// RUN: echo '# cold code keeps only the cheap analysis' > %t.profiles
+// RUN: echo 'shallow cold' >> %t.profiles
+// RUN: echo 'deep hot' >> %t.profiles
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config function-profiles=%t.profiles -verify %s
+
+void clang_analyzer_eval(int);
+
+// The callee must be large enough not to be inlined under the minimal
+// inlining of the 'shallow' profile (see 'ipa-always-inline-size').
+static int identity(int x) {
+  if (x > 100)
+    return x;
+  if (x < -100)
+    return x;
+  return x;
+}
+
+// The 'shallow' profile analyzes the entry point without inlining, so the
+// call is evaluated conservatively.
+void cold(void) {
+  clang_analyzer_eval(identity(5) == 5); // expected-warning{{UNKNOWN}}
+}
+
+// The 'deep' profile keeps full inlining.
+void hot(void) {
+  clang_analyzer_eval(identity(5) == 5); // expected-warning{{TRUE}}
+}
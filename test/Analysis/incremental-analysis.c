@@ -0,0 +1,31 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_analyze_cc1 -analyzer-display-progress \
+// RUN:   -analyzer-config incremental-analysis-dir=%t %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=FIRST %s
+// RUN: %clang_analyze_cc1 -analyzer-display-progress \
+// RUN:   -analyzer-config incremental-analysis-dir=%t %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=SECOND %s
+
+// The hashes cover the token stream, so a copy that only differs in
+// comments and whitespace must still hit the cache.
+// RUN: echo 'void g() { /* comment */ }'      > %t/src.c
+// RUN: echo 'void f() { g();   /* gap */ }'  >> %t/src.c
+// RUN: %clang_analyze_cc1 -analyzer-display-progress \
+// RUN:   -analyzer-config incremental-analysis-dir=%t %t/src.c 2>&1 \
+// RUN:   | FileCheck --check-prefix=COMMENT %s
+
+// The first run analyzes every function as top level and persists the
+// per-function hashes; the unchanged functions must not be path-analyzed
+// again by the second run (the syntax passes still visit them).
+
+void g() {}
+void f() { g(); }
+
+// FIRST-DAG: ANALYZE (Path,{{.*}} f()
+// FIRST-DAG: ANALYZE (Syntax): {{.*}} f()
+
+// SECOND-NOT: ANALYZE (Path
+// SECOND: ANALYZE (Syntax): {{.*}} f()
+
+// COMMENT-NOT: ANALYZE (Path
+// COMMENT: ANALYZE (Syntax): {{.*}} f()
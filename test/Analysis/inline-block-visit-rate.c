@@ -0,0 +1,22 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config inline-max-block-visit-rate=1 -verify %s
+
+void clang_analyzer_eval(int);
+
+static int identity(int x) {
+  if (x > 0)
+    return x;
+  return x;
+}
+
+// The first call is inlined: no block visits have been recorded for the
+// callee per inlining yet.
+void first_call_is_inlined() {
+  clang_analyzer_eval(identity(1) == 1); // expected-warning{{TRUE}}
+}
+
+// The visits recorded during the first inlining exceed the configured rate,
+// so further calls are evaluated conservatively.
+void further_calls_are_conservative() {
+  clang_analyzer_eval(identity(1) == 1); // expected-warning{{UNKNOWN}}
+}
@@ -0,0 +1,76 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,debug.ExprInspection -analyzer-max-loop 4 -analyzer-config widen-loops=true,widen-loops-only-modified=true -analyzer-config eagerly-assume=false -verify %s
+
+void clang_analyzer_eval(int);
+void clang_analyzer_warnIfReached();
+
+void external_function(int *);
+
+int g_global;
+
+void untouched_bindings_kept() {
+  int x = 1;
+  g_global = 2;
+  for (int i = 0; i < 10; ++i) {}
+  // Neither 'x' nor the global is modified by the loop, so widening must
+  // not invalidate them.
+  clang_analyzer_eval(x == 1);        // expected-warning {{TRUE}}
+  clang_analyzer_eval(g_global == 2); // expected-warning {{TRUE}}
+}
+
+void modified_local_widened() {
+  int n = 0;
+  int t = 1;
+  for (int i = 0; i < 10; ++i) {
+    n += 1;
+  }
+  clang_analyzer_eval(t == 1); // expected-warning {{TRUE}}
+  clang_analyzer_eval(n == 0); // expected-warning {{UNKNOWN}}
+  clang_analyzer_warnIfReached(); // expected-warning {{REACHABLE}}
+}
+
+void modified_global_widened() {
+  g_global = 0;
+  int t = 1;
+  for (int i = 0; i < 10; ++i) {
+    ++g_global;
+  }
+  clang_analyzer_eval(t == 1);        // expected-warning {{TRUE}}
+  clang_analyzer_eval(g_global == 0); // expected-warning {{UNKNOWN}}
+}
+
+void condition_side_effect_widened() {
+  int i = 0;
+  int t = 1;
+  while (i++ < 100) {}
+  clang_analyzer_eval(t == 1); // expected-warning {{TRUE}}
+  clang_analyzer_warnIfReached(); // expected-warning {{REACHABLE}}
+}
+
+void array_element_store_widens_array() {
+  int buf[8] = {0};
+  int t = 1;
+  for (int i = 0; i < 10; ++i)
+    buf[i & 7] = i;
+  clang_analyzer_eval(t == 1);      // expected-warning {{TRUE}}
+  clang_analyzer_eval(buf[0] == 0); // expected-warning {{UNKNOWN}}
+}
+
+void call_falls_back_to_full_invalidation() {
+  int x = 1;
+  int t = 1;
+  for (int i = 0; i < 10; ++i) {
+    external_function(&x);
+  }
+  // The call may modify anything reachable, so everything is widened.
+  clang_analyzer_eval(t == 1); // expected-warning {{UNKNOWN}}
+  clang_analyzer_eval(x == 1); // expected-warning {{UNKNOWN}}
+}
+
+void pointer_store_falls_back_to_full_invalidation(int *p) {
+  int t = 1;
+  for (int i = 0; i < 10; ++i) {
+    *p = i;
+  }
+  // The store target is unknown, so everything is widened.
+  clang_analyzer_eval(t == 1); // expected-warning {{UNKNOWN}}
+}
@@ -0,0 +1,20 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core -analyzer-output=plist \
+// RUN:   -analyzer-config stream-plist-diagnostics=true -o %t.plist \
+// RUN:   -verify %s
+// RUN: FileCheck --input-file=%t.plist %s
+
+// The streamed plist must still be a complete document: the header and the
+// diagnostics are written as the reports are finalized, the file table is
+// appended by the final flush.
+
+void test(int *p) {
+  if (p)
+    return;
+  *p = 1; // expected-warning{{Dereference of null pointer}}
+}
+
+// CHECK: <key>diagnostics</key>
+// CHECK: <string>Dereference of null pointer
+// CHECK: <key>files</key>
+// CHECK: plist-stream.c</string>
+// CHECK: </plist>
@@ -0,0 +1,12 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config profile-checkers=true %s 2>&1 | FileCheck %s
+
+int test(int x) {
+  if (x)
+    return 1 / x;
+  return 0;
+}
+
+// CHECK: Analyzer checker times
+// CHECK: Total
+// CHECK: core.DivideZero
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config progress-events=%t/events.jsonl %s
+// RUN: FileCheck --input-file=%t/events.jsonl %s
+
+// The progress stream carries one JSON object per line: a record for the
+// translation unit, then a begin and an end record for every path sensitive
+// entry point. Object keys are serialized in sorted order.
+
+void traced(int x) {
+  if (x)
+    ++x;
+}
+
+// CHECK: {"event":"translation-unit","file":"{{.*}}progress-events.c","ts-us":{{[0-9]+}}}
+// CHECK-NEXT: {"event":"begin","name":"traced","ts-us":{{[0-9]+}}}
+// CHECK-NEXT: {"budget-exhausted":false,"event":"end","exploded-nodes":{{[0-9]+}},"name":"traced","ts-us":{{[0-9]+}}}
@@ -0,0 +1,39 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,debug.ExprInspection -analyzer-config purge-dead-on-block-entrance=true -verify=purge,common %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,debug.ExprInspection -verify=common %s
+
+void clang_analyzer_eval(int);
+void clang_analyzer_warnOnDeadSymbol(int);
+
+int conjure();
+
+// The loop body is an empty CFG block, so no statement ever runs again after
+// the loop is entered and the statement-anchored purge can never collect 'x'.
+// With the block-entrance purge the symbol dies on the edge into the empty
+// block, anchored at the loop's terminator; without it the symbol survives
+// until the path is abandoned and no death is ever observed.
+void dead_symbol_in_empty_infinite_loop() {
+  int x = conjure();
+  clang_analyzer_warnOnDeadSymbol(x);
+  for (;;) { // purge-warning{{SYMBOL DEAD}}
+  }
+}
+
+// Bindings that are still live across an empty block must survive the
+// entrance purge: the symbol of 'x' is kept alive by 'y' and both variables
+// are read after the loop.
+void live_symbol_survives_empty_block() {
+  int x = conjure();
+  int y = x;
+  while (conjure()) {
+  }
+  clang_analyzer_eval(y == x); // common-warning{{TRUE}}
+}
+
+// Concrete bindings that stay live keep their values through the purge, with
+// or without the flag.
+void live_bindings_keep_their_values() {
+  int kept = 3;
+  while (conjure()) {
+  }
+  clang_analyzer_eval(kept == 3); // common-warning{{TRUE}}
+}
@@ -0,0 +1,20 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config report-dedup-dir=%t %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=FIRST %s
+// RUN: %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config report-dedup-dir=%t %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=SECOND --allow-empty %s
+
+// The first process claims the issue hash in the shared store and emits the
+// report; a later process reaching the same issue drops its copy.
+
+int deref(int *p) {
+  if (p)
+    return 0;
+  return *p; // The issue claimed by the first run.
+}
+
+// FIRST: warning: Dereference of null pointer
+
+// SECOND-NOT: warning:
@@ -0,0 +1,25 @@
+// Without a quota, every division is reported.
+// RUN: %clang_analyze_cc1 -analyzer-checker=core %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=ALL %s
+
+// With a quota of one report per (checker, file), the first report is kept
+// and the rest is dropped, with a summary at the end of the translation
+// unit.
+// RUN: %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config report-quota=1 %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=CAPPED %s
+
+int f1(int x) { return x / 0; }
+int f2(int x) { return x / 0; }
+int f3(int x) { return x / 0; }
+
+// ALL: Division by zero
+// ALL: Division by zero
+// ALL: Division by zero
+// ALL-NOT: suppressed
+
+// CAPPED: Division by zero
+// CAPPED-NOT: Division by zero
+// CAPPED: warning: the analyzer suppressed 2 further reports from checker
+// CAPPED-SAME: 'core.DivideZero' in file '{{.*}}report-quota.c' after its
+// CAPPED-SAME: report quota of 1 was reached
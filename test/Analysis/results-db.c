@@ -0,0 +1,17 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config results-db=%t/db %s
+// RUN: FileCheck --input-file=%t/db/tu-*.json %s
+
+// Every analyzed translation unit writes one JSON record into the results
+// database: total analysis time, per entry point timings and per-checker
+// diagnostic counts. Object keys are serialized in sorted order.
+
+int div(int x) {
+  return 1 / x; // triggers core.DivideZero
+}
+
+// CHECK: "checkers":{"core.DivideZero":{"diagnostics":1}}
+// CHECK-SAME: "entry-points":[{"budget-exhausted":false,"exploded-nodes":{{[0-9]+}},"name":"div","seconds":{{[0-9.e+-]+}}}]
+// CHECK-SAME: "file":"{{.*}}results-db.c"
+// CHECK-SAME: "total-seconds":{{[0-9.e+-]+}}
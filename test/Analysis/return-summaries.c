@@ -0,0 +1,24 @@
+// RUN: %clang_analyze_cc1 -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config use-return-summaries=true \
+// RUN:   -analyzer-config ipa=none -verify %s
+
+// With inlining disabled the precise results below can only come from the
+// recorded return-value summaries.
+
+void clang_analyzer_eval(int);
+
+int fortyTwo() { return 42; }
+int identity(int x) { return x; }
+int withEffect(int x) {
+  ++x;
+  return x;
+}
+
+void test(int n) {
+  clang_analyzer_eval(fortyTwo() == 42);   // expected-warning{{TRUE}}
+  clang_analyzer_eval(identity(n) == n);   // expected-warning{{TRUE}}
+  clang_analyzer_eval(identity(7) == 7);   // expected-warning{{TRUE}}
+  // A body with more than a single return statement has no summary; the
+  // call stays conservatively evaluated.
+  clang_analyzer_eval(withEffect(1) == 2); // expected-warning{{UNKNOWN}}
+}
@@ -0,0 +1,15 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_analyze_cc1 -analyzer-checker=core \
+// RUN:   -analyzer-config transition-trace=%t/trace.bin %s
+// RUN: FileCheck --input-file=%t/trace.bin %s
+
+// The trace is binary, but each segment starts with the magic and carries
+// the entry point name in plain text; decode with analyzer-trace-decode.
+
+void traced(int x) {
+  if (x)
+    ++x;
+}
+
+// CHECK: XGTR
+// CHECK: traced
@@ -0,0 +1,29 @@
+// RUN: rm -rf %t.dir
+// RUN: rm -rf %t.cdb
+// RUN: mkdir -p %t.dir
+// RUN: cp %s %t.dir/regular_cdb.cpp
+// RUN: cp %s %t.dir/regular_cdb2.cpp
+// RUN: mkdir %t.dir/Inputs
+// RUN: cp %S/Inputs/header.h %t.dir/Inputs/header.h
+// RUN: cp %S/Inputs/header2.h %t.dir/Inputs/header2.h
+// RUN: sed -e "s|DIR|%/t.dir|g" %S/Inputs/regular_cdb.json > %t.cdb
+//
+// Query the same file twice; the second response is served with warm caches
+// and must be identical. An unknown file reports an error but keeps the tool
+// alive for further queries.
+//
+// RUN: echo "%/t.dir/regular_cdb.cpp" > %t.queries
+// RUN: echo "%/t.dir/unknown.cpp" >> %t.queries
+// RUN: echo "%/t.dir/regular_cdb.cpp" >> %t.queries
+// RUN: clang-scan-deps -compilation-database %t.cdb -interactive \
+// RUN:   < %t.queries 2>%t.errs | FileCheck %s
+// RUN: FileCheck --check-prefix=ERR %s < %t.errs
+
+#include "header.h"
+
+// CHECK: regular_cdb.cpp
+// CHECK-NEXT: Inputs{{/|\\}}header.h
+// CHECK: regular_cdb.cpp
+// CHECK-NEXT: Inputs{{/|\\}}header.h
+
+// ERR: no compile command for {{.*}}unknown.cpp
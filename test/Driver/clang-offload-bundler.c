@@ -32,6 +32,7 @@
 // CK-HELP: {{.*}}one. The resulting file can also be unbundled into different files by
 // CK-HELP: {{.*}}this tool if -unbundle is provided.
 // CK-HELP: {{.*}}USAGE: clang-offload-bundler [options]
+// CK-HELP: {{.*}}-compress {{.*}}- Compress the device images when bundling with the binary
 // CK-HELP: {{.*}}-inputs=<string>  - [<input file>,...]
 // CK-HELP: {{.*}}-outputs=<string> - [<output file>,...]
 // CK-HELP: {{.*}}-targets=<string> - [<offload kind>-<target triple>,...]
@@ -209,6 +210,18 @@
 // RUN: diff %t.tgt1 %t.res.tgt1
 // RUN: diff %t.tgt2 %t.res.tgt2
 
+//
+// Check compressed binary bundle/unbundle. Compressible device images are
+// bundled with -compress and must come back unchanged when unbundled without
+// any extra option. Incompressible (or tiny) images are stored uncompressed,
+// so the round trip also holds when zlib is not available.
+//
+// RUN: clang-offload-bundler -type=bc -compress -targets=host-powerpc64le-ibm-linux-gnu,openmp-powerpc64le-ibm-linux-gnu,openmp-x86_64-pc-linux-gnu -inputs=%t.bc,%t.i,%t.tgt1 -outputs=%t.bundle3.compressed.bc 2>/dev/null
+// RUN: clang-offload-bundler -type=bc -targets=host-powerpc64le-ibm-linux-gnu,openmp-powerpc64le-ibm-linux-gnu,openmp-x86_64-pc-linux-gnu -outputs=%t.res.bc,%t.res.tgt1,%t.res.tgt2 -inputs=%t.bundle3.compressed.bc -unbundle
+// RUN: diff %t.bc %t.res.bc
+// RUN: diff %t.i %t.res.tgt1
+// RUN: diff %t.tgt1 %t.res.tgt2
+
 // Check if we can unbundle a file with no magic strings.
 // RUN: clang-offload-bundler -type=bc -targets=host-powerpc64le-ibm-linux-gnu,openmp-powerpc64le-ibm-linux-gnu,openmp-x86_64-pc-linux-gnu -outputs=%t.res.bc,%t.res.tgt1,%t.res.tgt2 -inputs=%t.bc -unbundle
 // RUN: diff %t.bc %t.res.bc
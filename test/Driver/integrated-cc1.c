@@ -0,0 +1,11 @@
+// RUN: %clang -### -fintegrated-cc1 -c %s 2>&1 | FileCheck %s --check-prefix=YES
+// RUN: %clang -### -fno-integrated-cc1 -c %s 2>&1 | FileCheck %s --check-prefix=NO
+// RUN: %clang -### -fintegrated-cc1 -fno-integrated-cc1 -c %s 2>&1 \
+// RUN:     | FileCheck %s --check-prefix=NO
+// RUN: %clang -### -fno-integrated-cc1 -fintegrated-cc1 -c %s 2>&1 \
+// RUN:     | FileCheck %s --check-prefix=YES
+// RUN: env CLANG_SPAWN_CC1=1 %clang -### -fintegrated-cc1 -c %s 2>&1 \
+// RUN:     | FileCheck %s --check-prefix=NO
+
+// YES: (in-process)
+// NO-NOT: (in-process)
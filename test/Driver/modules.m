@@ -27,6 +27,13 @@
 // RUN: %clang -fmodules-validate-once-per-build-session -### %s 2>&1 | FileCheck -check-prefix=MODULES_VALIDATE_ONCE_ERR %s
 // MODULES_VALIDATE_ONCE_ERR: option '-fmodules-validate-once-per-build-session' requires '-fbuild-session-timestamp=<seconds since Epoch>' or '-fbuild-session-file=<file>'
 
+// RUN: %clang -fbuild-session-timestamp=123 -fpch-validate-once-per-build-session -### %s 2>&1 | FileCheck -check-prefix=PCH_VALIDATE_ONCE %s
+// PCH_VALIDATE_ONCE: -fbuild-session-timestamp=123
+// PCH_VALIDATE_ONCE: -fpch-validate-once-per-build-session
+
+// RUN: %clang -fpch-validate-once-per-build-session -### %s 2>&1 | FileCheck -check-prefix=PCH_VALIDATE_ONCE_ERR %s
+// PCH_VALIDATE_ONCE_ERR: option '-fpch-validate-once-per-build-session' requires '-fbuild-session-timestamp=<seconds since Epoch>' or '-fbuild-session-file=<file>'
+
 // RUN: %clang -### %s 2>&1 | FileCheck -check-prefix=MODULES_VALIDATE_SYSTEM_HEADERS_DEFAULT %s
 // MODULES_VALIDATE_SYSTEM_HEADERS_DEFAULT-NOT: -fmodules-validate-system-headers
 
@@ -0,0 +1,20 @@
+// Check the persistent clean-file cache: a file that needs no replacements
+// is recorded, an already-recorded file is skipped, and the rewritten
+// content of a file that needed replacements is recorded right away.
+// RUN: rm -rf %t.dir
+// RUN: mkdir %t.dir
+// RUN: printf 'int a;\nint b;\n' > %t.dir/clean.cpp
+// RUN: printf ' int  c;\n' > %t.dir/dirty.cpp
+// RUN: clang-format -style=LLVM -i -cache-file=%t.dir/cache %t.dir/clean.cpp %t.dir/dirty.cpp
+// RUN: FileCheck -strict-whitespace -input-file=%t.dir/dirty.cpp %s --check-prefix=CHECK-FORMATTED
+// RUN: wc -l < %t.dir/cache | FileCheck %s --check-prefix=CHECK-TWO
+//
+// The second run hits the cache for both files and learns nothing new.
+// RUN: clang-format -style=LLVM -i -cache-file=%t.dir/cache %t.dir/clean.cpp %t.dir/dirty.cpp
+// RUN: wc -l < %t.dir/cache | FileCheck %s --check-prefix=CHECK-TWO
+//
+// The cache only makes sense for in-place runs.
+// RUN: not clang-format -style=LLVM -cache-file=%t.dir/cache %t.dir/clean.cpp
+
+// CHECK-FORMATTED: {{^int c;$}}
+// CHECK-TWO: 2
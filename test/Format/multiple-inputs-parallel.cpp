@@ -0,0 +1,10 @@
+// RUN: cp %s %t-1.cpp
+// RUN: cp %s %t-2.cpp
+// RUN: cp %s %t-3.cpp
+// RUN: clang-format -style=LLVM -i -j 2 %t-1.cpp %t-2.cpp %t-3.cpp
+// RUN: FileCheck -strict-whitespace -input-file=%t-1.cpp %s
+// RUN: FileCheck -strict-whitespace -input-file=%t-2.cpp %s
+// RUN: FileCheck -strict-whitespace -input-file=%t-3.cpp %s
+
+// CHECK: {{^int\ \*i;}}
+ int   *  i  ;
@@ -0,0 +1,18 @@
+// RUN: %clang_cc1 -fsyntax-only -ast-memory-profile=%t.json %s
+// RUN: FileCheck %s < %t.json
+
+// CHECK: "total_ast_bytes":
+// CHECK: "side_table_bytes":
+// CHECK: "decls": [
+// CHECK-DAG: {"name": "Function", "count"
+// CHECK-DAG: {"name": "Var", "count"
+// CHECK: "types": [
+// CHECK: "files": [
+// CHECK: ast-memory-profile.c
+
+int g;
+
+int f(int x) {
+  int y = x + 1;
+  return y;
+}
@@ -0,0 +1,29 @@
+// RUN: rm -rf %t.cache
+// RUN: echo '#define VALUE 1' > %t.h
+// RUN: %clang_cc1 -E -include %t.h -preprocessed-output-cache %t.cache %s -o %t.first
+// RUN: %clang_cc1 -E -include %t.h -preprocessed-output-cache %t.cache %s -o %t.second
+// RUN: diff %t.first %t.second
+//
+// The cache holds one entry: the preprocessed output and its manifest.
+// RUN: ls %t.cache | count 2
+//
+// The second run replays the stored bytes: tamper with the stored output and
+// the tampering shows up verbatim in the next run's output.
+// RUN: echo '// replayed-from-cache' > %t.marker
+// RUN: cat %t.marker %t.cache/*.out > %t.tampered
+// RUN: cp %t.tampered %t.cache/*.out
+// RUN: %clang_cc1 -E -include %t.h -preprocessed-output-cache %t.cache %s -o %t.replayed
+// RUN: FileCheck --check-prefix=REPLAYED %s < %t.replayed
+//
+// Changing an included file stops the manifest from matching; the output is
+// regenerated and the stale entry replaced.
+// RUN: echo '#define VALUE 2' > %t.h
+// RUN: %clang_cc1 -E -include %t.h -preprocessed-output-cache %t.cache %s -o %t.regen
+// RUN: FileCheck --check-prefix=REGEN %s < %t.regen
+
+int x = VALUE;
+
+// REPLAYED: replayed-from-cache
+
+// REGEN-NOT: replayed-from-cache
+// REGEN: int x = 2;
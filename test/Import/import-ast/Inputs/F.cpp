@@ -0,0 +1,3 @@
+extern "C" {
+  void f(int arg);
+}
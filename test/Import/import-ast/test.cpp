@@ -0,0 +1,8 @@
+// RUN: %clang_cc1 -x c++ -std=c++11 -emit-pch -o %t.ast %S/Inputs/F.cpp
+// RUN: clang-import-test -dump-ast -import-ast %t.ast -expression %s \
+// RUN:     | FileCheck %s
+// CHECK: FunctionDecl
+// CHECK-SAME: f 'void (int)'
+void expr() {
+  f(2);
+}
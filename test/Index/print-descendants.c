@@ -0,0 +1,16 @@
+// RUN: c-index-test -test-print-descendants %s | FileCheck %s
+
+int g;
+
+int f(int x) {
+  return x + g;
+}
+
+// CHECK:      VarDecl=g [c:@g] Extent=[3:1 - 3:6]
+// CHECK-NEXT: FunctionDecl=f [c:@F@f] Extent=[5:1 - 7:2]
+// CHECK-NEXT: ParmDecl=x [c:print-descendants.c@{{[0-9]+}}@F@f@x] Extent=[5:7 - 5:12]
+// CHECK-NEXT: CompoundStmt= Extent=[5:14 - 7:2]
+// CHECK-NEXT: ReturnStmt= Extent=[6:3 - 6:15]
+// CHECK:      DeclRefExpr=x Extent=[6:10 - 6:11]
+// CHECK:      DeclRefExpr=g Extent=[6:14 - 6:15]
+// CHECK:      Records: {{[0-9]+}} Strings: {{[0-9]+}}B
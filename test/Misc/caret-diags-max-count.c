@@ -0,0 +1,14 @@
+// RUN: %clang_cc1 -fsyntax-only -Wunused-variable -fcaret-diagnostics-max-count 1 %s 2>&1 | FileCheck %s
+
+void foo() {
+  int unused_one;
+  int unused_two;
+}
+
+// The first diagnostic is rendered with its snippet and caret; later ones
+// only show their location line.
+// CHECK:      warning: unused variable 'unused_one'
+// CHECK-NEXT: int unused_one;
+// CHECK-NEXT: ^
+// CHECK:      warning: unused variable 'unused_two'
+// CHECK-NOT:  int unused_two;
@@ -0,0 +1,27 @@
+// Test that -fpch-validate-once-per-build-session skips per-input-file
+// validation when the PCH carries the current build session timestamp.
+
+// RUN: echo 'struct S { char c; int i; }; void foo();' > %t.h
+// RUN: %clang_cc1 -x c++-header -emit-pch -o %t.pch %t.h -fbuild-session-timestamp=1390000000
+// RUN: echo '// stale' >> %t.h
+
+// The header changed, so a plain load rejects the PCH as out of date:
+// RUN: not %clang_cc1 -x c++ -include-pch %t.pch -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-STALE %s
+
+// Within the same build session the input files are not revalidated:
+// RUN: %clang_cc1 -x c++ -include-pch %t.pch -fsyntax-only %s -fbuild-session-timestamp=1390000000 -fpch-validate-once-per-build-session
+
+// A different session revalidates:
+// RUN: not %clang_cc1 -x c++ -include-pch %t.pch -fsyntax-only %s -fbuild-session-timestamp=1390000099 -fpch-validate-once-per-build-session 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-STALE %s
+
+// A PCH built without a session stamp never takes the fast path:
+// RUN: %clang_cc1 -x c++-header -emit-pch -o %t.nostamp.pch %t.h
+// RUN: echo '// stale again' >> %t.h
+// RUN: not %clang_cc1 -x c++ -include-pch %t.nostamp.pch -fsyntax-only %s -fbuild-session-timestamp=1390000000 -fpch-validate-once-per-build-session 2>&1 \
+// RUN:   | FileCheck -check-prefix=CHECK-STALE %s
+
+// CHECK-STALE: has been modified since the precompiled header
+
+void use(S *s) { foo(); }
@@ -0,0 +1,19 @@
+// Test the content-addressed PCH cache of -pch-cache-dir.
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo 'void cached_fn(int);' > %t/h.h
+// RUN: %clang_cc1 -x c-header -emit-pch -pch-cache-dir %t/cache -o %t/first.pch %t/h.h
+// RUN: %clang_cc1 -include-pch %t/first.pch -fsyntax-only %s
+
+// A second build of the same header must be served from the cache: after
+// planting a marker as the cached PCH, the marker shows up as the output.
+// RUN: echo REUSED > %t/marker
+// RUN: cp %t/marker %t/cache/*.pch
+// RUN: %clang_cc1 -x c-header -emit-pch -pch-cache-dir %t/cache -o %t/second.pch %t/h.h
+// RUN: diff %t/marker %t/second.pch
+
+// A changed header must miss the cache and rebuild a real PCH.
+// RUN: echo 'void cached_fn2(int);' >> %t/h.h
+// RUN: %clang_cc1 -x c-header -emit-pch -pch-cache-dir %t/cache -o %t/third.pch %t/h.h
+// RUN: not diff %t/marker %t/third.pch
+
+void use(void) { cached_fn(0); }
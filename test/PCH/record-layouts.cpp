@@ -0,0 +1,62 @@
+// Record layouts computed while building a PCH are stored in it and served
+// back when the PCH is used, so the layouts must come out the same either way.
+
+// Test this without pch.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -include %s -emit-llvm-only \
+// RUN:            -fdump-record-layouts %s 2>/dev/null | FileCheck %s
+
+// Test with pch.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-pch -o %t %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -include-pch %t -emit-llvm-only \
+// RUN:            -fdump-record-layouts %s 2>/dev/null | FileCheck %s
+
+#ifndef HEADER
+#define HEADER
+
+struct Padded {
+  char c;
+  int i;
+  char tail;
+};
+
+struct Base {
+  int b;
+};
+
+struct Derived : Padded, Base {
+  char d;
+};
+
+struct Virt : virtual Base {
+  char v;
+};
+
+// Force the layouts to be computed, and therefore stored in the PCH.
+typedef char PaddedSize[sizeof(Padded)];
+typedef char DerivedSize[sizeof(Derived)];
+typedef char VirtSize[sizeof(Virt)];
+
+#else
+
+// CHECK:           0 | struct Padded
+// CHECK-NEXT:      0 |   char c
+// CHECK-NEXT:      4 |   int i
+// CHECK-NEXT:      8 |   char tail
+// CHECK:             | [sizeof=12, {{.*}}align=4
+
+// CHECK:           0 | struct Derived
+// CHECK-NEXT:      0 |   struct Padded (base)
+// CHECK:          12 |   struct Base (base)
+// CHECK:          16 |   char d
+// CHECK:             | [sizeof=20, {{.*}}align=4
+
+// CHECK:           0 | struct Virt
+// CHECK:           8 |   char v
+// CHECK:          12 |   struct Base (vbase)
+// CHECK:             | [sizeof=16,
+
+int psize = sizeof(Padded);
+int dsize = sizeof(Derived);
+int vsize = sizeof(Virt);
+
+#endif
@@ -10,6 +10,9 @@
 // Verify successfully
 // RUN: %clang_cc1 -isystem %t/usr/include -verify-pch %t.pch
 
+// Full verification deserializes every declaration
+// RUN: %clang_cc1 -isystem %t/usr/include -verify-pch -verify-pch-full %t.pch
+
 // Incompatible lang options ignored
 // RUN: %clang_cc1 -isystem %t/usr/include -x objective-c -fno-builtin -verify-pch %t.pch
 
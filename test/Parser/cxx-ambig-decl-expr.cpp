@@ -17,3 +17,16 @@ auto (*q)() -> int(*)(unknown); // expected-error {{unknown type name 'unknown'}
 auto (*r)() -> int(*)(unknown + 1); // expected-error {{undeclared identifier 'unknown'}}
 
 int f(unknown const x); // expected-error {{unknown type name 'unknown'}}
+
+void tentatively_declared_ids() {
+  // 'x' is tentatively declared by the first init-declarator, so within the
+  // same disambiguation '(x)' must resolve as the initializer of 'y' rather
+  // than as a parameter list; verdicts memoized before the declarator-id was
+  // seen must not be replayed.
+  int(x), y(x);
+  y = x;
+
+  // The committed declarations stay visible after the ambiguous statement.
+  int(q), r(q);
+  r = q;
+}
@@ -0,0 +1,30 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+
+// Qualified lookup that walks using-directives is memoized in Sema. These
+// tests guard the memo's invalidation: a lookup must observe declarations
+// added to the graph after an earlier lookup of the same qualified name.
+
+namespace M {}
+namespace N { using namespace M; }
+
+int early = N::f(); // expected-error {{no member named 'f' in namespace 'N'}}
+
+namespace M { int f(); }
+
+int late = N::f();
+
+// Repeated lookups inside one body replay the memoized walk; a negative
+// result must be replayed as the same diagnostic.
+namespace Outer { using namespace M; }
+void repeated() {
+  int a = Outer::f();
+  int b = Outer::f();
+  Outer::missing(); // expected-error {{no member named 'missing' in namespace 'Outer'}}
+  Outer::missing(); // expected-error {{no member named 'missing' in namespace 'Outer'}}
+}
+
+// A new using-directive extends the graph and must also invalidate.
+namespace Extra { int g(); }
+int before = N::g(); // expected-error {{no member named 'g' in namespace 'N'}}
+namespace N { using namespace Extra; }
+int after = N::g();
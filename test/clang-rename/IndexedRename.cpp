@@ -0,0 +1,11 @@
+class Foo {         // CHECK: class Bar {
+};
+
+int main() {
+  Foo *Pointer = 0; // CHECK: Bar *Pointer = 0;
+  return 0;
+}
+
+// Test 1: build the index, then rename through it.
+// RUN: clang-rename -build-index -index=%t.idx %s --
+// RUN: clang-rename -index=%t.idx -qualified-name=Foo -new-name=Bar %s -- | sed 's,//.*,,' | FileCheck %s
@@ -0,0 +1,205 @@
+//===- AnalyzerTraceDecode.cpp - Decode analyzer transition traces --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Offline decoder for the binary traces written by the static analyzer under
+// -analyzer-config transition-trace=<file>; the format is described in
+// lib/StaticAnalyzer/Core/ExplodedGraphTrace.cpp. For every trace segment
+// (one per analyzed entry point) the decoder prints how many transitions were
+// recorded and aggregates them by statement location and checker tag, so the
+// program points responsible for an exponential blowup stand out at the top
+// of the listing. With --dump-records every transition is printed.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<std::string> InputFilename(cl::Positional, cl::Required,
+                                          cl::desc("<trace file>"));
+
+static cl::opt<bool> DumpRecords("dump-records",
+                                 cl::desc("Print every recorded transition"),
+                                 cl::init(false));
+
+static cl::opt<unsigned>
+    TopN("top", cl::desc("Number of hot program points to list per segment"),
+         cl::init(20));
+
+namespace {
+
+struct Record {
+  uint64_t PredID;
+  uint64_t SuccID;
+  uint32_t StmtLoc;
+  uint8_t PointKind;
+  uint8_t Flags;
+  uint16_t TagID;
+};
+
+// Names for ExplodedGraphTrace::StateChangeFlags.
+std::string flagString(uint8_t Flags) {
+  std::string S;
+  if (Flags & 0x1)
+    S += "env,";
+  if (Flags & 0x2)
+    S += "store,";
+  if (Flags & 0x4)
+    S += "gdm,";
+  if (Flags & 0x8)
+    S += "sink,";
+  if (!S.empty())
+    S.pop_back();
+  return S;
+}
+
+class Reader {
+public:
+  Reader(StringRef Data) : Data(Data) {}
+
+  bool atEnd() const { return Data.empty(); }
+
+  bool read(void *Buf, size_t Size) {
+    if (Data.size() < Size)
+      return false;
+    memcpy(Buf, Data.data(), Size);
+    Data = Data.drop_front(Size);
+    return true;
+  }
+
+  bool readU32(uint32_t &V) {
+    char Buf[4];
+    if (!read(Buf, sizeof(Buf)))
+      return false;
+    V = support::endian::read32le(Buf);
+    return true;
+  }
+
+  bool readU64(uint64_t &V) {
+    char Buf[8];
+    if (!read(Buf, sizeof(Buf)))
+      return false;
+    V = support::endian::read64le(Buf);
+    return true;
+  }
+
+  bool readString(std::string &S) {
+    uint32_t Length;
+    if (!readU32(Length) || Data.size() < Length)
+      return false;
+    S.assign(Data.data(), Length);
+    Data = Data.drop_front(Length);
+    return true;
+  }
+
+private:
+  StringRef Data;
+};
+
+} // anonymous namespace
+
+static bool decodeSegment(Reader &R, unsigned Index) {
+  char Magic[4];
+  uint32_t Version;
+  if (!R.read(Magic, sizeof(Magic)) || StringRef(Magic, 4) != "XGTR" ||
+      !R.readU32(Version) || Version != 1)
+    return false;
+
+  std::string EntryPoint;
+  uint64_t NumRecorded;
+  uint32_t NumStored, NumTags;
+  if (!R.readString(EntryPoint) || !R.readU64(NumRecorded) ||
+      !R.readU32(NumStored) || !R.readU32(NumTags))
+    return false;
+
+  std::vector<std::string> Tags(NumTags);
+  for (std::string &Tag : Tags)
+    if (!R.readString(Tag))
+      return false;
+
+  outs() << "=== segment " << Index << ": " << EntryPoint << "\n";
+  outs() << "    transitions: " << NumRecorded;
+  if (NumRecorded > NumStored)
+    outs() << " (ring kept the last " << NumStored << ")";
+  outs() << "\n";
+
+  // Aggregate by (statement location, tag); the pair pins a blowup to both
+  // the source position and the checker producing the transitions.
+  DenseMap<uint64_t, uint64_t> Hot;
+  for (uint32_t I = 0; I != NumStored; ++I) {
+    Record Rec;
+    char Small[2];
+    if (!R.readU64(Rec.PredID) || !R.readU64(Rec.SuccID) ||
+        !R.readU32(Rec.StmtLoc) || !R.read(Small, 2))
+      return false;
+    Rec.PointKind = uint8_t(Small[0]);
+    Rec.Flags = uint8_t(Small[1]);
+    char TagBuf[2];
+    if (!R.read(TagBuf, 2))
+      return false;
+    Rec.TagID = support::endian::read16le(TagBuf);
+    if (Rec.TagID >= NumTags)
+      return false;
+
+    ++Hot[(uint64_t(Rec.StmtLoc) << 16) | Rec.TagID];
+
+    if (DumpRecords)
+      outs() << "    " << Rec.PredID << " -> " << Rec.SuccID
+             << " kind=" << unsigned(Rec.PointKind) << " loc=" << Rec.StmtLoc
+             << " tag='" << Tags[Rec.TagID] << "' [" << flagString(Rec.Flags)
+             << "]\n";
+  }
+
+  std::vector<std::pair<uint64_t, uint64_t>> Sorted(Hot.begin(), Hot.end());
+  llvm::sort(Sorted, [](const std::pair<uint64_t, uint64_t> &L,
+                        const std::pair<uint64_t, uint64_t> &R) {
+    return L.second > R.second;
+  });
+  if (Sorted.size() > TopN)
+    Sorted.resize(TopN);
+
+  outs() << "    hot program points (transitions, raw loc, tag):\n";
+  for (const auto &Entry : Sorted)
+    outs() << "    " << Entry.second << "  loc=" << (Entry.first >> 16)
+           << "  '" << Tags[Entry.first & 0xffff] << "'\n";
+  return true;
+}
+
+int main(int argc, const char **argv) {
+  cl::ParseCommandLineOptions(
+      argc, argv, "Decoder for static analyzer transition traces\n");
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+      MemoryBuffer::getFile(InputFilename);
+  if (!BufferOrErr) {
+    errs() << "error: cannot open '" << InputFilename
+           << "': " << BufferOrErr.getError().message() << "\n";
+    return 1;
+  }
+
+  Reader R((*BufferOrErr)->getBuffer());
+  unsigned Index = 0;
+  while (!R.atEnd()) {
+    if (!decodeSegment(R, Index++)) {
+      errs() << "error: malformed trace segment " << Index - 1 << " in '"
+             << InputFilename << "'\n";
+      return 1;
+    }
+  }
+  if (Index == 0)
+    errs() << "warning: '" << InputFilename << "' contains no segments\n";
+  return 0;
+}
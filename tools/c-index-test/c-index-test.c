@@ -1437,6 +1437,33 @@ void PrintInclusionStack(CXTranslationUnit TU) {
   clang_getInclusions(TU, InclusionVisitor, NULL);
 }
 
+/******************************************************************************/
+/* Batched traversal testing.                                                 */
+/******************************************************************************/
+
+void PrintDescendantsBatch(CXTranslationUnit TU) {
+  CXCursorDescendants batch = clang_getCursorDescendants(
+      clang_getTranslationUnitCursor(TU), /*wantUSRs=*/1);
+  unsigned i, d;
+
+  for (i = 0; i < batch.numRecords; ++i) {
+    const CXDescendantRecord *R = &batch.records[i];
+    CXString KindStr = clang_getCursorKindSpelling(R->Kind);
+
+    for (d = 0; d <= R->Depth; ++d)
+      printf("  ");
+    printf("%s=%s", clang_getCString(KindStr),
+           batch.strings + R->SpellingOffset);
+    if (R->USROffset)
+      printf(" [%s]", batch.strings + R->USROffset);
+    PrintRange(R->Extent, "Extent");
+    printf("\n");
+    clang_disposeString(KindStr);
+  }
+  printf("Records: %u Strings: %uB\n", batch.numRecords, batch.stringsSize);
+  clang_disposeCursorDescendants(batch);
+}
+
 /******************************************************************************/
 /* Linkage testing.                                                           */
 /******************************************************************************/
@@ -4764,6 +4791,7 @@ static void print_usage(void) {
     "       c-index-test -test-inclusion-stack-source {<args>}*\n"
     "       c-index-test -test-inclusion-stack-tu <AST file>\n");
   fprintf(stderr,
+    "       c-index-test -test-print-descendants {<args>}*\n"
     "       c-index-test -test-print-linkage-source {<args>}*\n"
     "       c-index-test -test-print-visibility {<args>}*\n"
     "       c-index-test -test-print-type {<args>}*\n"
@@ -4860,6 +4888,9 @@ int cindextest_main(int argc, const char **argv) {
   else if (argc > 2 && strcmp(argv[1], "-test-inclusion-stack-tu") == 0)
     return perform_test_load_tu(argv[2], "all", NULL, NULL,
                                 PrintInclusionStack);
+  else if (argc > 2 && strcmp(argv[1], "-test-print-descendants") == 0)
+    return perform_test_load_source(argc - 2, argv + 2, "all", NULL,
+                                    PrintDescendantsBatch);
   else if (argc > 2 && strcmp(argv[1], "-test-print-linkage-source") == 0)
     return perform_test_load_source(argc - 2, argv + 2, "all", PrintLinkage,
                                     NULL);
@@ -13,14 +13,21 @@
 
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/CrossTU/CrossTranslationUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/AllTUsExecution.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+#include <mutex>
 #include <sstream>
 #include <string>
 
@@ -31,81 +38,133 @@ using namespace clang::tooling;
 
 static cl::OptionCategory ClangExtDefMapGenCategory("clang-extdefmapgen options");
 
-class MapExtDefNamesConsumer : public ASTConsumer {
+static cl::opt<std::string> BinaryIndexPath(
+    "emit-binary-index",
+    cl::desc("Emit the collected index in the binary format to the given file "
+             "instead of printing the text format to the standard output. The "
+             "entries of all processed source files are merged into a single "
+             "sorted index, which can be consumed directly as the "
+             "'ctu-index-name' of the analyzer without parsing."),
+    cl::value_desc("filename"), cl::cat(ClangExtDefMapGenCategory));
+
+static cl::opt<std::string> ConvertIndexPath(
+    "convert-text-index",
+    cl::desc("Convert the given text format index file to the binary format "
+             "instead of parsing any sources. Existing AST collections that "
+             "already have a merged text index get the mmap-friendly format "
+             "without reprocessing their translation units. The output path "
+             "is taken from -emit-binary-index."),
+    cl::value_desc("filename"), cl::cat(ClangExtDefMapGenCategory));
+
+static cl::opt<std::string> ReferenceMapPath(
+    "emit-reference-map",
+    cl::desc("Also emit a reference map to the given file: the sorted USRs "
+             "of every function referenced from the processed source files, "
+             "one per line. The static analyzer's analysis-reference-map "
+             "config option uses it to skip analyzing dead entry points. "
+             "Collecting references requires parsing function bodies, so "
+             "this disables the body-skipping fast path."),
+    cl::value_desc("filename"), cl::cat(ClangExtDefMapGenCategory));
+
+static cl::opt<unsigned> ExecutorConcurrency(
+    "j",
+    cl::desc("Number of worker threads used to process the translation units "
+             "in parallel. 0 means hardware concurrency."),
+    cl::init(0), cl::cat(ClangExtDefMapGenCategory));
+
+/// The index merged from all processed translation units. The consumers run
+/// concurrently, so the merge is guarded by MergedIndexMutex.
+static llvm::StringMap<std::string> MergedIndex;
+/// The USRs of the functions referenced from any processed translation unit;
+/// only filled when -emit-reference-map is given. Guarded by MergedIndexMutex
+/// as well.
+static llvm::StringSet<> MergedReferences;
+static std::mutex MergedIndexMutex;
+
+/// Collects the USR of every function referenced from the bodies and
+/// initializers of a translation unit. Template instantiations and implicit
+/// code are visited, so a reference buried in instantiated or compiler-
+/// generated code still marks its target as used.
+class ReferenceCollector : public RecursiveASTVisitor<ReferenceCollector> {
 public:
-  MapExtDefNamesConsumer(ASTContext &Context)
-      : Ctx(Context), SM(Context.getSourceManager()) {}
+  ReferenceCollector(llvm::StringSet<> &References) : References(References) {}
 
-  ~MapExtDefNamesConsumer() {
-    // Flush results to standard output.
-    llvm::outs() << createCrossTUIndexString(Index);
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+  bool VisitDeclRefExpr(DeclRefExpr *DRE) {
+    addReference(dyn_cast<FunctionDecl>(DRE->getDecl()));
+    return true;
   }
 
-  void HandleTranslationUnit(ASTContext &Context) override {
-    handleDecl(Context.getTranslationUnitDecl());
+  bool VisitMemberExpr(MemberExpr *ME) {
+    addReference(dyn_cast<FunctionDecl>(ME->getMemberDecl()));
+    return true;
   }
 
-private:
-  void handleDecl(const Decl *D);
-  void addIfInMain(const DeclaratorDecl *DD, SourceLocation defStart);
+  bool VisitCXXConstructExpr(CXXConstructExpr *CE) {
+    addReference(CE->getConstructor());
+    return true;
+  }
 
-  ASTContext &Ctx;
-  SourceManager &SM;
-  llvm::StringMap<std::string> Index;
-  std::string CurrentFileName;
-};
+  bool VisitObjCMessageExpr(ObjCMessageExpr *ME) {
+    addReference(ME->getMethodDecl());
+    return true;
+  }
 
-void MapExtDefNamesConsumer::handleDecl(const Decl *D) {
-  if (!D)
-    return;
-
-  if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
-    if (FD->isThisDeclarationADefinition())
-      if (const Stmt *Body = FD->getBody())
-        addIfInMain(FD, Body->getBeginLoc());
-  } else if (const auto *VD = dyn_cast<VarDecl>(D)) {
-    if (cross_tu::containsConst(VD, Ctx) && VD->hasInit())
-      if (const Expr *Init = VD->getInit())
-        addIfInMain(VD, Init->getBeginLoc());
+private:
+  void addReference(const NamedDecl *ND) {
+    if (!ND)
+      return;
+    if (llvm::Optional<std::string> LookupName =
+            CrossTranslationUnitContext::getLookupName(ND))
+      References.insert(*LookupName);
   }
 
-  if (const auto *DC = dyn_cast<DeclContext>(D))
-    for (const Decl *D : DC->decls())
-      handleDecl(D);
-}
+  llvm::StringSet<> &References;
+};
 
-void MapExtDefNamesConsumer::addIfInMain(const DeclaratorDecl *DD,
-                                         SourceLocation defStart) {
-  llvm::Optional<std::string> LookupName =
-      CrossTranslationUnitContext::getLookupName(DD);
-  if (!LookupName)
-    return;
-  assert(!LookupName->empty() && "Lookup name should be non-empty.");
-
-  if (CurrentFileName.empty()) {
-    CurrentFileName =
-        SM.getFileEntryForID(SM.getMainFileID())->tryGetRealPathName();
-    if (CurrentFileName.empty())
-      CurrentFileName = "invalid_file";
+class MapExtDefNamesConsumer : public ASTConsumer {
+public:
+  ~MapExtDefNamesConsumer() {
+    // Merge into the index emitted after all inputs are processed.
+    std::lock_guard<std::mutex> Guard(MergedIndexMutex);
+    for (const auto &E : Index)
+      MergedIndex[E.getKey()] = E.getValue();
+    for (const auto &E : References)
+      MergedReferences.insert(E.getKey());
   }
 
-  switch (DD->getLinkageInternal()) {
-  case ExternalLinkage:
-  case VisibleNoLinkage:
-  case UniqueExternalLinkage:
-    if (SM.isInMainFile(defStart))
-      Index[*LookupName] = CurrentFileName;
-    break;
-  default:
-    break;
+  void HandleTranslationUnit(ASTContext &Context) override {
+    cross_tu::collectCrossTUIndex(Context, Index);
+    if (!ReferenceMapPath.empty())
+      ReferenceCollector(References)
+          .TraverseDecl(Context.getTranslationUnitDecl());
   }
-}
+
+private:
+  llvm::StringMap<std::string> Index;
+  llvm::StringSet<> References;
+};
 
 class MapExtDefNamesAction : public ASTFrontendAction {
+public:
+  bool BeginInvocation(CompilerInstance &CI) override {
+    // The index needs the signatures and the location of the definitions
+    // only, so let the parser skip the function bodies. Sema still parses
+    // the bodies it cannot afford to lose (constexpr functions and deduced
+    // return types), and the consumer recognizes skipped definitions by
+    // FunctionDecl::hasSkippedBody(). The reference map, in contrast, is
+    // collected from the bodies, so it forces them to be parsed.
+    if (ReferenceMapPath.empty())
+      CI.getFrontendOpts().SkipFunctionBodies = true;
+    return true;
+  }
+
 protected:
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  llvm::StringRef) {
-    return llvm::make_unique<MapExtDefNamesConsumer>(CI.getASTContext());
+    return llvm::make_unique<MapExtDefNamesConsumer>();
   }
 };
 
@@ -122,8 +181,90 @@ int main(int argc, const char **argv) {
   CommonOptionsParser OptionsParser(argc, argv, ClangExtDefMapGenCategory,
                                     cl::ZeroOrMore, Overview);
 
-  ClangTool Tool(OptionsParser.getCompilations(),
-                 OptionsParser.getSourcePathList());
+  if (!ConvertIndexPath.empty()) {
+    if (BinaryIndexPath.empty()) {
+      errs() << "error: -convert-text-index requires -emit-binary-index for "
+                "the output path.\n";
+      return 1;
+    }
+    // Parse with an empty root directory so the file fields are preserved as
+    // written instead of being rebased; the analyzer resolves them against
+    // its own ctu-dir when the converted index is loaded.
+    llvm::Expected<llvm::StringMap<std::string>> IndexOrErr =
+        parseCrossTUIndex(ConvertIndexPath, "");
+    if (!IndexOrErr) {
+      errs() << "error: " << toString(IndexOrErr.takeError()) << '\n';
+      return 1;
+    }
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(BinaryIndexPath, EC, llvm::sys::fs::OF_None);
+    if (EC) {
+      errs() << "error: cannot open '" << BinaryIndexPath
+             << "': " << EC.message() << '\n';
+      return 1;
+    }
+    writeBinaryCrossTUIndex(OS, *IndexOrErr);
+    return 0;
+  }
+
+  int Result = 0;
+
+  if (OptionsParser.getSourcePathList().empty()) {
+    // Without explicit source files, process every translation unit of the
+    // compilation database with a thread pool; the consumers merge their
+    // entries into the single shared index as they finish.
+    AllTUsToolExecutor Executor(std::move(OptionsParser),
+                                ExecutorConcurrency);
+    if (llvm::Error Err =
+            Executor.execute(newFrontendActionFactory<MapExtDefNamesAction>())) {
+      errs() << toString(std::move(Err)) << '\n';
+      Result = 1;
+    }
+  } else {
+    // An explicit file list is processed in order on a single thread.
+    ClangTool Tool(OptionsParser.getCompilations(),
+                   OptionsParser.getSourcePathList());
+    Result = Tool.run(newFrontendActionFactory<MapExtDefNamesAction>().get());
+  }
+
+  if (!ReferenceMapPath.empty()) {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(ReferenceMapPath, EC, llvm::sys::fs::OF_None);
+    if (EC) {
+      errs() << "error: cannot open '" << ReferenceMapPath
+             << "': " << EC.message() << '\n';
+      return 1;
+    }
+    std::vector<StringRef> Names;
+    Names.reserve(MergedReferences.size());
+    for (const auto &E : MergedReferences)
+      Names.push_back(E.getKey());
+    llvm::sort(Names);
+    for (StringRef Name : Names)
+      OS << Name << '\n';
+  }
+
+  if (!BinaryIndexPath.empty()) {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(BinaryIndexPath, EC, llvm::sys::fs::OF_None);
+    if (EC) {
+      errs() << "error: cannot open '" << BinaryIndexPath
+             << "': " << EC.message() << '\n';
+      return 1;
+    }
+    writeBinaryCrossTUIndex(OS, MergedIndex);
+    return Result;
+  }
+
+  // Flush the merged index to standard output, sorted so the result needs no
+  // external sort pass.
+  std::vector<StringRef> Names;
+  Names.reserve(MergedIndex.size());
+  for (const auto &E : MergedIndex)
+    Names.push_back(E.getKey());
+  llvm::sort(Names);
+  for (StringRef Name : Names)
+    outs() << Name << " " << MergedIndex[Name] << '\n';
 
-  return Tool.run(newFrontendActionFactory<MapExtDefNamesAction>().get());
+  return Result;
 }
@@ -19,10 +19,16 @@
 #include "clang/Basic/Version.h"
 #include "clang/Format/Format.h"
 #include "clang/Rewrite/Core/Rewriter.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include <atomic>
+#include <mutex>
 
 using namespace llvm;
 using clang::tooling::Replacements;
@@ -107,12 +113,102 @@ static cl::opt<bool>
     Verbose("verbose", cl::desc("If set, shows the list of processed files"),
             cl::cat(ClangFormatCategory));
 
+static cl::opt<unsigned>
+    ParallelJobs("j",
+                 cl::desc("Number of files to format in parallel. Only\n"
+                          "effective together with -i and more than one\n"
+                          "input file; 0 means one job per hardware thread.\n"
+                          "The formatted output is independent of the job\n"
+                          "count, but diagnostics of different files may\n"
+                          "interleave."),
+                 cl::init(1), cl::cat(ClangFormatCategory));
+
+static cl::opt<std::string> CacheFile(
+    "cache-file",
+    cl::desc("Path of a persistent cache of files that are known to be\n"
+             "formatted correctly. A file whose content and effective\n"
+             "style hash to a cache entry is skipped without formatting\n"
+             "it again; a file that turns out to need no replacements and\n"
+             "the rewritten result of an in-place run are added to the\n"
+             "cache. Only effective together with -i and\n"
+             "without range options. The cache file is created on first\n"
+             "use; deleting it empties the cache."),
+    cl::init(""), cl::cat(ClangFormatCategory));
+
 static cl::list<std::string> FileNames(cl::Positional, cl::desc("[<file> ...]"),
                                        cl::cat(ClangFormatCategory));
 
 namespace clang {
 namespace format {
 
+/// A persistent set of content/style hashes of files that needed no
+/// replacements the last time they were seen. The verdict of a whole-file
+/// format run depends on nothing but the file content, the effective style
+/// and the clang-format version, all of which go into the key, so a hit is
+/// as good as re-running the formatter. Entries are never invalidated: an
+/// edited file simply hashes to a new key, and stale keys only cost their
+/// line in the cache file.
+class CleanFileCache {
+public:
+  CleanFileCache(StringRef Path) : Path(Path) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer = MemoryBuffer::getFile(Path);
+    if (!Buffer)
+      return; // A missing or unreadable cache file starts out empty.
+    SmallVector<StringRef, 128> Lines;
+    (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                 /*KeepEmpty=*/false);
+    for (StringRef Line : Lines)
+      Keys.insert(Line.trim());
+  }
+
+  /// Hashes everything the whole-file verdict depends on.
+  static std::string computeKey(const FormatStyle &Style, StringRef Code) {
+    llvm::MD5 Hash;
+    Hash.update(getClangToolFullVersion("clang-format"));
+    Hash.update(configurationAsText(Style));
+    Hash.update(Code);
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+    return Result.digest().str().str();
+  }
+
+  bool isKnownClean(StringRef Key) {
+    std::lock_guard<std::mutex> Guard(Mutex);
+    return Keys.count(Key);
+  }
+
+  void markClean(StringRef Key) {
+    std::lock_guard<std::mutex> Guard(Mutex);
+    if (Keys.insert(Key).second)
+      Dirty = true;
+  }
+
+  /// Writes the cache back if entries were added. Concurrent clang-format
+  /// processes may overwrite each other's additions; that merely loses a
+  /// future cache hit, never correctness.
+  void save() {
+    if (!Dirty)
+      return;
+    std::error_code EC;
+    raw_fd_ostream OS(Path, EC, llvm::sys::fs::OF_Text);
+    if (EC) {
+      errs() << "warning: could not write cache file '" << Path
+             << "': " << EC.message() << "\n";
+      return;
+    }
+    for (const auto &Entry : Keys)
+      OS << Entry.getKey() << '\n';
+  }
+
+private:
+  std::string Path;
+  std::mutex Mutex;
+  llvm::StringSet<> Keys;
+  bool Dirty = false;
+};
+
+static std::unique_ptr<CleanFileCache> Cache;
+
 static FileID createInMemoryFile(StringRef FileName, MemoryBuffer *Source,
                                  SourceManager &Sources, FileManager &Files,
                                  llvm::vfs::InMemoryFileSystem *MemFS) {
@@ -287,6 +383,10 @@ static bool format(StringRef FileName) {
     return true;
   }
 
+  // Read off whether this is a whole-file run before fillRanges pushes the
+  // default full-file range into the (global) range options.
+  const bool WholeFile =
+      Offsets.empty() && Lengths.empty() && LineRanges.empty();
   std::vector<tooling::Range> Ranges;
   if (fillRanges(Code.get(), Ranges))
     return true;
@@ -301,6 +401,17 @@ static bool format(StringRef FileName) {
 
   if (SortIncludes.getNumOccurrences() != 0)
     FormatStyle->SortIncludes = SortIncludes;
+
+  // The cache only records whole-file verdicts of in-place runs: a partial
+  // range says nothing about the rest of the file, and the stdout modes must
+  // produce their output regardless.
+  std::string CacheKey;
+  if (Cache && WholeFile && Inplace && !OutputXML && FileName != "-") {
+    CacheKey = CleanFileCache::computeKey(*FormatStyle, Code->getBuffer());
+    if (Cache->isKnownClean(CacheKey))
+      return false;
+  }
+
   unsigned CursorPosition = Cursor;
   Replacements Replaces = sortIncludes(*FormatStyle, Code->getBuffer(), Ranges,
                                        AssumedFileName, &CursorPosition);
@@ -315,6 +426,8 @@ static bool format(StringRef FileName) {
   Replacements FormatChanges = reformat(*FormatStyle, *ChangedCode, Ranges,
                                         AssumedFileName, &Status);
   Replaces = Replaces.merge(FormatChanges);
+  if (!CacheKey.empty() && Status.FormatComplete && Replaces.empty())
+    Cache->markClean(CacheKey);
   if (OutputXML) {
     outs() << "<?xml version='1.0'?>\n<replacements "
               "xml:space='preserve' incomplete_format='"
@@ -344,6 +457,18 @@ static bool format(StringRef FileName) {
     if (Inplace) {
       if (Rewrite.overwriteChangedFiles())
         return true;
+      // The rewritten content is what this style considers clean, so record
+      // it as well: the next run over the result -- the common format-on-save
+      // sequence -- then hits the cache instead of re-lexing and re-laying
+      // out the whole file. This relies on formatting being idempotent,
+      // which is the contract a stable run already depends on.
+      if (!CacheKey.empty() && Status.FormatComplete && !Replaces.empty()) {
+        std::string NewCode;
+        raw_string_ostream NewCodeStream(NewCode);
+        Rewrite.getEditBuffer(ID).write(NewCodeStream);
+        Cache->markClean(
+            CleanFileCache::computeKey(*FormatStyle, NewCodeStream.str()));
+      }
     } else {
       if (Cursor.getNumOccurrences() != 0) {
         outs() << "{ \"Cursor\": "
@@ -418,6 +543,14 @@ int main(int argc, const char **argv) {
     return 0;
   }
 
+  if (!CacheFile.empty()) {
+    if (!Inplace || OutputXML) {
+      errs() << "error: -cache-file is only supported with -i.\n";
+      return 1;
+    }
+    clang::format::Cache.reset(new clang::format::CleanFileCache(CacheFile));
+  }
+
   bool Error = false;
   if (FileNames.empty()) {
     Error = clang::format::format("-");
@@ -428,10 +561,32 @@ int main(int argc, const char **argv) {
               "single file.\n";
     return 1;
   }
-  for (const auto &FileName : FileNames) {
-    if (Verbose)
-      errs() << "Formatting " << FileName << "\n";
-    Error |= clang::format::format(FileName);
+  unsigned JobCount =
+      ParallelJobs == 0 ? llvm::hardware_concurrency() : ParallelJobs.getValue();
+  if (JobCount > 1 && Inplace && !OutputXML && FileNames.size() > 1) {
+    // Each in-place job reads and rewrites only its own file, so the files
+    // can be formatted concurrently. The stdout modes are kept sequential:
+    // their output is a single stream whose order must match the input order.
+    std::atomic<bool> AnyError(false);
+    llvm::ThreadPool Pool(std::min<unsigned>(JobCount, FileNames.size()));
+    for (const std::string &FileName : FileNames) {
+      if (Verbose)
+        errs() << "Formatting " << FileName << "\n";
+      Pool.async([&AnyError, &FileName] {
+        if (clang::format::format(FileName))
+          AnyError = true;
+      });
+    }
+    Pool.wait();
+    Error = AnyError;
+  } else {
+    for (const auto &FileName : FileNames) {
+      if (Verbose)
+        errs() << "Formatting " << FileName << "\n";
+      Error |= clang::format::format(FileName);
+    }
   }
+  if (clang::format::Cache)
+    clang::format::Cache->save();
   return Error ? 1 : 0;
 }
@@ -11,6 +11,7 @@
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/ExternalASTMerger.h"
 #include "clang/Basic/Builtins.h"
+#include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/TargetInfo.h"
@@ -18,8 +19,10 @@
 #include "clang/CodeGen/ModuleBuilder.h"
 #include "clang/Driver/Types.h"
 #include "clang/Frontend/ASTConsumers.h"
+#include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/MultiplexConsumer.h"
+#include "clang/Frontend/PCHContainerOperations.h"
 #include "clang/Frontend/TextDiagnosticBuffer.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
@@ -45,6 +48,11 @@ static llvm::cl::list<std::string>
     Imports("import", llvm::cl::ZeroOrMore,
             llvm::cl::desc("Path to a file containing declarations to import"));
 
+static llvm::cl::list<std::string> ASTImports(
+    "import-ast", llvm::cl::ZeroOrMore,
+    llvm::cl::desc("Path to a serialized AST file to import declarations "
+                   "from; declarations are materialized lazily on lookup"));
+
 static llvm::cl::opt<bool>
     Direct("direct", llvm::cl::Optional,
            llvm::cl::desc("Use the parsed declarations without indirection"));
@@ -241,14 +249,25 @@ namespace {
 /// attached).
 ///
 /// This is the main unit of parsed source code maintained by clang-import-test.
+/// It either owns a CompilerInstance for code parsed from source, or an
+/// ASTUnit for declarations loaded lazily from a serialized AST file.
 struct CIAndOrigins {
   using OriginMap = clang::ExternalASTMerger::OriginMap;
   std::unique_ptr<CompilerInstance> CI;
+  std::unique_ptr<ASTUnit> Unit;
 
-  ASTContext &getASTContext() { return CI->getASTContext(); }
-  FileManager &getFileManager() { return CI->getFileManager(); }
+  ASTContext &getASTContext() {
+    return Unit ? Unit->getASTContext() : CI->getASTContext();
+  }
+  FileManager &getFileManager() {
+    return Unit ? Unit->getFileManager() : CI->getFileManager();
+  }
   const OriginMap &getOriginMap() {
     static const OriginMap EmptyOriginMap{};
+    // The external source of a deserialized AST is its ASTReader, which
+    // carries no origin information.
+    if (Unit)
+      return EmptyOriginMap;
     if (ExternalASTSource *Source = CI->getASTContext().getExternalSource())
       return static_cast<ExternalASTMerger *>(Source)->GetOrigins();
     return EmptyOriginMap;
@@ -296,6 +315,23 @@ llvm::Error ParseSource(const std::string &Path, CompilerInstance &CI,
   return llvm::Error::success();
 }
 
+llvm::Expected<CIAndOrigins> LoadSerializedAST(const std::string &Path) {
+  // The ASTUnit keeps a reference to the reader, so the container operations
+  // must outlive every unit loaded here.
+  static PCHContainerOperations PCHOps;
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags =
+      CompilerInstance::createDiagnostics(new DiagnosticOptions());
+  std::unique_ptr<ASTUnit> Unit = ASTUnit::LoadFromASTFile(
+      Path, PCHOps.getRawReader(), ASTUnit::LoadEverything, Diags,
+      FileSystemOptions());
+  if (!Unit)
+    return llvm::make_error<llvm::StringError>(
+        llvm::Twine("Couldn't load AST file ", Path), std::error_code());
+  CIAndOrigins CI{};
+  CI.Unit = std::move(Unit);
+  return std::move(CI);
+}
+
 llvm::Expected<CIAndOrigins> Parse(const std::string &Path,
                                    llvm::MutableArrayRef<CIAndOrigins> Imports,
                                    bool ShouldDumpAST, bool ShouldDumpIR) {
@@ -362,6 +398,14 @@ int main(int argc, const char **argv) {
     }
     ImportCIs.push_back(std::move(*ImportCI));
   }
+  for (auto I : ASTImports) {
+    llvm::Expected<CIAndOrigins> ImportCI = LoadSerializedAST(I);
+    if (auto E = ImportCI.takeError()) {
+      llvm::errs() << llvm::toString(std::move(E));
+      exit(-1);
+    }
+    ImportCIs.push_back(std::move(*ImportCI));
+  }
   std::vector<CIAndOrigins> IndirectCIs;
   if (!Direct || UseOrigins) {
     for (auto &ImportCI : ImportCIs) {
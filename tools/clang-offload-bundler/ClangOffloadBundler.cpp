@@ -31,12 +31,14 @@
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Signals.h"
 #include <algorithm>
@@ -99,9 +101,20 @@ static cl::opt<bool> DumpTemporaryFiles(
     cl::desc("Dumps any temporary files created - for testing purposes.\n"),
     cl::init(false), cl::cat(ClangOffloadBundlerCategory));
 
+static cl::opt<bool> CompressDeviceImages(
+    "compress",
+    cl::desc("Compress the device images when bundling with the binary\n"
+             "format. The images are compressed in parallel and are\n"
+             "decompressed transparently when unbundling.\n"),
+    cl::init(false), cl::cat(ClangOffloadBundlerCategory));
+
 /// Magic string that marks the existence of offloading data.
 #define OFFLOAD_BUNDLER_MAGIC_STR "__CLANG_OFFLOAD_BUNDLE__"
 
+/// Magic string that starts a zlib-compressed bundle in a binary-format file.
+/// It is followed by the 8-byte uncompressed size and the compressed bytes.
+#define OFFLOAD_BUNDLER_COMPRESSED_MAGIC_STR "__CLANG_OFFLOAD_ZLIB__"
+
 /// The index of the host input in the list of inputs.
 static unsigned HostInputIndex = ~0u;
 
@@ -191,6 +204,12 @@ public:
 /// Bundle1
 /// ...
 /// BundleN
+///
+/// If a bundle was compressed (see the -compress option), its bytes consist
+/// of "OFFLOAD_BUNDLER_COMPRESSED_MAGIC_STR", the 8-byte uncompressed size
+/// and the zlib stream; the offset and size in the header describe the
+/// compressed bytes, so a single bundle can still be located without reading
+/// the others. Compressed bundles are decompressed transparently when read.
 
 /// Read 8-byte integers from a buffer in little-endian format.
 static uint64_t Read8byteIntegerFromBuffer(StringRef Buffer, size_t pos) {
@@ -232,6 +251,25 @@ class BinaryFileHandler final : public FileHandler {
   /// Iterator for the bundle information that is being read.
   StringMap<BundleInfo>::iterator CurBundleInfo;
 
+  /// Compressed device images, indexed like the inputs. An empty entry means
+  /// the corresponding input is stored uncompressed.
+  std::vector<SmallVector<char, 0>> CompressedImages;
+
+  /// Index of the input whose bundle is written next.
+  unsigned CurWriteIndex = 0;
+
+  /// Size of the fixed prefix of a compressed bundle: the magic string and
+  /// the uncompressed size.
+  static const uint64_t CompressedPrefixSize =
+      sizeof(OFFLOAD_BUNDLER_COMPRESSED_MAGIC_STR) - 1 + 8;
+
+  /// On-disk size of the bundle of input \a Idx.
+  uint64_t getBundleSize(const MemoryBuffer &MB, unsigned Idx) const {
+    if (!CompressedImages.empty() && !CompressedImages[Idx].empty())
+      return CompressedPrefixSize + CompressedImages[Idx].size();
+    return MB.getBufferSize();
+  }
+
 public:
   BinaryFileHandler() : FileHandler() {}
 
@@ -318,12 +356,63 @@ public:
   void ReadBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
     assert(CurBundleInfo != BundlesInfo.end() && "Invalid reader info!");
     StringRef FC = Input.getBuffer();
-    OS.write(FC.data() + CurBundleInfo->second.Offset,
-             CurBundleInfo->second.Size);
+    StringRef Bundle(FC.data() + CurBundleInfo->second.Offset,
+                     CurBundleInfo->second.Size);
+
+    // If the bundle was compressed by the bundler, decompress it on the fly.
+    if (Bundle.size() > CompressedPrefixSize &&
+        Bundle.startswith(OFFLOAD_BUNDLER_COMPRESSED_MAGIC_STR)) {
+      uint64_t UncompressedSize = Read8byteIntegerFromBuffer(
+          Bundle, sizeof(OFFLOAD_BUNDLER_COMPRESSED_MAGIC_STR) - 1);
+      SmallVector<char, 0> Uncompressed;
+      if (Error E = zlib::uncompress(Bundle.substr(CompressedPrefixSize),
+                                     Uncompressed, UncompressedSize)) {
+        logAllUnhandledErrors(std::move(E), errs(),
+                              "error: cannot decompress bundle: ");
+        return;
+      }
+      OS.write(Uncompressed.data(), Uncompressed.size());
+      return;
+    }
+
+    OS.write(Bundle.data(), Bundle.size());
   }
 
   void WriteHeader(raw_fd_ostream &OS,
                    ArrayRef<std::unique_ptr<MemoryBuffer>> Inputs) final {
+    // If requested, compress the device images before the header is emitted,
+    // as the header has to record the on-disk sizes. Each image is handled by
+    // its own thread pool job, so the images compress in parallel.
+    if (CompressDeviceImages) {
+      if (!zlib::isAvailable()) {
+        errs() << "warning: zlib is not available; "
+                  "bundles are stored uncompressed.\n";
+      } else {
+        CompressedImages.resize(Inputs.size());
+        ThreadPool Pool;
+        for (size_t I = 0, E = Inputs.size(); I != E; ++I) {
+          // Leave the host bundle uncompressed; it is the one the host
+          // compilation extracts, and that should stay a plain copy.
+          if (I == HostInputIndex)
+            continue;
+          Pool.async([this, &Inputs, I] {
+            SmallVector<char, 0> Buffer;
+            if (Error E = zlib::compress(Inputs[I]->getBuffer(), Buffer)) {
+              // Store the image uncompressed instead.
+              consumeError(std::move(E));
+              return;
+            }
+            // Only keep the compressed form if it is actually smaller.
+            if (CompressedPrefixSize + Buffer.size() >=
+                Inputs[I]->getBufferSize())
+              return;
+            CompressedImages[I] = std::move(Buffer);
+          });
+        }
+        Pool.wait();
+      }
+    }
+
     // Compute size of the header.
     uint64_t HeaderSize = 0;
 
@@ -342,12 +431,14 @@ public:
 
     unsigned Idx = 0;
     for (auto &T : TargetNames) {
-      MemoryBuffer &MB = *Inputs[Idx++].get();
+      MemoryBuffer &MB = *Inputs[Idx].get();
+      uint64_t BundleSize = getBundleSize(MB, Idx);
+      ++Idx;
       // Bundle offset.
       Write8byteIntegerToBuffer(OS, HeaderSize);
       // Size of the bundle (adds to the next bundle's offset)
-      Write8byteIntegerToBuffer(OS, MB.getBufferSize());
-      HeaderSize += MB.getBufferSize();
+      Write8byteIntegerToBuffer(OS, BundleSize);
+      HeaderSize += BundleSize;
       // Size of the triple
       Write8byteIntegerToBuffer(OS, T.size());
       // Triple
@@ -362,6 +453,13 @@ public:
   }
 
   void WriteBundle(raw_fd_ostream &OS, MemoryBuffer &Input) final {
+    unsigned Idx = CurWriteIndex++;
+    if (!CompressedImages.empty() && !CompressedImages[Idx].empty()) {
+      OS << OFFLOAD_BUNDLER_COMPRESSED_MAGIC_STR;
+      Write8byteIntegerToBuffer(OS, Input.getBufferSize());
+      OS.write(CompressedImages[Idx].data(), CompressedImages[Idx].size());
+      return;
+    }
     OS.write(Input.getBufferStart(), Input.getBufferSize());
   }
 };
@@ -777,8 +875,12 @@ static bool BundleFiles() {
 
   unsigned Idx = 0;
   for (auto &I : InputFileNames) {
+    // None of the handlers needs a null terminator, and not asking for one
+    // lets large inputs stay memory-mapped instead of being copied into an
+    // allocated buffer.
     ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-        MemoryBuffer::getFileOrSTDIN(I);
+        MemoryBuffer::getFileOrSTDIN(I, /*FileSize=*/-1,
+                                     /*RequiresNullTerminator=*/false);
     if (std::error_code EC = CodeOrErr.getError()) {
       errs() << "error: Can't open file " << I << ": " << EC.message() << "\n";
       return true;
@@ -813,9 +915,12 @@ static bool BundleFiles() {
 
 // Unbundle the files. Return true if an error was found.
 static bool UnbundleFiles() {
-  // Open Input file.
+  // Open Input file. A memory-mapped buffer means extracting one bundle out
+  // of a large fat binary only ever touches the pages of the header and of
+  // that bundle.
   ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-      MemoryBuffer::getFileOrSTDIN(InputFileNames.front());
+      MemoryBuffer::getFileOrSTDIN(InputFileNames.front(), /*FileSize=*/-1,
+                                   /*RequiresNullTerminator=*/false);
   if (std::error_code EC = CodeOrErr.getError()) {
     errs() << "error: Can't open file " << InputFileNames.front() << ": "
            << EC.message() << "\n";
@@ -16,16 +16,21 @@
 #include "clang/Frontend/CommandLineSourceLoc.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Rewrite/Core/Rewriter.h"
+#include "clang/Tooling/AllTUsExecution.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Refactoring.h"
 #include "clang/Tooling/Refactoring/RefactoringAction.h"
 #include "clang/Tooling/Refactoring/RefactoringOptions.h"
 #include "clang/Tooling/Refactoring/Rename/RenamingAction.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <string>
 
 using namespace clang;
@@ -45,6 +50,15 @@ static cl::opt<bool> Inplace("i", cl::desc("Inplace edit <file>s"),
                              cl::cat(cl::GeneralCategory),
                              cl::sub(*cl::AllSubCommands));
 
+static cl::opt<unsigned>
+    Jobs("j",
+         cl::desc("Number of translation units to process in parallel; 0 "
+                  "selects the hardware concurrency. Any value other than 1 "
+                  "runs the action over every file in the compilation "
+                  "database instead of the files given on the command line"),
+         cl::init(1), cl::cat(cl::GeneralCategory),
+         cl::sub(*cl::AllSubCommands));
+
 } // end namespace opts
 
 namespace {
@@ -313,7 +327,8 @@ private:
 
 class ClangRefactorConsumer final : public ClangRefactorToolConsumerInterface {
 public:
-  ClangRefactorConsumer(AtomicChanges &Changes) : SourceChanges(&Changes) {}
+  ClangRefactorConsumer(AtomicChanges &Changes, std::mutex &ChangesMutex)
+      : SourceChanges(&Changes), ChangesMutex(&ChangesMutex) {}
 
   void handleError(llvm::Error Err) override {
     Optional<PartialDiagnosticAt> Diag = DiagnosticError::take(Err);
@@ -328,6 +343,7 @@ public:
   }
 
   void handle(AtomicChanges Changes) override {
+    std::lock_guard<std::mutex> Lock(*ChangesMutex);
     SourceChanges->insert(SourceChanges->begin(), Changes.begin(),
                           Changes.end());
   }
@@ -338,13 +354,13 @@ public:
 
 private:
   AtomicChanges *SourceChanges;
+  std::mutex *ChangesMutex;
 };
 
 class ClangRefactorTool {
 public:
   ClangRefactorTool()
-      : SelectedSubcommand(nullptr), MatchingRule(nullptr),
-        Consumer(new ClangRefactorConsumer(Changes)), HasFailed(false) {
+      : SelectedSubcommand(nullptr), MatchingRule(nullptr), HasFailed(false) {
     std::vector<std::unique_ptr<RefactoringAction>> Actions =
         createRefactoringActions();
 
@@ -387,12 +403,15 @@ public:
 
   using TUCallbackType = std::function<void(ASTContext &)>;
 
-  // Callback of an AST action. This invokes the matching rule on the given AST.
+  // Callback of an AST action. This invokes the matching rule on the given
+  // AST. May run concurrently for different TUs, so every TU gets its own
+  // consumer; the collected changes are guarded by ChangesMutex.
   void callback(ASTContext &AST) {
-    assert(SelectedSubcommand && MatchingRule && Consumer);
+    assert(SelectedSubcommand && MatchingRule);
     RefactoringRuleContext Context(AST.getSourceManager());
     Context.setASTContext(AST);
 
+    ClangRefactorConsumer PerTUConsumer(Changes, ChangesMutex);
     // If the selection option is test specific, we use a test-specific
     // consumer.
     std::unique_ptr<ClangRefactorToolConsumerInterface> TestConsumer;
@@ -400,7 +419,7 @@ public:
     if (HasSelection)
       TestConsumer = SelectedSubcommand->getSelection()->createCustomConsumer();
     ClangRefactorToolConsumerInterface *ActiveConsumer =
-        TestConsumer ? TestConsumer.get() : Consumer.get();
+        TestConsumer ? TestConsumer.get() : &PerTUConsumer;
     ActiveConsumer->beginTU(AST);
 
     auto InvokeRule = [&](RefactoringResultConsumer &Consumer) {
@@ -471,17 +490,26 @@ public:
         [this](ASTContext &AST) { return callback(AST); });
   }
 
-  // FIXME(ioeric): this seems to only works for changes in a single file at
-  // this point.
   bool applySourceChanges() {
-    std::set<std::string> Files;
-    for (const auto &Change : Changes)
-      Files.insert(Change.getFilePath());
+    // Every translation unit that includes a shared header reports the same
+    // edits for it; apply each distinct change once. Changes with the same
+    // key but different content are all kept and surface as replacement
+    // conflicts below. The map also groups the changes by file, so that each
+    // file is rewritten in one conflict-checked pass.
+    llvm::StringSet<> Seen;
+    std::map<std::string, AtomicChanges> ChangesByFile;
+    for (auto &Change : Changes) {
+      if (Seen.insert(Change.toYAMLString()).second)
+        ChangesByFile[Change.getFilePath()].push_back(std::move(Change));
+    }
+    Changes.clear();
+
     // FIXME: Add automatic formatting support as well.
     tooling::ApplyChangesSpec Spec;
     // FIXME: We should probably cleanup the result by default as well.
     Spec.Cleanup = false;
-    for (const auto &File : Files) {
+    for (const auto &FileAndChanges : ChangesByFile) {
+      const std::string &File = FileAndChanges.first;
       llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> BufferErr =
           llvm::MemoryBuffer::getFile(File);
       if (!BufferErr) {
@@ -489,7 +517,7 @@ public:
         return true;
       }
       auto Result = tooling::applyAtomicChanges(File, (*BufferErr)->getBuffer(),
-                                                Changes, Spec);
+                                                FileAndChanges.second, Spec);
       if (!Result) {
         llvm::errs() << toString(Result.takeError());
         return true;
@@ -598,9 +626,9 @@ private:
   std::vector<std::unique_ptr<RefactoringActionSubcommand>> SubCommands;
   RefactoringActionSubcommand *SelectedSubcommand;
   RefactoringActionRule *MatchingRule;
-  std::unique_ptr<ClangRefactorToolConsumerInterface> Consumer;
   AtomicChanges Changes;
-  bool HasFailed;
+  std::mutex ChangesMutex;
+  std::atomic<bool> HasFailed;
 };
 
 } // end anonymous namespace
@@ -624,13 +652,24 @@ int main(int argc, const char **argv) {
     llvm::errs() << llvm::toString(ActionFactory.takeError()) << "\n";
     return 1;
   }
-  ClangTool Tool(Options.getCompilations(), Options.getSourcePathList());
   bool Failed = false;
-  if (Tool.run(ActionFactory->get()) != 0) {
-    llvm::errs() << "Failed to run refactoring action on files\n";
-    // It is possible that TUs are broken while changes are generated correctly,
-    // so we still try applying changes.
-    Failed = true;
+  if (opts::Jobs == 1) {
+    ClangTool Tool(Options.getCompilations(), Options.getSourcePathList());
+    if (Tool.run(ActionFactory->get()) != 0) {
+      llvm::errs() << "Failed to run refactoring action on files\n";
+      // It is possible that TUs are broken while changes are generated
+      // correctly, so we still try applying changes.
+      Failed = true;
+    }
+  } else {
+    // Process the whole compilation database in parallel; the changes are
+    // collected concurrently and applied below in a single deduplicated,
+    // conflict-checked pass.
+    AllTUsToolExecutor Executor(Options.getCompilations(), opts::Jobs);
+    if (auto Err = Executor.execute(std::move(*ActionFactory))) {
+      llvm::errs() << llvm::toString(std::move(Err)) << "\n";
+      Failed = true;
+    }
   }
   return RefactorTool.applySourceChanges() || Failed ||
          RefactorTool.hasFailed();
@@ -20,6 +20,9 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TokenKinds.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/IndexingAction.h"
+#include "clang/Index/USRGeneration.h"
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Refactoring.h"
@@ -28,6 +31,9 @@
 #include "clang/Tooling/ReplacementsYaml.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/YAMLTraits.h"
@@ -47,6 +53,15 @@ struct RenameAllInfo {
 
 LLVM_YAML_IS_SEQUENCE_VECTOR(RenameAllInfo)
 
+/// An entry of the persisted symbol index: a USR and the translation units
+/// whose main files mention it.
+struct IndexedSymbol {
+  std::string USR;
+  std::vector<std::string> Files;
+};
+
+LLVM_YAML_IS_SEQUENCE_VECTOR(IndexedSymbol)
+
 namespace llvm {
 namespace yaml {
 
@@ -60,9 +75,81 @@ template <> struct MappingTraits<RenameAllInfo> {
   }
 };
 
+/// Specialized MappingTraits to describe how an IndexedSymbol is
+/// (de)serialized.
+template <> struct MappingTraits<IndexedSymbol> {
+  static void mapping(IO &IO, IndexedSymbol &Symbol) {
+    IO.mapRequired("USR", Symbol.USR);
+    IO.mapRequired("Files", Symbol.Files);
+  }
+};
+
 } // end namespace yaml
 } // end namespace llvm
 
+namespace {
+
+/// Records, for every symbol occurrence seen while indexing, the main file of
+/// the translation unit it occurred in. Renaming re-parses whole translation
+/// units, so the index only has to answer "which TUs mention this USR", not
+/// where inside them the occurrences are.
+class OccurrenceIndexer : public index::IndexDataConsumer {
+public:
+  explicit OccurrenceIndexer(llvm::StringMap<llvm::StringSet<>> &Index)
+      : Index(Index) {}
+
+  void initialize(ASTContext &Ctx) override {
+    SourceManager &SM = Ctx.getSourceManager();
+    const FileEntry *FE = SM.getFileEntryForID(SM.getMainFileID());
+    if (!FE) {
+      MainFile.clear();
+      return;
+    }
+    // Prefer the resolved path so the index stays valid regardless of the
+    // working directory it is consumed from.
+    MainFile = FE->tryGetRealPathName();
+    if (MainFile.empty())
+      MainFile = FE->getName();
+  }
+
+  bool handleDeclOccurence(const Decl *D, index::SymbolRoleSet Roles,
+                           ArrayRef<index::SymbolRelation> Relations,
+                           SourceLocation Loc, ASTNodeInfo ASTNode) override {
+    if (MainFile.empty())
+      return true;
+    SmallString<128> USR;
+    if (index::generateUSRForDecl(D, USR))
+      return true;
+    Index[USR].insert(MainFile);
+    return true;
+  }
+
+private:
+  llvm::StringMap<llvm::StringSet<>> &Index;
+  std::string MainFile;
+};
+
+class IndexActionFactory : public tooling::FrontendActionFactory {
+public:
+  explicit IndexActionFactory(llvm::StringMap<llvm::StringSet<>> &Index)
+      : Index(Index) {}
+
+  FrontendAction *create() override {
+    index::IndexingOptions Opts;
+    Opts.SystemSymbolFilter =
+        index::IndexingOptions::SystemSymbolFilterKind::None;
+    return index::createIndexingAction(
+               std::make_shared<OccurrenceIndexer>(Index), Opts,
+               /*WrappedAction=*/nullptr)
+        .release();
+  }
+
+private:
+  llvm::StringMap<llvm::StringSet<>> &Index;
+};
+
+} // end anonymous namespace
+
 static cl::OptionCategory ClangRenameOptions("clang-rename common options");
 
 static cl::list<unsigned> SymbolOffsets(
@@ -96,10 +183,61 @@ static cl::opt<std::string>
 static cl::opt<bool> Force("force",
                            cl::desc("Ignore nonexistent qualified names."),
                            cl::cat(ClangRenameOptions));
+static cl::opt<std::string>
+    IndexFile("index",
+              cl::desc("YAML symbol index used to restrict the rename to the "
+                       "translation units that mention the symbol."),
+              cl::value_desc("filename"), cl::cat(ClangRenameOptions));
+static cl::opt<bool>
+    BuildIndex("build-index",
+               cl::desc("Build the symbol index over the given sources, write "
+                        "it to the file given by -index and exit."),
+               cl::cat(ClangRenameOptions));
 
 int main(int argc, const char **argv) {
   tooling::CommonOptionsParser OP(argc, argv, ClangRenameOptions);
 
+  if (BuildIndex) {
+    if (IndexFile.empty()) {
+      errs() << "clang-rename: -build-index requires -index=<file>.\n";
+      return 1;
+    }
+
+    tooling::ClangTool IndexTool(OP.getCompilations(), OP.getSourcePathList());
+    llvm::StringMap<llvm::StringSet<>> Index;
+    IndexActionFactory IndexFactory(Index);
+    if (IndexTool.run(&IndexFactory))
+      return 1;
+
+    // Emit the index sorted so rebuilding an unchanged project yields an
+    // identical file.
+    std::vector<IndexedSymbol> Symbols;
+    Symbols.reserve(Index.size());
+    for (const auto &Entry : Index) {
+      IndexedSymbol Symbol;
+      Symbol.USR = Entry.first().str();
+      for (const auto &File : Entry.second)
+        Symbol.Files.push_back(File.first().str());
+      llvm::sort(Symbol.Files.begin(), Symbol.Files.end());
+      Symbols.push_back(std::move(Symbol));
+    }
+    llvm::sort(Symbols.begin(), Symbols.end(),
+               [](const IndexedSymbol &LHS, const IndexedSymbol &RHS) {
+                 return LHS.USR < RHS.USR;
+               });
+
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(IndexFile, EC, llvm::sys::fs::F_None);
+    if (EC) {
+      errs() << "clang-rename: failed to write " << IndexFile << ": "
+             << EC.message() << "\n";
+      return 1;
+    }
+    yaml::Output YAML(OS);
+    YAML << Symbols;
+    return 0;
+  }
+
   if (!Input.empty()) {
     // Populate QualifiedNames and NewNames from a YAML file.
     ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer =
@@ -174,17 +312,61 @@ int main(int argc, const char **argv) {
     return 1;
   }
 
+  // With a symbol index, rename over the translation units that are known to
+  // mention one of the USRs instead of re-parsing every given source. The
+  // files named on the command line are always kept: they resolved the symbol
+  // just now, so they contain occurrences even if the index is stale.
+  std::vector<std::string> RenameFiles = Files;
+  if (!IndexFile.empty()) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer =
+        llvm::MemoryBuffer::getFile(IndexFile);
+    if (!Buffer) {
+      errs() << "clang-rename: failed to read " << IndexFile << ": "
+             << Buffer.getError().message() << "\n";
+      return 1;
+    }
+
+    std::vector<IndexedSymbol> Symbols;
+    llvm::yaml::Input YAML(Buffer.get()->getBuffer());
+    YAML >> Symbols;
+    if (YAML.error()) {
+      errs() << "clang-rename: failed to parse " << IndexFile << ".\n";
+      return 1;
+    }
+
+    llvm::StringSet<> Wanted;
+    for (const auto &USRs : USRList)
+      for (const auto &USR : USRs)
+        Wanted.insert(USR);
+
+    llvm::StringSet<> Relevant;
+    for (const auto &File : RenameFiles)
+      Relevant.insert(File);
+    for (const auto &Symbol : Symbols)
+      if (Wanted.count(Symbol.USR))
+        for (const auto &File : Symbol.Files)
+          Relevant.insert(File);
+
+    RenameFiles.clear();
+    for (const auto &File : Relevant)
+      RenameFiles.push_back(File.first().str());
+    llvm::sort(RenameFiles.begin(), RenameFiles.end());
+  }
+
+  tooling::RefactoringTool RenameTool(OP.getCompilations(), RenameFiles);
+
   // Perform the renaming.
   tooling::RenamingAction RenameAction(NewNames, PrevNames, USRList,
-                                       Tool.getReplacements(), PrintLocations);
+                                       RenameTool.getReplacements(),
+                                       PrintLocations);
   std::unique_ptr<tooling::FrontendActionFactory> Factory =
       tooling::newFrontendActionFactory(&RenameAction);
   int ExitCode;
 
   if (Inplace) {
-    ExitCode = Tool.runAndSave(Factory.get());
+    ExitCode = RenameTool.runAndSave(Factory.get());
   } else {
-    ExitCode = Tool.run(Factory.get());
+    ExitCode = RenameTool.run(Factory.get());
 
     if (!ExportFixes.empty()) {
       std::error_code EC;
@@ -196,7 +378,7 @@ int main(int argc, const char **argv) {
 
       // Export replacements.
       tooling::TranslationUnitReplacements TUR;
-      const auto &FileToReplacements = Tool.getReplacements();
+      const auto &FileToReplacements = RenameTool.getReplacements();
       for (const auto &Entry : FileToReplacements)
         TUR.Replacements.insert(TUR.Replacements.end(), Entry.second.begin(),
                                 Entry.second.end());
@@ -216,12 +398,12 @@ int main(int argc, const char **argv) {
     DiagnosticsEngine Diagnostics(
         IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs()), &*DiagOpts,
         &DiagnosticPrinter, false);
-    auto &FileMgr = Tool.getFiles();
+    auto &FileMgr = RenameTool.getFiles();
     SourceManager Sources(Diagnostics, FileMgr);
     Rewriter Rewrite(Sources, DefaultLangOptions);
 
-    Tool.applyAllReplacements(Rewrite);
-    for (const auto &File : Files) {
+    RenameTool.applyAllReplacements(Rewrite);
+    for (const auto &File : RenameFiles) {
       const auto *Entry = FileMgr.getFile(File);
       const auto ID = Sources.getOrCreateFileID(Entry, SrcMgr::C_User);
       Rewrite.getEditBuffer(ID).write(outs());
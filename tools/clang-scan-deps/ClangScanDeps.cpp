@@ -8,6 +8,7 @@
 
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
 #include "llvm/Support/InitLLVM.h"
@@ -15,6 +16,7 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/Threading.h"
+#include <iostream>
 #include <mutex>
 #include <thread>
 
@@ -45,9 +47,13 @@ public:
   ///
   /// \param Compilations     The reference to the compilation database that's
   /// used by the clang tool.
-  DependencyScanningTool(const tooling::CompilationDatabase &Compilations,
-                         SharedStream &OS, SharedStream &Errs)
-      : Compilations(Compilations), OS(OS), Errs(Errs) {}
+  /// \param SharedCache     The cache of minimized files shared between the
+  /// workers; null when the sources are preprocessed unmodified.
+  DependencyScanningTool(
+      DependencyScanningFilesystemSharedCache *SharedCache,
+      const tooling::CompilationDatabase &Compilations, SharedStream &OS,
+      SharedStream &Errs)
+      : Worker(SharedCache), Compilations(Compilations), OS(OS), Errs(Errs) {}
 
   /// Computes the dependencies for the given file and prints them out.
   ///
@@ -80,6 +86,31 @@ llvm::cl::opt<bool> Help("h", llvm::cl::desc("Alias for -help"),
 
 llvm::cl::OptionCategory DependencyScannerCategory("Tool options");
 
+/// The preprocessing modes of the scanner.
+enum ScanningMode {
+  /// The sources are preprocessed after being minimized down to the
+  /// directives that might affect the dependencies.
+  MinimizedSourcePreprocessing,
+
+  /// The sources are preprocessed unmodified.
+  CanonicalPreprocessing
+};
+
+llvm::cl::opt<ScanningMode> ScanMode(
+    "mode",
+    llvm::cl::desc("The preprocessing mode used to compute the dependencies"),
+    llvm::cl::values(
+        clEnumValN(MinimizedSourcePreprocessing,
+                   "preprocess-minimized-sources",
+                   "The set of dependencies is computed by preprocessing the "
+                   "source files that were minimized to the contents that "
+                   "might affect the dependencies"),
+        clEnumValN(CanonicalPreprocessing, "preprocess",
+                   "The set of dependencies is computed by preprocessing the "
+                   "unmodified source files")),
+    llvm::cl::init(MinimizedSourcePreprocessing),
+    llvm::cl::cat(DependencyScannerCategory));
+
 llvm::cl::opt<unsigned>
     NumThreads("j", llvm::cl::Optional,
                llvm::cl::desc("Number of worker threads to use (default: use "
@@ -91,6 +122,17 @@ llvm::cl::opt<std::string>
                   llvm::cl::desc("Compilation database"), llvm::cl::Required,
                   llvm::cl::cat(DependencyScannerCategory));
 
+llvm::cl::opt<bool> Interactive(
+    "interactive",
+    llvm::cl::desc(
+        "Keep the tool alive and serve one query per line from the standard "
+        "input instead of scanning the whole compilation database. A query "
+        "is the path of a file from the compilation database; the response "
+        "is its dependency list, followed by an empty line. The caches of "
+        "the tool stay warm between the queries, so rescanning a freshly "
+        "changed file does not pay the cold start cost again."),
+    llvm::cl::init(false), llvm::cl::cat(DependencyScannerCategory));
+
 } // end anonymous namespace
 
 int main(int argc, const char **argv) {
@@ -136,12 +178,50 @@ int main(int argc, const char **argv) {
   SharedStream Errs(llvm::errs());
   // Print out the dependency results to STDOUT by default.
   SharedStream DependencyOS(llvm::outs());
+  // The cache of minimized files is shared between all the workers, so each
+  // header is read and minimized exactly once per tool run.
+  DependencyScanningFilesystemSharedCache SharedCache;
+  DependencyScanningFilesystemSharedCache *SharedCachePtr =
+      ScanMode == MinimizedSourcePreprocessing ? &SharedCache : nullptr;
   unsigned NumWorkers =
-      NumThreads == 0 ? llvm::hardware_concurrency() : NumThreads;
+      Interactive ? 1
+                  : (NumThreads == 0 ? llvm::hardware_concurrency()
+                                     : NumThreads);
   std::vector<std::unique_ptr<DependencyScanningTool>> WorkerTools;
   for (unsigned I = 0; I < NumWorkers; ++I)
     WorkerTools.push_back(llvm::make_unique<DependencyScanningTool>(
-        *AdjustingCompilations, DependencyOS, Errs));
+        SharedCachePtr, *AdjustingCompilations, DependencyOS, Errs));
+
+  if (Interactive) {
+    // Serve the queries from the standard input until it is closed. The
+    // worker, its file system and the shared minimization cache live across
+    // the queries, so only the files that actually changed since the
+    // previous query are read and minimized again. Each response ends with
+    // an empty line so a client driving the tool over a pipe can detect the
+    // end of a response without closing the stream.
+    llvm::StringMap<std::string> InputDirs;
+    for (const auto &Input : Inputs)
+      InputDirs[Input.first] = Input.second;
+
+    bool HadErrors = false;
+    std::string Line;
+    while (std::getline(std::cin, Line)) {
+      StringRef Filename = StringRef(Line).trim();
+      if (Filename.empty())
+        continue;
+      auto It = InputDirs.find(Filename);
+      if (It == InputDirs.end()) {
+        Errs.applyLocked([&](raw_ostream &OS) {
+          OS << "Error: no compile command for " << Filename << "\n";
+        });
+        HadErrors = true;
+      } else if (WorkerTools.front()->runOnFile(Filename, It->getValue())) {
+        HadErrors = true;
+      }
+      DependencyOS.applyLocked([](raw_ostream &OS) { OS << "\n"; });
+    }
+    return HadErrors;
+  }
 
   std::vector<std::thread> WorkerThreads;
   std::atomic<bool> HadErrors(false);
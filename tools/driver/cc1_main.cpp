@@ -240,8 +240,12 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
                                   static_cast<void*>(&Clang->getDiagnostics()));
 
   DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
-  if (!Success)
+  if (!Success) {
+    // Keep the error handler from leaking into a cc1 invocation that runs
+    // in-process after this one (see CC1Command).
+    llvm::remove_fatal_error_handler();
     return 1;
+  }
 
   // Execute the frontend actions.
   {
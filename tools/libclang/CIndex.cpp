@@ -38,6 +38,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Compiler.h"
@@ -3482,8 +3483,11 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
   // in the actual argument list.
   // Put the source file after command_line_args otherwise if '-x' flag is
   // present it will be unused.
-  if (source_filename)
+  size_t SourceArgIndex = 0;
+  if (source_filename) {
+    SourceArgIndex = Args->size();
     Args->push_back(source_filename);
+  }
 
   // Do we need the detailed preprocessing record?
   if (options & CXTranslationUnit_DetailedPreprocessingRecord) {
@@ -3506,6 +3510,39 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
       *CXXIdx, LibclangInvocationReporter::OperationKind::ParseOperation,
       options, llvm::makeArrayRef(*Args), /*InvocationArgs=*/None,
       unsaved_files);
+
+  // Reuse the driver-resolved invocation of an earlier parse whose command
+  // line differed only in the input file; when the command line is new,
+  // LoadFromCommandLine fills the slot with a pristine copy for the pool.
+  // The pool is keyed without the input, so it only applies when the input
+  // arrives as 'source_filename' rather than embedded in the arguments.
+  SmallVector<const char *, 32> PoolKeyArgs;
+  if (source_filename) {
+    PoolKeyArgs.append(Args->begin(), Args->end());
+    PoolKeyArgs.erase(PoolKeyArgs.begin() + SourceArgIndex);
+  }
+
+  CIndexer::InvocationPoolEntry PoolEntry;
+  const bool HadPooledInvocation =
+      source_filename &&
+      CXXIdx->lookupInvocation(PoolKeyArgs, source_filename, PoolEntry);
+
+  std::shared_ptr<CompilerInvocation> PooledInvocation;
+  SmallVector<StoredDiagnostic, 2> PooledDriverDiags;
+  if (HadPooledInvocation) {
+    // The pooled invocation was resolved for a different input of the same
+    // kind; parse a copy with the input swapped for ours, replaying the
+    // driver diagnostics recorded when the command line was resolved.
+    PooledInvocation =
+        std::make_shared<CompilerInvocation>(*PoolEntry.Invocation);
+    FrontendOptions &FEOpts = PooledInvocation->getFrontendOpts();
+    FrontendInputFile Input(source_filename, FEOpts.Inputs[0].getKind(),
+                            FEOpts.Inputs[0].isSystem());
+    FEOpts.Inputs.clear();
+    FEOpts.Inputs.push_back(Input);
+    PooledDriverDiags = std::move(PoolEntry.DriverDiagnostics);
+  }
+
   std::unique_ptr<ASTUnit> Unit(ASTUnit::LoadFromCommandLine(
       Args->data(), Args->data() + Args->size(),
       CXXIdx->getPCHContainerOperations(), Diags,
@@ -3516,7 +3553,18 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
       /*AllowPCHWithCompilerErrors=*/true, SkipFunctionBodies, SingleFileParse,
       /*UserFilesAreVolatile=*/true, ForSerialization,
       CXXIdx->getPCHContainerOperations()->getRawReader().getFormat(),
-      &ErrUnit));
+      &ErrUnit, /*VFS=*/nullptr,
+      source_filename ? &PooledInvocation : nullptr,
+      source_filename ? &PooledDriverDiags : nullptr));
+
+  // Only single-input invocations enter the pool: the input re-application
+  // above assumes it can substitute Inputs[0] wholesale.
+  if (!HadPooledInvocation && PooledInvocation &&
+      PooledInvocation->getFrontendOpts().Inputs.size() == 1) {
+    PoolEntry.Invocation = std::move(PooledInvocation);
+    PoolEntry.DriverDiagnostics = std::move(PooledDriverDiags);
+    CXXIdx->rememberInvocation(PoolKeyArgs, source_filename, PoolEntry);
+  }
 
   // Early failures in LoadFromCommandLine may return with ErrUnit unset.
   if (!Unit && !ErrUnit)
@@ -4426,6 +4474,81 @@ unsigned clang_visitChildrenWithBlock(CXCursor parent,
   return clang_visitChildren(parent, visitWithBlock, block);
 }
 
+namespace {
+
+/// Accumulates the flat arrays handed out by clang_getCursorDescendants.
+/// Everything the records point at is owned here, so one allocation keeps
+/// the whole batch alive until clang_disposeCursorDescendants.
+struct CursorDescendantsBuilder {
+  std::vector<CXDescendantRecord> Records;
+  std::string Strings;
+  llvm::StringMap<unsigned> StringOffsets;
+  unsigned Depth = 0;
+  bool WantUSRs;
+
+  CursorDescendantsBuilder(bool WantUSRs) : WantUSRs(WantUSRs) {
+    // Reserve offset 0 for the empty string, so records can use 0 for
+    // "no string".
+    Strings.push_back('\0');
+  }
+
+  unsigned internString(CXString S) {
+    const char *CStr = clang_getCString(S);
+    unsigned Offset = 0;
+    if (CStr && *CStr) {
+      auto Inserted =
+          StringOffsets.insert(std::make_pair(StringRef(CStr), Strings.size()));
+      if (Inserted.second) {
+        Strings += CStr;
+        Strings.push_back('\0');
+      }
+      Offset = Inserted.first->second;
+    }
+    clang_disposeString(S);
+    return Offset;
+  }
+};
+
+} // namespace
+
+static enum CXChildVisitResult
+visitForDescendants(CXCursor cursor, CXCursor /*parent*/,
+                    CXClientData client_data) {
+  CursorDescendantsBuilder &B =
+      *static_cast<CursorDescendantsBuilder *>(client_data);
+
+  CXDescendantRecord Record;
+  Record.Kind = clang_getCursorKind(cursor);
+  Record.Depth = B.Depth;
+  Record.Extent = clang_getCursorExtent(cursor);
+  Record.SpellingOffset = B.internString(clang_getCursorSpelling(cursor));
+  Record.USROffset = B.WantUSRs ? B.internString(clang_getCursorUSR(cursor)) : 0;
+  B.Records.push_back(Record);
+
+  ++B.Depth;
+  clang_visitChildren(cursor, visitForDescendants, client_data);
+  --B.Depth;
+  return CXChildVisit_Continue;
+}
+
+CXCursorDescendants clang_getCursorDescendants(CXCursor parent,
+                                               unsigned wantUSRs) {
+  auto *Builder = new CursorDescendantsBuilder(wantUSRs != 0);
+  clang_visitChildren(parent, visitForDescendants, Builder);
+
+  CXCursorDescendants Batch;
+  Batch.data = Builder;
+  Batch.numRecords = Builder->Records.size();
+  Batch.records = Builder->Records.data();
+  Batch.stringsSize = Builder->Strings.size();
+  Batch.strings = Builder->Strings.data();
+  return Batch;
+}
+
+void clang_disposeCursorDescendants(CXCursorDescendants batch) {
+  delete static_cast<CursorDescendantsBuilder *>(batch.data);
+}
+
 static CXString getDeclSpelling(const Decl *D) {
   if (!D)
     return cxstring::createEmpty();
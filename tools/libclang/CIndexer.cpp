@@ -15,6 +15,7 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Basic/Version.h"
 #include "clang/Driver/Driver.h"
+#include "clang/Frontend/CompilerInvocation.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/MD5.h"
@@ -23,6 +24,7 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/YAMLParser.h"
 #include <cstdio>
+#include <cstring>
 
 #ifdef __CYGWIN__
 #include <cygwin/version.h>
@@ -147,6 +149,46 @@ StringRef CIndexer::getClangToolchainPath() {
   return ToolchainPath;
 }
 
+/// Build the pool key for a command line: the exact argument spellings of
+/// everything but the input file, NUL-separated, followed by the input
+/// file's extension. The extension stands in for the input name because it
+/// is all the driver's language inference looks at, so invocations resolved
+/// for inputs of the same kind are interchangeable up to the input itself.
+static void getInvocationPoolKey(ArrayRef<const char *> Args,
+                                 StringRef InputFile,
+                                 SmallVectorImpl<char> &Key) {
+  for (const char *Arg : Args) {
+    Key.append(Arg, Arg + strlen(Arg));
+    Key.push_back('\0');
+  }
+  StringRef Ext = llvm::sys::path::extension(InputFile);
+  Key.append(Ext.begin(), Ext.end());
+}
+
+bool CIndexer::lookupInvocation(ArrayRef<const char *> Args,
+                                StringRef InputFile,
+                                InvocationPoolEntry &Entry) {
+  SmallString<512> Key;
+  getInvocationPoolKey(Args, InputFile, Key);
+
+  llvm::MutexGuard Guard(InvocationPoolMutex);
+  auto I = InvocationPool.find(Key);
+  if (I == InvocationPool.end())
+    return false;
+  Entry = I->second;
+  return true;
+}
+
+void CIndexer::rememberInvocation(ArrayRef<const char *> Args,
+                                  StringRef InputFile,
+                                  const InvocationPoolEntry &Entry) {
+  SmallString<512> Key;
+  getInvocationPoolKey(Args, InputFile, Key);
+
+  llvm::MutexGuard Guard(InvocationPoolMutex);
+  InvocationPool[Key] = Entry;
+}
+
 LibclangInvocationReporter::LibclangInvocationReporter(
     CIndexer &Idx, OperationKind Op, unsigned ParseOptions,
     llvm::ArrayRef<const char *> Args,
@@ -15,9 +15,13 @@
 #define LLVM_CLANG_TOOLS_LIBCLANG_CINDEXER_H
 
 #include "clang-c/Index.h"
+#include "clang/Basic/Diagnostic.h"
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Mutex.h"
+#include <memory>
 #include <utility>
 
 namespace llvm {
@@ -26,6 +30,7 @@ namespace llvm {
 
 namespace clang {
 class ASTUnit;
+class CompilerInvocation;
 class MacroInfo;
 class MacroDefinitionRecord;
 class SourceLocation;
@@ -33,6 +38,17 @@ class Token;
 class IdentifierInfo;
 
 class CIndexer {
+public:
+  /// A driver-resolved invocation remembered for reuse: the pristine
+  /// CompilerInvocation together with the diagnostics the driver emitted
+  /// while resolving it, which every parse that skips the driver must
+  /// replay into its stored diagnostics.
+  struct InvocationPoolEntry {
+    std::shared_ptr<CompilerInvocation> Invocation;
+    SmallVector<StoredDiagnostic, 2> DriverDiagnostics;
+  };
+
+private:
   bool OnlyLocalDecls;
   bool DisplayDiagnostics;
   unsigned Options; // CXGlobalOptFlags.
@@ -44,6 +60,19 @@ class CIndexer {
 
   std::string InvocationEmissionPath;
 
+  /// A pool of driver-resolved CompilerInvocations, keyed by the command
+  /// line with the input file left out (plus the input's extension, the
+  /// only part of the input name the driver's language inference reads).
+  /// Resolving an invocation runs the driver and re-resolves the header
+  /// search and target options, which an IDE session repeats with a
+  /// command line that differs only in the input file for every
+  /// translation unit it parses or reparses; the pool makes that setup
+  /// happen once per distinct command line, not once per file. Only
+  /// pristine invocations are stored, and lookers receive copies, so
+  /// per-parse mutations never leak into the pool.
+  llvm::sys::Mutex InvocationPoolMutex;
+  llvm::StringMap<InvocationPoolEntry> InvocationPool;
+
 public:
   CIndexer(std::shared_ptr<PCHContainerOperations> PCHContainerOps =
                std::make_shared<PCHContainerOperations>())
@@ -83,6 +112,20 @@ public:
   }
 
   StringRef getInvocationEmissionPath() const { return InvocationEmissionPath; }
+
+  /// Look up the pooled invocation resolved earlier from \p Args — the
+  /// command line with the input file already removed — for an input named
+  /// like \p InputFile. Returns false when the command line has not been
+  /// seen yet; the caller is expected to offer the entry it resolves back
+  /// via rememberInvocation().
+  bool lookupInvocation(llvm::ArrayRef<const char *> Args,
+                        StringRef InputFile, InvocationPoolEntry &Entry);
+
+  /// Store \p Entry, whose invocation must be pristine, as the pooled
+  /// invocation for \p Args and inputs named like \p InputFile.
+  void rememberInvocation(llvm::ArrayRef<const char *> Args,
+                          StringRef InputFile,
+                          const InvocationPoolEntry &Entry);
 };
 
 /// Logs information about a particular libclang operation like parsing to
@@ -1195,13 +1195,8 @@ void CXIndexDataConsumer::getEntityInfo(const NamedDecl *D,
   }
 
   {
-    SmallString<512> StrBuf;
-    bool Ignore = getDeclCursorUSR(D, StrBuf);
-    if (Ignore) {
-      EntityInfo.USR = nullptr;
-    } else {
-      EntityInfo.USR = SA.copyCStr(StrBuf.str());
-    }
+    StringRef USR = DeclUSRs.getUSR(D);
+    EntityInfo.USR = USR.empty() ? nullptr : SA.copyCStr(USR);
   }
 }
 
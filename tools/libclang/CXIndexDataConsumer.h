@@ -12,6 +12,7 @@
 #include "CXCursor.h"
 #include "Index_Internal.h"
 #include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/USRGeneration.h"
 #include "clang/AST/DeclGroup.h"
 #include "clang/AST/DeclObjC.h"
 #include "llvm/ADT/DenseSet.h"
@@ -288,6 +289,10 @@ class CXIndexDataConsumer : public index::IndexDataConsumer {
   ContainerMapTy ContainerMap;
   EntityMapTy EntityMap;
 
+  /// Every reference re-describes its entity to the callbacks, so entity
+  /// USRs are interned here instead of being regenerated per occurrence.
+  index::USRCache DeclUSRs;
+
   typedef std::pair<const FileEntry *, const Decl *> RefFileOccurrence;
   llvm::DenseSet<RefFileOccurrence> RefFileOccurrences;
 
@@ -17,6 +17,7 @@ import json
 import logging
 import multiprocessing
 import tempfile
+import time
 import functools
 import subprocess
 import contextlib
@@ -203,6 +204,67 @@ def merge_ctu_extdef_maps(ctudir):
             shutil.rmtree(extdefmap_dir, ignore_errors=True)
 
 
+def duration_history_file(cdb):
+    """ Path of the per-file analysis duration history.
+
+    It lives next to the compilation database, so that consecutive runs
+    against the same build share it. """
+
+    return os.path.join(os.path.dirname(os.path.abspath(cdb)),
+                        '.analyze-durations.json')
+
+
+def load_run_durations(cdb):
+    """ Read per-file analysis durations persisted by a previous run.
+
+    Returns an empty dictionary when there was no previous run (or the
+    history cannot be read); scheduling then falls back to database order. """
+
+    try:
+        with open(duration_history_file(cdb), 'r') as handle:
+            return json.load(handle)
+    except (IOError, OSError, ValueError):
+        return dict()
+
+
+def save_run_durations(cdb, durations):
+    """ Persist per-file analysis durations for the next run to schedule by.
+
+    Failure to write the history only costs the next run its scheduling
+    hints, so it is not propagated. """
+
+    try:
+        with open(duration_history_file(cdb), 'w') as handle:
+            json.dump(durations, handle)
+    except (IOError, OSError):
+        logging.debug('could not write analysis duration history')
+
+
+def schedule_longest_first(commands, durations):
+    """ Order compilation database entries for parallel analysis.
+
+    Longest-job-first keeps a straggler translation unit from being picked
+    up last and running alone at the end of the build. Files without a
+    recorded duration are scheduled first; they are new or changed, and
+    assuming they are long only costs placing them early. """
+
+    return sorted(commands,
+                  key=lambda cmd: durations.get(cmd['file'], float('inf')),
+                  reverse=True)
+
+
+def run_timed(opts):
+    """ Worker entry point: run the analyzer and measure how long it took.
+
+    Returns the analyzed file name and the elapsed wall time along with the
+    result, so the parent process can persist the duration history. """
+
+    source = opts['file']
+    started = time.time()
+    result = run(opts)
+    return source, time.time() - started, result
+
+
 def run_analyzer_parallel(args):
     """ Runs the analyzer against the given compilation database. """
 
@@ -222,18 +284,25 @@ def run_analyzer_parallel(args):
     }
 
     logging.debug('run analyzer against compilation database')
+    durations = load_run_durations(args.cdb)
     with open(args.cdb, 'r') as handle:
-        generator = (dict(cmd, **consts)
-                     for cmd in json.load(handle) if not exclude(cmd['file']))
+        commands = [dict(cmd, **consts)
+                    for cmd in json.load(handle) if not exclude(cmd['file'])]
+        # the whole database is known up front, so the longest jobs can be
+        # dispatched first instead of wherever the build happened to put them
+        commands = schedule_longest_first(commands, durations)
         # when verbose output requested execute sequentially
         pool = multiprocessing.Pool(1 if args.verbose > 2 else None)
-        for current in pool.imap_unordered(run, generator):
+        for source, elapsed, current in pool.imap_unordered(
+                run_timed, commands):
+            durations[source] = elapsed
             if current is not None:
                 # display error message from the static analyzer
                 for line in current['error_output']:
                     logging.info(line.rstrip())
         pool.close()
         pool.join()
+    save_run_durations(args.cdb, durations)
 
 
 def govern_analyzer_runs(args):
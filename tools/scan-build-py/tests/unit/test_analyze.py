@@ -25,6 +25,39 @@ class ReportDirectoryTest(unittest.TestCase):
             self.assertLess(report_dir2, report_dir3)
 
 
+class ScheduleLongestFirstTest(unittest.TestCase):
+
+    def test_known_durations_descend(self):
+        commands = [{'file': 'a.c'}, {'file': 'b.c'}, {'file': 'c.c'}]
+        durations = {'a.c': 1.0, 'b.c': 5.0, 'c.c': 3.0}
+        result = sut.schedule_longest_first(commands, durations)
+        self.assertEqual(['b.c', 'c.c', 'a.c'],
+                         [cmd['file'] for cmd in result])
+
+    def test_unknown_durations_go_first(self):
+        commands = [{'file': 'a.c'}, {'file': 'new.c'}]
+        durations = {'a.c': 10.0}
+        result = sut.schedule_longest_first(commands, durations)
+        self.assertEqual('new.c', result[0]['file'])
+
+    def test_no_history_keeps_entries(self):
+        commands = [{'file': 'a.c'}, {'file': 'b.c'}]
+        result = sut.schedule_longest_first(commands, dict())
+        self.assertEqual(2, len(result))
+
+    def test_history_round_trip(self):
+        with libear.TemporaryDirectory() as tmpdir:
+            cdb = os.path.join(tmpdir, 'compile_commands.json')
+            durations = {'a.c': 1.5, 'b.c': 0.25}
+            sut.save_run_durations(cdb, durations)
+            self.assertEqual(durations, sut.load_run_durations(cdb))
+
+    def test_missing_history_is_empty(self):
+        with libear.TemporaryDirectory() as tmpdir:
+            cdb = os.path.join(tmpdir, 'compile_commands.json')
+            self.assertEqual(dict(), sut.load_run_durations(cdb))
+
+
 class FilteringFlagsTest(unittest.TestCase):
 
     def test_language_captured(self):
@@ -0,0 +1,108 @@
+//===- unittests/Basic/FileSystemStatCacheTest.cpp -- stat cache tests ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/FileSystemStatCache.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+// Counts the status requests that reach the underlying file system, so the
+// tests can verify that the shared cache absorbed them.
+class CountingFileSystem : public llvm::vfs::ProxyFileSystem {
+public:
+  unsigned StatusCalls = 0;
+
+  explicit CountingFileSystem(
+      IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const Twine &Path) override {
+    ++StatusCalls;
+    return ProxyFileSystem::status(Path);
+  }
+};
+
+class SharedStatCacheTest : public ::testing::Test {
+protected:
+  SharedStatCacheTest()
+      : InMemFS(new llvm::vfs::InMemoryFileSystem), FS(InMemFS),
+        Storage(new SharedStatCacheStorage) {
+    InMemFS->addFile("/dir/a.h", 0, llvm::MemoryBuffer::getMemBuffer(""));
+  }
+
+  std::error_code stat(SharedStatCache &Cache, StringRef Path) {
+    llvm::vfs::Status Status;
+    return FileSystemStatCache::get(Path, Status, /*isFile=*/true,
+                                    /*F=*/nullptr, &Cache, FS);
+  }
+
+  IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> InMemFS;
+  CountingFileSystem FS;
+  IntrusiveRefCntPtr<SharedStatCacheStorage> Storage;
+};
+
+// Caches created from the same storage observe each other's results, for
+// hits and misses alike.
+TEST_F(SharedStatCacheTest, SharesResultsAcrossInstances) {
+  SharedStatCache Cache1(Storage);
+  SharedStatCache Cache2(Storage);
+
+  EXPECT_TRUE(stat(Cache1, "/dir/missing.h") ==
+              std::errc::no_such_file_or_directory);
+  EXPECT_EQ(1u, FS.StatusCalls);
+  EXPECT_FALSE(stat(Cache1, "/dir/a.h"));
+  EXPECT_EQ(2u, FS.StatusCalls);
+
+  // Both results are served to the second cache without new stats.
+  EXPECT_TRUE(stat(Cache2, "/dir/missing.h") ==
+              std::errc::no_such_file_or_directory);
+  EXPECT_FALSE(stat(Cache2, "/dir/a.h"));
+  EXPECT_EQ(2u, FS.StatusCalls);
+}
+
+// A preloaded directory listing answers lookups of unlisted names as ENOENT
+// without any stat traffic.
+TEST_F(SharedStatCacheTest, PreloadedListingProvidesNegativeEntries) {
+  Storage->preloadDirectory("/dir", FS);
+  SharedStatCache Cache(Storage);
+
+  EXPECT_TRUE(stat(Cache, "/dir/missing.h") ==
+              std::errc::no_such_file_or_directory);
+  EXPECT_TRUE(stat(Cache, "/dir/also_missing.h") ==
+              std::errc::no_such_file_or_directory);
+  EXPECT_EQ(0u, FS.StatusCalls);
+
+  // Listed names still hit the file system the first time; the listing only
+  // proves existence of the name, not its stat data.
+  EXPECT_FALSE(stat(Cache, "/dir/a.h"));
+  EXPECT_EQ(1u, FS.StatusCalls);
+
+  // Paths outside the listed directory are unaffected.
+  EXPECT_TRUE(stat(Cache, "/other/missing.h") ==
+              std::errc::no_such_file_or_directory);
+  EXPECT_EQ(2u, FS.StatusCalls);
+}
+
+// Relative paths bypass the shared storage entirely; they may resolve
+// differently in other instances.
+TEST_F(SharedStatCacheTest, RelativePathsAreNotCached) {
+  SharedStatCache Cache(Storage);
+
+  EXPECT_TRUE(stat(Cache, "missing.h") ==
+              std::errc::no_such_file_or_directory);
+  EXPECT_TRUE(stat(Cache, "missing.h") ==
+              std::errc::no_such_file_or_directory);
+  EXPECT_EQ(2u, FS.StatusCalls);
+}
+
+} // anonymous namespace
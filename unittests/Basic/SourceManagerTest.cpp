@@ -102,6 +102,22 @@ TEST_F(SourceManagerTest, isBeforeInTranslationUnit) {
   EXPECT_TRUE(SourceMgr.isBeforeInTranslationUnit(idLoc, macroExpEndLoc));
 }
 
+TEST_F(SourceManagerTest, isBufferPureASCII) {
+  const char *ASCIISource = "int x;\n";
+  const char *UTF8Source = "// \xC3\xBC\n"
+                           "int x;\n";
+
+  FileID ASCIIFile = SourceMgr.createFileID(
+      llvm::MemoryBuffer::getMemBuffer(ASCIISource));
+  FileID UTF8File = SourceMgr.createFileID(
+      llvm::MemoryBuffer::getMemBuffer(UTF8Source));
+
+  EXPECT_TRUE(SourceMgr.isBufferPureASCII(ASCIIFile));
+  EXPECT_FALSE(SourceMgr.isBufferPureASCII(UTF8File));
+  // Unknown FileIDs are conservatively not pure ASCII.
+  EXPECT_FALSE(SourceMgr.isBufferPureASCII(FileID()));
+}
+
 TEST_F(SourceManagerTest, getColumnNumber) {
   const char *Source =
     "int x;\n"
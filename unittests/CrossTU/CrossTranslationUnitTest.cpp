@@ -173,6 +173,53 @@ TEST(CrossTranslationUnit, IndexFormatCanBeParsed) {
     EXPECT_TRUE(Index.count(E.getKey()));
 }
 
+TEST(CrossTranslationUnit, BinaryIndexRoundTrip) {
+  llvm::StringMap<std::string> Index;
+  Index["c:@F@f#I#"] = "/path/f1.ast";
+  Index["c:@F@g#"] = "/path/f2.ast";
+  Index["c:@F@h#"] = "/path/f1.ast";
+
+  int IndexFD;
+  llvm::SmallString<256> IndexFileName;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("index", "bin", IndexFD,
+                                                  IndexFileName));
+  llvm::ToolOutputFile IndexFile(IndexFileName, IndexFD);
+  writeBinaryCrossTUIndex(IndexFile.os(), Index);
+  IndexFile.os().flush();
+  EXPECT_TRUE(llvm::sys::fs::exists(IndexFileName));
+
+  EXPECT_TRUE(BinaryCrossTUIndex::isBinaryIndexFile(IndexFileName));
+  llvm::Expected<BinaryCrossTUIndex> LoadedIndex =
+      BinaryCrossTUIndex::load(IndexFileName, "");
+  ASSERT_TRUE((bool)LoadedIndex);
+  for (const auto &E : Index) {
+    llvm::Optional<std::string> FilePath = LoadedIndex->lookup(E.getKey());
+    ASSERT_TRUE((bool)FilePath);
+    EXPECT_EQ(*FilePath, E.getValue());
+  }
+  EXPECT_FALSE(LoadedIndex->lookup("c:@F@missing#"));
+}
+
+TEST(CrossTranslationUnit, BinaryIndexAppliesCTUDir) {
+  llvm::StringMap<std::string> Index;
+  Index["a"] = "b/c/d";
+
+  int IndexFD;
+  llvm::SmallString<256> IndexFileName;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("index", "bin", IndexFD,
+                                                  IndexFileName));
+  llvm::ToolOutputFile IndexFile(IndexFileName, IndexFD);
+  writeBinaryCrossTUIndex(IndexFile.os(), Index);
+  IndexFile.os().flush();
+
+  llvm::Expected<BinaryCrossTUIndex> LoadedIndex =
+      BinaryCrossTUIndex::load(IndexFileName, "/ctudir");
+  ASSERT_TRUE((bool)LoadedIndex);
+  llvm::Optional<std::string> FilePath = LoadedIndex->lookup("a");
+  ASSERT_TRUE((bool)FilePath);
+  EXPECT_EQ(*FilePath, "/ctudir/b/c/d");
+}
+
 TEST(CrossTranslationUnit, CTUDirIsHandledCorrectly) {
   llvm::StringMap<std::string> Index;
   Index["a"] = "/b/c/d";
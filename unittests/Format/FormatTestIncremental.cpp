@@ -0,0 +1,97 @@
+//===- unittest/Format/FormatTestIncremental.cpp - Formatting unit tests --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "FormatTestUtils.h"
+#include "clang/Format/Format.h"
+#include "llvm/Support/Debug.h"
+#include "gtest/gtest.h"
+
+#define DEBUG_TYPE "format-test"
+
+namespace clang {
+namespace format {
+namespace {
+
+class FormatTestIncremental : public ::testing::Test {
+protected:
+  std::string format(llvm::StringRef Code) {
+    LLVM_DEBUG(llvm::errs() << "---\n");
+    LLVM_DEBUG(llvm::errs() << Code << "\n\n");
+    FormattingAttemptStatus Status;
+    tooling::Replacements Replaces =
+        reformatIncremental(Style, Code, Cache, "<stdin>", &Status);
+    EXPECT_TRUE(Status.FormatComplete) << Code << "\n\n";
+    auto Result = applyAllReplacements(Code, Replaces);
+    EXPECT_TRUE(static_cast<bool>(Result));
+    LLVM_DEBUG(llvm::errs() << "\n" << *Result << "\n\n");
+    return *Result;
+  }
+
+  FormatStyle Style = getLLVMStyle();
+  IncrementalFormatCache Cache;
+};
+
+TEST_F(FormatTestIncremental, FormatsWholeFileOnFirstCall) {
+  EXPECT_EQ("int a;\n"
+            "int b;\n",
+            format("int  a;\n"
+                   "int    b;\n"));
+}
+
+TEST_F(FormatTestIncremental, ReformatsOnlyEditedLines) {
+  EXPECT_EQ("int a;\n"
+            "int b;\n",
+            format("int  a;\n"
+                   "int b;\n"));
+  // The first line is byte-identical to the previous input, so only the
+  // edited second line is reformatted.
+  EXPECT_EQ("int  a;\n"
+            "int bb;\n",
+            format("int  a;\n"
+                   "int    bb;\n"));
+}
+
+TEST_F(FormatTestIncremental, UnchangedInputNeedsNoReformatting) {
+  EXPECT_EQ("int a;\n", format("int  a;\n"));
+  // Byte-identical input returns the cached replacements.
+  EXPECT_EQ("int a;\n", format("int  a;\n"));
+}
+
+TEST_F(FormatTestIncremental, StyleChangeInvalidatesCache) {
+  EXPECT_EQ("int *a;\n"
+            "int *b;\n",
+            format("int* a;\n"
+                   "int* b;\n"));
+  Style.PointerAlignment = FormatStyle::PAS_Left;
+  // The style changed, so the unchanged lines are formatted anew as well.
+  EXPECT_EQ("int* a;\n"
+            "int* b;\n",
+            format("int *a;\n"
+                   "int *b;\n"));
+}
+
+TEST_F(FormatTestIncremental, HandlesInsertedAndRemovedLines) {
+  EXPECT_EQ("int a;\n"
+            "int b;\n",
+            format("int a;\n"
+                   "int b;\n"));
+  EXPECT_EQ("int a;\n"
+            "int c;\n"
+            "int b;\n",
+            format("int a;\n"
+                   "int   c;\n"
+                   "int b;\n"));
+  EXPECT_EQ("int a;\n"
+            "int b;\n",
+            format("int a;\n"
+                   "int b;\n"));
+}
+
+} // end namespace
+} // end namespace format
+} // end namespace clang
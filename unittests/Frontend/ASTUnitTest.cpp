@@ -97,6 +97,26 @@ TEST_F(ASTUnitTest, SaveLoadPreservesLangOptionsInPrintingPolicy) {
   EXPECT_FALSE(AU->getASTContext().getPrintingPolicy().UseVoidForZeroParams);
 }
 
+TEST_F(ASTUnitTest, ReparseSkippedOnUnchangedInputs) {
+  std::unique_ptr<ASTUnit> AST = createASTUnit(false);
+
+  if (!AST)
+    FAIL() << "failed to create ASTUnit";
+
+  // A reparse with changed on-disk contents rebuilds the AST.
+  {
+    std::ofstream OS(InputFileName.c_str());
+    OS << "int foo() { return 0; }\n";
+  }
+  ASSERT_FALSE(AST->Reparse(PCHContainerOps));
+  ASTContext *ContextAfterParse = &AST->getASTContext();
+
+  // A reparse without any input change is skipped entirely and keeps the
+  // existing AST alive.
+  ASSERT_FALSE(AST->Reparse(PCHContainerOps));
+  EXPECT_EQ(ContextAfterParse, &AST->getASTContext());
+}
+
 TEST_F(ASTUnitTest, GetBufferForFileMemoryMapping) {
   std::unique_ptr<ASTUnit> AST = createASTUnit(true);
 
@@ -9,6 +9,7 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
+#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/CompilerInstance.h"
@@ -16,8 +17,10 @@
 #include "clang/Index/IndexDataConsumer.h"
 #include "clang/Index/IndexSymbol.h"
 #include "clang/Index/IndexingAction.h"
+#include "clang/Index/USRGeneration.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/VirtualFileSystem.h"
 #include "gmock/gmock.h"
@@ -292,6 +295,66 @@ TEST(IndexTest, Constructors) {
                 WrittenAt(Position(4, 8)))));
 }
 
+TEST(IndexTest, USRCacheMatchesGeneration) {
+  // The cache interns per canonical decl and splices cached namespace
+  // prefixes into nested USRs; every cached result must be byte-identical
+  // to running the generator from scratch.
+  std::string Code = R"cpp(
+    namespace outer {
+    inline namespace versioned {
+    namespace inner {
+    template <typename T> struct Box {
+      T Value;
+      void set(T V) { Value = V; }
+    };
+    struct S {
+      int Field;
+      void method(Box<S> &B) const;
+    };
+    void function(Box<int>, S *);
+    extern "C" int CLinkage;
+    enum class E { A, B };
+    } // namespace inner
+    } // namespace versioned
+    } // namespace outer
+    template struct outer::inner::Box<float>;
+  )cpp";
+
+  class Checker : public ASTConsumer, public RecursiveASTVisitor<Checker> {
+  public:
+    void HandleTranslationUnit(ASTContext &Ctx) override {
+      TraverseDecl(Ctx.getTranslationUnitDecl());
+      EXPECT_GT(NumChecked, 15u);
+    }
+
+    bool VisitNamedDecl(NamedDecl *D) {
+      SmallString<128> Regenerated;
+      bool Ignore = generateUSRForDecl(D->getCanonicalDecl(), Regenerated);
+      StringRef Cached = Cache.getUSR(D);
+      if (Ignore)
+        EXPECT_TRUE(Cached.empty()) << D->getQualifiedNameAsString();
+      else
+        EXPECT_EQ(Cached.str(), StringRef(Regenerated).str())
+            << D->getQualifiedNameAsString();
+      ++NumChecked;
+      return true;
+    }
+
+    USRCache Cache;
+    unsigned NumChecked = 0;
+  };
+
+  class CheckAction : public ASTFrontendAction {
+  protected:
+    std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &,
+                                                   StringRef) override {
+      return llvm::make_unique<Checker>();
+    }
+  };
+
+  ASSERT_TRUE(tooling::runToolOnCode(new CheckAction, Code));
+}
+
 } // namespace
 } // namespace index
 } // namespace clang
@@ -17,6 +17,7 @@
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/HeaderSearchOptions.h"
 #include "clang/Serialization/InMemoryModuleCache.h"
+#include "llvm/ADT/STLExtras.h"
 #include "gtest/gtest.h"
 
 namespace clang {
@@ -123,6 +124,114 @@ TEST_F(HeaderSearchTest, DotDotsWithAbsPath) {
             "z");
 }
 
+TEST_F(HeaderSearchTest, SharedLookupHitCacheOffByDefault) {
+  // Without the opt-in, instances must neither publish nor consume shared
+  // hits: a header that appears in an earlier search directory between two
+  // parses is found there by the next instance.
+  auto AddDir = [&](llvm::StringRef Dir) {
+    VFS->addFile(Dir, 0, llvm::MemoryBuffer::getMemBuffer(""), /*User=*/None,
+                 /*Group=*/None, llvm::sys::fs::file_type::directory_file);
+  };
+  auto AddHeader = [&](llvm::StringRef Path) {
+    VFS->addFile(Path, 0, llvm::MemoryBuffer::getMemBuffer("\n"));
+  };
+  auto MakeSearch = [&](bool Shared) {
+    auto Opts = std::make_shared<HeaderSearchOptions>();
+    Opts->SharedLookupHitCache = Shared;
+    auto HS = llvm::make_unique<HeaderSearch>(Opts, SourceMgr, Diags, LangOpts,
+                                              Target.get());
+    for (llvm::StringRef Dir : {"/off/a", "/off/b"}) {
+      const DirectoryEntry *DE = FileMgr.getDirectory(Dir);
+      HS->AddSearchPath(
+          DirectoryLookup(DE, SrcMgr::C_User, /*isFramework=*/false),
+          /*isAngled=*/false);
+    }
+    return HS;
+  };
+  auto Lookup = [&](HeaderSearch &HS, llvm::StringRef File) {
+    const DirectoryLookup *CurDir = nullptr;
+    return HS.LookupFile(File, SourceLocation(), /*isAngled=*/false,
+                         /*FromDir=*/nullptr, CurDir, /*Includers=*/{},
+                         /*SearchPath=*/nullptr, /*RelativePath=*/nullptr,
+                         /*RequestingModule=*/nullptr,
+                         /*SuggestedModule=*/nullptr, /*IsMapped=*/nullptr,
+                         /*IsFrameworkFound=*/nullptr);
+  };
+
+  AddDir("/off/a");
+  AddDir("/off/b");
+  AddHeader("/off/b/t.h");
+
+  auto HS1 = MakeSearch(/*Shared=*/false);
+  const FileEntry *FE = Lookup(*HS1, "t.h");
+  ASSERT_TRUE(FE);
+  EXPECT_EQ(FE->getName(), "/off/b/t.h");
+
+  AddHeader("/off/a/t.h");
+  auto HS2 = MakeSearch(/*Shared=*/false);
+  FE = Lookup(*HS2, "t.h");
+  ASSERT_TRUE(FE);
+  EXPECT_EQ(FE->getName(), "/off/a/t.h");
+}
+
+TEST_F(HeaderSearchTest, SharedLookupHitCacheResumesAtHit) {
+  // With the opt-in, a fresh instance with the same search path list resumes
+  // its scan at the directory a previous instance recorded, skipping the
+  // directories before it (the documented frozen-directory assumption).
+  auto AddDir = [&](llvm::StringRef Dir) {
+    VFS->addFile(Dir, 0, llvm::MemoryBuffer::getMemBuffer(""), /*User=*/None,
+                 /*Group=*/None, llvm::sys::fs::file_type::directory_file);
+  };
+  auto AddHeader = [&](llvm::StringRef Path) {
+    VFS->addFile(Path, 0, llvm::MemoryBuffer::getMemBuffer("\n"));
+  };
+  auto MakeSearch = [&](bool Shared) {
+    auto Opts = std::make_shared<HeaderSearchOptions>();
+    Opts->SharedLookupHitCache = Shared;
+    auto HS = llvm::make_unique<HeaderSearch>(Opts, SourceMgr, Diags, LangOpts,
+                                              Target.get());
+    for (llvm::StringRef Dir : {"/on/a", "/on/b"}) {
+      const DirectoryEntry *DE = FileMgr.getDirectory(Dir);
+      HS->AddSearchPath(
+          DirectoryLookup(DE, SrcMgr::C_User, /*isFramework=*/false),
+          /*isAngled=*/false);
+    }
+    return HS;
+  };
+  auto Lookup = [&](HeaderSearch &HS, llvm::StringRef File) {
+    const DirectoryLookup *CurDir = nullptr;
+    return HS.LookupFile(File, SourceLocation(), /*isAngled=*/false,
+                         /*FromDir=*/nullptr, CurDir, /*Includers=*/{},
+                         /*SearchPath=*/nullptr, /*RelativePath=*/nullptr,
+                         /*RequestingModule=*/nullptr,
+                         /*SuggestedModule=*/nullptr, /*IsMapped=*/nullptr,
+                         /*IsFrameworkFound=*/nullptr);
+  };
+
+  AddDir("/on/a");
+  AddDir("/on/b");
+  AddHeader("/on/b/u.h");
+
+  auto HS1 = MakeSearch(/*Shared=*/true);
+  const FileEntry *FE = Lookup(*HS1, "u.h");
+  ASSERT_TRUE(FE);
+  EXPECT_EQ(FE->getName(), "/on/b/u.h");
+
+  // The header now also exists in the earlier directory, but the recorded
+  // hit makes the next sharing instance resume at /on/b.
+  AddHeader("/on/a/u.h");
+  auto HS2 = MakeSearch(/*Shared=*/true);
+  FE = Lookup(*HS2, "u.h");
+  ASSERT_TRUE(FE);
+  EXPECT_EQ(FE->getName(), "/on/b/u.h");
+
+  // A non-sharing instance over the same directories ignores the memo.
+  auto HS3 = MakeSearch(/*Shared=*/false);
+  FE = Lookup(*HS3, "u.h");
+  ASSERT_TRUE(FE);
+  EXPECT_EQ(FE->getName(), "/on/a/u.h");
+}
+
 TEST_F(HeaderSearchTest, IncludeFromSameDirectory) {
   EXPECT_EQ(Search.suggestPathToFileForDiagnostics("/y/z/t.h",
                                                    /*WorkingDir=*/"",
@@ -370,6 +370,33 @@ TEST_F(LexerTest, DontMergeMacroArgsFromDifferentMacroFiles) {
   EXPECT_EQ(SourceMgr.getFileIDSize(SourceMgr.getFileID(helper1ArgLoc)), 8U);
 }
 
+TEST_F(LexerTest, ReplayedObjectMacroHasExpansionLocations) {
+  // An object-like macro whose body contains no identifiers is replayed
+  // verbatim instead of going through the TokenLexer; the tokens must still
+  // carry proper macro body expansion locations.
+  std::vector<tok::TokenKind> ExpectedTokens;
+  ExpectedTokens.push_back(tok::l_paren);
+  ExpectedTokens.push_back(tok::numeric_constant);
+  ExpectedTokens.push_back(tok::plus);
+  ExpectedTokens.push_back(tok::numeric_constant);
+  ExpectedTokens.push_back(tok::r_paren);
+
+  std::vector<Token> toks = CheckLex("#define M (1 + 2)\n"
+                                     "M",
+                                     ExpectedTokens);
+
+  SourceLocation ExpansionLoc = SourceMgr.getExpansionLoc(toks[0].getLocation());
+  for (const Token &Tok : toks) {
+    EXPECT_TRUE(Tok.getLocation().isMacroID());
+    EXPECT_TRUE(SourceMgr.isMacroBodyExpansion(Tok.getLocation()));
+    // All tokens expand at the point where the macro name was written.
+    EXPECT_EQ(ExpansionLoc, SourceMgr.getExpansionLoc(Tok.getLocation()));
+  }
+  // Spellings still point into the macro definition.
+  EXPECT_EQ("1", Lexer::getSpelling(toks[1], SourceMgr, LangOpts));
+  EXPECT_EQ("+", Lexer::getSpelling(toks[2], SourceMgr, LangOpts));
+}
+
 TEST_F(LexerTest, DontOverallocateStringifyArgs) {
   TrivialModuleLoader ModLoader;
   auto PP = CreatePP("\"StrArg\", 5, 'C'", ModLoader);
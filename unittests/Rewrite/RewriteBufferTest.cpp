@@ -47,4 +47,27 @@ TEST(RewriteBuffer, TagRanges) {
   EXPECT_EQ(Output, Result);
 }
 
+// Streams edits front to back the way a refactoring tool does; the rope
+// coalesces adjacent pieces on this pattern, so check the content survives.
+TEST(RewriteBuffer, SequentialInsertions) {
+  StringRef Input = "abcdefghij";
+
+  RewriteBuffer Buf;
+  Buf.Initialize(Input);
+
+  std::string Expected;
+  for (unsigned i = 0, e = Input.size(); i != e; ++i) {
+    std::string Insert = "<" + std::to_string(i) + ">";
+    Buf.InsertTextBefore(i, Insert);
+    Expected += Insert;
+    Expected += Input[i];
+  }
+
+  std::string Result;
+  raw_string_ostream OS(Result);
+  Buf.write(OS);
+  OS.flush();
+  EXPECT_EQ(Expected, Result);
+}
+
 } // anonymous namespace
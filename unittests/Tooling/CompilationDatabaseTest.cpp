@@ -13,8 +13,11 @@
 #include "clang/Tooling/FileMatchTrie.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -205,6 +208,58 @@ TEST(JSONCompilationDatabase, ArgumentsPreferredOverCommand) {
    EXPECT_EQ(Arguments, FoundCommand.CommandLine[0]) << ErrorMessage;
 }
 
+static std::unique_ptr<JSONCompilationDatabase>
+loadFromTemporaryFile(StringRef JSONDatabase, std::string &ErrorMessage,
+                      llvm::SmallVectorImpl<char> &DatabasePath) {
+  int FD;
+  if (llvm::sys::fs::createTemporaryFile("compile_commands", "json", FD,
+                                         DatabasePath)) {
+    ADD_FAILURE() << "Failed to create temporary file";
+    return nullptr;
+  }
+  llvm::raw_fd_ostream(FD, /*shouldClose=*/true) << JSONDatabase;
+  return JSONCompilationDatabase::loadFromFile(
+      StringRef(DatabasePath.data(), DatabasePath.size()), ErrorMessage,
+      JSONCommandLineSyntax::Gnu);
+}
+
+TEST(JSONCompilationDatabase, LoadsFromFileLazily) {
+  // loadFromFile only indexes the database; the entries are parsed when a
+  // caller requests them.
+  std::string ErrorMessage;
+  SmallString<128> DatabasePath;
+  auto Database = loadFromTemporaryFile(
+      "[{\"directory\":\"//net/dir\","
+      "\"command\":\"command1 file1\","
+      "\"file\":\"file1\"},\n"
+      " {\"directory\":\"//net/dir\","
+      "\"arguments\":[\"command2\",\"file2\"],"
+      "\"file\":\"//net/dir/file2\"}]",
+      ErrorMessage, DatabasePath);
+  llvm::FileRemover Cleanup(DatabasePath);
+  ASSERT_TRUE(Database != nullptr) << ErrorMessage;
+  EXPECT_EQ(2u, Database->getAllFiles().size());
+  SmallString<16> PathStorage;
+  llvm::sys::path::native("//net/dir/file1", PathStorage);
+  std::vector<CompileCommand> Commands =
+      Database->getCompileCommands(PathStorage);
+  ASSERT_EQ(1u, Commands.size());
+  EXPECT_THAT(Commands[0].CommandLine, ElementsAre("command1", "file1"));
+  EXPECT_EQ(2u, Database->getAllCompileCommands().size());
+}
+
+TEST(JSONCompilationDatabase, ReportsParseErrorsWhenLoadingFromFile) {
+  // A database outside of the subset the lazy index understands goes
+  // through the full parse, which reports the exact error.
+  std::string ErrorMessage;
+  SmallString<128> DatabasePath;
+  auto Database = loadFromTemporaryFile("[{\"a\":\"b\"}]", ErrorMessage,
+                                        DatabasePath);
+  llvm::FileRemover Cleanup(DatabasePath);
+  EXPECT_EQ(nullptr, Database);
+  EXPECT_THAT(ErrorMessage, testing::HasSubstr("Unknown key"));
+}
+
 struct FakeComparator : public PathComparator {
   ~FakeComparator() override {}
   bool equivalent(StringRef FileA, StringRef FileB) const override {
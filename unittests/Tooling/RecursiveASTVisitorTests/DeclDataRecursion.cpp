@@ -0,0 +1,71 @@
+//===- unittest/Tooling/RecursiveASTVisitorTests/DeclDataRecursion.cpp ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "TestVisitor.h"
+#include <algorithm>
+
+using namespace clang;
+
+namespace {
+
+/// Records the names of all named declarations in visitation order.
+template <typename Derived>
+class NameCollectorVisitor : public TestVisitor<Derived> {
+public:
+  bool VisitNamedDecl(NamedDecl *D) {
+    Names.push_back(D->getNameAsString());
+    return true;
+  }
+
+  std::vector<std::string> Names;
+};
+
+class NativeRecursionVisitor
+    : public NameCollectorVisitor<NativeRecursionVisitor> {};
+
+class DataRecursionVisitor : public NameCollectorVisitor<DataRecursionVisitor> {
+public:
+  bool shouldDataRecurseDecls() const { return true; }
+};
+
+TEST(RecursiveASTVisitor, DeclDataRecursionPreservesContextOrder) {
+  // For declarations nested purely through declaration contexts, the
+  // worklist-based traversal must produce exactly the native preorder.
+  StringRef Code = "namespace a { namespace b {\n"
+                   "struct S { struct T { int m; }; };\n"
+                   "enum E { V };\n"
+                   "} // namespace b\n"
+                   "int x; }\n";
+
+  NativeRecursionVisitor Native;
+  EXPECT_TRUE(Native.runOver(Code));
+  DataRecursionVisitor Data;
+  EXPECT_TRUE(Data.runOver(Code));
+
+  EXPECT_FALSE(Native.Names.empty());
+  EXPECT_EQ(Native.Names, Data.Names);
+}
+
+TEST(RecursiveASTVisitor, DeclDataRecursionVisitsStatementNestedDecls) {
+  // Declarations reached through statements (a local class) are deferred to
+  // the worklist, which may reorder them relative to the native traversal,
+  // but every declaration must still be visited exactly once.
+  StringRef Code = "void f() { struct Local { int n; } l; (void)l; }\n";
+
+  NativeRecursionVisitor Native;
+  EXPECT_TRUE(Native.runOver(Code));
+  DataRecursionVisitor Data;
+  EXPECT_TRUE(Data.runOver(Code));
+
+  std::sort(Native.Names.begin(), Native.Names.end());
+  std::sort(Data.Names.begin(), Data.Names.end());
+  EXPECT_FALSE(Native.Names.empty());
+  EXPECT_EQ(Native.Names, Data.Names);
+}
+
+} // end anonymous namespace
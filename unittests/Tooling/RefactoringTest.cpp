@@ -464,6 +464,28 @@ TEST_F(ReplacementTest, AdjacentReplacements) {
   EXPECT_EQ("xy", Context.getRewrittenText(ID));
 }
 
+TEST_F(ReplacementTest, StreamsReplacedCodeToOstream) {
+  Replacements Replaces =
+      toReplacements({Replacement("<stdin>", 6, 5, "replaced"),
+                      Replacement("<stdin>", 12, 5, "other")});
+  std::string Result;
+  llvm::raw_string_ostream OS(Result);
+  llvm::Error Err =
+      applyAllReplacements("line1\nline2\nline3\nline4", Replaces, OS);
+  EXPECT_TRUE(!Err);
+  llvm::consumeError(std::move(Err));
+  EXPECT_EQ("line1\nreplaced\nother\nline4", OS.str());
+}
+
+TEST_F(ReplacementTest, StreamingFailsOnOutOfBoundReplacement) {
+  Replacements Replaces = toReplacements({Replacement("<stdin>", 10, 5, "x")});
+  std::string Result;
+  llvm::raw_string_ostream OS(Result);
+  llvm::Error Err = applyAllReplacements("short", Replaces, OS);
+  EXPECT_TRUE(!!Err);
+  llvm::consumeError(std::move(Err));
+}
+
 TEST_F(ReplacementTest, AddDuplicateReplacements) {
   FileID ID = Context.createInMemoryFile("input.cpp",
                                          "line1\nline2\nline3\nline4");
@@ -199,6 +199,53 @@ TEST(ToolInvocation, TestVirtualModulesCompilation) {
   EXPECT_TRUE(Invocation.run());
 }
 
+TEST(ToolInvocation, TestInvocationTemplateCache) {
+  llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> OverlayFileSystem(
+      new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()));
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> InMemoryFileSystem(
+      new llvm::vfs::InMemoryFileSystem);
+  OverlayFileSystem->pushOverlay(InMemoryFileSystem);
+  llvm::IntrusiveRefCntPtr<FileManager> Files(
+      new FileManager(FileSystemOptions(), OverlayFileSystem));
+  InMemoryFileSystem->addFile("a.cpp", 0,
+                              llvm::MemoryBuffer::getMemBuffer("class X;\n"));
+  InMemoryFileSystem->addFile("b.cpp", 0,
+                              llvm::MemoryBuffer::getMemBuffer("class Y;\n"));
+
+  InvocationTemplateCache Cache;
+
+  std::vector<std::string> ArgsA;
+  ArgsA.push_back("tool-executable");
+  ArgsA.push_back("-fsyntax-only");
+  ArgsA.push_back("a.cpp");
+  bool FoundClassDeclX = false;
+  ToolInvocation InvocationA(
+      ArgsA,
+      new TestAction(
+          llvm::make_unique<FindClassDeclXConsumer>(&FoundClassDeclX)),
+      Files.get());
+  InvocationA.setInvocationTemplateCache(&Cache);
+  EXPECT_TRUE(InvocationA.run());
+  EXPECT_TRUE(FoundClassDeclX);
+
+  // The second run only differs in the input file, so it hits the cached
+  // template; seeing b.cpp's content proves the clone was patched with the
+  // new input rather than replaying a.cpp.
+  std::vector<std::string> ArgsB;
+  ArgsB.push_back("tool-executable");
+  ArgsB.push_back("-fsyntax-only");
+  ArgsB.push_back("b.cpp");
+  FoundClassDeclX = false;
+  ToolInvocation InvocationB(
+      ArgsB,
+      new TestAction(
+          llvm::make_unique<FindClassDeclXConsumer>(&FoundClassDeclX)),
+      Files.get());
+  InvocationB.setInvocationTemplateCache(&Cache);
+  EXPECT_TRUE(InvocationB.run());
+  EXPECT_FALSE(FoundClassDeclX);
+}
+
 struct VerifyEndCallback : public SourceFileCallbacks {
   VerifyEndCallback() : BeginCalled(0), EndCalled(0), Matched(false) {}
   bool handleBeginSource(CompilerInstance &CI) override {
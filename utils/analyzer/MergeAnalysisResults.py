@@ -0,0 +1,92 @@
+#!/usr/bin/env python
+
+"""
+MergeAnalysisResults - Merge the plist output directories of several analyzer
+runs into a single directory, dropping the diagnostics that are duplicated
+between the inputs.
+
+This is the companion of the sharded analysis modes (the analysis-shard-count
+and analysis-shard-manifest analyzer configs): every shard writes a complete
+plist directory of its own, and this tool combines them into the directory a
+results viewer is pointed at. Two diagnostics are considered the same issue
+if they agree on the issue hash, the source file, the bug type and the bug
+category; the issue hash is stable across translation units and shards, so a
+report that several shards reach (typically in a shared header) is kept only
+once.
+
+Usage:
+
+    MergeAnalysisResults.py -o merged-dir shard-dir1 shard-dir2 ...
+"""
+
+from __future__ import division, print_function
+
+from optparse import OptionParser
+import os
+import plistlib
+
+
+def diagnosticKey(diag, files):
+    fileIndex = diag.get('location', {}).get('file', 0)
+    return (diag.get('issue_hash_content_of_line_in_context'),
+            files[fileIndex] if fileIndex < len(files) else None,
+            diag.get('type'), diag.get('category'))
+
+
+def mergeDirectory(path, outputDir, seen, nextOutputIndex):
+    kept = 0
+    dropped = 0
+    for name in sorted(os.listdir(path)):
+        if not name.endswith('.plist'):
+            continue
+        data = plistlib.readPlist(os.path.join(path, name))
+        diagnostics = data.get('diagnostics', [])
+        files = data.get('files', [])
+        unique = []
+        for diag in diagnostics:
+            key = diagnosticKey(diag, files)
+            if key in seen:
+                dropped += 1
+                continue
+            seen.add(key)
+            unique.append(diag)
+        if not unique:
+            continue
+        # Each input plist is written out as a whole after filtering; the
+        # diagnostics reference the 'files' list of their own plist by index,
+        # so keeping the plists separate avoids renumbering them.
+        data['diagnostics'] = unique
+        outName = 'merged-%d.plist' % nextOutputIndex[0]
+        nextOutputIndex[0] += 1
+        plistlib.writePlist(data, os.path.join(outputDir, outName))
+        kept += len(unique)
+    return kept, dropped
+
+
+def main():
+    parser = OptionParser('usage: %prog [options] <input directories>')
+    parser.add_option('-o', dest='output',
+                      help='the directory the merged plists are written to')
+    (opts, args) = parser.parse_args()
+    if not opts.output or not args:
+        parser.error('an output directory and at least one input directory '
+                     'are required')
+
+    if not os.path.isdir(opts.output):
+        os.makedirs(opts.output)
+
+    seen = set()
+    nextOutputIndex = [0]
+    totalKept = 0
+    totalDropped = 0
+    for path in args:
+        kept, dropped = mergeDirectory(path, opts.output, seen,
+                                       nextOutputIndex)
+        totalKept += kept
+        totalDropped += dropped
+    print('merged %d diagnostics, dropped %d duplicates' %
+          (totalKept, totalDropped))
+
+
+if __name__ == '__main__':
+    main()